@@ -67,6 +67,7 @@ constexpr UINT           WM_SKIF_UPDATER        = WM_USER + 0x2051; // Updater w
 constexpr UINT           WM_SKIF_ICON           = WM_USER + 0x2052; // Patreon/Cover/Icon textures workers completed...
 constexpr UINT           WM_SKIF_REFRESHCOVER   = WM_USER + 0x2053; // Refresh Cover -- Update Cover worker completed
 constexpr UINT           WM_SKIF_REFRESHFOCUS   = WM_USER + 0x2054; // Trigger a new focus check from the main thread (used by child threads, e.g. gamepad input thread)
+constexpr UINT           WM_SKIF_EXPORT         = WM_USER + 0x2055; // Export worker advanced or finished a job
 
 // Callbacks / Event Signals
 constexpr UINT           WM_SKIF_POWERMODE      = WM_USER + 0x2101; // Used to signal that a new effective power mode has been applied
@@ -123,6 +124,8 @@ struct SKIF_Signals { // Used for command line arguments
   BOOL CaptureRegion        = FALSE;
   BOOL CaptureScreen        = FALSE;
   BOOL ServiceMode          = FALSE;
+  BOOL Benchmark            = FALSE;
+  BOOL Convert              = FALSE;
 
   // Helper variables
   HWND _RunningInstance     = NULL;
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+
+// Headless batch conversion (SKIV.exe /Convert <inputs...> /To <ext> [options])
+//
+//   Inputs are files, wildcard patterns (C:\Captures\*.jxr), folders or list
+//     files (@files.txt, one input per line). Every input is decoded with the
+//       viewer's own decoders, tonemapped if an HDR image is exported to an SDR
+//         format, and encoded by a pool of workers; a JSON report with the status
+//           and timings of each file is written at the end.
+//
+//   Options:  /To <ext>        Target format (png, jxl, avif, exr, jxr, hdr, dds, jpg, bmp, tiff)
+//             /Out <folder>    Output folder (defaults to the folder of each input)
+//             /SDR             Always export SDR, tonemapping HDR inputs
+//             /Visualize <viz> Export an HDR visualization instead (heatmap, gamut or sdr)
+//             /Resize <size>   Scale down to a percentage (50%) or to fit within WIDTHxHEIGHT
+//             /Jobs <count>    Number of concurrent conversions
+//             /MaxMemory <MiB> Budget for decoded images held in memory at once
+//             /Overwrite       Replace existing output files instead of skipping them
+//             /Report <file>   Report path (defaults to SKIV_convert.json in the user data folder)
+//
+//   Returns the process exit code (0 = all files converted or skipped,
+//     1 = at least one failure, 2 = invalid arguments).
+int SKIV_Batch_Run (const std::wstring& args, const std::wstring& default_report_path);
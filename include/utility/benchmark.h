@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string>
+
+// Headless benchmark of the image pipeline (SKIV.exe /Benchmark [output.json])
+//
+//   Generates a deterministic synthetic SDR / HDR / wide color gamut corpus at
+//     several resolutions, times each pipeline stage over a number of warmup
+//       and measured iterations, and writes the results as JSON so that they
+//         can be compared across builds. The updater's SHA-256 is timed as
+//           well, and checked against picosha2, as is the cost of logging.
+//             CICP decoding is timed per transfer function.
+//
+//   Returns the process exit code (0 = all stages succeeded).
+int SKIV_Benchmark_Run (const std::wstring& output_path);
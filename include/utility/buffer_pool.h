@@ -0,0 +1,83 @@
+#pragma once
+
+#include <wtypes.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+#include <type_traits>
+
+// Size-classed pool for the large, short-lived buffers of the image pipeline
+//   (file contents, decoder output, staging rows, luminance histograms).
+//
+//   Released buffers are kept committed up to a configurable cap, so loading
+//     the next image in a folder re-uses pages that are already faulted in
+//       instead of paying for VirtualAlloc + demand-zero faults every time.
+class SKIV_BufferPool
+{
+public:
+  struct stats_s {
+    size_t   bytes_in_use        = 0;
+    size_t   bytes_in_use_peak   = 0;
+    size_t   bytes_retained      = 0; // Released to the pool, but not to the OS
+    size_t   bytes_retained_peak = 0;
+    size_t   bytes_cap           = 0;
+    uint64_t hits                = 0;
+    uint64_t misses              = 0;
+    uint64_t evictions           = 0;
+    bool     large_pages         = false;
+  };
+
+  struct deleter_s {
+    void operator() (void* ptr) const;
+  };
+
+  template <typename T>
+  using unique_ptr = std::unique_ptr <T[], deleter_s>;
+
+  // Contents of an acquired buffer are undefined (not zeroed)
+  void*   Acquire       (size_t size);
+  void    Release       (void*  ptr);
+  void    Trim          (size_t retain = 0);
+  void    SetCap        (size_t bytes);
+  void    SetLargePages (bool   enable);
+  stats_s GetStats      (void);
+
+  template <typename T>
+  unique_ptr <T> make_unique (size_t count)
+  {
+    static_assert (std::is_trivially_destructible_v <T>);
+
+    return
+      unique_ptr <T> (static_cast <T *> (Acquire (count * sizeof (T))));
+  }
+
+  static SKIV_BufferPool& GetInstance (void)
+  {
+      static SKIV_BufferPool instance;
+      return instance;
+  }
+
+  SKIV_BufferPool (SKIV_BufferPool const&) = delete; // Delete copy constructor
+  SKIV_BufferPool (SKIV_BufferPool&&)      = delete; // Delete move constructor
+
+private:
+  struct block_s {
+    void*  ptr         = nullptr;
+    size_t size_class  = 0;
+    size_t committed   = 0;
+    bool   large_pages = false;
+  };
+
+  std::mutex                           lock;
+  std::vector        <block_s>         free_blocks; // Ordered from least to most recently released
+  std::unordered_map <void*, block_s>  live_blocks;
+  stats_s                              stats;
+  size_t                               large_page_min = 0;
+  bool                                 large_pages    = false;
+
+           SKIV_BufferPool  (void);
+  block_s  Allocate         (size_t size_class, size_t page_size);
+  void     Free             (block_s& block);
+  void     Evict            (size_t retain);
+};
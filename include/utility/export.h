@@ -0,0 +1,72 @@
+#pragma once
+
+#include <utility/image.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct skiv_tiled_image_s;
+
+// Background export queue
+//
+//   Save As and the export dialogs hand the viewer's retained CPU copy of the
+//     decoded image (shared, never copied) to a small pool of workers, which
+//       resize, visualize or tonemap and encode it off the render thread. Each
+//         job writes to a temporary file next to its target that only replaces
+//           the target once encoding succeeded, so cancelled and failed jobs
+//             leave nothing behind.
+//
+//   The memory a job allocates along the way is estimated up front and counts
+//     against SKIV_EXPORT_MEMORY_BUDGET; queued jobs wait for running ones to
+//       free enough of it, but a job is always let through while none run.
+constexpr size_t SKIV_EXPORT_WORKERS       = 2;
+constexpr size_t SKIV_EXPORT_MEMORY_BUDGET = 2048ULL * 1024 * 1024;
+
+enum skiv_export_mode_e {
+  SKIV_Export_AsIs          = 0, // HDR images stay HDR
+  SKIV_Export_SDR           = 1, // HDR images are tonemapped
+  SKIV_Export_Visualization = 2  // The current visualization and tonemap, as rendered
+};
+
+enum skiv_export_state_e {
+  SKIV_ExportState_Queued    = 0,
+  SKIV_ExportState_Running   = 1,
+  SKIV_ExportState_Succeeded = 2,
+  SKIV_ExportState_Failed    = 3,
+  SKIV_ExportState_Cancelled = 4
+};
+
+struct skiv_export_request_s {
+  std::wstring                                  path;
+  skiv_export_mode_e                            mode       = SKIV_Export_AsIs;
+  bool                                          is_hdr     = false;
+  std::shared_ptr <const DirectX::ScratchImage> pixels;              // The decoded image ...
+  std::shared_ptr <const skiv_tiled_image_s>    tiles;               // ... or the tiles of one too large for a texture
+  float                                         percent    = 100.0f; // Export size, see SKIV_Image_ResizeForExport ()
+  size_t                                        max_width  = 0;
+  size_t                                        max_height = 0;
+  skiv_hdr_visualization_s                      viz;                 // SKIV_Export_Visualization only
+};
+
+struct skiv_export_status_s {
+  uint32_t            id       = 0;
+  std::wstring        path;
+  skiv_export_mode_e  mode     = SKIV_Export_AsIs;
+  skiv_export_state_e state    = SKIV_ExportState_Queued;
+  float               progress = 0.0f; // 0 - 1, advanced per pipeline stage
+  HRESULT             hr       = S_OK;
+};
+
+// Queues the export and returns the id of its job
+uint32_t SKIV_Export_Submit   (skiv_export_request_s request);
+
+// Queued jobs are dropped at once; running ones stop before their next stage,
+//   as the encoders themselves cannot be interrupted
+void     SKIV_Export_Cancel   (uint32_t id);
+
+// Every queued and running job, plus the jobs that finished since the last
+//   call, which are forgotten afterwards
+void     SKIV_Export_GetJobs  (std::vector <skiv_export_status_s>& jobs);
+
+// Cancels all jobs and waits for the workers to exit
+void     SKIV_Export_Shutdown (void);
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <DirectXTex.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Color management of embedded ICC profiles
+//
+//   A profile is compiled once into a transform from its color space to scRGB
+//     (linear Rec. 709, D65; relative colorimetric), and cached by the SHA-256
+//       of its contents, so a folder of photos from the same camera or editor
+//         shares a single transform:
+//
+//     - Matrix / TRC profiles (RGB and gray) become a linearization table per
+//         channel followed by a 3x3 matrix, evaluated with AVX2 gathers.
+//     - LUT-based profiles (lut8 / lut16 A2B0) are sampled into a 3D LUT of
+//         scRGB values that is interpolated trilinearly.
+//
+//   Profiles that are equivalent to sRGB compile to nothing, since the viewer
+//     already treats untagged images as sRGB.
+struct skiv_icc_transform_s {
+  enum type_e {
+    Matrix,
+    LUT3D
+  } type = Matrix;
+
+  // Matrix / TRC: the curves map [0, 1] in SKIV_ICC_CURVE_SIZE steps (plus one
+  //   guard entry), and the matrix (row-major) takes the result to scRGB
+  std::vector <float> curves [3];
+  float               matrix [3][3] = { };
+
+  // LUT-based: grid^3 nodes of scRGB (padded to four floats), red varying slowest
+  uint32_t            grid = 0;
+  std::vector <float> lut;
+};
+
+constexpr size_t SKIV_ICC_CURVE_SIZE = 4096;
+
+// Embedded profile of a PNG (iCCP) or JPEG (APP2) held in memory; empty if there is none
+std::vector <uint8_t>
+        SKIV_ICC_ExtractProfile (const uint8_t* data, size_t size);
+
+// nullptr for profiles that are unsupported, malformed or equivalent to sRGB
+std::shared_ptr <const skiv_icc_transform_s>
+        SKIV_ICC_GetTransform   (const uint8_t* profile, size_t size);
+
+// RGBA32F in, RGBA32F out; alpha is passed through
+void    SKIV_ICC_Transform      (const skiv_icc_transform_s& transform, const float* src, float* dst, size_t count);
+
+// RGBA8 / RGBA16 pixels (as decoded by stbi) to scRGB FP16, in parallel; wcg is set
+//   if any pixel falls outside of Rec. 709, hdr if any is brighter than SDR white
+HRESULT SKIV_ICC_TransformImage (const skiv_icc_transform_s& transform, const void* pixels, size_t width, size_t height, bool is_16bit,
+                                 DirectX::ScratchImage& result, bool& wcg, bool& hdr);
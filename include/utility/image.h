@@ -118,6 +118,80 @@ static const ParamsPQ PQ =
 
 #pragma warning( pop )
 
+// Structs (shared by the loaders and the pixel kernels)
+
+struct skiv_image_gamut_s {
+  struct pixel_samples_s {
+    uint32_t rec_709;
+    uint32_t rec_2020;
+    uint32_t dci_p3;
+    uint32_t ap1;
+    uint32_t ap0;
+    uint32_t undefined;
+    uint32_t total;
+
+    float getPercentRec709    (void) const;
+    float getPercentRec2020   (void) const;
+    float getPercentDCIP3     (void) const;
+    float getPercentAP1       (void) const;
+    float getPercentAP0       (void) const;
+    float getPercentUndefined (void) const;
+  } pixel_counts;
+};
+
+// Light levels of an scRGB image, as listed in the viewer's image details
+struct skiv_image_light_s {
+  float max_cll      = 0.0f;
+  char  max_cll_name =  '?';  // Channel holding max_cll
+  float max_nits     = 0.0f;
+  float min_nits     = 0.0f;
+  float avg_nits     = 0.0f;
+  float p99_nits     = 0.0f;  // 99.94th percentile luminance
+};
+
+// Inputs of the viewer's HDR visualizations and tonemapping (imgui_pix_shader.hlsl),
+//   so that the CPU reference renderer reproduces what is shown on screen.
+struct skiv_hdr_visualization_s {
+  uint32_t type              = 0;           // SKIV_HDR_Visualizations
+  uint32_t sdr_flags         = 0xFFFFFFFFU; // SKIV_HDR_VisualizationFlags
+  uint32_t tonemap_type      = 0;           // SKIV_HDR_TonemapType
+  float    brightness        = 1.0f;        // 1.0 = 100 %
+  float    content_max_nits  = 80.0f;
+  float    display_max_nits  = 80.0f;
+  bool     hdr_display       = true;        // SDR displays always map content to 1.5x SDR white
+
+  float    gamut_hue [6][4]  = {
+    { 1.0f, 1.0f, 1.0f, 1.0f }, // Rec. 709  (White)
+    { 0.0f, 1.0f, 1.0f, 1.0f }, // DCI-P3    (Cyan)
+    { 0.0f, 1.0f, 0.0f, 1.0f }, // Rec. 2020 (Green)
+    { 1.0f, 1.0f, 0.0f, 1.0f }, // AP1       (Yellow)
+    { 1.0f, 0.0f, 1.0f, 1.0f }, // AP0       (Magenta)
+    { 1.0f, 0.0f, 0.0f, 1.0f }  // Undefined (Red)
+  };
+};
+
+// Filters of SKIV_Image_Resample (); UNORM images are filtered in linear light
+enum SKIV_ResampleFilter {
+  SKIV_ResampleFilter_Area     = 0, // Exact pixel coverage, no ringing
+  SKIV_ResampleFilter_Triangle = 1,
+  SKIV_ResampleFilter_Mitchell = 2, // Mitchell-Netravali, B = C = 1/3
+  SKIV_ResampleFilter_Lanczos3 = 3
+};
+
+// Speed / quality presets of the BC6H and BC7 encoders
+enum SKIV_BCQuality {
+  SKIV_BCQuality_Fast   = 0, // Single mode, no partitions
+  SKIV_BCQuality_Normal = 1,
+  SKIV_BCQuality_Best   = 2
+};
+
+// Half-float conversion paths of SKIV_Image_PackFP32toFP16 / UnpackFP16toFP32
+enum SKIV_FP16Kernel {
+  SKIV_FP16Kernel_Scalar = 0,
+  SKIV_FP16Kernel_F16C   = 1,
+  SKIV_FP16Kernel_AVX512 = 2  // AVX-512F, tails go through F16C
+};
+
 // Declarations
 DirectX::XMVECTOR SKIV_Image_PQToLinear    (DirectX::XMVECTOR N, DirectX::XMVECTOR maxPQValue = DirectX::g_XMOne);
 DirectX::XMVECTOR SKIV_Image_LinearToPQ    (DirectX::XMVECTOR N, DirectX::XMVECTOR maxPQValue = DirectX::g_XMOne);
@@ -131,6 +205,102 @@ HRESULT SKIV_Image_SaveToDisk_SDR  (const DirectX::Image& image, const wchar_t*
 HRESULT SKIV_Image_CaptureDesktop  (DirectX::ScratchImage& image, POINT pos, int flags = 0x0);
 void    SKIV_Image_CaptureRegion   (ImRect capture_area);
 HRESULT SKIV_Image_TonemapToSDR    (const DirectX::Image& image, DirectX::ScratchImage& final_sdr, float mastering_max_nits, float mastering_sdr_nits);
+bool    SKIV_HDR_ConvertImageToPNG (const DirectX::Image& raw_hdr_img, DirectX::ScratchImage& png_img);
+void    SKIV_HDR_GetContentLightLevels
+                                   (const DirectX::Image& img, float& max_cll, float& max_fall);
+
+// Pixel kernels (image_kernels.cpp)
+skiv_image_gamut_s::pixel_samples_s
+        SKIV_Image_ClassifyGamut   (const DirectX::Image& image);
+skiv_image_light_s
+        SKIV_Image_MeasureLight    (const DirectX::Image& image);
+void    SKIV_Image_PackFP32toFP16  (const float*    src, uint16_t* dst, size_t count);
+void    SKIV_Image_UnpackFP16toFP32(const uint16_t* src, float*    dst, size_t count);
+
+// The fastest path the CPU supports is picked on first use; forcing another one
+//   (returns false if the CPU lacks it) lets the tests compare every path
+SKIV_FP16Kernel
+        SKIV_Image_GetFP16Kernel   (void);
+bool    SKIV_Image_SetFP16Kernel   (SKIV_FP16Kernel kernel);
+
+HRESULT SKIV_Image_Convert         (const DirectX::Image& image, DXGI_FORMAT format, DirectX::TEX_FILTER_FLAGS filter, float threshold, DirectX::ScratchImage& result);
+HRESULT SKIV_Image_GenerateMipMaps (const DirectX::Image& image, DirectX::ScratchImage& result);
+HRESULT SKIV_Image_ApplyVisualization
+                                   (const DirectX::Image& image, const skiv_hdr_visualization_s& params, DirectX::ScratchImage& result);
+HRESULT SKIV_Image_AccumulateCIE1931
+                                   (const DirectX::Image& image, DirectX::ScratchImage& coverage);
+HRESULT SKIV_Image_Resample        (const DirectX::Image& image, size_t width, size_t height, SKIV_ResampleFilter filter, DirectX::ScratchImage& result);
+
+// Scales by percent (at most 100) and fits within max_width x max_height (0 = unbounded);
+//   returns S_FALSE, leaving result untouched, if the image already fits.
+HRESULT SKIV_Image_ResizeForExport (const DirectX::Image& image, float percent, size_t max_width, size_t max_height, DirectX::ScratchImage& result);
+
+// Size SKIV_Image_ResizeForExport produces for a width x height image
+void    SKIV_Image_GetExportSize   (size_t width, size_t height, float percent, size_t max_width, size_t max_height,
+                                    size_t& export_width, size_t& export_height);
+
+// Export size requested by a batch conversion, passed to the decoders so that
+//   they can decode straight to a smaller size when they support it
+struct skiv_export_size_s {
+  float  percent    = 100.0f;
+  size_t max_width  = 0;
+  size_t max_height = 0;
+};
+
+// Crops rect (clipped to the image), rotates it clockwise and converts it to
+//   format in a single pass; supports copies within a format, 8-bit sRGB <-> FP16
+//     scRGB and FP16 scRGB -> HDR10 (R10G10B10A2).
+HRESULT SKIV_Image_CropRotate      (const DirectX::Image& image, const DirectX::Rect& rect, DXGI_MODE_ROTATION rotation, DXGI_FORMAT format, DirectX::ScratchImage& result);
+
+// Coding-independent code points (ITU-T H.273) of a decoded signal, as signaled
+//   by AVIF (nclx), JPEG XL and PNG (cICP)
+struct skiv_cicp_s {
+  uint8_t primaries     =  1;      // 1 = BT.709, 5 / 6 = BT.601, 9 = BT.2020, 11 = DCI-P3, 12 = Display P3
+  uint8_t transfer_func = 13;      // 1 / 6 / 14 / 15 = BT.709, 4 / 5 = Gamma 2.2 / 2.8, 8 = Linear, 13 = sRGB, 16 = PQ, 18 = HLG
+  float   hlg_peak_nits = 1000.0f; // Nominal peak luminance of the display HLG's OOTF targets
+  float   linear_scale  = 1.0f;    // scRGB value of 1.0 in a linear signal
+};
+
+// RGBA8 / RGBA16 UNORM, FP16 or FP32 holding the encoded signal to FP16 scRGB in
+//   a single pass; wcg is set if any pixel falls outside of Rec. 709, hdr if any
+//     is brighter than SDR white. Unspecified or unsupported code points decode
+//       as sRGB.
+HRESULT SKIV_Image_DecodeCICP      (const DirectX::Image& image, const skiv_cicp_s& cicp, DirectX::ScratchImage& result, bool& wcg, bool& hdr);
+
+// Block-compressed textures (image_bc.cpp)
+//
+//   BC1 - BC3 and BC7 decode to R8G8B8A8 (UNORM or UNORM_SRGB), BC4 / BC5 to
+//     R8G8B8A8 with the missing channels zeroed (SNORM stays SNORM), and BC6H
+//       to R16G16B16A16_FLOAT.
+bool    SKIV_Image_IsBCDecodable   (DXGI_FORMAT format);
+HRESULT SKIV_Image_DecompressBC    (const DirectX::Image& image, DirectX::ScratchImage& result);
+
+// BC7 (UNORM or UNORM_SRGB) is encoded from R8G8B8A8 as stored, BC6H (UF16 or
+//   SF16) from R16G16B16A16_FLOAT; other inputs are converted first. SaveToDDS
+//     picks BC6H for floating-point images (signed only if needed) and BC7_SRGB
+//       otherwise, optionally with a full mip chain.
+HRESULT SKIV_Image_CompressBC      (const DirectX::Image& image, DXGI_FORMAT format, SKIV_BCQuality quality, DirectX::ScratchImage& result);
+HRESULT SKIV_Image_SaveToDDS       (const DirectX::Image& image, const wchar_t* wszFileName, SKIV_BCQuality quality, bool mipmaps);
+
+// Radiance RGBE (image_radiance.cpp)
+//
+//   .hdr files (new-style and old-style RLE, or flat) decode to scRGB FP16, with
+//     anything brighter than FP16 clamped; rotated layouts and XYZE are left to
+//       DirectXTex (E_NOTIMPL). FP16 and FP32 images encode with new-style RLE.
+HRESULT SKIV_Image_LoadRadiance    (const void* data, size_t size, DirectX::ScratchImage& result);
+HRESULT SKIV_Image_SaveRadiance    (const DirectX::Image& image, DirectX::Blob& blob);
+HRESULT SKIV_Image_SaveRadianceToFile
+                                   (const DirectX::Image& image, const wchar_t* wszFileName);
+
+// Baseline JPEG (image_jpeg.cpp)
+//
+//   Sequential Huffman-coded 8-bit gray, YCbCr and RGB decode to R8G8B8A8 or
+//     B8G8R8A8 / B8G8R8X8 (UNORM or UNORM_SRGB) at 1/scale of the size (1, 2, 4
+//       or 8); progressive, arithmetic-coded, 12-bit and CMYK files return
+//         E_NOTIMPL and are left to stbi.
+bool    SKIV_Image_GetJPEGInfo     (const void* data, size_t size, size_t& width, size_t& height, int& channels);
+int     SKIV_Image_GetJPEGScale    (size_t width, size_t height, size_t min_width, size_t min_height);
+HRESULT SKIV_Image_LoadJPEG        (const void* data, size_t size, int scale, DXGI_FORMAT format, DirectX::ScratchImage& result);
 
 bool    SKIV_Image_IsUltraHDR      (const wchar_t* wszFileName);
 bool    SKIV_Image_IsUltraHDR      (void* data, int size);
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <utility/image.h>
+#include <DirectXTex.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// On-disk cache of decoded images (opt-in, capped by "Decoded Image Cache Cap")
+//
+//   Images that took a while to decode are stored under skiv_temp\cache\ as the
+//     final texture payload plus the statistics computed on load, split into
+//       chunks compressed with XPRESS (Windows Compression API) in parallel.
+//         Reopening one maps the entry and decompresses the chunks in parallel
+//           straight into the image instead of decoding the file again.
+//
+//   Entries are keyed by the normalized path of the file, and only served if its
+//     size and last write time still match, or its SHA-256 if only the time
+//       changed. The least recently used entries are evicted once the cache
+//         grows past its cap.
+
+// Images that decode faster than this are not worth caching
+constexpr DWORD SKIV_IMAGE_CACHE_MIN_DECODE_MS = 150;
+
+// Everything the viewer computes on load besides the pixels
+struct skiv_image_cache_info_s {
+  int                                 bpc          = 0;
+  int                                 channels     = 0;
+  bool                                is_hdr       = false;
+  bool                                is_dds       = false;
+  bool                                light_is_hdr = false;
+  float                               max_cll      = 0.0f;
+  char                                max_cll_name =  '?';
+  float                               max_nits     = 0.0f;
+  float                               min_nits     = 0.0f;
+  float                               avg_nits     = 0.0f;
+  float                               p99_nits     = 0.0f;
+  skiv_image_gamut_s::pixel_samples_s pixel_counts = { };
+};
+
+struct skiv_image_cache_stats_s {
+  uint64_t bytes   = 0; // On disk
+  uint64_t entries = 0;
+  uint64_t hits    = 0;
+  uint64_t misses  = 0;
+  uint64_t stores  = 0;
+};
+
+bool SKIV_ImageCache_IsEnabled (void);
+
+// Fails for anything not in the cache, or that changed since it was stored
+bool SKIV_ImageCache_Load      (const std::wstring& path, DirectX::ScratchImage& result, skiv_image_cache_info_s& info);
+
+// Compresses and writes the image on a background thread; single 2D images only
+void SKIV_ImageCache_Store     (const std::wstring& path, std::shared_ptr <DirectX::ScratchImage> pixels, const skiv_image_cache_info_s& info);
+
+// Evicts down to the current cap
+void SKIV_ImageCache_Trim      (void);
+void SKIV_ImageCache_Clear     (void);
+skiv_image_cache_stats_s
+     SKIV_ImageCache_GetStats  (void);
+
+// A single entry file made from the file at path, as used by the functions above
+bool SKIV_ImageCache_ReadEntry  (const std::wstring& entry_path, const std::wstring& path, DirectX::ScratchImage& result, skiv_image_cache_info_s& info);
+bool SKIV_ImageCache_WriteEntry (const std::wstring& entry_path, const std::wstring& path, const DirectX::Image& image, const skiv_image_cache_info_s& info);
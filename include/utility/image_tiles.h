@@ -0,0 +1,79 @@
+#pragma once
+
+#include <DirectXTex.h>
+#include <atlbase.h>
+#include <d3d11.h>
+#include <vector>
+
+// Images beyond the maximum texture dimension, or too large for the video memory
+//   that is left, cannot be held in a single D3D11 texture; they are split into
+//     fixed-size tiles that are only uploaded to the GPU while visible, with a
+//       downscaled overview texture drawn underneath.
+//
+//   The tiles are views into the decoded image, which the tiled image takes
+//     over, so tiling never holds a second copy of the pixels.
+constexpr size_t SKIV_TILED_IMAGE_MAX_DIMENSION = D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION;
+constexpr size_t SKIV_TILE_SIZE                 = 2048;
+constexpr size_t SKIV_TILE_PREVIEW_SIZE         = 4096;                 // Longest edge of the overview
+constexpr size_t SKIV_TILE_BUDGET               = 1024ULL * 1024 * 1024; // Resident tile VRAM, in bytes, at most
+constexpr size_t SKIV_TILE_UPLOADS_PER_FRAME    = 2;
+
+struct skiv_image_tile_s {
+  size_t                x         = 0; // Position in the full image, in pixels
+  size_t                y         = 0;
+  size_t                width     = 0;
+  size_t                height    = 0;
+  DirectX::Image        pixels    = { }; // Points into skiv_tiled_image_s::image
+  uint64_t              last_used = 0;   // Frame the tile was last visible in
+
+  CComPtr <ID3D11ShaderResourceView> pSRV;
+};
+
+struct skiv_tiled_image_s {
+  size_t      width          = 0;
+  size_t      height         = 0;
+  size_t      tile_size      = 0;
+  size_t      columns        = 0;
+  size_t      rows           = 0;
+  size_t      preview_width  = 0;
+  size_t      preview_height = 0;
+  size_t      resident_bytes = 0;
+  size_t      budget         = SKIV_TILE_BUDGET; // Resident tile VRAM, in bytes
+  uint64_t    frame          = 0;
+  DXGI_FORMAT format         = DXGI_FORMAT_UNKNOWN;
+
+  DirectX::ScratchImage           image; // The full image
+  std::vector <skiv_image_tile_s> tiles;
+
+  // texture_bytes is the size of the image as a texture (with its mipmaps) and
+  //   video_memory what is left of the GPU's budget, 0 if unknown; a texture may
+  //     take at most half of it, the previous image stays on screen meanwhile.
+  static bool IsRequired (size_t image_width, size_t image_height, size_t texture_bytes = 0, size_t video_memory = 0)
+  {
+    return image_width  > SKIV_TILED_IMAGE_MAX_DIMENSION ||
+           image_height > SKIV_TILED_IMAGE_MAX_DIMENSION ||
+          (video_memory != 0 && texture_bytes > video_memory / 2);
+  }
+
+  // Takes over the image and splits it into tiles, without copying any pixels
+  HRESULT Create        (DirectX::ScratchImage&& source, size_t size = SKIV_TILE_SIZE);
+
+  // Downscales the image into a single overview of at most max_dimension pixels
+  HRESULT CreatePreview (DirectX::ScratchImage& preview, size_t max_dimension = SKIV_TILE_PREVIEW_SIZE);
+
+  // Marks the tiles that intersect the given region (in image pixels) as visible,
+  //   uploads up to SKIV_TILE_UPLOADS_PER_FRAME of those that are not resident
+  //     yet and evicts the least recently visible tiles beyond the budget.
+  void    UpdateResidency (ID3D11Device* pDevice, float x0, float y0, float x1, float y1);
+
+  bool    IsVisible       (const skiv_image_tile_s& tile) const { return tile.last_used == frame && tile.pSRV.p != nullptr; }
+
+  // Hands the GPU textures to SKIF_ResourcesToFree, they may still be referenced by the current frame
+  void    ReleaseTextures (void);
+
+  skiv_tiled_image_s (void) = default;
+ ~skiv_tiled_image_s (void) { ReleaseTextures ( ); }
+
+  skiv_tiled_image_s (skiv_tiled_image_s const&) = delete;
+  skiv_tiled_image_s (skiv_tiled_image_s&&)      = delete;
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <plog/Log.h>
+#include <Windows.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Asynchronous log file appender
+//
+//   Records are copied into a fixed-size ring by the logging thread and nothing
+//     else; formatting (including the stripping of personal data) and the file
+//       writes happen in batches on a low-priority flusher thread. Producers
+//         never block: a record that finds the ring full is counted as dropped,
+//           and the count is written to the log on the next flush.
+//
+//   Fatal records, and any call to flush (), drain the ring synchronously on
+//     the calling thread, so that whatever led up to a crash is on disk before
+//       the process goes away.
+//
+//   The file is truncated once it grows past max_file_size, the same as a
+//     plog::RollingFileAppender keeping a single file.
+class SKIV_AsyncLogAppender : public plog::IAppender
+{
+public:
+  SKIV_AsyncLogAppender (const wchar_t* path, size_t max_file_size, size_t capacity = 8192); // capacity: power of two
+ ~SKIV_AsyncLogAppender (void);
+
+  void     write   (const plog::Record& record) override;
+
+  // Returns false if the flusher could not be waited on (crash handlers only wait briefly)
+  bool     flush   (void);
+
+  uint64_t dropped (void) const { return records_dropped.load (); }
+  uint64_t written (void) const { return records_written.load (); }
+
+private:
+  struct entry_s {
+    plog::util::Time    time     = { };
+    plog::Severity      severity = plog::none;
+    unsigned int        tid      = 0;
+    size_t              line     = 0;
+    std::string         func;
+    plog::util::nstring message;
+  };
+
+  // Bounded MPSC queue (D. Vyukov): a slot is free for position pos while its
+  //   sequence equals pos, and holds a record for the consumer at pos + 1
+  struct slot_s {
+    std::atomic <size_t> sequence;
+    entry_s              entry;
+  };
+
+  void   drain   (void); // Consumer side, flush_lock held
+  void   flusher (void);
+
+  std::unique_ptr <slot_s []> slots;
+  const size_t                mask;
+
+  alignas (64)
+  std::atomic <size_t>        enqueue_pos     = 0;
+  alignas (64)
+  size_t                      dequeue_pos     = 0;  // Guarded by flush_lock
+  std::timed_mutex            flush_lock;
+
+  std::atomic <uint64_t>      records_dropped = 0;
+  std::atomic <uint64_t>      records_written = 0;
+  uint64_t                    dropped_logged  = 0;  // Guarded by flush_lock
+
+  std::wstring                file_path;
+  HANDLE                      file            = INVALID_HANDLE_VALUE;
+  size_t                      file_size       = 0;
+  const size_t                max_size;
+  std::string                 batch;                // UTF-8, reused between flushes
+
+  HANDLE                      wake            = nullptr;
+  std::atomic <bool>          stopping        = false;
+  std::thread                 thread;
+};
@@ -18,32 +18,39 @@ namespace plog
     }
 
     static util::nstring format(const Record& record)
+    {
+      return format(record.getTime(), record.getSeverity(), record.getTid(), record.getLine(), record.getFunc(), record.getMessage());
+    }
+
+    // Also used by SKIV_AsyncLogAppender, which captures the fields of a record
+    //   and formats them later on its flusher thread
+    static util::nstring format(const util::Time& time, Severity severity, unsigned int tid, size_t line, const char* func, const util::nchar* message)
     {
       tm t;
-      useUtcTime ? util::gmtime_s   (&t, &record.getTime().time)
-                 : util::localtime_s(&t, &record.getTime().time);
+      useUtcTime ? util::gmtime_s   (&t, &time.time)
+                 : util::localtime_s(&t, &time.time);
 
       util::nostringstream ss;
       // YYYY-MM-DD
       ss << t.tm_year + 1900 << PLOG_NSTR('-') << std::setfill(PLOG_NSTR('0')) << std::setw(2) << t.tm_mon + 1 << PLOG_NSTR('-') << std::setfill(PLOG_NSTR('0')) << std::setw(2) << t.tm_mday << PLOG_NSTR(' ');
 
       // HH:mm:ss:m
-      ss << std::setfill(PLOG_NSTR('0')) << std::setw(2) << t.tm_hour << PLOG_NSTR(':') << std::setfill(PLOG_NSTR('0')) << std::setw(2) << t.tm_min << PLOG_NSTR(':') << std::setfill(PLOG_NSTR('0')) << std::setw(2) << t.tm_sec << PLOG_NSTR('.') << std::setfill(PLOG_NSTR('0')) << std::setw(3) << static_cast<int> (record.getTime().millitm) << PLOG_NSTR(' ');
+      ss << std::setfill(PLOG_NSTR('0')) << std::setw(2) << t.tm_hour << PLOG_NSTR(':') << std::setfill(PLOG_NSTR('0')) << std::setw(2) << t.tm_min << PLOG_NSTR(':') << std::setfill(PLOG_NSTR('0')) << std::setw(2) << t.tm_sec << PLOG_NSTR('.') << std::setfill(PLOG_NSTR('0')) << std::setw(3) << static_cast<int> (time.millitm) << PLOG_NSTR(' ');
 
       // Severity
-      ss << std::setfill(PLOG_NSTR(' ')) << std::setw(5) << std::left << severityToString(record.getSeverity()) << PLOG_NSTR(' ');
+      ss << std::setfill(PLOG_NSTR(' ')) << std::setw(5) << std::left << severityToString(severity) << PLOG_NSTR(' ');
 
       // Thread ID
-      ss << PLOG_NSTR('[') << std::setfill(PLOG_NSTR(' ')) << std::setw(5) << std::right << record.getTid()  << PLOG_NSTR("] ");
+      ss << PLOG_NSTR('[') << std::setfill(PLOG_NSTR(' ')) << std::setw(5) << std::right << tid  << PLOG_NSTR("] ");
 
       // Line + Function
       util::nostringstream ssFuncName;
-      ssFuncName << record.getFunc() << PLOG_NSTR("] ");
+      ssFuncName << func << PLOG_NSTR("] ");
 
-      ss << PLOG_NSTR("[@") << std::setfill(PLOG_NSTR(' ')) << std::setw(5) << std::left << record.getLine() << PLOG_NSTR("] [") << std::setfill(PLOG_NSTR(' ')) << std::setw(50) << std::left << ssFuncName.str();
+      ss << PLOG_NSTR("[@") << std::setfill(PLOG_NSTR(' ')) << std::setw(5) << std::left << line << PLOG_NSTR("] [") << std::setfill(PLOG_NSTR(' ')) << std::setw(50) << std::left << ssFuncName.str();
 
       // Message (stripped out of any personal data)
-      ss << SKIF_Util_StripPersonalData (record.getMessage()) << PLOG_NSTR('\n');
+      ss << SKIF_Util_StripPersonalData (message) << PLOG_NSTR('\n');
 
       return ss.str();
     }
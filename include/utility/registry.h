@@ -265,6 +265,10 @@ struct SKIF_RegistrySettings {
     SKIF_MakeRegKeyB ( LR"(SOFTWARE\Kaldaien\Special K\Viewer\)",
                          LR"(99th Percentile MaxCLL)" );
 
+  KeyValue <bool> regKVBufferPoolLargePages =
+    SKIF_MakeRegKeyB ( LR"(SOFTWARE\Kaldaien\Special K\Viewer\)",
+                         LR"(Buffer Pool Large Pages)" );
+
   // Integers (DWORDs)
 
   KeyValue <int> regKVImageScaling =
@@ -311,6 +315,18 @@ struct SKIF_RegistrySettings {
     SKIF_MakeRegKeyI ( LR"(SOFTWARE\Kaldaien\Special K\Viewer\)",
                          LR"(Diagnostics)" );
 
+  KeyValue <int> regKVBufferPoolCap =
+    SKIF_MakeRegKeyI ( LR"(SOFTWARE\Kaldaien\Special K\Viewer\)",
+                         LR"(Buffer Pool Cap)" );
+
+  KeyValue <int> regKVImageCacheCap =
+    SKIF_MakeRegKeyI ( LR"(SOFTWARE\Kaldaien\Special K\Viewer\)",
+                         LR"(Decoded Image Cache Cap)" );
+
+  KeyValue <int> regKVExportSize =
+    SKIF_MakeRegKeyI ( LR"(SOFTWARE\Kaldaien\Special K\Viewer\)",
+                         LR"(Export Size)" );
+
   KeyValue <int> regKVAVIFQuality =
     SKIF_MakeRegKeyI ( LR"(SOFTWARE\Kaldaien\Special K\Viewer\AVIF\)",
                          LR"(Quality)" );
@@ -343,6 +359,14 @@ struct SKIF_RegistrySettings {
     SKIF_MakeRegKeyI ( LR"(SOFTWARE\Kaldaien\Special K\Viewer\PNG\)",
                          LR"(HDR BitDepth)" );
 
+  KeyValue <int> regKVDDSQuality =
+    SKIF_MakeRegKeyI ( LR"(SOFTWARE\Kaldaien\Special K\Viewer\DDS\)",
+                         LR"(Quality)" );
+
+  KeyValue <bool> regKVDDSMipmaps =
+    SKIF_MakeRegKeyB ( LR"(SOFTWARE\Kaldaien\Special K\Viewer\DDS\)",
+                         LR"(Mipmaps)" );
+
   // Wide Strings
 
   KeyValue <std::wstring> regKVIgnoreUpdate =
@@ -423,6 +447,9 @@ struct SKIF_RegistrySettings {
   int iHDRToneMapType          = 8;   // 0 = Do Nothing,                  1 = Clip Luminance,         8 = Map to Display
   int iUIMode                  = 1;   // 0 = Safe Mode (BitBlt),          1 = Normal,                 2 = VRR Compatibility
   int iDiagnostics             = 1;   // 0 = None,                        1 = Normal,                 2 = Enhanced (not actually used yet)
+  int iBufferPoolCap           = 256; // MiB of released image buffers kept committed for re-use (0 = disabled)
+  int iImageCacheCap           = 0;   // MiB of decoded images cached on disk for faster reopening (0 = disabled)
+  int iExportSize              = 0;   // 0 = Original,                    1 = 75 %,                   2 = 50 %,                        3 = 25 %,                           4 = Fit 3840x2160, 5 = Fit 2560x1440, 6 = Fit 1920x1080
 
   // Default settings (booleans)
   bool bAdjustWindow            = false; // Adjust window size based on the image size?
@@ -437,6 +464,7 @@ struct SKIF_RegistrySettings {
   bool bTouchInput              =  true; // Automatically make the UI more optimized for touch input on capable devices
   bool bImageDetails            = false;
   bool b99thPercentileMaxCLL    =  true;
+  bool bBufferPoolLargePages    = false; // Back pooled image buffers with large pages (requires SeLockMemoryPrivilege)
 
   bool bFirstLaunch             = false;
   bool bCloseToTray             = false;
@@ -487,6 +515,12 @@ struct SKIF_RegistrySettings {
     int     hdr_bitdepth = 16;
   } png;
 
+  struct {
+    CRegKey key;
+    int     quality      = 1;    // SKIV_BCQuality
+    bool    mipmaps      = true;
+  } dds;
+
   // Windows stuff
   std::wstring wsAppRegistration;
   int  iNotificationsDuration       = 5; // Defaults to 5 seconds in case Windows is not set to something else
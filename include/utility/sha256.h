@@ -0,0 +1,38 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+// Incremental SHA-256 (FIPS 180-4)
+//
+//   Data can be fed in chunks of any size as it arrives, e.g. straight from a
+//     download. Blocks are compressed with the SHA extensions where the CPU has
+//       them (Intel Goldmont / Ice Lake and later, AMD Zen), and with a portable
+//         implementation otherwise.
+struct skiv_sha256_s {
+  skiv_sha256_s (void);
+
+  void                     update     (const void* data, size_t size);
+
+  // The hasher has to be reset before it is fed again
+  std::array <uint8_t, 32> finish     (void);
+  std::string              finish_hex (void); // Lowercase
+  void                     reset      (void);
+
+private:
+  uint32_t state  [8];
+  uint8_t  buffer [64];
+  size_t   buffered = 0;
+  uint64_t length   = 0; // Bytes
+};
+
+// Hashes a file in chunks; returns an empty string if it could not be read
+std::string SKIV_SHA256_HashFile          (const std::wstring& path);
+
+// "SHA-NI" or "Scalar"
+const char* SKIV_SHA256_GetImplementation (void);
+
+// Forces the portable implementation, or the SHA extensions if the CPU has
+//   them (returns false otherwise); lets the tests cover both paths
+bool        SKIV_SHA256_SetImplementation (bool shani);
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Streaming ingest of downloaded images
+//
+//   A download registers a stream under the path of the file it is writing and
+//     appends every chunk to it as it arrives, while the file itself is written
+//       alongside. The image worker looks the path up before opening the file:
+//         the JPEG XL decoder consumes the stream while the transfer is still
+//           running, the other decoders (PNG and progressive JPEG included)
+//             wait for it to end and read the file. The image is only shown
+//               once it is fully decoded.
+//
+//   A stream is unregistered once its file has been completely written, so a
+//     path without a stream is always safe to read from disk.
+struct skiv_stream_s {
+  // Called by the download
+  void   write     (const void* data, size_t size);
+  void   finish    (bool success);
+
+  // Appends up to max_size of the bytes past offset to out, blocking until there
+  //   are any; returns how many were appended, 0 once the stream has ended
+  size_t read      (size_t offset, std::vector <uint8_t>& out, size_t max_size = SIZE_MAX);
+
+  // Blocks until at least size bytes arrived or the stream ended;
+  //   returns the number of bytes available
+  size_t wait      (size_t size = SIZE_MAX);
+
+  bool   ended     (void);
+  bool   succeeded (void);
+
+private:
+  std::mutex              lock;
+  std::condition_variable grown;
+  std::vector <uint8_t>   data;
+  bool                    done    = false;
+  bool                    success = false;
+};
+
+// Downloads url (http or https) to destination, writing every chunk to the file
+//   and to stream (if any) as it arrives, then passing it to on_data; the stream
+//     is finished either way, and a failed download leaves no file behind.
+bool                            SKIV_Stream_Download   (const std::wstring& url, const std::wstring& destination, skiv_stream_s* stream,
+                                                        const std::function <void (const void* data, size_t size)>& on_data = nullptr);
+
+std::shared_ptr <skiv_stream_s> SKIV_Stream_Register   (const std::wstring& path);
+std::shared_ptr <skiv_stream_s> SKIV_Stream_Find       (const std::wstring& path);
+void                            SKIV_Stream_Unregister (const std::wstring& path);
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+
+// Chrome trace event recorder (load the output in chrome://tracing or ui.perfetto.dev)
+//
+//   Spans and counters are always compiled in; while no trace is being
+//     recorded each one costs a single relaxed atomic load. Names must be
+//       string literals, only the pointer is kept until the trace is written.
+//
+//   Only the standard library is used, so the pipeline can be traced from
+//     a headless harness on any platform.
+
+extern std::atomic <bool> SKIV_Trace_Recording;
+
+void     SKIV_Trace_Start     (void);
+void     SKIV_Trace_Stop      (void);
+bool     SKIV_Trace_WriteJSON (const std::filesystem::path& path); // Writes and discards all recorded events
+uint64_t SKIV_Trace_Now       (void);                              // Microseconds on the steady clock
+void     SKIV_Trace_Span      (const char* name, uint64_t begin, uint64_t end);
+void     SKIV_Trace_Counter   (const char* name, double   value);
+
+inline bool
+SKIV_Trace_IsRecording (void)
+{
+  return
+    SKIV_Trace_Recording.load (std::memory_order_relaxed);
+}
+
+class SKIV_TraceScope
+{
+public:
+  explicit SKIV_TraceScope (const char* span_name) : name   (span_name),
+                                                     active (SKIV_Trace_IsRecording ( ))
+  {
+    if (active)
+      begin = SKIV_Trace_Now ( );
+  }
+
+  ~SKIV_TraceScope (void) { End ( ); }
+
+  // Closes the span before the end of the enclosing scope
+  void End (void)
+  {
+    if (active)
+    {
+      active = false;
+      SKIV_Trace_Span (name, begin, SKIV_Trace_Now ( ));
+    }
+  }
+
+  SKIV_TraceScope (SKIV_TraceScope const&) = delete;
+
+private:
+  const char* name;
+  uint64_t    begin = 0;
+  bool        active;
+};
+
+#define SKIV_TRACE_CONCAT_(a,b) a##b
+#define SKIV_TRACE_CONCAT(a,b)  SKIV_TRACE_CONCAT_(a,b)
+#define SKIV_TRACE_SCOPE(name)  SKIV_TraceScope SKIV_TRACE_CONCAT(_trace_scope_, __LINE__) (name)
@@ -20,8 +20,6 @@
 // DEALINGS IN THE SOFTWARE.
 //
 
-RWTexture2D <float4> texGamutCoverage : register (u1);
-
 static const uint SKIV_VISUALIZATION_NONE    = 0;
 static const uint SKIV_VISUALIZATION_HEATMAP = 1;
 static const uint SKIV_VISUALIZATION_GAMUT   = 2;
@@ -31,30 +29,9 @@ static const uint SKIV_VIZ_FLAG_SDR_CONSIDER_LUMINANCE  = 0x1;
 static const uint SKIV_VIZ_FLAG_SDR_CONSIDER_GAMUT      = 0x2;
 static const uint SKIV_VIZ_FLAG_SDR_CONSIDER_OVERBRIGHT = 0x4;
 
-void UpdateCIE1931 (float4 hdr_color)
-{
-  float3 XYZ = Rec709toXYZ (hdr_color.rgb);
-  float  xyz = XYZ.x + XYZ.y + XYZ.z;
-
-  float4 normalized_color =
-    float4 (hdr_color.rgb / xyz, 1.0);
-
-  if (all (Rec709toAP1_D65 (hdr_color.rgb) >= FP16_MIN))
-  {
-    texGamutCoverage [ uint2 (        1024 * XYZ.x / xyz,
-                               1024 - 1024 * XYZ.y / xyz ) ].rgba =
-      float4 (normalized_color.rgb * 2.0f, 1.0f);
-  }
-}
-
 // HDR Color Input is Linear Rec 709 (scRGB)
 float4 ApplyHDRVisualization (uint type, float4 hdr_color, bool post_tonemap)
 {
-  // Ideally this remains constant with changes in luminance, but
-  //   let's test that theory :)
-  if (        post_tonemap  && type != SKIV_VISUALIZATION_GAMUT) UpdateCIE1931 (hdr_color);
-  else if ((! post_tonemap) && type == SKIV_VISUALIZATION_GAMUT) UpdateCIE1931 (hdr_color);
-
   switch (type)
   {
     case SKIV_VISUALIZATION_SDR:
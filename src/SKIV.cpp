@@ -34,6 +34,7 @@
 #include "plog/Appenders/ConsoleAppender.h"
 #include "plog/Appenders/DebugOutputAppender.h"
 #include <utility/plog_formatter.h>
+#include <utility/plog_async.h>
 
 #include <utility/utility.h>
 #include <utility/skif_imgui.h>
@@ -78,6 +79,9 @@
 #include <netlistmgr.h>
 #include <html_coder.hpp>
 #include <utility/image.h>
+#include <utility/benchmark.h>
+#include <utility/batch.h>
+#include <utility/export.h>
 
 const int SKIF_STEAM_APPID      = 1157970;
 bool  RecreateSwapChains        = false;
@@ -109,6 +113,30 @@ DWORD SKIF_startupTime          = 0; // Used as a basis of how long the initiali
 DWORD SKIF_firstFrameTime       = 0; // Used as a basis of how long the initialization took
 HANDLE SteamProcessHandle       = NULL;
 
+// The log file, written by a background thread; anything still queued has to
+//   be flushed before the process is terminated.
+SKIV_AsyncLogAppender* SKIV_LogFile = nullptr;
+
+static void
+SKIV_Log_Flush (void)
+{
+  if (SKIV_LogFile != nullptr)
+      SKIV_LogFile->flush ();
+}
+
+static LPTOP_LEVEL_EXCEPTION_FILTER SKIV_Log_PrevExceptionFilter = nullptr;
+
+// Fatal records are written out synchronously
+static LONG WINAPI
+SKIV_Log_UnhandledExceptionFilter (EXCEPTION_POINTERS* pExceptionInfo)
+{
+  PLOG_FATAL << "Unhandled exception " << std::hex << pExceptionInfo->ExceptionRecord->ExceptionCode
+             << " at "                             << pExceptionInfo->ExceptionRecord->ExceptionAddress;
+
+  return (SKIV_Log_PrevExceptionFilter != nullptr) ? SKIV_Log_PrevExceptionFilter (pExceptionInfo)
+                                                   : EXCEPTION_CONTINUE_SEARCH;
+}
+
 // Exporting RTSSHooksCompatibility set to 0x0 prevents RTSS from drawing.
 //
 //  * If it becomes necessary to test with RTSS active, then create
@@ -270,15 +298,32 @@ SKIF_Startup_ProcessCmdLineArgs (LPWSTR lpCmdLine)
     _wcsicmp (lpCmdLine, L"/CaptureRegion") == NULL;
   _Signal.CaptureScreen = 
     _wcsicmp (lpCmdLine, L"/CaptureScreen") == NULL;
+  _Signal.Benchmark = 
+    _wcsnicmp (lpCmdLine, L"/Benchmark", 10) == NULL;
+  _Signal.Convert = 
+    _wcsnicmp (lpCmdLine, L"/Convert",    8) == NULL;
 
   if (! _Signal.Quit           &&
       ! _Signal.Minimize       &&
       ! _Signal.OpenFileDialog &&
       ! _Signal.CaptureWindow  &&
       ! _Signal.CaptureRegion  &&
-      ! _Signal.CaptureScreen)
+      ! _Signal.CaptureScreen  &&
+      ! _Signal.Benchmark      &&
+      ! _Signal.Convert)
     _Signal._FilePath = std::wstring(lpCmdLine);
 
+  // /Benchmark takes an optional path to write the results to
+  if (_Signal.Benchmark)
+  {
+    _Signal._FilePath = std::wstring(lpCmdLine + 10);
+    std::erase (_Signal._FilePath, L'"');
+  }
+
+  // /Convert keeps its arguments as-is (quoted paths with spaces), they are parsed by SKIV_Batch_Run
+  if (_Signal.Convert)
+    _Signal._FilePath = std::wstring(lpCmdLine + 8);
+
   SKIF_Util_TrimLeadingSpacesW (_Signal._FilePath);
 
   _Signal._RunningInstance =
@@ -311,7 +356,10 @@ SKIF_Startup_CopyDataRunningInstance (void)
                   WM_COPYDATA,
                   NULL, //(WPARAM)(HWND) NULL
                   (LPARAM) (LPVOID) &cds))
-      ExitProcess (0x0);
+    {
+      SKIV_Log_Flush ( );
+      ExitProcess    (0x0);
+    }
   }
 }
 
@@ -511,7 +559,8 @@ SKIF_Startup_ProxyCommandLineArguments (void)
     }
 
     PLOG_INFO << "Terminating due to this instance having done its job.";
-    ExitProcess (0x0);
+    SKIV_Log_Flush ( );
+    ExitProcess    (0x0);
   }
 }
 
@@ -535,7 +584,8 @@ SKIF_Startup_RaiseRunningInstance (void)
   SendMessage (_Signal._RunningInstance, WM_SKIF_RESTORE, 0x0, 0x0);
   
   PLOG_INFO << "Terminating due to this instance having done its job.";
-  ExitProcess (0x0);
+  SKIV_Log_Flush ( );
+  ExitProcess    (0x0);
 }
 
 void SKIF_Shell_CreateUpdateNotifyMenu (void)
@@ -891,9 +941,13 @@ void SKIF_Initialize (LPWSTR lpCmdLine)
   MoveFile   (logPath.c_str(), logPath_old.c_str());
 
   // Engage logging!
-  static plog::RollingFileAppender<plog::LogFormatterUtcTime> fileAppender(logPath.c_str(), 10000000, 1);
+  static SKIV_AsyncLogAppender fileAppender (logPath.c_str(), 10000000);
   plog::init (plog::debug, &fileAppender);
 
+  SKIV_LogFile                 = &fileAppender;
+  SKIV_Log_PrevExceptionFilter =
+    SetUnhandledExceptionFilter (SKIV_Log_UnhandledExceptionFilter);
+
   // Let us do a one-time check if a debugger is attached,
   //   and if so set up PLOG to push logs there as well
   BOOL isRemoteDebuggerPresent = FALSE;
@@ -1041,7 +1095,7 @@ wWinMain ( _In_     HINSTANCE hInstance,
   //     closing either that one or this one...
   //
   // Process cmd line arguments (3/4)
-  if (_Signal._RunningInstance)
+  if (_Signal._RunningInstance && ! _Signal.Benchmark && ! _Signal.Convert)
   {
     // NOTE: Logging hasn't been initialized at this point!
 
@@ -1075,6 +1129,19 @@ wWinMain ( _In_     HINSTANCE hInstance,
   wcsncpy_s ( _path_cache.specialk_userdata, MAX_PATH,
               _registry.wsPathSpecialK.c_str(), _TRUNCATE);
 
+  // Headless benchmark of the image pipeline; exits without creating any windows
+  if (_Signal.Benchmark)
+  {
+    if (_Signal._FilePath.empty())
+      _Signal._FilePath = SK_FormatStringW (LR"(%ws\SKIV_benchmark.json)", _path_cache.skiv_userdata);
+
+    return SKIV_Benchmark_Run (_Signal._FilePath);
+  }
+
+  // Headless batch conversion; exits without creating any windows
+  if (_Signal.Convert)
+    return SKIV_Batch_Run (_Signal._FilePath, SK_FormatStringW (LR"(%ws\SKIV_convert.json)", _path_cache.skiv_userdata));
+
   // Set process preference to E-cores using only CPU sets, :)
   //  as affinity masks are inherited by child processes... :(
   SKIF_Util_SetProcessPrefersECores ( );
@@ -3616,6 +3683,9 @@ wWinMain ( _In_     HINSTANCE hInstance,
   }
 
   PLOG_INFO << "Exited main loop...";
+
+  // Unfinished exports only ever wrote temporary files
+  SKIV_Export_Shutdown                  ( );
   
   SKIF_Util_UnregisterHotKeyCapture     (CaptureMode_Screen);
   SKIF_Util_UnregisterHotKeyCapture     (CaptureMode_Region);
@@ -3652,6 +3722,8 @@ wWinMain ( _In_     HINSTANCE hInstance,
   DeleteCriticalSection (&CriticalSectionDbgHelp);
 
   PLOG_INFO << "Exiting process with code " << SKIF_ExitCode;
+  SKIV_Log_Flush ( );
+
   return SKIF_ExitCode;
 }
 
@@ -4315,6 +4387,10 @@ SKIF_WndProc (HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
       }
       break;
 
+    case WM_SKIF_EXPORT:
+      addAdditionalFrames += 3;
+      break;
+
     case WM_SKIF_REFRESHCOVER:
       {
         addAdditionalFrames += 3;
@@ -685,16 +685,6 @@ void ImGui_ImplDX11_RenderDrawData (ImDrawData *draw_data)
   ImGui_ImplDX11_SetupRenderState (draw_data, ctx);
 
 
-  extern CComPtr <ID3D11UnorderedAccessView>
-      SKIV_HDR_GamutCoverageUAV;
-  extern CComPtr <ID3D11ShaderResourceView>
-      SKIV_HDR_GamutCoverageSRV;
-  if (SKIV_HDR_GamutCoverageUAV != nullptr)
-  {
-    FLOAT                                                          fClearColor [] = { 0.f, 0.f, 0.f, 0.f };
-    ctx->ClearUnorderedAccessViewFloat (SKIV_HDR_GamutCoverageUAV, fClearColor);
-  }
-
   // Render command lists
   // (Because we merged all buffers into a single one, we maintain our own offset into them)
   int global_idx_offset = 0;
@@ -745,37 +735,10 @@ void ImGui_ImplDX11_RenderDrawData (ImDrawData *draw_data)
         if (pcmd->TextureId == ImGui::GetIO ().Fonts->TexID)
         ctx->PSSetConstantBuffers ( 0, 1, &bd->pFontConstantBuffer );
 
-        //
-        // If GamutCoverageUAV is non-null, then the image we are
-        //   rendering to is eligible for output to the gamut texture.
-        //
-        //  The pixel shader does the actual work of determining whether
-        //    to output gamut coverage, just bind the UAV for all eligible
-        //      render passes.
-        //
-        CComPtr <ID3D11RenderTargetView> rtv;
-        ctx->OMGetRenderTargets     (1, &rtv.p, nullptr);
-
-        if (SKIV_HDR_GamutCoverageUAV.p != nullptr)
-        {
-          if (texture_srv != SKIV_HDR_GamutCoverageSRV.p)
-          {
-            // Set the PS resources first because D3D11 will refuse
-            //   to allow a UAV and SRV to the same resource to be
-            //     bound simultaneously.
-            ctx->PSSetShaderResources                      (0, 1, &texture_srv);
-            ctx->OMSetRenderTargetsAndUnorderedAccessViews (1, &rtv.p, nullptr, 1, 1, &SKIV_HDR_GamutCoverageUAV.p, nullptr);
-          }
-        }
-
         ctx->PSSetShaderResources ( 0, 1, &texture_srv);
         ctx->DrawIndexed          ( pcmd->ElemCount,
                                     pcmd->IdxOffset + global_idx_offset,
                                     pcmd->VtxOffset + global_vtx_offset );
-
-        ID3D11UnorderedAccessView* pNulUAV = nullptr;
-
-        ctx->OMSetRenderTargetsAndUnorderedAccessViews (1, &rtv.p, nullptr, 1, 1, &pNulUAV, nullptr);
       }
     }
 
@@ -985,7 +948,8 @@ static void ImGui_ImplDX11_CreateFontsTexture()
   if (FAILED (bd->pd3dDevice->CreateSamplerState (&sampler_desc, &bd->pFontSampler)))
     PLOG_ERROR << "Failed creating sampler-state object of the font sampler!";
 
-  io.Fonts->ClearTexData ();
+  // The atlas is not kept around in its input form (SKIF_ImGui_InitFonts discards the font
+  //   files once built), so the bitmap is retained to re-upload it after a device reset
 }
 
 #endif // !SKIF_D3D11
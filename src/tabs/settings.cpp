@@ -14,6 +14,10 @@
 #include <utility/registry.h>
 #include <utility/updater.h>
 #include <utility/gamepad.h>
+#include <utility/buffer_pool.h>
+#include <utility/image_cache.h>
+#include <utility/trace.h>
+#include <ImGuiNotify.hpp>
 #include "../../version.h"
 #include <tabs/common_ui.h>
 #include <set>
@@ -188,6 +192,48 @@ SKIF_UI_Tab_DrawSettings (void)
       _registry.regKVDarkenImages.putData (                        _registry.iDarkenImages);
     ImGui::TreePop         ( );
 
+    ImGui::Spacing         ( );
+
+    ImGui::TextColored     (ImGui::GetStyleColorVec4(ImGuiCol_SKIF_Info), ICON_FA_LIGHTBULB);
+    SKIF_ImGui_SetHoverTip ("Used for Save As, Export to SDR and Export Visualization.\n"
+                            "Images are only ever scaled down, never up.");
+    ImGui::SameLine        ( );
+    ImGui::TextColored (
+      ImGui::GetStyleColorVec4(ImGuiCol_SKIF_TextCaption),
+        "Export size:"
+    );
+    ImGui::TreePush        ("ExportSize");
+
+    const char* ExportSizes[] = { "Original",
+                                  "75%",
+                                  "50%",
+                                  "25%",
+                                  "Fit to 3840x2160",
+                                  "Fit to 2560x1440",
+                                  "Fit to 1920x1080" };
+    static const char* ExportSizeCurrent = ExportSizes[std::clamp (_registry.iExportSize, 0, IM_ARRAYSIZE (ExportSizes) - 1)];
+
+    if (ImGui::GetContentRegionAvail().x > 725.0f)
+      ImGui::SetNextItemWidth (500.0f);
+
+    if (ImGui::BeginCombo ("###_registry.iExportSizeCombo", ExportSizeCurrent))
+    {
+      for (int n = 0; n < IM_ARRAYSIZE (ExportSizes); n++)
+      {
+        bool is_selected = (ExportSizeCurrent == ExportSizes[n]);
+        if (ImGui::Selectable (ExportSizes[n], is_selected))
+        {
+          _registry.iExportSize = n;
+          _registry.regKVExportSize.putData (_registry.iExportSize);
+          ExportSizeCurrent = ExportSizes[_registry.iExportSize];
+        }
+        if (is_selected)
+          ImGui::SetItemDefaultFocus ( );
+      }
+      ImGui::EndCombo  ( );
+    }
+    ImGui::TreePop         ( );
+
     ImGui::PopStyleColor();
 
     // nb:  Prefernece needs implementation
@@ -970,6 +1016,111 @@ SKIF_UI_Tab_DrawSettings (void)
     SKIF_ImGui_SetHoverTip  ("Engage efficiency mode for this app when idle.\n"
                              "Not recommended for Windows 10 and earlier.");
 
+    if (_registry.bDeveloperMode)
+    {
+      static SKIV_BufferPool& _pool = SKIV_BufferPool::GetInstance ( );
+
+      SKIF_ImGui_Spacing ( );
+
+      if (ImGui::GetContentRegionAvail().x > 725.0f)
+        ImGui::SetNextItemWidth (500.0f);
+
+      if (ImGui::SliderInt ("Image buffer pool", &_registry.iBufferPoolCap, 0, 2048, "%d MiB"))
+      {
+        _registry.iBufferPoolCap = std::min (std::max (0, _registry.iBufferPoolCap), 2048);
+        _registry.regKVBufferPoolCap.putData (_registry.iBufferPoolCap);
+
+        _pool.SetCap (static_cast <size_t> (_registry.iBufferPoolCap) * 1024 * 1024);
+      }
+
+      SKIF_ImGui_SetHoverTip  ("Image buffers released after loading or saving are kept committed up to this\n"
+                               "size, so that the next image can re-use them instead of allocating anew.");
+
+      ImGui::SameLine    ( );
+
+      if (ImGui::Checkbox  ("Large pages", &_registry.bBufferPoolLargePages))
+      {
+        _registry.regKVBufferPoolLargePages.putData (_registry.bBufferPoolLargePages);
+
+        _pool.SetLargePages (_registry.bBufferPoolLargePages);
+      }
+
+      SKIF_ImGui_SetHoverTip  ("Back image buffers with large pages.\n"
+                               "Requires the 'Lock pages in memory' user right.");
+
+      const SKIV_BufferPool::stats_s stats =
+        _pool.GetStats ( );
+
+      ImGui::TextDisabled ("In use: %.1f MiB (peak: %.1f MiB), retained: %.1f MiB (peak: %.1f MiB), hits: %llu, misses: %llu%s",
+                             static_cast <double> (stats.bytes_in_use)        / (1024.0 * 1024.0),
+                             static_cast <double> (stats.bytes_in_use_peak)   / (1024.0 * 1024.0),
+                             static_cast <double> (stats.bytes_retained)      / (1024.0 * 1024.0),
+                             static_cast <double> (stats.bytes_retained_peak) / (1024.0 * 1024.0),
+                               stats.hits, stats.misses, stats.large_pages ? ", large pages" : "");
+
+      SKIF_ImGui_Spacing ( );
+
+      if (ImGui::GetContentRegionAvail().x > 725.0f)
+        ImGui::SetNextItemWidth (500.0f);
+
+      if (ImGui::SliderInt ("Decoded image cache", &_registry.iImageCacheCap, 0, 16384, "%d MiB"))
+      {
+        _registry.iImageCacheCap = std::min (std::max (0, _registry.iImageCacheCap), 16384);
+        _registry.regKVImageCacheCap.putData (_registry.iImageCacheCap);
+
+        SKIV_ImageCache_Trim ( );
+      }
+
+      SKIF_ImGui_SetHoverTip  ("Images that are slow to decode are kept in the temporary folder, compressed,\n"
+                               "so that opening them again skips the decoder (0 = disabled).");
+
+      ImGui::SameLine    ( );
+
+      if (ImGui::Button  ("Clear cache"))
+        SKIV_ImageCache_Clear ( );
+
+      const skiv_image_cache_stats_s cache_stats =
+        SKIV_ImageCache_GetStats ( );
+
+      ImGui::TextDisabled ("Cached: %.1f MiB in %llu images, hits: %llu, misses: %llu, stored: %llu",
+                             static_cast <double> (cache_stats.bytes) / (1024.0 * 1024.0),
+                               cache_stats.entries, cache_stats.hits, cache_stats.misses, cache_stats.stores);
+
+      SKIF_ImGui_Spacing ( );
+
+      static std::wstring wsPathToTrace = SK_FormatStringW (
+        LR"(%ws\SKIV_trace.json)", _path_cache.skiv_userdata
+      );
+
+      if (! SKIV_Trace_IsRecording ( ))
+      {
+        if (ImGui::Button  (ICON_FA_STOPWATCH " Start trace"))
+          SKIV_Trace_Start ( );
+
+        SKIF_ImGui_SetHoverTip  ("Records the time spent in each stage of loading and saving images.");
+      }
+
+      else
+      {
+        if (ImGui::Button  (ICON_FA_FLOPPY_DISK " Stop and save trace"))
+        {
+          SKIV_Trace_Stop ( );
+
+          if (SKIV_Trace_WriteJSON (wsPathToTrace))
+            ImGui::InsertNotification (
+              {
+                ImGuiToastType::Info,
+                5000,
+                "Trace saved", "%s",
+                SK_WideCharToUTF8 (wsPathToTrace).c_str ()
+              }
+            );
+        }
+
+        SKIF_ImGui_SetHoverTip  ("Open the saved file in chrome://tracing or ui.perfetto.dev");
+      }
+    }
+
     static std::wstring wsPathToSKDll = SK_FormatStringW (
         LR"(%ws\%ws)",
           _path_cache.specialk_userdata, // Can theoretically be wrong
@@ -32,6 +32,7 @@
 
 #include "DirectXTex.h"
 #include <wincodec.h>
+#include <dxgi1_4.h>
 #ifdef _M_X64
 #include <utility/DirectXTexEXR.h>
 #endif
@@ -57,6 +58,13 @@
 #include <utility/registry.h>
 #include <utility/updater.h>
 #include <utility/sk_utility.h>
+#include <utility/buffer_pool.h>
+#include <utility/trace.h>
+#include <utility/image_tiles.h>
+#include <utility/export.h>
+#include <utility/stream.h>
+#include <utility/image_cache.h>
+#include <utility/icc.h>
 
 #include <imgui/imgui_impl_dx11.h>
 
@@ -113,10 +121,6 @@ float    SKIV_HDR_BrightnessScale       = 100.0f;
 
 float    SKIV_HDR_MaxLuminanceP99       =  80.0f;
 
-CComPtr <ID3D11UnorderedAccessView>
-         SKIV_HDR_GamutCoverageUAV      = nullptr;
-CComPtr <ID3D11ShaderResourceView>
-         SKIV_HDR_GamutCoverageSRV      = nullptr;
 
 // Identify file type by reading the file signature
 const std::initializer_list<FileSignature> supported_formats =
@@ -155,7 +159,7 @@ const std::initializer_list<FileSignature> supported_sdr_encode_formats =
   FileSignature { L"image/bmp",                 { L".bmp"  },          { 0x42, 0x4D } },
   FileSignature { L"image/tiff",                { L".tiff", L".tif" }, { 0x49, 0x49, 0x2A, 0x00 } }, // TIFF: little-endian
   FileSignature { L"image/tiff",                { L".tiff", L".tif" }, { 0x4D, 0x4D, 0x00, 0x2A } }, // TIFF: big-endian
-//FileSignature { L"image/vnd-ms.dds",          { L".dds"  },          { 0x44, 0x44, 0x53, 0x20 } },
+  FileSignature { L"image/vnd-ms.dds",          { L".dds"  },          { 0x44, 0x44, 0x53, 0x20 } },
 //FileSignature { L"image/x-targa",             { L".tga"  },          { 0x00, } }, // TGA has no real unique header identifier, so just use the file extension on those
 };
 
@@ -170,7 +174,7 @@ const std::initializer_list<FileSignature> supported_hdr_encode_formats =
   FileSignature { L"image/jxl",                 { L".jxl"  },          { 0xFF, 0x0A } },
   FileSignature { L"image/avif",                { L".avif" },          { 0x00, 0x00, 0x00, 0x20, 0x66, 0x74, 0x79, 0x70, 0x61, 0x76, 0x69, 0x66 },   // ftypavif
                                                                        { 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF } }, // ?? ?? ?? ?? 66 74 79 70 61 76 69 66
-//FileSignature { L"image/vnd-ms.dds",          { L".dds"  },          { 0x44, 0x44, 0x53, 0x20 } },
+  FileSignature { L"image/vnd-ms.dds",          { L".dds"  },          { 0x44, 0x44, 0x53, 0x20 } },
 };
 
 bool isJXLDecoderAvailable (void)
@@ -429,6 +433,7 @@ const float fTintMin     = 0.75f;
 PopupState OpenFileDialog  = PopupState_Closed;
 PopupState SaveFileDialog  = PopupState_Closed;
 PopupState ExportSDRDialog = PopupState_Closed;
+PopupState ExportVizDialog = PopupState_Closed;
 PopupState ContextMenu     = PopupState_Closed;
 PopupState ConfigEncoders  = PopupState_Closed;
 
@@ -460,8 +465,13 @@ struct image_s {
   bool         is_dds      = false;
 
   CComPtr <ID3D11ShaderResourceView>  pRawTexSRV;
-  CComPtr <ID3D11UnorderedAccessView> pGamutCoverageUAV;
-  CComPtr <ID3D11ShaderResourceView>  pGamutCoverageSRV;
+  CComPtr <ID3D11ShaderResourceView>  pGamutCoverageSRV; // CIE 1931 plot, computed once on load
+
+  // Only set for images beyond the maximum texture dimension, pRawTexSRV then holds a downscaled overview
+  std::shared_ptr <skiv_tiled_image_s> tiles;
+
+  // The decoded image as uploaded, kept on the CPU for exports (unset for tiled images)
+  std::shared_ptr <DirectX::ScratchImage> pixels;
 
   struct light_info_s {
     float max_cll      = 0.0f;
@@ -473,24 +483,8 @@ struct image_s {
     bool  isHDR        = false;
   } light_info;
 
-  struct gamut_info_s {
-    struct pixel_samples_s {
-      uint32_t rec_709;
-      uint32_t rec_2020;
-      uint32_t dci_p3;
-      uint32_t ap1;
-      uint32_t ap0;
-      uint32_t undefined;
-      uint32_t total;
-
-      float getPercentRec709    (void) const;
-      float getPercentRec2020   (void) const;
-      float getPercentDCIP3     (void) const;
-      float getPercentAP1       (void) const;
-      float getPercentAP0       (void) const;
-      float getPercentUndefined (void) const;
-    } pixel_counts;
-  } colorimetry;
+  using gamut_info_s = skiv_image_gamut_s;
+  gamut_info_s colorimetry;
 
   // copy assignment
   image_s& operator= (const image_s other) noexcept
@@ -508,7 +502,8 @@ struct image_s {
     avail_size_cache    = other.avail_size_cache;
     pRawTexSRV.p        = other.pRawTexSRV.p;
     pGamutCoverageSRV.p = other.pGamutCoverageSRV.p;
-    pGamutCoverageUAV.p = other.pGamutCoverageUAV.p;
+    tiles               = other.tiles;
+    pixels              = other.pixels;
     is_hdr              = other.is_hdr;
     is_dds              = other.is_dds;
     light_info          = other.light_info;
@@ -531,7 +526,8 @@ struct image_s {
     avail_size_cache    = { };
     pRawTexSRV.p        = nullptr;
     pGamutCoverageSRV.p = nullptr;
-    pGamutCoverageUAV.p = nullptr;
+    tiles               = nullptr;
+    pixels              = nullptr;
     is_hdr              = false;
     is_dds              = false;
     light_info          = { };
@@ -542,6 +538,108 @@ struct image_s {
 float        image_s::zoom    = 1.0f;
 ImageScaling image_s::scaling = ImageScaling_Auto;
 
+// Local video memory the process can still use within the budget the OS
+//   gives it, or 0 if unknown
+static size_t
+SKIV_Viewer_GetAvailableVideoMemory (ID3D11Device* pDevice)
+{
+  CComQIPtr <IDXGIDevice>  pDXGIDevice (pDevice);
+  CComPtr   <IDXGIAdapter> pAdapter;
+
+  if (pDXGIDevice == nullptr || FAILED (pDXGIDevice->GetAdapter (&pAdapter.p)))
+    return 0;
+
+  CComQIPtr <IDXGIAdapter3> pAdapter3 (pAdapter);
+
+  DXGI_QUERY_VIDEO_MEMORY_INFO info = { };
+
+  if (pAdapter3 == nullptr || FAILED (pAdapter3->QueryVideoMemoryInfo (0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &info)))
+    return 0;
+
+  return
+    static_cast <size_t> (info.Budget > info.CurrentUsage ? info.Budget - info.CurrentUsage : 0);
+}
+
+// Reads back the image at full resolution; tiled images only have their
+//   overview on the GPU, so they are copied from the CPU-side image.
+static HRESULT
+SKIV_Viewer_CaptureImage (const image_s& image, ID3D11Device* pDevice, ID3D11DeviceContext* pDevCtx, ID3D11Resource* pResource, DirectX::ScratchImage& result)
+{
+  if (image.tiles != nullptr)
+    return result.InitializeFromImage (*image.tiles->image.GetImage (0, 0, 0));
+
+  return
+    DirectX::CaptureTexture (pDevice, pDevCtx, pResource, result);
+}
+
+// The visualization and tonemap state the pixel shader currently renders with
+static skiv_hdr_visualization_s
+SKIV_Viewer_GetVisualization (void)
+{
+  static SKIF_RegistrySettings& _registry = SKIF_RegistrySettings::GetInstance ( );
+
+  skiv_hdr_visualization_s viz;
+
+  viz.type             = SKIV_HDR_VisualizationId;
+  viz.sdr_flags        = SKIV_HDR_VisualizationFlagsSDR;
+  viz.tonemap_type     = _registry.iHDRToneMapType;
+  viz.brightness       = SKIV_HDR_BrightnessScale / 100.0f;
+  viz.content_max_nits = _registry.b99thPercentileMaxCLL ? SKIV_HDR_MaxLuminanceP99
+                                                         : SKIV_HDR_MaxLuminance;
+  viz.display_max_nits = std::abs (SKIV_HDR_DisplayMaxLuminance); // Negative while calibrating
+  viz.hdr_display      = (_registry.iHDRMode > 0 && SKIF_Util_IsHDRActive (NULL));
+
+  memcpy (viz.gamut_hue [0], SKIV_HDR_GamutHue_Rec709,    sizeof (float) * 4);
+  memcpy (viz.gamut_hue [1], SKIV_HDR_GamutHue_DciP3,     sizeof (float) * 4);
+  memcpy (viz.gamut_hue [2], SKIV_HDR_GamutHue_Rec2020,   sizeof (float) * 4);
+  memcpy (viz.gamut_hue [3], SKIV_HDR_GamutHue_Ap1,       sizeof (float) * 4);
+  memcpy (viz.gamut_hue [4], SKIV_HDR_GamutHue_Ap0,       sizeof (float) * 4);
+  memcpy (viz.gamut_hue [5], SKIV_HDR_GamutHue_Undefined, sizeof (float) * 4);
+
+  return viz;
+}
+
+// An export of the current image at the size picked in the settings, read from
+//   the retained CPU copy of the decoded image rather than the texture
+static skiv_export_request_s
+SKIV_Viewer_GetExportRequest (const image_s& image, const wchar_t* wszFilePath, skiv_export_mode_e mode)
+{
+  static SKIF_RegistrySettings& _registry = SKIF_RegistrySettings::GetInstance ( );
+
+  static constexpr struct {
+    float  percent;
+    size_t max_width;
+    size_t max_height;
+  } sizes [] = {
+    { 100.0f,    0,    0 }, // Original
+    {  75.0f,    0,    0 },
+    {  50.0f,    0,    0 },
+    {  25.0f,    0,    0 },
+    { 100.0f, 3840, 2160 },
+    { 100.0f, 2560, 1440 },
+    { 100.0f, 1920, 1080 }
+  };
+
+  const auto& size =
+    sizes [std::clamp (_registry.iExportSize, 0, static_cast <int> (std::size (sizes)) - 1)];
+
+  skiv_export_request_s request;
+
+  request.path       = wszFilePath;
+  request.mode       = mode;
+  request.is_hdr     = image.is_hdr;
+  request.pixels     = image.pixels;
+  request.tiles      = image.tiles;
+  request.percent    = size.percent;
+  request.max_width  = size.max_width;
+  request.max_height = size.max_height;
+
+  if (mode == SKIV_Export_Visualization)
+    request.viz = SKIV_Viewer_GetVisualization ();
+
+  return request;
+}
+
 float
 image_s::gamut_info_s::pixel_samples_s::getPercentRec709 (void) const
 {
@@ -672,23 +770,8 @@ SaveTempImage (std::wstring_view source, std::wstring_view filename)
 
     bool success = false;
 
-    // This both downloads a new image from the internet as well as copies a local file to the destination
-    // BMP files are downloaded to .tmp, while all others are downloaded to their intended path
-    success = SKIF_Util_GetWebResource (_data->source, _data->destination);
-
-    // If the file was copied successfully, we also need to ensure it's not marked as read-only
-    if (success)
-      SetFileAttributes (_data->destination.c_str(),
-      GetFileAttributes (_data->destination.c_str()) & ~FILE_ATTRIBUTE_READONLY);
-
-    else
-    {
-      PLOG_ERROR << "Could not save the source image to the destination path!";
-      PLOG_ERROR << "Source:      " << _data->source;
-      PLOG_ERROR << "Destination: " << _data->destination;
-    }
-
-    if (success)
+    // Hands the file over to the viewer through the same path as a second instance would
+    auto _OpenInViewer = [&](void) -> bool
     {
       // If the specified window was created by the calling thread, the window procedure is called immediately as a subroutine. 
       wchar_t                    wszFilePath [MAX_PATH] = { };
@@ -705,16 +788,64 @@ SaveTempImage (std::wstring_view source, std::wstring_view filename)
                       WM_COPYDATA,
                       (WPARAM) SKIF_ImGui_hWnd,
                       (LPARAM) (LPVOID) &cds))
+        {
           PLOG_VERBOSE << "Data transfer successful!";
-
-        // Delete the temp file in case of an error
-        else
-          DeleteFile (_data->destination.c_str());
+          return true;
+        }
       }
+
+      return false;
+    };
+
+    // Registered before the viewer learns of the file, so that the image worker
+    //   decodes from the stream instead of the partially written file
+    auto stream =
+      SKIV_Stream_Register (_data->destination);
+
+    bool handed_over = false,
+         accepted    = false;
+
+    // This both downloads a new image from the internet as well as copies a local file to the destination
+    // BMP files are downloaded to .tmp, while all others are downloaded to their intended path
+    SKIV_TraceScope trace_download ("Download");
+    success = SKIV_Stream_Download (_data->source, _data->destination, stream.get (),
+      [&](const void*, size_t)
+      {
+        // The image starts decoding as soon as its first bytes are in
+        if (! std::exchange (handed_over, true))
+        {
+          PLOG_INFO << "Opening the web image while it is still downloading...";
+          accepted = _OpenInViewer ();
+        }
+      });
+    trace_download.End ( );
+
+    // The file is complete (or gone) from here on
+    SKIV_Stream_Unregister (_data->destination);
+
+    // If the file was copied successfully, we also need to ensure it's not marked as read-only
+    if (success)
+      SetFileAttributes (_data->destination.c_str(),
+      GetFileAttributes (_data->destination.c_str()) & ~FILE_ATTRIBUTE_READONLY);
+
+    else
+    {
+      PLOG_ERROR << "Could not save the source image to the destination path!";
+      PLOG_ERROR << "Source:      " << _data->source;
+      PLOG_ERROR << "Destination: " << _data->destination;
     }
 
-    else {
-      PostMessage (SKIF_Notify_hWnd, WM_SKIF_IMAGE, 0x0, static_cast<LPARAM> (success));
+    // Empty files never went through the callback
+    if (success && ! handed_over)
+      accepted = _OpenInViewer ();
+
+    // Delete the temp file in case of an error
+    if (success && ! accepted)
+      DeleteFile (_data->destination.c_str());
+
+    // Once accepted, the image worker reports whether the image loaded
+    if (! accepted) {
+      PostMessage (SKIF_Notify_hWnd, WM_SKIF_IMAGE, 0x0, static_cast<LPARAM> (false));
       PLOG_ERROR << "Failed to process the new cover image!";
     }
 
@@ -758,7 +889,8 @@ enum ImageDecoder {
 #endif
   ImageDecoder_HDR,
   ImageDecoder_UHDR,
-  ImageDecoder_AVIF
+  ImageDecoder_AVIF,
+  ImageDecoder_JPEG
 };
 
 class SK_AutoFile {
@@ -791,6 +923,58 @@ private:
   FILE*  file_;
 };
 
+// Read-only view of a whole file, so that it can be probed and decoded without
+//   first being copied into memory; data () is nullptr if it cannot be mapped.
+//     Writers are locked out so that the view cannot change under a decoder;
+//       files that are still being downloaded are read through the stream.
+class SK_AutoFileView {
+public:
+  SK_AutoFileView (const wchar_t* wszFileName)
+  {
+    HANDLE hFile =
+      CreateFileW (wszFileName, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                     nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (hFile == INVALID_HANDLE_VALUE)
+      return;
+
+    LARGE_INTEGER file_size = { };
+
+    // Empty files cannot be mapped, and the decoders take an int size
+    if (GetFileSizeEx (hFile, &file_size) && file_size.QuadPart > 0 && file_size.QuadPart < INT_MAX)
+    {
+      HANDLE hMapping =
+        CreateFileMappingW (hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+      if (hMapping != nullptr)
+      {
+        data_ = static_cast <const uint8_t *> (MapViewOfFile (hMapping, FILE_MAP_READ, 0, 0, 0));
+        size_ = (data_ != nullptr) ? static_cast <size_t> (file_size.QuadPart) : 0;
+
+        // The view keeps the mapping alive
+        CloseHandle (hMapping);
+      }
+    }
+
+    CloseHandle (hFile);
+  }
+
+  ~SK_AutoFileView (void)
+  {
+    if (data_ != nullptr)
+    {
+      UnmapViewOfFile (std::exchange (data_, nullptr));
+    }
+  }
+
+  const uint8_t* data (void) const { return data_; }
+  size_t         size (void) const { return size_; }
+
+private:
+  const uint8_t* data_ = nullptr;
+  size_t         size_ = 0;
+};
+
 class SKIV_ScopedThreadPriority_Viewer
 {
 public:
@@ -967,26 +1151,20 @@ SKIV_DXGI_NumberOfChannels (DXGI_FORMAT format)
   }
 }
 
-bool
-LoadLibraryTexture (image_s& image)
+// Decodes image.file_info.path into img on the CPU without touching the GPU;
+//   shared by LoadLibraryTexture and the headless /Convert batch mode. Decoders
+//     that can scale while decoding stop at the first size no smaller than
+//       export_size, which is then rewritten relative to the decoded image.
+static bool
+SKIV_Viewer_DecodeImage (image_s& image, DirectX::ScratchImage& img, DirectX::TexMetadata& meta, ImageDecoder& decoder, skiv_export_size_s* export_size = nullptr)
 {
-  SKIV_ScopedThreadPriority_Viewer _scoped_thread_prio;
-
-  // NOT REALLY THREAD-SAFE WHILE IT RELIES ON THESE GLOBAL OBJECTS!
-  static SKIF_RegistrySettings& _registry   = SKIF_RegistrySettings::GetInstance ( );
-  static SKIF_CommonPathsCache& _path_cache = SKIF_CommonPathsCache::GetInstance ( );
-
-  CComPtr <ID3D11Texture2D> pRawTex2D;
-  CComPtr <ID3D11Texture2D> pGamutCoverageTex2D;
-  DirectX::TexMetadata        meta      = { };
-  DirectX::ScratchImage        img      = { };
   DirectX::ScratchImage        img_srgb = { };
 
   bool succeeded = false;
   bool converted = false;
   bool need_srgb = false;
 
-  DWORD pre = SKIF_Util_timeGetTime1 ();
+  decoder = ImageDecoder_None;
 
   if (image.file_info.path.empty ())
     return false;
@@ -997,16 +1175,23 @@ LoadLibraryTexture (image_s& image)
   std::wstring ext   = SKIF_Util_ToLowerW (imagePath.extension ().wstring ());
   std::string szPath = SK_WideCharToUTF8  (image.file_info.path);
 
-  ImageDecoder decoder = ImageDecoder_None;
-
   if (ext == L".tga")
     decoder = ImageDecoder_stbi;
 
         FILE*          pImageFile = nullptr;
   const FileSignature* image_sig  = nullptr;
 
+  // JPEG files are mapped once, for both Ultra HDR detection and decoding
+  std::unique_ptr <SK_AutoFileView> file_view;
+
+  // Set while a web image is still being downloaded, see utility/stream.h
+  auto stream =
+    SKIV_Stream_Find (image.file_info.path);
+
   if (decoder == ImageDecoder_None)
   {
+    SKIV_TRACE_SCOPE ("DetectSignature");
+
     static size_t
         maxLength  = 0;
     if (maxLength == 0)
@@ -1029,8 +1214,22 @@ LoadLibraryTexture (image_s& image)
     {
       std::vector <char>
               buffer         (maxLength);
-      fread  (buffer.data (), maxLength, 1, pImageFile);
-      rewind (                              pImageFile);
+
+      if (stream != nullptr)
+      {
+        std::vector <uint8_t> head;
+
+        stream->wait (maxLength);
+        stream->read (0, head, maxLength);
+
+        std::copy (head.begin (), head.end (), buffer.begin ());
+      }
+
+      else
+      {
+        fread  (buffer.data (), maxLength, 1, pImageFile);
+        rewind (                              pImageFile);
+      }
 
       for (auto& type : supported_formats)
       {
@@ -1040,10 +1239,25 @@ LoadLibraryTexture (image_s& image)
 
           PLOG_INFO << "Detected an " << type.mime_type << " image";
 
+          // Ultra HDR detection already reads the rest of a JPEG file
+          if (type.mime_type == L"image/jpeg")
+          {
+            if (stream != nullptr)
+              stream->wait ();
+
+            file_view =
+              std::make_unique <SK_AutoFileView> (imagePath.c_str ());
+          }
+
+          const bool mapped =
+            (file_view != nullptr && file_view->data () != nullptr);
+
           decoder = 
              (type.mime_type == L"image/jpeg"                ) ?
-                   (SKIV_Image_IsUltraHDR (imagePath.c_str ()) ? ImageDecoder_UHDR :
-                                                                 ImageDecoder_stbi):
+                   (! mapped                                   ? ImageDecoder_stbi :
+                    SKIV_Image_IsUltraHDR (const_cast <uint8_t *> (file_view->data ()),
+                       static_cast <int> (file_view->size ())) ? ImageDecoder_UHDR :
+                                                                 ImageDecoder_JPEG):
              (type.mime_type == L"image/png"                 ) ? ImageDecoder_stbi : // Use WIC for proper color correction
              (type.mime_type == L"image/bmp"                 ) ? ImageDecoder_stbi :
              (type.mime_type == L"image/vnd.adobe.photoshop" ) ? ImageDecoder_stbi :
@@ -1083,10 +1297,29 @@ LoadLibraryTexture (image_s& image)
     }
   }
 
+  // Only the JPEG XL decoder takes its input as it arrives, the others need the complete file
+  if (stream != nullptr && decoder != ImageDecoder_JXL)
+  {
+    SKIV_TRACE_SCOPE ("WaitForDownload");
+
+    stream->wait ();
+  }
+
   SK_AutoFile _(pImageFile);
 
-  auto _scratchMemory =
-    std::make_unique <unsigned char []> (_.getInitialSize ());
+  if (stream != nullptr && stream->ended () && ! stream->succeeded ())
+  {
+    PLOG_ERROR << "Failed to download the image!";
+    return false;
+  }
+
+  // Mapped JPEGs are decoded straight from the mapping, every other decoder
+  //   reads the whole file into this first
+  SKIV_BufferPool::unique_ptr <unsigned char> _scratchMemory;
+
+  if (file_view == nullptr || file_view->data () == nullptr)
+    _scratchMemory =
+      SKIV_BufferPool::GetInstance ( ).make_unique <unsigned char> (_.getInitialSize ());
 
   PLOG_ERROR_IF(decoder == ImageDecoder_None) << "Failed to detect file type!";
   PLOG_DEBUG_IF(decoder == ImageDecoder_stbi) << "Using stbi decoder...";
@@ -1098,20 +1331,20 @@ LoadLibraryTexture (image_s& image)
 #endif
   PLOG_DEBUG_IF(decoder == ImageDecoder_HDR ) << "Using Radiance HDR decoder...";
   PLOG_DEBUG_IF(decoder == ImageDecoder_UHDR) << "Using Ultra HDR decoder...";
+  PLOG_DEBUG_IF(decoder == ImageDecoder_JPEG) << "Using SIMD JPEG decoder...";
 
   if (decoder == ImageDecoder_None)
     return false;
 
   if (decoder == ImageDecoder_UHDR)
   {
-    fseek  (pImageFile,                                 0, SEEK_SET  );
-    fread  (_scratchMemory.get (), _.getInitialSize (), 1, pImageFile);
-    rewind (pImageFile);
+    SKIV_TRACE_SCOPE ("Decode (Ultra HDR)");
 
     image.light_info.isHDR = true;
     image.is_hdr           = true;
 
-    SKIV_Image_LoadUltraHDR (img, _scratchMemory.get (), static_cast <int> (_.getInitialSize ()));
+    // Only ever selected for a mapped file
+    SKIV_Image_LoadUltraHDR (img, const_cast <uint8_t *> (file_view->data ()), static_cast <int> (file_view->size ()));
 
     meta           = img.GetMetadata ();
     meta.dimension = DirectX::TEX_DIMENSION_TEXTURE2D;
@@ -1120,8 +1353,111 @@ LoadLibraryTexture (image_s& image)
     succeeded = true;
   }
 
+  if (decoder == ImageDecoder_JPEG)
+  {
+    SKIV_TRACE_SCOPE ("Decode (JPEG)");
+
+    const uint8_t* data = file_view->data ();
+    const size_t   size = file_view->size ();
+
+    size_t width    = 0,
+           height   = 0;
+    int    channels = 0;
+
+    HRESULT hr = E_NOTIMPL;
+
+    if (SKIV_Image_GetJPEGInfo (data, size, width, height, channels))
+    {
+      // Exports that shrink the image are decoded straight from the DCT at 1/2,
+      //   1/4 or 1/8 of the size, as long as that is still large enough
+      size_t export_width  = width,
+             export_height = height;
+
+      if (export_size != nullptr)
+        SKIV_Image_GetExportSize (width, height, export_size->percent, export_size->max_width, export_size->max_height, export_width, export_height);
+
+      const int scale =
+        SKIV_Image_GetJPEGScale (width, height, export_width, export_height);
+
+      // Images tagged with an ICC profile other than sRGB are decoded to scRGB
+      std::shared_ptr <const skiv_icc_transform_s> icc_transform;
+
+      const std::vector <uint8_t> profile =
+        SKIV_ICC_ExtractProfile (data, size);
+
+      if (! profile.empty ())
+        icc_transform = SKIV_ICC_GetTransform (profile.data (), profile.size ());
+
+      if (icc_transform != nullptr)
+      {
+        DirectX::ScratchImage signal;
+
+        hr =
+          SKIV_Image_LoadJPEG (data, size, scale, DXGI_FORMAT_R8G8B8A8_UNORM, signal);
+
+        bool wcg = false;
+        bool hdr = false;
+
+        if (SUCCEEDED (hr))
+          hr = SKIV_ICC_TransformImage (*icc_transform, signal.GetPixels (), signal.GetMetadata ().width,
+                                                                             signal.GetMetadata ().height, false, img, wcg, hdr);
+
+        if (SUCCEEDED (hr))
+        {
+          PLOG_INFO << "Decoded the image to scRGB using its ICC profile";
+
+          image.light_info.isHDR = wcg||hdr;
+          image.is_hdr           = wcg||hdr;
+        }
+      }
+
+      else
+      {
+        hr =
+          SKIV_Image_LoadJPEG (data, size, scale, (channels == 1) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB
+                                                                  : DXGI_FORMAT_B8G8R8X8_UNORM_SRGB, img);
+      }
+
+      if (SUCCEEDED (hr) && scale > 1 && export_size != nullptr)
+      {
+        PLOG_INFO << "Decoded the image at 1/" << scale << " of its " << width << "x" << height << " size for export";
+
+        *export_size = { 100.0f, export_width, export_height };
+      }
+    }
+
+    if (SUCCEEDED (hr))
+    {
+      meta = img.GetMetadata ();
+
+      image.bpc      = 8;
+      image.channels = channels;
+
+      converted = true;
+      succeeded = true;
+    }
+
+    // Progressive, arithmetic-coded, 12-bit and CMYK files
+    else
+    {
+      PLOG_INFO_IF (hr == E_NOTIMPL) << "Unsupported JPEG coding, using stbi instead...";
+      PLOG_ERROR_IF(hr != E_NOTIMPL) << "SIMD JPEG decoder failed, using stbi instead...";
+
+      decoder = ImageDecoder_stbi;
+    }
+  }
+
   if (decoder == ImageDecoder_stbi)
   {
+    SKIV_TRACE_SCOPE ("Decode (stbi)");
+
+    // JPEG files were already mapped, the rest are read into the scratch memory
+    const bool mapped =
+      (file_view != nullptr && file_view->data () != nullptr);
+
+    const uint8_t* file_data = mapped ? file_view->data () : _scratchMemory.get ();
+    const size_t   file_size = mapped ? file_view->size () : _.getInitialSize ();
+
     // If desired_channels is non-zero, *channels_in_file has the number of components that _would_ have been
     // output otherwise. E.g. if you set desired_channels to 4, you will always get RGBA output, but you can
     // check *channels_in_file to see if it's trivially opaque because e.g. there were only 3 channels in the source image.
@@ -1142,52 +1478,52 @@ LoadLibraryTexture (image_s& image)
 
     PLOG_VERBOSE << "STBI thinks the image is... " << ((image.light_info.isHDR) ? "HDR" : "SDR");
 
-    fseek  (pImageFile,                                 0, SEEK_SET  );
-    fread  (_scratchMemory.get (), _.getInitialSize (), 1, pImageFile);
-    rewind (pImageFile);
+    if (! mapped)
+    {
+      SKIV_TraceScope trace_read ("ReadFile");
+      fseek  (pImageFile,                                 0, SEEK_SET  );
+      fread  (_scratchMemory.get (), _.getInitialSize (), 1, pImageFile);
+      rewind (pImageFile);
+      trace_read.End ( );
+    }
 
     if (image_sig->mime_type == L"image/png")
     {
-      std::string_view     data_view ((const char *)_scratchMemory.get (), _.getInitialSize ());
+      std::string_view     data_view ((const char *)file_data, file_size);
       if (auto cicp_pos  = data_view.find ("cICP", 0, 4);
                cicp_pos != data_view.npos)
       {
-        memcpy (&SKIV_STBI_CICP, &_scratchMemory.get ()[cicp_pos+4], 4);
+        memcpy (&SKIV_STBI_CICP, &file_data [cicp_pos+4], 4);
       }
 
       if (auto sbit_pos  = data_view.find ("sBIT", 0, 4);
                sbit_pos != data_view.npos)
       {
         unsigned long size =
-          *((unsigned long *)&_scratchMemory.get ()[sbit_pos-4]);
+          *((unsigned long *)&file_data [sbit_pos-4]);
 
 #if (defined _M_IX86) || (defined _M_X64)
         size = _byteswap_ulong (size);
 #endif
 
-        memcpy (&SKIV_STBI_SBIT, &_scratchMemory.get ()[sbit_pos+4], std::min (4ul, size));
+        memcpy (&SKIV_STBI_SBIT, &file_data [sbit_pos+4], std::min (4ul, size));
       }
     }
 
-    float*                pixels = SKIV_STBI_CICP.primaries != 0 ?
-                                                         nullptr :
-                                   stbi_loadf_from_memory (_scratchMemory.get (), static_cast <int> (_.getInitialSize ()), &width, &height, &channels_in_file, desired_channels);
-    typedef float         pixel_size;
-    DXGI_FORMAT           dxgi_format = DXGI_FORMAT::DXGI_FORMAT_R32G32B32A32_FLOAT;
-#else
-    unsigned char*        pixels = stbi_load  (szPath.c_str(), &width, &height, &channels_in_file, desired_channels);
-    typedef unsigned char pixel_size;
-    constexpr DXGI_FORMAT dxgi_format = DXGI_FORMAT::DXGI_FORMAT_R8G8B8A8_UNORM;
-#endif
+    // Images tagged with CICP (cICP) or an ICC profile other than sRGB are decoded
+    //   from their integer pixels straight to scRGB; CICP takes precedence
+    std::shared_ptr <const skiv_icc_transform_s> icc_transform;
 
-    // Fall back to using WIC if STB fails to parse the file
-    if (pixels == NULL && SKIV_STBI_CICP.primaries == 0)
+    if (SKIV_STBI_CICP.primaries == 0)
     {
-      decoder = ImageDecoder_WIC;
-      PLOG_ERROR << "Using WIC decoder due to STB failing with: " << stbi_failure_reason();
+      const std::vector <uint8_t> profile =
+        SKIV_ICC_ExtractProfile (file_data, file_size);
+
+      if (! profile.empty ())
+        icc_transform = SKIV_ICC_GetTransform (profile.data (), profile.size ());
     }
 
-    else
+    if (SKIV_STBI_CICP.primaries != 0 || icc_transform != nullptr)
     {
 #ifdef _DEBUG
 
@@ -1199,103 +1535,118 @@ LoadLibraryTexture (image_s& image)
 
 #endif // _DEBUG
 
-      if (SKIV_STBI_CICP.primaries != 0)
+      // RGB is currently the only supported color model in PNG, and as such
+      //   Matrix Coefficients shall be set to 0 (Identity)
+      assert (SKIV_STBI_CICP.matrix_coeffs == 0);
+
+      const int  size     = static_cast <int> (file_size);
+      const bool is_16bit = stbi_is_16_bit_from_memory (file_data, size);
+
+      void* int_pixels = is_16bit ? static_cast <void *> (stbi_load_16_from_memory (file_data, size, &width, &height, &channels_in_file, desired_channels))
+                                  : static_cast <void *> (stbi_load_from_memory    (file_data, size, &width, &height, &channels_in_file, desired_channels));
+
+      bool    wcg = false;
+      bool    hdr = false;
+      HRESULT hr  = E_FAIL;
+
+      if (int_pixels != nullptr && icc_transform != nullptr)
+        hr = SKIV_ICC_TransformImage (*icc_transform, int_pixels, width, height, is_16bit, img, wcg, hdr);
+
+      else if (int_pixels != nullptr)
       {
-        dxgi_format = DXGI_FORMAT_R16G16B16A16_FLOAT;
-
-        assert (SKIV_STBI_CICP.primaries     ==  9); // BT 2020
-        assert (SKIV_STBI_CICP.transfer_func == 16); // ST 2084
-        assert (SKIV_STBI_CICP.matrix_coeffs ==  0); // Identity
-        // RGB is currently the only supported color model in PNG,
-        //   and as such Matrix Coefficients shall be set to 0.
-        // 
-        // But presumably it may eventually also be:
-        //    0 (RGB)
-        //    9 (BT.2020 Non-Constant Luminance)
-        //   10 (BT.2020 Constant Luminance)
-        //   14 (BT.2100 ICtCp)
-
-        image.light_info.isHDR = true;
-        image.is_hdr           = true;
-      }
+        const size_t row_pitch =
+          static_cast <size_t> (width) * desired_channels * (is_16bit ? 2 : 1);
+
+        const DirectX::Image signal = {
+          .width      = static_cast <size_t> (width),
+          .height     = static_cast <size_t> (height),
+          .format     = is_16bit ? DXGI_FORMAT_R16G16B16A16_UNORM : DXGI_FORMAT_R8G8B8A8_UNORM,
+          .rowPitch   = row_pitch,
+          .slicePitch = row_pitch * height,
+          .pixels     = static_cast <uint8_t *> (int_pixels)
+        };
 
-      meta.width     = width;
-      meta.height    = height;
-      meta.depth     = 1;
-      meta.arraySize = 1;
-      meta.mipLevels = 1;
-      meta.format    = dxgi_format; // STBI_rgb_alpha
-      meta.dimension = DirectX::TEX_DIMENSION_TEXTURE2D;
+        const skiv_cicp_s cicp = {
+          .primaries     = SKIV_STBI_CICP.primaries,
+          .transfer_func = SKIV_STBI_CICP.transfer_func
+        };
 
-      if ( dxgi_format == DXGI_FORMAT_R32G32B32A32_FLOAT ||
-          (dxgi_format == DXGI_FORMAT_R16G16B16A16_FLOAT && image.is_hdr))
+        hr = SKIV_Image_DecodeCICP (signal, cicp, img, wcg, hdr);
+      }
+
+      if (SUCCEEDED (hr))
       {
-        // Good grief this is inefficient, let's convert it to something reasonable...
-        DirectX::ScratchImage raw_fp32_img;
+        meta.width     = width;
+        meta.height    = height;
+        meta.depth     = 1;
+        meta.arraySize = 1;
+        meta.mipLevels = 1;
+        meta.format    = DXGI_FORMAT_R16G16B16A16_FLOAT;
+        meta.dimension = DirectX::TEX_DIMENSION_TEXTURE2D;
+
+        image.bpc      = is_16bit ? 16 : 8;
+        image.channels = channels_in_file;
 
-        // Check for BT.2020 using ST.2084 (HDR10)
-        if ( SKIV_STBI_CICP.primaries     ==  9 &&
-             SKIV_STBI_CICP.transfer_func == 16 )
+        if (SKIV_STBI_SBIT.red_bits != 0)
         {
-          DirectX::ScratchImage temp_img  = { };
-          DirectX::ScratchImage temp_img2 = { };
-
-          if (SUCCEEDED (
-              DirectX::LoadFromWICMemory (
-                _scratchMemory.get (), _.getInitialSize (),
-                  DirectX::WIC_FLAGS_FILTER_POINT | DirectX::WIC_FLAGS_FORCE_LINEAR,
-                    &meta, temp_img)))
-          {
-            image.bpc      =
-              (int)DirectX::BitsPerColor (meta.format);
-            image.channels =
-              DirectX::HasAlpha     (meta.format) ? 4 : 3; // Expect 3... 4 would be weird for an HDR image
+          image.bpc = SKIV_STBI_SBIT.red_bits;
 
-            PLOG_INFO << "HDR10 PNG detected, transforming to scRGB...";
+          image.channels = 0;
 
-            // PNG will be loaded as UNORM, we need to convert to float...
-            if (SUCCEEDED (DirectX::Convert        (*temp_img.GetImages (), DXGI_FORMAT_R16G16B16A16_FLOAT, DirectX::TEX_FILTER_DEFAULT, 0.0f, temp_img2)))
-            if (SUCCEEDED (img.InitializeFromImage (*temp_img2.GetImage (0,0,0))))
-            {
-              using namespace DirectX;
+          if (SKIV_STBI_SBIT.red_bits   > 0) image.channels++;
+          if (SKIV_STBI_SBIT.green_bits > 0) image.channels++;
+          if (SKIV_STBI_SBIT.blue_bits  > 0) image.channels++;
+          if (SKIV_STBI_SBIT.alpha_bits > 0) image.channels++;
+        }
 
-              TransformImage ( temp_img2.GetImages     (),
-                               temp_img2.GetImageCount (),
-                               temp_img2.GetMetadata   (),
-              [&](XMVECTOR* outPixels, const XMVECTOR* inPixels, size_t width, size_t y)
-              {
-                UNREFERENCED_PARAMETER(y);
-              
-                for (size_t j = 0; j < width; ++j)
-                {
-                  XMVECTOR v = inPixels [j];
+        image.light_info.isHDR = wcg||hdr;
+        image.is_hdr           = wcg||hdr;
 
-                  outPixels [j] =
-                    XMVector3Transform (SKIV_Image_PQToLinear (v), c_Bt2100toscRGB);
-                }
-              }, img );
+        converted = true;
+        succeeded = true;
+      }
 
-              meta.format = DXGI_FORMAT_R16G16B16A16_FLOAT;
-              converted   = true;
-              succeeded   = true;
+      stbi_image_free (int_pixels);
+    }
 
-              if (SKIV_STBI_SBIT.red_bits != 0)
-              {
-                image.bpc = SKIV_STBI_SBIT.red_bits;
+    float*                pixels = succeeded ? nullptr :
+                                   stbi_loadf_from_memory (file_data, static_cast <int> (file_size), &width, &height, &channels_in_file, desired_channels);
+    typedef float         pixel_size;
+    DXGI_FORMAT           dxgi_format = DXGI_FORMAT::DXGI_FORMAT_R32G32B32A32_FLOAT;
+#else
+    unsigned char*        pixels = stbi_load  (szPath.c_str(), &width, &height, &channels_in_file, desired_channels);
+    typedef unsigned char pixel_size;
+    constexpr DXGI_FORMAT dxgi_format = DXGI_FORMAT::DXGI_FORMAT_R8G8B8A8_UNORM;
+#endif
 
-                image.channels = 0;
+    if (succeeded)
+    {
+      PLOG_INFO << "Decoded the image to scRGB using its " << ((icc_transform != nullptr) ? "ICC profile" : "CICP");
+    }
 
-                if (SKIV_STBI_SBIT.red_bits   > 0) image.channels++;
-                if (SKIV_STBI_SBIT.green_bits > 0) image.channels++;
-                if (SKIV_STBI_SBIT.blue_bits  > 0) image.channels++;
-                if (SKIV_STBI_SBIT.alpha_bits > 0) image.channels++;
-              }
-            }
-          }
-        }
+    // Fall back to using WIC if STB fails to parse the file
+    else if (pixels == NULL)
+    {
+      decoder = ImageDecoder_WIC;
+      PLOG_ERROR << "Using WIC decoder due to STB failing with: " << stbi_failure_reason();
+    }
+
+    else
+    {
+      meta.width     = width;
+      meta.height    = height;
+      meta.depth     = 1;
+      meta.arraySize = 1;
+      meta.mipLevels = 1;
+      meta.format    = dxgi_format; // STBI_rgb_alpha
+      meta.dimension = DirectX::TEX_DIMENSION_TEXTURE2D;
 
+      if (dxgi_format == DXGI_FORMAT_R32G32B32A32_FLOAT)
+      {
+        // Good grief this is inefficient, let's convert it to something reasonable...
+        DirectX::ScratchImage raw_fp32_img;
 
-        if ((! converted) && SUCCEEDED (raw_fp32_img.Initialize2D (meta.format, width, height, 1, 1)))
+        if (SUCCEEDED (raw_fp32_img.Initialize2D (meta.format, width, height, 1, 1)))
         {
           size_t   imageSize = width * height * desired_channels * sizeof (pixel_size);
           uint8_t* pDest     = raw_fp32_img.GetImage (0, 0, 0)->pixels;
@@ -1344,7 +1695,7 @@ LoadLibraryTexture (image_s& image)
                                                     : DXGI_FORMAT_UNKNOWN
                                                     : DXGI_FORMAT_UNKNOWN;
 
-          if (SUCCEEDED (DirectX::Convert (*raw_fp32_img.GetImages (), final_format, DirectX::TEX_FILTER_DEFAULT, 0.0f, img)))
+          if (SUCCEEDED (SKIV_Image_Convert (*raw_fp32_img.GetImages (), final_format, DirectX::TEX_FILTER_DEFAULT, 0.0f, img)))
           {
             meta.format = final_format;
             converted   = true;
@@ -1371,9 +1722,13 @@ LoadLibraryTexture (image_s& image)
 
   if (decoder == ImageDecoder_WIC)
   {
+    SKIV_TRACE_SCOPE ("Decode (WIC)");
+
+    SKIV_TraceScope trace_read ("ReadFile");
     fseek  (pImageFile,                                 0, SEEK_SET  );
     fread  (_scratchMemory.get (), _.getInitialSize (), 1, pImageFile);
     rewind (pImageFile);
+    trace_read.End ( );
 
     if (SUCCEEDED (
         DirectX::LoadFromWICMemory (
@@ -1438,9 +1793,13 @@ LoadLibraryTexture (image_s& image)
 
   if (decoder == ImageDecoder_DDS)
   {
+    SKIV_TRACE_SCOPE ("Decode (DDS)");
+
+    SKIV_TraceScope trace_read ("ReadFile");
     fseek  (pImageFile,                                 0, SEEK_SET  );
     fread  (_scratchMemory.get (), _.getInitialSize (), 1, pImageFile);
     rewind (pImageFile);
+    trace_read.End ( );
 
     if (SUCCEEDED (
         DirectX::LoadFromDDSMemory (
@@ -1455,7 +1814,29 @@ LoadLibraryTexture (image_s& image)
       image.channels =                    SKIV_DXGI_NumberOfChannels (meta.format);
       image.is_dds   = true;
 
-      if (DirectX::MakeTypeless (meta.format) == DXGI_FORMAT_BC6H_TYPELESS)
+      const bool is_bc6h =
+        (DirectX::MakeTypeless (meta.format) == DXGI_FORMAT_BC6H_TYPELESS);
+
+      // Block-compressed surfaces are decoded up front (top level only, the mip
+      //   chain is regenerated), so statistics, tonemapping and export get plain
+      //     RGBA8 or FP16 scRGB pixels like every other decoder produces.
+      if (SKIV_Image_IsBCDecodable (meta.format))
+      {
+        DirectX::ScratchImage decoded;
+
+        if (SUCCEEDED (SKIV_Image_DecompressBC (*img.GetImage (0, 0, 0), decoded)))
+        {
+          std::swap (img, decoded);
+          meta = img.GetMetadata ( );
+
+          image.light_info.isHDR = is_bc6h;
+        }
+
+        else
+          PLOG_WARNING << "Failed to decompress the " << meta.width << "x" << meta.height << " block-compressed image!";
+      }
+
+      if (is_bc6h)
       {
         image.is_hdr = true;
       }
@@ -1465,6 +1846,8 @@ LoadLibraryTexture (image_s& image)
 #ifdef _M_X64
   if (decoder == ImageDecoder_EXR)
   {
+    SKIV_TRACE_SCOPE ("Decode (OpenEXR)");
+
     using namespace DirectX;
 
     TexMetadata exr_meta;
@@ -1496,15 +1879,28 @@ LoadLibraryTexture (image_s& image)
 
   if (decoder == ImageDecoder_HDR)
   {
+    SKIV_TRACE_SCOPE ("Decode (Radiance HDR)");
+
+    SKIV_TraceScope trace_read ("ReadFile");
     fseek  (pImageFile,                                 0, SEEK_SET  );
     fread  (_scratchMemory.get (), _.getInitialSize (), 1, pImageFile);
     rewind (pImageFile);
+    trace_read.End ( );
 
     using namespace DirectX;
 
     TexMetadata hdr_meta;
 
-    if (SUCCEEDED (LoadFromHDRMemory (_scratchMemory.get (), _.getInitialSize (), &hdr_meta, img)))
+    // Parallel in-tree decoder first; DirectXTex handles XYZE and rotated files
+    bool loaded =
+      SUCCEEDED (SKIV_Image_LoadRadiance (_scratchMemory.get (), _.getInitialSize (), img));
+
+    if (loaded)
+      hdr_meta = img.GetMetadata ();
+    else
+      loaded = SUCCEEDED (LoadFromHDRMemory (_scratchMemory.get (), _.getInitialSize (), &hdr_meta, img));
+
+    if (loaded)
     {
       image.bpc      = static_cast <int> (DirectX::BitsPerColor (hdr_meta.format));
       image.channels =               3 + (DirectX::HasAlpha     (hdr_meta.format) ?
@@ -1530,6 +1926,8 @@ LoadLibraryTexture (image_s& image)
 
   if (decoder == ImageDecoder_AVIF)
   {
+    SKIV_TRACE_SCOPE ("Decode (AVIF)");
+
     if (! isAVIFEncoderAvailable ())
     {
       PLOG_ERROR << L"Unworkable libavif DLL present, will attempt to re-download the next time an AVIF image is decoded.";
@@ -1546,9 +1944,11 @@ LoadLibraryTexture (image_s& image)
       avif_decoder->maxThreads =
         std::min (64U, std::min ((UINT)si.dwNumberOfProcessors, (UINT)__popcnt64 (si.dwActiveProcessorMask)));
 
+      SKIV_TraceScope trace_read ("ReadFile");
       fseek  (pImageFile,                                 0, SEEK_SET  );
       fread  (_scratchMemory.get (), _.getInitialSize (), 1, pImageFile);
       rewind (pImageFile);
+      trace_read.End ( );
 
       SK_avifDecoderSetIOMemory (avif_decoder, _scratchMemory.get (), _.getInitialSize ());
       SK_avifDecoderParse       (avif_decoder);
@@ -1568,25 +1968,47 @@ LoadLibraryTexture (image_s& image)
         rgb.ignoreAlpha = true;
         rgb.isFloat     = true;
 
-        SK_avifRGBImageAllocatePixels (                     &rgb);
+        // Decode into a pooled buffer rather than avifRGBImageAllocatePixels ( ),
+        //   same layout: tightly packed RGBA16
+        rgb.rowBytes    = rgb.width * 4 * sizeof (uint16_t);
+
+        auto rgb_pixels =
+          SKIV_BufferPool::GetInstance ( ).make_unique <uint8_t> (static_cast <size_t> (rgb.rowBytes) * rgb.height);
+
+        rgb.pixels      = rgb_pixels.get ();
+
         SK_avifImageYUVToRGB          (avif_decoder->image, &rgb);
 
         image.width    = static_cast <float> (rgb.width);
         image.height   = static_cast <float> (rgb.height);
 
-        DirectX::ScratchImage temp_img;
+        // The encoded signal (half-float), decoded according to the image's CICP
+        const DirectX::Image signal = {
+          .width      = rgb.width,
+          .height     = rgb.height,
+          .format     = DXGI_FORMAT_R16G16B16A16_FLOAT,
+          .rowPitch   = rgb.rowBytes,
+          .slicePitch = static_cast <size_t> (rgb.rowBytes) * rgb.height,
+          .pixels     = rgb.pixels
+        };
+
+        const skiv_cicp_s cicp = {
+          .primaries     = static_cast <uint8_t> (avif_decoder->image->colorPrimaries),
+          .transfer_func = static_cast <uint8_t> (avif_decoder->image->transferCharacteristics)
+        };
+
+        bool wcg = false;
+        bool hdr = false;
 
-        if (SUCCEEDED (temp_img.Initialize2D (DXGI_FORMAT_R16G16B16A16_FLOAT, static_cast <size_t> (image.width),
-                                                                              static_cast <size_t> (image.height), 1, 1)))
+        if (SUCCEEDED (SKIV_Image_DecodeCICP (signal, cicp, img, wcg, hdr)))
         {
-          using namespace DirectX;
+          PLOG_INFO << "AVIF CICP: " << (int)cicp.primaries << "/" << (int)cicp.transfer_func;
 
           image.channels = 3;
           image.bpc      = bpc;
 
-          // XXX
-          image.light_info.isHDR = true;
-          image.is_hdr           = true;
+          image.light_info.isHDR = wcg||hdr;
+          image.is_hdr           = wcg||hdr;
 
           succeeded      = true;
 
@@ -1597,42 +2019,9 @@ LoadLibraryTexture (image_s& image)
           meta.arraySize = 1;
           meta.mipLevels = 1;
           meta.dimension = DirectX::TEX_DIMENSION_TEXTURE2D;
-
-          void*  pixels_buffer      = static_cast <void *>(temp_img.GetPixels ());
-
-#ifdef _DEBUG
-          size_t pixels_buffer_size = temp_img.GetPixelsSize ();
-          assert (pixels_buffer_size >= rgb.rowBytes * rgb.height);
-#endif
-
-          memcpy (pixels_buffer, rgb.pixels, rgb.rowBytes * rgb.height);
-
-          if ( SUCCEEDED ( TransformImage (*temp_img.GetImages (),
-                [&](      XMVECTOR* outPixels,
-                    const XMVECTOR* inPixels,
-                          size_t    width,
-                          size_t    y)
-                {
-                  UNREFERENCED_PARAMETER(y);
-                
-                  for (size_t j = 0; j < width; ++j)
-                  {
-                    XMVECTOR v = inPixels [j];
-
-                    v =
-                      XMVector3Transform (SKIV_Image_PQToLinear (v), c_Bt2100toscRGB);
-
-                    outPixels [j] = v;
-                  }
-                }, img )
-              )
-            )
-          {
-            temp_img.Release ();
-          }
         }
 
-        SK_avifRGBImageFreePixels     (                     &rgb);
+        rgb.pixels      = nullptr;
       }
 
       SK_avifDecoderDestroy (avif_decoder);
@@ -1641,6 +2030,8 @@ LoadLibraryTexture (image_s& image)
 
   if (decoder == ImageDecoder_JXL)
   {
+    SKIV_TRACE_SCOPE ("Decode (JPEG XL)");
+
     static HMODULE hModJXL;
     SK_RunOnce (   hModJXL = LoadLibraryW (L"jxl.dll"));
 
@@ -1657,6 +2048,7 @@ LoadLibraryTexture (image_s& image)
     using JxlDecoderGetBasicInfo_pfn             = JxlDecoderStatus (*)(const JxlDecoder* dec, JxlBasicInfo* info);
     using JxlDecoderProcessInput_pfn             = JxlDecoderStatus (*)(      JxlDecoder* dec);
     using JxlDecoderCloseInput_pfn               = void             (*)(      JxlDecoder* dec);
+    using JxlDecoderReleaseInput_pfn             = size_t           (*)(      JxlDecoder* dec);
     using JxlDecoderSetPreferredColorProfile_pfn = JxlDecoderStatus (*)(      JxlDecoder* dec, const JxlColorEncoding* color_encoding);
     using JxlDecoderGetColorAsEncodedProfile_pfn = JxlDecoderStatus (*)(const JxlDecoder* dec, JxlColorProfileTarget target, JxlColorEncoding* color_encoding);
     using JxlDecoderSetParallelRunner_pfn        = JxlDecoderStatus (*)(      JxlDecoder* dec,
@@ -1682,6 +2074,7 @@ LoadLibraryTexture (image_s& image)
     JxlDecoderGetBasicInfo_pfn             jxlDecoderGetBasicInfo             = (JxlDecoderGetBasicInfo_pfn)            GetProcAddress (hModJXL, "JxlDecoderGetBasicInfo");
     JxlDecoderProcessInput_pfn             jxlDecoderProcessInput             = (JxlDecoderProcessInput_pfn)            GetProcAddress (hModJXL, "JxlDecoderProcessInput");
     JxlDecoderCloseInput_pfn               jxlDecoderCloseInput               = (JxlDecoderCloseInput_pfn)              GetProcAddress (hModJXL, "JxlDecoderCloseInput");
+    JxlDecoderReleaseInput_pfn             jxlDecoderReleaseInput             = (JxlDecoderReleaseInput_pfn)            GetProcAddress (hModJXL, "JxlDecoderReleaseInput");
     JxlDecoderSetImageOutBuffer_pfn        jxlDecoderSetImageOutBuffer        = (JxlDecoderSetImageOutBuffer_pfn)       GetProcAddress (hModJXL, "JxlDecoderSetImageOutBuffer");
     JxlDecoderSetImageOutBitDepth_pfn      jxlDecoderSetImageOutBitDepth      = (JxlDecoderSetImageOutBitDepth_pfn)     GetProcAddress (hModJXL, "JxlDecoderSetImageOutBitDepth");
     JxlDecoderSetParallelRunner_pfn        jxlDecoderSetParallelRunner        = (JxlDecoderSetParallelRunner_pfn)       GetProcAddress (hModJXL, "JxlDecoderSetParallelRunner");
@@ -1712,6 +2105,9 @@ LoadLibraryTexture (image_s& image)
     {
       JxlColorEncoding actual_encoding = { };
 
+      // The decoder's output, converted to FP16 scRGB once complete
+      SKIV_BufferPool::unique_ptr <uint8_t> jxl_pixels;
+
       JxlBasicInfo   info   = { };
       JxlPixelFormat format =
         { 4, JXL_TYPE_FLOAT, JXL_NATIVE_ENDIAN, 0 };
@@ -1723,12 +2119,41 @@ LoadLibraryTexture (image_s& image)
         (format.data_type == JXL_TYPE_FLOAT16) ? (sizeof (float)/2) * format.num_channels  :
                                                   sizeof (uint8_t)  * format.num_channels;
 
-      fseek  (pImageFile,                                 0, SEEK_SET  );
-      fread  (_scratchMemory.get (), _.getInitialSize (), 1, pImageFile);
-      rewind (pImageFile);
+      // Input of a download in progress: the bytes the decoder has yet to consume,
+      //   topped up from the stream whenever it runs out
+      std::vector <uint8_t> stream_input;
+      size_t                stream_offset = 0;
+      bool                  stream_closed = false;
+
+      if (stream != nullptr)
+      {
+        // Older libjxl builds cannot be topped up
+        if (jxlDecoderReleaseInput == nullptr)
+          stream->wait ();
+
+        stream_offset +=
+          stream->read (stream_offset, stream_input);
+
+        jxlDecoderSetInput   (jxl_decoder, stream_input.data (), stream_input.size ());
+
+        if (jxlDecoderReleaseInput == nullptr)
+        {
+          jxlDecoderCloseInput (jxl_decoder);
+          stream_closed = true;
+        }
+      }
 
-      jxlDecoderSetInput   (jxl_decoder, _scratchMemory.get (), _.getInitialSize ());
-      jxlDecoderCloseInput (jxl_decoder);
+      else
+      {
+        SKIV_TraceScope trace_read ("ReadFile");
+        fseek  (pImageFile,                                 0, SEEK_SET  );
+        fread  (_scratchMemory.get (), _.getInitialSize (), 1, pImageFile);
+        rewind (pImageFile);
+        trace_read.End ( );
+
+        jxlDecoderSetInput   (jxl_decoder, _scratchMemory.get (), _.getInitialSize ());
+        jxlDecoderCloseInput (jxl_decoder);
+      }
 
       for (;;)
       {
@@ -1743,8 +2168,36 @@ LoadLibraryTexture (image_s& image)
 
         else if (status == JXL_DEC_NEED_MORE_INPUT)
         {
-          PLOG_ERROR << "Error, already provided all input";
-          break;
+          if (stream == nullptr || stream_closed)
+          {
+            PLOG_ERROR << "Error, already provided all input";
+            break;
+          }
+
+          const size_t unconsumed =
+            jxlDecoderReleaseInput (jxl_decoder);
+
+          stream_input.erase (stream_input.begin (), stream_input.end () - unconsumed);
+
+          const size_t received =
+            stream->read (stream_offset, stream_input);
+
+          stream_offset += received;
+
+          jxlDecoderSetInput (jxl_decoder, stream_input.data (), stream_input.size ());
+
+          // The download has ended, whatever the decoder asks for next is missing
+          if (received == 0)
+          {
+            if (! stream->succeeded ())
+            {
+              PLOG_ERROR << "Error, the download failed";
+              break;
+            }
+
+            jxlDecoderCloseInput (jxl_decoder);
+            stream_closed = true;
+          }
         }
 
         else if (status == JXL_DEC_BASIC_INFO)
@@ -1800,24 +2253,20 @@ LoadLibraryTexture (image_s& image)
             break;
           }
 
-          if (SUCCEEDED (img.Initialize2D (DXGI_FORMAT_R32G32B32A32_FLOAT, static_cast <size_t> (image.width),
-                                                                           static_cast <size_t> (image.height), 1, 1)))
-          {
-            image.bpc      = info.bits_per_sample;
-            image.channels = info.num_color_channels;
+          jxl_pixels =
+            SKIV_BufferPool::GetInstance ( ).make_unique <uint8_t> (buffer_size);
 
-            void*  pixels_buffer      = static_cast <void *>(img.GetPixels ());
-            size_t pixels_buffer_size = img.GetPixelsSize ();
+          image.bpc      = info.bits_per_sample;
+          image.channels = info.num_color_channels;
 
-            std::ignore = jxlDecoderSetImageOutBitDepth;
+          std::ignore = jxlDecoderSetImageOutBitDepth;
 
-            if (JXL_DEC_SUCCESS != jxlDecoderSetImageOutBuffer(jxl_decoder, &format,
-                                                               pixels_buffer,
-                                                               pixels_buffer_size))
-            {
-              PLOG_ERROR << "JxlDecoderSetImageOutBuffer failed";
-              break;
-            }
+          if (JXL_DEC_SUCCESS != jxlDecoderSetImageOutBuffer(jxl_decoder, &format,
+                                                             jxl_pixels.get (),
+                                                             buffer_size))
+          {
+            PLOG_ERROR << "JxlDecoderSetImageOutBuffer failed";
+            break;
           }
         }
 
@@ -1829,8 +2278,6 @@ LoadLibraryTexture (image_s& image)
 
         else if (status == JXL_DEC_SUCCESS)
         {
-          succeeded = true;
-
           meta.format    = DXGI_FORMAT_R16G16B16A16_FLOAT;
           meta.width     = static_cast <size_t> (image.width);
           meta.height    = static_cast <size_t> (image.height);
@@ -1842,80 +2289,60 @@ LoadLibraryTexture (image_s& image)
           bool wcg = false;
           bool hdr = false;
 
-          using namespace DirectX;
-
-          ScratchImage converted_img;
-
-          const XMVECTOR vRelativeToAbsoluteNits =
-            XMVectorReplicate (info.intensity_target != 255.0f ? info.intensity_target / 80.0f
-                                                               : 1.0f);
+          // The decoder honors the preferred (scRGB) profile whenever it can, anything
+          //   else arrives in the image's own color space
+          skiv_cicp_s cicp = {
+            .primaries     = static_cast <uint8_t> (actual_encoding.primaries),
+            .transfer_func = static_cast <uint8_t> (actual_encoding.transfer_function),
+            .hlg_peak_nits = info.intensity_target,
+            .linear_scale  = info.intensity_target != 255.0f ? info.intensity_target / 80.0f
+                                                             : 1.0f
+          };
 
-          const bool bIsHDR10 =
-            actual_encoding.primaries         == JXL_PRIMARIES_2100 &&
-            actual_encoding.transfer_function == JXL_TRANSFER_FUNCTION_PQ;
+          if (actual_encoding.color_space != JXL_COLOR_SPACE_RGB &&
+              actual_encoding.color_space != JXL_COLOR_SPACE_GRAY)
+          {
+            PLOG_WARNING << "Unexpected color space " << (int)actual_encoding.color_space;
+          }
 
-          const bool bIsRec709Linear =
-            actual_encoding.primaries         == JXL_PRIMARIES_SRGB &&
-            actual_encoding.transfer_function == JXL_TRANSFER_FUNCTION_LINEAR;
+          if (actual_encoding.primaries == JXL_PRIMARIES_P3 && actual_encoding.white_point == JXL_WHITE_POINT_D65)
+          {
+            cicp.primaries = 12; // Display P3
+          }
 
-          if (actual_encoding.white_point != JXL_WHITE_POINT_D65)
+          else if (actual_encoding.white_point != JXL_WHITE_POINT_D65 && actual_encoding.primaries != JXL_PRIMARIES_P3)
           {
             PLOG_WARNING << "Unexpected non-D65 white point";
           }
 
-          if (! (bIsHDR10 || bIsRec709Linear))
+          if (actual_encoding.primaries == JXL_PRIMARIES_CUSTOM)
           {
-            PLOG_WARNING << "Encoded image is neither HDR10 nor scRGB...";
+            PLOG_WARNING << "Custom primaries are unsupported, assuming BT.709";
           }
 
-          if ( SUCCEEDED ( TransformImage (*img.GetImages (),
-                [&](      XMVECTOR* outPixels,
-                    const XMVECTOR* inPixels,
-                          size_t    width,
-                          size_t    y)
-                {
-                  UNREFERENCED_PARAMETER(y);
-                
-                  for (size_t j = 0; j < width; ++j)
-                  {
-                    XMVECTOR v = inPixels [j];
-
-                    if (bIsRec709Linear)
-                    {
-                      v =
-                        XMVectorMultiply (v, vRelativeToAbsoluteNits);
-                    }
-
-                    else if (bIsHDR10)
-                    {
-                      v =
-                        XMVector3Transform (SKIV_Image_PQToLinear (v), c_Bt2100toscRGB);
-                    }
-
-                    uint32_t xm_test_rec709 = 0x0,
-                             xm_test_hdr    = 0x0;
-
-                    if (XMVectorGreaterOrEqualR (&xm_test_rec709, v, g_XMZero);
-                        XMComparisonAnyFalse    ( xm_test_rec709))
-                    {
-                      wcg = true;
-                    }
+          if (actual_encoding.transfer_function == JXL_TRANSFER_FUNCTION_GAMMA)
+          {
+            cicp.transfer_func = std::abs (1.0 / actual_encoding.gamma - 2.2) < 0.05 ? uint8_t (4) :
+                                 std::abs (1.0 / actual_encoding.gamma - 2.8) < 0.05 ? uint8_t (5) : uint8_t (0);
+          }
 
-                    if (XMVectorGreaterR    (&xm_test_hdr, v, g_XMOne);
-                        XMComparisonAnyTrue ( xm_test_hdr))
-                    {
-                      hdr = true;
-                    }
+          const DirectX::Image signal = {
+            .width      = meta.width,
+            .height     = meta.height,
+            .format     = DXGI_FORMAT_R32G32B32A32_FLOAT,
+            .rowPitch   = meta.width * bpp,
+            .slicePitch = meta.width * bpp * meta.height,
+            .pixels     = jxl_pixels.get ()
+          };
 
-                    outPixels [j] = v;
-                  }
-                }, converted_img )
-              )
-            )
+          if (jxl_pixels == nullptr || FAILED (SKIV_Image_DecodeCICP (signal, cicp, img, wcg, hdr)))
           {
-            DirectX::Convert (*converted_img.GetImages (), DXGI_FORMAT_R16G16B16A16_FLOAT, DirectX::TEX_FILTER_DEFAULT, 0.0f, img);
+            PLOG_ERROR << "Failed to convert the decoded image to scRGB";
+            break;
           }
 
+          succeeded = true;
+
           image.light_info.isHDR = wcg||hdr;
           image.is_hdr           = wcg||hdr;
 
@@ -1937,321 +2364,243 @@ LoadLibraryTexture (image_s& image)
       jxlResizableParallelRunnerDestroy (nullptr);
   }
 
-  // Push the existing texture to a stack to be released after the frame
-  //   Do this regardless of whether we could actually load the new cover or not
-  if (image.pRawTexSRV.p != nullptr)
-  {
-    extern concurrency::concurrent_queue <IUnknown *> SKIF_ResourcesToFree;
-    PLOG_VERBOSE << "SKIF_ResourcesToFree: Pushing " << image.pRawTexSRV.p << " to be released";;
-    SKIF_ResourcesToFree.push (image.pRawTexSRV.p);
-    image.pRawTexSRV.p = nullptr;
-  }
-
-  if (! succeeded)
-    return false;
-
-  DirectX::ScratchImage* pImg  =   &img;
-  DirectX::ScratchImage   converted_img;
-
-  // We don't want single-channel icons, so convert to RGBA
-  if (meta.format == DXGI_FORMAT_R8_UNORM)
-  {
-    if (SUCCEEDED (DirectX::Convert (pImg->GetImages(), pImg->GetImageCount(), pImg->GetMetadata (), DXGI_FORMAT_R8G8B8A8_UNORM, DirectX::TEX_FILTER_DEFAULT, 0.0f, converted_img)))
-    {
-      meta =  converted_img.GetMetadata ();
-      pImg = &converted_img;
-    }
-  }
+  // Remember HDR images read using the WIC encoder
+  if (succeeded && (meta.format == DXGI_FORMAT_R16G16B16A16_FLOAT  ||
+                    meta.format == DXGI_FORMAT_R32G32B32A32_FLOAT) && decoder == ImageDecoder_WIC)
+    image.light_info.isHDR = true;
 
-#if 0
-  // Downscale covers to 220x330, which will then be shown in horizon mode
-  if (false)
-  {
-    size_t width  = 220;
-    size_t height = 330;
+  return succeeded;
+}
 
-    if (
-      SUCCEEDED (
-        DirectX::Resize (
-          pImg->GetImages   (), pImg->GetImageCount (),
-          pImg->GetMetadata (), width, height,
-          DirectX::TEX_FILTER_FANT,
-              converted_img
-        )
-      )
-    )
-    {
-      meta =  converted_img.GetMetadata ();
-      pImg = &converted_img;
-    }
-  }
-#endif
+// CPU-only decode for the headless /Convert batch mode
+bool
+SKIV_Viewer_LoadImageFromFile (const std::wstring& path, DirectX::ScratchImage& result, bool& is_hdr, skiv_export_size_s* export_size)
+{
+  image_s              image;
+  DirectX::TexMetadata meta    = { };
+  ImageDecoder         decoder = ImageDecoder_None;
 
-  auto pDevice =
-    SKIF_D3D11_GetDevice ();
+  image.file_info.path = path;
 
-  if (! pDevice)
+  if (! SKIV_Viewer_DecodeImage (image, result, meta, decoder, export_size))
     return false;
 
-  pRawTex2D        = nullptr;
-
-  succeeded = false;
-
-  if (image.is_hdr)
-  {
-    using namespace DirectX;
+  is_hdr = image.is_hdr || image.light_info.isHDR;
 
-    assert (meta.format == DXGI_FORMAT_R16G16B16A16_FLOAT ||
-            meta.format == DXGI_FORMAT_R32G32B32A32_FLOAT);
-
-    XMVECTOR vMaxCLL   =   g_XMZero;
-    float    fMaxLum   =       0.0f;
-    float    fMinLum   = 5240320.0f;
-    float    fMaxLum99 =       0.0f;
-
-    auto        luminance_freq = std::make_unique <uint32_t []> (65536);
-    ZeroMemory (luminance_freq.get (),     sizeof (uint32_t)  *  65536);
-
-    double dLumAccum = 0.0;
-
-    static constexpr float FLT16_MIN = 0.0000000894069671630859375f;
-
-    EvaluateImage ( pImg->GetImages     (),
-                    pImg->GetImageCount (),
-                    pImg->GetMetadata   (),
-    [&](const XMVECTOR* pixels, size_t width, size_t y)
-    {
-      UNREFERENCED_PARAMETER(y);
-
-      XMVECTOR vColorXYZ;
-      XMVECTOR vColorDCIP3;
-      XMVECTOR vColor2020;
-      XMVECTOR vColorAP1;
-      XMVECTOR vColorAP0;
-      XMVECTOR v;
-
-      uint32_t xm_test_all = 0x0;
-
-      double dScanlineLum = 0.0;
+  return true;
+}
 
-      for (size_t j = 0; j < width; ++j)
-      {
-        v = *pixels;
+bool
+LoadLibraryTexture (image_s& image)
+{
+  SKIV_ScopedThreadPriority_Viewer _scoped_thread_prio;
+  SKIV_TRACE_SCOPE ("LoadLibraryTexture");
 
-        vMaxCLL =
-          XMVectorMax (v, vMaxCLL);
+  CComPtr <ID3D11Texture2D> pRawTex2D;
+  DirectX::TexMetadata        meta      = { };
+  DirectX::ScratchImage        img      = { };
+  ImageDecoder              decoder     = ImageDecoder_None;
 
-        vColorXYZ =
-          XMVector3Transform (v, c_from709toXYZ);
+  DWORD pre = SKIF_Util_timeGetTime1 ();
 
-        xm_test_all = 0x0;
+  // Images that were slow to decode may be in the image cache (utility/image_cache.h);
+  //   the statistics computed below come with them. Downloads in progress are not.
+  skiv_image_cache_info_s cached_info;
 
-        #define FP16_MIN 0.0005f
+  const bool cache_hit =
+    SKIV_Stream_Find     (image.file_info.path) == nullptr &&
+    SKIV_ImageCache_Load (image.file_info.path, img, cached_info);
 
-        if (XMVectorGreaterOrEqualR (&xm_test_all, v, g_XMZero);
-            XMComparisonAllTrue     ( xm_test_all) || XMVectorGetY (vColorXYZ) < FP16_MIN)
-        {
-          image.colorimetry.pixel_counts.rec_709++;
-        }
+  bool succeeded = cache_hit;
 
-        else
-        {
-          vColorDCIP3 =
-            XMVector3Transform (v, c_from709toDCIP3);
+  if (cache_hit)
+  {
+    meta                           = img.GetMetadata ();
+    image.bpc                      = cached_info.bpc;
+    image.channels                 = cached_info.channels;
+    image.is_hdr                   = cached_info.is_hdr;
+    image.is_dds                   = cached_info.is_dds;
+    image.light_info.isHDR         = cached_info.light_is_hdr;
+    image.light_info.max_cll       = cached_info.max_cll;
+    image.light_info.max_cll_name  = cached_info.max_cll_name;
+    image.light_info.max_nits      = cached_info.max_nits;
+    image.light_info.min_nits      = cached_info.min_nits;
+    image.light_info.avg_nits      = cached_info.avg_nits;
+    image.light_info.p99_nits      = cached_info.p99_nits;
+    image.colorimetry.pixel_counts = cached_info.pixel_counts;
+
+    PLOG_INFO << "[Image Processing] Read image from the image cache in " << (SKIF_Util_timeGetTime1 ( ) - pre) << " ms.";
+  }
 
-          if (XMVectorGreaterOrEqualR (&xm_test_all, vColorDCIP3, g_XMZero);
-              XMComparisonAnyFalse    ( xm_test_all))
-          {
-            vColor2020 =
-              XMVector3Transform (v, c_from709to2020);
+  else
+    succeeded = SKIV_Viewer_DecodeImage (image, img, meta, decoder);
 
-            if (XMVectorGreaterOrEqualR (&xm_test_all, vColor2020, g_XMZero);
-                XMComparisonAnyFalse    ( xm_test_all))
-            {
-              vColorAP1 =
-                XMVector3Transform (v, c_from709toAP1);
+  const DWORD decode_ms =
+    SKIF_Util_timeGetTime1 ( ) - pre;
 
-              if (XMVectorGreaterOrEqualR (&xm_test_all, vColorAP1, g_XMZero);
-                  XMComparisonAnyFalse    ( xm_test_all))
-              {
-                vColorAP0 =
-                  XMVector3Transform (v, c_from709toAP0);
+  // Push the existing texture to a stack to be released after the frame
+  //   Do this regardless of whether we could actually load the new cover or not
+  if (image.pRawTexSRV.p != nullptr)
+  {
+    extern concurrency::concurrent_queue <IUnknown *> SKIF_ResourcesToFree;
+    PLOG_VERBOSE << "SKIF_ResourcesToFree: Pushing " << image.pRawTexSRV.p << " to be released";;
+    SKIF_ResourcesToFree.push (image.pRawTexSRV.p);
+    image.pRawTexSRV.p = nullptr;
+  }
 
-                if (XMVectorGreaterOrEqualR (&xm_test_all, vColorAP0, g_XMZero);
-                    XMComparisonAnyFalse    ( xm_test_all))
-                {
-                  image.colorimetry.pixel_counts.undefined++;
-                }
+  image.tiles  = nullptr;
+  image.pixels = nullptr;
 
-                else
-                {
-                  image.colorimetry.pixel_counts.ap0++;
-                }
-              }
+  if (! succeeded)
+    return false;
 
-              else
-              {
-                image.colorimetry.pixel_counts.ap1++;
-              }
-            }
+  SKIV_Trace_Counter ("Image Megapixels", static_cast <double> (meta.width * meta.height) / 1000000.0);
 
-            else
-            {
-              image.colorimetry.pixel_counts.rec_2020++;
-            }
-          }
+  DirectX::ScratchImage* pImg  =   &img;
+  DirectX::ScratchImage   converted_img;
 
-          else
-          {
-            image.colorimetry.pixel_counts.dci_p3++;
-          }
-        }
+  // We don't want single-channel icons, so convert to RGBA
+  if (meta.format == DXGI_FORMAT_R8_UNORM)
+  {
+    if (SUCCEEDED (DirectX::Convert (pImg->GetImages(), pImg->GetImageCount(), pImg->GetMetadata (), DXGI_FORMAT_R8G8B8A8_UNORM, DirectX::TEX_FILTER_DEFAULT, 0.0f, converted_img)))
+    {
+      meta =  converted_img.GetMetadata ();
+      pImg = &converted_img;
+    }
+  }
 
-        image.colorimetry.pixel_counts.total++;
+#if 0
+  // Downscale covers to 220x330, which will then be shown in horizon mode
+  if (false)
+  {
+    size_t width  = 220;
+    size_t height = 330;
 
-        const float fLum =
-          XMVectorGetY (vColorXYZ);
+    if (
+      SUCCEEDED (
+        DirectX::Resize (
+          pImg->GetImages   (), pImg->GetImageCount (),
+          pImg->GetMetadata (), width, height,
+          DirectX::TEX_FILTER_FANT,
+              converted_img
+        )
+      )
+    )
+    {
+      meta =  converted_img.GetMetadata ();
+      pImg = &converted_img;
+    }
+  }
+#endif
 
-        fMaxLum =
-          std::max (fMaxLum, fLum);
-        fMinLum =
-          std::min (fMinLum, fLum);
+  auto pDevice =
+    SKIF_D3D11_GetDevice ();
 
-        dScanlineLum +=
-          std::max (0.0, static_cast <double> (fLum));
+  if (! pDevice)
+    return false;
 
-        pixels++;
-      }
+  pRawTex2D        = nullptr;
 
-      dLumAccum +=
-        (dScanlineLum / static_cast <float> (width));
-    } );
+  succeeded = false;
 
-    float fMaxLumActual =           fMaxLum;
-    float fMinLumActual = std::max (fMinLum, 0.0f);
+  // Images beyond the maximum texture dimension, or too large for the video
+  //   memory that is left, are split into tiles, and the texture created below
+  //     becomes a downscaled overview of the image.
+  DirectX::ScratchImage preview_img;
+  DirectX::ScratchImage coverage_img; // CIE 1931 plot of HDR images
+  DirectX::TexMetadata  tex_meta = meta;
 
-    // 0 nits - 10k nits (appropriate for screencap, but not HDR photography)
-    fMinLum = std::clamp (fMinLum, 0.0f,    125.0f);
-    fMaxLum = std::clamp (fMaxLum, fMinLum, 125.0f);
+  const size_t video_memory =
+    SKIV_Viewer_GetAvailableVideoMemory (pDevice);
 
-    const float fLumRange =
-            (fMaxLum - fMinLum);
+  const size_t texture_bytes = // With a full mip chain
+    pImg->GetPixelsSize () / 3 * 4;
 
-    EvaluateImage ( pImg->GetImages     (),
-                    pImg->GetImageCount (),
-                    pImg->GetMetadata   (),
-    [&](const XMVECTOR* pixels, size_t width, size_t y)
-    {
-      UNREFERENCED_PARAMETER(y);
+  if (skiv_tiled_image_s::IsRequired (meta.width, meta.height, texture_bytes, video_memory))
+  {
+    auto tiles =
+      std::make_shared <skiv_tiled_image_s> ();
 
-      for (size_t j = 0; j < width; ++j)
-      {
-        XMVECTOR v = *pixels++;
+    if (video_memory != 0)
+      tiles->budget = std::min (SKIV_TILE_BUDGET, video_memory / 2);
 
-        v =
-          XMVectorMax (g_XMZero, XMVector3Transform (v, c_from709toXYZ));
+    // The preview is resampled from the full decode, which the tiles need
+    //   anyway; a second, DCT-scaled decode of a JPEG (SKIV_Image_GetJPEGScale)
+    //     would cost more than the resampling it saves.
+    if (FAILED (tiles->Create        (std::move (*pImg))) ||
+        FAILED (tiles->CreatePreview (preview_img)))
+    {
+      PLOG_ERROR << "Failed to create the tiles of a " << meta.width << "x" << meta.height << " image!";
+      return false;
+    }
 
-        luminance_freq [
-          std::clamp ( (int)
-            std::roundf (
-              (XMVectorGetY (v) - fMinLum) /
-                                    (fLumRange / 65536.0f) ),
-                                              0, 65535 ) ]++;
-      }
-    });
+    // The tiled image now holds the decoded pixels
+    pImg        = &tiles->image;
+    image.tiles = tiles;
+    tex_meta    = preview_img.GetMetadata ();
+  }
 
-          double percent  = 100.0;
-    const double img_size = (double)pImg->GetMetadata ().width *
-                            (double)pImg->GetMetadata ().height;
+  if (image.is_hdr && cache_hit)
+  {
+    if (FAILED (SKIV_Image_AccumulateCIE1931 (*pImg->GetImage (0, 0, 0), coverage_img)))
+      PLOG_WARNING << "Failed to accumulate the CIE 1931 coverage of the image";
+  }
 
-    for (auto i = 65535; i >= 0; --i)
-    {
-      percent -=
-        100.0 * ((double)luminance_freq [i] / img_size);
+  else if (image.is_hdr)
+  {
+    SKIV_TRACE_SCOPE ("Statistics");
 
-      if (percent <= 99.94)
-      {
-        PLOG_INFO << "99.94th percentile luminance: " <<
-          80.0f * (fMinLum + (fLumRange * ((float)i / 65536.0f)))
-                                                      << " nits";
+    assert (meta.format == DXGI_FORMAT_R16G16B16A16_FLOAT ||
+            meta.format == DXGI_FORMAT_R32G32B32A32_FLOAT);
 
-        fMaxLum99 =
-            fMinLum + (fLumRange * ((float)i / 65536.0f));
+    // Gamut coverage is classified in its own vectorized, multi-threaded pass
+    image.colorimetry.pixel_counts =
+      SKIV_Image_ClassifyGamut (*pImg->GetImage (0, 0, 0));
 
-        break;
-      }
-    }
+    // The chromaticity plot only depends on the image, so it is built once here
+    //   instead of being scattered into a UAV by the pixel shader every frame.
+    if (FAILED (SKIV_Image_AccumulateCIE1931 (*pImg->GetImage (0, 0, 0), coverage_img)))
+      PLOG_WARNING << "Failed to accumulate the CIE 1931 coverage of the image";
 
-    const float fMaxCLL =
-      std::max ({
-        XMVectorGetX (vMaxCLL),
-        XMVectorGetY (vMaxCLL),
-        XMVectorGetZ (vMaxCLL)
-      });
+    const skiv_image_light_s light =
+      SKIV_Image_MeasureLight (*pImg->GetImage (0, 0, 0));
 
-    XMVECTOR vMaxCLLReplicated =
-      XMVectorReplicate (fMaxCLL);
+    image.light_info.max_cll      = light.max_cll;
+    image.light_info.max_cll_name = light.max_cll_name;
+    image.light_info.max_nits     = light.max_nits;
+    image.light_info.min_nits     = light.min_nits;
+    image.light_info.p99_nits     = light.p99_nits;
+    image.light_info.avg_nits     = light.avg_nits;
+  }
 
-    char cMaxChannel =
-      fMaxCLL == XMVectorGetX (vMaxCLL) ? 'R' :
-      fMaxCLL == XMVectorGetY (vMaxCLL) ? 'G' :
-      fMaxCLL == XMVectorGetZ (vMaxCLL) ? 'B' :
-                                          'X';
+  SKIV_TRACE_SCOPE ("CreateTexture");
 
-    // Use the maximum luminance if for some reason the percentile calc failed
-    if (fMaxLum99 <= 0.01f)
-        fMaxLum99  = fMaxLum;
+  DirectX::ScratchImage* pTexImg =
+    (image.tiles != nullptr) ? &preview_img : pImg;
 
-    image.light_info.max_cll      = fMaxCLL;
-    image.light_info.max_cll_name = cMaxChannel;
-    image.light_info.max_nits     = std::max (0.0f, fMaxLumActual * 80.0f); // scRGB
-    image.light_info.min_nits     = std::max (0.0f, fMinLumActual * 80.0f); // scRGB
-    image.light_info.p99_nits     = std::max (0.0f, fMaxLum99     * 80.0f); // scRGB
+  // Fit mode minifies large images heavily every frame; a full mip chain lets the
+  //   trilinear sampler read a level close to the displayed size instead.
+  DirectX::ScratchImage mip_img;
 
-    // We use the sum of averages per-scanline to help avoid overflow
-    image.light_info.avg_nits     = static_cast <float> (80.0 *
-      (dLumAccum / static_cast <double> (meta.height)));
+  if (tex_meta.mipLevels == 1 && tex_meta.arraySize == 1 &&
+      tex_meta.dimension == DirectX::TEX_DIMENSION_TEXTURE2D && ! DirectX::IsCompressed (tex_meta.format) &&
+      SUCCEEDED (SKIV_Image_GenerateMipMaps (*pTexImg->GetImage (0, 0, 0), mip_img)))
+  {
+    pTexImg            = &mip_img;
+    tex_meta.mipLevels = mip_img.GetMetadata ().mipLevels;
   }
 
   HRESULT hr =
-    DirectX::CreateTexture (pDevice, pImg->GetImages (), pImg->GetImageCount (), meta, (ID3D11Resource **)&pRawTex2D.p);
+    DirectX::CreateTexture (pDevice, pTexImg->GetImages (), pTexImg->GetImageCount (), tex_meta, (ID3D11Resource **)&pRawTex2D.p);
 
   if (SUCCEEDED (hr))
   {
-    if (image.is_hdr)
+    if (image.is_hdr && coverage_img.GetImageCount () != 0)
     {
-      D3D11_TEXTURE2D_DESC
-        texDesc            = { };
-        texDesc.BindFlags  = D3D11_BIND_UNORDERED_ACCESS | D3D11_BIND_SHADER_RESOURCE;
-        texDesc.Format     = DXGI_FORMAT_R16G16B16A16_FLOAT;
-        texDesc.SampleDesc = { .Count   = 1,
-                               .Quality = 0 };
-        texDesc.Usage      = D3D11_USAGE_DEFAULT;
-        texDesc.ArraySize  = 1;
-        texDesc.Width      = 1024;
-        texDesc.Height     = 1024;
-
-      if (SUCCEEDED (pDevice->CreateTexture2D (&texDesc, nullptr, &pGamutCoverageTex2D.p)))
-      {
-        pDevice->CreateUnorderedAccessView (pGamutCoverageTex2D.p, nullptr, &image.pGamutCoverageUAV.p);
-        pDevice->CreateShaderResourceView  (pGamutCoverageTex2D.p, nullptr, &image.pGamutCoverageSRV.p);
-
-        CComPtr <ID3D11DeviceContext>  pDevCtx;
-        pDevice->GetImmediateContext (&pDevCtx);
-
-        if (pDevCtx.p != nullptr)
-        {
-          FLOAT fClearColor [] = { 0.f, 0.f, 0.f, 0.f };
-          pDevCtx->ClearUnorderedAccessViewFloat (image.pGamutCoverageUAV, fClearColor);
-        }
-      }
+      DirectX::CreateShaderResourceView (pDevice, coverage_img.GetImages (), coverage_img.GetImageCount (),
+                                                  coverage_img.GetMetadata (), &image.pGamutCoverageSRV.p);
     }
 
-    // Remember HDR images read using the WIC encoder
-    if ((meta.format == DXGI_FORMAT_R16G16B16A16_FLOAT  ||
-         meta.format == DXGI_FORMAT_R32G32B32A32_FLOAT) && decoder == ImageDecoder_WIC)
-      image.light_info.isHDR = true;
-
     D3D11_SHADER_RESOURCE_VIEW_DESC
     srv_desc                           = { };
     srv_desc.Format                    = DXGI_FORMAT_UNKNOWN;
@@ -2268,12 +2617,36 @@ LoadLibraryTexture (image_s& image)
       image.width  = static_cast<float>(meta.width);
       image.height = static_cast<float>(meta.height);
 
+      // Tiled images already keep their pixels on the CPU
+      if (image.tiles == nullptr)
+        image.pixels = std::make_shared <DirectX::ScratchImage> (std::move (*pImg));
+
+      // Written in the background from the retained pixels, so tiled images are not cached
+      if (! cache_hit && decode_ms >= SKIV_IMAGE_CACHE_MIN_DECODE_MS && SKIV_ImageCache_IsEnabled ())
+      {
+        skiv_image_cache_info_s info;
+
+        info.bpc          = image.bpc;
+        info.channels     = image.channels;
+        info.is_hdr       = image.is_hdr;
+        info.is_dds       = image.is_dds;
+        info.light_is_hdr = image.light_info.isHDR;
+        info.max_cll      = image.light_info.max_cll;
+        info.max_cll_name = image.light_info.max_cll_name;
+        info.max_nits     = image.light_info.max_nits;
+        info.min_nits     = image.light_info.min_nits;
+        info.avg_nits     = image.light_info.avg_nits;
+        info.p99_nits     = image.light_info.p99_nits;
+        info.pixel_counts = image.colorimetry.pixel_counts;
+
+        SKIV_ImageCache_Store (image.file_info.path, image.pixels, info);
+      }
+
       succeeded = true;
     }
 
     // SRV is holding a reference, this is not needed anymore.
-    pRawTex2D           = nullptr;
-    pGamutCoverageTex2D = nullptr;
+    pRawTex2D = nullptr;
   }
 
   return succeeded;
@@ -2405,6 +2778,36 @@ image_s                  cover     = { },
                          cover_old = { };
 int              tmp_iDarkenImages = _registry.iDarkenImages;
 
+// Hand-off slot between the image worker and the UI thread. The worker fills in
+//   an image of its own and publishes it with a single exchange; the UI thread
+//     takes it at the start of its next frame, so cover is only ever written by
+//       the UI thread and never seen half-updated. The decoded pixels and tiles
+//         are reference counted, never copied: cover, the image cache and any
+//           export still running on the previous image all share them.
+static std::atomic <image_s*> SKIV_LoadedImage = nullptr;
+
+// Images that never made it on screen; their textures go through the deferred
+//   release queue like every other texture the render thread is done with
+static void
+SKIV_Viewer_RetireImage (image_s* image)
+{
+  if (image->pRawTexSRV.p != nullptr)
+  {
+    PLOG_VERBOSE << "SKIF_ResourcesToFree: Pushing " << image->pRawTexSRV.p << " to be released";
+    SKIF_ResourcesToFree.push(image->pRawTexSRV.p);
+    image->pRawTexSRV.p = nullptr;
+  }
+
+  if (image->pGamutCoverageSRV.p != nullptr)
+  {
+    PLOG_VERBOSE << "SKIF_ResourcesToFree: Pushing " << image->pGamutCoverageSRV.p << " to be released";
+    SKIF_ResourcesToFree.push(image->pGamutCoverageSRV.p);
+    image->pGamutCoverageSRV.p = nullptr;
+  }
+
+  delete image;
+}
+
 int32_t ImGuiToast::maxAssignedId = 0;
 
 uint32_t
@@ -2501,7 +2904,7 @@ SKIF_UI_Tab_DrawViewer (void)
         if (pTexResource.p != nullptr)
         {
           DirectX::ScratchImage                                                     captured_img;
-          if (SUCCEEDED (DirectX::CaptureTexture (pDevice, pDevCtx, pTexResource.p, captured_img)))
+          if (SUCCEEDED (SKIV_Viewer_CaptureImage (cover, pDevice, pDevCtx, pTexResource.p, captured_img)))
           {
             if (copyRect.GetArea () != 0)
             {
@@ -2603,13 +3006,6 @@ SKIF_UI_Tab_DrawViewer (void)
         cover_old.pGamutCoverageSRV.p = nullptr;
       }
 
-      if (cover_old.pGamutCoverageUAV.p != nullptr)
-      {
-        PLOG_VERBOSE << "SKIF_ResourcesToFree: Pushing " << cover_old.pGamutCoverageUAV.p << " to be released";;
-        SKIF_ResourcesToFree.push(cover_old.pGamutCoverageUAV.p);
-        cover_old.pGamutCoverageUAV.p = nullptr;
-      }
-
       // Set up the current one to be released
       cover_old = cover;
       cover.reset();
@@ -2655,13 +3051,6 @@ SKIF_UI_Tab_DrawViewer (void)
       SKIF_ResourcesToFree.push(cover_old.pGamutCoverageSRV.p);
       cover_old.pGamutCoverageSRV.p = nullptr;
     }
-
-    if (cover_old.pGamutCoverageUAV.p != nullptr)
-    {
-      PLOG_VERBOSE << "SKIF_ResourcesToFree: Pushing " << cover_old.pGamutCoverageUAV.p << " to be released";;
-      SKIF_ResourcesToFree.push(cover_old.pGamutCoverageUAV.p);
-      cover_old.pGamutCoverageUAV.p = nullptr;
-    }
   }
 
   // Apply changes when the image changes
@@ -2675,6 +3064,34 @@ SKIF_UI_Tab_DrawViewer (void)
     tmp_iDarkenImages = _registry.iDarkenImages;
   }
 
+  // Swap in the image the worker published, if any
+  if (image_s* loaded = SKIV_LoadedImage.exchange (nullptr))
+  {
+    cover.file_info         = loaded->file_info;
+    cover.bpc               = loaded->bpc;
+    cover.channels          = loaded->channels;
+    cover.width             = loaded->width;
+    cover.height            = loaded->height;
+    cover.zoom              = loaded->zoom;
+    cover.uv0               = loaded->uv0;
+    cover.uv1               = loaded->uv1;
+    cover.pRawTexSRV        = loaded->pRawTexSRV;
+    cover.pGamutCoverageSRV = loaded->pGamutCoverageSRV;
+    cover.tiles             = loaded->tiles;
+    cover.pixels            = loaded->pixels;
+    cover.light_info        = loaded->light_info;
+    cover.colorimetry       = loaded->colorimetry;
+    cover.is_hdr            = loaded->is_hdr;
+    cover.is_dds            = loaded->is_dds;
+
+    extern ImVec2 SKIV_ResizeApp;
+    SKIV_ResizeApp.x = cover.width;
+    SKIV_ResizeApp.y = cover.height;
+
+    // cover holds its own references to the textures and pixels now
+    delete loaded;
+  }
+
   if (newImageFailed)
   {
     newImageFailed   = false;
@@ -2948,9 +3365,6 @@ SKIF_UI_Tab_DrawViewer (void)
         ? AdjustAlpha (fTint)
         : fTint;
  
-  bool bIsHDR =
-    cover_old.is_hdr;
-
   SKIV_HDR_MaxCLL       = cover_old.light_info.max_cll;
   SKIV_HDR_MaxLuminance = cover_old.light_info.max_nits;
 
@@ -2982,21 +3396,6 @@ SKIF_UI_Tab_DrawViewer (void)
     fading = true;
   }
 
-  bIsHDR =
-    cover.is_hdr;
-
-  if (bIsHDR && (! fading))
-  {
-    SKIV_HDR_GamutCoverageUAV = cover.pGamutCoverageUAV;
-    SKIV_HDR_GamutCoverageSRV = cover.pGamutCoverageSRV;
-  }
-
-  else
-  {
-    SKIV_HDR_GamutCoverageUAV = nullptr;
-    SKIV_HDR_GamutCoverageSRV = nullptr;
-  }
-
   SKIV_HDR_MaxCLL          = cover.light_info.max_cll;
   SKIV_HDR_MaxLuminanceP99 = cover.light_info.p99_nits;
   SKIV_HDR_MaxLuminance    = cover.light_info.max_nits;
@@ -3024,6 +3423,60 @@ SKIF_UI_Tab_DrawViewer (void)
 
   isImageHovered = ImGui::IsItemHovered();
 
+  // Gigapixel images: once zoomed in beyond the resolution of the overview,
+  //   draw the visible full resolution tiles on top of it
+  if (cover.tiles != nullptr && cover.pRawTexSRV.p != nullptr && image_rect.GetArea () > 0.0f)
+  {
+    auto& tiles = *cover.tiles;
+
+    // HDR and DDS images are always drawn in full, the reserved UVs cannot express a crop
+    const bool   full_uv = (cover.light_info.isHDR || cover.is_dds);
+    const ImVec2 uv0     = full_uv ? ImVec2 (0.0f, 0.0f) : cover.uv0;
+    const ImVec2 uv1     = full_uv ? ImVec2 (1.0f, 1.0f) : cover.uv1;
+    const ImVec2 uv_size = uv1 - uv0;
+
+    const ImVec2 scale   = ImVec2 (sizeCover.x / (uv_size.x * tiles.width),
+                                   sizeCover.y / (uv_size.y * tiles.height)); // Screen pixels per image pixel
+    const ImVec2 origin  = image_pos - ImVec2 (uv0.x * tiles.width  * scale.x,
+                                               uv0.y * tiles.height * scale.y);
+
+    if (scale.x * tiles.width > static_cast <float> (tiles.preview_width))
+    {
+      ImDrawList* draw_list =
+        ImGui::GetWindowDrawList ();
+
+      ImRect visible_rect = image_rect;
+      visible_rect.ClipWithFull (ImRect (draw_list->GetClipRectMin ( ), draw_list->GetClipRectMax ( )));
+
+      tiles.UpdateResidency ( SKIF_D3D11_GetDevice ( ),
+                                (visible_rect.Min.x - origin.x) / scale.x, (visible_rect.Min.y - origin.y) / scale.y,
+                                (visible_rect.Max.x - origin.x) / scale.x, (visible_rect.Max.y - origin.y) / scale.y );
+
+      const ImU32 tint =
+        ImGui::GetColorU32 ((_registry._StyleLightMode) ? ImVec4 (1.0f, 1.0f, 1.0f, fGammaCorrectedTint * AdjustAlpha (fAlpha)) :
+                                                          ImVec4 (1.f, 1.f, 1.f, 1.f));
+
+      draw_list->PushClipRect (visible_rect.Min, visible_rect.Max, true);
+
+      for (auto& tile : tiles.tiles)
+      {
+        if (! tiles.IsVisible (tile))
+          continue;
+
+        const ImVec2 tile_min = origin + ImVec2 (static_cast <float> (tile.x)               * scale.x,
+                                                 static_cast <float> (tile.y)               * scale.y);
+        const ImVec2 tile_max = origin + ImVec2 (static_cast <float> (tile.x + tile.width)  * scale.x,
+                                                 static_cast <float> (tile.y + tile.height) * scale.y);
+
+        draw_list->AddImage ( (ImTextureID)tile.pSRV.p, tile_min, tile_max,
+                                cover.light_info.isHDR ? hdr_uv0 : cover.is_dds ? srgb_uv0 : ImVec2 (0.0f, 0.0f),
+                                cover.light_info.isHDR ? hdr_uv1 : cover.is_dds ? srgb_uv1 : ImVec2 (1.0f, 1.0f), tint );
+      }
+
+      draw_list->PopClipRect ( );
+    }
+  }
+
   // Reset scroll (center-align the scroll)
   if (resetScrollCenter && cover_old.pRawTexSRV.p == nullptr)
   {
@@ -3439,6 +3892,8 @@ SKIF_UI_Tab_DrawViewer (void)
         SaveFileDialog  = PopupState_Open;
       if (ImGui::Button (ICON_FA_FILE_EXPORT " Export to SDR"))
         ExportSDRDialog = PopupState_Open;
+      if (ImGui::Button (ICON_FA_FILE_EXPORT " Export Visualization"))
+        ExportVizDialog = PopupState_Open;
 
       ImGui::Spacing (); ImGui::Spacing (); ImGui::Spacing (); ImGui::Spacing ();
       //ImGui::TextUnformatted ("");
@@ -3706,6 +4161,102 @@ SKIF_UI_Tab_DrawViewer (void)
 
 #pragma endregion
 
+#pragma region Exports
+
+  static std::vector <skiv_export_status_s> exports;
+  SKIV_Export_GetJobs (exports);
+
+  bool exports_pending = false;
+
+  for (const auto& job : exports)
+  {
+    const char* szTitle =
+      (job.mode == SKIV_Export_Visualization) ? "Visualization Export" :
+      (job.mode == SKIV_Export_SDR)           ? "SDR Export"
+                                              : "File Save";
+
+    switch (job.state)
+    {
+      case SKIV_ExportState_Queued:
+      case SKIV_ExportState_Running:
+        exports_pending = true;
+        break;
+
+      case SKIV_ExportState_Succeeded:
+        ImGui::InsertNotification (
+        {
+          ImGuiToastType::Info,
+          3000,
+          szTitle, "Saved '%ws'",
+          job.path.c_str ()
+        });
+        break;
+
+      case SKIV_ExportState_Failed:
+        ImGui::InsertNotification (
+        {
+          ImGuiToastType::Error,
+          15000,
+          szTitle, "Failed to Save '%ws', HRESULT=%x",
+          job.path.c_str (), job.hr
+        });
+        break;
+
+      case SKIV_ExportState_Cancelled:
+        ImGui::InsertNotification (
+        {
+          ImGuiToastType::Info,
+          3000,
+          szTitle, "Cancelled '%ws'",
+          job.path.c_str ()
+        });
+        break;
+    }
+  }
+
+  if (exports_pending)
+  {
+    auto parent_pos =
+      ImGui::GetCursorPos ();
+
+    const float fWidth = 300.0f * SKIF_ImGui_GlobalDPIScale;
+
+    // Display "floating" in the top right corner regardless of scroll position
+    ImGui::SetCursorPos   (ImVec2 (ImGui::GetScrollX ( ) + ImGui::GetWindowWidth ( ) - fWidth - ImGui::GetStyle ( ).WindowPadding.x,
+                                   ImGui::GetScrollY ( )));
+
+    ImGui::PushStyleColor (ImGuiCol_ChildBg, ImGui::GetStyleColorVec4 (ImGuiCol_WindowBg));
+    ImGui::BeginChild     ("###Exports", ImVec2 (fWidth, 0), ImGuiChildFlags_AlwaysUseWindowPadding | ImGuiChildFlags_AutoResizeY | ((_registry.bUIBorders) ? ImGuiChildFlags_Border : ImGuiChildFlags_None), ImGuiWindowFlags_NoScrollbar);
+    ImGui::PopStyleColor  ( );
+
+    for (const auto& job : exports)
+    {
+      if (job.state >= SKIV_ExportState_Succeeded)
+        continue;
+
+      ImGui::PushID (static_cast <int> (job.id));
+
+      ImGui::TextUnformatted (SK_WideCharToUTF8 (std::filesystem::path (job.path).filename ().wstring ()).c_str ());
+
+      const float fCancelWidth =
+        ImGui::CalcTextSize ("Cancel").x + ImGui::GetStyle ( ).FramePadding.x * 2.0f;
+
+      ImGui::ProgressBar (job.progress, ImVec2 (- (fCancelWidth + ImGui::GetStyle ( ).ItemSpacing.x), 0),
+                         (job.state == SKIV_ExportState_Queued) ? "Queued" : nullptr);
+      ImGui::SameLine    ( );
+
+      if (ImGui::Button ("Cancel"))
+        SKIV_Export_Cancel (job.id);
+
+      ImGui::PopID ( );
+    }
+
+    ImGui::EndChild     ( ); // ###Exports
+    ImGui::SetCursorPos (parent_pos);
+  }
+
+#pragma endregion
+
 #pragma region ContextMenu
 
   auto _IsRightClicked = [&](void) -> bool
@@ -3816,6 +4367,18 @@ SKIF_UI_Tab_DrawViewer (void)
           _registry.regKVPNGHDRBitDepth.putData(_registry.png.hdr_bitdepth);
         ImGui::EndTabItem      ();
       }
+      if (ImGui::BeginTabItem ("DDS", nullptr, ImGuiTabItemFlags_NoTooltip))
+      {
+        selection = 4;
+
+        // SDR images are encoded as BC7, HDR images as BC6H
+        if (ImGui::Combo     ("Compression Quality", &_registry.dds.quality, " Fast\0 Normal\0 Best\0\0"))
+          _registry.regKVDDSQuality.putData          (_registry.dds.quality);
+
+        if (ImGui::Checkbox  ("Generate Mipmaps",    &_registry.dds.mipmaps))
+          _registry.regKVDDSMipmaps.putData          (_registry.dds.mipmaps);
+        ImGui::EndTabItem      ();
+      }
       //if (ImGui::BeginTabItem ("Ultra HDR", nullptr, ImGuiTabItemFlags_NoTooltip))
       //{
       //}
@@ -3864,6 +4427,9 @@ SKIF_UI_Tab_DrawViewer (void)
       if (cover.is_hdr &&
           SKIF_ImGui_MenuItemEx2 ("Export to SDR", ICON_FA_FILE_EXPORT, ImGui::GetStyleColorVec4(ImGuiCol_Text),      "Ctrl+X"))
         ExportSDRDialog = PopupState_Open;
+      if (cover.is_hdr &&
+          SKIF_ImGui_MenuItemEx2 ("Export Visualization", ICON_FA_FILE_EXPORT, ImGui::GetStyleColorVec4(ImGuiCol_Text)))
+        ExportVizDialog = PopupState_Open;
       if (SKIF_ImGui_MenuItemEx2 ("Encoder Setup", ICON_FA_GEARS,       ImGui::GetStyleColorVec4(ImGuiCol_Text),      "Ctrl+B"))
         ConfigEncoders = PopupState_Open;
       if (//cover.is_hdr &&
@@ -4033,15 +4599,11 @@ SKIF_UI_Tab_DrawViewer (void)
     if (SKIF_ImGui_hWnd != NULL)
       ::SetWindowText (SKIF_ImGui_hWnd, L"Loading... - " SKIV_WINDOW_TITLE_SHORT_W);
 
-    struct thread_s {
-      image_s image = { };
-    };
-  
-    thread_s* data = new thread_s;
+    image_s* data = new image_s;
 
-    data->image.file_info.path      = new_path;
-    data->image.file_info.path_utf8 = SK_WideCharToUTF8 (new_path);
-    data->image.file_info.size      = SK_File_GetSize   (new_path.c_str ());
+    data->file_info.path      = new_path;
+    data->file_info.path_utf8 = SK_WideCharToUTF8 (new_path);
+    data->file_info.size      = SK_File_GetSize   (new_path.c_str ());
     new_path.clear();
 
     // We're going to stream the cover in asynchronously on this thread
@@ -4052,7 +4614,7 @@ SKIF_UI_Tab_DrawViewer (void)
 
       SKIF_Util_SetThreadDescription (GetCurrentThread (), L"SKIV_ImageWorker");
 
-      thread_s* _data = static_cast<thread_s*>(var);
+      image_s* _data = static_cast<image_s*>(var);
 
       CoInitializeEx (nullptr, 0x0);
 
@@ -4063,9 +4625,9 @@ SKIF_UI_Tab_DrawViewer (void)
       int queuePos = getTextureLoadQueuePos();
       //PLOG_VERBOSE << "queuePos = " << queuePos;
     
-      bool success = LoadLibraryTexture ( _data->image );
+      bool success = LoadLibraryTexture (*_data);
 
-      PLOG_VERBOSE << "_pRawTexSRV = "        << _data->image.pRawTexSRV;
+      PLOG_VERBOSE << "_pRawTexSRV = "        << _data->pRawTexSRV;
 
       int currentQueueLength = textureLoadQueueLength.load();
 
@@ -4076,33 +4638,17 @@ SKIF_UI_Tab_DrawViewer (void)
         else
           PLOG_WARNING << "Queue position is live, but texture failed to load properly...";
 
-        cover.file_info         = _data->image.file_info;
-        cover.bpc               = _data->image.bpc;
-        cover.channels          = _data->image.channels;
-        cover.width             = _data->image.width;
-        cover.height            = _data->image.height;
-        cover.zoom              = _data->image.zoom;
-        cover.uv0               = _data->image.uv0;
-        cover.uv1               = _data->image.uv1;
-        cover.pRawTexSRV        = _data->image.pRawTexSRV;
-        cover.pGamutCoverageSRV = _data->image.pGamutCoverageSRV;
-        cover.pGamutCoverageUAV = _data->image.pGamutCoverageUAV;
-        cover.light_info        = _data->image.light_info;
-        cover.colorimetry       = _data->image.colorimetry;
-        cover.is_hdr            = _data->image.is_hdr;
-        cover.is_dds            = _data->image.is_dds;
-
         // Parent folder (used for the directory watch)
-        std::filesystem::path path       = SKIF_Util_NormalizeFullPath (cover.file_info.path);
-        cover.file_info.folder_path      = path.parent_path().wstring();
-        cover.file_info.folder_path_utf8 = SK_WideCharToUTF8 (cover.file_info.folder_path);
-        cover.file_info.filename         = path.filename()   .wstring();
-        cover.file_info.filename_utf8    = SK_WideCharToUTF8 (cover.file_info.filename);
-        cover.file_info.size             = SK_File_GetSize   (cover.file_info.path.c_str ());
+        std::filesystem::path path        = SKIF_Util_NormalizeFullPath (_data->file_info.path);
+        _data->file_info.folder_path      = path.parent_path().wstring();
+        _data->file_info.folder_path_utf8 = SK_WideCharToUTF8 (_data->file_info.folder_path);
+        _data->file_info.filename         = path.filename()   .wstring();
+        _data->file_info.filename_utf8    = SK_WideCharToUTF8 (_data->file_info.filename);
+        _data->file_info.size             = SK_File_GetSize   (_data->file_info.path.c_str ());
 
-        extern ImVec2 SKIV_ResizeApp;
-        SKIV_ResizeApp.x = cover.width;
-        SKIV_ResizeApp.y = cover.height;
+        // Published in one go; an earlier image the UI thread never got to is superseded
+        if (image_s* superseded = SKIV_LoadedImage.exchange (_data))
+          SKIV_Viewer_RetireImage (superseded);
 
         // Indicate that we have stopped loading the cover
         imageLoading.store (false);
@@ -4111,37 +4657,14 @@ SKIF_UI_Tab_DrawViewer (void)
         PostMessage (SKIF_Notify_hWnd, WM_SKIF_IMAGE, 0x0, static_cast<LPARAM> (success));
       }
 
-      else if (_data->image.pRawTexSRV.p        != nullptr ||
-               _data->image.pGamutCoverageSRV.p != nullptr ||
-               _data->image.pGamutCoverageUAV.p != nullptr)
+      else
       {
-        if (_data->image.pRawTexSRV.p != nullptr)
-        {
-          PLOG_DEBUG << "Texture is late! (" << queuePos << " vs " << currentQueueLength << ")";
-          PLOG_VERBOSE << "SKIF_ResourcesToFree: Pushing " << _data->image.pRawTexSRV.p << " to be released";;
-          SKIF_ResourcesToFree.push(_data->image.pRawTexSRV.p);
-          _data->image.pRawTexSRV.p = nullptr;
-        }
-
-        if (_data->image.pGamutCoverageSRV.p != nullptr)
-        {
+        if (_data->pRawTexSRV.p != nullptr)
           PLOG_DEBUG << "Texture is late! (" << queuePos << " vs " << currentQueueLength << ")";
-          PLOG_VERBOSE << "SKIF_ResourcesToFree: Pushing " << _data->image.pGamutCoverageSRV.p << " to be released";;
-          SKIF_ResourcesToFree.push(_data->image.pGamutCoverageSRV.p);
-          _data->image.pGamutCoverageSRV.p = nullptr;
-        }
 
-        if (_data->image.pGamutCoverageUAV.p != nullptr)
-        {
-          PLOG_DEBUG << "Texture is late! (" << queuePos << " vs " << currentQueueLength << ")";
-          PLOG_VERBOSE << "SKIF_ResourcesToFree: Pushing " << _data->image.pGamutCoverageUAV.p << " to be released";;
-          SKIF_ResourcesToFree.push(_data->image.pGamutCoverageUAV.p);
-          _data->image.pGamutCoverageUAV.p = nullptr;
-        }
+        SKIV_Viewer_RetireImage (_data);
       }
 
-      delete _data;
-
       PLOG_INFO  << "Finished streaming image asynchronously...";
       PLOG_DEBUG << "SKIV_ImageWorker thread stopped!";
       return 0;
@@ -4216,48 +4739,18 @@ SKIF_UI_Tab_DrawViewer (void)
 
     else if (SUCCEEDED(hr))
     {
-      hr = E_UNEXPECTED;
-
-      auto pDevice =
-        SKIF_D3D11_GetDevice ();
+      // Encoded in the background, failures are reported by the export overlay
+      if (cover.pixels != nullptr || cover.tiles != nullptr)
+        SKIV_Export_Submit (SKIV_Viewer_GetExportRequest (cover, pwszFilePath, SKIV_Export_AsIs));
 
-      if (pDevice && cover.pRawTexSRV.p != nullptr)
-      {
-        CComPtr <ID3D11DeviceContext>  pDevCtx;
-        pDevice->GetImmediateContext (&pDevCtx);
-
-        if (pDevCtx)
-        {
-          CComPtr <ID3D11Resource>        pCoverRes;
-          cover.pRawTexSRV->GetResource (&pCoverRes.p);
-
-          DirectX::ScratchImage                                                captured_img;
-          if (SUCCEEDED (DirectX::CaptureTexture (pDevice, pDevCtx, pCoverRes, captured_img)))
-          {
-            if (cover.is_hdr)
-            {
-              hr =
-                SKIV_Image_SaveToDisk_HDR (*captured_img.GetImages (), pwszFilePath);
-            }
-
-            else
-            {
-              hr =
-                SKIV_Image_SaveToDisk_SDR (*captured_img.GetImages (), pwszFilePath, false);
-            }
-          }
-        }
-      }
-
-      if (FAILED (hr))
+      else
       {
-        // Crap...
         ImGui::InsertNotification (
         {
           ImGuiToastType::Error,
           15000,
           "File Save", "Failed to Save '%ws', HRESULT=%x",
-          pwszFilePath, hr
+          pwszFilePath, E_UNEXPECTED
         });
       }
     }
@@ -4294,55 +4787,72 @@ SKIF_UI_Tab_DrawViewer (void)
 
     else if (SUCCEEDED(hr))
     {
-      hr = E_UNEXPECTED;
-
-      auto pDevice =
-        SKIF_D3D11_GetDevice ();
+      // Encoded in the background, failures are reported by the export overlay
+      if (cover.pixels != nullptr || cover.tiles != nullptr)
+        SKIV_Export_Submit (SKIV_Viewer_GetExportRequest (cover, pwszFilePath, SKIV_Export_SDR));
 
-      if (pDevice && cover.pRawTexSRV.p != nullptr)
+      else
       {
-        CComPtr <ID3D11DeviceContext>  pDevCtx;
-        pDevice->GetImmediateContext (&pDevCtx);
-
-        if (pDevCtx)
+        ImGui::InsertNotification (
         {
-          CComPtr <ID3D11Resource>        pCoverRes;
-          cover.pRawTexSRV->GetResource (&pCoverRes.p);
+          ImGuiToastType::Error,
+          15000,
+          "SDR Export", "Failed to Export SDR copy to '%ws', HRESULT=%x",
+          pwszFilePath, E_UNEXPECTED
+        });
+      }
+    }
 
-          DirectX::ScratchImage                                                captured_img;
-          if (SUCCEEDED (DirectX::CaptureTexture (pDevice, pDevCtx, pCoverRes, captured_img)))
-          {
+    ExportSDRDialog = PopupState_Closed;
+  }
 
-            if (cover.is_hdr)
-            {
-              hr =
-                SKIV_Image_SaveToDisk_SDR (*captured_img.GetImages (), pwszFilePath, false);
-            }
+  // Renders the current visualization and tonemap on the CPU, at full resolution
+  if (ExportVizDialog == PopupState_Open)
+  {
+    ExportVizDialog = PopupState_Opened;
 
-            else
-            {
-              // WTF? It's already SDR... oh well, save it anyway
-              hr =
-                SKIV_Image_SaveToDisk_SDR (*captured_img.GetImages (), pwszFilePath, false);
-            }
-          }
-        }
-      }
+    const skiv_hdr_visualization_s viz =
+      SKIV_Viewer_GetVisualization ();
+
+    // What an SDR display shows is 8-bit sRGB, anything else stays scRGB
+    const filterspec_s filters = CreateFILTERSPEC ((viz.hdr_display ? Save_HDR : Save_SDR));
+
+    wchar_t               wszCoverName [MAX_PATH + 2] = { };
+    wcsncpy (             wszCoverName, cover.file_info.filename.c_str(), MAX_PATH);
+    PathRemoveExtensionW (wszCoverName);
+
+    const wchar_t *wszDefaultExtension =
+      viz.hdr_display ? defaultHDRFileExt.c_str ()
+                      : defaultSDRFileExt.c_str ();
+
+    LPWSTR pwszFilePath = NULL;
+    HRESULT hr          =
+      SK_FileSaveDialog (&pwszFilePath, wszCoverName, wszDefaultExtension, filters.filterSpec.data(), static_cast<UINT> (filters.filterSpec.size()), SKIF_ImGui_hWnd, FOS_STRICTFILETYPES|FOS_FILEMUSTEXIST|FOS_OVERWRITEPROMPT|FOS_DONTADDTORECENT, FOLDERID_Pictures, cover.file_info.folder_path.c_str());
+
+    if (hr == HRESULT_FROM_WIN32(ERROR_CANCELLED))
+    {
+      // If cancelled, do nothing
+    }
+
+    else if (SUCCEEDED(hr))
+    {
+      // Encoded in the background, failures are reported by the export overlay
+      if (cover.pixels != nullptr || cover.tiles != nullptr)
+        SKIV_Export_Submit (SKIV_Viewer_GetExportRequest (cover, pwszFilePath, SKIV_Export_Visualization));
 
-      if (FAILED (hr))
+      else
       {
-        // Crap...
         ImGui::InsertNotification (
         {
           ImGuiToastType::Error,
           15000,
-          "SDR Export", "Failed to Export SDR copy to '%ws', HRESULT=%x",
-          pwszFilePath, hr
+          "Visualization Export", "Failed to Export visualization to '%ws', HRESULT=%x",
+          pwszFilePath, E_UNEXPECTED
         });
       }
     }
 
-    ExportSDRDialog = PopupState_Closed;
+    ExportVizDialog = PopupState_Closed;
   }
 
 
@@ -4567,12 +5077,6 @@ SKIF_UI_Tab_DrawViewer (void)
         SKIF_ResourcesToFree.push(cover_old.pGamutCoverageSRV.p);
         cover_old.pGamutCoverageSRV.p = nullptr;
       }
-
-      if (cover_old.pGamutCoverageUAV.p != nullptr)
-      {
-        SKIF_ResourcesToFree.push(cover_old.pGamutCoverageUAV.p);
-        cover_old.pGamutCoverageUAV.p = nullptr;
-      }
     }
 
     // Trigger a refresh of the cover
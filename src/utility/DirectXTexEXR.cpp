@@ -12,6 +12,7 @@
 //#define NOMINMAX
 
 #include "utility/DirectXTexEXR.h"
+#include "utility/image.h" // SKIV_Image_PackFP32toFP16
 
 #include <DirectXPackedVector.h>
 
@@ -579,13 +580,8 @@ HRESULT DirectX::SaveToEXRFile(const Image& image, const wchar_t* szFile)
             {
                 for (int j = 0; j < height; ++j)
                 {
-                    auto srcPtr = reinterpret_cast<const XMFLOAT4*>(sPtr);
-                    auto destPtr = dPtr;
-                    for (int k = 0; k < width; ++k, ++srcPtr, ++destPtr)
-                    {
-                        const XMVECTOR v = XMLoadFloat4(srcPtr);
-                        PackedVector::XMStoreHalf4(destPtr, v);
-                    }
+                    SKIV_Image_PackFP32toFP16(reinterpret_cast<const float*>(sPtr),
+                                              reinterpret_cast<uint16_t*>(dPtr), static_cast<size_t>(width) * 4);
 
                     sPtr += image.rowPitch;
                     dPtr += width;
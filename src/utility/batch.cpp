@@ -0,0 +1,641 @@
+#include <utility/batch.h>
+#include <utility/image.h>
+#ifdef _M_X64
+#include <utility/DirectXTexEXR.h>
+#endif
+#include <utility/sk_utility.h>
+#include <utility/utility.h>
+#include <tabs/viewer.h>
+#include <plog/Log.h>
+#include <nlohmann/json.hpp>
+#include <shellapi.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../../version.h"
+
+// Implemented by the viewer, which owns the decoders
+extern bool SKIV_Viewer_LoadImageFromFile (const std::wstring& path, DirectX::ScratchImage& image, bool& is_hdr, skiv_export_size_s* export_size = nullptr);
+extern bool isExtensionSupported          (const std::wstring extension);
+
+struct skiv_batch_options_s {
+  std::vector <std::wstring> inputs;
+  std::wstring               format;            // Lowercase, without the leading dot
+  std::filesystem::path      out_dir;
+  std::filesystem::path      report;
+  size_t                     jobs       = 0;
+  size_t                     max_memory = 0;    // In bytes, 0 = unlimited
+  bool                       force_sdr  = false;
+  bool                       overwrite  = false;
+  uint32_t                   visualization = SKIV_HDR_VISUALIZTION_NONE;
+  float                      resize_percent    = 100.0f;
+  size_t                     resize_max_width  = 0;
+  size_t                     resize_max_height = 0;
+};
+
+struct skiv_batch_result_s {
+  std::wstring input;
+  std::wstring output;
+  const char*  status    = "pending"; // converted, skipped or failed
+  std::string  error;
+  size_t       width     = 0;
+  size_t       height    = 0;
+  bool         is_hdr    = false;
+  double       decode_ms = 0.0;
+  double       encode_ms = 0.0;
+  double       total_ms  = 0.0;
+};
+
+// Bounds the memory of the images being converted at once. Workers reserve
+//   what the file header says the image will take before decoding and settle
+//     the difference afterwards; files without a readable header reserve the
+//       largest size seen so far, but never less than an even share of the
+//         limit. A worker is always let through while nothing is reserved.
+struct skiv_batch_budget_s {
+  std::mutex              lock;
+  std::condition_variable released;
+  size_t                  in_use   = 0;
+  size_t                  limit    = 0;
+  size_t                  jobs     = 1;
+  std::atomic <size_t>    estimate = 0;
+
+  size_t Acquire (size_t expected = 0)
+  {
+    if (limit == 0)
+      return 0;
+
+    const size_t bytes = (expected != 0) ? expected :
+      std::max (estimate.load (), limit / std::max <size_t> (1, jobs));
+
+    std::unique_lock <std::mutex> _(lock);
+
+    released.wait (_, [&] { return in_use == 0 || in_use + bytes <= limit; });
+
+    in_use += bytes;
+
+    return bytes;
+  }
+
+  // Never blocks; waiting here while holding a reservation could deadlock
+  size_t Settle (size_t reserved, size_t actual)
+  {
+    if (limit == 0)
+      return 0;
+
+    size_t prev = estimate.load ();
+    while (actual > prev && ! estimate.compare_exchange_weak (prev, actual))
+      ;
+
+    {
+      std::scoped_lock <std::mutex> _(lock);
+      in_use = in_use - reserved + actual;
+    }
+
+    released.notify_all ();
+
+    return actual;
+  }
+
+  void Release (size_t bytes)
+  {
+    Settle (bytes, 0);
+  }
+};
+
+static bool
+SKIV_Batch_IsHDRFormat (const std::wstring& format)
+{
+  return format == L"png" || format == L"jxl" || format == L"avif" ||
+         format == L"exr" || format == L"jxr" || format == L"hdr" ||
+         format == L"dds";
+}
+
+static bool
+SKIV_Batch_IsSupportedFormat (const std::wstring& format)
+{
+  return SKIV_Batch_IsHDRFormat (format) ||
+         format == L"jpg"  || format == L"jpeg" || format == L"bmp" ||
+         format == L"tiff" || format == L"tif";
+}
+
+// Size of the decoded image according to the file header, or 0 if the header
+//   could not be read (AVIF, JPEG XL, WebP, PSD)
+static size_t
+SKIV_Batch_EstimateDecodedSize (const std::wstring& path)
+{
+  const std::wstring ext =
+    SKIF_Util_ToLowerW (std::filesystem::path (path).extension ().wstring ());
+
+  DirectX::TexMetadata meta = { };
+  HRESULT              hr   = E_NOTIMPL;
+
+  if      (ext == L".dds")
+    hr = DirectX::GetMetadataFromDDSFile (path.c_str (), DirectX::DDS_FLAGS_NONE, meta);
+  else if (ext == L".hdr")
+    hr = DirectX::GetMetadataFromHDRFile (path.c_str (), meta);
+#ifdef _M_X64
+  else if (ext == L".exr")
+    hr = DirectX::GetMetadataFromEXRFile (path.c_str (), meta);
+#endif
+  else if (ext == L".jpg" || ext == L".jpeg" || ext == L".png" || ext == L".bmp" ||
+           ext == L".tif" || ext == L".tiff" || ext == L".jxr" || ext == L".hdp" ||
+           ext == L".gif")
+    hr = DirectX::GetMetadataFromWICFile (path.c_str (), DirectX::WIC_FLAGS_NONE, meta);
+
+  if (FAILED (hr) || meta.width == 0 || meta.height == 0)
+    return 0;
+
+  // The decoders expand everything to at least four 8-bit channels
+  const size_t bpp =
+    std::max <size_t> (32, DirectX::BitsPerPixel (meta.format));
+
+  return meta.width * meta.height * meta.arraySize * bpp / 8;
+}
+
+static void
+SKIV_Batch_ExpandInput (const std::wstring& input, std::vector <std::wstring>& files)
+{
+  if (input.empty ())
+    return;
+
+  // List file, one input (or pattern) per line
+  if (input [0] == L'@')
+  {
+    std::ifstream list (std::filesystem::path (input.substr (1)));
+
+    if (! list.is_open ())
+    {
+      PLOG_ERROR << "Failed to open the list file " << input.substr (1);
+      return;
+    }
+
+    std::string line;
+
+    while (std::getline (list, line))
+    {
+      std::erase (line, '\r');
+      std::erase (line, '"');
+
+      if (! line.empty () && line [0] != '#')
+        SKIV_Batch_ExpandInput (SK_UTF8ToWideChar (line), files);
+    }
+
+    return;
+  }
+
+  std::filesystem::path path (input);
+  std::error_code       ec;
+
+  // Folders only pick up what the decoders can read; explicit files and
+  //   patterns are taken as given
+  const bool folder =
+    std::filesystem::is_directory (path, ec);
+
+  if (folder)
+    path /= L"*";
+
+  if (path.wstring ().find_first_of (L"*?") == std::wstring::npos)
+  {
+    files.push_back (path.wstring ());
+    return;
+  }
+
+  WIN32_FIND_DATAW fd     = { };
+  HANDLE           hFind  =
+    FindFirstFileExW (path.c_str (), FindExInfoBasic, &fd, FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+
+  if (hFind == INVALID_HANDLE_VALUE)
+  {
+    PLOG_WARNING << "No files match " << path.wstring ();
+    return;
+  }
+
+  do
+  {
+    if ((fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+      continue;
+
+    if (folder && ! isExtensionSupported (std::filesystem::path (fd.cFileName).extension ().wstring ()))
+      continue;
+
+    files.push_back ((path.parent_path () / fd.cFileName).wstring ());
+  } while (FindNextFileW (hFind, &fd));
+
+  FindClose (hFind);
+}
+
+static bool
+SKIV_Batch_ParseArgs (const std::wstring& args, skiv_batch_options_s& options)
+{
+  int     argc = 0;
+  LPWSTR* argv =
+    CommandLineToArgvW ((L"SKIV " + args).c_str (), &argc);
+
+  if (argv == nullptr)
+    return false;
+
+  bool valid = true;
+
+  for (int i = 1; i < argc && valid; ++i)
+  {
+    const wchar_t* arg = argv [i];
+
+    auto _Value = [&](void) -> const wchar_t*
+    {
+      if (i + 1 < argc)
+        return argv [++i];
+
+      PLOG_ERROR << arg << " requires a value!";
+      valid = false;
+      return nullptr;
+    };
+
+    if (_wcsicmp (arg, L"/To") == 0)
+    {
+      if (const wchar_t* value = _Value ())
+      {
+        options.format = SKIF_Util_ToLowerW (value);
+
+        if (options.format.starts_with (L"."))
+          options.format.erase (0, 1);
+      }
+    }
+
+    else if (_wcsicmp (arg, L"/Out") == 0)
+    {
+      if (const wchar_t* value = _Value ())
+        options.out_dir = value;
+    }
+
+    else if (_wcsicmp (arg, L"/Report") == 0)
+    {
+      if (const wchar_t* value = _Value ())
+        options.report = value;
+    }
+
+    else if (_wcsicmp (arg, L"/Jobs") == 0)
+    {
+      if (const wchar_t* value = _Value ())
+        options.jobs = static_cast <size_t> (std::max (1, _wtoi (value)));
+    }
+
+    else if (_wcsicmp (arg, L"/MaxMemory") == 0)
+    {
+      if (const wchar_t* value = _Value ())
+        options.max_memory = static_cast <size_t> (std::max (0, _wtoi (value))) * 1024 * 1024;
+    }
+
+    else if (_wcsicmp (arg, L"/Visualize") == 0)
+    {
+      if (const wchar_t* value = _Value ())
+      {
+        if      (_wcsicmp (value, L"heatmap") == 0) options.visualization = SKIV_HDR_VISUALIZTION_HEATMAP;
+        else if (_wcsicmp (value, L"gamut")   == 0) options.visualization = SKIV_HDR_VISUALIZTION_GAMUT;
+        else if (_wcsicmp (value, L"sdr")     == 0) options.visualization = SKIV_HDR_VISUALIZTION_SDR;
+        else
+        {
+          PLOG_ERROR << "Unknown visualization " << value;
+          valid = false;
+        }
+      }
+    }
+
+    // Either a percentage (50%) or a box to fit within (1920x1080)
+    else if (_wcsicmp (arg, L"/Resize") == 0)
+    {
+      if (const wchar_t* value = _Value ())
+      {
+        float    percent = 0.0f;
+        unsigned width   = 0,
+                 height  = 0;
+        wchar_t  suffix  = L'\0';
+
+        if (swscanf_s (value, L"%f%c", &percent, &suffix, 1) == 2 && suffix == L'%' && percent > 0.0f && percent <= 100.0f)
+          options.resize_percent = percent;
+
+        else if (swscanf_s (value, L"%ux%u", &width, &height) == 2 && width > 0 && height > 0)
+        {
+          options.resize_max_width  = width;
+          options.resize_max_height = height;
+        }
+
+        else
+        {
+          PLOG_ERROR << "Invalid size " << value << ", expected a percentage (1-100%) or WIDTHxHEIGHT";
+          valid = false;
+        }
+      }
+    }
+
+    else if (_wcsicmp (arg, L"/SDR") == 0)
+      options.force_sdr = true;
+
+    else if (_wcsicmp (arg, L"/Overwrite") == 0)
+      options.overwrite = true;
+
+    else if (arg [0] == L'/')
+    {
+      PLOG_ERROR << "Unknown option " << arg;
+      valid = false;
+    }
+
+    else
+      options.inputs.push_back (arg);
+  }
+
+  LocalFree (argv);
+
+  if (valid && ! SKIV_Batch_IsSupportedFormat (options.format))
+  {
+    PLOG_ERROR << "Missing or unsupported target format (/To): " << options.format;
+    valid = false;
+  }
+
+  if (valid && options.inputs.empty ())
+  {
+    PLOG_ERROR << "No input files were given!";
+    valid = false;
+  }
+
+  return valid;
+}
+
+static void
+SKIV_Batch_ConvertFile (const skiv_batch_options_s& options, skiv_batch_result_s& result, skiv_batch_budget_s& budget)
+{
+  using clock = std::chrono::steady_clock;
+
+  const auto start = clock::now ();
+
+  std::error_code ec;
+
+  if (! options.overwrite && std::filesystem::exists (result.output, ec))
+  {
+    result.status = "skipped";
+    result.error  = "Output file already exists";
+    return;
+  }
+
+  DirectX::ScratchImage image;
+
+  const size_t viz_factor =
+    (options.visualization != SKIV_HDR_VISUALIZTION_NONE ? 4 : 3);
+
+  size_t reserved =
+    budget.Acquire (SKIV_Batch_EstimateDecodedSize (result.input) * viz_factor);
+
+  // Decoders that can scale while decoding (JPEG) rewrite this to what is left
+  //   to do to the image they return
+  skiv_export_size_s export_size = {
+    .percent    = options.resize_percent,
+    .max_width  = options.resize_max_width,
+    .max_height = options.resize_max_height
+  };
+
+  const bool decoded =
+    SKIV_Viewer_LoadImageFromFile (result.input, image, result.is_hdr, &export_size) && image.GetImageCount () > 0;
+
+  const auto decoded_at = clock::now ();
+
+  result.decode_ms =
+    std::chrono::duration <double, std::milli> (decoded_at - start).count ();
+
+  if (! decoded)
+  {
+    budget.Release (reserved);
+
+    result.status = "failed";
+    result.error  = "Failed to decode the image";
+    return;
+  }
+
+  const DirectX::Image* pixels =
+    image.GetImage (0, 0, 0);
+
+  result.width  = pixels->width;
+  result.height = pixels->height;
+
+  // The decoded image, plus the tonemapped / converted copy the encoders make,
+  //   the resized copy and the visualization, if any
+  reserved =
+    budget.Settle (reserved, image.GetPixelsSize () * viz_factor);
+
+  HRESULT hr = S_OK;
+
+  DirectX::ScratchImage resized;
+
+  if (export_size.percent < 100.0f || export_size.max_width != 0 || export_size.max_height != 0)
+  {
+    hr = SKIV_Image_ResizeForExport (*pixels, export_size.percent, export_size.max_width, export_size.max_height, resized);
+
+    if (hr == S_OK)
+      pixels = resized.GetImage (0, 0, 0);
+  }
+
+  // Rendered as on an HDR display at 100 % brightness, the output is scRGB
+  DirectX::ScratchImage visualized;
+
+  if (SUCCEEDED (hr) && options.visualization != SKIV_HDR_VISUALIZTION_NONE)
+  {
+    skiv_hdr_visualization_s viz;
+    viz.type = options.visualization;
+
+    hr = SKIV_Image_ApplyVisualization (*pixels, viz, visualized);
+
+    if (SUCCEEDED (hr))
+      pixels = visualized.GetImage (0, 0, 0);
+  }
+
+  const bool export_hdr =
+    (result.is_hdr || options.visualization != SKIV_HDR_VISUALIZTION_NONE) &&
+      ! options.force_sdr && SKIV_Batch_IsHDRFormat (options.format);
+
+  if (SUCCEEDED (hr))
+  {
+    hr = export_hdr ?
+      SKIV_Image_SaveToDisk_HDR (*pixels, result.output.c_str ()) :
+      SKIV_Image_SaveToDisk_SDR (*pixels, result.output.c_str (), false);
+  }
+
+  budget.Release (reserved);
+
+  const auto end = clock::now ();
+
+  result.encode_ms = std::chrono::duration <double, std::milli> (end - decoded_at).count ();
+  result.total_ms  = std::chrono::duration <double, std::milli> (end - start     ).count ();
+
+  if (SUCCEEDED (hr))
+    result.status = "converted";
+
+  else
+  {
+    result.status = "failed";
+    result.error  = SK_FormatString ("Failed to encode the image, HRESULT=%x", hr);
+  }
+}
+
+int
+SKIV_Batch_Run (const std::wstring& args, const std::wstring& default_report_path)
+{
+  using clock = std::chrono::steady_clock;
+
+  skiv_batch_options_s options;
+
+  if (! SKIV_Batch_ParseArgs (args, options))
+    return 2;
+
+  if (options.report.empty ())
+    options.report = default_report_path;
+
+  if (options.jobs == 0)
+    options.jobs = std::max (1U, std::thread::hardware_concurrency () / 2);
+
+  std::vector <std::wstring> files;
+
+  for (const auto& input : options.inputs)
+    SKIV_Batch_ExpandInput (input, files);
+
+  std::sort (files.begin (), files.end ());
+  files.erase (std::unique (files.begin (), files.end ()), files.end ());
+
+  std::error_code ec;
+
+  if (! options.out_dir.empty ())
+    std::filesystem::create_directories (options.out_dir, ec);
+
+  // Outputs are resolved up front, so that two inputs that differ only by their
+  //   extension (shot.png, shot.jxr) are not written to the same file at once.
+  std::vector <skiv_batch_result_s>             results (files.size ());
+  std::map    <std::wstring, const std::wstring*> outputs;
+
+  for (size_t i = 0; i < files.size (); ++i)
+  {
+    const std::filesystem::path input (files [i]);
+
+    std::filesystem::path output =
+      (options.out_dir.empty () ? input.parent_path () : options.out_dir) / input.stem ();
+    output += L"." + options.format;
+
+    results [i].input  = input .wstring ();
+    results [i].output = output.wstring ();
+
+    const std::wstring key =
+      SKIF_Util_ToLowerW (output.lexically_normal ().wstring ());
+
+    if (key == SKIF_Util_ToLowerW (input.lexically_normal ().wstring ()))
+    {
+      results [i].status = "failed";
+      results [i].error  = "Output would replace the input";
+    }
+
+    else if (auto [it, inserted] = outputs.emplace (key, &results [i].input); ! inserted)
+    {
+      results [i].status = "failed";
+      results [i].error  = "Output collides with " + SK_WideCharToUTF8 (*it->second);
+    }
+  }
+
+  PLOG_INFO << "Converting " << files.size () << " files to ." << options.format
+            << " using " << options.jobs << " workers...";
+
+  skiv_batch_budget_s budget;
+  budget.limit = options.max_memory;
+  budget.jobs  = options.jobs;
+
+  std::atomic <size_t> next = 0;
+
+  const auto start = clock::now ();
+
+  std::vector <std::thread> workers;
+
+  for (size_t i = 0; i < std::min (options.jobs, std::max <size_t> (1, files.size ())); ++i)
+  {
+    workers.emplace_back ([&](void)
+    {
+      // WIC and the WIC-based encoders need COM on every worker
+      CoInitializeEx (nullptr, 0x0);
+
+      for (size_t idx = next++; idx < results.size (); idx = next++)
+      {
+        auto& result = results [idx];
+
+        if (strcmp (result.status, "pending") != 0)
+          continue;
+
+        SKIV_Batch_ConvertFile (options, result, budget);
+
+        PLOG_INFO << "[" << result.status << "] " << result.input << " -> " << result.output
+                  << " (" << result.total_ms << " ms) " << result.error.c_str ();
+      }
+
+      CoUninitialize ();
+    });
+  }
+
+  for (auto& worker : workers)
+    worker.join ();
+
+  const double total_ms =
+    std::chrono::duration <double, std::milli> (clock::now () - start).count ();
+
+  size_t converted = 0,
+         skipped   = 0,
+         failed    = 0;
+
+  nlohmann::ordered_json files_json = nlohmann::ordered_json::array ();
+
+  for (const auto& result : results)
+  {
+    if      (strcmp (result.status, "converted") == 0) converted++;
+    else if (strcmp (result.status, "skipped")   == 0) skipped++;
+    else                                               failed++;
+
+    files_json.push_back ({
+      { "input",     SK_WideCharToUTF8 (result.input)  },
+      { "output",    SK_WideCharToUTF8 (result.output) },
+      { "status",    result.status                     },
+      { "error",     result.error                      },
+      { "width",     result.width                      },
+      { "height",    result.height                     },
+      { "hdr",       result.is_hdr                     },
+      { "decode_ms", result.decode_ms                  },
+      { "encode_ms", result.encode_ms                  },
+      { "total_ms",  result.total_ms                   }
+    });
+  }
+
+  nlohmann::ordered_json report = {
+    { "version",   SKIV_VERSION_STR_A                 },
+    { "format",    SK_WideCharToUTF8 (options.format) },
+    { "jobs",      options.jobs                       },
+    { "converted", converted                          },
+    { "skipped",   skipped                            },
+    { "failed",    failed                             },
+    { "total_ms",  total_ms                           },
+    { "files",     files_json                         }
+  };
+
+  std::ofstream file (options.report, std::ios::out | std::ios::trunc);
+
+  if (file.is_open ())
+  {
+    file << report.dump (2) << std::endl;
+
+    PLOG_INFO << "Conversion report written to " << options.report.wstring ();
+  }
+
+  else
+    PLOG_ERROR << "Failed to open " << options.report.wstring () << " for writing!";
+
+  PLOG_INFO << "Converted " << converted << ", skipped " << skipped << ", failed " << failed
+            << " of " << files.size () << " files in " << total_ms << " ms";
+
+  return (failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,1051 @@
+#include <utility/benchmark.h>
+#include <utility/image.h>
+#include <tabs/viewer.h>
+#include <utility/sk_utility.h>
+#include <utility/utility.h>
+#include <utility/sha256.h>
+#include <utility/plog_async.h>
+#include <utility/plog_formatter.h>
+#include <utility/fsutil.h>
+#include <plog/Log.h>
+#include <plog/Appenders/RollingFileAppender.h>
+#include <nlohmann/json.hpp>
+#include <picosha2.h>
+#include <stb_image.h>
+#include <Psapi.h>
+#include <algorithm>
+#include <chrono>
+#include <cfloat>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <numeric>
+#include <thread>
+#include "../../version.h"
+
+constexpr int SKIV_BENCH_WARMUP     =  2;
+constexpr int SKIV_BENCH_ITERATIONS = 10;
+
+enum skiv_bench_kind_e {
+  SKIV_Bench_SDR = 0x1, // RGBA8
+  SKIV_Bench_HDR = 0x2, // scRGB FP16, Rec. 709 primaries, 0.01 - 10,000 nits
+  SKIV_Bench_WCG = 0x4, // scRGB FP16, Rec. 2020 primaries (negative components)
+};
+
+struct skiv_bench_input_s {
+  const char*           kind_name = "";
+  skiv_bench_kind_e     kind      = SKIV_Bench_SDR;
+  size_t                width     = 0;
+  size_t                height    = 0;
+  DirectX::ScratchImage image;
+
+  // Pre-encoded copies of the image for the decode stages
+  DirectX::Blob         png;
+  DirectX::Blob         jpeg;
+  DirectX::Blob         radiance;
+  DirectX::ScratchImage bc;       // BC7 (SDR) or BC6H (HDR / WCG)
+};
+
+struct skiv_bench_stage_s {
+  const char*                                 name;
+  int                                         kinds; // Mask of skiv_bench_kind_e
+  std::function <bool (skiv_bench_input_s&)>  run;
+};
+
+// xorshift32, so the corpus is identical across runs and builds
+struct skiv_bench_rng_s {
+  uint32_t state;
+
+  float next (void)
+  {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state <<  5;
+
+    return
+      static_cast <float> (state >> 8) * (1.0f / 16777216.0f);
+  }
+};
+
+static size_t
+SKIV_Bench_GetPeakWorkingSet (void)
+{
+  PROCESS_MEMORY_COUNTERS pmc = { };
+
+  if (GetProcessMemoryInfo (GetCurrentProcess (), &pmc, sizeof (pmc)))
+    return pmc.PeakWorkingSetSize;
+
+  return 0;
+}
+
+// The encoders are far slower than anything benchmarked here, so the
+//   block-compressed copy is made once per input rather than timed.
+static bool
+SKIV_Bench_CompressBC (skiv_bench_input_s& input)
+{
+  using namespace DirectX;
+
+  const DXGI_FORMAT format =
+    (input.kind == SKIV_Bench_SDR) ? DXGI_FORMAT_BC7_UNORM
+                                   : DXGI_FORMAT_BC6H_SF16; // WCG has negative components
+
+  return
+    SUCCEEDED (Compress (*input.image.GetImages (), format, TEX_COMPRESS_BC7_QUICK | TEX_COMPRESS_PARALLEL, TEX_THRESHOLD_DEFAULT, input.bc));
+}
+
+static bool
+SKIV_Bench_Generate (skiv_bench_input_s& input)
+{
+  using namespace DirectX;
+
+  skiv_bench_rng_s rng {
+    static_cast <uint32_t> (0x9E3779B9U ^ (input.width * 73856093U) ^ (input.height * 19349663U) ^ input.kind)
+  };
+
+  const size_t width  = input.width;
+  const size_t height = input.height;
+
+  if (input.kind == SKIV_Bench_SDR)
+  {
+    if (FAILED (input.image.Initialize2D (DXGI_FORMAT_R8G8B8A8_UNORM, width, height, 1, 1)))
+      return false;
+
+    const Image* img = input.image.GetImages ();
+
+    for (size_t y = 0; y < height; ++y)
+    {
+      uint8_t* pixel =
+        img->pixels + y * img->rowPitch;
+
+      for (size_t x = 0; x < width; ++x)
+      {
+        const float u     = static_cast <float> (x) / static_cast <float> (width);
+        const float v     = static_cast <float> (y) / static_cast <float> (height);
+        const float noise = (rng.next () - 0.5f) * 0.05f;
+
+        const float rgb [3] = {
+          u + noise,
+          v + noise,
+          0.5f + 0.5f * sinf (6.2831853f * (u + v)) + noise
+        };
+
+        for (float c : rgb)
+          *pixel++ = static_cast <uint8_t> (std::clamp (c, 0.0f, 1.0f) * 255.0f + 0.5f);
+
+        *pixel++ = 255;
+      }
+    }
+
+    return
+      SUCCEEDED (SaveToWICMemory (*img, WIC_FLAGS_NONE, GetWICCodec (WIC_CODEC_PNG),  input.png))  &&
+      SUCCEEDED (SaveToWICMemory (*img, WIC_FLAGS_NONE, GetWICCodec (WIC_CODEC_JPEG), input.jpeg)) &&
+      SKIV_Bench_CompressBC (input);
+  }
+
+  if (FAILED (input.image.Initialize2D (DXGI_FORMAT_R16G16B16A16_FLOAT, width, height, 1, 1)))
+    return false;
+
+  const Image* img = input.image.GetImages ();
+
+  const XMMATRIX from2020to709 =
+    XMMatrixMultiply (c_from2020toXYZ, c_fromXYZto709);
+
+  std::vector <float> row (width * 4);
+
+  for (size_t y = 0; y < height; ++y)
+  {
+    const float v = static_cast <float> (y) / static_cast <float> (height);
+
+    // Hue varies down the image
+    XMVECTOR hue =
+      XMVectorSet ( 0.5f + 0.5f * cosf (6.2831853f *  v),
+                    0.5f + 0.5f * cosf (6.2831853f * (v - 1.0f / 3.0f)),
+                    0.5f + 0.5f * cosf (6.2831853f * (v - 2.0f / 3.0f)), 1.0f );
+
+    if (input.kind == SKIV_Bench_WCG)
+      hue = XMVector3Transform (hue, from2020to709);
+
+    const float hue_Y =
+      std::max (1.0e-4f, XMVectorGetY (XMVector3Transform (hue, c_from709toXYZ)));
+
+    for (size_t x = 0; x < width; ++x)
+    {
+      const float u = static_cast <float> (x) / static_cast <float> (width);
+
+      // Luminance sweeps exponentially from 0.01 to 10,000 nits across the image
+      const float nits  = 0.01f * powf (1000000.0f, u);
+      const float scale = (nits / 80.0f) / hue_Y * (1.0f + (rng.next () - 0.5f) * 0.02f);
+
+      row [x * 4 + 0] = XMVectorGetX (hue) * scale;
+      row [x * 4 + 1] = XMVectorGetY (hue) * scale;
+      row [x * 4 + 2] = XMVectorGetZ (hue) * scale;
+      row [x * 4 + 3] = 1.0f;
+    }
+
+    SKIV_Image_PackFP32toFP16 ( row.data (),
+      reinterpret_cast <uint16_t *> (img->pixels + y * img->rowPitch), row.size () );
+  }
+
+  return
+    SUCCEEDED (SaveToHDRMemory (*img, input.radiance)) &&
+    SKIV_Bench_CompressBC (input);
+}
+
+using skiv_bench_resize_pfn =
+  std::function <HRESULT (const DirectX::Image&, size_t, size_t, DirectX::ScratchImage&)>;
+
+// The resamplers compared by the Resize stages and SKIV_Bench_GetResamplePSNR
+static const std::pair <const char*, skiv_bench_resize_pfn> skiv_bench_resizers [] = {
+  { "Resample (Area)",     [](const DirectX::Image& img, size_t w, size_t h, DirectX::ScratchImage& out) { return SKIV_Image_Resample (img, w, h, SKIV_ResampleFilter_Area,     out); } },
+  { "Resample (Mitchell)", [](const DirectX::Image& img, size_t w, size_t h, DirectX::ScratchImage& out) { return SKIV_Image_Resample (img, w, h, SKIV_ResampleFilter_Mitchell, out); } },
+  { "Resample (Lanczos3)", [](const DirectX::Image& img, size_t w, size_t h, DirectX::ScratchImage& out) { return SKIV_Image_Resample (img, w, h, SKIV_ResampleFilter_Lanczos3, out); } },
+  { "Resize (Fant)",       [](const DirectX::Image& img, size_t w, size_t h, DirectX::ScratchImage& out) { return DirectX::Resize     (img, w, h, DirectX::TEX_FILTER_FANT,    out); } },
+  { "Resize (Cubic)",      [](const DirectX::Image& img, size_t w, size_t h, DirectX::ScratchImage& out) { return DirectX::Resize     (img, w, h, DirectX::TEX_FILTER_CUBIC,   out); } },
+};
+
+using skiv_bench_compress_pfn =
+  std::function <HRESULT (const DirectX::Image&, DXGI_FORMAT, DirectX::ScratchImage&)>;
+
+// The BC7 / BC6H encoders compared by the quality section of the report;
+//   DirectXTex runs with its default (exhaustive) BC7 mode search.
+static const std::pair <const char*, skiv_bench_compress_pfn> skiv_bench_compressors [] = {
+  { "CompressBC (Fast)",     [](const DirectX::Image& img, DXGI_FORMAT fmt, DirectX::ScratchImage& out) { return SKIV_Image_CompressBC (img, fmt, SKIV_BCQuality_Fast,   out); } },
+  { "CompressBC (Normal)",   [](const DirectX::Image& img, DXGI_FORMAT fmt, DirectX::ScratchImage& out) { return SKIV_Image_CompressBC (img, fmt, SKIV_BCQuality_Normal, out); } },
+  { "CompressBC (Best)",     [](const DirectX::Image& img, DXGI_FORMAT fmt, DirectX::ScratchImage& out) { return SKIV_Image_CompressBC (img, fmt, SKIV_BCQuality_Best,   out); } },
+  { "Compress (DirectXTex)", [](const DirectX::Image& img, DXGI_FORMAT fmt, DirectX::ScratchImage& out) { return DirectX::Compress      (img, fmt, DirectX::TEX_COMPRESS_PARALLEL, DirectX::TEX_THRESHOLD_DEFAULT, out); } },
+};
+
+// Compares result to the input: SDR as stored (sRGB), HDR after PQ encoding so
+//   that the brightest highlights do not drown out everything else.
+static double
+SKIV_Bench_GetPSNR (const skiv_bench_input_s& input, const DirectX::Image& result)
+{
+  using namespace DirectX;
+
+  const Image* original =
+    input.image.GetImages ();
+
+  ScratchImage a, b;
+
+  if (FAILED (SKIV_Image_Convert (*original, DXGI_FORMAT_R32G32B32A32_FLOAT, TEX_FILTER_DEFAULT, 0.0f, a)) ||
+      FAILED (SKIV_Image_Convert (result,    DXGI_FORMAT_R32G32B32A32_FLOAT, TEX_FILTER_DEFAULT, 0.0f, b)))
+    return 0.0;
+
+  static const XMVECTOR pq_scale =
+    XMVectorReplicate (80.0f / 10000.0f);
+
+  double sum = 0.0;
+
+  for (size_t y = 0; y < original->height; ++y)
+  {
+    const XMFLOAT4* pa = reinterpret_cast <const XMFLOAT4 *> (a.GetImages ()->pixels + y * a.GetImages ()->rowPitch);
+    const XMFLOAT4* pb = reinterpret_cast <const XMFLOAT4 *> (b.GetImages ()->pixels + y * b.GetImages ()->rowPitch);
+
+    for (size_t x = 0; x < original->width; ++x)
+    {
+      XMVECTOR va = XMLoadFloat4 (&pa [x]);
+      XMVECTOR vb = XMLoadFloat4 (&pb [x]);
+
+      if (input.kind != SKIV_Bench_SDR)
+      {
+        va = SKIV_Image_LinearToPQ (XMVectorMax (XMVectorMultiply (va, pq_scale), g_XMZero));
+        vb = SKIV_Image_LinearToPQ (XMVectorMax (XMVectorMultiply (vb, pq_scale), g_XMZero));
+      }
+
+      sum += XMVectorGetX (XMVector3LengthSq (XMVectorSubtract (va, vb)));
+    }
+  }
+
+  const double mse =
+    sum / static_cast <double> (original->width * original->height * 3);
+
+  return
+    (mse > 0.0) ? 10.0 * log10 (1.0 / mse) : 100.0;
+}
+
+// Downscales to half the size and back up with the same resampler
+static double
+SKIV_Bench_GetResamplePSNR (const skiv_bench_input_s& input, const skiv_bench_resize_pfn& resize)
+{
+  using namespace DirectX;
+
+  const Image* original =
+    input.image.GetImages ();
+
+  ScratchImage half, full;
+
+  if (FAILED (resize (*original,          original->width / 2, original->height / 2, half)) ||
+      FAILED (resize (*half.GetImages (), original->width,     original->height,     full)))
+    return 0.0;
+
+  return
+    SKIV_Bench_GetPSNR (input, *full.GetImages ());
+}
+
+// Throughput of the updater's SHA-256, checked against picosha2 (the portable
+//   implementation it replaced)
+static nlohmann::ordered_json
+SKIV_Bench_SHA256 (bool& failed)
+{
+  using clock = std::chrono::steady_clock;
+
+  std::vector <uint8_t> data (64 * 1024 * 1024);
+  skiv_bench_rng_s      rng  { 0x5EED };
+
+  for (auto& byte : data)
+    byte = static_cast <uint8_t> (rng.next () * 256.0f);
+
+  const double megabytes =
+    static_cast <double> (data.size ()) / (1024.0 * 1024.0);
+
+  std::string digest;
+  double      best_ms = DBL_MAX;
+
+  for (int i = 0; i < SKIV_BENCH_WARMUP + SKIV_BENCH_ITERATIONS; ++i)
+  {
+    skiv_sha256_s sha256;
+
+    const auto start = clock::now ();
+    sha256.update (data.data (), data.size ());
+    digest           = sha256.finish_hex ();
+    const auto end   = clock::now ();
+
+    // Fastest of the measured iterations, the buffer is hashed from memory
+    if (i >= SKIV_BENCH_WARMUP)
+      best_ms = std::min (best_ms, std::chrono::duration <double, std::milli> (end - start).count ());
+  }
+
+  // The reference is slow enough to be timed once
+  const auto  start     = clock::now ();
+  std::string reference = picosha2::hash256_hex_string (data.begin (), data.end ());
+  const auto  end       = clock::now ();
+
+  const double reference_ms =
+    std::chrono::duration <double, std::milli> (end - start).count ();
+
+  const bool matches =
+    (digest == reference);
+
+  if (! matches)
+  {
+    PLOG_ERROR << "SHA-256 (" << SKIV_SHA256_GetImplementation () << ") does not match picosha2!";
+    failed = true;
+  }
+
+  PLOG_INFO << "SHA-256 (" << SKIV_SHA256_GetImplementation () << "): "
+            << megabytes / (best_ms / 1000.0) << " MiB/s, picosha2: "
+            << megabytes / (reference_ms / 1000.0) << " MiB/s";
+
+  return {
+    { "implementation",     SKIV_SHA256_GetImplementation ()    },
+    { "mib_per_s",          megabytes / (best_ms      / 1000.0) },
+    { "picosha2_mib_per_s", megabytes / (reference_ms / 1000.0) },
+    { "matches_picosha2",   matches                             }
+  };
+}
+
+// Time spent on the calling thread per log record (mean / 99th percentile / worst)
+static nlohmann::ordered_json
+SKIV_Bench_GetLogStats (std::vector <double>& ns)
+{
+  std::sort (ns.begin (), ns.end ());
+
+  return {
+    { "mean_ns", std::accumulate (ns.begin (), ns.end (), 0.0) / static_cast <double> (ns.size ()) },
+    { "p99_ns",  ns [ns.size () * 99 / 100] },
+    { "max_ns",  ns.back ()                 }
+  };
+}
+
+// Cost of a log record: formatting it, and how long the logging thread (e.g.
+//   the image loader) is held up by plog's synchronous file appender compared
+//     to SKIV_AsyncLogAppender with several threads logging at once
+static nlohmann::ordered_json
+SKIV_Bench_Logging (bool& failed)
+{
+  using clock = std::chrono::steady_clock;
+
+  constexpr size_t records   = 100000;
+  constexpr size_t producers = 4;
+
+  static SKIF_CommonPathsCache& _path_cache = SKIF_CommonPathsCache::GetInstance ( );
+
+  const std::wstring sync_path  = std::wstring (_path_cache.skiv_temp) + L"benchmark_sync.log";
+  const std::wstring async_path = std::wstring (_path_cache.skiv_temp) + L"benchmark_async.log";
+
+  // Formats without writing anything
+  struct skiv_bench_format_appender_s : plog::IAppender {
+    size_t bytes = 0;
+
+    void write (const plog::Record& record) override
+    {
+      bytes += plog::LogFormatterUtcTime::format (record).size ();
+    }
+  };
+
+  auto _Measure = [](plog::IAppender& appender, size_t count, std::vector <double>& ns)
+  {
+    ns.reserve (ns.size () + count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+      plog::Record record (plog::info, __FUNCTION__, __LINE__, __FILE__, nullptr, PLOG_DEFAULT_INSTANCE_ID);
+      record << L"Loading image " << i << L" from " << LR"(C:\Users\Public\Pictures\Screenshots\capture.jxr)";
+
+      const auto start = clock::now ();
+      appender.write (record);
+      const auto end   = clock::now ();
+
+      ns.push_back (std::chrono::duration <double, std::nano> (end - start).count ());
+    }
+  };
+
+  std::vector <double>         format_ns, sync_ns, async_ns;
+  skiv_bench_format_appender_s format;
+
+  _Measure (format, records, format_ns);
+
+  {
+    plog::RollingFileAppender <plog::LogFormatterUtcTime> sync (sync_path.c_str (), 10000000, 1);
+
+    _Measure (sync, records, sync_ns);
+  }
+
+  double   flush_ms = 0.0;
+  uint64_t written  = 0,
+           dropped  = 0;
+
+  {
+    SKIV_AsyncLogAppender async (async_path.c_str (), 10000000);
+
+    std::vector <std::vector <double>> ns (producers);
+    std::vector <std::thread>          threads;
+
+    for (size_t i = 0; i < producers; ++i)
+      threads.emplace_back ([&, i] { _Measure (async, records / producers, ns [i]); });
+
+    for (auto& thread : threads)
+      thread.join ();
+
+    for (auto& times : ns)
+      async_ns.insert (async_ns.end (), times.begin (), times.end ());
+
+    // Whatever the flusher has not gotten to yet
+    const auto start = clock::now ();
+    async.flush ();
+    const auto end   = clock::now ();
+
+    flush_ms = std::chrono::duration <double, std::milli> (end - start).count ();
+    written  = async.written ();
+    dropped  = async.dropped ();
+  }
+
+  std::error_code ec;
+  std::filesystem::remove (sync_path,  ec);
+  std::filesystem::remove (async_path, ec);
+
+  if (written + dropped != records)
+  {
+    PLOG_ERROR << "The asynchronous log appender lost track of " << records - written - dropped << " records!";
+    failed = true;
+  }
+
+  const nlohmann::ordered_json sync_stats  = SKIV_Bench_GetLogStats (sync_ns),
+                               async_stats = SKIV_Bench_GetLogStats (async_ns);
+
+  PLOG_INFO << "Logging: " << SKIV_Bench_GetLogStats (format_ns) ["mean_ns"].get <double> () << " ns to format a record, "
+            << sync_stats  ["mean_ns"].get <double> () << " ns (max " << sync_stats  ["max_ns"].get <double> () << ") per synchronous write, "
+            << async_stats ["mean_ns"].get <double> () << " ns (max " << async_stats ["max_ns"].get <double> () << ") per asynchronous write, "
+            << dropped << " dropped";
+
+  return {
+    { "records",   records                            },
+    { "format",    SKIV_Bench_GetLogStats (format_ns) },
+    { "sync",      sync_stats                         },
+    { "async",     async_stats                        },
+    { "producers", producers                          },
+    { "dropped",   dropped                            },
+    { "flush_ms",  flush_ms                           }
+  };
+}
+
+// CICP decoding (AVIF / JPEG XL / PNG cICP), timed on FP16 noise as libavif
+//   outputs it; the decoded levels are checked by SKIV.Tests
+static nlohmann::ordered_json
+SKIV_Bench_CICP (bool& failed)
+{
+  using clock = std::chrono::steady_clock;
+
+  struct reference_s {
+    const char* name;
+    skiv_cicp_s cicp;
+  };
+
+  static constexpr reference_s references [] = {
+    { "srgb",    { .primaries =  1, .transfer_func = 13 } },
+    { "pq_2020", { .primaries =  9, .transfer_func = 16 } },
+    { "hlg",     { .primaries =  9, .transfer_func = 18 } },
+    { "p3",      { .primaries = 12, .transfer_func = 13 } }
+  };
+
+  constexpr size_t width  = 3840,
+                   height = 2160;
+
+  std::vector <uint16_t> signal (width * height * 4);
+  std::vector <float>    noise  (signal.size ());
+  skiv_bench_rng_s       rng    { 0xC1C9 };
+
+  for (auto& value : noise)
+    value = rng.next ();
+
+  SKIV_Image_PackFP32toFP16 (noise.data (), signal.data (), noise.size ());
+
+  const DirectX::Image image = {
+    .width      = width,
+    .height     = height,
+    .format     = DXGI_FORMAT_R16G16B16A16_FLOAT,
+    .rowPitch   = width * 4 * sizeof (uint16_t),
+    .slicePitch = width * 4 * sizeof (uint16_t) * height,
+    .pixels     = reinterpret_cast <uint8_t *> (signal.data ())
+  };
+
+  const double megapixels =
+    static_cast <double> (width * height) / 1000000.0;
+
+  nlohmann::ordered_json results = nlohmann::ordered_json::array ();
+
+  for (const auto& reference : references)
+  {
+    DirectX::ScratchImage decoded;
+    bool                  wcg = false,
+                          hdr = false;
+
+    double best_ms = DBL_MAX;
+
+    for (int i = 0; i < SKIV_BENCH_WARMUP + SKIV_BENCH_ITERATIONS; ++i)
+    {
+      const auto start = clock::now ();
+      const bool ok    = SUCCEEDED (SKIV_Image_DecodeCICP (image, reference.cicp, decoded, wcg, hdr));
+      const auto end   = clock::now ();
+
+      if (! ok)
+      {
+        failed = true;
+        break;
+      }
+
+      if (i >= SKIV_BENCH_WARMUP)
+        best_ms = std::min (best_ms, std::chrono::duration <double, std::milli> (end - start).count ());
+    }
+
+    PLOG_INFO << "CICP (" << reference.name << "): "
+              << megapixels / (best_ms / 1000.0) << " MP/s";
+
+    results.push_back ({
+      { "cicp",           reference.name                     },
+      { "mp_per_s",       megapixels / (best_ms / 1000.0)    }
+    });
+  }
+
+  return results;
+}
+
+static std::vector <skiv_bench_stage_s>
+SKIV_Bench_GetStages (void)
+{
+  using namespace DirectX;
+
+  constexpr int HDR_WCG = SKIV_Bench_HDR | SKIV_Bench_WCG;
+
+  std::vector <skiv_bench_stage_s> stages = {
+    { "ClassifyGamut", HDR_WCG, [](skiv_bench_input_s& in)
+      {
+        return
+          SKIV_Image_ClassifyGamut (*in.image.GetImages ()).total != 0;
+      }
+    },
+
+    { "ContentLightLevels", HDR_WCG, [](skiv_bench_input_s& in)
+      {
+        float max_cll = 0.0f, max_fall = 0.0f;
+
+        SKIV_HDR_GetContentLightLevels (*in.image.GetImages (), max_cll, max_fall);
+
+        return max_cll > 0.0f;
+      }
+    },
+
+    { "TonemapToSDR", HDR_WCG, [](skiv_bench_input_s& in)
+      {
+        ScratchImage sdr;
+
+        return
+          SUCCEEDED (SKIV_Image_TonemapToSDR (*in.image.GetImages (), sdr, 1000.0f, 80.0f));
+      }
+    },
+
+    { "ConvertImageToPNG", HDR_WCG, [](skiv_bench_input_s& in)
+      {
+        ScratchImage png;
+
+        return
+          SKIV_HDR_ConvertImageToPNG (*in.image.GetImages (), png);
+      }
+    },
+
+    { "LinearToPQ", HDR_WCG, [](skiv_bench_input_s& in)
+      {
+        ScratchImage pq;
+
+        return
+          SUCCEEDED (TransformImage (*in.image.GetImages (),
+            [&](XMVECTOR* outPixels, const XMVECTOR* inPixels, size_t width, size_t y)
+            {
+              UNREFERENCED_PARAMETER (y);
+
+              static const XMVECTOR scale =
+                XMVectorReplicate (80.0f / 10000.0f);
+
+              for (size_t j = 0; j < width; ++j)
+              {
+                outPixels [j] =
+                  SKIV_Image_LinearToPQ (
+                    XMVectorMax (XMVectorMultiply (XMVector3Transform (inPixels [j], c_from709to2020), scale), g_XMZero)
+                  );
+              }
+            }, pq));
+      }
+    },
+
+    { "Convert FP16 to FP32", HDR_WCG, [](skiv_bench_input_s& in)
+      {
+        ScratchImage fp32;
+
+        return
+          SUCCEEDED (SKIV_Image_Convert (*in.image.GetImages (), DXGI_FORMAT_R32G32B32A32_FLOAT, TEX_FILTER_DEFAULT, 0.0f, fp32));
+      }
+    },
+
+    { "ApplyVisualization (Heatmap)", HDR_WCG, [](skiv_bench_input_s& in)
+      {
+        ScratchImage viz_img;
+        skiv_hdr_visualization_s viz;
+        viz.type = SKIV_HDR_VISUALIZTION_HEATMAP;
+
+        return
+          SUCCEEDED (SKIV_Image_ApplyVisualization (*in.image.GetImages (), viz, viz_img));
+      }
+    },
+
+    { "ApplyVisualization (Gamut)", HDR_WCG, [](skiv_bench_input_s& in)
+      {
+        ScratchImage viz_img;
+        skiv_hdr_visualization_s viz;
+        viz.type = SKIV_HDR_VISUALIZTION_GAMUT;
+
+        return
+          SUCCEEDED (SKIV_Image_ApplyVisualization (*in.image.GetImages (), viz, viz_img));
+      }
+    },
+
+    { "ApplyVisualization (Tonemap)", HDR_WCG, [](skiv_bench_input_s& in)
+      {
+        ScratchImage viz_img;
+        skiv_hdr_visualization_s viz;
+        viz.tonemap_type     = SKIV_TONEMAP_TYPE_MAP_CLL_TO_DISPLAY;
+        viz.content_max_nits = 10000.0f;
+        viz.display_max_nits =   400.0f;
+
+        return
+          SUCCEEDED (SKIV_Image_ApplyVisualization (*in.image.GetImages (), viz, viz_img));
+      }
+    },
+
+    { "Encode Radiance HDR", HDR_WCG, [](skiv_bench_input_s& in)
+      {
+        Blob blob;
+
+        return
+          SUCCEEDED (SaveToHDRMemory (*in.image.GetImages (), blob));
+      }
+    },
+
+    { "Decode Radiance HDR", HDR_WCG, [](skiv_bench_input_s& in)
+      {
+        ScratchImage img;
+
+        return
+          SUCCEEDED (LoadFromHDRMemory (in.radiance.GetBufferPointer (), in.radiance.GetBufferSize (), nullptr, img));
+      }
+    },
+
+    { "Encode Radiance HDR (parallel)", HDR_WCG, [](skiv_bench_input_s& in)
+      {
+        Blob blob;
+
+        return
+          SUCCEEDED (SKIV_Image_SaveRadiance (*in.image.GetImages (), blob));
+      }
+    },
+
+    { "Decode Radiance HDR (parallel)", HDR_WCG, [](skiv_bench_input_s& in)
+      {
+        ScratchImage img;
+
+        return
+          SUCCEEDED (SKIV_Image_LoadRadiance (in.radiance.GetBufferPointer (), in.radiance.GetBufferSize (), img));
+      }
+    },
+
+    { "Convert RGBA8 to FP16", SKIV_Bench_SDR, [](skiv_bench_input_s& in)
+      {
+        ScratchImage fp16;
+
+        return
+          SUCCEEDED (SKIV_Image_Convert (*in.image.GetImages (), DXGI_FORMAT_R16G16B16A16_FLOAT, TEX_FILTER_DEFAULT, 0.0f, fp16));
+      }
+    },
+
+    { "GenerateMipMaps", SKIV_Bench_SDR | HDR_WCG, [](skiv_bench_input_s& in)
+      {
+        ScratchImage mips;
+
+        return
+          SUCCEEDED (SKIV_Image_GenerateMipMaps (*in.image.GetImages (), mips));
+      }
+    },
+
+    // Reference for the above
+    { "GenerateMipMaps (DirectXTex)", SKIV_Bench_SDR | HDR_WCG, [](skiv_bench_input_s& in)
+      {
+        ScratchImage mips;
+
+        return
+          SUCCEEDED (GenerateMipMaps (*in.image.GetImages (), TEX_FILTER_DEFAULT, 0, mips));
+      }
+    },
+
+    { "Decompress BC", SKIV_Bench_SDR | HDR_WCG, [](skiv_bench_input_s& in)
+      {
+        ScratchImage img;
+
+        return
+          SUCCEEDED (SKIV_Image_DecompressBC (*in.bc.GetImages (), img));
+      }
+    },
+
+    // Reference for the above
+    { "Decompress BC (DirectXTex)", SKIV_Bench_SDR | HDR_WCG, [](skiv_bench_input_s& in)
+      {
+        ScratchImage img;
+
+        return
+          SUCCEEDED (Decompress (*in.bc.GetImages (), DXGI_FORMAT_UNKNOWN, img));
+      }
+    },
+
+    { "Encode PNG (WIC)", SKIV_Bench_SDR, [](skiv_bench_input_s& in)
+      {
+        Blob blob;
+
+        return
+          SUCCEEDED (SaveToWICMemory (*in.image.GetImages (), WIC_FLAGS_NONE, GetWICCodec (WIC_CODEC_PNG), blob));
+      }
+    },
+
+    { "Decode PNG (WIC)", SKIV_Bench_SDR, [](skiv_bench_input_s& in)
+      {
+        ScratchImage img;
+
+        return
+          SUCCEEDED (LoadFromWICMemory (in.png.GetBufferPointer (), in.png.GetBufferSize (), WIC_FLAGS_NONE, nullptr, img));
+      }
+    },
+
+    { "Decode JPEG (WIC)", SKIV_Bench_SDR, [](skiv_bench_input_s& in)
+      {
+        ScratchImage img;
+
+        return
+          SUCCEEDED (LoadFromWICMemory (in.jpeg.GetBufferPointer (), in.jpeg.GetBufferSize (), WIC_FLAGS_NONE, nullptr, img));
+      }
+    },
+
+    // The viewer decodes everything stbi handles as float
+    { "Decode PNG (stbi)", SKIV_Bench_SDR, [](skiv_bench_input_s& in)
+      {
+        int width, height, channels;
+
+        float* pixels =
+          stbi_loadf_from_memory (static_cast <const stbi_uc *> (in.png.GetBufferPointer ()),
+                                  static_cast <int>             (in.png.GetBufferSize    ()), &width, &height, &channels, 4);
+
+        stbi_image_free (pixels);
+
+        return pixels != nullptr;
+      }
+    },
+
+    { "Decode JPEG (stbi)", SKIV_Bench_SDR, [](skiv_bench_input_s& in)
+      {
+        int width, height, channels;
+
+        float* pixels =
+          stbi_loadf_from_memory (static_cast <const stbi_uc *> (in.jpeg.GetBufferPointer ()),
+                                  static_cast <int>             (in.jpeg.GetBufferSize    ()), &width, &height, &channels, 4);
+
+        stbi_image_free (pixels);
+
+        return pixels != nullptr;
+      }
+    },
+
+    // What the viewer now uses for baseline JPEG, at full size and as a thumbnail
+    { "Decode JPEG (parallel)", SKIV_Bench_SDR, [](skiv_bench_input_s& in)
+      {
+        ScratchImage img;
+
+        return
+          SUCCEEDED (SKIV_Image_LoadJPEG (in.jpeg.GetBufferPointer (), in.jpeg.GetBufferSize (), 1, DXGI_FORMAT_B8G8R8X8_UNORM_SRGB, img));
+      }
+    },
+
+    { "Decode JPEG 1/8 (parallel)", SKIV_Bench_SDR, [](skiv_bench_input_s& in)
+      {
+        ScratchImage img;
+
+        return
+          SUCCEEDED (SKIV_Image_LoadJPEG (in.jpeg.GetBufferPointer (), in.jpeg.GetBufferSize (), 8, DXGI_FORMAT_B8G8R8X8_UNORM_SRGB, img));
+      }
+    },
+  };
+
+  // Halves the image; the "Resize" stages are DirectXTex, for reference
+  for (const auto& resizer : skiv_bench_resizers)
+  {
+    stages.push_back ({ resizer.first, SKIV_Bench_SDR | HDR_WCG, [&resizer](skiv_bench_input_s& in)
+      {
+        ScratchImage half;
+
+        return
+          SUCCEEDED (resizer.second (*in.image.GetImages (), in.width / 2, in.height / 2, half));
+      }
+    });
+  }
+
+  return stages;
+}
+
+int
+SKIV_Benchmark_Run (const std::wstring& output_path)
+{
+  using clock = std::chrono::steady_clock;
+
+  static const std::pair <size_t, size_t> resolutions [] = {
+    { 1280,  720 },
+    { 1920, 1080 },
+    { 3840, 2160 }
+  };
+
+  static const std::pair <skiv_bench_kind_e, const char*> kinds [] = {
+    { SKIV_Bench_SDR, "SDR" },
+    { SKIV_Bench_HDR, "HDR" },
+    { SKIV_Bench_WCG, "WCG" }
+  };
+
+  PLOG_INFO << "Running image pipeline benchmark ("
+            << SKIV_BENCH_WARMUP     << " warmup, "
+            << SKIV_BENCH_ITERATIONS << " measured iterations per stage)...";
+
+  // Per-call logging would otherwise end up in the measurements
+  const plog::Severity severity =
+    plog::get ()->getMaxSeverity ();
+
+  const std::vector <skiv_bench_stage_s> stages =
+    SKIV_Bench_GetStages ();
+
+  nlohmann::ordered_json results = nlohmann::ordered_json::array ();
+  nlohmann::ordered_json quality = nlohmann::ordered_json::array ();
+  nlohmann::ordered_json bc      = nlohmann::ordered_json::array ();
+  bool                   failed  = false;
+
+  const nlohmann::ordered_json sha256 =
+    SKIV_Bench_SHA256 (failed);
+
+  const nlohmann::ordered_json logging =
+    SKIV_Bench_Logging (failed);
+
+  const nlohmann::ordered_json cicp =
+    SKIV_Bench_CICP (failed);
+
+  for (const auto& [kind, kind_name] : kinds)
+  {
+    for (const auto& [width, height] : resolutions)
+    {
+      skiv_bench_input_s input;
+      input.kind      = kind;
+      input.kind_name = kind_name;
+      input.width     = width;
+      input.height    = height;
+
+      if (! SKIV_Bench_Generate (input))
+      {
+        PLOG_ERROR << "Failed to generate the " << kind_name << " " << width << "x" << height << " input!";
+        failed = true;
+        continue;
+      }
+
+      const double megapixels =
+        static_cast <double> (width * height) / 1000000.0;
+
+      // Quality is only measured on the smallest input of each kind
+      if (width == resolutions [0].first)
+      {
+        for (const auto& [name, resize] : skiv_bench_resizers)
+        {
+          const double psnr =
+            SKIV_Bench_GetResamplePSNR (input, resize);
+
+          PLOG_INFO << name << " [" << kind_name << "]: " << psnr << " dB PSNR after a 50% round trip";
+
+          quality.push_back ({
+            { "resampler", name      },
+            { "kind",      kind_name },
+            { "psnr_db",   psnr      }
+          });
+        }
+
+        // The encoders are too slow for the warmup / iteration scheme, so each
+        //   one is timed once.
+        const DXGI_FORMAT bc_format =
+          (kind == SKIV_Bench_SDR) ? DXGI_FORMAT_BC7_UNORM :
+          (kind == SKIV_Bench_HDR) ? DXGI_FORMAT_BC6H_UF16 :
+                                     DXGI_FORMAT_BC6H_SF16;
+
+        for (const auto& [name, compress] : skiv_bench_compressors)
+        {
+          DirectX::ScratchImage compressed, decompressed;
+
+          const auto start = clock::now ();
+          HRESULT    hr    = compress (*input.image.GetImages (), bc_format, compressed);
+          const auto end   = clock::now ();
+
+          if (SUCCEEDED (hr))
+            hr = SKIV_Image_DecompressBC (*compressed.GetImages (), decompressed);
+
+          if (FAILED (hr))
+          {
+            PLOG_ERROR << name << " failed on the " << kind_name << " input, HRESULT=" << hr;
+            failed = true;
+            continue;
+          }
+
+          const double ms   = std::chrono::duration <double, std::milli> (end - start).count ();
+          const double psnr = SKIV_Bench_GetPSNR (input, *decompressed.GetImages ());
+
+          PLOG_INFO << name << " [" << kind_name << "]: " << ms << " ms, "
+                    << megapixels / (ms / 1000.0) << " MP/s, " << psnr << " dB PSNR";
+
+          bc.push_back ({
+            { "encoder",   name                       },
+            { "kind",      kind_name                  },
+            { "format",    (kind == SKIV_Bench_SDR) ? "BC7" : "BC6H" },
+            { "ms",        ms                         },
+            { "mp_per_s",  megapixels / (ms / 1000.0) },
+            { "psnr_db",   psnr                       }
+          });
+        }
+      }
+
+      for (const auto& stage : stages)
+      {
+        if ((stage.kinds & kind) == 0)
+          continue;
+
+        std::vector <double> ms;
+        bool                 ok = true;
+
+        plog::get ()->setMaxSeverity (std::min (severity, plog::warning));
+
+        for (int i = 0; i < SKIV_BENCH_WARMUP + SKIV_BENCH_ITERATIONS && ok; ++i)
+        {
+          const auto start = clock::now ();
+          ok               = stage.run (input);
+          const auto end   = clock::now ();
+
+          if (i >= SKIV_BENCH_WARMUP)
+            ms.push_back (std::chrono::duration <double, std::milli> (end - start).count ());
+        }
+
+        plog::get ()->setMaxSeverity (severity);
+
+        if (! ok)
+        {
+          PLOG_ERROR << stage.name << " failed on the " << kind_name << " " << width << "x" << height << " input!";
+          failed = true;
+          continue;
+        }
+
+        std::sort (ms.begin (), ms.end ());
+
+        const double mean   = std::accumulate (ms.begin (), ms.end (), 0.0) / ms.size ();
+        const double median = ms [ms.size () / 2];
+        const double p90    = ms [std::min (ms.size () - 1, (ms.size () * 9) / 10)];
+        double       var    = 0.0;
+
+        for (double t : ms)
+          var += (t - mean) * (t - mean);
+
+        const double stddev = sqrt (var / ms.size ());
+
+        PLOG_INFO << stage.name << " [" << kind_name << " " << width << "x" << height << "]: "
+                  << median << " ms median, " << megapixels / (median / 1000.0) << " MP/s";
+
+        results.push_back ({
+          { "stage",          stage.name         },
+          { "kind",           kind_name          },
+          { "width",          width              },
+          { "height",         height             },
+          { "iterations",     ms.size ()         },
+          { "min_ms",         ms.front ()        },
+          { "median_ms",      median             },
+          { "mean_ms",        mean               },
+          { "p90_ms",         p90                },
+          { "max_ms",         ms.back ()         },
+          { "stddev_ms",      stddev             },
+          { "mp_per_s",       megapixels / (median / 1000.0) },
+          { "peak_rss_bytes", SKIV_Bench_GetPeakWorkingSet () }
+        });
+      }
+    }
+  }
+
+  nlohmann::ordered_json report = {
+    { "version",        SKIV_VERSION_STR_A                          },
+    { "threads",        std::thread::hardware_concurrency ()       },
+    { "warmup",         SKIV_BENCH_WARMUP                           },
+    { "peak_rss_bytes", SKIV_Bench_GetPeakWorkingSet ()             },
+    { "results",        results                                     },
+    { "resample_psnr",  quality                                     },
+    { "bc_quality",     bc                                          },
+    { "sha256",         sha256                                      },
+    { "logging",        logging                                     },
+    { "cicp",           cicp                                        }
+  };
+
+  std::ofstream file (output_path, std::ios::out | std::ios::trunc);
+
+  if (! file.is_open ())
+  {
+    PLOG_ERROR << "Failed to open " << output_path << " for writing!";
+    return 1;
+  }
+
+  file << report.dump (2) << std::endl;
+
+  PLOG_INFO << "Benchmark results written to " << output_path;
+
+  return
+    (failed || ! file.good ()) ? 1 : 0;
+}
@@ -0,0 +1,259 @@
+#include <utility/buffer_pool.h>
+#include <utility/registry.h>
+#include <utility/fsutil.h>
+#include <utility/trace.h>
+#include <plog/Log.h>
+#include <intrin.h>
+#include <algorithm>
+#include <new>
+
+// Smallest size class handed out; anything below this is rounded up
+constexpr size_t SKIV_BUFFER_POOL_MIN_CLASS = 64 * 1024;
+
+// Size classes are 2^k * { 1, 1.25, 1.5, 1.75 }, which bounds the waste to
+//   25% while letting images of similar (but not identical) dimensions
+//     share buffers.
+static size_t
+SKIV_BufferPool_GetSizeClass (size_t size)
+{
+  if (size <= SKIV_BUFFER_POOL_MIN_CLASS)
+    return    SKIV_BUFFER_POOL_MIN_CLASS;
+
+  unsigned long msb = 0;
+  _BitScanReverse64 (&msb, size);
+
+  const size_t step = 1ULL << (msb - 2);
+
+  return
+    (size + step - 1) & ~(step - 1);
+}
+
+void
+SKIV_BufferPool::deleter_s::operator() (void* ptr) const
+{
+  SKIV_BufferPool::GetInstance ( ).Release (ptr);
+}
+
+SKIV_BufferPool::SKIV_BufferPool (void)
+{
+  static SKIF_RegistrySettings& _registry = SKIF_RegistrySettings::GetInstance ( );
+
+  stats.bytes_cap = static_cast <size_t> (std::max (0, _registry.iBufferPoolCap)) * 1024 * 1024;
+
+  if (_registry.bBufferPoolLargePages)
+    SetLargePages (true);
+}
+
+SKIV_BufferPool::block_s
+SKIV_BufferPool::Allocate (size_t size_class, size_t page_size)
+{
+  block_s block;
+  block.size_class = size_class;
+
+  // page_size is zero unless large pages are enabled
+  if (page_size != 0 && size_class >= page_size)
+  {
+    block.committed = (size_class + page_size - 1) & ~(page_size - 1);
+    block.ptr       =
+      VirtualAlloc (nullptr, block.committed, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+
+    if (block.ptr != nullptr)
+      block.large_pages = true;
+
+    else
+    {
+      PLOG_WARNING << "Large page allocation of " << block.committed << " bytes failed (error " << GetLastError ( ) << "); "
+                   << "falling back to regular pages for the remainder of the session.";
+
+      std::scoped_lock <std::mutex> _(lock);
+      large_pages       = false;
+      stats.large_pages = false;
+    }
+  }
+
+  if (block.ptr == nullptr)
+  {
+    block.committed = size_class;
+    block.ptr       =
+      VirtualAlloc (nullptr, block.committed, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+  }
+
+  return block;
+}
+
+void
+SKIV_BufferPool::Free (block_s& block)
+{
+  VirtualFree (block.ptr, 0, MEM_RELEASE);
+
+  block.ptr = nullptr;
+}
+
+// Returns the least recently released blocks to the OS until at most
+//   retain bytes are left in the pool; the caller must hold the lock.
+void
+SKIV_BufferPool::Evict (size_t retain)
+{
+  size_t count = 0;
+
+  while (stats.bytes_retained > retain && count < free_blocks.size ())
+  {
+    stats.bytes_retained -= free_blocks [count].committed;
+    stats.evictions++;
+
+    Free (free_blocks [count++]);
+  }
+
+  free_blocks.erase (free_blocks.begin (), free_blocks.begin () + count);
+}
+
+void*
+SKIV_BufferPool::Acquire (size_t size)
+{
+  if (size == 0)
+    return nullptr;
+
+  const size_t size_class =
+    SKIV_BufferPool_GetSizeClass (size);
+
+  block_s block;
+
+  std::unique_lock <std::mutex> _(lock);
+
+  // Prefer the most recently released block; it is the most likely to
+  //   still be resident in the working set and the TLB.
+  auto it =
+    std::find_if ( free_blocks.rbegin (), free_blocks.rend (),
+                     [&](const block_s& free_block) { return free_block.size_class == size_class; } );
+
+  if (it != free_blocks.rend ())
+  {
+    block = *it;
+
+    free_blocks.erase (std::next (it).base ());
+
+    stats.bytes_retained -= block.committed;
+    stats.hits++;
+  }
+
+  else
+  {
+    stats.misses++;
+
+    const size_t page_size =
+      large_pages ? large_page_min : 0;
+
+    _.unlock ( );
+    block = Allocate (size_class, page_size);
+    _.lock   ( );
+
+    if (block.ptr == nullptr)
+    {
+      PLOG_ERROR << "Failed to allocate " << size_class << " bytes (error " << GetLastError ( ) << ")";
+      throw std::bad_alloc ( );
+    }
+  }
+
+  live_blocks.emplace (block.ptr, block);
+
+  stats.bytes_in_use      += block.committed;
+  stats.bytes_in_use_peak  =
+    std::max (stats.bytes_in_use_peak, stats.bytes_in_use);
+
+  SKIV_Trace_Counter ("Buffer Pool In Use (MiB)", static_cast <double> (stats.bytes_in_use) / (1024.0 * 1024.0));
+
+  return block.ptr;
+}
+
+void
+SKIV_BufferPool::Release (void* ptr)
+{
+  if (ptr == nullptr)
+    return;
+
+  std::scoped_lock <std::mutex> _(lock);
+
+  auto it =
+    live_blocks.find (ptr);
+
+  if (it == live_blocks.end ())
+  {
+    PLOG_ERROR << "Attempted to release a buffer that was not acquired from the pool: " << ptr;
+    return;
+  }
+
+  block_s block = it->second;
+  live_blocks.erase (it);
+
+  stats.bytes_in_use -= block.committed;
+
+  SKIV_Trace_Counter ("Buffer Pool In Use (MiB)", static_cast <double> (stats.bytes_in_use) / (1024.0 * 1024.0));
+
+  if (block.committed > stats.bytes_cap)
+  {
+    Free (block);
+    return;
+  }
+
+  free_blocks.push_back (block);
+
+  stats.bytes_retained      += block.committed;
+  stats.bytes_retained_peak  =
+    std::max (stats.bytes_retained_peak, stats.bytes_retained);
+
+  Evict (stats.bytes_cap);
+}
+
+void
+SKIV_BufferPool::Trim (size_t retain)
+{
+  std::scoped_lock <std::mutex> _(lock);
+
+  Evict (retain);
+
+  PLOG_VERBOSE << "Buffer pool trimmed; in use: "   << stats.bytes_in_use   / 1024 / 1024 << " MiB"
+               <<                 ", retained: "    << stats.bytes_retained / 1024 / 1024 << " MiB"
+               <<                 ", hits/misses: " << stats.hits << "/" << stats.misses;
+}
+
+void
+SKIV_BufferPool::SetCap (size_t bytes)
+{
+  std::scoped_lock <std::mutex> _(lock);
+
+  stats.bytes_cap = bytes;
+
+  Evict (bytes);
+}
+
+void
+SKIV_BufferPool::SetLargePages (bool enable)
+{
+  std::scoped_lock <std::mutex> _(lock);
+
+  // Large pages require SeLockMemoryPrivilege to have been granted to the user;
+  //   enabling it here is harmless if it was not, VirtualAlloc will then fail
+  //     and we fall back to regular pages.
+  if (enable && large_page_min == 0)
+  {
+    ModifyPrivilege (SE_LOCK_MEMORY_NAME, TRUE);
+
+    large_page_min = GetLargePageMinimum ( );
+
+    if (large_page_min == 0)
+      PLOG_WARNING << "Large pages are not supported on this system!";
+    else
+      PLOG_INFO    << "Buffer pool using large pages of " << large_page_min / 1024 << " KiB";
+  }
+
+  large_pages       = (enable && large_page_min != 0);
+  stats.large_pages = large_pages;
+}
+
+SKIV_BufferPool::stats_s
+SKIV_BufferPool::GetStats (void)
+{
+  std::scoped_lock <std::mutex> _(lock);
+
+  return stats;
+}
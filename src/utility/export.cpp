@@ -0,0 +1,349 @@
+#include <utility/export.h>
+#include <utility/image_tiles.h>
+#include <utility/sk_utility.h>
+#include <utility/trace.h>
+#include <utility/utility.h>
+#include <SKIV.h>
+#include <plog/Log.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+struct skiv_export_job_s {
+  uint32_t              id       = 0;
+  skiv_export_request_s request;
+  size_t                bytes    = 0;                       // Estimated peak allocation
+  std::atomic <float>   progress = 0.0f;
+  std::atomic <bool>    cancel   = false;
+  skiv_export_state_e   state    = SKIV_ExportState_Queued; // Guarded by the queue lock
+  HRESULT               hr       = S_OK;
+};
+
+static struct {
+  std::mutex                                         lock;
+  std::condition_variable                            changed;
+  std::deque  <std::shared_ptr <skiv_export_job_s>>  jobs;      // Submission order, finished ones until reported
+  std::vector <std::thread>                          workers;
+  size_t                                             in_use   = 0;
+  size_t                                             running  = 0;
+  uint32_t                                           next_id  = 1;
+  bool                                               shutdown = false;
+} skiv_export;
+
+// Wakes the render loop so that the export overlay catches up
+static void
+SKIV_Export_SetProgress (skiv_export_job_s& job, float progress)
+{
+  job.progress = progress;
+
+  PostMessage (SKIF_Notify_hWnd, WM_SKIF_EXPORT, 0x0, 0x0);
+}
+
+// The first queued job, if it fits the budget; jobs never overtake each other,
+//   so a large export cannot be starved by a stream of small ones.
+static std::shared_ptr <skiv_export_job_s>
+SKIV_Export_GetNextJob (void)
+{
+  for (auto& job : skiv_export.jobs)
+  {
+    if (job->state != SKIV_ExportState_Queued)
+      continue;
+
+    if (skiv_export.running == 0 || skiv_export.in_use + job->bytes <= SKIV_EXPORT_MEMORY_BUDGET)
+      return job;
+
+    break;
+  }
+
+  return nullptr;
+}
+
+// The resized copy, the visualized or converted copy and the encoder's own
+//   buffers; tiled images are read in place like any other.
+static size_t
+SKIV_Export_EstimateBytes (const skiv_export_request_s& request)
+{
+  size_t bytes = 0;
+
+  if (request.pixels != nullptr)
+    bytes = request.pixels->GetImage (0, 0, 0)->slicePitch;
+
+  else if (request.tiles != nullptr)
+    bytes = request.tiles->image.GetImage (0, 0, 0)->slicePitch;
+
+  return
+    bytes * 3;
+}
+
+static HRESULT
+SKIV_Export_RunJob (skiv_export_job_s& job, const std::wstring& temp_path)
+{
+  SKIV_TRACE_SCOPE ("ExportJob");
+
+  const skiv_export_request_s& request = job.request;
+
+  DirectX::ScratchImage resized, processed;
+  const DirectX::Image* pImage = nullptr;
+
+  if (request.tiles != nullptr)
+    pImage = request.tiles->image.GetImage (0, 0, 0);
+
+  else if (request.pixels != nullptr)
+    pImage = request.pixels->GetImage (0, 0, 0);
+
+  if (pImage == nullptr)
+    return E_POINTER;
+
+  SKIV_Export_SetProgress (job, 0.1f);
+
+  if (job.cancel.load ())
+    return E_ABORT;
+
+  HRESULT hr =
+    SKIV_Image_ResizeForExport (*pImage, request.percent, request.max_width, request.max_height, resized);
+
+  if (FAILED (hr))
+    return hr;
+
+  if (hr == S_OK)
+    pImage = resized.GetImage (0, 0, 0);
+
+  SKIV_Export_SetProgress (job, 0.3f);
+
+  if (job.cancel.load ())
+    return E_ABORT;
+
+  bool save_as_hdr =
+    request.is_hdr && request.mode == SKIV_Export_AsIs;
+
+  if (request.mode == SKIV_Export_Visualization)
+  {
+    if (FAILED (hr = SKIV_Image_ApplyVisualization (*pImage, request.viz, processed)))
+      return hr;
+
+    save_as_hdr = request.viz.hdr_display;
+
+    // Same as the shader's ApplySRGBCurve (saturate (...)) for SDR displays
+    if (! save_as_hdr)
+    {
+      DirectX::ScratchImage                                                                                       srgb_img;
+      if (FAILED (hr = SKIV_Image_Convert (*processed.GetImages (), DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, DirectX::TEX_FILTER_DEFAULT, 0.0f, srgb_img)))
+        return hr;
+
+      std::swap (processed, srgb_img);
+    }
+
+    pImage = processed.GetImage (0, 0, 0);
+  }
+
+  SKIV_Export_SetProgress (job, 0.5f);
+
+  if (job.cancel.load ())
+    return E_ABORT;
+
+  hr = save_as_hdr ? SKIV_Image_SaveToDisk_HDR (*pImage, temp_path.c_str ())
+                   : SKIV_Image_SaveToDisk_SDR (*pImage, temp_path.c_str (), false);
+
+  if (FAILED (hr))
+    return hr;
+
+  SKIV_Export_SetProgress (job, 0.95f);
+
+  if (job.cancel.load ())
+    return E_ABORT;
+
+  if (! MoveFileExW (temp_path.c_str (), request.path.c_str (), MOVEFILE_REPLACE_EXISTING | MOVEFILE_COPY_ALLOWED))
+    return HRESULT_FROM_WIN32 (GetLastError ());
+
+  SKIV_Export_SetProgress (job, 1.0f);
+
+  return S_OK;
+}
+
+static void
+SKIV_Export_Worker (void)
+{
+  SKIF_Util_SetThreadDescription (GetCurrentThread (), L"SKIV_ExportWorker");
+
+  // WIC encoders
+  CoInitializeEx (nullptr, 0x0);
+
+  while (true)
+  {
+    std::shared_ptr <skiv_export_job_s> job;
+
+    {
+      std::unique_lock <std::mutex> _(skiv_export.lock);
+
+      skiv_export.changed.wait (_, [&]
+      {
+        job = SKIV_Export_GetNextJob ();
+
+        return job != nullptr || skiv_export.shutdown;
+      });
+
+      if (job == nullptr)
+        break;
+
+      job->state            = SKIV_ExportState_Running;
+      skiv_export.in_use   += job->bytes;
+      skiv_export.running++;
+    }
+
+    // Same folder, so that the final rename never has to copy across volumes;
+    //   the extension is kept as it selects the encoder.
+    const std::filesystem::path target    (job->request.path);
+    const std::filesystem::path temp_path =
+      target.parent_path () / (target.stem ().wstring () + L".skiv-export-" + std::to_wstring (job->id) + target.extension ().wstring ());
+
+    const DWORD dwStart = SKIF_Util_timeGetTime1 ( );
+
+    const HRESULT hr =
+      SKIV_Export_RunJob (*job, temp_path.wstring ());
+
+    std::error_code ec;
+    std::filesystem::remove (temp_path, ec);
+
+    if (SUCCEEDED (hr))
+      PLOG_INFO    << "Exported " << job->request.path << " in " << SKIF_Util_timeGetTime1 ( ) - dwStart << " ms";
+    else if (hr == E_ABORT)
+      PLOG_INFO    << "Cancelled the export of " << job->request.path;
+    else
+      PLOG_WARNING << "Failed to export " << job->request.path << ", HRESULT=" << hr;
+
+    {
+      std::scoped_lock <std::mutex> _(skiv_export.lock);
+
+      job->hr    = hr;
+      job->state = SUCCEEDED (hr)  ? SKIV_ExportState_Succeeded :
+                   (hr == E_ABORT) ? SKIV_ExportState_Cancelled :
+                                     SKIV_ExportState_Failed;
+
+      // The pixels may be the last reference to an image the viewer moved on from
+      job->request.pixels = nullptr;
+      job->request.tiles  = nullptr;
+
+      skiv_export.in_use -= job->bytes;
+      skiv_export.running--;
+    }
+
+    skiv_export.changed.notify_all ();
+
+    PostMessage (SKIF_Notify_hWnd, WM_SKIF_EXPORT, 0x0, 0x0);
+  }
+
+  CoUninitialize ();
+}
+
+uint32_t
+SKIV_Export_Submit (skiv_export_request_s request)
+{
+  auto job =
+    std::make_shared <skiv_export_job_s> ();
+
+  job->bytes   = SKIV_Export_EstimateBytes (request);
+  job->request = std::move (request);
+
+  {
+    std::scoped_lock <std::mutex> _(skiv_export.lock);
+
+    job->id = skiv_export.next_id++;
+
+    skiv_export.jobs.push_back (job);
+
+    if (skiv_export.workers.empty () && ! skiv_export.shutdown)
+    {
+      for (size_t i = 0; i < SKIV_EXPORT_WORKERS; ++i)
+        skiv_export.workers.emplace_back (SKIV_Export_Worker);
+    }
+  }
+
+  PLOG_INFO << "Queued export #" << job->id << " to " << job->request.path
+            << " (" << job->bytes / (1024 * 1024) << " MiB estimated)";
+
+  skiv_export.changed.notify_all ();
+
+  return job->id;
+}
+
+void
+SKIV_Export_Cancel (uint32_t id)
+{
+  {
+    std::scoped_lock <std::mutex> _(skiv_export.lock);
+
+    for (auto& job : skiv_export.jobs)
+    {
+      if (job->id != id)
+        continue;
+
+      job->cancel = true;
+
+      if (job->state == SKIV_ExportState_Queued)
+      {
+        job->state          = SKIV_ExportState_Cancelled;
+        job->hr             = E_ABORT;
+        job->request.pixels = nullptr;
+        job->request.tiles  = nullptr;
+      }
+    }
+  }
+
+  // The next queued job may fit now
+  skiv_export.changed.notify_all ();
+}
+
+void
+SKIV_Export_GetJobs (std::vector <skiv_export_status_s>& jobs)
+{
+  jobs.clear ();
+
+  std::scoped_lock <std::mutex> _(skiv_export.lock);
+
+  for (const auto& job : skiv_export.jobs)
+  {
+    jobs.push_back ({
+      job->id, job->request.path, job->request.mode,
+      job->state, job->progress.load (), job->hr
+    });
+  }
+
+  std::erase_if (skiv_export.jobs, [](const std::shared_ptr <skiv_export_job_s>& job)
+  {
+    return job->state >= SKIV_ExportState_Succeeded;
+  });
+}
+
+void
+SKIV_Export_Shutdown (void)
+{
+  std::vector <std::thread> workers;
+
+  {
+    std::scoped_lock <std::mutex> _(skiv_export.lock);
+
+    skiv_export.shutdown = true;
+
+    for (auto& job : skiv_export.jobs)
+    {
+      job->cancel = true;
+
+      if (job->state == SKIV_ExportState_Queued)
+        job->state = SKIV_ExportState_Cancelled;
+    }
+
+    std::swap (workers, skiv_export.workers);
+  }
+
+  skiv_export.changed.notify_all ();
+
+  if (! workers.empty ())
+    PLOG_INFO << "Waiting for the export workers to exit...";
+
+  for (auto& worker : workers)
+    worker.join ();
+}
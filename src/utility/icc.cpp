@@ -0,0 +1,855 @@
+#include <utility/icc.h>
+#include <utility/image.h>
+#include <utility/sha256.h>
+#include <utility/trace.h>
+#include <plog/Log.h>
+#include <stb_image.h>
+#include <immintrin.h>
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <ppl.h>
+
+#pragma region Parsing
+
+static constexpr uint32_t
+SKIV_ICC_Sig (const char (&sig) [5])
+{
+  return (static_cast <uint32_t> (static_cast <uint8_t> (sig [0])) << 24) |
+         (static_cast <uint32_t> (static_cast <uint8_t> (sig [1])) << 16) |
+         (static_cast <uint32_t> (static_cast <uint8_t> (sig [2])) <<  8) |
+          static_cast <uint32_t> (static_cast <uint8_t> (sig [3]));
+}
+
+static uint16_t
+SKIV_ICC_ReadU16 (const uint8_t* data)
+{
+  return static_cast <uint16_t> ((data [0] << 8) | data [1]);
+}
+
+static uint32_t
+SKIV_ICC_ReadU32 (const uint8_t* data)
+{
+  return (static_cast <uint32_t> (data [0]) << 24) | (static_cast <uint32_t> (data [1]) << 16) |
+         (static_cast <uint32_t> (data [2]) <<  8) |  static_cast <uint32_t> (data [3]);
+}
+
+static float
+SKIV_ICC_ReadS15Fixed16 (const uint8_t* data)
+{
+  return
+    static_cast <float> (static_cast <int32_t> (SKIV_ICC_ReadU32 (data))) / 65536.0f;
+}
+
+// D50 XYZ (the profile connection space) to scRGB, Bradford-adapted to D65
+static constexpr float skiv_icc_xyz_d50_to_scrgb [3][3] = {
+  {  3.1338561f, -1.6168667f, -0.4906146f },
+  { -0.9787684f,  1.9161415f,  0.0334540f },
+  {  0.0719453f, -0.2289914f,  1.4052427f }
+};
+
+struct skiv_icc_profile_s {
+  const uint8_t* data = nullptr;
+  size_t         size = 0;
+
+  uint32_t color_space (void) const { return SKIV_ICC_ReadU32 (data + 16); }
+  uint32_t pcs         (void) const { return SKIV_ICC_ReadU32 (data + 20); }
+
+  bool parse (const uint8_t* profile, size_t profile_size)
+  {
+    data = profile;
+    size = profile_size;
+
+    return size >= 132                                          &&
+           SKIV_ICC_ReadU32 (data + 36) == SKIV_ICC_Sig ("acsp") &&
+           SKIV_ICC_ReadU32 (data + 128) <= (size - 132) / 12;
+  }
+
+  // The tag data, bounds-checked against the profile
+  const uint8_t* find (uint32_t sig, size_t& tag_size) const
+  {
+    const uint32_t tags =
+      SKIV_ICC_ReadU32 (data + 128);
+
+    for (uint32_t i = 0; i < tags; ++i)
+    {
+      const uint8_t* entry = data + 132 + i * 12;
+
+      if (SKIV_ICC_ReadU32 (entry) != sig)
+        continue;
+
+      const size_t offset = SKIV_ICC_ReadU32 (entry + 4);
+                 tag_size = SKIV_ICC_ReadU32 (entry + 8);
+
+      if (offset >= size || tag_size > size - offset || tag_size < 8)
+        return nullptr;
+
+      return data + offset;
+    }
+
+    return nullptr;
+  }
+};
+
+// Linear interpolation into a table spanning [0, 1]
+template <typename T>
+static float
+SKIV_ICC_Interpolate (const T* table, size_t count, float scale, float x)
+{
+  const float pos  = std::clamp (x, 0.0f, 1.0f) * static_cast <float> (count - 1);
+  const size_t idx = std::min (static_cast <size_t> (pos), count - 2);
+  const float frac = pos - static_cast <float> (idx);
+
+  return
+    (static_cast <float> (table [idx]) + frac * (static_cast <float> (table [idx + 1]) - static_cast <float> (table [idx]))) * scale;
+}
+
+// curveType and parametricCurveType, sampled into SKIV_ICC_CURVE_SIZE + 1 steps
+static bool
+SKIV_ICC_ReadCurve (const uint8_t* tag, size_t size, std::vector <float>& curve)
+{
+  if (size < 12)
+    return false;
+
+  curve.resize (SKIV_ICC_CURVE_SIZE + 1);
+
+  const uint32_t type =
+    SKIV_ICC_ReadU32 (tag);
+
+  if (type == SKIV_ICC_Sig ("curv"))
+  {
+    const uint32_t count =
+      SKIV_ICC_ReadU32 (tag + 8);
+
+    if (count > (size - 12) / 2)
+      return false;
+
+    std::vector <uint16_t> table (count);
+
+    for (uint32_t i = 0; i < count; ++i)
+      table [i] = SKIV_ICC_ReadU16 (tag + 12 + i * 2);
+
+    // No entries is the identity, a single one a gamma in u8Fixed8
+    const float gamma =
+      (count == 1) ? static_cast <float> (table [0]) / 256.0f : 1.0f;
+
+    for (size_t i = 0; i <= SKIV_ICC_CURVE_SIZE; ++i)
+    {
+      const float x =
+        static_cast <float> (i) / static_cast <float> (SKIV_ICC_CURVE_SIZE);
+
+      curve [i] = (count < 2) ? std::pow (x, gamma)
+                              : SKIV_ICC_Interpolate (table.data (), count, 1.0f / 65535.0f, x);
+    }
+
+    return true;
+  }
+
+  if (type == SKIV_ICC_Sig ("para"))
+  {
+    static constexpr uint32_t param_count [5] = { 1, 3, 4, 5, 7 };
+
+    const uint16_t function =
+      SKIV_ICC_ReadU16 (tag + 8);
+
+    if (function > 4 || size < 12 + param_count [function] * 4)
+      return false;
+
+    float p [7] = { 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+
+    for (uint32_t i = 0; i < param_count [function]; ++i)
+      p [i] = SKIV_ICC_ReadS15Fixed16 (tag + 12 + i * 4);
+
+    const float g = p [0], a = p [1], b = p [2], c = p [3],
+                d = p [4], e = p [5], f = p [6];
+
+    for (size_t i = 0; i <= SKIV_ICC_CURVE_SIZE; ++i)
+    {
+      const float x =
+        static_cast <float> (i) / static_cast <float> (SKIV_ICC_CURVE_SIZE);
+
+      float y = 0.0f;
+
+      switch (function)
+      {
+        case 0: y =                                                 std::pow (x, g);                  break;
+        case 1: y = (x >= -b / a) ? std::pow (std::max (0.0f, a * x + b), g)     : 0.0f;              break;
+        case 2: y = (x >= -b / a) ? std::pow (std::max (0.0f, a * x + b), g) + c : c;                 break;
+        case 3: y = (x >=  d)     ? std::pow (std::max (0.0f, a * x + b), g)     : c * x;             break;
+        case 4: y = (x >=  d)     ? std::pow (std::max (0.0f, a * x + b), g) + e : c * x + f;         break;
+      }
+
+      curve [i] = y;
+    }
+
+    return true;
+  }
+
+  return false;
+}
+
+#pragma endregion
+
+#pragma region Compilation
+
+static float
+SKIV_ICC_LabInverse (float t)
+{
+  return (t > 6.0f / 29.0f) ? t * t * t
+                            : 3.0f * (6.0f / 29.0f) * (6.0f / 29.0f) * (t - 4.0f / 29.0f);
+}
+
+static void
+SKIV_ICC_XYZtoScRGB (const float xyz [3], float* rgb)
+{
+  for (int i = 0; i < 3; ++i)
+  {
+    rgb [i] = skiv_icc_xyz_d50_to_scrgb [i][0] * xyz [0] +
+              skiv_icc_xyz_d50_to_scrgb [i][1] * xyz [1] +
+              skiv_icc_xyz_d50_to_scrgb [i][2] * xyz [2];
+  }
+}
+
+static bool
+SKIV_ICC_CompileMatrix (const skiv_icc_profile_s& profile, skiv_icc_transform_s& transform)
+{
+  size_t tag_size = 0;
+
+  transform.type = skiv_icc_transform_s::Matrix;
+
+  if (profile.color_space () == SKIV_ICC_Sig ("GRAY"))
+  {
+    const uint8_t* trc =
+      profile.find (SKIV_ICC_Sig ("kTRC"), tag_size);
+
+    if (trc == nullptr || ! SKIV_ICC_ReadCurve (trc, tag_size, transform.curves [0]))
+      return false;
+
+    transform.curves [1] = transform.curves [0];
+    transform.curves [2] = transform.curves [0];
+
+    // Gray maps onto the PCS white point, which is scRGB white
+    for (int i = 0; i < 3; ++i)
+      transform.matrix [i][i] = 1.0f;
+
+    return true;
+  }
+
+  static constexpr uint32_t colorants [3] = { SKIV_ICC_Sig ("rXYZ"), SKIV_ICC_Sig ("gXYZ"), SKIV_ICC_Sig ("bXYZ") };
+  static constexpr uint32_t trcs      [3] = { SKIV_ICC_Sig ("rTRC"), SKIV_ICC_Sig ("gTRC"), SKIV_ICC_Sig ("bTRC") };
+
+  float to_xyz [3][3] = { }; // Colorants as columns
+
+  for (int c = 0; c < 3; ++c)
+  {
+    const uint8_t* xyz =
+      profile.find (colorants [c], tag_size);
+
+    if (xyz == nullptr || tag_size < 20)
+      return false;
+
+    for (int i = 0; i < 3; ++i)
+      to_xyz [i][c] = SKIV_ICC_ReadS15Fixed16 (xyz + 8 + i * 4);
+
+    const uint8_t* trc =
+      profile.find (trcs [c], tag_size);
+
+    if (trc == nullptr || ! SKIV_ICC_ReadCurve (trc, tag_size, transform.curves [c]))
+      return false;
+  }
+
+  for (int i = 0; i < 3; ++i)
+  {
+    for (int j = 0; j < 3; ++j)
+    {
+      transform.matrix [i][j] = skiv_icc_xyz_d50_to_scrgb [i][0] * to_xyz [0][j] +
+                                skiv_icc_xyz_d50_to_scrgb [i][1] * to_xyz [1][j] +
+                                skiv_icc_xyz_d50_to_scrgb [i][2] * to_xyz [2][j];
+    }
+  }
+
+  return true;
+}
+
+// lut8Type / lut16Type with three input and output channels; the tag's matrix
+//   only applies to XYZ input, so it is ignored for RGB
+static bool
+SKIV_ICC_CompileLUT (const skiv_icc_profile_s& profile, skiv_icc_transform_s& transform)
+{
+  size_t         tag_size = 0;
+  const uint8_t* tag      =
+    profile.find (SKIV_ICC_Sig ("A2B0"), tag_size);
+
+  if (tag == nullptr || tag_size < 52 || profile.color_space () != SKIV_ICC_Sig ("RGB "))
+    return false;
+
+  const uint32_t type  = SKIV_ICC_ReadU32 (tag);
+  const bool     lut16 = (type == SKIV_ICC_Sig ("mft2"));
+
+  if (! lut16 && type != SKIV_ICC_Sig ("mft1"))
+    return false;
+
+  const bool lab = (profile.pcs () == SKIV_ICC_Sig ("Lab "));
+
+  if (! lab && (profile.pcs () != SKIV_ICC_Sig ("XYZ ") || ! lut16))
+    return false;
+
+  const uint32_t in_channels  = tag [8],
+                 out_channels = tag [9],
+                 clut_points  = tag [10];
+
+  if (in_channels != 3 || out_channels != 3 || clut_points < 2)
+    return false;
+
+  const size_t in_entries  = lut16 ? SKIV_ICC_ReadU16 (tag + 48) : 256,
+               out_entries = lut16 ? SKIV_ICC_ReadU16 (tag + 50) : 256,
+               value_size  = lut16 ? 2 : 1,
+               clut_size   = clut_points * clut_points * clut_points * 3,
+               start       = lut16 ? 52 : 48;
+
+  if (in_entries < 2 || out_entries < 2 ||
+      start + (in_entries * 3 + clut_size + out_entries * 3) * value_size > tag_size)
+    return false;
+
+  // Everything normalized to [0, 1]
+  auto _ReadTable = [&](size_t offset, size_t count)
+  {
+    std::vector <float> table (count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+      table [i] = lut16 ? static_cast <float> (SKIV_ICC_ReadU16 (tag + offset + i * 2)) / 65535.0f
+                        : static_cast <float> (tag [offset + i])                        /   255.0f;
+    }
+
+    return table;
+  };
+
+  std::vector <float> in_curves  = _ReadTable (start,                                                  in_entries * 3),
+                      clut       = _ReadTable (start +  in_entries * 3              * value_size,      clut_size),
+                      out_curves = _ReadTable (start + (in_entries * 3 + clut_size) * value_size, out_entries * 3);
+
+  auto _Evaluate = [&](const float rgb [3], float* out)
+  {
+    float pos  [3];
+    int   idx  [3];
+    float frac [3];
+
+    for (int c = 0; c < 3; ++c)
+    {
+      pos  [c] = SKIV_ICC_Interpolate (in_curves.data () + c * in_entries, in_entries, 1.0f, rgb [c]) * static_cast <float> (clut_points - 1);
+      idx  [c] = std::min (static_cast <int> (pos [c]), static_cast <int> (clut_points) - 2);
+      frac [c] = pos [c] - static_cast <float> (idx [c]);
+    }
+
+    float pcs [3] = { };
+
+    for (int corner = 0; corner < 8; ++corner)
+    {
+      float  weight = 1.0f;
+      size_t node   = 0;
+
+      for (int c = 0; c < 3; ++c)
+      {
+        const int bit = (corner >> (2 - c)) & 1;
+
+        weight *= bit ? frac [c] : 1.0f - frac [c];
+        node    = node * clut_points + idx [c] + bit;
+      }
+
+      for (int o = 0; o < 3; ++o)
+        pcs [o] += weight * clut [node * 3 + o];
+    }
+
+    for (int o = 0; o < 3; ++o)
+      pcs [o] = SKIV_ICC_Interpolate (out_curves.data () + o * out_entries, out_entries, 1.0f, pcs [o]);
+
+    float xyz [3];
+
+    if (lab)
+    {
+      // lut16Type keeps the legacy 16-bit Lab encoding, even in version 4 profiles
+      const float L = lut16 ? pcs [0] * 65535.0f / 65280.0f * 100.0f : pcs [0] * 100.0f;
+      const float a = lut16 ? pcs [1] * 65535.0f / 256.0f - 128.0f   : pcs [1] * 255.0f - 128.0f;
+      const float b = lut16 ? pcs [2] * 65535.0f / 256.0f - 128.0f   : pcs [2] * 255.0f - 128.0f;
+
+      const float fy = (L + 16.0f) / 116.0f;
+
+      xyz [0] = 0.9642f * SKIV_ICC_LabInverse (fy + a / 500.0f);
+      xyz [1] =           SKIV_ICC_LabInverse (fy);
+      xyz [2] = 0.8249f * SKIV_ICC_LabInverse (fy - b / 200.0f);
+    }
+
+    else
+    {
+      for (int o = 0; o < 3; ++o)
+        xyz [o] = pcs [o] * 65535.0f / 32768.0f;
+    }
+
+    SKIV_ICC_XYZtoScRGB (xyz, out);
+  };
+
+  transform.type = skiv_icc_transform_s::LUT3D;
+  transform.grid = 33;
+  transform.lut.resize (transform.grid * transform.grid * transform.grid * 4);
+
+  const float step =
+    1.0f / static_cast <float> (transform.grid - 1);
+
+  for (uint32_t r = 0; r < transform.grid; ++r)
+  for (uint32_t g = 0; g < transform.grid; ++g)
+  for (uint32_t b = 0; b < transform.grid; ++b)
+  {
+    const float rgb [3] = { r * step, g * step, b * step };
+
+    _Evaluate (rgb, &transform.lut [((r * transform.grid + g) * transform.grid + b) * 4]);
+  }
+
+  return true;
+}
+
+// Within half a code value of sRGB at 8 bpc, and a matrix close to identity
+static bool
+SKIV_ICC_IsSRGB (const skiv_icc_transform_s& transform)
+{
+  if (transform.type != skiv_icc_transform_s::Matrix)
+    return false;
+
+  for (int i = 0; i < 3; ++i)
+  for (int j = 0; j < 3; ++j)
+  {
+    if (std::abs (transform.matrix [i][j] - ((i == j) ? 1.0f : 0.0f)) > 0.01f)
+      return false;
+  }
+
+  for (int c = 0; c < 3; ++c)
+  {
+    for (size_t i = 0; i <= SKIV_ICC_CURVE_SIZE; i += 16)
+    {
+      const float x =
+        static_cast <float> (i) / static_cast <float> (SKIV_ICC_CURVE_SIZE);
+
+      const float srgb =
+        (x <= 0.04045f) ? x / 12.92f : std::pow ((x + 0.055f) / 1.055f, 2.4f);
+
+      // Compared encoded, where the eye is about equally sensitive throughout
+      if (std::abs (std::pow (transform.curves [c][i], 1.0f / 2.4f) - std::pow (srgb, 1.0f / 2.4f)) > 0.5f / 255.0f)
+        return false;
+    }
+  }
+
+  return true;
+}
+
+#pragma endregion
+
+static struct {
+  std::mutex                                                          lock;
+  std::map <std::string, std::shared_ptr <const skiv_icc_transform_s>> transforms; // nullptr for unsupported profiles
+} skiv_icc_cache;
+
+std::shared_ptr <const skiv_icc_transform_s>
+SKIV_ICC_GetTransform (const uint8_t* data, size_t size)
+{
+  skiv_sha256_s sha256;
+  sha256.update (data, size);
+
+  const std::string hash =
+    sha256.finish_hex ();
+
+  {
+    std::scoped_lock <std::mutex> _(skiv_icc_cache.lock);
+
+    if (auto  it  = skiv_icc_cache.transforms.find (hash);
+              it != skiv_icc_cache.transforms.end ())
+      return  it->second;
+  }
+
+  SKIV_TRACE_SCOPE ("CompileICC");
+
+  auto transform =
+    std::make_shared <skiv_icc_transform_s> ();
+
+  skiv_icc_profile_s profile;
+
+  bool compiled =
+    profile.parse (data, size);
+
+  // A LUT takes precedence over the colorants, as it does for any CMM
+  if (compiled)
+    compiled = SKIV_ICC_CompileLUT    (profile, *transform) ||
+               SKIV_ICC_CompileMatrix (profile, *transform);
+
+  std::shared_ptr <const skiv_icc_transform_s> result;
+
+  if (! compiled)
+    PLOG_WARNING << "Unsupported ICC profile " << hash.substr (0, 16) << ", treating the image as sRGB";
+
+  else if (SKIV_ICC_IsSRGB (*transform))
+    PLOG_DEBUG   << "ICC profile " << hash.substr (0, 16) << " is equivalent to sRGB";
+
+  else
+  {
+    PLOG_INFO    << "Compiled ICC profile " << hash.substr (0, 16) << " into a "
+                 << ((transform->type == skiv_icc_transform_s::LUT3D) ? "3D LUT" : "matrix and curves");
+
+    result = transform;
+  }
+
+  std::scoped_lock <std::mutex> _(skiv_icc_cache.lock);
+
+  skiv_icc_cache.transforms [hash] = result;
+
+  return result;
+}
+
+#pragma region Evaluation
+
+static __forceinline __m128
+SKIV_ICC_SampleLUT3D (const skiv_icc_transform_s& transform, const float* rgb)
+{
+  const int   last = static_cast <int> (transform.grid) - 1;
+
+  int   idx  [3];
+  float frac [3];
+
+  for (int c = 0; c < 3; ++c)
+  {
+    const float pos = std::clamp (rgb [c], 0.0f, 1.0f) * static_cast <float> (last);
+
+    idx  [c] = std::min (static_cast <int> (pos), last - 1);
+    frac [c] = pos - static_cast <float> (idx [c]);
+  }
+
+  const size_t stride_r = transform.grid * transform.grid * 4,
+               stride_g = transform.grid * 4;
+
+  const float* n =
+    transform.lut.data () + idx [0] * stride_r + idx [1] * stride_g + idx [2] * 4;
+
+  auto _Lerp = [](__m128 a, __m128 b, float t)
+  {
+    return _mm_add_ps (a, _mm_mul_ps (_mm_sub_ps (b, a), _mm_set1_ps (t)));
+  };
+
+  const __m128 c00 = _Lerp (_mm_loadu_ps (n),                       _mm_loadu_ps (n + 4),                       frac [2]);
+  const __m128 c01 = _Lerp (_mm_loadu_ps (n + stride_g),            _mm_loadu_ps (n + stride_g + 4),            frac [2]);
+  const __m128 c10 = _Lerp (_mm_loadu_ps (n + stride_r),            _mm_loadu_ps (n + stride_r + 4),            frac [2]);
+  const __m128 c11 = _Lerp (_mm_loadu_ps (n + stride_r + stride_g), _mm_loadu_ps (n + stride_r + stride_g + 4), frac [2]);
+
+  return
+    _Lerp (_Lerp (c00, c01, frac [1]), _Lerp (c10, c11, frac [1]), frac [0]);
+}
+
+void
+SKIV_ICC_Transform (const skiv_icc_transform_s& transform, const float* src, float* dst, size_t count)
+{
+  for (size_t i = 0; i < count; ++i, src += 4, dst += 4)
+  {
+    float rgb [4];
+
+    if (transform.type == skiv_icc_transform_s::LUT3D)
+      _mm_storeu_ps (rgb, SKIV_ICC_SampleLUT3D (transform, src));
+
+    else
+    {
+      float linear [3];
+
+      for (int c = 0; c < 3; ++c)
+        linear [c] = SKIV_ICC_Interpolate (transform.curves [c].data (), SKIV_ICC_CURVE_SIZE + 1, 1.0f, src [c]);
+
+      for (int c = 0; c < 3; ++c)
+        rgb [c] = transform.matrix [c][0] * linear [0] + transform.matrix [c][1] * linear [1] + transform.matrix [c][2] * linear [2];
+    }
+
+    const float alpha = src [3];
+
+    dst [0] = rgb [0];
+    dst [1] = rgb [1];
+    dst [2] = rgb [2];
+    dst [3] = alpha;
+  }
+}
+
+HRESULT
+SKIV_ICC_TransformImage (const skiv_icc_transform_s& transform, const void* pixels, size_t width, size_t height, bool is_16bit,
+                         DirectX::ScratchImage& result, bool& wcg, bool& hdr)
+{
+  SKIV_TRACE_SCOPE ("ApplyICC");
+
+  HRESULT hr =
+    result.Initialize2D (DXGI_FORMAT_R16G16B16A16_FLOAT, width, height, 1, 1);
+
+  if (FAILED (hr))
+    return hr;
+
+  const DirectX::Image& dst =
+    *result.GetImage (0, 0, 0);
+
+  // The curves resampled at every code value, so that they are a single gather
+  const size_t levels = is_16bit ? 65536 : 256;
+
+  std::vector <float> tables [3];
+
+  if (transform.type == skiv_icc_transform_s::Matrix)
+  {
+    for (int c = 0; c < 3; ++c)
+    {
+      tables [c].resize (levels);
+
+      for (size_t v = 0; v < levels; ++v)
+        tables [c][v] = SKIV_ICC_Interpolate (transform.curves [c].data (), SKIV_ICC_CURVE_SIZE + 1, 1.0f,
+                                              static_cast <float> (v) / static_cast <float> (levels - 1));
+    }
+  }
+
+  static const size_t
+    num_cpus = std::max (1U, std::thread::hardware_concurrency ());
+
+  const size_t band  = std::max <size_t> (1, height / (num_cpus * 4));
+  const size_t bands = (height + band - 1) / band;
+
+  // Outside of Rec. 709 / above SDR white by more than rounding noise
+  constexpr float epsilon = 1.0f / 1024.0f;
+
+  std::atomic <bool> any_wcg = false,
+                     any_hdr = false;
+
+  concurrency::parallel_for (size_t (0), bands, [&](size_t band_idx)
+  {
+    std::vector <float> row (width * 4 + 32);
+
+    __m256 vMin = _mm256_set1_ps ( FLT_MAX),
+           vMax = _mm256_set1_ps (-FLT_MAX);
+
+    float  fMin =  FLT_MAX,
+           fMax = -FLT_MAX;
+
+    const size_t y_end =
+      std::min (height, (band_idx + 1) * band);
+
+    for (size_t y = band_idx * band; y < y_end; ++y)
+    {
+      const uint8_t*  src8  = static_cast <const uint8_t  *> (pixels) + y * width * 4;
+      const uint16_t* src16 = static_cast <const uint16_t *> (pixels) + y * width * 4;
+
+      size_t x = 0;
+
+      if (transform.type == skiv_icc_transform_s::Matrix)
+      {
+        const __m256 m [3][3] = {
+          { _mm256_set1_ps (transform.matrix [0][0]), _mm256_set1_ps (transform.matrix [0][1]), _mm256_set1_ps (transform.matrix [0][2]) },
+          { _mm256_set1_ps (transform.matrix [1][0]), _mm256_set1_ps (transform.matrix [1][1]), _mm256_set1_ps (transform.matrix [1][2]) },
+          { _mm256_set1_ps (transform.matrix [2][0]), _mm256_set1_ps (transform.matrix [2][1]), _mm256_set1_ps (transform.matrix [2][2]) }
+        };
+
+        const __m256  alpha_scale = _mm256_set1_ps (1.0f / static_cast <float> (levels - 1));
+        const __m256i byte_mask   = _mm256_set1_epi32 (0xFF);
+
+        for (; x + 8 <= width; x += 8)
+        {
+          __m256i ir, ig, ib, ia;
+
+          if (! is_16bit)
+          {
+            const __m256i px =
+              _mm256_loadu_si256 (reinterpret_cast <const __m256i *> (src8 + x * 4));
+
+            ir = _mm256_and_si256  (                    px,      byte_mask);
+            ig = _mm256_and_si256  (_mm256_srli_epi32  (px,  8), byte_mask);
+            ib = _mm256_and_si256  (_mm256_srli_epi32  (px, 16), byte_mask);
+            ia =                    _mm256_srli_epi32  (px, 24);
+          }
+
+          else
+          {
+            alignas (32) int32_t c [4][8];
+
+            for (int i = 0; i < 8; ++i)
+            for (int k = 0; k < 4; ++k)
+              c [k][i] = src16 [(x + i) * 4 + k];
+
+            ir = _mm256_load_si256 (reinterpret_cast <const __m256i *> (c [0]));
+            ig = _mm256_load_si256 (reinterpret_cast <const __m256i *> (c [1]));
+            ib = _mm256_load_si256 (reinterpret_cast <const __m256i *> (c [2]));
+            ia = _mm256_load_si256 (reinterpret_cast <const __m256i *> (c [3]));
+          }
+
+          const __m256 r = _mm256_i32gather_ps (tables [0].data (), ir, 4);
+          const __m256 g = _mm256_i32gather_ps (tables [1].data (), ig, 4);
+          const __m256 b = _mm256_i32gather_ps (tables [2].data (), ib, 4);
+
+          __m256 out [4];
+
+          for (int c = 0; c < 3; ++c)
+          {
+            out [c] = _mm256_fmadd_ps (m [c][0], r,
+                      _mm256_fmadd_ps (m [c][1], g,
+                      _mm256_mul_ps   (m [c][2], b)));
+
+            vMin = _mm256_min_ps (vMin, out [c]);
+            vMax = _mm256_max_ps (vMax, out [c]);
+          }
+
+          out [3] = _mm256_mul_ps (_mm256_cvtepi32_ps (ia), alpha_scale);
+
+          alignas (32) float soa [4][8];
+
+          for (int c = 0; c < 4; ++c)
+            _mm256_store_ps (soa [c], out [c]);
+
+          for (int i = 0; i < 8; ++i)
+          for (int c = 0; c < 4; ++c)
+            row [(x + i) * 4 + c] = soa [c][i];
+        }
+      }
+
+      // LUT-based transforms, and whatever is left of the row
+      const float scale =
+        1.0f / static_cast <float> (levels - 1);
+
+      for (; x < width; ++x)
+      {
+        float in [4];
+
+        for (int c = 0; c < 4; ++c)
+          in [c] = static_cast <float> (is_16bit ? src16 [x * 4 + c] : src8 [x * 4 + c]) * scale;
+
+        SKIV_ICC_Transform (transform, in, &row [x * 4], 1);
+
+        for (int c = 0; c < 3; ++c)
+        {
+          fMin = std::min (fMin, row [x * 4 + c]);
+          fMax = std::max (fMax, row [x * 4 + c]);
+        }
+      }
+
+      SKIV_Image_PackFP32toFP16 (row.data (), reinterpret_cast <uint16_t *> (dst.pixels + y * dst.rowPitch), width * 4);
+    }
+
+    alignas (32) float lanes [2][8];
+
+    _mm256_store_ps (lanes [0], vMin);
+    _mm256_store_ps (lanes [1], vMax);
+
+    for (int i = 0; i < 8; ++i)
+    {
+      fMin = std::min (fMin, lanes [0][i]);
+      fMax = std::max (fMax, lanes [1][i]);
+    }
+
+    if (fMin < -epsilon)
+      any_wcg = true;
+
+    if (fMax > 1.0f + epsilon)
+      any_hdr = true;
+  });
+
+  wcg = any_wcg.load ();
+  hdr = any_hdr.load ();
+
+  return S_OK;
+}
+
+#pragma endregion
+
+std::vector <uint8_t>
+SKIV_ICC_ExtractProfile (const uint8_t* data, size_t size)
+{
+  std::vector <uint8_t> profile;
+
+  static constexpr uint8_t png_signature [8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+  if (size > 8 && memcmp (data, png_signature, 8) == 0)
+  {
+    // iCCP precedes the first IDAT
+    for (size_t pos = 8; pos + 12 <= size; )
+    {
+      const size_t   length = SKIV_ICC_ReadU32 (data + pos);
+      const uint32_t type   = SKIV_ICC_ReadU32 (data + pos + 4);
+
+      if (length > size - pos - 12 || type == SKIV_ICC_Sig ("IDAT"))
+        break;
+
+      if (type == SKIV_ICC_Sig ("iCCP"))
+      {
+        const uint8_t* chunk = data + pos + 8;
+        const uint8_t* name_end =
+          static_cast <const uint8_t *> (memchr (chunk, 0, std::min <size_t> (length, 80)));
+
+        // Profile name, then the compression method (0 = zlib)
+        if (name_end != nullptr && name_end + 2 <= chunk + length && name_end [1] == 0)
+        {
+          const int compressed_size =
+            static_cast <int> (chunk + length - (name_end + 2));
+
+          int   decompressed_size = 0;
+          char* decompressed      =
+            stbi_zlib_decode_malloc_guesssize_headerflag (reinterpret_cast <const char *> (name_end + 2), compressed_size,
+                                                          64 * 1024, &decompressed_size, 1);
+
+          if (decompressed != nullptr)
+          {
+            profile.assign (decompressed, decompressed + decompressed_size);
+            stbi_image_free (decompressed);
+          }
+        }
+
+        break;
+      }
+
+      pos += length + 12;
+    }
+  }
+
+  else if (size > 4 && data [0] == 0xFF && data [1] == 0xD8)
+  {
+    // Split across APP2 segments, each numbered 1 to count
+    std::map <uint8_t, std::pair <const uint8_t *, size_t>> chunks;
+    uint8_t                                                 count = 0;
+
+    for (size_t pos = 2; pos + 4 <= size && data [pos] == 0xFF; )
+    {
+      const uint8_t marker = data [pos + 1];
+
+      if (marker == 0xFF) // Fill byte
+      {
+        pos++;
+        continue;
+      }
+
+      if (marker == 0xDA || marker == 0xD9) // Start of scan / end of image
+        break;
+
+      const size_t length =
+        SKIV_ICC_ReadU16 (data + pos + 2);
+
+      if (length < 2 || length > size - pos - 2)
+        break;
+
+      const uint8_t* segment = data + pos + 4;
+
+      if (marker == 0xE2 && length >= 16 && memcmp (segment, "ICC_PROFILE\0", 12) == 0)
+      {
+        count                 = segment [13];
+        chunks [segment [12]] = { segment + 14, length - 16 };
+      }
+
+      pos += 2 + length;
+    }
+
+    for (uint8_t i = 1; i <= count && chunks.contains (i); ++i)
+      profile.insert (profile.end (), chunks [i].first, chunks [i].first + chunks [i].second);
+
+    if (count == 0 || chunks.size () != count)
+      profile.clear ();
+  }
+
+  return profile;
+}
@@ -17,6 +17,8 @@
 #include <utility/utility.h>
 #include "DirectXTex.h"
 #include <utility/DirectXTexEXR.h>
+#include <utility/buffer_pool.h>
+#include <utility/trace.h>
 
 #include <jxl/codestream_header.h>
 #include <jxl/encode.h>
@@ -512,6 +514,8 @@ SKIV_HDR_CalculateContentLightInfo (const DirectX::Image& img)
 {
   using namespace DirectX;
 
+  SKIV_TRACE_SCOPE ("CalculateContentLightInfo");
+
   SK_PNG_HDR_cLLi_Payload clli;
 
   float N          =       0.0f;
@@ -596,7 +600,7 @@ SKIV_HDR_CalculateContentLightInfo (const DirectX::Image& img)
     const float fLumRange =
             (fMaxLum - fMinLum);
 
-    auto        luminance_freq = std::make_unique <uint32_t []> (65536);
+    auto        luminance_freq = SKIV_BufferPool::GetInstance ( ).make_unique <uint32_t> (65536);
     ZeroMemory (luminance_freq.get (),     sizeof (uint32_t)  *  65536);
 
     EvaluateImage ( img,
@@ -647,7 +651,18 @@ SKIV_HDR_CalculateContentLightInfo (const DirectX::Image& img)
   return clli;
 }
 
-static bool
+void
+SKIV_HDR_GetContentLightLevels (const DirectX::Image& img, float& max_cll, float& max_fall)
+{
+  const SK_PNG_HDR_cLLi_Payload clli =
+    SKIV_HDR_CalculateContentLightInfo (img);
+
+  // Stored in units of 0.0001 nits
+  max_cll  = static_cast <float> (SK_PNG_GetUint32 (clli.max_cll))  * 0.0001f;
+  max_fall = static_cast <float> (SK_PNG_GetUint32 (clli.max_fall)) * 0.0001f;
+}
+
+bool
 SKIV_HDR_ConvertImageToPNG (const DirectX::Image& raw_hdr_img, DirectX::ScratchImage& png_img)
 {
   static SKIF_RegistrySettings& _registry =
@@ -1286,6 +1301,7 @@ HRESULT
 SKIV_Image_TonemapToSDR (const DirectX::Image& image, DirectX::ScratchImage& final_sdr, float mastering_max_nits, float mastering_sdr_nits)
 {
   SKIV_ScopedThreadPriority _;
+  SKIV_TRACE_SCOPE ("TonemapToSDR");
 
   DWORD dwStart = SKIF_Util_timeGetTime1 ();
 
@@ -1348,7 +1364,7 @@ SKIV_Image_TonemapToSDR (const DirectX::Image& image, DirectX::ScratchImage& fin
     const float fLumRange =
       XMVectorGetY (maxLum) - XMVectorGetY (minLum);
 
-    auto        luminance_freq = std::make_unique <uint32_t []> (65536);
+    auto        luminance_freq = SKIV_BufferPool::GetInstance ( ).make_unique <uint32_t> (65536);
     ZeroMemory (luminance_freq.get (),     sizeof (uint32_t)  *  65536);
     
     EvaluateImage ( *scrgb.GetImage (0,0,0),
@@ -1556,6 +1572,8 @@ SKIV_Image_SaveToDisk_SDR (const DirectX::Image& image, const wchar_t* wszFileNa
 {
   using namespace DirectX;
 
+  SKIV_TRACE_SCOPE ("SaveToDisk_SDR");
+
   ScratchImage
     scratch_image;
     scratch_image.InitializeFromImage (image);
@@ -1602,6 +1620,7 @@ SKIV_Image_SaveToDisk_SDR (const DirectX::Image& image, const wchar_t* wszFileNa
 
   bool bPrefer10bpcAs48bpp = false;
   bool bPrefer10bpcAs32bpp = false;
+  bool bSaveAsDDS          = false;
 
   GUID      wic_codec;
   WIC_FLAGS wic_flags = WIC_FLAGS_DITHER_DIFFUSION | (force_sRGB ? WIC_FLAGS_FORCE_SRGB : WIC_FLAGS_NONE);
@@ -1743,6 +1762,12 @@ SKIV_Image_SaveToDisk_SDR (const DirectX::Image& image, const wchar_t* wszFileNa
     bPrefer10bpcAs32bpp = is_hdr;
   }
 
+  // Not a WIC codec; encoded as BC7 after tonemapping
+  else if (StrStrIW (wszExtension, L"dds"))
+  {
+    bSaveAsDDS = true;
+  }
+
   // AVIF technically works for SDR... do we want to support it?
   //  If we do, WIC won't help us, however.
 
@@ -1788,7 +1813,7 @@ SKIV_Image_SaveToDisk_SDR (const DirectX::Image& image, const wchar_t* wszFileNa
 
     minLum = XMVectorMax (g_XMZero, minLum);
 
-    auto        luminance_freq = std::make_unique <uint32_t []> (65536);
+    auto        luminance_freq = SKIV_BufferPool::GetInstance ( ).make_unique <uint32_t> (65536);
     ZeroMemory (luminance_freq.get (),     sizeof (uint32_t)  *  65536);
 
     const float fLumRange =
@@ -2005,6 +2030,16 @@ SKIV_Image_SaveToDisk_SDR (const DirectX::Image& image, const wchar_t* wszFileNa
   ///  pQueryReader = pMQR;
   ///});
 
+  if (bSaveAsDDS)
+  {
+    SKIF_RegistrySettings& _registry =
+      SKIF_RegistrySettings::GetInstance ();
+
+    return
+      SKIV_Image_SaveToDDS (*pOutputImage, wszImplicitFileName, static_cast <SKIV_BCQuality> (_registry.dds.quality),
+                                                                                              _registry.dds.mipmaps);
+  }
+
   return
     DirectX::SaveToWICFile (*pOutputImage, wic_flags, wic_codec,
                       wszImplicitFileName, bPrefer10bpcAs48bpp ? &GUID_WICPixelFormat48bppRGB       :
@@ -2406,6 +2441,8 @@ SKIV_Image_LoadUltraHDR (DirectX::ScratchImage& image, void* data, int size)
 HRESULT
 SKIV_Image_SaveToDisk_HDR (const DirectX::Image& image, const wchar_t* wszFileName)
 {
+  SKIV_TRACE_SCOPE ("SaveToDisk_HDR");
+
   SKIF_RegistrySettings& _registry =
     SKIF_RegistrySettings::GetInstance ();
 
@@ -2461,7 +2498,8 @@ SKIV_Image_SaveToDisk_HDR (const DirectX::Image& image, const wchar_t* wszFileNa
   {
     using namespace DirectX;
 
-    if (SUCCEEDED (SaveToHDRFile (image, wszImplicitFileName)))
+    if (SUCCEEDED (SKIV_Image_SaveRadianceToFile (image, wszImplicitFileName)) ||
+        SUCCEEDED (SaveToHDRFile                 (image, wszImplicitFileName)))
     {
       return S_OK;
     }
@@ -2479,6 +2517,15 @@ SKIV_Image_SaveToDisk_HDR (const DirectX::Image& image, const wchar_t* wszFileNa
     }
   }
 
+  else if (StrStrIW (wszExtension, L"dds"))
+  {
+    if (SUCCEEDED (SKIV_Image_SaveToDDS (image, wszImplicitFileName, static_cast <SKIV_BCQuality> (_registry.dds.quality),
+                                                                                                  _registry.dds.mipmaps)))
+    {
+      return S_OK;
+    }
+  }
+
   else if (StrStrIW (wszExtension, L"jxl"))
   {
     extern bool isJXLDecoderAvailable (void);
@@ -2567,27 +2614,61 @@ SKIV_Image_SaveToDisk_HDR (const DirectX::Image& image, const wchar_t* wszFileNa
       JxlDataType type = JXL_TYPE_FLOAT;
       size_t      size = sizeof (float);
 
-      std::vector <float> fp_pixels (image.width * image.height * 3);
+      const size_t fp_pixels_count = image.width * image.height * 3;
 
-      auto fp_pixel_comp =
-        fp_pixels.begin ();
+      auto fp_pixels =
+        SKIV_BufferPool::GetInstance ( ).make_unique <float> (fp_pixels_count);
 
-      EvaluateImage ( image,
-        [&](const XMVECTOR* pixels, size_t width, size_t y)
+      // Plain float layouts are unpacked row-by-row without a trip through XMVECTOR
+      if (image.format == DXGI_FORMAT_R16G16B16A16_FLOAT ||
+          image.format == DXGI_FORMAT_R32G32B32A32_FLOAT)
+      {
+        std::vector <float> fp_row (image.width * 4);
+
+        for (size_t y = 0; y < image.height; ++y)
         {
-          UNREFERENCED_PARAMETER(y);
+          const uint8_t* row =
+            image.pixels + y * image.rowPitch;
 
-          for (size_t j = 0; j < width; ++j)
-          {
-            XMVECTOR v =
-              *pixels++;
+          if (image.format == DXGI_FORMAT_R16G16B16A16_FLOAT)
+            SKIV_Image_UnpackFP16toFP32 (reinterpret_cast <const uint16_t *> (row), fp_row.data (), fp_row.size ());
+          else
+            memcpy (fp_row.data (), row, fp_row.size () * sizeof (float));
 
-            *fp_pixel_comp++ = XMVectorGetX (v);
-            *fp_pixel_comp++ = XMVectorGetY (v);
-            *fp_pixel_comp++ = XMVectorGetZ (v);
+          float* fp_pixel_comp =
+            &fp_pixels [y * image.width * 3];
+
+          for (size_t j = 0; j < image.width; ++j)
+          {
+            *fp_pixel_comp++ = fp_row [j * 4 + 0];
+            *fp_pixel_comp++ = fp_row [j * 4 + 1];
+            *fp_pixel_comp++ = fp_row [j * 4 + 2];
           }
         }
-      );
+      }
+
+      else
+      {
+        float* fp_pixel_comp =
+          fp_pixels.get ();
+
+        EvaluateImage ( image,
+          [&](const XMVECTOR* pixels, size_t width, size_t y)
+          {
+            UNREFERENCED_PARAMETER(y);
+
+            for (size_t j = 0; j < width; ++j)
+            {
+              XMVECTOR v =
+                *pixels++;
+
+              *fp_pixel_comp++ = XMVectorGetX (v);
+              *fp_pixel_comp++ = XMVectorGetY (v);
+              *fp_pixel_comp++ = XMVectorGetZ (v);
+            }
+          }
+        );
+      }
 
       JxlPixelFormat pixel_format =
         { 3, type, JXL_NATIVE_ENDIAN, 0 };
@@ -2634,8 +2715,8 @@ SKIV_Image_SaveToDisk_HDR (const DirectX::Image& image, const wchar_t* wszFileNa
 
       if ( JXL_ENC_SUCCESS !=
              jxlEncoderAddImageFrame ( frame_settings, &pixel_format,
-               static_cast <const void *> (fp_pixels.data ()),
-                                    size * fp_pixels.size () ) )
+               static_cast <const void *> (fp_pixels.get ()),
+                                    size * fp_pixels_count ) )
       {
         PLOG_ERROR << "JxlEncoderAddImageFrame failed";
         break;
@@ -2650,6 +2731,8 @@ SKIV_Image_SaveToDisk_HDR (const DirectX::Image& image, const wchar_t* wszFileNa
 
       JxlEncoderStatus process_result = JXL_ENC_NEED_MORE_OUTPUT;
 
+      SKIV_TraceScope trace_encode ("Encode (JPEG XL)");
+
       while (process_result == JXL_ENC_NEED_MORE_OUTPUT)
       {
         process_result =
@@ -2668,6 +2751,8 @@ SKIV_Image_SaveToDisk_HDR (const DirectX::Image& image, const wchar_t* wszFileNa
 
       output.resize (next_out - output.data ());
 
+      trace_encode.End ( );
+
       if (JXL_ENC_SUCCESS != process_result)
       {
         PLOG_ERROR << "JxlEncoderProcessOutput failed";
@@ -2679,6 +2764,8 @@ SKIV_Image_SaveToDisk_HDR (const DirectX::Image& image, const wchar_t* wszFileNa
 
       if (fOutput != nullptr)
       {
+        SKIV_TRACE_SCOPE ("WriteFile");
+
         fwrite (output.data (), output.size (), 1, fOutput);
         fclose (fOutput);
 
@@ -2752,6 +2839,8 @@ SKIV_Image_SaveToDisk_HDR (const DirectX::Image& image, const wchar_t* wszFileNa
     
     avifRWData   avifOutput = AVIF_DATA_EMPTY;
     avifRGBImage rgb        = { };
+    SKIV_BufferPool::unique_ptr <uint8_t>
+                 rgb_pixels;
     avifEncoder* encoder    = nullptr;
     avifImage*   avif_image =
       SK_avifImageCreate (width, height, bit_depth, yuv_format);
@@ -2780,7 +2869,11 @@ SKIV_Image_SaveToDisk_HDR (const DirectX::Image& image, const wchar_t* wszFileNa
       rgb.isFloat     = false;
       rgb.format      = AVIF_RGB_FORMAT_RGB;
     
-      SK_avifRGBImageAllocatePixels (&rgb);
+      // Pooled instead of avifRGBImageAllocatePixels ( ), same tightly packed layout
+      rgb.rowBytes = rgb.width * 3 * (rgb.depth > 8 ? sizeof (uint16_t) : sizeof (uint8_t));
+      rgb_pixels   =
+        SKIV_BufferPool::GetInstance ( ).make_unique <uint8_t> (static_cast <size_t> (rgb.rowBytes) * rgb.height);
+      rgb.pixels   = rgb_pixels.get ();
     
       switch (image.format)
       {
@@ -2892,7 +2985,7 @@ SKIV_Image_SaveToDisk_HDR (const DirectX::Image& image, const wchar_t* wszFileNa
             const float fLumRange =
                     (fMaxLum - fMinLum);
 
-            auto        luminance_freq = std::make_unique <uint32_t []> (65536);
+            auto        luminance_freq = SKIV_BufferPool::GetInstance ( ).make_unique <uint32_t> (65536);
             ZeroMemory (luminance_freq.get (),     sizeof (uint32_t)  *  65536);
 
             EvaluateImage ( image,
@@ -3020,6 +3113,8 @@ SKIV_Image_SaveToDisk_HDR (const DirectX::Image& image, const wchar_t* wszFileNa
         encoder->codecChoice     = AVIF_CODEC_CHOICE_AUTO;
         encoder->speed           = _registry.avif.speed;
     
+        SKIV_TRACE_SCOPE ("Encode (AVIF)");
+
         addResult    = SK_avifEncoderAddImage (encoder, avif_image, 1, AVIF_ADD_IMAGE_FLAG_SINGLE);
         encodeResult = SK_avifEncoderFinish   (encoder, &avifOutput);
       }
@@ -3039,6 +3134,8 @@ SKIV_Image_SaveToDisk_HDR (const DirectX::Image& image, const wchar_t* wszFileNa
     
       if (fAVIF != nullptr)
       {
+        SKIV_TRACE_SCOPE ("WriteFile");
+
         fwrite (avifOutput.data, 1, avifOutput.size, fAVIF);
         fclose (fAVIF);
       }
@@ -3047,8 +3144,6 @@ SKIV_Image_SaveToDisk_HDR (const DirectX::Image& image, const wchar_t* wszFileNa
     if (avif_image != nullptr) SK_avifImageDestroy   (avif_image);
     if (encoder    != nullptr) SK_avifEncoderDestroy (encoder);
     
-    SK_avifRGBImageFreePixels (&rgb);
-    
     return
       ( encodeResult == AVIF_RESULT_OK ) ? S_OK : E_FAIL;
   }
@@ -3361,46 +3456,46 @@ SKIV_Image_CaptureRegion (ImRect capture_area)
 
   _AdjustCaptureAreaRelativeToDisplayOrigin ();
 
-  if (SKIV_DesktopImage._rotation == DXGI_MODE_ROTATION_ROTATE90 ||
-      SKIV_DesktopImage._rotation == DXGI_MODE_ROTATION_ROTATE270)
+  // The desktop texture is stored unrotated; map the presented rectangle into
+  //   texture space, the kernel below rotates the pixels back upright.
+  const float W  = static_cast <float> (minfo.rcMonitor.right  - minfo.rcMonitor.left),
+              H  = static_cast <float> (minfo.rcMonitor.bottom - minfo.rcMonitor.top);
+  const float x0 = capture_area.Min.x, x1 = capture_area.Max.x,
+              y0 = capture_area.Min.y, y1 = capture_area.Max.y;
+
+  switch (SKIV_DesktopImage._rotation)
   {
-    const float height =
-      static_cast <float> (minfo.rcMonitor.right  - minfo.rcMonitor.left),
-                width  =
-      static_cast <float> (minfo.rcMonitor.bottom - minfo.rcMonitor.top);
+    case DXGI_MODE_ROTATION_ROTATE90:
+      capture_area = ImRect (y0,     W - x1, y1,     W - x0);
+      break;
+    case DXGI_MODE_ROTATION_ROTATE180:
+      capture_area = ImRect (W - x1, H - y1, W - x0, H - y0);
+      break;
+    case DXGI_MODE_ROTATION_ROTATE270:
+      capture_area = ImRect (H - y1, x0,     H - y0, x1);
+      break;
+    default:
+      break;
+  }
 
-    std::swap (capture_area.Min.x, capture_area.Min.y);
-    std::swap (capture_area.Max.x, capture_area.Max.y);
+  const float tex_width  = SKIV_DesktopImage._resolution.x,
+              tex_height = SKIV_DesktopImage._resolution.y;
 
-    const float capture_height =
-      static_cast <float> (capture_area.Max.y - capture_area.Min.y),
-                capture_width  =
-      static_cast <float> (capture_area.Max.x - capture_area.Min.x);
+  const UINT
+    left   = static_cast <UINT> (std::clamp (capture_area.Min.x, 0.0f, tex_width)),
+    top    = static_cast <UINT> (std::clamp (capture_area.Min.y, 0.0f, tex_height)),
+    right  = static_cast <UINT> (std::clamp (capture_area.Max.x, 0.0f, tex_width)),
+    bottom = static_cast <UINT> (std::clamp (capture_area.Max.y, 0.0f, tex_height));
 
-    if (SKIV_DesktopImage._rotation == DXGI_MODE_ROTATION_ROTATE90)
-    {
-      capture_area.Min.y = height - capture_area.Max.y;
-      capture_area.Max.y = height - capture_area.Max.y + capture_height;
-    }
+  CComQIPtr <ID3D11Texture2D>
+      pDesktopTex (SKIV_DesktopImage._res);
 
-    else
-    {
-      std::ignore = capture_width;
-      std::ignore = width;
-      //capture_area.Min.x = width - capture_width;
-      //capture_area.Max.x = width;
-    }
+  if (pDesktopTex == nullptr || right <= left || bottom <= top)
+  {
+    PLOG_WARNING << "SKIV_Image_CaptureRegion   ( ): Empty capture area";
+    return;
   }
 
-  const size_t
-    x      = static_cast <size_t> (std::max (0.0f, capture_area.Min.x)),
-    y      = static_cast <size_t> (std::max (0.0f, capture_area.Min.y)),
-    width  = static_cast <size_t> (std::max (0.0f, capture_area.GetWidth  ())),
-    height = static_cast <size_t> (std::max (0.0f, capture_area.GetHeight ()));
-
-  const DirectX::Rect
-    src_rect (x,y, width,height);
-
   extern CComPtr <ID3D11Device>
     SKIF_D3D11_GetDevice (bool bWait);
 
@@ -3409,83 +3504,92 @@ SKIV_Image_CaptureRegion (ImRect capture_area)
   CComPtr <ID3D11DeviceContext>  pDevCtx;
   pDevice->GetImmediateContext (&pDevCtx.p);
 
-  DirectX::ScratchImage captured_img;
-  if (SUCCEEDED (DirectX::CaptureTexture (pDevice, pDevCtx, SKIV_DesktopImage._res, captured_img)))
+  // Only the selected rectangle is read back, not the whole desktop
+  D3D11_TEXTURE2D_DESC   texDesc = { };
+  pDesktopTex->GetDesc (&texDesc);
+
+  texDesc.Width          = right  - left;
+  texDesc.Height         = bottom - top;
+  texDesc.MipLevels      = 1;
+  texDesc.ArraySize      = 1;
+  texDesc.SampleDesc     = { 1, 0 };
+  texDesc.Usage          = D3D11_USAGE_STAGING;
+  texDesc.BindFlags      = 0;
+  texDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+  texDesc.MiscFlags      = 0;
+
+  CComPtr <ID3D11Texture2D> pStaging;
+
+  if (FAILED (pDevice->CreateTexture2D (&texDesc, nullptr, &pStaging.p)))
   {
-    PLOG_VERBOSE << "DirectX::CaptureTexture    ( ): SUCCEEDED";
-    DirectX::ScratchImage subrect;
+    PLOG_WARNING << "CreateTexture2D            ( ): FAILED";
+    return;
+  }
 
-    if (SUCCEEDED (subrect.Initialize2D   ( captured_img.GetMetadata ().format, width, height, 1, 1)))
-    {
-      PLOG_VERBOSE << "subrect.Initialize2D       ( ): SUCCEEDED";
+  const D3D11_BOX box = { left, top, 0, right, bottom, 1 };
 
-      if (SUCCEEDED (DirectX::CopyRectangle (*captured_img.GetImages (), src_rect,
-                                                  *subrect.GetImages (), DirectX::TEX_FILTER_DEFAULT, 0, 0)))
-      {
-        PLOG_VERBOSE << "DirectX::CopyRectangle     ( ): SUCCEEDED";
+  pDevCtx->CopySubresourceRegion (pStaging, 0, 0, 0, 0, SKIV_DesktopImage._res, 0, &box);
 
-        DirectX::ScratchImage rotated;
-        const DirectX::Image* final = subrect.GetImages ();
+  D3D11_MAPPED_SUBRESOURCE mapped = { };
 
-        if (SKIV_DesktopImage._rotation > DXGI_MODE_ROTATION_IDENTITY)
-        {
-          DirectX::TEX_FR_FLAGS rotate_flags = DirectX::TEX_FR_ROTATE0;
+  if (FAILED (pDevCtx->Map (pStaging, 0, D3D11_MAP_READ, 0, &mapped)))
+  {
+    PLOG_WARNING << "ID3D11DeviceContext::Map   ( ): FAILED";
+    return;
+  }
 
-          switch (SKIV_DesktopImage._rotation)
-          {
-            case DXGI_MODE_ROTATION_ROTATE90:
-              rotate_flags = DirectX::TEX_FR_ROTATE90;
-              break;
+  DirectX::Image region = { };
+  region.width      = texDesc.Width;
+  region.height     = texDesc.Height;
+  region.format     = texDesc.Format;
+  region.rowPitch   = mapped.RowPitch;
+  region.slicePitch = static_cast <size_t> (mapped.RowPitch) * texDesc.Height;
+  region.pixels     = static_cast <uint8_t *> (mapped.pData);
 
-            case DXGI_MODE_ROTATION_ROTATE180:
-              rotate_flags = DirectX::TEX_FR_ROTATE180;
-              break;
+  // SDR desktops go straight to the format the clipboard wants
+  const DXGI_FORMAT format =
+    (texDesc.Format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB) ? DXGI_FORMAT_B8G8R8X8_UNORM_SRGB
+                                                        : texDesc.Format;
 
-            case DXGI_MODE_ROTATION_ROTATE270:
-              rotate_flags = DirectX::TEX_FR_ROTATE270;
-              break;
-          }
+  DirectX::ScratchImage snipped;
 
-          if (SUCCEEDED (DirectX::FlipRotate (*subrect.GetImages (), DirectX::TEX_FR_ROTATE90, rotated)))
-          {
-            PLOG_VERBOSE << "DirectX::FlipRotate        ( ): SUCCEEDED";
+  HRESULT hr =
+    SKIV_Image_CropRotate (region, DirectX::Rect (0, 0, region.width, region.height), SKIV_DesktopImage._rotation, format, snipped);
 
-            final = rotated.GetImages ();
-          } else
-            PLOG_VERBOSE << "DirectX::FlipRotate        ( ): FAILED";
-        }
+  pDevCtx->Unmap (pStaging, 0);
 
-        if (SKIV_Image_CopyToClipboard (final, true, SKIV_DesktopImage._hdr_image))
-        {
-          PLOG_VERBOSE << "SKIV_Image_CopyToClipboard ( ): SUCCEEDED";
+  if (FAILED (hr))
+  {
+    PLOG_WARNING << "SKIV_Image_CropRotate      ( ): FAILED, HRESULT=" << hr;
+    return;
+  }
 
-          ImGui::InsertNotification (
-            {
-              ImGuiToastType::Info,
-              3000,
-              "Copied image to clipboard", ""
-            }
-          );
-        }
+  PLOG_VERBOSE << "SKIV_Image_CropRotate      ( ): SUCCEEDED";
 
-        else {
-          ImGui::InsertNotification (
-            {
-              ImGuiToastType::Error,
-              3000,
-              "Failed to copy image to clipboard", ""
-            }
-          );
-          PLOG_WARNING << "SKIV_Image_CopyToClipboard ( ): FAILED";
-        }
-      } else
-        PLOG_WARNING << "DirectX::CopyRectangle     ( ): FAILED";
-    } else
-      PLOG_WARNING << "subrect.Initialize2D       ( ): FAILED";
-  } else
-    PLOG_WARNING << "DirectX::CaptureTexture    ( ): FAILED";
-}
+  if (SKIV_Image_CopyToClipboard (snipped.GetImages (), true, SKIV_DesktopImage._hdr_image))
+  {
+    PLOG_VERBOSE << "SKIV_Image_CopyToClipboard ( ): SUCCEEDED";
+
+    ImGui::InsertNotification (
+      {
+        ImGuiToastType::Info,
+        3000,
+        "Copied image to clipboard", ""
+      }
+    );
+  }
 
+  else {
+    ImGui::InsertNotification (
+      {
+        ImGuiToastType::Error,
+        3000,
+        "Failed to copy image to clipboard", ""
+      }
+    );
+    PLOG_WARNING << "SKIV_Image_CopyToClipboard ( ): FAILED";
+  }
+}
 
 bool
 isAVIFEncoderAvailable (void)
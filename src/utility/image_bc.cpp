@@ -0,0 +1,1935 @@
+#include "utility/image.h"
+#include "utility/trace.h"
+#include "utility/utility.h"
+#include <plog/Log.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include <immintrin.h>
+#include <ppl.h>
+
+// Block-compressed (BC1 - BC7) texture decoding, and BC6H / BC7 encoding
+//
+//   DirectX::Decompress decodes every block into XMVECTORs and converts them
+//     back to the target format one scanline at a time on a single thread;
+//       these decoders write each 4x4 block straight into the output format,
+//         one row of blocks per task, and produce the same bytes (BC6H the
+//           same halves) as DirectXTex does.
+//
+//   Every block picks its own mode, partition and index precision, so the work
+//     is branchy and per-block rather than lane-parallel; throughput comes from
+//       spreading the block rows across all cores.
+//
+//   The encoders rank the partitions of a block by the error of the best line
+//     through each subset (AVX2 moments over all 16 pixels at once) and only
+//       fit, quantize and refine endpoints for the few that rank highest.
+
+#pragma region Helpers
+
+// Little-endian bit stream over a single 128-bit block
+struct skiv_bc_bits_s {
+  uint64_t lo  = 0;
+  uint64_t hi  = 0;
+  uint32_t pos = 0;
+
+  explicit skiv_bc_bits_s (const uint8_t* block)
+  {
+    memcpy (&lo, block,     8);
+    memcpy (&hi, block + 8, 8);
+  }
+
+  uint32_t Read (uint32_t count)
+  {
+    uint64_t value;
+
+    if      (pos >= 64)         value =  hi >> (pos - 64);
+    else if (pos + count <= 64) value =  lo >>  pos;
+    else                        value = (lo >>  pos) | (hi << (64 - pos));
+
+    pos += count;
+
+    return static_cast <uint32_t> (value) & ((1U << count) - 1);
+  }
+};
+
+// Interpolation weights (out of 64) shared by BC6H and BC7
+static constexpr uint8_t skiv_bc_weights2 [ 4] = { 0, 21, 43, 64 };
+static constexpr uint8_t skiv_bc_weights3 [ 8] = { 0,  9, 18, 27, 37, 46, 55, 64 };
+static constexpr uint8_t skiv_bc_weights4 [16] = { 0,  4,  9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+static const uint8_t*
+SKIV_BC_GetWeights (uint32_t index_bits)
+{
+  return (index_bits == 2) ? skiv_bc_weights2 :
+         (index_bits == 3) ? skiv_bc_weights3 : skiv_bc_weights4;
+}
+
+// Subset of every pixel in the two-subset partitions (one bit per pixel)
+static constexpr uint16_t skiv_bc_partitions2 [64] = {
+  0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+  0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+  0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+  0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+  0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+  0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+  0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+  0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22
+};
+
+// Subset of every pixel in the three-subset partitions (two bits per pixel)
+static constexpr uint32_t skiv_bc_partitions3 [64] = {
+  0xAA685050, 0x6A5A5040, 0x5A5A4200, 0x5450A0A8, 0xA5A50000, 0xA0A05050, 0x5555A0A0, 0x5A5A5050,
+  0xAA550000, 0xAA555500, 0xAAAA5500, 0x90909090, 0x94949494, 0xA4A4A4A4, 0xA9A59450, 0x2A0A4250,
+  0xA5945040, 0x0A425054, 0xA5A5A500, 0x55A0A0A0, 0xA8A85454, 0x6A6A4040, 0xA4A45000, 0x1A1A0500,
+  0x0050A4A4, 0xAAA59090, 0x14696914, 0x69691400, 0xA08585A0, 0xAA821414, 0x50A4A450, 0x6A5A0200,
+  0xA9A58000, 0x5090A0A8, 0xA8A09050, 0x24242424, 0x00AA5500, 0x24924924, 0x24499224, 0x50A50A50,
+  0x500AA550, 0xAAAA4444, 0x66660000, 0xA5A0A5A0, 0x50A050A0, 0x69286928, 0x44AAAA44, 0x66666600,
+  0xAA444444, 0x54A854A8, 0x95809580, 0x96969600, 0xA85454A8, 0x80959580, 0xAA141414, 0x96960000,
+  0xAAAA1414, 0xA05050A0, 0xA0A5A5A0, 0x96000000, 0x40804080, 0xA9A8A9A8, 0xAAAAAA44, 0x2A4A5254
+};
+
+// Anchor pixels (whose index omits its most significant bit) of the second
+//   and third subsets; the first subset is always anchored at pixel 0.
+static constexpr uint8_t skiv_bc_anchors2 [64] = {
+  15,15,15,15,15,15,15,15, 15,15,15,15,15,15,15,15,
+  15, 2, 8, 2, 2, 8, 8,15,  2, 8, 2, 2, 8, 8, 2, 2,
+  15,15, 6, 8, 2, 8,15,15,  2, 8, 2, 2, 2,15,15, 6,
+   6, 2, 6, 8,15,15, 2, 2, 15,15,15,15,15, 2, 2,15
+};
+
+static constexpr uint8_t skiv_bc_anchors3_second [64] = {
+   3, 3,15,15, 8, 3,15,15,  8, 8, 6, 6, 6, 5, 3, 3,
+   3, 3, 8,15, 3, 3, 6,10,  5, 8, 8, 6, 8, 5,15,15,
+   8,15, 3, 5, 6,10, 8,15, 15, 3,15, 5,15,15,15,15,
+   3,15, 5, 5, 5, 8, 5,10,  5,10, 8,13,15,12, 3, 3
+};
+
+static constexpr uint8_t skiv_bc_anchors3_third [64] = {
+  15, 8, 8, 3,15,15, 3, 8, 15,15,15,15,15,15,15, 8,
+  15, 8,15, 3,15, 8,15, 8,  3,15, 6,10,15,15,10, 8,
+  15, 3,15,10,10, 8, 9,10,  6,15, 8,15, 3, 6, 6, 8,
+  15, 3,15,15,15,15,15,15, 15,15,15,15, 3,15,15, 8
+};
+
+static __forceinline uint32_t
+SKIV_BC_Interpolate (uint32_t e0, uint32_t e1, uint32_t weight)
+{
+  return ((64 - weight) * e0 + weight * e1 + 32) >> 6;
+}
+
+static __forceinline int32_t
+SKIV_BC_SignExtend (int32_t value, uint32_t bits)
+{
+  return static_cast <int32_t> (static_cast <uint32_t> (value) << (32 - bits)) >> (32 - bits);
+}
+
+#pragma endregion
+
+#pragma region BC1 - BC5
+
+// BC1 (and the colour half of BC2 / BC3) into RGBA8; the three-colour mode with
+//   transparent black only exists in BC1, BC2 and BC3 always interpolate four.
+//     The palette is built in float and rounded the way DirectXTex does it, so
+//       that the endpoints and 1/3, 2/3 and 1/2 steps come out the same.
+static void
+SKIV_BC_DecodeColor (const uint8_t* block, uint8_t* rgba, bool allow_transparent)
+{
+  const uint32_t c0 = block [0] | (block [1] << 8);
+  const uint32_t c1 = block [2] | (block [3] << 8);
+
+  uint32_t indices;
+  memcpy (&indices, block + 4, 4);
+
+  float   endpoints [2][3];
+  uint8_t palette   [4][4];
+
+  auto _Expand565 = [](uint32_t c, float* out)
+  {
+    out [0] = static_cast <float> ((c >> 11) & 0x1F) * (1.0f / 31.0f);
+    out [1] = static_cast <float> ((c >>  5) & 0x3F) * (1.0f / 63.0f);
+    out [2] = static_cast <float> ( c        & 0x1F) * (1.0f / 31.0f);
+  };
+
+  // Rounds to nearest even, like the conversion XMStoreUByteN4 uses
+  auto _Store = [](const float* color, uint8_t* out)
+  {
+    for (int c = 0; c < 3; ++c)
+      out [c] = static_cast <uint8_t> (std::nearbyint (color [c] * 255.0f));
+
+    out [3] = 255;
+  };
+
+  auto _Lerp = [&](float t, uint8_t* out)
+  {
+    float color [3];
+
+    for (int c = 0; c < 3; ++c)
+      color [c] = endpoints [0][c] + (endpoints [1][c] - endpoints [0][c]) * t;
+
+    _Store (color, out);
+  };
+
+  _Expand565 (c0, endpoints [0]);
+  _Expand565 (c1, endpoints [1]);
+
+  _Store (endpoints [0], palette [0]);
+  _Store (endpoints [1], palette [1]);
+
+  if (c0 > c1 || ! allow_transparent)
+  {
+    _Lerp (1.0f / 3.0f, palette [2]);
+    _Lerp (2.0f / 3.0f, palette [3]);
+  }
+
+  else
+  {
+    _Lerp (0.5f, palette [2]);
+    memset (palette [3], 0, 4);
+  }
+
+  for (uint32_t i = 0; i < 16; ++i)
+    memcpy (rgba + i * 4, palette [(indices >> (i * 2)) & 0x3], 4);
+}
+
+// BC2 alpha, 4 bits per pixel
+static void
+SKIV_BC_DecodeExplicitAlpha (const uint8_t* block, uint8_t* channel)
+{
+  uint64_t bits;
+  memcpy (&bits, block, 8);
+
+  for (uint32_t i = 0; i < 16; ++i)
+    channel [i * 4] = static_cast <uint8_t> (((bits >> (i * 4)) & 0xF) * 17);
+}
+
+// BC3 alpha and BC4 / BC5 channels: two endpoints and 3-bit indices
+static void
+SKIV_BC_DecodeChannel (const uint8_t* block, uint8_t* channel)
+{
+  const uint32_t a0 = block [0];
+  const uint32_t a1 = block [1];
+
+  uint64_t bits = 0;
+  memcpy (&bits, block + 2, 6);
+
+  uint8_t palette [8] = { static_cast <uint8_t> (a0), static_cast <uint8_t> (a1) };
+
+  if (a0 > a1)
+  {
+    for (uint32_t i = 1; i < 7; ++i)
+      palette [i + 1] = static_cast <uint8_t> (((7 - i) * a0 + i * a1 + 3) / 7);
+  }
+
+  else
+  {
+    for (uint32_t i = 1; i < 5; ++i)
+      palette [i + 1] = static_cast <uint8_t> (((5 - i) * a0 + i * a1 + 2) / 5);
+
+    palette [6] = 0;
+    palette [7] = 255;
+  }
+
+  for (uint32_t i = 0; i < 16; ++i)
+    channel [i * 4] = palette [(bits >> (i * 3)) & 0x7];
+}
+
+// BC4 / BC5 SNORM; -128 is an alias of -127 so that both ends are symmetric,
+//   but the mode is still picked by comparing the endpoints as stored
+static void
+SKIV_BC_DecodeChannelSigned (const uint8_t* block, int8_t* channel)
+{
+  const int8_t  r0 = static_cast <int8_t> (block [0]);
+  const int8_t  r1 = static_cast <int8_t> (block [1]);
+  const int32_t a0 = std::max <int32_t> (-127, r0);
+  const int32_t a1 = std::max <int32_t> (-127, r1);
+
+  uint64_t bits = 0;
+  memcpy (&bits, block + 2, 6);
+
+  auto _Divide = [](int32_t value, int32_t divisor) -> int8_t
+  {
+    return static_cast <int8_t> ((value + (value < 0 ? -divisor : divisor) / 2) / divisor);
+  };
+
+  int8_t palette [8] = { static_cast <int8_t> (a0), static_cast <int8_t> (a1) };
+
+  if (r0 > r1)
+  {
+    for (int32_t i = 1; i < 7; ++i)
+      palette [i + 1] = _Divide ((7 - i) * a0 + i * a1, 7);
+  }
+
+  else
+  {
+    for (int32_t i = 1; i < 5; ++i)
+      palette [i + 1] = _Divide ((5 - i) * a0 + i * a1, 5);
+
+    palette [6] = -127;
+    palette [7] =  127;
+  }
+
+  for (uint32_t i = 0; i < 16; ++i)
+    channel [i * 4] = palette [(bits >> (i * 3)) & 0x7];
+}
+
+#pragma endregion
+
+#pragma region BC6H
+
+// One run of consecutive bits in a BC6H header; bits [first_bit] .. [last_bit]
+//   of a component are stored in stream order, which is reversed (most
+//     significant bit first) in a few fields of the single-region modes.
+struct skiv_bc6h_field_s {
+  char    channel;  // 'r', 'g' or 'b'
+  uint8_t endpoint; // w, x, y, z = 0, 1, 2, 3
+  uint8_t last_bit;
+  uint8_t first_bit;
+};
+
+struct skiv_bc6h_mode_s {
+  uint8_t           regions;
+  bool              transformed;     // Endpoints other than the first are deltas
+  uint8_t           endpoint_bits;
+  uint8_t           delta_bits [3];
+  uint8_t           field_count;
+  skiv_bc6h_field_s fields     [24];
+};
+
+static constexpr skiv_bc6h_mode_s skiv_bc6h_modes [14] = {
+  { 2, true, 10, { 5, 5, 5 }, 19, {
+    {'g',2,4,4},{'b',2,4,4},{'b',3,4,4},{'r',0,9,0},{'g',0,9,0},{'b',0,9,0},{'r',1,4,0},{'g',3,4,4},{'g',2,3,0},{'g',1,4,0},
+    {'b',3,0,0},{'g',3,3,0},{'b',1,4,0},{'b',3,1,1},{'b',2,3,0},{'r',2,4,0},{'b',3,2,2},{'r',3,4,0},{'b',3,3,3} } },
+  { 2, true,  7, { 6, 6, 6 }, 23, {
+    {'g',2,5,5},{'g',3,4,4},{'g',3,5,5},{'r',0,6,0},{'b',3,0,0},{'b',3,1,1},{'b',2,4,4},{'g',0,6,0},{'b',2,5,5},{'b',3,2,2},
+    {'g',2,4,4},{'b',0,6,0},{'b',3,3,3},{'b',3,5,5},{'b',3,4,4},{'r',1,5,0},{'g',2,3,0},{'g',1,5,0},{'g',3,3,0},{'b',1,5,0},
+    {'b',2,3,0},{'r',2,5,0},{'r',3,5,0} } },
+  { 2, true, 11, { 5, 4, 4 }, 18, {
+    {'r',0,9,0},{'g',0,9,0},{'b',0,9,0},{'r',1,4,0},{'r',0,10,10},{'g',2,3,0},{'g',1,3,0},{'g',0,10,10},{'b',3,0,0},{'g',3,3,0},
+    {'b',1,3,0},{'b',0,10,10},{'b',3,1,1},{'b',2,3,0},{'r',2,4,0},{'b',3,2,2},{'r',3,4,0},{'b',3,3,3} } },
+  { 2, true, 11, { 4, 5, 4 }, 20, {
+    {'r',0,9,0},{'g',0,9,0},{'b',0,9,0},{'r',1,3,0},{'r',0,10,10},{'g',3,4,4},{'g',2,3,0},{'g',1,4,0},{'g',0,10,10},{'g',3,3,0},
+    {'b',1,3,0},{'b',0,10,10},{'b',3,1,1},{'b',2,3,0},{'r',2,3,0},{'b',3,0,0},{'b',3,2,2},{'r',3,3,0},{'g',2,4,4},{'b',3,3,3} } },
+  { 2, true, 11, { 4, 4, 5 }, 20, {
+    {'r',0,9,0},{'g',0,9,0},{'b',0,9,0},{'r',1,3,0},{'r',0,10,10},{'b',2,4,4},{'g',2,3,0},{'g',1,3,0},{'g',0,10,10},{'b',3,0,0},
+    {'g',3,3,0},{'b',1,4,0},{'b',0,10,10},{'b',2,3,0},{'r',2,3,0},{'b',3,1,1},{'b',3,2,2},{'r',3,3,0},{'b',3,4,4},{'b',3,3,3} } },
+  { 2, true,  9, { 5, 5, 5 }, 19, {
+    {'r',0,8,0},{'b',2,4,4},{'g',0,8,0},{'g',2,4,4},{'b',0,8,0},{'b',3,4,4},{'r',1,4,0},{'g',3,4,4},{'g',2,3,0},{'g',1,4,0},
+    {'b',3,0,0},{'g',3,3,0},{'b',1,4,0},{'b',3,1,1},{'b',2,3,0},{'r',2,4,0},{'b',3,2,2},{'r',3,4,0},{'b',3,3,3} } },
+  { 2, true,  8, { 6, 5, 5 }, 19, {
+    {'r',0,7,0},{'g',3,4,4},{'b',2,4,4},{'g',0,7,0},{'b',3,2,2},{'g',2,4,4},{'b',0,7,0},{'b',3,3,3},{'b',3,4,4},{'r',1,5,0},
+    {'g',2,3,0},{'g',1,4,0},{'b',3,0,0},{'g',3,3,0},{'b',1,4,0},{'b',3,1,1},{'b',2,3,0},{'r',2,5,0},{'r',3,5,0} } },
+  { 2, true,  8, { 5, 6, 5 }, 21, {
+    {'r',0,7,0},{'b',3,0,0},{'b',2,4,4},{'g',0,7,0},{'g',2,5,5},{'g',2,4,4},{'b',0,7,0},{'g',3,5,5},{'b',3,4,4},{'r',1,4,0},
+    {'g',3,4,4},{'g',2,3,0},{'g',1,5,0},{'g',3,3,0},{'b',1,4,0},{'b',3,1,1},{'b',2,3,0},{'r',2,4,0},{'b',3,2,2},{'r',3,4,0},
+    {'b',3,3,3} } },
+  { 2, true,  8, { 5, 5, 6 }, 21, {
+    {'r',0,7,0},{'b',3,1,1},{'b',2,4,4},{'g',0,7,0},{'b',2,5,5},{'g',2,4,4},{'b',0,7,0},{'b',3,5,5},{'b',3,4,4},{'r',1,4,0},
+    {'g',3,4,4},{'g',2,3,0},{'g',1,4,0},{'b',3,0,0},{'g',3,3,0},{'b',1,5,0},{'b',2,3,0},{'r',2,4,0},{'b',3,2,2},{'r',3,4,0},
+    {'b',3,3,3} } },
+  { 2, false, 6, { 6, 6, 6 }, 23, {
+    {'r',0,5,0},{'g',3,4,4},{'b',3,0,0},{'b',3,1,1},{'b',2,4,4},{'g',0,5,0},{'g',2,5,5},{'b',2,5,5},{'b',3,2,2},{'g',2,4,4},
+    {'b',0,5,0},{'g',3,5,5},{'b',3,3,3},{'b',3,5,5},{'b',3,4,4},{'r',1,5,0},{'g',2,3,0},{'g',1,5,0},{'g',3,3,0},{'b',1,5,0},
+    {'b',2,3,0},{'r',2,5,0},{'r',3,5,0} } },
+  { 1, false, 10, { 10, 10, 10 }, 6, {
+    {'r',0,9,0},{'g',0,9,0},{'b',0,9,0},{'r',1,9,0},{'g',1,9,0},{'b',1,9,0} } },
+  { 1, true,  11, {  9,  9,  9 }, 9, {
+    {'r',0,9,0},{'g',0,9,0},{'b',0,9,0},{'r',1,8,0},{'r',0,10,10},{'g',1,8,0},{'g',0,10,10},{'b',1,8,0},{'b',0,10,10} } },
+  { 1, true,  12, {  8,  8,  8 }, 9, {
+    {'r',0,9,0},{'g',0,9,0},{'b',0,9,0},{'r',1,7,0},{'r',0,10,11},{'g',1,7,0},{'g',0,10,11},{'b',1,7,0},{'b',0,10,11} } },
+  { 1, true,  16, {  4,  4,  4 }, 9, {
+    {'r',0,9,0},{'g',0,9,0},{'b',0,9,0},{'r',1,3,0},{'r',0,10,15},{'g',1,3,0},{'g',0,10,15},{'b',1,3,0},{'b',0,10,15} } }
+};
+
+// Mode bits (2 bits, or 5 if the low two are 1x) to skiv_bc6h_modes, -1 = reserved
+static constexpr int8_t skiv_bc6h_mode_index [32] = {
+   0,  1,  2, 10,  0,  1,  3, 11,  0,  1,  4, 12,  0,  1,  5, 13,
+   0,  1,  6, -1,  0,  1,  7, -1,  0,  1,  8, -1,  0,  1,  9, -1
+};
+
+static int32_t
+SKIV_BC6H_Unquantize (int32_t value, uint32_t bits, bool is_signed)
+{
+  if (! is_signed)
+  {
+    if (bits >= 15)                  return value;
+    if (value == 0)                  return 0;
+    if (value == (1 << bits) - 1)    return 0xFFFF;
+
+    return ((value << 16) + 0x8000) >> bits;
+  }
+
+  if (bits >= 16)
+    return value;
+
+  const bool negative = (value < 0);
+  int32_t    magnitude = negative ? -value : value;
+
+  if      (magnitude == 0)                       magnitude = 0;
+  else if (magnitude >= (1 << (bits - 1)) - 1)   magnitude = 0x7FFF;
+  else    magnitude = ((magnitude << 15) + 0x4000) >> (bits - 1);
+
+  return negative ? -magnitude : magnitude;
+}
+
+// Scales an interpolated value to the half-float bit pattern (max 0x7BFF)
+static __forceinline uint16_t
+SKIV_BC6H_Finish (int32_t value, bool is_signed)
+{
+  if (! is_signed)
+    return static_cast <uint16_t> ((value * 31) >> 6);
+
+  return (value < 0) ? static_cast <uint16_t> (0x8000 | (((-value) * 31) >> 5))
+                     : static_cast <uint16_t> (          (  value  * 31) >> 5);
+}
+
+// Decodes into 16 RGBA FP16 pixels (alpha = 1.0); reserved modes decode to black
+static void
+SKIV_BC_DecodeBC6H (const uint8_t* block, uint16_t* rgba, bool is_signed)
+{
+  static constexpr uint16_t one = 0x3C00;
+
+  skiv_bc_bits_s bits (block);
+
+  uint32_t mode_bits = bits.Read (2);
+
+  if (mode_bits > 1)
+    mode_bits |= bits.Read (3) << 2;
+
+  const int mode_index =
+    skiv_bc6h_mode_index [mode_bits];
+
+  if (mode_index < 0)
+  {
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+      rgba [i * 4 + 0] = rgba [i * 4 + 1] = rgba [i * 4 + 2] = 0;
+      rgba [i * 4 + 3] = one;
+    }
+
+    return;
+  }
+
+  const skiv_bc6h_mode_s& mode =
+    skiv_bc6h_modes [mode_index];
+
+  int32_t endpoints [4][3] = { };
+
+  for (uint32_t f = 0; f < mode.field_count; ++f)
+  {
+    const skiv_bc6h_field_s& field = mode.fields [f];
+    int32_t&                 value = endpoints [field.endpoint][field.channel == 'r' ? 0 : field.channel == 'g' ? 1 : 2];
+
+    if (field.last_bit >= field.first_bit)
+      value |= bits.Read (field.last_bit - field.first_bit + 1) << field.first_bit;
+
+    else
+    {
+      for (int bit = field.first_bit; bit >= field.last_bit; --bit)
+        value |= bits.Read (1) << bit;
+    }
+  }
+
+  const uint32_t partition   = (mode.regions == 2) ? bits.Read (5) : 0;
+  const uint32_t num_points  = mode.regions * 2;
+  const uint32_t base_bits   = mode.endpoint_bits;
+
+  for (uint32_t c = 0; c < 3; ++c)
+  {
+    if (is_signed)
+      endpoints [0][c] = SKIV_BC_SignExtend (endpoints [0][c], base_bits);
+
+    for (uint32_t e = 1; e < num_points; ++e)
+    {
+      int32_t& value = endpoints [e][c];
+
+      if (is_signed || mode.transformed)
+        value = SKIV_BC_SignExtend (value, mode.delta_bits [c]);
+
+      if (mode.transformed)
+      {
+        value = (endpoints [0][c] + value) & ((1 << base_bits) - 1);
+
+        if (is_signed)
+          value = SKIV_BC_SignExtend (value, base_bits);
+      }
+    }
+
+    for (uint32_t e = 0; e < num_points; ++e)
+      endpoints [e][c] = SKIV_BC6H_Unquantize (endpoints [e][c], base_bits, is_signed);
+  }
+
+  const uint32_t  index_bits = (mode.regions == 2) ? 3 : 4;
+  const uint8_t*  weights    = SKIV_BC_GetWeights (index_bits);
+  const uint32_t  subsets    = (mode.regions == 2) ? skiv_bc_partitions2 [partition] : 0;
+  const uint32_t  anchor     = (mode.regions == 2) ? skiv_bc_anchors2    [partition] : 0;
+
+  for (uint32_t i = 0; i < 16; ++i)
+  {
+    const uint32_t index  = bits.Read (index_bits - ((i == 0 || (mode.regions == 2 && i == anchor)) ? 1 : 0));
+    const uint32_t subset = (subsets >> i) & 0x1;
+    const int32_t  weight = weights [index];
+
+    for (uint32_t c = 0; c < 3; ++c)
+    {
+      const int32_t e0 = endpoints [subset * 2 + 0][c];
+      const int32_t e1 = endpoints [subset * 2 + 1][c];
+
+      rgba [i * 4 + c] =
+        SKIV_BC6H_Finish (((64 - weight) * e0 + weight * e1 + 32) >> 6, is_signed);
+    }
+
+    rgba [i * 4 + 3] = one;
+  }
+}
+
+#pragma endregion
+
+#pragma region BC7
+
+struct skiv_bc7_mode_s {
+  uint8_t subsets;
+  uint8_t partition_bits;
+  uint8_t rotation_bits;
+  uint8_t index_selection_bits;
+  uint8_t color_bits;
+  uint8_t alpha_bits;
+  uint8_t endpoint_pbits;       // One p-bit per endpoint
+  uint8_t shared_pbits;         // One p-bit per subset
+  uint8_t index_bits;
+  uint8_t index_bits2;          // Separate alpha (or colour, see index selection) indices
+};
+
+static constexpr skiv_bc7_mode_s skiv_bc7_modes [8] = {
+  { 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+  { 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+  { 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+  { 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+  { 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+  { 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+  { 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+  { 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 }
+};
+
+// Decodes into 16 RGBA8 pixels; blocks without a mode decode to transparent black
+static void
+SKIV_BC_DecodeBC7 (const uint8_t* block, uint8_t* rgba)
+{
+  if (block [0] == 0)
+  {
+    memset (rgba, 0, 64);
+    return;
+  }
+
+  unsigned long mode_index;
+  _BitScanForward (&mode_index, block [0]);
+
+  const skiv_bc7_mode_s& mode =
+    skiv_bc7_modes [mode_index];
+
+  skiv_bc_bits_s bits (block);
+  bits.pos = mode_index + 1;
+
+  const uint32_t partition       = bits.Read (mode.partition_bits);
+  const uint32_t rotation        = bits.Read (mode.rotation_bits);
+  const uint32_t index_selection = bits.Read (mode.index_selection_bits);
+  const uint32_t num_points      = mode.subsets * 2;
+
+  uint32_t endpoints [6][4];
+
+  for (uint32_t c = 0; c < 3; ++c)
+    for (uint32_t e = 0; e < num_points; ++e)
+      endpoints [e][c] = bits.Read (mode.color_bits);
+
+  for (uint32_t e = 0; e < num_points; ++e)
+    endpoints [e][3] = bits.Read (mode.alpha_bits);
+
+  uint32_t color_bits = mode.color_bits;
+  uint32_t alpha_bits = mode.alpha_bits;
+
+  if (mode.endpoint_pbits != 0 || mode.shared_pbits != 0)
+  {
+    uint32_t pbits [6];
+
+    if (mode.endpoint_pbits != 0)
+      for (uint32_t e = 0; e < num_points; ++e)
+        pbits [e] = bits.Read (1);
+
+    else
+      for (uint32_t s = 0; s < mode.subsets; ++s)
+        pbits [s * 2] = pbits [s * 2 + 1] = bits.Read (1);
+
+    for (uint32_t e = 0; e < num_points; ++e)
+      for (uint32_t c = 0; c < 4; ++c)
+        endpoints [e][c] = (endpoints [e][c] << 1) | pbits [e];
+
+    color_bits++;
+
+    if (alpha_bits != 0)
+      alpha_bits++;
+  }
+
+  // Replicates the most significant bits into the low bits
+  for (uint32_t e = 0; e < num_points; ++e)
+  {
+    for (uint32_t c = 0; c < 3; ++c)
+      endpoints [e][c] = (endpoints [e][c] << (8 - color_bits)) | (endpoints [e][c] >> (2 * color_bits - 8));
+
+    endpoints [e][3] = (alpha_bits == 0) ? 255
+                     : (endpoints [e][3] << (8 - alpha_bits)) | (endpoints [e][3] >> (2 * alpha_bits - 8));
+  }
+
+  uint32_t subsets [16];
+  bool     anchors [16] = { true };
+
+  for (uint32_t i = 0; i < 16; ++i)
+    subsets [i] = (mode.subsets == 2) ? (skiv_bc_partitions2 [partition] >>  i)      & 0x1 :
+                  (mode.subsets == 3) ? (skiv_bc_partitions3 [partition] >> (i * 2)) & 0x3 : 0;
+
+  if (mode.subsets == 2)
+    anchors [skiv_bc_anchors2 [partition]] = true;
+
+  else if (mode.subsets == 3)
+  {
+    anchors [skiv_bc_anchors3_second [partition]] = true;
+    anchors [skiv_bc_anchors3_third  [partition]] = true;
+  }
+
+  uint32_t indices  [16];
+  uint32_t indices2 [16] = { };
+
+  for (uint32_t i = 0; i < 16; ++i)
+    indices [i] = bits.Read (mode.index_bits - (anchors [i] ? 1 : 0));
+
+  if (mode.index_bits2 != 0)
+    for (uint32_t i = 0; i < 16; ++i)
+      indices2 [i] = bits.Read (mode.index_bits2 - (i == 0 ? 1 : 0));
+
+  // Without a second set of indices, alpha shares the colour indices
+  const bool      swap_sets     = (index_selection != 0);
+  const uint32_t* color_indices = swap_sets ? indices2 : indices;
+  const uint32_t* alpha_indices = (mode.index_bits2 == 0) ? indices : swap_sets ? indices : indices2;
+  const uint8_t*  color_weights = SKIV_BC_GetWeights (swap_sets ? mode.index_bits2 : mode.index_bits);
+  const uint8_t*  alpha_weights = SKIV_BC_GetWeights ((mode.index_bits2 == 0 || swap_sets) ? mode.index_bits : mode.index_bits2);
+
+  for (uint32_t i = 0; i < 16; ++i)
+  {
+    const uint32_t* e0 = endpoints [subsets [i] * 2 + 0];
+    const uint32_t* e1 = endpoints [subsets [i] * 2 + 1];
+    uint8_t*        px = rgba + i * 4;
+
+    for (uint32_t c = 0; c < 3; ++c)
+      px [c] = static_cast <uint8_t> (SKIV_BC_Interpolate (e0 [c], e1 [c], color_weights [color_indices [i]]));
+
+    px [3] = static_cast <uint8_t> (SKIV_BC_Interpolate (e0 [3], e1 [3], alpha_weights [alpha_indices [i]]));
+
+    if (rotation != 0)
+      std::swap (px [3], px [rotation - 1]);
+  }
+}
+
+#pragma endregion
+
+#pragma region Image Decoding
+
+enum skiv_bc_codec_e {
+  SKIV_BC_None,
+  SKIV_BC_BC1,
+  SKIV_BC_BC2,
+  SKIV_BC_BC3,
+  SKIV_BC_BC4,
+  SKIV_BC_BC4S,
+  SKIV_BC_BC5,
+  SKIV_BC_BC5S,
+  SKIV_BC_BC6H,
+  SKIV_BC_BC6HS,
+  SKIV_BC_BC7
+};
+
+// Typeless formats are decoded as their UNORM (or UF16) variant
+static skiv_bc_codec_e
+SKIV_BC_GetCodec (DXGI_FORMAT format, DXGI_FORMAT& output)
+{
+  output = DXGI_FORMAT_R8G8B8A8_UNORM;
+
+  switch (format)
+  {
+    case DXGI_FORMAT_BC1_UNORM_SRGB: output = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB; [[fallthrough]];
+    case DXGI_FORMAT_BC1_TYPELESS:
+    case DXGI_FORMAT_BC1_UNORM:      return SKIV_BC_BC1;
+    case DXGI_FORMAT_BC2_UNORM_SRGB: output = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB; [[fallthrough]];
+    case DXGI_FORMAT_BC2_TYPELESS:
+    case DXGI_FORMAT_BC2_UNORM:      return SKIV_BC_BC2;
+    case DXGI_FORMAT_BC3_UNORM_SRGB: output = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB; [[fallthrough]];
+    case DXGI_FORMAT_BC3_TYPELESS:
+    case DXGI_FORMAT_BC3_UNORM:      return SKIV_BC_BC3;
+    case DXGI_FORMAT_BC4_TYPELESS:
+    case DXGI_FORMAT_BC4_UNORM:      return SKIV_BC_BC4;
+    case DXGI_FORMAT_BC4_SNORM:      output = DXGI_FORMAT_R8G8B8A8_SNORM; return SKIV_BC_BC4S;
+    case DXGI_FORMAT_BC5_TYPELESS:
+    case DXGI_FORMAT_BC5_UNORM:      return SKIV_BC_BC5;
+    case DXGI_FORMAT_BC5_SNORM:      output = DXGI_FORMAT_R8G8B8A8_SNORM; return SKIV_BC_BC5S;
+    case DXGI_FORMAT_BC6H_TYPELESS:
+    case DXGI_FORMAT_BC6H_UF16:      output = DXGI_FORMAT_R16G16B16A16_FLOAT; return SKIV_BC_BC6H;
+    case DXGI_FORMAT_BC6H_SF16:      output = DXGI_FORMAT_R16G16B16A16_FLOAT; return SKIV_BC_BC6HS;
+    case DXGI_FORMAT_BC7_UNORM_SRGB: output = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB; [[fallthrough]];
+    case DXGI_FORMAT_BC7_TYPELESS:
+    case DXGI_FORMAT_BC7_UNORM:      return SKIV_BC_BC7;
+    default:                         return SKIV_BC_None;
+  }
+}
+
+// Decodes one block into 16 pixels of the output format (4 or 8 bytes each)
+static void
+SKIV_BC_DecodeBlock (skiv_bc_codec_e codec, const uint8_t* block, uint8_t* pixels)
+{
+  switch (codec)
+  {
+    case SKIV_BC_BC1:
+      SKIV_BC_DecodeColor (block, pixels, true);
+      break;
+
+    case SKIV_BC_BC2:
+      SKIV_BC_DecodeColor         (block + 8, pixels, false);
+      SKIV_BC_DecodeExplicitAlpha (block,     pixels + 3);
+      break;
+
+    case SKIV_BC_BC3:
+      SKIV_BC_DecodeColor   (block + 8, pixels, false);
+      SKIV_BC_DecodeChannel (block,     pixels + 3);
+      break;
+
+    case SKIV_BC_BC4:
+    case SKIV_BC_BC5:
+      for (uint32_t i = 0; i < 16; ++i)
+        memcpy (pixels + i * 4, "\x00\x00\x00\xFF", 4);
+
+      SKIV_BC_DecodeChannel (block, pixels);
+
+      if (codec == SKIV_BC_BC5)
+        SKIV_BC_DecodeChannel (block + 8, pixels + 1);
+      break;
+
+    case SKIV_BC_BC4S:
+    case SKIV_BC_BC5S:
+      for (uint32_t i = 0; i < 16; ++i)
+        memcpy (pixels + i * 4, "\x00\x00\x00\x7F", 4);
+
+      SKIV_BC_DecodeChannelSigned (block, reinterpret_cast <int8_t*> (pixels));
+
+      if (codec == SKIV_BC_BC5S)
+        SKIV_BC_DecodeChannelSigned (block + 8, reinterpret_cast <int8_t*> (pixels + 1));
+      break;
+
+    case SKIV_BC_BC6H:
+    case SKIV_BC_BC6HS:
+      SKIV_BC_DecodeBC6H (block, reinterpret_cast <uint16_t*> (pixels), codec == SKIV_BC_BC6HS);
+      break;
+
+    case SKIV_BC_BC7:
+      SKIV_BC_DecodeBC7 (block, pixels);
+      break;
+
+    default:
+      break;
+  }
+}
+
+bool
+SKIV_Image_IsBCDecodable (DXGI_FORMAT format)
+{
+  DXGI_FORMAT output;
+  return SKIV_BC_GetCodec (format, output) != SKIV_BC_None;
+}
+
+HRESULT
+SKIV_Image_DecompressBC (const DirectX::Image& image, DirectX::ScratchImage& result)
+{
+  SKIV_TRACE_SCOPE ("DecompressBC");
+
+  DXGI_FORMAT           output;
+  const skiv_bc_codec_e codec =
+    SKIV_BC_GetCodec (image.format, output);
+
+  if (codec == SKIV_BC_None)
+    return HRESULT_FROM_WIN32 (ERROR_NOT_SUPPORTED);
+
+  if (image.pixels == nullptr || image.width == 0 || image.height == 0)
+    return E_INVALIDARG;
+
+  HRESULT hr =
+    result.Initialize2D (output, image.width, image.height, 1, 1);
+
+  if (FAILED (hr))
+    return hr;
+
+  const DirectX::Image& dst = *result.GetImage (0, 0, 0);
+
+  const size_t block_bytes  = (codec == SKIV_BC_BC1 || codec == SKIV_BC_BC4 || codec == SKIV_BC_BC4S) ? 8 : 16;
+  const size_t pixel_bytes  = DirectX::BitsPerPixel (output) / 8;
+  const size_t block_cols   = (image.width  + 3) / 4;
+  const size_t block_rows   = (image.height + 3) / 4;
+
+  concurrency::parallel_for (size_t { 0 }, block_rows, [&](size_t by)
+  {
+    const uint8_t* src     = image.pixels + by * image.rowPitch;
+    const size_t   y0      = by * 4;
+    const size_t   rows    = std::min <size_t> (4, image.height - y0);
+
+    alignas (16) uint8_t pixels [16 * 8];
+
+    for (size_t bx = 0; bx < block_cols; ++bx, src += block_bytes)
+    {
+      SKIV_BC_DecodeBlock (codec, src, pixels);
+
+      // Blocks along the right and bottom edges extend past the image
+      const size_t x0   = bx * 4;
+      const size_t cols = std::min <size_t> (4, image.width - x0);
+
+      for (size_t y = 0; y < rows; ++y)
+        memcpy ( dst.pixels + (y0 + y) * dst.rowPitch + x0 * pixel_bytes,
+                 pixels     +       y  * 4 * pixel_bytes, cols * pixel_bytes );
+    }
+  });
+
+  return S_OK;
+}
+
+#pragma endregion
+
+#pragma region Encoding Helpers
+
+struct skiv_bc_writer_s {
+  uint64_t lo  = 0;
+  uint64_t hi  = 0;
+  uint32_t pos = 0;
+
+  void Write (uint32_t value, uint32_t count)
+  {
+    const uint64_t bits =
+      value & ((1ULL << count) - 1);
+
+    if      (pos >= 64)         hi |= bits << (pos - 64);
+    else if (pos + count <= 64) lo |= bits <<  pos;
+    else
+    {
+      lo |= bits <<        pos;
+      hi |= bits >> (64 -  pos);
+    }
+
+    pos += count;
+  }
+
+  void Store (uint8_t* block) const
+  {
+    memcpy (block,     &lo, 8);
+    memcpy (block + 8, &hi, 8);
+  }
+};
+
+// The 16 pixels of a block, one row of floats per channel; BC7 works on 0 - 255
+//   values and BC6H on half-float bit patterns (as signed integers), which the
+//     format interpolates linearly and which make a roughly logarithmic metric.
+struct skiv_bc_block_s {
+  alignas (32) float c [4][16];
+};
+
+// Pixels of every subset of a partition, one bit per pixel
+static void
+SKIV_BC_GetSubsetMasks (uint32_t subsets, uint32_t partition, uint32_t masks [3])
+{
+  masks [0] = masks [1] = masks [2] = 0;
+
+  if (subsets == 1)
+    masks [0] = 0xFFFF;
+
+  else if (subsets == 2)
+  {
+    masks [1] = skiv_bc_partitions2 [partition];
+    masks [0] = ~masks [1] & 0xFFFF;
+  }
+
+  else
+  {
+    for (uint32_t i = 0; i < 16; ++i)
+      masks [(skiv_bc_partitions3 [partition] >> (i * 2)) & 0x3] |= 1U << i;
+  }
+}
+
+static uint32_t
+SKIV_BC_GetAnchor (uint32_t subsets, uint32_t partition, uint32_t subset)
+{
+  if (subset == 0)
+    return 0;
+
+  if (subsets == 2)
+    return skiv_bc_anchors2 [partition];
+
+  return (subset == 1) ? skiv_bc_anchors3_second [partition]
+                       : skiv_bc_anchors3_third  [partition];
+}
+
+static __forceinline __m256
+SKIV_BC_GetLaneMask (uint32_t bits)
+{
+  const __m256i lanes =
+    _mm256_setr_epi32 (1, 2, 4, 8, 16, 32, 64, 128);
+
+  return
+    _mm256_castsi256_ps (_mm256_cmpeq_epi32 (_mm256_and_si256 (_mm256_set1_epi32 (static_cast <int> (bits)), lanes), lanes));
+}
+
+static __forceinline float
+SKIV_BC_GetHorizontalSum (__m256 v)
+{
+  __m128 sum = _mm_add_ps (_mm256_castps256_ps128 (v), _mm256_extractf128_ps (v, 1));
+         sum = _mm_add_ps (sum, _mm_movehl_ps (sum, sum));
+         sum = _mm_add_ss (sum, _mm_shuffle_ps (sum, sum, 0x1));
+
+  return _mm_cvtss_f32 (sum);
+}
+
+// Mean, covariance and principal axis of the pixels in mask over the channels
+//   [first, first + count); the sums run 8 pixels at a time.
+struct skiv_bc_moments_s {
+  float n           = 0.0f;
+  float mean  [4]   = { };
+  float cov   [4][4] = { };
+  float axis  [4]   = { };
+  float lambda      = 0.0f; // Variance along the axis
+  float total       = 0.0f; // Variance over all channels
+};
+
+static void
+SKIV_BC_GetMoments (const skiv_bc_block_s& block, uint32_t mask, uint32_t first, uint32_t count, skiv_bc_moments_s& m)
+{
+  const __m256 lanes0 = SKIV_BC_GetLaneMask (mask & 0xFF);
+  const __m256 lanes1 = SKIV_BC_GetLaneMask (mask >> 8);
+
+  m.n = static_cast <float> (_mm_popcnt_u32 (mask));
+
+  if (m.n == 0.0f)
+    return;
+
+  __m256 v [4][2];
+
+  for (uint32_t c = 0; c < count; ++c)
+  {
+    v [c][0] = _mm256_and_ps (lanes0, _mm256_load_ps (block.c [first + c]));
+    v [c][1] = _mm256_and_ps (lanes1, _mm256_load_ps (block.c [first + c] + 8));
+
+    m.mean [c] = SKIV_BC_GetHorizontalSum (_mm256_add_ps (v [c][0], v [c][1])) / m.n;
+  }
+
+  for (uint32_t c = 0; c < count; ++c)
+  {
+    for (uint32_t d = 0; d <= c; ++d)
+    {
+      m.cov [c][d] = m.cov [d][c] =
+        SKIV_BC_GetHorizontalSum (_mm256_fmadd_ps (v [c][0], v [d][0], _mm256_mul_ps (v [c][1], v [d][1]))) / m.n
+          - m.mean [c] * m.mean [d];
+    }
+
+    m.total += m.cov [c][c];
+  }
+
+  // Power iteration, starting from the channel with the largest variance
+  uint32_t largest = 0;
+
+  for (uint32_t c = 1; c < count; ++c)
+    if (m.cov [c][c] > m.cov [largest][largest])
+      largest = c;
+
+  for (uint32_t c = 0; c < count; ++c)
+    m.axis [c] = (c == largest) ? 1.0f : 0.0f;
+
+  for (int iteration = 0; iteration < 8; ++iteration)
+  {
+    float next [4] = { };
+    float length   = 0.0f;
+
+    for (uint32_t c = 0; c < count; ++c)
+    {
+      for (uint32_t d = 0; d < count; ++d)
+        next [c] += m.cov [c][d] * m.axis [d];
+
+      length += next [c] * next [c];
+    }
+
+    if (length < 1.0e-12f)
+      break;
+
+    length = 1.0f / std::sqrt (length);
+
+    for (uint32_t c = 0; c < count; ++c)
+      m.axis [c] = next [c] * length;
+  }
+
+  for (uint32_t c = 0; c < count; ++c)
+    for (uint32_t d = 0; d < count; ++d)
+      m.lambda += m.axis [c] * m.cov [c][d] * m.axis [d];
+}
+
+// Squared error of the best unquantized line through every subset; used to
+//   rank partitions before encoding any of them.
+static void
+SKIV_BC_RankPartitions (const skiv_bc_block_s& block, uint32_t subsets, uint32_t partitions, uint32_t channels,
+                        uint32_t* ranked, uint32_t count)
+{
+  std::pair <float, uint32_t> scores [64];
+
+  for (uint32_t p = 0; p < partitions; ++p)
+  {
+    uint32_t masks [3];
+    SKIV_BC_GetSubsetMasks (subsets, p, masks);
+
+    float error = 0.0f;
+
+    for (uint32_t s = 0; s < subsets; ++s)
+    {
+      skiv_bc_moments_s m;
+      SKIV_BC_GetMoments (block, masks [s], 0, channels, m);
+
+      error += m.n * std::max (0.0f, m.total - m.lambda);
+    }
+
+    scores [p] = { error, p };
+  }
+
+  count = std::min (count, partitions);
+
+  std::partial_sort (scores, scores + count, scores + partitions);
+
+  for (uint32_t i = 0; i < count; ++i)
+    ranked [i] = scores [i].second;
+}
+
+// Endpoints of the line through the pixels in mask, spanning their projections
+static void
+SKIV_BC_FitLine (const skiv_bc_block_s& block, uint32_t mask, uint32_t first, uint32_t count, float lo [4], float hi [4])
+{
+  skiv_bc_moments_s m;
+  SKIV_BC_GetMoments (block, mask, first, count, m);
+
+  float t_min =  FLT_MAX;
+  float t_max = -FLT_MAX;
+
+  for (uint32_t i = 0; i < 16; ++i)
+  {
+    if ((mask & (1U << i)) == 0)
+      continue;
+
+    float t = 0.0f;
+
+    for (uint32_t c = 0; c < count; ++c)
+      t += (block.c [first + c][i] - m.mean [c]) * m.axis [c];
+
+    t_min = std::min (t_min, t);
+    t_max = std::max (t_max, t);
+  }
+
+  if (t_min > t_max)
+    t_min = t_max = 0.0f;
+
+  for (uint32_t c = 0; c < count; ++c)
+  {
+    lo [c] = m.mean [c] + t_min * m.axis [c];
+    hi [c] = m.mean [c] + t_max * m.axis [c];
+  }
+}
+
+// Nearest palette entry for every pixel in mask, returns the squared error;
+//   restricted pixels (anchors whose endpoints cannot be swapped anymore) may
+//     only use the lower half of the palette.
+static float
+SKIV_BC_AssignIndices (const skiv_bc_block_s& block, uint32_t mask, uint32_t first, uint32_t count,
+                       const float palette [][4], uint32_t entries, uint8_t* indices, uint32_t restricted = 0)
+{
+  float total = 0.0f;
+
+  for (uint32_t i = 0; i < 16; ++i)
+  {
+    if ((mask & (1U << i)) == 0)
+      continue;
+
+    const uint32_t limit = (restricted & (1U << i)) ? entries / 2 : entries;
+
+    float    best_error = FLT_MAX;
+    uint32_t best       = 0;
+
+    for (uint32_t e = 0; e < limit; ++e)
+    {
+      float error = 0.0f;
+
+      for (uint32_t c = 0; c < count; ++c)
+      {
+        const float d = palette [e][c] - block.c [first + c][i];
+        error += d * d;
+      }
+
+      if (error < best_error)
+      {
+        best_error = error;
+        best       = e;
+      }
+    }
+
+    indices [i] = static_cast <uint8_t> (best);
+    total      += best_error;
+  }
+
+  return total;
+}
+
+// Least-squares endpoints for the chosen indices; false if they are degenerate
+static bool
+SKIV_BC_RefineLine (const skiv_bc_block_s& block, uint32_t mask, uint32_t first, uint32_t count,
+                    const uint8_t* indices, const uint8_t* weights, float lo [4], float hi [4])
+{
+  float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+  float ap [4] = { }, bp [4] = { };
+
+  for (uint32_t i = 0; i < 16; ++i)
+  {
+    if ((mask & (1U << i)) == 0)
+      continue;
+
+    const float b = static_cast <float> (weights [indices [i]]) / 64.0f;
+    const float a = 1.0f - b;
+
+    aa += a * a;
+    ab += a * b;
+    bb += b * b;
+
+    for (uint32_t c = 0; c < count; ++c)
+    {
+      ap [c] += a * block.c [first + c][i];
+      bp [c] += b * block.c [first + c][i];
+    }
+  }
+
+  const float det = aa * bb - ab * ab;
+
+  if (std::fabs (det) < 1.0e-6f)
+    return false;
+
+  for (uint32_t c = 0; c < count; ++c)
+  {
+    lo [c] = (bb * ap [c] - ab * bp [c]) / det;
+    hi [c] = (aa * bp [c] - ab * ap [c]) / det;
+  }
+
+  return true;
+}
+
+// Swaps the endpoints of a subset by mirroring its indices; the weights are
+//   symmetric, so the decoded pixels stay exactly the same.
+static void
+SKIV_BC_MirrorIndices (uint32_t mask, uint32_t entries, uint8_t* indices)
+{
+  for (uint32_t i = 0; i < 16; ++i)
+    if (mask & (1U << i))
+      indices [i] = static_cast <uint8_t> (entries - 1 - indices [i]);
+}
+
+#pragma endregion
+
+#pragma region BC6H Encoding
+
+struct skiv_bc6h_encoding_s {
+  int      mode      = -1;
+  uint32_t partition = 0;
+  int32_t  endpoints [4][3] = { }; // Quantized, absolute (deltas are derived when writing)
+  uint8_t  indices   [16]   = { };
+  float    error     = FLT_MAX;
+};
+
+// Mode bits of every entry in skiv_bc6h_modes
+static constexpr uint8_t skiv_bc6h_mode_bits [14] = {
+  0x00, 0x01, 0x02, 0x06, 0x0A, 0x0E, 0x12, 0x16, 0x1A, 0x1E, 0x03, 0x07, 0x0B, 0x0F
+};
+
+static __forceinline int32_t
+SKIV_BC6H_ToInteger (uint16_t half, bool is_signed)
+{
+  return (is_signed && (half & 0x8000)) ? -static_cast <int32_t> (half & 0x7FFF)
+                                        :  static_cast <int32_t> (half);
+}
+
+// Endpoint at the given precision whose decoded value is closest to value
+static int32_t
+SKIV_BC6H_Quantize (float value, uint32_t bits, bool is_signed)
+{
+  const int32_t max_q = is_signed ? (1 << (bits - 1)) - 1 : (1 << bits) - 1;
+  const int32_t min_q = is_signed ? -max_q : 0;
+  const float   scale = static_cast <float> (is_signed ? (1 << (bits - 1)) : (1 << bits)) / 31744.0f;
+
+  const int32_t estimate =
+    static_cast <int32_t> (std::floor (value * scale));
+
+  int32_t best       = 0;
+  float   best_error = FLT_MAX;
+
+  for (int32_t q = estimate - 1; q <= estimate + 1; ++q)
+  {
+    const int32_t clamped = std::clamp (q, min_q, max_q);
+    const float   error   = std::fabs (value - static_cast <float> (
+      SKIV_BC6H_ToInteger (SKIV_BC6H_Finish (SKIV_BC6H_Unquantize (clamped, bits, is_signed), is_signed), is_signed)));
+
+    if (error < best_error)
+    {
+      best_error = error;
+      best       = clamped;
+    }
+  }
+
+  return best;
+}
+
+static void
+SKIV_BC6H_GetPalette (const int32_t e0 [3], const int32_t e1 [3], uint32_t bits, bool is_signed, uint32_t index_bits, float palette [16][4])
+{
+  const uint8_t* weights = SKIV_BC_GetWeights (index_bits);
+
+  for (uint32_t c = 0; c < 3; ++c)
+  {
+    const int32_t u0 = SKIV_BC6H_Unquantize (e0 [c], bits, is_signed);
+    const int32_t u1 = SKIV_BC6H_Unquantize (e1 [c], bits, is_signed);
+
+    for (uint32_t i = 0; i < (1U << index_bits); ++i)
+    {
+      palette [i][c] = static_cast <float> (SKIV_BC6H_ToInteger (
+        SKIV_BC6H_Finish (((64 - weights [i]) * u0 + weights [i] * u1 + 32) >> 6, is_signed), is_signed));
+    }
+  }
+}
+
+// Encodes the block with one mode and partition, starting from the given lines
+//   (per region: low and high endpoint); refinement re-fits the lines to the
+//     chosen indices.
+static void
+SKIV_BC6H_EncodeMode (const skiv_bc_block_s& block, int mode_index, uint32_t partition, bool is_signed,
+                      const float (&lines) [2][2][4], uint32_t refinements, skiv_bc6h_encoding_s& best)
+{
+  const skiv_bc6h_mode_s& mode = skiv_bc6h_modes [mode_index];
+
+  const uint32_t index_bits = (mode.regions == 2) ? 3 : 4;
+  const uint32_t entries    = 1U << index_bits;
+  const uint8_t* weights    = SKIV_BC_GetWeights (index_bits);
+  const uint32_t bits       = mode.endpoint_bits;
+
+  uint32_t masks [3];
+  SKIV_BC_GetSubsetMasks (mode.regions, partition, masks);
+
+  float line [2][2][4];
+  memcpy (line, lines, sizeof (line));
+
+  for (uint32_t iteration = 0; iteration <= refinements; ++iteration)
+  {
+    skiv_bc6h_encoding_s enc;
+    enc.mode      = mode_index;
+    enc.partition = partition;
+
+    for (uint32_t r = 0; r < mode.regions; ++r)
+      for (uint32_t e = 0; e < 2; ++e)
+        for (uint32_t c = 0; c < 3; ++c)
+          enc.endpoints [r * 2 + e][c] = SKIV_BC6H_Quantize (line [r][e][c], bits, is_signed);
+
+    float palette [2][16][4];
+
+    for (uint32_t r = 0; r < mode.regions; ++r)
+    {
+      SKIV_BC6H_GetPalette (enc.endpoints [r * 2], enc.endpoints [r * 2 + 1], bits, is_signed, index_bits, palette [r]);
+      SKIV_BC_AssignIndices (block, masks [r], 0, 3, palette [r], entries, enc.indices);
+
+      const uint32_t anchor = SKIV_BC_GetAnchor (mode.regions, partition, r);
+
+      if (enc.indices [anchor] >= entries / 2)
+      {
+        std::swap (enc.endpoints [r * 2], enc.endpoints [r * 2 + 1]);
+        SKIV_BC_MirrorIndices (masks [r], entries, enc.indices);
+      }
+    }
+
+    // Deltas beyond their precision are clamped, which moves the endpoints;
+    //   the indices are then chosen again with the anchors kept in the lower
+    //     half of the palette, since the endpoints cannot be swapped anymore.
+    if (mode.transformed)
+    {
+      for (uint32_t e = 1; e < mode.regions * 2U; ++e)
+      {
+        for (uint32_t c = 0; c < 3; ++c)
+        {
+          const int32_t limit = 1 << (mode.delta_bits [c] - 1);
+          const int32_t delta = enc.endpoints [e][c] - enc.endpoints [0][c];
+
+          enc.endpoints [e][c] = enc.endpoints [0][c] + std::clamp (delta, -limit, limit - 1);
+        }
+      }
+    }
+
+    enc.error = 0.0f;
+
+    for (uint32_t r = 0; r < mode.regions; ++r)
+    {
+      SKIV_BC6H_GetPalette (enc.endpoints [r * 2], enc.endpoints [r * 2 + 1], bits, is_signed, index_bits, palette [r]);
+
+      enc.error +=
+        SKIV_BC_AssignIndices (block, masks [r], 0, 3, palette [r], entries, enc.indices,
+                               1U << SKIV_BC_GetAnchor (mode.regions, partition, r));
+    }
+
+    if (enc.error < best.error)
+      best = enc;
+
+    if (enc.error == 0.0f || iteration == refinements)
+      break;
+
+    bool refined = false;
+
+    for (uint32_t r = 0; r < mode.regions; ++r)
+      refined |= SKIV_BC_RefineLine (block, masks [r], 0, 3, enc.indices, weights, line [r][0], line [r][1]);
+
+    if (! refined)
+      break;
+  }
+}
+
+static void
+SKIV_BC6H_WriteBlock (const skiv_bc6h_encoding_s& enc, uint8_t* out)
+{
+  const skiv_bc6h_mode_s& mode = skiv_bc6h_modes [enc.mode];
+
+  int32_t stored [4][3];
+
+  for (uint32_t e = 0; e < mode.regions * 2U; ++e)
+  {
+    for (uint32_t c = 0; c < 3; ++c)
+    {
+      stored [e][c] = (e == 0 || ! mode.transformed)
+        ? enc.endpoints [e][c]                         & ((1 << mode.endpoint_bits) - 1)
+        : (enc.endpoints [e][c] - enc.endpoints [0][c]) & ((1 << mode.delta_bits [c]) - 1);
+    }
+  }
+
+  skiv_bc_writer_s bits;
+  bits.Write (skiv_bc6h_mode_bits [enc.mode], (enc.mode < 2) ? 2 : 5);
+
+  for (uint32_t f = 0; f < mode.field_count; ++f)
+  {
+    const skiv_bc6h_field_s& field = mode.fields [f];
+    const uint32_t           value = static_cast <uint32_t> (
+      stored [field.endpoint][field.channel == 'r' ? 0 : field.channel == 'g' ? 1 : 2]);
+
+    if (field.last_bit >= field.first_bit)
+      bits.Write (value >> field.first_bit, field.last_bit - field.first_bit + 1);
+
+    else
+    {
+      for (int bit = field.first_bit; bit >= field.last_bit; --bit)
+        bits.Write (value >> bit, 1);
+    }
+  }
+
+  const uint32_t index_bits = (mode.regions == 2) ? 3 : 4;
+  const uint32_t anchor     = (mode.regions == 2) ? skiv_bc_anchors2 [enc.partition] : 0;
+
+  if (mode.regions == 2)
+    bits.Write (enc.partition, 5);
+
+  for (uint32_t i = 0; i < 16; ++i)
+    bits.Write (enc.indices [i], index_bits - ((i == 0 || (mode.regions == 2 && i == anchor)) ? 1 : 0));
+
+  bits.Store (out);
+}
+
+// Fast tries the four single-region modes, Normal and Best add the two-region
+//   modes on the 2 and 8 partitions that fit best.
+static void
+SKIV_BC6H_EncodeBlock (const skiv_bc_block_s& block, bool is_signed, SKIV_BCQuality quality, uint8_t* out)
+{
+  const uint32_t refinements = static_cast <uint32_t> (quality);
+
+  skiv_bc6h_encoding_s best;
+
+  float lines [2][2][4] = { };
+  SKIV_BC_FitLine (block, 0xFFFF, 0, 3, lines [0][0], lines [0][1]);
+
+  for (int mode = 10; mode < 14 && best.error > 0.0f; ++mode)
+    SKIV_BC6H_EncodeMode (block, mode, 0, is_signed, lines, refinements, best);
+
+  if (quality != SKIV_BCQuality_Fast && best.error > 0.0f)
+  {
+    uint32_t ranked [8];
+    uint32_t count = (quality == SKIV_BCQuality_Best) ? 8 : 2;
+
+    SKIV_BC_RankPartitions (block, 2, 32, 3, ranked, count);
+
+    for (uint32_t k = 0; k < count && best.error > 0.0f; ++k)
+    {
+      uint32_t masks [3];
+      SKIV_BC_GetSubsetMasks (2, ranked [k], masks);
+
+      for (uint32_t r = 0; r < 2; ++r)
+        SKIV_BC_FitLine (block, masks [r], 0, 3, lines [r][0], lines [r][1]);
+
+      for (int mode = 0; mode < 10; ++mode)
+        SKIV_BC6H_EncodeMode (block, mode, ranked [k], is_signed, lines, refinements, best);
+    }
+  }
+
+  SKIV_BC6H_WriteBlock (best, out);
+}
+
+#pragma endregion
+
+#pragma region BC7 Encoding
+
+struct skiv_bc7_encoding_s {
+  uint32_t mode            = 6;
+  uint32_t partition       = 0;
+  uint32_t index_selection = 0;
+  uint32_t endpoints [6][4] = { }; // Quantized, without the p-bits
+  uint32_t pbits     [6]    = { };
+  uint8_t  indices   [16]   = { };
+  uint8_t  indices2  [16]   = { };
+  float    error            = FLT_MAX;
+};
+
+static __forceinline uint32_t
+SKIV_BC7_Expand (uint32_t value, uint32_t bits)
+{
+  return (value << (8 - bits)) | (value >> (2 * bits - 8));
+}
+
+// Stored bits of the nearest representable value, with the p-bit (if any)
+//   appended below them before expansion to 8 bits.
+static uint32_t
+SKIV_BC7_Quantize (float value, uint32_t bits, int pbit)
+{
+  const uint32_t total = bits + (pbit >= 0 ? 1 : 0);
+  const int32_t  max_q = (1 << bits) - 1;
+
+  const float scaled =
+    std::clamp (value, 0.0f, 255.0f) * static_cast <float> ((1 << total) - 1) / 255.0f;
+
+  const int32_t estimate = (pbit >= 0) ? static_cast <int32_t> ((scaled - pbit) * 0.5f)
+                                       : static_cast <int32_t> (scaled);
+
+  uint32_t best       = 0;
+  float    best_error = FLT_MAX;
+
+  for (int32_t q = estimate; q <= estimate + 1; ++q)
+  {
+    const uint32_t clamped  = static_cast <uint32_t> (std::clamp (q, 0, max_q));
+    const uint32_t expanded = SKIV_BC7_Expand ((pbit >= 0) ? (clamped << 1) | pbit : clamped, total);
+    const float    error    = std::fabs (value - static_cast <float> (expanded));
+
+    if (error < best_error)
+    {
+      best_error = error;
+      best       = clamped;
+    }
+  }
+
+  return best;
+}
+
+// Quantizes a line for channels [first, first + count) under every p-bit
+//   combination the mode allows and assigns indices; returns the best error.
+static float
+SKIV_BC7_EncodeEndpoints (const skiv_bc_block_s& block, uint32_t mask, uint32_t first, uint32_t count,
+                          const skiv_bc7_mode_s& mode, uint32_t index_bits, const float lo [4], const float hi [4],
+                          uint32_t endpoints [2][4], uint32_t pbits [2], uint8_t* indices)
+{
+  const uint32_t entries = 1U << index_bits;
+  const uint8_t* weights = SKIV_BC_GetWeights (index_bits);
+
+  const uint32_t combinations = mode.endpoint_pbits ? 4 :
+                                mode.shared_pbits   ? 2 : 1;
+
+  float best_error = FLT_MAX;
+
+  for (uint32_t combination = 0; combination < combinations; ++combination)
+  {
+    const int p [2] = {
+      mode.endpoint_pbits ?  static_cast <int> (combination &  1)       :
+      mode.shared_pbits   ?  static_cast <int> (combination)            : -1,
+      mode.endpoint_pbits ?  static_cast <int> (combination >> 1)       :
+      mode.shared_pbits   ?  static_cast <int> (combination)            : -1
+    };
+
+    uint32_t q        [2][4] = { };
+    uint32_t expanded [2][4] = { };
+
+    for (uint32_t e = 0; e < 2; ++e)
+    {
+      for (uint32_t c = 0; c < count; ++c)
+      {
+        const uint32_t channel = first + c;
+        const uint32_t bits    = (channel < 3) ? mode.color_bits : mode.alpha_bits;
+        const uint32_t total   = bits + (p [e] >= 0 ? 1 : 0);
+
+        q        [e][c] = SKIV_BC7_Quantize ((e == 0 ? lo : hi) [c], bits, p [e]);
+        expanded [e][c] = SKIV_BC7_Expand  ((p [e] >= 0) ? (q [e][c] << 1) | p [e] : q [e][c], total);
+      }
+    }
+
+    float palette [16][4];
+
+    for (uint32_t i = 0; i < entries; ++i)
+      for (uint32_t c = 0; c < count; ++c)
+        palette [i][c] = static_cast <float> (SKIV_BC_Interpolate (expanded [0][c], expanded [1][c], weights [i]));
+
+    uint8_t    candidate [16];
+    const float error =
+      SKIV_BC_AssignIndices (block, mask, first, count, palette, entries, candidate);
+
+    if (error < best_error)
+    {
+      best_error = error;
+
+      for (uint32_t e = 0; e < 2; ++e)
+      {
+        pbits [e] = static_cast <uint32_t> (std::max (p [e], 0));
+
+        for (uint32_t c = 0; c < count; ++c)
+          endpoints [e][first + c] = q [e][c];
+      }
+
+      for (uint32_t i = 0; i < 16; ++i)
+        if (mask & (1U << i))
+          indices [i] = candidate [i];
+    }
+  }
+
+  return best_error;
+}
+
+static float
+SKIV_BC7_EncodeLine (const skiv_bc_block_s& block, uint32_t mask, uint32_t first, uint32_t count,
+                     const skiv_bc7_mode_s& mode, uint32_t index_bits, uint32_t refinements,
+                     uint32_t endpoints [2][4], uint32_t pbits [2], uint8_t* indices)
+{
+  float lo [4], hi [4];
+  SKIV_BC_FitLine (block, mask, first, count, lo, hi);
+
+  float error =
+    SKIV_BC7_EncodeEndpoints (block, mask, first, count, mode, index_bits, lo, hi, endpoints, pbits, indices);
+
+  for (uint32_t iteration = 0; iteration < refinements && error > 0.0f; ++iteration)
+  {
+    if (! SKIV_BC_RefineLine (block, mask, first, count, indices, SKIV_BC_GetWeights (index_bits), lo, hi))
+      break;
+
+    uint32_t refined_endpoints [2][4];
+    uint32_t refined_pbits     [2];
+    uint8_t  refined_indices   [16];
+
+    memcpy (refined_endpoints, endpoints, sizeof (refined_endpoints));
+
+    const float refined_error =
+      SKIV_BC7_EncodeEndpoints (block, mask, first, count, mode, index_bits, lo, hi, refined_endpoints, refined_pbits, refined_indices);
+
+    if (refined_error >= error)
+      break;
+
+    error = refined_error;
+
+    memcpy (endpoints, refined_endpoints, sizeof (refined_endpoints));
+    memcpy (pbits,     refined_pbits,     sizeof (refined_pbits));
+
+    for (uint32_t i = 0; i < 16; ++i)
+      if (mask & (1U << i))
+        indices [i] = refined_indices [i];
+  }
+
+  return error;
+}
+
+static void
+SKIV_BC7_EncodeMode (const skiv_bc_block_s& block, uint32_t mode_index, uint32_t partition, uint32_t index_selection,
+                     uint32_t refinements, skiv_bc7_encoding_s& best)
+{
+  const skiv_bc7_mode_s& mode = skiv_bc7_modes [mode_index];
+
+  skiv_bc7_encoding_s enc;
+  enc.mode            = mode_index;
+  enc.partition       = partition;
+  enc.index_selection = index_selection;
+  enc.error           = 0.0f;
+
+  uint32_t masks [3];
+  SKIV_BC_GetSubsetMasks (mode.subsets, partition, masks);
+
+  if (mode.index_bits2 != 0)
+  {
+    // Modes 4 and 5: colour and alpha are separate lines with their own indices
+    uint8_t*       color_indices = index_selection ? enc.indices2 : enc.indices;
+    uint8_t*       alpha_indices = index_selection ? enc.indices  : enc.indices2;
+    const uint32_t color_bits    = index_selection ? mode.index_bits2 : mode.index_bits;
+    const uint32_t alpha_bits    = index_selection ? mode.index_bits  : mode.index_bits2;
+
+    uint32_t pbits [2];
+
+    enc.error += SKIV_BC7_EncodeLine (block, 0xFFFF, 0, 3, mode, color_bits, refinements,
+                   reinterpret_cast <uint32_t (*)[4]> (enc.endpoints [0]), pbits, color_indices);
+    enc.error += SKIV_BC7_EncodeLine (block, 0xFFFF, 3, 1, mode, alpha_bits, refinements,
+                   reinterpret_cast <uint32_t (*)[4]> (enc.endpoints [0]), pbits, alpha_indices);
+
+    if (color_indices [0] >= (1U << color_bits) / 2)
+    {
+      for (uint32_t c = 0; c < 3; ++c)
+        std::swap (enc.endpoints [0][c], enc.endpoints [1][c]);
+
+      SKIV_BC_MirrorIndices (0xFFFF, 1U << color_bits, color_indices);
+    }
+
+    if (alpha_indices [0] >= (1U << alpha_bits) / 2)
+    {
+      std::swap (enc.endpoints [0][3], enc.endpoints [1][3]);
+      SKIV_BC_MirrorIndices (0xFFFF, 1U << alpha_bits, alpha_indices);
+    }
+  }
+
+  else
+  {
+    // Modes without alpha decode it as 255, which they are only used for
+    const uint32_t channels = (mode.alpha_bits != 0) ? 4 : 3;
+
+    for (uint32_t s = 0; s < mode.subsets; ++s)
+    {
+      enc.error +=
+        SKIV_BC7_EncodeLine (block, masks [s], 0, channels, mode, mode.index_bits, refinements,
+                             reinterpret_cast <uint32_t (*)[4]> (enc.endpoints [s * 2]), enc.pbits + s * 2, enc.indices);
+
+      if (enc.error >= best.error)
+        return;
+
+      if (enc.indices [SKIV_BC_GetAnchor (mode.subsets, partition, s)] >= (1U << mode.index_bits) / 2)
+      {
+        std::swap (enc.endpoints [s * 2], enc.endpoints [s * 2 + 1]);
+        std::swap (enc.pbits     [s * 2], enc.pbits     [s * 2 + 1]);
+
+        SKIV_BC_MirrorIndices (masks [s], 1U << mode.index_bits, enc.indices);
+      }
+    }
+  }
+
+  if (enc.error < best.error)
+    best = enc;
+}
+
+static void
+SKIV_BC7_WriteBlock (const skiv_bc7_encoding_s& enc, uint8_t* out)
+{
+  const skiv_bc7_mode_s& mode = skiv_bc7_modes [enc.mode];
+
+  const uint32_t num_points = mode.subsets * 2;
+
+  skiv_bc_writer_s bits;
+
+  bits.Write (1U << enc.mode, enc.mode + 1);
+  bits.Write (enc.partition,       mode.partition_bits);
+  bits.Write (0,                   mode.rotation_bits);
+  bits.Write (enc.index_selection, mode.index_selection_bits);
+
+  for (uint32_t c = 0; c < 3; ++c)
+    for (uint32_t e = 0; e < num_points; ++e)
+      bits.Write (enc.endpoints [e][c], mode.color_bits);
+
+  for (uint32_t e = 0; e < num_points; ++e)
+    bits.Write (enc.endpoints [e][3], mode.alpha_bits);
+
+  if (mode.endpoint_pbits != 0)
+    for (uint32_t e = 0; e < num_points; ++e)
+      bits.Write (enc.pbits [e], 1);
+
+  if (mode.shared_pbits != 0)
+    for (uint32_t s = 0; s < mode.subsets; ++s)
+      bits.Write (enc.pbits [s * 2], 1);
+
+  for (uint32_t i = 0; i < 16; ++i)
+  {
+    bool anchor = (i == 0);
+
+    for (uint32_t s = 1; s < mode.subsets; ++s)
+      anchor |= (i == SKIV_BC_GetAnchor (mode.subsets, enc.partition, s));
+
+    bits.Write (enc.indices [i], mode.index_bits - (anchor ? 1 : 0));
+  }
+
+  if (mode.index_bits2 != 0)
+    for (uint32_t i = 0; i < 16; ++i)
+      bits.Write (enc.indices2 [i], mode.index_bits2 - (i == 0 ? 1 : 0));
+
+  bits.Store (out);
+}
+
+// Fast only uses mode 6; Normal adds the two-subset modes (1 and 3 for opaque
+//   blocks, 5 and 7 otherwise) on the 4 best partitions, Best searches 16 of
+//     them plus the three-subset modes 0 and 2, and mode 4.
+static void
+SKIV_BC7_EncodeBlock (const skiv_bc_block_s& block, SKIV_BCQuality quality, uint8_t* out)
+{
+  const uint32_t refinements = static_cast <uint32_t> (quality);
+
+  bool opaque = true;
+
+  for (uint32_t i = 0; i < 16; ++i)
+    opaque &= (block.c [3][i] == 255.0f);
+
+  skiv_bc7_encoding_s best;
+
+  SKIV_BC7_EncodeMode (block, 6, 0, 0, refinements, best);
+
+  if (quality != SKIV_BCQuality_Fast && best.error > 0.0f)
+  {
+    const uint32_t count = (quality == SKIV_BCQuality_Best) ? 16 : 4;
+    uint32_t       ranked [16];
+
+    SKIV_BC_RankPartitions (block, 2, 64, opaque ? 3 : 4, ranked, count);
+
+    if (! opaque)
+    {
+      SKIV_BC7_EncodeMode (block, 5, 0, 0, refinements, best);
+
+      if (quality == SKIV_BCQuality_Best)
+      {
+        SKIV_BC7_EncodeMode (block, 4, 0, 0, refinements, best);
+        SKIV_BC7_EncodeMode (block, 4, 0, 1, refinements, best);
+      }
+    }
+
+    for (uint32_t k = 0; k < count && best.error > 0.0f; ++k)
+    {
+      if (opaque)
+      {
+        SKIV_BC7_EncodeMode (block, 1, ranked [k], 0, refinements, best);
+        SKIV_BC7_EncodeMode (block, 3, ranked [k], 0, refinements, best);
+      }
+
+      else
+        SKIV_BC7_EncodeMode (block, 7, ranked [k], 0, refinements, best);
+    }
+
+    if (opaque && quality == SKIV_BCQuality_Best && best.error > 0.0f)
+    {
+      SKIV_BC_RankPartitions (block, 3, 16, 3, ranked, 4);
+
+      for (uint32_t k = 0; k < 4; ++k)
+        SKIV_BC7_EncodeMode (block, 0, ranked [k], 0, refinements, best);
+
+      SKIV_BC_RankPartitions (block, 3, 64, 3, ranked, 8);
+
+      for (uint32_t k = 0; k < 8; ++k)
+        SKIV_BC7_EncodeMode (block, 2, ranked [k], 0, refinements, best);
+    }
+  }
+
+  SKIV_BC7_WriteBlock (best, out);
+}
+
+#pragma endregion
+
+#pragma region Image Encoding
+
+// Compresses src (RGBA8 for BC7, RGBA FP16 for BC6H) into the blocks of dst
+static void
+SKIV_BC_CompressImage (const DirectX::Image& src, SKIV_BCQuality quality, const DirectX::Image& dst)
+{
+  const bool is_bc7    = (dst.format == DXGI_FORMAT_BC7_UNORM || dst.format == DXGI_FORMAT_BC7_UNORM_SRGB);
+  const bool is_signed = (dst.format == DXGI_FORMAT_BC6H_SF16);
+
+  const size_t block_cols = (src.width  + 3) / 4;
+  const size_t block_rows = (src.height + 3) / 4;
+
+  concurrency::parallel_for (size_t { 0 }, block_rows, [&](size_t by)
+  {
+    skiv_bc_block_s block;
+
+    for (size_t bx = 0; bx < block_cols; ++bx)
+    {
+      // Blocks along the right and bottom edges repeat the last column / row
+      for (uint32_t i = 0; i < 16; ++i)
+      {
+        const size_t x = std::min (bx * 4 + (i & 3), src.width  - 1);
+        const size_t y = std::min (by * 4 + (i >> 2), src.height - 1);
+
+        if (is_bc7)
+        {
+          const uint8_t* pixel = src.pixels + y * src.rowPitch + x * 4;
+
+          for (uint32_t c = 0; c < 4; ++c)
+            block.c [c][i] = static_cast <float> (pixel [c]);
+        }
+
+        else
+        {
+          const uint16_t* pixel =
+            reinterpret_cast <const uint16_t *> (src.pixels + y * src.rowPitch) + x * 4;
+
+          for (uint32_t c = 0; c < 3; ++c)
+          {
+            // NaN and infinity become black and the largest finite value;
+            //   UF16 cannot hold negative values at all.
+            const uint16_t magnitude = pixel [c] & 0x7FFF;
+            const bool     negative  = (pixel [c] & 0x8000) != 0;
+
+            int32_t value = (magnitude > 0x7C00) ? 0 : std::min <int32_t> (magnitude, 0x7BFF);
+
+            if (negative)
+              value = is_signed ? -value : 0;
+
+            block.c [c][i] = static_cast <float> (value);
+          }
+
+          block.c [3][i] = 0.0f;
+        }
+      }
+
+      uint8_t* out = dst.pixels + by * dst.rowPitch + bx * 16;
+
+      if (is_bc7) SKIV_BC7_EncodeBlock  (block,            quality, out);
+      else        SKIV_BC6H_EncodeBlock (block, is_signed, quality, out);
+    }
+  });
+}
+
+// Converts image into the layout SKIV_BC_CompressImage reads, if necessary
+static HRESULT
+SKIV_BC_GetEncoderInput (const DirectX::Image& image, DXGI_FORMAT format, DirectX::ScratchImage& converted, const DirectX::Image*& source)
+{
+  const bool is_bc7 =
+    (format == DXGI_FORMAT_BC7_UNORM || format == DXGI_FORMAT_BC7_UNORM_SRGB);
+
+  source = &image;
+
+  // RGBA8 is encoded as stored, whether or not it is tagged sRGB
+  if (is_bc7 ? (image.format == DXGI_FORMAT_R8G8B8A8_UNORM || image.format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB)
+             :  image.format == DXGI_FORMAT_R16G16B16A16_FLOAT)
+    return S_OK;
+
+  // The sRGB tag of the input is kept, so that the conversion only requantizes
+  const DXGI_FORMAT input =
+    ! is_bc7                           ? DXGI_FORMAT_R16G16B16A16_FLOAT  :
+    DirectX::IsSRGB (image.format)     ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB :
+                                         DXGI_FORMAT_R8G8B8A8_UNORM;
+
+  HRESULT hr =
+    SKIV_Image_Convert (image, input, DirectX::TEX_FILTER_DEFAULT, 0.0f, converted);
+
+  if (SUCCEEDED (hr))
+    source = converted.GetImage (0, 0, 0);
+
+  return hr;
+}
+
+HRESULT
+SKIV_Image_CompressBC (const DirectX::Image& image, DXGI_FORMAT format, SKIV_BCQuality quality, DirectX::ScratchImage& result)
+{
+  SKIV_TRACE_SCOPE ("CompressBC");
+
+  if (format != DXGI_FORMAT_BC7_UNORM && format != DXGI_FORMAT_BC7_UNORM_SRGB &&
+      format != DXGI_FORMAT_BC6H_UF16 && format != DXGI_FORMAT_BC6H_SF16)
+    return HRESULT_FROM_WIN32 (ERROR_NOT_SUPPORTED);
+
+  if (image.pixels == nullptr || image.width == 0 || image.height == 0)
+    return E_INVALIDARG;
+
+  DirectX::ScratchImage converted;
+  const DirectX::Image* source = nullptr;
+
+  HRESULT hr =
+    SKIV_BC_GetEncoderInput (image, format, converted, source);
+
+  if (SUCCEEDED (hr))
+    hr = result.Initialize2D (format, image.width, image.height, 1, 1);
+
+  if (FAILED (hr))
+    return hr;
+
+  SKIV_BC_CompressImage (*source, quality, *result.GetImage (0, 0, 0));
+
+  return S_OK;
+}
+
+HRESULT
+SKIV_Image_SaveToDDS (const DirectX::Image& image, const wchar_t* wszFileName, SKIV_BCQuality quality, bool mipmaps)
+{
+  SKIV_TRACE_SCOPE ("SaveToDDS");
+
+  // HDR10 (PQ) would need to be converted to scRGB first
+  if (image.format == DXGI_FORMAT_R10G10B10A2_UNORM)
+    return E_NOTIMPL;
+
+  const bool is_hdr =
+    (DirectX::FormatDataType (image.format) == DirectX::FORMAT_TYPE_FLOAT);
+
+  // SDR images hold sRGB-encoded content even when they are not tagged as such
+  DXGI_FORMAT format =
+    is_hdr ? DXGI_FORMAT_BC6H_UF16 : DXGI_FORMAT_BC7_UNORM_SRGB;
+
+  DirectX::ScratchImage converted;
+  const DirectX::Image* source = nullptr;
+
+  HRESULT hr =
+    SKIV_BC_GetEncoderInput (image, format, converted, source);
+
+  if (FAILED (hr))
+    return hr;
+
+  // Negative components (colours outside of Rec. 709) need the signed variant
+  if (is_hdr)
+  {
+    for (size_t y = 0; y < source->height && format == DXGI_FORMAT_BC6H_UF16; ++y)
+    {
+      const uint16_t* pixel =
+        reinterpret_cast <const uint16_t *> (source->pixels + y * source->rowPitch);
+
+      for (size_t x = 0; x < source->width; ++x, pixel += 4)
+      {
+        // Negative zero does not count
+        if ((pixel [0] > 0x8000) || (pixel [1] > 0x8000) || (pixel [2] > 0x8000))
+        {
+          format = DXGI_FORMAT_BC6H_SF16;
+          break;
+        }
+      }
+    }
+  }
+
+  DirectX::ScratchImage mips;
+
+  if (! mipmaps || FAILED (SKIV_Image_GenerateMipMaps (*source, mips)))
+  {
+    mips.Release ( );
+
+    if (FAILED (hr = mips.InitializeFromImage (*source)))
+      return hr;
+  }
+
+  const size_t levels =
+    mips.GetMetadata ().mipLevels;
+
+  DirectX::ScratchImage compressed;
+
+  if (FAILED (hr = compressed.Initialize2D (format, source->width, source->height, 1, levels)))
+    return hr;
+
+  const DWORD dwStart = SKIF_Util_timeGetTime1 ( );
+
+  for (size_t level = 0; level < levels; ++level)
+    SKIV_BC_CompressImage (*mips.GetImage (level, 0, 0), quality, *compressed.GetImage (level, 0, 0));
+
+  PLOG_INFO << "Compressed " << source->width << "x" << source->height << " image (" << levels << " mip levels) to "
+            << ((format == DXGI_FORMAT_BC7_UNORM_SRGB) ? "BC7" : (format == DXGI_FORMAT_BC6H_SF16) ? "BC6H (signed)" : "BC6H")
+            << " in " << SKIF_Util_timeGetTime1 ( ) - dwStart << " ms";
+
+  return
+    DirectX::SaveToDDSFile (compressed.GetImages (), compressed.GetImageCount (), compressed.GetMetadata (),
+                            DirectX::DDS_FLAGS_NONE, wszFileName);
+}
+
+#pragma endregion
@@ -0,0 +1,244 @@
+#include <utility/image_cache.h>
+#include <utility/fsutil.h>
+#include <utility/registry.h>
+#include <utility/sha256.h>
+#include <utility/trace.h>
+#include <utility/utility.h>
+#include <plog/Log.h>
+#include <process.h>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <vector>
+
+static struct {
+  std::atomic <uint64_t> hits    = 0;
+  std::atomic <uint64_t> misses  = 0;
+  std::atomic <uint64_t> stores  = 0;
+  std::atomic <uint64_t> bytes   = 0;     // As of the last trim
+  std::atomic <uint64_t> entries = 0;
+  std::atomic <bool>     storing = false; // One entry is written at a time
+} skiv_image_cache;
+
+static std::wstring
+SKIV_ImageCache_GetFolder (void)
+{
+  static SKIF_CommonPathsCache& _path_cache = SKIF_CommonPathsCache::GetInstance ( );
+
+  return
+    std::wstring (_path_cache.skiv_temp) + LR"(cache\)";
+}
+
+// The viewer normalizes the paths it opens, but not their case
+static std::wstring
+SKIV_ImageCache_GetEntryPath (const std::wstring& path)
+{
+  const std::wstring key =
+    SKIF_Util_ToLowerW (SKIF_Util_NormalizeFullPath (path));
+
+  skiv_sha256_s sha256;
+  sha256.update (key.data (), key.size () * sizeof (wchar_t));
+
+  const std::string hex =
+    sha256.finish_hex ().substr (0, 32);
+
+  return
+    SKIV_ImageCache_GetFolder () + std::wstring (hex.begin (), hex.end ()) + L".skivcache";
+}
+
+// Oldest first; reads refresh the write time of an entry
+void
+SKIV_ImageCache_Trim (void)
+{
+  static SKIF_RegistrySettings& _registry = SKIF_RegistrySettings::GetInstance ( );
+
+  const uint64_t cap =
+    static_cast <uint64_t> (std::max (0, _registry.iImageCacheCap)) * 1024 * 1024;
+
+  struct entry_s {
+    std::filesystem::path           path;
+    uint64_t                        size;
+    std::filesystem::file_time_type time;
+  };
+
+  std::vector <entry_s> entries;
+  uint64_t              total = 0;
+  std::error_code       ec;
+
+  for (const auto& file : std::filesystem::directory_iterator (SKIV_ImageCache_GetFolder (), ec))
+  {
+    if (file.path ().extension () != L".skivcache")
+      continue;
+
+    entries.push_back ({ file.path (), file.file_size (ec), file.last_write_time (ec) });
+    total += entries.back ().size;
+  }
+
+  std::sort (entries.begin (), entries.end (), [](const entry_s& a, const entry_s& b) { return a.time < b.time; });
+
+  size_t count = entries.size ();
+
+  for (const auto& entry : entries)
+  {
+    if (total <= cap)
+      break;
+
+    if (std::filesystem::remove (entry.path, ec))
+    {
+      PLOG_VERBOSE << "Evicted " << entry.path.wstring () << " from the image cache";
+      total -= entry.size;
+      count--;
+    }
+  }
+
+  skiv_image_cache.bytes   = total;
+  skiv_image_cache.entries = count;
+}
+
+bool
+SKIV_ImageCache_IsEnabled (void)
+{
+  static SKIF_RegistrySettings& _registry = SKIF_RegistrySettings::GetInstance ( );
+
+  return
+    _registry.iImageCacheCap > 0;
+}
+
+bool
+SKIV_ImageCache_Load (const std::wstring& path, DirectX::ScratchImage& result, skiv_image_cache_info_s& info)
+{
+  if (! SKIV_ImageCache_IsEnabled ())
+    return false;
+
+  SKIV_TRACE_SCOPE ("ImageCacheLoad");
+
+  const std::wstring entry_path =
+    SKIV_ImageCache_GetEntryPath (path);
+
+  if (! SKIV_ImageCache_ReadEntry (entry_path, path, result, info))
+  {
+    PLOG_DEBUG << "The image cache has no valid entry for " << path;
+
+    skiv_image_cache.misses++;
+    return false;
+  }
+
+  // Keep recently viewed images from being evicted first
+  HANDLE hTouch =
+    CreateFileW (entry_path.c_str (), FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                 OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+  if (hTouch != INVALID_HANDLE_VALUE)
+  {
+    FILETIME     now;
+    GetSystemTimeAsFileTime (&now);
+    SetFileTime (hTouch, nullptr, nullptr, &now);
+    CloseHandle (hTouch);
+  }
+
+  skiv_image_cache.hits++;
+
+  return true;
+}
+
+static void
+SKIV_ImageCache_Write (const std::wstring& path, const DirectX::Image& image, const skiv_image_cache_info_s& info)
+{
+  SKIV_TRACE_SCOPE ("ImageCacheStore");
+
+  std::error_code ec;
+  std::filesystem::create_directories (SKIV_ImageCache_GetFolder (), ec);
+
+  if (! SKIV_ImageCache_WriteEntry (SKIV_ImageCache_GetEntryPath (path), path, image, info))
+    return;
+
+  skiv_image_cache.stores++;
+
+  PLOG_INFO << "Stored " << path << " in the image cache ("
+            << (image.slicePitch / (1024 * 1024)) << " MiB uncompressed)";
+
+  SKIV_ImageCache_Trim ();
+}
+
+void
+SKIV_ImageCache_Store (const std::wstring& path, std::shared_ptr <DirectX::ScratchImage> pixels, const skiv_image_cache_info_s& info)
+{
+  if (! SKIV_ImageCache_IsEnabled () || pixels == nullptr)
+    return;
+
+  const DirectX::TexMetadata& meta =
+    pixels->GetMetadata ();
+
+  if (pixels->GetImageCount () != 1 || meta.dimension != DirectX::TEX_DIMENSION_TEXTURE2D || DirectX::IsCompressed (meta.format))
+    return;
+
+  if (skiv_image_cache.storing.exchange (true))
+  {
+    PLOG_DEBUG << "The image cache is busy, not storing " << path;
+    return;
+  }
+
+  struct thread_s {
+    std::wstring                            path;
+    std::shared_ptr <DirectX::ScratchImage> pixels;
+    skiv_image_cache_info_s                 info;
+  };
+
+  thread_s* data = new thread_s { path, std::move (pixels), info };
+
+  HANDLE hWorkerThread = (HANDLE)
+  _beginthreadex (nullptr, 0x0, [](void* var) -> unsigned
+  {
+    SKIF_Util_SetThreadDescription (GetCurrentThread (), L"SKIV_ImageCacheWorker");
+
+    thread_s* _data = static_cast <thread_s*> (var);
+
+    SKIV_ImageCache_Write (_data->path, *_data->pixels->GetImage (0, 0, 0), _data->info);
+
+    delete _data;
+
+    skiv_image_cache.storing = false;
+
+    return 0;
+  }, data, 0x0, nullptr);
+
+  if (hWorkerThread != nullptr)
+    CloseHandle (hWorkerThread);
+
+  else
+  {
+    delete data;
+    skiv_image_cache.storing = false;
+  }
+}
+
+void
+SKIV_ImageCache_Clear (void)
+{
+  std::error_code ec;
+
+  for (const auto& file : std::filesystem::directory_iterator (SKIV_ImageCache_GetFolder (), ec))
+    std::filesystem::remove (file.path (), ec);
+
+  skiv_image_cache.bytes   = 0;
+  skiv_image_cache.entries = 0;
+}
+
+skiv_image_cache_stats_s
+SKIV_ImageCache_GetStats (void)
+{
+  // Entries left over from a previous session
+  static std::once_flag scanned;
+  std::call_once (scanned, SKIV_ImageCache_Trim);
+
+  skiv_image_cache_stats_s stats;
+
+  stats.bytes   = skiv_image_cache.bytes;
+  stats.entries = skiv_image_cache.entries;
+  stats.hits    = skiv_image_cache.hits;
+  stats.misses  = skiv_image_cache.misses;
+  stats.stores  = skiv_image_cache.stores;
+
+  return stats;
+}
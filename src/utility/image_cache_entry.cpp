@@ -0,0 +1,269 @@
+#include <utility/image_cache.h>
+#include <utility/sha256.h>
+#include <compressapi.h>
+#include <ppl.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#pragma comment (lib, "Cabinet.lib")
+
+// The format of a single image cache entry, kept apart from the registry and
+//   the cache folder so that SKIV.Tests can write and read entries directly
+
+constexpr uint32_t SKIV_IMAGE_CACHE_MAGIC      = 0x43564B53; // SKVC
+constexpr uint32_t SKIV_IMAGE_CACHE_VERSION    = 2;
+constexpr size_t   SKIV_IMAGE_CACHE_CHUNK_SIZE = 4 * 1024 * 1024;
+
+// Followed by chunk_count compressed sizes (uint32_t) and then the chunks; a
+//   chunk that would not shrink is stored as-is, with its size left unchanged.
+struct skiv_image_cache_header_s {
+  uint32_t                magic       = SKIV_IMAGE_CACHE_MAGIC;
+  uint32_t                version     = SKIV_IMAGE_CACHE_VERSION;
+  uint64_t                file_size   = 0;
+  uint64_t                file_time   = 0; // Last write time
+  char                    sha256 [65] = { };
+  uint32_t                format      = 0; // DXGI_FORMAT
+  uint32_t                width       = 0;
+  uint32_t                height      = 0;
+  uint64_t                row_pitch   = 0;
+  uint64_t                bytes       = 0; // Uncompressed
+  uint32_t                chunk_count = 0;
+  skiv_image_cache_info_s info;
+};
+
+static bool
+SKIV_ImageCache_GetSourceInfo (const std::wstring& path, uint64_t& size, uint64_t& time)
+{
+  WIN32_FILE_ATTRIBUTE_DATA
+                        attrs = { };
+  if (! GetFileAttributesExW (path.c_str (), GetFileExInfoStandard, &attrs))
+    return false;
+
+  size = (static_cast <uint64_t> (attrs.nFileSizeHigh)                  << 32) | attrs.nFileSizeLow;
+  time = (static_cast <uint64_t> (attrs.ftLastWriteTime.dwHighDateTime) << 32) | attrs.ftLastWriteTime.dwLowDateTime;
+
+  return true;
+}
+
+bool
+SKIV_ImageCache_ReadEntry (const std::wstring& entry_path, const std::wstring& path, DirectX::ScratchImage& result, skiv_image_cache_info_s& info)
+{
+  uint64_t file_size = 0,
+           file_time = 0;
+
+  if (! SKIV_ImageCache_GetSourceInfo (path, file_size, file_time))
+    return false;
+
+  HANDLE hFile =
+    CreateFileW (entry_path.c_str (), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                 OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+  if (hFile == INVALID_HANDLE_VALUE)
+    return false;
+
+  // The header alone decides whether the entry is any use, before it is mapped
+  skiv_image_cache_header_s header;
+
+  LARGE_INTEGER entry_size = { };
+  DWORD         dwRead     = 0;
+
+  bool valid =
+    GetFileSizeEx (hFile, &entry_size) && static_cast <uint64_t> (entry_size.QuadPart) >= sizeof (header) &&
+    ReadFile      (hFile, &header, sizeof (header), &dwRead, nullptr) && dwRead == sizeof (header);
+
+  const size_t size =
+    static_cast <size_t> (entry_size.QuadPart);
+
+  if (valid)
+  {
+    header.sha256 [64] = '\0';
+
+    valid = header.magic       == SKIV_IMAGE_CACHE_MAGIC   &&
+            header.version     == SKIV_IMAGE_CACHE_VERSION &&
+            header.file_size   == file_size                &&
+            header.chunk_count == (header.bytes + SKIV_IMAGE_CACHE_CHUNK_SIZE - 1) / SKIV_IMAGE_CACHE_CHUNK_SIZE &&
+            size >= sizeof (header) + header.chunk_count * sizeof (uint32_t);
+  }
+
+  // An unchanged size and last write time are taken as an unchanged file; the
+  //   file is only hashed when it was touched (copied, restored, ...) since
+  if (valid && header.file_time != file_time)
+    valid = (SKIV_SHA256_HashFile (path) == header.sha256);
+
+  HANDLE hMapping = valid ?
+    CreateFileMappingW (hFile, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+
+  CloseHandle (hFile);
+
+  const uint8_t* view = (hMapping != nullptr) ?
+    static_cast <const uint8_t *> (MapViewOfFile (hMapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+
+  if (hMapping != nullptr)
+    CloseHandle (hMapping);
+
+  if (view == nullptr)
+    return false;
+
+  std::vector <size_t> offsets;
+
+  {
+    const uint32_t* sizes =
+      reinterpret_cast <const uint32_t *> (view + sizeof (header));
+
+    size_t offset =
+      sizeof (header) + header.chunk_count * sizeof (uint32_t);
+
+    for (uint32_t i = 0; i < header.chunk_count; ++i)
+    {
+      offsets.push_back (offset);
+      offset += sizes [i];
+    }
+
+    offsets.push_back (offset);
+
+    valid = (offset <= size) &&
+      SUCCEEDED (result.Initialize2D (static_cast <DXGI_FORMAT> (header.format), header.width, header.height, 1, 1)) &&
+      result.GetImage (0, 0, 0)->rowPitch   == header.row_pitch &&
+      result.GetImage (0, 0, 0)->slicePitch == header.bytes;
+  }
+
+  if (valid)
+  {
+    // Read the entry in large requests up front instead of a page fault at a time
+    WIN32_MEMORY_RANGE_ENTRY
+      range = { const_cast <uint8_t *> (view), size };
+    PrefetchVirtualMemory (GetCurrentProcess (), 1, &range, 0);
+
+    uint8_t* pixels =
+      result.GetImage (0, 0, 0)->pixels;
+
+    std::atomic <bool> failed = false;
+
+    concurrency::parallel_for (uint32_t (0), header.chunk_count, [&](uint32_t i)
+    {
+      const size_t raw_size        = std::min (SKIV_IMAGE_CACHE_CHUNK_SIZE, static_cast <size_t> (header.bytes) - i * SKIV_IMAGE_CACHE_CHUNK_SIZE);
+      const size_t compressed_size = offsets [i + 1] - offsets [i];
+
+      if (compressed_size == raw_size)
+      {
+        memcpy (pixels + i * SKIV_IMAGE_CACHE_CHUNK_SIZE, view + offsets [i], raw_size);
+        return;
+      }
+
+      DECOMPRESSOR_HANDLE hDecompressor = nullptr;
+      SIZE_T              decompressed  = 0;
+
+      if (! CreateDecompressor (COMPRESS_ALGORITHM_XPRESS | COMPRESS_RAW, nullptr, &hDecompressor) ||
+          ! Decompress         (hDecompressor, view + offsets [i], compressed_size,
+                                pixels + i * SKIV_IMAGE_CACHE_CHUNK_SIZE, raw_size, &decompressed) || decompressed != raw_size)
+        failed = true;
+
+      if (hDecompressor != nullptr)
+        CloseDecompressor (hDecompressor);
+    });
+
+    valid = ! failed.load ();
+  }
+
+  UnmapViewOfFile (view);
+
+  if (! valid)
+  {
+    result.Release ();
+    return false;
+  }
+
+  info = header.info;
+
+  return true;
+}
+
+bool
+SKIV_ImageCache_WriteEntry (const std::wstring& entry_path, const std::wstring& path, const DirectX::Image& image, const skiv_image_cache_info_s& info)
+{
+  skiv_image_cache_header_s header;
+  header.format    = image.format;
+  header.width     = static_cast <uint32_t> (image.width);
+  header.height    = static_cast <uint32_t> (image.height);
+  header.row_pitch = image.rowPitch;
+  header.bytes     = image.slicePitch;
+  header.info      = info;
+
+  if (! SKIV_ImageCache_GetSourceInfo (path, header.file_size, header.file_time))
+    return false;
+
+  const std::string sha256 =
+    SKIV_SHA256_HashFile (path);
+
+  if (sha256.size () != 64)
+    return false;
+
+  memcpy (header.sha256, sha256.c_str (), 65);
+
+  header.chunk_count = static_cast <uint32_t> (
+    (header.bytes + SKIV_IMAGE_CACHE_CHUNK_SIZE - 1) / SKIV_IMAGE_CACHE_CHUNK_SIZE
+  );
+
+  std::vector <std::vector <uint8_t>> chunks (header.chunk_count);
+
+  concurrency::parallel_for (uint32_t (0), header.chunk_count, [&](uint32_t i)
+  {
+    const uint8_t* raw      = image.pixels + i * SKIV_IMAGE_CACHE_CHUNK_SIZE;
+    const size_t   raw_size = std::min (SKIV_IMAGE_CACHE_CHUNK_SIZE, static_cast <size_t> (header.bytes) - i * SKIV_IMAGE_CACHE_CHUNK_SIZE);
+
+    COMPRESSOR_HANDLE hCompressor = nullptr;
+    SIZE_T            compressed  = 0;
+
+    chunks [i].resize (raw_size);
+
+    // Fails with ERROR_INSUFFICIENT_BUFFER if the chunk would not shrink
+    if (CreateCompressor (COMPRESS_ALGORITHM_XPRESS | COMPRESS_RAW, nullptr, &hCompressor) &&
+        Compress         (hCompressor, raw, raw_size, chunks [i].data (), raw_size - 1, &compressed))
+      chunks [i].resize (compressed);
+    else
+      memcpy (chunks [i].data (), raw, raw_size);
+
+    if (hCompressor != nullptr)
+      CloseCompressor (hCompressor);
+  });
+
+  const std::wstring temp_path =
+    entry_path + L".tmp";
+
+  HANDLE hFile =
+    CreateFileW (temp_path.c_str (), GENERIC_WRITE, 0x0, nullptr,
+                 CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+  if (hFile == INVALID_HANDLE_VALUE)
+    return false;
+
+  DWORD dwWritten = 0;
+  bool  written   =
+    WriteFile (hFile, &header, sizeof (header), &dwWritten, nullptr);
+
+  for (const auto& chunk : chunks)
+  {
+    const uint32_t chunk_size = static_cast <uint32_t> (chunk.size ());
+
+    written = written &&
+      WriteFile (hFile, &chunk_size, sizeof (chunk_size), &dwWritten, nullptr);
+  }
+
+  for (const auto& chunk : chunks)
+  {
+    written = written &&
+      WriteFile (hFile, chunk.data (), static_cast <DWORD> (chunk.size ()), &dwWritten, nullptr);
+  }
+
+  CloseHandle (hFile);
+
+  if (! written || ! MoveFileExW (temp_path.c_str (), entry_path.c_str (), MOVEFILE_REPLACE_EXISTING))
+  {
+    DeleteFileW (temp_path.c_str ());
+    return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,1319 @@
+#include "utility/image.h"
+#include "utility/trace.h"
+#include <plog/Log.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <immintrin.h>
+#include <ppl.h>
+
+// Baseline JPEG decoding
+//
+//   stbi decodes a JPEG one MCU row after another on a single thread. Here the
+//     entropy-coded data is split at its restart markers (if the encoder wrote
+//       any) and the segments are Huffman-decoded in parallel into coefficient
+//         planes; without restart markers the Huffman decoding stays serial, but
+//           the bands of MCU rows it completes are handed off to other threads.
+//
+//   Each band is then transformed (AVX2 IDCT), upsampled (the same triangle
+//     filter stbi and libjpeg use) and color converted (AVX2) straight into the
+//       texture.
+//
+//   Scaled decoding (1/2, 1/4 or 1/8 of the size) averages every 2x2, 4x4 or 8x8
+//     pixels of a block's IDCT before rounding; 1/8 only needs DC. 4:2:0 chroma
+//       is scaled to twice that size rather than upsampled. The Huffman data
+//         still has to be read in full, but upsampling and color conversion
+//           shrink with the output.
+
+#pragma region Helpers
+
+constexpr int SKIV_JPEG_FAST_BITS = 9;
+
+// Natural (row-major) position of every coefficient in zigzag order, plus
+//   padding for corrupt runs that skip past the end of a block
+static constexpr uint8_t skiv_jpeg_zigzag [64 + 16] = {
+   0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+  12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+  35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+  58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63,
+  63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63
+};
+
+struct skiv_jpeg_huffman_s {
+  // Lookahead of SKIV_JPEG_FAST_BITS: code length (0 = longer code) and symbol
+  uint8_t  fast_size   [1 << SKIV_JPEG_FAST_BITS] = { };
+  uint8_t  fast_symbol [1 << SKIV_JPEG_FAST_BITS] = { };
+
+  // AC only: run, coefficient and total length of codes whose value bits fit
+  //   in the lookahead as well; (value << 16) | (run << 8) | length
+  int32_t  fast_ac     [1 << SKIV_JPEG_FAST_BITS] = { };
+
+  int32_t  maxcode     [18] = { };
+  int32_t  valoffset   [17] = { };
+  uint8_t  symbols     [256] = { };
+  bool     defined          = false;
+};
+
+struct skiv_jpeg_component_s {
+  uint8_t  id       = 0;
+  uint8_t  h        = 1,
+           v        = 1;
+  uint8_t  tq       = 0,
+           td       = 0,
+           ta       = 0;
+
+  size_t   blocks_w = 0, // Whole MCUs, as stored in the coefficient plane
+           blocks_h = 0;
+  size_t   width    = 0, // Samples that hold image data, at the output scale
+           height   = 0;
+  int      n        = 8, // Output samples per block and dimension
+           k        = 8; // Coefficients kept per block and dimension
+  uint8_t  fh       = 1, // Sampling factors left after scaling the IDCT up
+           fv       = 1;
+
+  std::unique_ptr <int16_t []> coefs; // k x k per block, natural order
+  alignas (32) float           q [64] = { }; // k x k; for k = 8, scaled for SKIV_JPEG_IDCT8_Float
+};
+
+struct skiv_jpeg_s {
+  size_t                 width            = 0,
+                         height           = 0;
+  int                    components       = 0;
+  skiv_jpeg_component_s  comp [3];
+  int                    hmax             = 1,
+                         vmax             = 1;
+  size_t                 mcus_x           = 0,
+                         mcus_y           = 0;
+  size_t                 restart_interval = 0;
+  bool                   rgb              = false; // Adobe transform 0, or components named R, G, B
+
+  uint16_t               quant [4][64]    = { };  // Natural order
+  bool                   quant_defined [4] = { };
+  skiv_jpeg_huffman_s    dc [4],
+                         ac [4];
+
+  const uint8_t*         scan_begin       = nullptr;
+  const uint8_t*         scan_end         = nullptr;
+};
+
+// Big-endian bit reader over one entropy-coded segment; stuffed zero bytes are
+//   dropped, and reading past the end yields zeros
+struct skiv_jpeg_bits_s {
+  const uint8_t* pos    = nullptr;
+  const uint8_t* end    = nullptr;
+  uint64_t       buffer = 0; // Left-aligned
+  int            count  = 0;
+
+  void refill (void)
+  {
+    if (count > 56)
+      return;
+
+    // Fast path: the next eight bytes hold no 0xFF, so as many whole bytes as
+    //   fit can be taken at once
+    if (end - pos >= 8)
+    {
+      uint64_t word;
+      memcpy (&word, pos, sizeof (word));
+
+      const uint64_t inverted = ~word;
+
+      if (((inverted - 0x0101010101010101ULL) & ~inverted & 0x8080808080808080ULL) == 0)
+      {
+        const int take = (64 - count) & ~7;
+
+        word    = _byteswap_uint64 (word);
+        buffer |= (word >> (64 - take)) << (64 - take - count);
+        count  += take;
+        pos    += take / 8;
+
+        return;
+      }
+    }
+
+    while (count <= 56)
+    {
+      uint64_t byte = 0;
+
+      if (pos < end)
+      {
+        byte = *pos++;
+
+        if (byte == 0xFF && pos < end && *pos == 0x00)
+          pos++;
+      }
+
+      buffer |= byte << (56 - count);
+      count  += 8;
+    }
+  }
+
+  uint32_t peek (int bits) const { return static_cast <uint32_t> (buffer >> (64 - bits)); }
+  void     skip (int bits)       { buffer <<= bits; count -= bits; }
+
+  uint32_t get  (int bits)
+  {
+    const uint32_t value = peek (bits);
+    skip (bits);
+    return value;
+  }
+};
+
+static __forceinline int
+SKIV_JPEG_Extend (uint32_t value, int bits)
+{
+  return
+    (value < (1U << (bits - 1))) ? static_cast <int> (value) - (1 << bits) + 1
+                                 : static_cast <int> (value);
+}
+
+static bool
+SKIV_JPEG_BuildHuffman (skiv_jpeg_huffman_s& table, const uint8_t counts [16], const uint8_t* symbols, size_t total, bool ac)
+{
+  table = { };
+
+  memcpy (table.symbols, symbols, total);
+
+  uint8_t  sizes [256];
+  uint32_t codes [256];
+
+  uint32_t code = 0;
+  size_t   k    = 0;
+
+  for (int len = 1; len <= 16; ++len)
+  {
+    const size_t first = k;
+
+    for (int i = 0; i < counts [len - 1]; ++i, ++k)
+    {
+      sizes [k] = static_cast <uint8_t> (len);
+      codes [k] = code++;
+    }
+
+    // Codes of this length must leave room for a prefix of the longer ones
+    if (code > (1U << len))
+      return false;
+
+    table.maxcode   [len] = (k > first) ? static_cast <int32_t> (code - 1) : -1;
+    table.valoffset [len] = static_cast <int32_t> (first) - static_cast <int32_t> (code - (k - first));
+
+    code <<= 1;
+  }
+
+  table.maxcode [17] = INT32_MAX;
+
+  for (size_t i = 0; i < total; ++i)
+  {
+    if (sizes [i] > SKIV_JPEG_FAST_BITS)
+      continue;
+
+    const int      shift = SKIV_JPEG_FAST_BITS - sizes [i];
+    const uint32_t first = codes [i] << shift;
+
+    for (uint32_t j = 0; j < (1U << shift); ++j)
+    {
+      table.fast_size   [first + j] = sizes [i];
+      table.fast_symbol [first + j] = symbols [i];
+    }
+  }
+
+  if (ac)
+  {
+    for (uint32_t look = 0; look < (1U << SKIV_JPEG_FAST_BITS); ++look)
+    {
+      const int len = table.fast_size [look];
+
+      if (len == 0)
+        continue;
+
+      const int run  = table.fast_symbol [look] >> 4;
+      const int bits = table.fast_symbol [look] & 15;
+
+      if (bits != 0 && len + bits <= SKIV_JPEG_FAST_BITS)
+      {
+        const uint32_t raw =
+          (look >> (SKIV_JPEG_FAST_BITS - len - bits)) & ((1U << bits) - 1);
+
+        table.fast_ac [look] =
+          SKIV_JPEG_Extend (raw, bits) * 65536 + (run << 8) + (len + bits);
+      }
+    }
+  }
+
+  table.defined = true;
+
+  return true;
+}
+
+static __forceinline int
+SKIV_JPEG_DecodeSymbol (skiv_jpeg_bits_s& bits, const skiv_jpeg_huffman_s& table)
+{
+  const uint32_t look =
+    bits.peek (SKIV_JPEG_FAST_BITS);
+
+  if (const int len = table.fast_size [look]; len != 0)
+  {
+    bits.skip (len);
+    return table.fast_symbol [look];
+  }
+
+  const uint32_t code16 = bits.peek (16);
+
+  for (int len = SKIV_JPEG_FAST_BITS + 1; len <= 16; ++len)
+  {
+    const int32_t code =
+      static_cast <int32_t> (code16 >> (16 - len));
+
+    if (code <= table.maxcode [len])
+    {
+      bits.skip (len);
+      return table.symbols [(table.valoffset [len] + code) & 0xFF];
+    }
+  }
+
+  return -1;
+}
+
+// Huffman state of one run of MCUs
+struct skiv_jpeg_scan_s {
+  skiv_jpeg_bits_s bits;
+  int              pred [3] = { };
+  bool             failed   = false;
+};
+
+// Decodes one block into natural order (coef is zeroed here); false on a code
+//   that matches no symbol, after which the rest of the run decodes as zero
+static bool
+SKIV_JPEG_DecodeBlock (skiv_jpeg_scan_s& scan, const skiv_jpeg_huffman_s& dc, const skiv_jpeg_huffman_s& ac, int& pred, int16_t coef [64])
+{
+  memset (coef, 0, 64 * sizeof (int16_t));
+
+  if (scan.failed)
+    return false;
+
+  skiv_jpeg_bits_s& bits = scan.bits;
+
+  bits.refill ();
+
+  const int t = SKIV_JPEG_DecodeSymbol (bits, dc);
+
+  if (t < 0 || t > 15)
+    return false;
+
+  if (t != 0)
+  {
+    bits.refill ();
+    pred += SKIV_JPEG_Extend (bits.get (t), t);
+  }
+
+  coef [0] = static_cast <int16_t> (pred);
+
+  for (int k = 1; k < 64; )
+  {
+    if (bits.count < 32)
+      bits.refill ();
+
+    const uint32_t look =
+      bits.peek (SKIV_JPEG_FAST_BITS);
+
+    if (const int32_t fast = ac.fast_ac [look]; fast != 0)
+    {
+      bits.skip (fast & 0xFF);
+
+      k += (fast >> 8) & 0xF;
+      coef [skiv_jpeg_zigzag [k++]] = static_cast <int16_t> (fast >> 16);
+
+      continue;
+    }
+
+    const int rs = SKIV_JPEG_DecodeSymbol (bits, ac);
+
+    if (rs < 0)
+      return false;
+
+    const int run = rs >> 4,
+              s   = rs & 15;
+
+    if (s == 0)
+    {
+      if (run != 15)
+        break; // End of block
+
+      k += 16;
+      continue;
+    }
+
+    k += run;
+
+    coef [skiv_jpeg_zigzag [std::min (k, 63)]] =
+      static_cast <int16_t> (SKIV_JPEG_Extend (bits.get (s), s));
+
+    k++;
+  }
+
+  return true;
+}
+
+// Decodes MCUs [first, last) into the coefficient planes, keeping the top-left
+//   k x k coefficients of every block (all of them, or only DC)
+static void
+SKIV_JPEG_DecodeMCUs (skiv_jpeg_s& jpeg, skiv_jpeg_scan_s& scan, size_t first, size_t last)
+{
+  alignas (32) int16_t coef [64];
+
+  for (size_t mcu = first; mcu < last; ++mcu)
+  {
+    const size_t mx = mcu % jpeg.mcus_x,
+                 my = mcu / jpeg.mcus_x;
+
+    for (int c = 0; c < jpeg.components; ++c)
+    {
+      skiv_jpeg_component_s& comp = jpeg.comp [c];
+
+      const int    K  = comp.k;
+      const size_t KK = static_cast <size_t> (K) * K;
+
+      for (int by = 0; by < comp.v; ++by)
+      {
+        for (int bx = 0; bx < comp.h; ++bx)
+        {
+          if (! SKIV_JPEG_DecodeBlock (scan, jpeg.dc [comp.td], jpeg.ac [comp.ta], scan.pred [c], coef))
+            scan.failed = true;
+
+          const size_t block =
+            (my * comp.v + by) * comp.blocks_w + (mx * comp.h + bx);
+
+          int16_t* dst = comp.coefs.get () + block * KK;
+
+          for (int row = 0; row < K; ++row)
+            memcpy (dst + row * K, coef + row * 8, K * sizeof (int16_t));
+        }
+      }
+    }
+  }
+}
+
+// Transposes eight rows of eight floats in place
+static __forceinline void
+SKIV_JPEG_Transpose8x8 (__m256 r [8])
+{
+  const __m256 t0 = _mm256_unpacklo_ps (r [0], r [1]), t1 = _mm256_unpackhi_ps (r [0], r [1]),
+               t2 = _mm256_unpacklo_ps (r [2], r [3]), t3 = _mm256_unpackhi_ps (r [2], r [3]),
+               t4 = _mm256_unpacklo_ps (r [4], r [5]), t5 = _mm256_unpackhi_ps (r [4], r [5]),
+               t6 = _mm256_unpacklo_ps (r [6], r [7]), t7 = _mm256_unpackhi_ps (r [6], r [7]);
+
+  const __m256 s0 = _mm256_shuffle_ps (t0, t2, _MM_SHUFFLE (1, 0, 1, 0)), s1 = _mm256_shuffle_ps (t0, t2, _MM_SHUFFLE (3, 2, 3, 2)),
+               s2 = _mm256_shuffle_ps (t1, t3, _MM_SHUFFLE (1, 0, 1, 0)), s3 = _mm256_shuffle_ps (t1, t3, _MM_SHUFFLE (3, 2, 3, 2)),
+               s4 = _mm256_shuffle_ps (t4, t6, _MM_SHUFFLE (1, 0, 1, 0)), s5 = _mm256_shuffle_ps (t4, t6, _MM_SHUFFLE (3, 2, 3, 2)),
+               s6 = _mm256_shuffle_ps (t5, t7, _MM_SHUFFLE (1, 0, 1, 0)), s7 = _mm256_shuffle_ps (t5, t7, _MM_SHUFFLE (3, 2, 3, 2));
+
+  r [0] = _mm256_permute2f128_ps (s0, s4, 0x20); r [4] = _mm256_permute2f128_ps (s0, s4, 0x31);
+  r [1] = _mm256_permute2f128_ps (s1, s5, 0x20); r [5] = _mm256_permute2f128_ps (s1, s5, 0x31);
+  r [2] = _mm256_permute2f128_ps (s2, s6, 0x20); r [6] = _mm256_permute2f128_ps (s2, s6, 0x31);
+  r [3] = _mm256_permute2f128_ps (s3, s7, 0x20); r [7] = _mm256_permute2f128_ps (s3, s7, 0x31);
+}
+
+// cos (k pi / 16) * sqrt (2) for k > 0; the butterflies below leave these
+//   factors out, so they are folded into the dequantization
+static constexpr float skiv_jpeg_aan_scale [8] = {
+  1.0f, 1.387039845f, 1.306562965f, 1.175875602f,
+  1.0f, 0.785694958f, 0.541196100f, 0.275899379f
+};
+
+// One 1-D pass of the AAN float IDCT (as in libjpeg's jidctflt.c) on eight
+//   columns at once
+static __forceinline void
+SKIV_JPEG_IDCT8_Pass (__m256 r [8])
+{
+  const __m256 sqrt2 = _mm256_set1_ps (1.414213562f);
+
+  // Even part
+  const __m256 tmp10 = _mm256_add_ps (r [0], r [4]);
+  const __m256 tmp11 = _mm256_sub_ps (r [0], r [4]);
+  const __m256 tmp13 = _mm256_add_ps (r [2], r [6]);
+  const __m256 tmp12 = _mm256_fmsub_ps (_mm256_sub_ps (r [2], r [6]), sqrt2, tmp13);
+
+  const __m256 e0 = _mm256_add_ps (tmp10, tmp13),
+               e3 = _mm256_sub_ps (tmp10, tmp13),
+               e1 = _mm256_add_ps (tmp11, tmp12),
+               e2 = _mm256_sub_ps (tmp11, tmp12);
+
+  // Odd part
+  const __m256 z13 = _mm256_add_ps (r [5], r [3]);
+  const __m256 z10 = _mm256_sub_ps (r [5], r [3]);
+  const __m256 z11 = _mm256_add_ps (r [1], r [7]);
+  const __m256 z12 = _mm256_sub_ps (r [1], r [7]);
+
+  const __m256 o7  = _mm256_add_ps (z11, z13);
+  const __m256 o11 = _mm256_mul_ps (_mm256_sub_ps (z11, z13), sqrt2);
+  const __m256 z5  = _mm256_mul_ps (_mm256_add_ps (z10, z12), _mm256_set1_ps (1.847759065f));
+  const __m256 o10 = _mm256_fnmadd_ps (z12, _mm256_set1_ps (1.082392200f), z5);
+  const __m256 o12 = _mm256_fnmadd_ps (z10, _mm256_set1_ps (2.613125930f), z5);
+
+  const __m256 o6 = _mm256_sub_ps (o12, o7),
+               o5 = _mm256_sub_ps (o11, o6),
+               o4 = _mm256_sub_ps (o10, o5);
+
+  r [0] = _mm256_add_ps (e0, o7); r [7] = _mm256_sub_ps (e0, o7);
+  r [1] = _mm256_add_ps (e1, o6); r [6] = _mm256_sub_ps (e1, o6);
+  r [2] = _mm256_add_ps (e2, o5); r [5] = _mm256_sub_ps (e2, o5);
+  r [3] = _mm256_add_ps (e3, o4); r [4] = _mm256_sub_ps (e3, o4);
+}
+
+// 8 x 8 IDCT to level-shifted floats, one row per AVX2 register: a pass down
+//   the columns, a transpose, a pass along the rows and another transpose. q
+//     holds the dequantization factors scaled by skiv_jpeg_aan_scale and 1/8
+static __forceinline void
+SKIV_JPEG_IDCT8_Float (const int16_t* coef, const float* q, __m256 r [8])
+{
+  const __m128i ac =
+    _mm_or_si128 (
+      _mm_or_si128 (_mm_or_si128 (_mm_loadu_si128 (reinterpret_cast <const __m128i *> (coef +  8)),
+                                  _mm_loadu_si128 (reinterpret_cast <const __m128i *> (coef + 16))),
+                    _mm_or_si128 (_mm_loadu_si128 (reinterpret_cast <const __m128i *> (coef + 24)),
+                                  _mm_loadu_si128 (reinterpret_cast <const __m128i *> (coef + 32)))),
+      _mm_or_si128 (_mm_or_si128 (_mm_loadu_si128 (reinterpret_cast <const __m128i *> (coef + 40)),
+                                  _mm_loadu_si128 (reinterpret_cast <const __m128i *> (coef + 48))),
+                                  _mm_loadu_si128 (reinterpret_cast <const __m128i *> (coef + 56))));
+
+  for (int u = 0; u < 8; ++u)
+  {
+    r [u] =
+      _mm256_mul_ps (_mm256_cvtepi32_ps (_mm256_cvtepi16_epi32 (
+        _mm_loadu_si128 (reinterpret_cast <const __m128i *> (coef + u * 8)))), _mm256_load_ps (q + u * 8));
+  }
+
+  // Only the first row is non-zero: the column pass copies it to every row
+  if (_mm_testz_si128 (ac, ac))
+  {
+    for (int u = 1; u < 8; ++u)
+      r [u] = r [0];
+  }
+
+  else
+    SKIV_JPEG_IDCT8_Pass (r);
+
+  SKIV_JPEG_Transpose8x8 (r);
+
+  // Level shift through the DC term, which reaches every output unscaled
+  r [0] = _mm256_add_ps (r [0], _mm256_set1_ps (128.0f));
+
+  SKIV_JPEG_IDCT8_Pass   (r);
+  SKIV_JPEG_Transpose8x8 (r);
+}
+
+static void
+SKIV_JPEG_IDCT8 (const int16_t* coef, const float* q, uint8_t* out, size_t stride)
+{
+  __m256 r [8];
+
+  SKIV_JPEG_IDCT8_Float (coef, q, r);
+
+  // Round, saturate to 8-bit and write two rows per 128-bit lane
+  const __m256i order =
+    _mm256_setr_epi32 (0, 4, 1, 5, 2, 6, 3, 7);
+
+  for (int y = 0; y < 8; y += 4)
+  {
+    const __m256i r01 = _mm256_packus_epi32 (_mm256_cvtps_epi32 (r [y + 0]), _mm256_cvtps_epi32 (r [y + 1]));
+    const __m256i r23 = _mm256_packus_epi32 (_mm256_cvtps_epi32 (r [y + 2]), _mm256_cvtps_epi32 (r [y + 3]));
+    const __m256i px  = _mm256_permutevar8x32_epi32 (_mm256_packus_epi16 (r01, r23), order);
+
+    const __m128i lo = _mm256_castsi256_si128   (px);
+    const __m128i hi = _mm256_extracti128_si256 (px, 1);
+
+    _mm_storel_epi64 (reinterpret_cast <__m128i *> (out + (y + 0) * stride), lo);
+    _mm_storel_epi64 (reinterpret_cast <__m128i *> (out + (y + 1) * stride), _mm_unpackhi_epi64 (lo, lo));
+    _mm_storel_epi64 (reinterpret_cast <__m128i *> (out + (y + 2) * stride), hi);
+    _mm_storel_epi64 (reinterpret_cast <__m128i *> (out + (y + 3) * stride), _mm_unpackhi_epi64 (hi, hi));
+  }
+}
+
+// N x N pixels (N = 4 or 2), each the average of 8 / N x 8 / N pixels of the
+//   full IDCT before rounding
+template <int N>
+static void
+SKIV_JPEG_IDCTN (const int16_t* coef, const float* q, uint8_t* out, size_t stride)
+{
+  constexpr int S = 8 / N;
+
+  __m256 r [8];
+
+  SKIV_JPEG_IDCT8_Float (coef, q, r);
+
+  alignas (32) float px [8][8];
+
+  for (int y = 0; y < 8; ++y)
+    _mm256_store_ps (px [y], r [y]);
+
+  for (int y = 0; y < N; ++y)
+  {
+    for (int x = 0; x < N; ++x)
+    {
+      float sum = 0.0f;
+
+      for (int i = 0; i < S; ++i)
+        for (int j = 0; j < S; ++j)
+          sum += px [y * S + i][x * S + j];
+
+      out [y * stride + x] =
+        static_cast <uint8_t> (std::clamp (static_cast <int> (std::lrintf (sum / (S * S))), 0, 255));
+    }
+  }
+}
+
+// The average of all 64 pixels is DC / 8
+static void
+SKIV_JPEG_IDCT1 (const int16_t* coef, const float* q, uint8_t* out, size_t)
+{
+  *out =
+    static_cast <uint8_t> (std::clamp (static_cast <int> (std::lrintf (128.0f + coef [0] * q [0] / 8.0f)), 0, 255));
+}
+
+// Horizontal half of the triangle filter: t holds width samples, 4x their
+//   vertically filtered value, for out_width (2 * width, or one less) pixels
+static void
+SKIV_JPEG_UpsampleRow (const uint16_t* t, size_t width, uint8_t* out, size_t out_width)
+{
+  // 3/4 of the nearer sample plus 1/4 of the one to the left (even pixels) or
+  //   right (odd pixels)
+  auto _Pixel = [&](size_t x)
+  {
+    const size_t c  = x / 2;
+    const size_t nb = (x & 1) ? std::min (c + 1, width - 1) : (c > 0 ? c - 1 : 0);
+
+    out [x] = static_cast <uint8_t> ((3 * t [c] + t [nb] + 8) >> 4);
+  };
+
+  for (size_t x = 0; x < std::min <size_t> (2, out_width); ++x)
+    _Pixel (x);
+
+  // 16 samples to 32 pixels at a time, away from the edges
+  const __m256i round = _mm256_set1_epi16 (8);
+
+  size_t i = 1;
+
+  for (; i + 17 <= width; i += 16)
+  {
+    const __m256i c = _mm256_loadu_si256 (reinterpret_cast <const __m256i *> (t + i));
+    const __m256i l = _mm256_loadu_si256 (reinterpret_cast <const __m256i *> (t + i - 1));
+    const __m256i r = _mm256_loadu_si256 (reinterpret_cast <const __m256i *> (t + i + 1));
+
+    const __m256i c3 = _mm256_add_epi16 (_mm256_add_epi16 (c, _mm256_slli_epi16 (c, 1)), round);
+    const __m256i e  = _mm256_srli_epi16 (_mm256_add_epi16 (c3, l), 4);
+    const __m256i o  = _mm256_srli_epi16 (_mm256_add_epi16 (c3, r), 4);
+
+    _mm256_storeu_si256 (reinterpret_cast <__m256i *> (out + 2 * i),
+      _mm256_packus_epi16 (_mm256_unpacklo_epi16 (e, o), _mm256_unpackhi_epi16 (e, o)));
+  }
+
+  for (size_t x = 2 * i; x < out_width; ++x)
+    _Pixel (x);
+}
+
+// YCbCr (or RGB / gray) rows to 4 bytes per pixel, with alpha 255
+static void
+SKIV_JPEG_ConvertRow (const uint8_t* y_row, const uint8_t* cb_row, const uint8_t* cr_row, int components, bool rgb, bool bgr, uint8_t* out, size_t width)
+{
+  uint32_t* dst = reinterpret_cast <uint32_t *> (out);
+
+  const int r_shift = bgr ? 16 :  0,
+            b_shift = bgr ?  0 : 16;
+
+  size_t x = 0;
+
+  if (components == 1)
+  {
+    for (; x < width; ++x)
+      dst [x] = y_row [x] * 0x010101U | 0xFF000000U;
+
+    return;
+  }
+
+  const __m256  half   = _mm256_set1_ps    (128.0f);
+  const __m256  zero   = _mm256_setzero_ps ();
+  const __m256  max    = _mm256_set1_ps    (255.0f);
+  const __m256i alpha  = _mm256_set1_epi32 (0xFF000000);
+
+  auto _Load = [](const uint8_t* src)
+  {
+    return
+      _mm256_cvtepi32_ps (_mm256_cvtepu8_epi32 (_mm_loadl_epi64 (reinterpret_cast <const __m128i *> (src))));
+  };
+
+  auto _Pack = [&](__m256 r, __m256 g, __m256 b)
+  {
+    const __m256i ri = _mm256_cvtps_epi32 (_mm256_min_ps (_mm256_max_ps (r, zero), max));
+    const __m256i gi = _mm256_cvtps_epi32 (_mm256_min_ps (_mm256_max_ps (g, zero), max));
+    const __m256i bi = _mm256_cvtps_epi32 (_mm256_min_ps (_mm256_max_ps (b, zero), max));
+
+    return
+      _mm256_or_si256 (_mm256_or_si256 (_mm256_sllv_epi32 (ri, _mm256_set1_epi32 (r_shift)), _mm256_slli_epi32 (gi, 8)),
+                       _mm256_or_si256 (_mm256_sllv_epi32 (bi, _mm256_set1_epi32 (b_shift)), alpha));
+  };
+
+  for (; x + 8 <= width; x += 8)
+  {
+    const __m256 c0 = _Load (y_row  + x),
+                 c1 = _Load (cb_row + x),
+                 c2 = _Load (cr_row + x);
+
+    __m256i px;
+
+    if (rgb)
+      px = _Pack (c0, c1, c2);
+
+    else
+    {
+      const __m256 cb = _mm256_sub_ps (c1, half),
+                   cr = _mm256_sub_ps (c2, half);
+
+      px = _Pack (_mm256_fmadd_ps (cr, _mm256_set1_ps (1.40200f), c0),
+                  _mm256_fnmadd_ps (cr, _mm256_set1_ps (0.71414f), _mm256_fnmadd_ps (cb, _mm256_set1_ps (0.34414f), c0)),
+                  _mm256_fmadd_ps (cb, _mm256_set1_ps (1.77200f), c0));
+    }
+
+    _mm256_storeu_si256 (reinterpret_cast <__m256i *> (dst + x), px);
+  }
+
+  for (; x < width; ++x)
+  {
+    float r = y_row [x],
+          g = cb_row [x],
+          b = cr_row [x];
+
+    if (! rgb)
+    {
+      const float luma = y_row  [x],
+                  cb   = cb_row [x] - 128.0f,
+                  cr   = cr_row [x] - 128.0f;
+
+      r = luma + 1.40200f * cr;
+      g = luma - 0.34414f * cb - 0.71414f * cr;
+      b = luma + 1.77200f * cb;
+    }
+
+    auto _Clamp = [](float value) {
+      return static_cast <uint32_t> (std::clamp (static_cast <int> (std::lrintf (value)), 0, 255));
+    };
+
+    dst [x] = (_Clamp (r) << r_shift) | (_Clamp (g) << 8) | (_Clamp (b) << b_shift) | 0xFF000000U;
+  }
+}
+
+// Walks the markers up to the first scan; E_NOTIMPL for anything other than a
+//   single-scan, Huffman-coded, 8-bit baseline / extended image with 1 or 3
+//     components at sampling factors of 1 or 2
+static HRESULT
+SKIV_JPEG_ParseHeader (const uint8_t* data, size_t size, skiv_jpeg_s& jpeg, bool frame_only)
+{
+  const uint8_t* pos = data;
+  const uint8_t* end = data + size;
+
+  if (size < 4 || pos [0] != 0xFF || pos [1] != 0xD8)
+    return E_FAIL;
+
+  pos += 2;
+
+  bool frame  = false,
+       jfif   = false,
+       adobe  = false;
+  int  adobe_transform = 1;
+
+  while (true)
+  {
+    // Fill bytes may precede a marker
+    while (pos < end && *pos != 0xFF)
+      pos++;
+
+    while (pos < end && *pos == 0xFF)
+      pos++;
+
+    if (pos >= end)
+      return E_FAIL;
+
+    const uint8_t marker = *pos++;
+
+    if (marker == 0xD8 || (marker >= 0xD0 && marker <= 0xD7) || marker == 0x01)
+      continue;
+
+    if (marker == 0xD9)
+      return E_FAIL;
+
+    if (end - pos < 2)
+      return E_FAIL;
+
+    const size_t length =
+      (static_cast <size_t> (pos [0]) << 8) | pos [1];
+
+    if (length < 2 || length > static_cast <size_t> (end - pos))
+      return E_FAIL;
+
+    const uint8_t* seg     = pos + 2;
+    const uint8_t* seg_end = pos + length;
+
+    pos += length;
+
+    switch (marker)
+    {
+      case 0xC0: // Baseline
+      case 0xC1: // Extended sequential, Huffman
+      {
+        if (length < 8 || seg [0] != 8)
+          return E_NOTIMPL;
+
+        jpeg.height     = (static_cast <size_t> (seg [1]) << 8) | seg [2];
+        jpeg.width      = (static_cast <size_t> (seg [3]) << 8) | seg [4];
+        jpeg.components = seg [5];
+
+        if (jpeg.width == 0 || jpeg.height == 0 || (jpeg.components != 1 && jpeg.components != 3))
+          return E_NOTIMPL;
+
+        if (length < 8 + 3 * static_cast <size_t> (jpeg.components))
+          return E_FAIL;
+
+        for (int c = 0; c < jpeg.components; ++c)
+        {
+          skiv_jpeg_component_s& comp = jpeg.comp [c];
+
+          comp.id = seg [6 + c * 3];
+          comp.h  = seg [7 + c * 3] >> 4;
+          comp.v  = seg [7 + c * 3] & 15;
+          comp.tq = seg [8 + c * 3];
+
+          if (comp.h < 1 || comp.h > 2 || comp.v < 1 || comp.v > 2 || comp.tq > 3)
+            return E_NOTIMPL;
+
+          jpeg.hmax = std::max <int> (jpeg.hmax, comp.h);
+          jpeg.vmax = std::max <int> (jpeg.vmax, comp.v);
+        }
+
+        // A single component is never interleaved, its MCU is one block
+        if (jpeg.components == 1)
+        {
+          jpeg.comp [0].h = jpeg.comp [0].v = 1;
+          jpeg.hmax       = jpeg.vmax       = 1;
+        }
+
+        // Chroma is upsampled by 2 at most, and never from the luma plane
+        if (jpeg.comp [0].h != jpeg.hmax || jpeg.comp [0].v != jpeg.vmax)
+          return E_NOTIMPL;
+
+        jpeg.mcus_x = (jpeg.width  + 8 * jpeg.hmax - 1) / (8 * jpeg.hmax);
+        jpeg.mcus_y = (jpeg.height + 8 * jpeg.vmax - 1) / (8 * jpeg.vmax);
+
+        frame = true;
+
+        if (frame_only)
+          return S_OK;
+      } break;
+
+      // Progressive, lossless, arithmetic-coded and hierarchical
+      case 0xC2: case 0xC3: case 0xC5: case 0xC6: case 0xC7:
+      case 0xC9: case 0xCA: case 0xCB: case 0xCD: case 0xCE: case 0xCF:
+        return E_NOTIMPL;
+
+      case 0xC4: // DHT
+      {
+        while (seg < seg_end)
+        {
+          if (seg_end - seg < 17)
+            return E_FAIL;
+
+          const int table_class = seg [0] >> 4,
+                    table_id    = seg [0] & 15;
+
+          size_t total = 0;
+
+          for (int i = 1; i <= 16; ++i)
+            total += seg [i];
+
+          if (table_class > 1 || table_id > 3 || total > 256 || static_cast <size_t> (seg_end - seg) < 17 + total)
+            return E_FAIL;
+
+          skiv_jpeg_huffman_s& table =
+            (table_class == 0) ? jpeg.dc [table_id] : jpeg.ac [table_id];
+
+          if (! SKIV_JPEG_BuildHuffman (table, seg + 1, seg + 17, total, table_class == 1))
+            return E_FAIL;
+
+          seg += 17 + total;
+        }
+      } break;
+
+      case 0xDB: // DQT
+      {
+        while (seg < seg_end)
+        {
+          const int precision = seg [0] >> 4,
+                    table_id  = seg [0] & 15;
+
+          const size_t bytes =
+            1 + 64 * (precision ? 2 : 1);
+
+          if (precision > 1 || table_id > 3 || static_cast <size_t> (seg_end - seg) < bytes)
+            return E_FAIL;
+
+          for (int i = 0; i < 64; ++i)
+          {
+            jpeg.quant [table_id][skiv_jpeg_zigzag [i]] =
+              precision ? static_cast <uint16_t> ((seg [1 + i * 2] << 8) | seg [2 + i * 2])
+                        : seg [1 + i];
+          }
+
+          jpeg.quant_defined [table_id] = true;
+
+          seg += bytes;
+        }
+      } break;
+
+      case 0xDD: // DRI
+      {
+        if (length < 4)
+          return E_FAIL;
+
+        jpeg.restart_interval = (static_cast <size_t> (seg [0]) << 8) | seg [1];
+      } break;
+
+      case 0xE0: // JFIF
+      {
+        jfif |= (length >= 7 && memcmp (seg, "JFIF", 4) == 0);
+      } break;
+
+      case 0xEE: // Adobe
+      {
+        if (length >= 14 && memcmp (seg, "Adobe", 5) == 0)
+        {
+          adobe           = true;
+          adobe_transform = seg [11];
+        }
+      } break;
+
+      case 0xDA: // SOS
+      {
+        if (! frame || length < 6 || seg [0] != jpeg.components ||
+            length < 6 + 2 * static_cast <size_t> (jpeg.components))
+          return E_NOTIMPL; // Non-interleaved scans of a multi-component image
+
+        for (int c = 0; c < jpeg.components; ++c)
+        {
+          // Scan components must follow the frame's order
+          if (seg [1 + c * 2] != jpeg.comp [c].id)
+            return E_NOTIMPL;
+
+          jpeg.comp [c].td = seg [2 + c * 2] >> 4;
+          jpeg.comp [c].ta = seg [2 + c * 2] & 15;
+
+          if (jpeg.comp [c].td > 3 || jpeg.comp [c].ta > 3 ||
+              ! jpeg.dc [jpeg.comp [c].td].defined ||
+              ! jpeg.ac [jpeg.comp [c].ta].defined ||
+              ! jpeg.quant_defined [jpeg.comp [c].tq])
+            return E_FAIL;
+        }
+
+        jpeg.rgb =
+          jpeg.components == 3 && ((adobe && adobe_transform == 0) ||
+            (! adobe && ! jfif && jpeg.comp [0].id == 'R' && jpeg.comp [1].id == 'G' && jpeg.comp [2].id == 'B'));
+
+        jpeg.scan_begin = seg_end;
+        jpeg.scan_end   = end;
+
+        return S_OK;
+      }
+
+      case 0xDC: // DNL
+        return E_NOTIMPL;
+
+      default:
+        break;
+    }
+  }
+}
+
+#pragma endregion
+
+bool
+SKIV_Image_GetJPEGInfo (const void* data, size_t size, size_t& width, size_t& height, int& channels)
+{
+  skiv_jpeg_s jpeg;
+
+  if (FAILED (SKIV_JPEG_ParseHeader (static_cast <const uint8_t *> (data), size, jpeg, true)))
+    return false;
+
+  width    = jpeg.width;
+  height   = jpeg.height;
+  channels = jpeg.components;
+
+  return true;
+}
+
+int
+SKIV_Image_GetJPEGScale (size_t width, size_t height, size_t min_width, size_t min_height)
+{
+  for (int scale = 8; scale > 1; scale /= 2)
+  {
+    if ((width  + scale - 1) / scale >= min_width &&
+        (height + scale - 1) / scale >= min_height)
+      return scale;
+  }
+
+  return 1;
+}
+
+HRESULT
+SKIV_Image_LoadJPEG (const void* data, size_t size, int scale, DXGI_FORMAT format, DirectX::ScratchImage& result)
+{
+  SKIV_TRACE_SCOPE ("LoadJPEG");
+
+  bool bgr = false;
+
+  switch (format)
+  {
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+      break;
+
+    case DXGI_FORMAT_B8G8R8A8_UNORM:
+    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+    case DXGI_FORMAT_B8G8R8X8_UNORM:
+    case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+      bgr = true;
+      break;
+
+    default:
+      return E_INVALIDARG;
+  }
+
+  if (scale != 1 && scale != 2 && scale != 4 && scale != 8)
+    return E_INVALIDARG;
+
+  auto jpeg =
+    std::make_unique <skiv_jpeg_s> ();
+
+  HRESULT hr =
+    SKIV_JPEG_ParseHeader (static_cast <const uint8_t *> (data), size, *jpeg, false);
+
+  if (FAILED (hr))
+    return hr;
+
+  const int N = 8 / scale; // Output pixels per block and dimension
+
+  const size_t out_width  = (jpeg->width  + scale - 1) / scale,
+               out_height = (jpeg->height + scale - 1) / scale;
+
+  for (int c = 0; c < jpeg->components; ++c)
+  {
+    skiv_jpeg_component_s& comp = jpeg->comp [c];
+
+    comp.blocks_w = jpeg->mcus_x * comp.h;
+    comp.blocks_h = jpeg->mcus_y * comp.v;
+
+    // When scaling down, 4:2:0 chroma is transformed to twice the size of luma
+    //   instead of being upsampled, as libjpeg does
+    const bool scale_up =
+      N < 8 && comp.h * 2 == jpeg->hmax && comp.v * 2 == jpeg->vmax;
+
+    comp.n  = scale_up ? N * 2 : N;
+    comp.k  = (comp.n == 1) ? 1 : 8;
+    comp.fh = static_cast <uint8_t> (scale_up ? jpeg->hmax : comp.h);
+    comp.fv = static_cast <uint8_t> (scale_up ? jpeg->vmax : comp.v);
+
+    comp.width  = ((jpeg->width  * comp.fh + jpeg->hmax - 1) / jpeg->hmax + scale - 1) / scale;
+    comp.height = ((jpeg->height * comp.fv + jpeg->vmax - 1) / jpeg->vmax + scale - 1) / scale;
+
+    const size_t KK = static_cast <size_t> (comp.k) * comp.k;
+
+    comp.coefs.reset (new (std::nothrow) int16_t [comp.blocks_w * comp.blocks_h * KK]);
+
+    if (comp.coefs == nullptr)
+      return E_OUTOFMEMORY;
+
+    for (int u = 0; u < comp.k; ++u)
+      for (int v = 0; v < comp.k; ++v)
+        comp.q [u * comp.k + v] = jpeg->quant [comp.tq][u * 8 + v] *
+          ((comp.k == 8) ? skiv_jpeg_aan_scale [u] * skiv_jpeg_aan_scale [v] / 8.0f : 1.0f);
+  }
+
+  hr =
+    result.Initialize2D (format, out_width, out_height, 1, 1);
+
+  if (FAILED (hr))
+    return hr;
+
+  // Entropy-coded segments, split at the restart markers; the scan ends at the
+  //   first other marker
+  struct segment_s {
+    const uint8_t* begin;
+    const uint8_t* end;
+  };
+
+  std::vector <segment_s> segments;
+
+  {
+    const uint8_t* begin = jpeg->scan_begin;
+    const uint8_t* pos   = begin;
+    const uint8_t* end   = jpeg->scan_end;
+
+    while (true)
+    {
+      pos = static_cast <const uint8_t *> (memchr (pos, 0xFF, end - pos));
+
+      if (pos == nullptr || pos + 1 >= end)
+      {
+        segments.push_back ({ begin, end });
+        break;
+      }
+
+      const uint8_t* marker = pos;
+
+      while (pos + 1 < end && pos [1] == 0xFF)
+        pos++;
+
+      if (pos + 1 >= end)
+      {
+        segments.push_back ({ begin, marker });
+        break;
+      }
+
+      const uint8_t code = pos [1];
+
+      pos += 2;
+
+      if (code == 0x00)
+        continue;
+
+      segments.push_back ({ begin, marker });
+
+      if (code < 0xD0 || code > 0xD7 || jpeg->restart_interval == 0)
+        break;
+
+      begin = pos;
+    }
+  }
+
+  const size_t total_mcus = jpeg->mcus_x * jpeg->mcus_y;
+  const size_t interval   = (jpeg->restart_interval != 0) ? jpeg->restart_interval : total_mcus;
+  const size_t expected   = (total_mcus + interval - 1) / interval;
+
+  PLOG_WARNING_IF (segments.size () < expected) << "JPEG is truncated or corrupt, " << segments.size () << " of " << expected << " entropy-coded segments found";
+
+  auto _DecodeSegment = [&](size_t segment, size_t first, size_t last)
+  {
+    skiv_jpeg_scan_s scan;
+
+    if (segment < segments.size ())
+    {
+      scan.bits.pos = segments [segment].begin;
+      scan.bits.end = segments [segment].end;
+    }
+
+    SKIV_JPEG_DecodeMCUs (*jpeg, scan, first, last);
+
+    return !scan.failed;
+  };
+
+  // IDCT, upsampling and color conversion of MCU rows [m0, m1)
+  const DirectX::Image& dst =
+    *result.GetImage (0, 0, 0);
+
+  auto _ProcessBand = [&](size_t m0, size_t m1)
+  {
+    const size_t y0 = std::min (out_height, m0 * jpeg->vmax * N),
+                 y1 = std::min (out_height, m1 * jpeg->vmax * N);
+
+    if (y0 >= y1)
+      return;
+
+    struct plane_s {
+      std::vector <uint8_t> samples;
+      size_t                stride    = 0;
+      size_t                first_row = 0;
+
+      const uint8_t* row (size_t y) const { return samples.data () + (y - first_row) * stride; }
+    } planes [3];
+
+    for (int c = 0; c < jpeg->components; ++c)
+    {
+      const skiv_jpeg_component_s& comp = jpeg->comp [c];
+
+      // Rows of this component the band needs, plus a row above and below for
+      //   the vertical upsampling filter
+      const int    n         = comp.n;
+      const bool   upsampled = comp.fv < jpeg->vmax;
+      const size_t r0        = (y0 * comp.fv) / jpeg->vmax - ((upsampled && y0 > 0) ? 1 : 0);
+      const size_t r1        = std::min (comp.height, (y1 * comp.fv + jpeg->vmax - 1) / jpeg->vmax + (upsampled ? 1 : 0));
+
+      const size_t br0 = r0 / n,
+                   br1 = std::min (comp.blocks_h, (r1 + n - 1) / n);
+
+      plane_s& plane = planes [c];
+
+      plane.stride    = comp.blocks_w * n;
+      plane.first_row = br0 * n;
+      plane.samples.resize ((br1 - br0) * n * plane.stride + 32);
+
+      for (size_t by = br0; by < br1; ++by)
+      {
+        for (size_t bx = 0; bx < comp.blocks_w; ++bx)
+        {
+          const int16_t* coef = comp.coefs.get () + (by * comp.blocks_w + bx) * comp.k * comp.k;
+          uint8_t*       out  = plane.samples.data () + (by - br0) * n * plane.stride + bx * n;
+
+          switch (n)
+          {
+            case 8: SKIV_JPEG_IDCT8     (coef, comp.q, out, plane.stride); break;
+            case 4: SKIV_JPEG_IDCTN <4> (coef, comp.q, out, plane.stride); break;
+            case 2: SKIV_JPEG_IDCTN <2> (coef, comp.q, out, plane.stride); break;
+            case 1: SKIV_JPEG_IDCT1     (coef, comp.q, out, plane.stride); break;
+          }
+        }
+      }
+    }
+
+    std::vector <uint16_t> vertical (out_width + 32);
+    std::vector <uint8_t>  upsampled [3];
+
+    for (auto& row : upsampled)
+      row.resize (out_width + 32);
+
+    for (size_t y = y0; y < y1; ++y)
+    {
+      const uint8_t* rows [3] = { };
+
+      for (int c = 0; c < jpeg->components; ++c)
+      {
+        const skiv_jpeg_component_s& comp  = jpeg->comp [c];
+        const plane_s&               plane = planes [c];
+
+        const bool up_h = comp.fh < jpeg->hmax,
+                   up_v = comp.fv < jpeg->vmax;
+
+        if (! (up_h || up_v))
+        {
+          rows [c] = plane.row (y);
+          continue;
+        }
+
+        // Triangle filter: 3/4 of the nearer sample plus 1/4 of the farther,
+        //   in both directions; t holds 4x (or 16x for both) the sum
+        const size_t   width = up_h ? comp.width : out_width;
+        const size_t   near  = up_v ? std::min (y / 2, comp.height - 1) : y;
+        const size_t   far   = up_v ? std::min (comp.height - 1, (y & 1) ? near + 1 : (near > 0 ? near - 1 : 0)) : y;
+        const uint8_t* pn    = plane.row (near);
+        const uint8_t* pf    = plane.row (far);
+
+        if (up_v)
+        {
+          for (size_t x = 0; x < width; ++x)
+            vertical [x] = static_cast <uint16_t> (3 * pn [x] + pf [x]);
+        }
+
+        else
+        {
+          for (size_t x = 0; x < width; ++x)
+            vertical [x] = static_cast <uint16_t> (4 * pn [x]);
+        }
+
+        uint8_t* out = upsampled [c].data ();
+
+        if (up_h)
+          SKIV_JPEG_UpsampleRow (vertical.data (), width, out, out_width);
+
+        else
+        {
+          for (size_t x = 0; x < out_width; ++x)
+            out [x] = static_cast <uint8_t> ((vertical [x] + 2) >> 2);
+        }
+
+        rows [c] = out;
+      }
+
+      SKIV_JPEG_ConvertRow (rows [0], rows [1], rows [2], jpeg->components, jpeg->rgb, bgr,
+                            dst.pixels + y * dst.rowPitch, out_width);
+    }
+  };
+
+  static const size_t
+    num_cpus = std::max (1U, std::thread::hardware_concurrency ());
+
+  const size_t band  = std::max <size_t> (2, jpeg->mcus_y / (num_cpus * 4));
+  const size_t bands = (jpeg->mcus_y + band - 1) / band;
+
+  bool intact = true;
+
+  if (expected > 1 && segments.size () > 1)
+  {
+    std::vector <uint8_t> ok (expected);
+
+    concurrency::parallel_for (size_t (0), expected, [&](size_t segment)
+    {
+      ok [segment] =
+        _DecodeSegment (segment, segment * interval, std::min (total_mcus, (segment + 1) * interval));
+    });
+
+    concurrency::parallel_for (size_t (0), bands, [&](size_t b)
+    {
+      _ProcessBand (b * band, std::min (jpeg->mcus_y, (b + 1) * band));
+    });
+
+    intact = std::all_of (ok.begin (), ok.end (), [](uint8_t segment_ok) { return segment_ok != 0; });
+  }
+
+  // Serial Huffman decoding; every band is processed as soon as the MCU row
+  //   below it (for the upsampling filter) has been decoded
+  else
+  {
+    skiv_jpeg_scan_s        scan;
+    concurrency::task_group tasks;
+
+    size_t next_band = 0;
+
+    for (size_t my = 0; my < jpeg->mcus_y; ++my)
+    {
+      const size_t row_end = (my + 1) * jpeg->mcus_x;
+
+      for (size_t mcu = my * jpeg->mcus_x; mcu < row_end; )
+      {
+        // Restart markers reset the bit stream and the DC predictors
+        if (mcu % interval == 0)
+        {
+          const size_t segment = mcu / interval;
+
+          intact &= ! scan.failed;
+          scan    = { };
+
+          if (segment < segments.size ())
+            scan.bits = { .pos = segments [segment].begin, .end = segments [segment].end };
+        }
+
+        const size_t last =
+          std::min (row_end, (mcu / interval + 1) * interval);
+
+        SKIV_JPEG_DecodeMCUs (*jpeg, scan, mcu, last);
+
+        mcu = last;
+      }
+
+      while (next_band < bands && (std::min (jpeg->mcus_y, (next_band + 1) * band) <= my || my + 1 == jpeg->mcus_y))
+      {
+        const size_t m0 = next_band * band,
+                     m1 = std::min (jpeg->mcus_y, m0 + band);
+
+        tasks.run ([&_ProcessBand, m0, m1] { _ProcessBand (m0, m1); });
+
+        next_band++;
+      }
+    }
+
+    tasks.wait ();
+
+    intact &= ! scan.failed;
+  }
+
+  PLOG_WARNING_IF (! intact) << "JPEG has corrupt entropy-coded data, the affected blocks were left blank";
+
+  return S_OK;
+}
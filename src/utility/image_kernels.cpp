@@ -0,0 +1,2815 @@
+#include "utility/image.h"
+#include "utility/trace.h"
+#include "tabs/viewer.h"
+#include <plog/Log.h>
+#include <DirectXPackedVector.h>
+#include <immintrin.h>
+#include <intrin.h>
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <ppl.h>
+
+// Pixel kernels operating directly on DirectX::Image rows
+//
+//   These bypass DirectX::EvaluateImage / TransformImage (which go through
+//     a scalar XMVECTOR scanline per row) and process 8 pixels at a time
+//       in structure-of-arrays form across all cores.
+
+#pragma region Helpers
+
+// Splits an image into bands of rows that are large enough to amortize the
+//   scheduling overhead, but small enough to keep every core busy.
+static size_t
+SKIV_Kernel_GetBandHeight (size_t height)
+{
+  static const size_t
+    num_cpus = std::max (1U, std::thread::hardware_concurrency ());
+
+  return
+    std::max <size_t> (1, height / (num_cpus * 4));
+}
+
+// Transposes 8 RGBA pixels (two per register) into R, G and B vectors.
+//
+//   Lanes are permuted (0,2,4,6,1,3,5,7), which is irrelevant to anything
+//     that reduces the result rather than writing it back.
+static __forceinline void
+SKIV_Kernel_DeinterleaveRGB8 (__m256 p0, __m256 p1, __m256 p2, __m256 p3, __m256& r, __m256& g, __m256& b)
+{
+  const __m256 t0 = _mm256_unpacklo_ps (p0, p1); // r0 r2 g0 g2 | r1 r3 g1 g3
+  const __m256 t1 = _mm256_unpackhi_ps (p0, p1); // b0 b2 a0 a2 | b1 b3 a1 a3
+  const __m256 t2 = _mm256_unpacklo_ps (p2, p3); // r4 r6 g4 g6 | r5 r7 g5 g7
+  const __m256 t3 = _mm256_unpackhi_ps (p2, p3); // b4 b6 a4 a6 | b5 b7 a5 a7
+
+  r = _mm256_shuffle_ps (t0, t2, _MM_SHUFFLE (1, 0, 1, 0));
+  g = _mm256_shuffle_ps (t0, t2, _MM_SHUFFLE (3, 2, 3, 2));
+  b = _mm256_shuffle_ps (t1, t3, _MM_SHUFFLE (1, 0, 1, 0));
+}
+
+static __forceinline void
+SKIV_Kernel_LoadRGB8_FP32 (const float* pixels, __m256& r, __m256& g, __m256& b)
+{
+  SKIV_Kernel_DeinterleaveRGB8 (
+    _mm256_loadu_ps (pixels +  0), _mm256_loadu_ps (pixels +  8),
+    _mm256_loadu_ps (pixels + 16), _mm256_loadu_ps (pixels + 24), r, g, b
+  );
+}
+
+static __forceinline void
+SKIV_Kernel_LoadRGB8_FP16 (const uint16_t* pixels, __m256& r, __m256& g, __m256& b)
+{
+  SKIV_Kernel_DeinterleaveRGB8 (
+    _mm256_cvtph_ps (_mm_loadu_si128 ((const __m128i *)(pixels +  0))),
+    _mm256_cvtph_ps (_mm_loadu_si128 ((const __m128i *)(pixels +  8))),
+    _mm256_cvtph_ps (_mm_loadu_si128 ((const __m128i *)(pixels + 16))),
+    _mm256_cvtph_ps (_mm_loadu_si128 ((const __m128i *)(pixels + 24))), r, g, b
+  );
+}
+
+#pragma endregion
+
+#pragma region Gamut Classification
+
+// A gamut boundary expressed as three half-planes in Rec. 709 space:
+//
+//   A pixel lies within the gamut when every channel of (M * rgb) is >= 0,
+//     so each row of the Rec. 709 -> gamut matrix is one half-plane test and
+//       no actual conversion to the target space needs to happen.
+struct skiv_gamut_planes_s {
+  __m256 r [3];
+  __m256 g [3];
+  __m256 b [3];
+
+  skiv_gamut_planes_s (const DirectX::XMMATRIX& from709) // Transposed
+  {
+    DirectX::XMFLOAT4X4     m;
+    DirectX::XMStoreFloat4x4 (&m, from709);
+
+    for (int k = 0; k < 3; ++k)
+    {
+      r [k] = _mm256_set1_ps (m.m [0][k]);
+      g [k] = _mm256_set1_ps (m.m [1][k]);
+      b [k] = _mm256_set1_ps (m.m [2][k]);
+    }
+  }
+
+  // Channel k of (M * rgb)
+  __forceinline __m256 dot (int k, __m256 vR, __m256 vG, __m256 vB) const
+  {
+    return
+      _mm256_fmadd_ps (vB, b [k], _mm256_fmadd_ps (vG, g [k], _mm256_mul_ps (vR, r [k])));
+  }
+
+  __forceinline __m256 contains (__m256 vR, __m256 vG, __m256 vB) const
+  {
+    const __m256 zero = _mm256_setzero_ps ();
+
+    __m256 inside =
+      _mm256_cmp_ps (dot (0, vR, vG, vB), zero, _CMP_GE_OQ);
+    inside = _mm256_and_ps (inside,
+      _mm256_cmp_ps (dot (1, vR, vG, vB), zero, _CMP_GE_OQ));
+    inside = _mm256_and_ps (inside,
+      _mm256_cmp_ps (dot (2, vR, vG, vB), zero, _CMP_GE_OQ));
+
+    return inside;
+  }
+};
+
+// Near-black pixels are counted as Rec. 709 regardless of their chromaticity
+#define FP16_MIN 0.0005f
+
+struct skiv_gamut_counts_s {
+  uint64_t rec_709   = 0;
+  uint64_t dci_p3    = 0;
+  uint64_t rec_2020  = 0;
+  uint64_t ap1       = 0;
+  uint64_t ap0       = 0;
+  uint64_t undefined = 0;
+};
+
+// Classifies a single pixel, matching the order of the vectorized path
+//   (Rec. 709 -> DCI-P3 -> Rec. 2020 -> AP1 -> AP0); used for row tails.
+static void
+SKIV_Image_ClassifyGamutScalar (float r, float g, float b, skiv_gamut_counts_s& counts)
+{
+  using namespace DirectX;
+
+  const XMVECTOR v =
+    XMVectorSet (r, g, b, 1.0f);
+
+  auto _Inside = [&](const XMMATRIX& m) -> bool
+  {
+    uint32_t                xm_test_all = 0x0;
+    XMVectorGreaterOrEqualR (&xm_test_all, XMVector3Transform (v, m), g_XMZero);
+    return
+      XMComparisonAllTrue   ( xm_test_all);
+  };
+
+  if ((r >= 0.0f && g >= 0.0f && b >= 0.0f) ||
+      XMVectorGetY (XMVector3Transform (v, c_from709toXYZ)) < FP16_MIN)
+                                          counts.rec_709++;
+  else if (_Inside (c_from709toDCIP3))    counts.dci_p3++;
+  else if (_Inside (c_from709to2020))     counts.rec_2020++;
+  else if (_Inside (c_from709toAP1))      counts.ap1++;
+  else if (_Inside (c_from709toAP0))      counts.ap0++;
+  else                                    counts.undefined++;
+}
+
+skiv_image_gamut_s::pixel_samples_s
+SKIV_Image_ClassifyGamut (const DirectX::Image& image)
+{
+  SKIV_TRACE_SCOPE ("ClassifyGamut");
+
+  skiv_image_gamut_s::pixel_samples_s
+    samples = { };
+
+  const bool fp16 = (image.format == DXGI_FORMAT_R16G16B16A16_FLOAT);
+  const bool fp32 = (image.format == DXGI_FORMAT_R32G32B32A32_FLOAT);
+
+  if ((! fp16 && ! fp32) || image.pixels == nullptr)
+  {
+    PLOG_ERROR << "Gamut classification requires an FP16 or FP32 RGBA image!";
+    return samples;
+  }
+
+  static const skiv_gamut_planes_s planes_p3   (c_from709toDCIP3);
+  static const skiv_gamut_planes_s planes_2020 (c_from709to2020);
+  static const skiv_gamut_planes_s planes_ap1  (c_from709toAP1);
+  static const skiv_gamut_planes_s planes_ap0  (c_from709toAP0);
+
+  // Y row of the Rec. 709 -> XYZ matrix
+  static const skiv_gamut_planes_s planes_xyz  (c_from709toXYZ);
+
+  const __m256 lum_r   = planes_xyz.r [1];
+  const __m256 lum_g   = planes_xyz.g [1];
+  const __m256 lum_b   = planes_xyz.b [1];
+  const __m256 lum_min = _mm256_set1_ps (FP16_MIN);
+
+  const size_t width  = image.width;
+  const size_t height = image.height;
+  const size_t band   = SKIV_Kernel_GetBandHeight (height);
+  const size_t bands  = (height + band - 1) / band;
+
+  concurrency::combinable <skiv_gamut_counts_s> thread_counts;
+
+  concurrency::parallel_for (size_t (0), bands, [&](size_t band_idx)
+  {
+    skiv_gamut_counts_s& counts =
+      thread_counts.local ();
+
+    const size_t y_begin =                       band_idx * band;
+    const size_t y_end   = std::min (height, y_begin + band);
+
+    const __m256 zero = _mm256_setzero_ps ();
+
+    for (size_t y = y_begin; y < y_end; ++y)
+    {
+      const uint8_t* row =
+        image.pixels + y * image.rowPitch;
+
+      size_t x = 0;
+
+      for (; x + 8 <= width; x += 8)
+      {
+        __m256 r, g, b;
+
+        if (fp16) SKIV_Kernel_LoadRGB8_FP16 (reinterpret_cast <const uint16_t *> (row) + x * 4, r, g, b);
+        else      SKIV_Kernel_LoadRGB8_FP32 (reinterpret_cast <const float    *> (row) + x * 4, r, g, b);
+
+        const __m256 lum =
+          _mm256_fmadd_ps (b, lum_b, _mm256_fmadd_ps (g, lum_g, _mm256_mul_ps (r, lum_r)));
+
+        // Rec. 709 is the common case for nearly every image, and needs no
+        //   matrix math at all; skip the remaining tests when all 8 pass.
+        const __m256 in_709 =
+          _mm256_or_ps (
+            _mm256_and_ps (_mm256_cmp_ps (r, zero, _CMP_GE_OQ),
+            _mm256_and_ps (_mm256_cmp_ps (g, zero, _CMP_GE_OQ),
+                           _mm256_cmp_ps (b, zero, _CMP_GE_OQ))),
+                           _mm256_cmp_ps (lum, lum_min, _CMP_LT_OQ) );
+
+        int remaining =
+          ~_mm256_movemask_ps (in_709) & 0xFF;
+
+        counts.rec_709 += 8 - __popcnt (remaining);
+
+        if (remaining == 0)
+          continue;
+
+        int inside;
+
+        inside          = _mm256_movemask_ps (planes_p3.contains   (r, g, b)) & remaining;
+        counts.dci_p3   += __popcnt (inside);
+        remaining       &= ~inside;
+
+        if (remaining == 0)
+          continue;
+
+        inside          = _mm256_movemask_ps (planes_2020.contains (r, g, b)) & remaining;
+        counts.rec_2020 += __popcnt (inside);
+        remaining       &= ~inside;
+
+        if (remaining == 0)
+          continue;
+
+        inside          = _mm256_movemask_ps (planes_ap1.contains  (r, g, b)) & remaining;
+        counts.ap1      += __popcnt (inside);
+        remaining       &= ~inside;
+
+        if (remaining == 0)
+          continue;
+
+        inside           = _mm256_movemask_ps (planes_ap0.contains (r, g, b)) & remaining;
+        counts.ap0       += __popcnt (inside);
+        remaining        &= ~inside;
+
+        counts.undefined += __popcnt (remaining);
+      }
+
+      for (; x < width; ++x)
+      {
+        float rgb [4];
+
+        if (fp16)
+        {
+          const uint16_t* p =
+            reinterpret_cast <const uint16_t *> (row) + x * 4;
+
+          rgb [0] = DirectX::PackedVector::XMConvertHalfToFloat (p [0]);
+          rgb [1] = DirectX::PackedVector::XMConvertHalfToFloat (p [1]);
+          rgb [2] = DirectX::PackedVector::XMConvertHalfToFloat (p [2]);
+        }
+
+        else
+          memcpy (rgb, reinterpret_cast <const float *> (row) + x * 4, sizeof (float) * 3);
+
+        SKIV_Image_ClassifyGamutScalar (rgb [0], rgb [1], rgb [2], counts);
+      }
+    }
+  });
+
+  skiv_gamut_counts_s total = { };
+
+  thread_counts.combine_each ([&](const skiv_gamut_counts_s& counts)
+  {
+    total.rec_709   += counts.rec_709;
+    total.dci_p3    += counts.dci_p3;
+    total.rec_2020  += counts.rec_2020;
+    total.ap1       += counts.ap1;
+    total.ap0       += counts.ap0;
+    total.undefined += counts.undefined;
+  });
+
+  samples.rec_709   = static_cast <uint32_t> (total.rec_709);
+  samples.dci_p3    = static_cast <uint32_t> (total.dci_p3);
+  samples.rec_2020  = static_cast <uint32_t> (total.rec_2020);
+  samples.ap1       = static_cast <uint32_t> (total.ap1);
+  samples.ap0       = static_cast <uint32_t> (total.ap0);
+  samples.undefined = static_cast <uint32_t> (total.undefined);
+  samples.total     = static_cast <uint32_t> (width * height);
+
+  return samples;
+}
+
+#pragma endregion
+
+#pragma region Light Levels
+
+struct skiv_light_accum_s {
+  float  max_rgb [3] = { 0.0f, 0.0f, 0.0f };
+  float  max_lum     =       0.0f;
+  float  min_lum     = 5240320.0f;
+  double lum_accum   =        0.0; // Sum of the average luminance of each scanline
+};
+
+// MaxCLL, minimum / maximum / average luminance and the 99.94th percentile of
+//   an FP16 or FP32 scRGB image, in two banded passes over the rows; the second
+//     histograms luminance between the clamped extremes of the first.
+//
+//   NaN pixels are ignored by the extremes and the average, and count as black
+//     in the histogram.
+skiv_image_light_s
+SKIV_Image_MeasureLight (const DirectX::Image& image)
+{
+  SKIV_TRACE_SCOPE ("MeasureLight");
+
+  skiv_image_light_s light;
+
+  const bool fp16 = (image.format == DXGI_FORMAT_R16G16B16A16_FLOAT);
+  const bool fp32 = (image.format == DXGI_FORMAT_R32G32B32A32_FLOAT);
+
+  if ((! fp16 && ! fp32) || image.pixels == nullptr || image.width == 0 || image.height == 0)
+  {
+    PLOG_ERROR << "Light level measurement requires an FP16 or FP32 RGBA image!";
+    return light;
+  }
+
+  // Y row of the Rec. 709 -> XYZ matrix
+  DirectX::XMFLOAT4X4      to_xyz;
+  DirectX::XMStoreFloat4x4 (&to_xyz, c_from709toXYZ);
+
+  const float lum_r = to_xyz.m [0][1];
+  const float lum_g = to_xyz.m [1][1];
+  const float lum_b = to_xyz.m [2][1];
+
+  const size_t width  = image.width;
+  const size_t height = image.height;
+  const size_t band   = SKIV_Kernel_GetBandHeight (height);
+  const size_t bands  = (height + band - 1) / band;
+
+  concurrency::combinable <std::vector <float>> thread_scanline;
+
+  // FP32 rows are read in place, FP16 rows are widened into a per-thread scanline
+  auto _GetRow = [&](size_t y) -> const float*
+  {
+    const uint8_t* row =
+      image.pixels + y * image.rowPitch;
+
+    if (fp32)
+      return reinterpret_cast <const float *> (row);
+
+    std::vector <float>& scanline =
+      thread_scanline.local ();
+
+    scanline.resize (width * 4);
+
+    SKIV_Image_UnpackFP16toFP32 (reinterpret_cast <const uint16_t *> (row), scanline.data (), width * 4);
+
+    return scanline.data ();
+  };
+
+  concurrency::combinable <skiv_light_accum_s> thread_accum;
+
+  concurrency::parallel_for (size_t (0), bands, [&](size_t band_idx)
+  {
+    skiv_light_accum_s& accum =
+      thread_accum.local ();
+
+    const size_t y_begin =                       band_idx * band;
+    const size_t y_end   = std::min (height, y_begin + band);
+
+    for (size_t y = y_begin; y < y_end; ++y)
+    {
+      const float* pixels = _GetRow (y);
+      double       scanline_lum = 0.0;
+
+      for (size_t x = 0; x < width; ++x, pixels += 4)
+      {
+        for (int k = 0; k < 3; ++k)
+          if (pixels [k] > accum.max_rgb [k])
+              accum.max_rgb [k] = pixels [k];
+
+        const float lum =
+          pixels [0] * lum_r + pixels [1] * lum_g + pixels [2] * lum_b;
+
+        if (lum > accum.max_lum) accum.max_lum = lum;
+        if (lum < accum.min_lum) accum.min_lum = lum;
+        if (lum > 0.0f)          scanline_lum += lum;
+      }
+
+      accum.lum_accum +=
+        scanline_lum / static_cast <double> (width);
+    }
+  });
+
+  skiv_light_accum_s total;
+
+  thread_accum.combine_each ([&](const skiv_light_accum_s& accum)
+  {
+    for (int k = 0; k < 3; ++k)
+      total.max_rgb [k] = std::max (total.max_rgb [k], accum.max_rgb [k]);
+
+    total.max_lum    = std::max (total.max_lum, accum.max_lum);
+    total.min_lum    = std::min (total.min_lum, accum.min_lum);
+    total.lum_accum += accum.lum_accum;
+  });
+
+  // 0 nits - 10k nits (appropriate for screencap, but not HDR photography)
+  const float min_lum   = std::clamp (total.min_lum, 0.0f,    125.0f);
+  const float max_lum   = std::clamp (total.max_lum, min_lum, 125.0f);
+  const float lum_range = max_lum - min_lum;
+  const float bin_size  = lum_range / 65536.0f;
+
+  concurrency::combinable <std::vector <uint32_t>> thread_freq;
+
+  concurrency::parallel_for (size_t (0), bands, [&](size_t band_idx)
+  {
+    std::vector <uint32_t>& freq =
+      thread_freq.local ();
+
+    if (freq.empty ())
+        freq.resize (65536, 0);
+
+    const size_t y_begin =                       band_idx * band;
+    const size_t y_end   = std::min (height, y_begin + band);
+
+    for (size_t y = y_begin; y < y_end; ++y)
+    {
+      const float* pixels = _GetRow (y);
+
+      for (size_t x = 0; x < width; ++x, pixels += 4)
+      {
+        const float lum =
+          pixels [0] * lum_r + pixels [1] * lum_g + pixels [2] * lum_b;
+
+        const float bin = (lum > 0.0f && bin_size > 0.0f) ?
+          std::roundf ((lum - min_lum) / bin_size)        : 0.0f;
+
+        freq [static_cast <size_t> (std::clamp (bin, 0.0f, 65535.0f))]++;
+      }
+    }
+  });
+
+  std::vector <uint64_t> luminance_freq (65536, 0);
+
+  thread_freq.combine_each ([&](const std::vector <uint32_t>& freq)
+  {
+    for (size_t i = 0; i < freq.size (); ++i)
+      luminance_freq [i] += freq [i];
+  });
+
+  float        max_lum99 = 0.0f;
+  double       percent   = 100.0;
+  const double img_size  = static_cast <double> (width) *
+                           static_cast <double> (height);
+
+  for (int i = 65535; i >= 0; --i)
+  {
+    percent -=
+      100.0 * (static_cast <double> (luminance_freq [i]) / img_size);
+
+    if (percent <= 99.94)
+    {
+      max_lum99 =
+        min_lum + (lum_range * (static_cast <float> (i) / 65536.0f));
+
+      PLOG_INFO << "99.94th percentile luminance: " << 80.0f * max_lum99 << " nits";
+
+      break;
+    }
+  }
+
+  // Use the maximum luminance if for some reason the percentile calc failed
+  if (max_lum99 <= 0.01f)
+      max_lum99  = max_lum;
+
+  const float max_cll =
+    std::max ({ total.max_rgb [0], total.max_rgb [1], total.max_rgb [2] });
+
+  light.max_cll      = max_cll;
+  light.max_cll_name = max_cll == total.max_rgb [0] ? 'R' :
+                       max_cll == total.max_rgb [1] ? 'G' :
+                                                      'B';
+  light.max_nits     = std::max (0.0f, total.max_lum * 80.0f); // scRGB
+  light.min_nits     = std::max (0.0f, total.min_lum * 80.0f); // scRGB
+  light.p99_nits     = std::max (0.0f, max_lum99     * 80.0f); // scRGB
+
+  // We use the sum of averages per-scanline to help avoid overflow
+  light.avg_nits     = static_cast <float> (80.0 *
+    (total.lum_accum / static_cast <double> (height)));
+
+  return light;
+}
+
+#pragma endregion
+
+#pragma region Half-Float Conversion
+
+// Portable IEEE 754 binary32 <-> binary16 conversion (round-to-nearest-even),
+//   used on CPUs without F16C and for row tails shorter than one vector.
+static uint16_t
+SKIV_Kernel_FloatToHalf (float value)
+{
+  uint32_t bits;
+  memcpy (&bits, &value, sizeof (float));
+
+  const uint32_t sign = (bits >> 16) & 0x8000;
+  const uint32_t abs  =  bits        & 0x7FFFFFFF;
+
+  // NaN (keep it quiet) / Inf
+  if (abs >= 0x7F800000)
+    return static_cast <uint16_t> (sign | 0x7C00 | (abs > 0x7F800000 ? 0x200 | ((abs >> 13) & 0x3FF) : 0));
+
+  // Overflows to Inf
+  if (abs >= 0x477FF000)
+    return static_cast <uint16_t> (sign | 0x7C00);
+
+  // Subnormal half (or zero)
+  if (abs < 0x38800000)
+  {
+    if (abs < 0x33000000)
+      return static_cast <uint16_t> (sign);
+
+    const uint32_t mant  = (abs & 0x7FFFFF) | 0x800000;
+    const uint32_t shift = 126 - (abs >> 23);
+    const uint32_t half  = mant >> shift;
+    const uint32_t rem   = mant & ((1U << shift) - 1);
+    const uint32_t mid   = 1U << (shift - 1);
+
+    return static_cast <uint16_t> (sign | (half + ((rem > mid || (rem == mid && (half & 1))) ? 1 : 0)));
+  }
+
+  // Normal; rebias the exponent and round the mantissa to 10 bits
+  const uint32_t rebased = abs - 0x38000000;
+
+  return static_cast <uint16_t> (sign | ((rebased + 0xFFF + ((rebased >> 13) & 1)) >> 13));
+}
+
+static float
+SKIV_Kernel_HalfToFloat (uint16_t value)
+{
+  const uint32_t sign = (value & 0x8000U) << 16;
+  const uint32_t exp  = (value & 0x7C00U) >> 10;
+        uint32_t mant = (value & 0x03FFU);
+        uint32_t bits;
+
+  if (exp == 0x1F) // Inf / NaN (quieted, same as VCVTPH2PS)
+    bits = sign | 0x7F800000 | (mant << 13) | (mant != 0 ? 0x400000 : 0);
+
+  else if (exp != 0)
+    bits = sign | ((exp + 112) << 23) | (mant << 13);
+
+  else if (mant == 0)
+    bits = sign;
+
+  else // Subnormal half, normalize it
+  {
+    uint32_t e = 113;
+
+    while ((mant & 0x400) == 0)
+    {
+      mant <<= 1;
+      --e;
+    }
+
+    bits = sign | (e << 23) | ((mant & 0x3FF) << 13);
+  }
+
+  float  result;
+  memcpy (&result, &bits, sizeof (float));
+  return result;
+}
+
+static void
+SKIV_Kernel_PackFP16_Scalar (const float* src, uint16_t* dst, size_t count)
+{
+  for (size_t i = 0; i < count; ++i)
+    dst [i] = SKIV_Kernel_FloatToHalf (src [i]);
+}
+
+static void
+SKIV_Kernel_UnpackFP16_Scalar (const uint16_t* src, float* dst, size_t count)
+{
+  for (size_t i = 0; i < count; ++i)
+    dst [i] = SKIV_Kernel_HalfToFloat (src [i]);
+}
+
+static void
+SKIV_Kernel_PackFP16_F16C (const float* src, uint16_t* dst, size_t count)
+{
+  size_t i = 0;
+
+  for (; i + 16 <= count; i += 16)
+  {
+    _mm_storeu_si128 ((__m128i *)(dst + i),     _mm256_cvtps_ph (_mm256_loadu_ps (src + i),     _MM_FROUND_TO_NEAREST_INT));
+    _mm_storeu_si128 ((__m128i *)(dst + i + 8), _mm256_cvtps_ph (_mm256_loadu_ps (src + i + 8), _MM_FROUND_TO_NEAREST_INT));
+  }
+
+  for (; i + 8 <= count; i += 8)
+    _mm_storeu_si128 ((__m128i *)(dst + i),     _mm256_cvtps_ph (_mm256_loadu_ps (src + i),     _MM_FROUND_TO_NEAREST_INT));
+
+  SKIV_Kernel_PackFP16_Scalar (src + i, dst + i, count - i);
+}
+
+static void
+SKIV_Kernel_UnpackFP16_F16C (const uint16_t* src, float* dst, size_t count)
+{
+  size_t i = 0;
+
+  for (; i + 16 <= count; i += 16)
+  {
+    _mm256_storeu_ps (dst + i,     _mm256_cvtph_ps (_mm_loadu_si128 ((const __m128i *)(src + i))));
+    _mm256_storeu_ps (dst + i + 8, _mm256_cvtph_ps (_mm_loadu_si128 ((const __m128i *)(src + i + 8))));
+  }
+
+  for (; i + 8 <= count; i += 8)
+    _mm256_storeu_ps (dst + i,     _mm256_cvtph_ps (_mm_loadu_si128 ((const __m128i *)(src + i))));
+
+  SKIV_Kernel_UnpackFP16_Scalar (src + i, dst + i, count - i);
+}
+
+// 512-bit VCVTPS2PH / VCVTPH2PS (AVX-512F); the tail is handled by F16C
+static void
+SKIV_Kernel_PackFP16_AVX512 (const float* src, uint16_t* dst, size_t count)
+{
+  size_t i = 0;
+
+  for (; i + 32 <= count; i += 32)
+  {
+    _mm256_storeu_si256 ((__m256i *)(dst + i),      _mm512_cvtps_ph (_mm512_loadu_ps (src + i),      _MM_FROUND_TO_NEAREST_INT));
+    _mm256_storeu_si256 ((__m256i *)(dst + i + 16), _mm512_cvtps_ph (_mm512_loadu_ps (src + i + 16), _MM_FROUND_TO_NEAREST_INT));
+  }
+
+  SKIV_Kernel_PackFP16_F16C (src + i, dst + i, count - i);
+}
+
+static void
+SKIV_Kernel_UnpackFP16_AVX512 (const uint16_t* src, float* dst, size_t count)
+{
+  size_t i = 0;
+
+  for (; i + 32 <= count; i += 32)
+  {
+    _mm512_storeu_ps (dst + i,      _mm512_cvtph_ps (_mm256_loadu_si256 ((const __m256i *)(src + i))));
+    _mm512_storeu_ps (dst + i + 16, _mm512_cvtph_ps (_mm256_loadu_si256 ((const __m256i *)(src + i + 16))));
+  }
+
+  SKIV_Kernel_UnpackFP16_F16C (src + i, dst + i, count - i);
+}
+
+using SKIV_Kernel_PackFP16_pfn   = void (*)(const float*    src, uint16_t* dst, size_t count);
+using SKIV_Kernel_UnpackFP16_pfn = void (*)(const uint16_t* src, float*    dst, size_t count);
+
+struct skiv_fp16_kernels_s {
+  SKIV_Kernel_PackFP16_pfn   pack   = SKIV_Kernel_PackFP16_Scalar;
+  SKIV_Kernel_UnpackFP16_pfn unpack = SKIV_Kernel_UnpackFP16_Scalar;
+  const char*                name   = "Scalar";
+  SKIV_FP16Kernel            kernel = SKIV_FP16Kernel_Scalar;
+  SKIV_FP16Kernel            best   = SKIV_FP16Kernel_Scalar; // What the CPU supports
+
+  void select (SKIV_FP16Kernel selected)
+  {
+    static constexpr struct {
+      SKIV_Kernel_PackFP16_pfn   pack;
+      SKIV_Kernel_UnpackFP16_pfn unpack;
+      const char*                name;
+    } table [] = {
+      { SKIV_Kernel_PackFP16_Scalar, SKIV_Kernel_UnpackFP16_Scalar, "Scalar"  },
+      { SKIV_Kernel_PackFP16_F16C,   SKIV_Kernel_UnpackFP16_F16C,   "F16C"    },
+      { SKIV_Kernel_PackFP16_AVX512, SKIV_Kernel_UnpackFP16_AVX512, "AVX-512" }
+    };
+
+    pack   = table [selected].pack;
+    unpack = table [selected].unpack;
+    name   = table [selected].name;
+    kernel = selected;
+  }
+
+  skiv_fp16_kernels_s (void)
+  {
+    int cpu_info [4] = { };
+
+    __cpuid   (cpu_info, 0);
+    const int max_leaf = cpu_info [0];
+
+    __cpuid   (cpu_info, 1);
+    const bool has_f16c    = (cpu_info [2] & (1 << 29)) != 0;
+    const bool has_osxsave = (cpu_info [2] & (1 << 27)) != 0;
+
+    // YMM state (bits 1-2) and, for AVX-512, opmask + ZMM state (bits 5-7)
+    const uint64_t xcr0 =
+      has_osxsave ? _xgetbv (0) : 0;
+
+    const bool os_avx    = (xcr0 & 0x06) == 0x06;
+    const bool os_avx512 = (xcr0 & 0xE6) == 0xE6;
+
+    bool has_avx512f = false;
+
+    if (max_leaf >= 7)
+    {
+      __cpuidex (cpu_info, 7, 0);
+      has_avx512f = (cpu_info [1] & (1 << 16)) != 0;
+    }
+
+    if (has_f16c && os_avx)
+      best = (has_avx512f && os_avx512) ? SKIV_FP16Kernel_AVX512
+                                        : SKIV_FP16Kernel_F16C;
+
+    select (best);
+
+    PLOG_INFO << "Half-float conversion kernels: " << name;
+  }
+};
+
+static skiv_fp16_kernels_s&
+SKIV_Kernel_GetFP16Kernels (void)
+{
+  static skiv_fp16_kernels_s kernels;
+  return                     kernels;
+}
+
+void
+SKIV_Image_PackFP32toFP16 (const float* src, uint16_t* dst, size_t count)
+{
+  SKIV_Kernel_GetFP16Kernels ().pack (src, dst, count);
+}
+
+void
+SKIV_Image_UnpackFP16toFP32 (const uint16_t* src, float* dst, size_t count)
+{
+  SKIV_Kernel_GetFP16Kernels ().unpack (src, dst, count);
+}
+
+SKIV_FP16Kernel
+SKIV_Image_GetFP16Kernel (void)
+{
+  return
+    SKIV_Kernel_GetFP16Kernels ().kernel;
+}
+
+bool
+SKIV_Image_SetFP16Kernel (SKIV_FP16Kernel kernel)
+{
+  auto& kernels =
+    SKIV_Kernel_GetFP16Kernels ();
+
+  if (kernel < SKIV_FP16Kernel_Scalar || kernel > kernels.best)
+    return false;
+
+  kernels.select (kernel);
+
+  return true;
+}
+
+HRESULT
+SKIV_Image_Convert (const DirectX::Image& image, DXGI_FORMAT format, DirectX::TEX_FILTER_FLAGS filter, float threshold, DirectX::ScratchImage& result)
+{
+  SKIV_TRACE_SCOPE ("Convert");
+
+  const bool to_fp16 = (image.format == DXGI_FORMAT_R32G32B32A32_FLOAT && format == DXGI_FORMAT_R16G16B16A16_FLOAT);
+  const bool to_fp32 = (image.format == DXGI_FORMAT_R16G16B16A16_FLOAT && format == DXGI_FORMAT_R32G32B32A32_FLOAT);
+
+  // Anything that is not a plain float <-> half layout change (sRGB, UNORM,
+  //   packed formats, ...) goes through DirectXTex's generic conversion.
+  if ((! to_fp16 && ! to_fp32) || image.pixels == nullptr)
+    return
+      DirectX::Convert (image, format, filter, threshold, result);
+
+  HRESULT hr =
+    result.Initialize2D (format, image.width, image.height, 1, 1);
+
+  if (FAILED (hr))
+    return hr;
+
+  const DirectX::Image* pDest =
+    result.GetImage (0, 0, 0);
+
+  const size_t count  = image.width * 4;
+  const size_t height = image.height;
+  const size_t band   = SKIV_Kernel_GetBandHeight (height);
+  const size_t bands  = (height + band - 1) / band;
+
+  const skiv_fp16_kernels_s& kernels =
+    SKIV_Kernel_GetFP16Kernels ();
+
+  concurrency::parallel_for (size_t (0), bands, [&](size_t band_idx)
+  {
+    const size_t y_begin =                       band_idx * band;
+    const size_t y_end   = std::min (height, y_begin + band);
+
+    for (size_t y = y_begin; y < y_end; ++y)
+    {
+      const uint8_t* src =  image.pixels + y *  image.rowPitch;
+            uint8_t* dst = pDest->pixels + y * pDest->rowPitch;
+
+      if (to_fp16) kernels.pack   (reinterpret_cast <const float    *> (src), reinterpret_cast <uint16_t *> (dst), count);
+      else         kernels.unpack (reinterpret_cast <const uint16_t *> (src), reinterpret_cast <float    *> (dst), count);
+    }
+  });
+
+  return S_OK;
+}
+
+#pragma endregion
+
+#pragma region Row Conversion
+
+// UNORM formats are filtered in linear light; this matters for the sRGB
+//   formats as much as for UNORM, which in practice holds sRGB content too.
+struct skiv_srgb_luts_s {
+  static constexpr size_t ENCODE_SIZE = 16384;
+
+  float   decode [256];
+  uint8_t encode [ENCODE_SIZE];
+
+  skiv_srgb_luts_s (void)
+  {
+    for (size_t i = 0; i < 256; ++i)
+    {
+      const float v = static_cast <float> (i) / 255.0f;
+
+      decode [i] = (v <= 0.04045f) ? v / 12.92f
+                                   : std::pow ((v + 0.055f) / 1.055f, 2.4f);
+    }
+
+    for (size_t i = 0; i < ENCODE_SIZE; ++i)
+    {
+      const float v = static_cast <float> (i) / static_cast <float> (ENCODE_SIZE - 1);
+
+      encode [i] = static_cast <uint8_t> (std::lround (255.0f *
+        ((v <= 0.0031308f) ? v * 12.92f
+                           : 1.055f * std::pow (v, 1.0f / 2.4f) - 0.055f)));
+    }
+  }
+};
+
+// 16-bit rows (e.g. 16 bpc PNG); the encode table is indexed by the square root
+//   of the linear value, which keeps it precise enough near black.
+struct skiv_srgb16_luts_s {
+  static constexpr size_t SIZE = 65536;
+
+  float    decode [SIZE];
+  uint16_t encode [SIZE];
+
+  skiv_srgb16_luts_s (void)
+  {
+    for (size_t i = 0; i < SIZE; ++i)
+    {
+      const float v = static_cast <float> (i) / 65535.0f;
+      const float l = v * v;
+
+      decode [i] = (v <= 0.04045f) ? v / 12.92f
+                                   : std::pow ((v + 0.055f) / 1.055f, 2.4f);
+
+      encode [i] = static_cast <uint16_t> (std::lround (65535.0f *
+        ((l <= 0.0031308f) ? l * 12.92f
+                           : 1.055f * std::pow (l, 1.0f / 2.4f) - 0.055f)));
+    }
+  }
+};
+
+static const skiv_srgb_luts_s&
+SKIV_Kernel_GetSRGBLuts (void)
+{
+  static skiv_srgb_luts_s luts;
+  return                  luts;
+}
+
+static const skiv_srgb16_luts_s&
+SKIV_Kernel_GetSRGB16Luts (void)
+{
+  static const auto luts = std::make_unique <skiv_srgb16_luts_s> ();
+  return                  *luts;
+}
+
+enum skiv_row_layout_e {
+  SKIV_Row_Unsupported,
+  SKIV_Row_RGBA8,  // RGBA / BGRA, color channels sRGB-encoded, alpha linear
+  SKIV_Row_RGBX8,  // BGRX, same but opaque: X is read as 1 and written as 255
+  SKIV_Row_RGBA16, // Same, 16 bpc
+  SKIV_Row_FP16,
+  SKIV_Row_FP32
+};
+
+static skiv_row_layout_e
+SKIV_Kernel_GetRowLayout (DXGI_FORMAT format)
+{
+  switch (format)
+  {
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+    case DXGI_FORMAT_B8G8R8A8_UNORM:
+    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+      return SKIV_Row_RGBA8;
+    case DXGI_FORMAT_B8G8R8X8_UNORM:
+    case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+      return SKIV_Row_RGBX8;
+    case DXGI_FORMAT_R16G16B16A16_UNORM:
+      return SKIV_Row_RGBA16;
+    case DXGI_FORMAT_R16G16B16A16_FLOAT:
+      return SKIV_Row_FP16;
+    case DXGI_FORMAT_R32G32B32A32_FLOAT:
+      return SKIV_Row_FP32;
+    default:
+      return SKIV_Row_Unsupported;
+  }
+}
+
+static bool
+SKIV_Kernel_IsBGRA8 (DXGI_FORMAT format)
+{
+  return format == DXGI_FORMAT_B8G8R8A8_UNORM || format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB ||
+         format == DXGI_FORMAT_B8G8R8X8_UNORM || format == DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+}
+
+// Row <-> linear RGBA float, HDR (scRGB) rows are already linear
+static void
+SKIV_Kernel_LoadRow (skiv_row_layout_e layout, const uint8_t* src, float* dst, size_t pixels)
+{
+  if (layout == SKIV_Row_FP32)
+    memcpy (dst, src, pixels * 4 * sizeof (float));
+
+  else if (layout == SKIV_Row_FP16)
+    SKIV_Kernel_GetFP16Kernels ().unpack (reinterpret_cast <const uint16_t *> (src), dst, pixels * 4);
+
+  else if (layout == SKIV_Row_RGBA16)
+  {
+    const float*    decode = SKIV_Kernel_GetSRGB16Luts ().decode;
+    const uint16_t* src16  = reinterpret_cast <const uint16_t *> (src);
+
+    for (size_t i = 0; i < pixels * 4; i += 4)
+    {
+      dst [i + 0] = decode [src16 [i + 0]];
+      dst [i + 1] = decode [src16 [i + 1]];
+      dst [i + 2] = decode [src16 [i + 2]];
+      dst [i + 3] = static_cast <float> (src16 [i + 3]) * (1.0f / 65535.0f);
+    }
+  }
+
+  else
+  {
+    const float* decode = SKIV_Kernel_GetSRGBLuts ().decode;
+    const bool   opaque = (layout == SKIV_Row_RGBX8);
+
+    for (size_t i = 0; i < pixels * 4; i += 4)
+    {
+      dst [i + 0] = decode [src [i + 0]];
+      dst [i + 1] = decode [src [i + 1]];
+      dst [i + 2] = decode [src [i + 2]];
+      dst [i + 3] = opaque ? 1.0f : static_cast <float> (src [i + 3]) * (1.0f / 255.0f);
+    }
+  }
+}
+
+static void
+SKIV_Kernel_StoreRow (skiv_row_layout_e layout, const float* src, uint8_t* dst, size_t pixels)
+{
+  if (layout == SKIV_Row_FP32)
+    memcpy (dst, src, pixels * 4 * sizeof (float));
+
+  else if (layout == SKIV_Row_FP16)
+    SKIV_Kernel_GetFP16Kernels ().pack (src, reinterpret_cast <uint16_t *> (dst), pixels * 4);
+
+  else if (layout == SKIV_Row_RGBA16)
+  {
+    const uint16_t* encode = SKIV_Kernel_GetSRGB16Luts ().encode;
+    uint16_t*       dst16  = reinterpret_cast <uint16_t *> (dst);
+
+    for (size_t i = 0; i < pixels * 4; i += 4)
+    {
+      dst16 [i + 0] = encode [static_cast <size_t> (std::sqrt (std::clamp (src [i + 0], 0.0f, 1.0f)) * 65535.0f + 0.5f)];
+      dst16 [i + 1] = encode [static_cast <size_t> (std::sqrt (std::clamp (src [i + 1], 0.0f, 1.0f)) * 65535.0f + 0.5f)];
+      dst16 [i + 2] = encode [static_cast <size_t> (std::sqrt (std::clamp (src [i + 2], 0.0f, 1.0f)) * 65535.0f + 0.5f)];
+      dst16 [i + 3] = static_cast <uint16_t> (std::clamp (src [i + 3], 0.0f, 1.0f) * 65535.0f + 0.5f);
+    }
+  }
+
+  else
+  {
+    const uint8_t* encode = SKIV_Kernel_GetSRGBLuts ().encode;
+    const bool     opaque = (layout == SKIV_Row_RGBX8);
+
+    constexpr float scale =
+      static_cast <float> (skiv_srgb_luts_s::ENCODE_SIZE - 1);
+
+    for (size_t i = 0; i < pixels * 4; i += 4)
+    {
+      dst [i + 0] = encode [static_cast <size_t> (std::clamp (src [i + 0], 0.0f, 1.0f) * scale + 0.5f)];
+      dst [i + 1] = encode [static_cast <size_t> (std::clamp (src [i + 1], 0.0f, 1.0f) * scale + 0.5f)];
+      dst [i + 2] = encode [static_cast <size_t> (std::clamp (src [i + 2], 0.0f, 1.0f) * scale + 0.5f)];
+      dst [i + 3] = opaque ? 255 : static_cast <uint8_t> (std::clamp (src [i + 3], 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+  }
+}
+
+#pragma endregion
+
+#pragma region Mipmap Generation
+
+// 2x2 box filter of two linear RGBA rows into one row of half the width;
+//   an odd trailing column of a single pixel wide source is clamped.
+static void
+SKIV_Kernel_DownsampleMipRow (const float* row0, const float* row1, float* dst, size_t src_width, size_t dst_width)
+{
+  const __m256 quarter = _mm256_set1_ps (0.25f);
+
+  size_t x = 0;
+
+  // Two destination pixels (four source pixels, two per register) at a time
+  for (; x + 2 <= dst_width && 2 * x + 4 <= src_width; x += 2)
+  {
+    const __m256 a = _mm256_add_ps (_mm256_loadu_ps (row0 + 8 * x),     _mm256_loadu_ps (row1 + 8 * x));     // p0 p1
+    const __m256 b = _mm256_add_ps (_mm256_loadu_ps (row0 + 8 * x + 8), _mm256_loadu_ps (row1 + 8 * x + 8)); // p2 p3
+
+    const __m256 even = _mm256_permute2f128_ps (a, b, 0x20); // p0 p2
+    const __m256 odd  = _mm256_permute2f128_ps (a, b, 0x31); // p1 p3
+
+    _mm256_storeu_ps (dst + 4 * x, _mm256_mul_ps (_mm256_add_ps (even, odd), quarter));
+  }
+
+  for (; x < dst_width; ++x)
+  {
+    const size_t x0 =            2 * x;
+    const size_t x1 = std::min ( 2 * x + 1, src_width - 1);
+
+    for (size_t c = 0; c < 4; ++c)
+    {
+      dst [4 * x + c] =
+        0.25f * (row0 [4 * x0 + c] + row0 [4 * x1 + c] +
+                 row1 [4 * x0 + c] + row1 [4 * x1 + c]);
+    }
+  }
+}
+
+HRESULT
+SKIV_Image_GenerateMipMaps (const DirectX::Image& image, DirectX::ScratchImage& result)
+{
+  SKIV_TRACE_SCOPE ("GenerateMipMaps");
+
+  const skiv_row_layout_e layout =
+    SKIV_Kernel_GetRowLayout (image.format);
+
+  if (layout == SKIV_Row_Unsupported || image.pixels == nullptr)
+    return
+      DirectX::GenerateMipMaps (image, DirectX::TEX_FILTER_DEFAULT, 0, result);
+
+  // Full chain, down to 1x1
+  HRESULT hr =
+    result.Initialize2D (image.format, image.width, image.height, 1, 0);
+
+  if (FAILED (hr))
+    return hr;
+
+  const size_t levels          = result.GetMetadata ().mipLevels;
+  const size_t bytes_per_pixel = DirectX::BitsPerPixel (image.format) / 8;
+
+  const DirectX::Image* pBase =
+    result.GetImage (0, 0, 0);
+
+  concurrency::parallel_for (size_t (0), image.height, [&](size_t y)
+  {
+    memcpy (pBase->pixels + y * pBase->rowPitch,
+             image.pixels + y *  image.rowPitch, image.width * bytes_per_pixel);
+  });
+
+  // Each level is built from the one above it; rows within a level are independent
+  for (size_t level = 1; level < levels; ++level)
+  {
+    const DirectX::Image* pSrc = result.GetImage (level - 1, 0, 0);
+    const DirectX::Image* pDst = result.GetImage (level,     0, 0);
+
+    const size_t height = pDst->height;
+    const size_t band   = SKIV_Kernel_GetBandHeight (height);
+    const size_t bands  = (height + band - 1) / band;
+
+    concurrency::parallel_for (size_t (0), bands, [&](size_t band_idx)
+    {
+      std::vector <float> rows ((2 * pSrc->width + pDst->width) * 4);
+
+      float* row0 = rows.data ();
+      float* row1 = row0 + pSrc->width * 4;
+      float* out  = row1 + pSrc->width * 4;
+
+      const size_t y_begin =                       band_idx * band;
+      const size_t y_end   = std::min (height, y_begin + band);
+
+      for (size_t y = y_begin; y < y_end; ++y)
+      {
+        const size_t y0 =            2 * y;
+        const size_t y1 = std::min ( 2 * y + 1, pSrc->height - 1);
+
+        SKIV_Kernel_LoadRow          (layout, pSrc->pixels + y0 * pSrc->rowPitch, row0, pSrc->width);
+        SKIV_Kernel_LoadRow          (layout, pSrc->pixels + y1 * pSrc->rowPitch, row1, pSrc->width);
+        SKIV_Kernel_DownsampleMipRow (row0, row1, out, pSrc->width, pDst->width);
+        SKIV_Kernel_StoreRow         (layout, out, pDst->pixels + y  * pDst->rowPitch,  pDst->width);
+      }
+    });
+  }
+
+  return S_OK;
+}
+
+#pragma endregion
+
+#pragma region Resampling
+
+// Separable resampling: every destination pixel is a weighted sum of a run of
+//   consecutive source pixels, first along the rows and then down the columns.
+//     The weights only depend on the two sizes and the filter, so each axis gets
+//       a filter bank computed once instead of evaluating the filter per pixel.
+struct skiv_filter_bank_s {
+  size_t               taps = 0; // Weights per destination pixel, zero-padded
+  std::vector <size_t> first;    // First source pixel of each destination pixel
+  std::vector <float>  weights;  // taps per destination pixel, normalized
+  std::vector <float>  expanded; // Same, repeated for each of the 4 channels
+};
+
+static float
+SKIV_Kernel_GetFilterRadius (SKIV_ResampleFilter filter)
+{
+  switch (filter)
+  {
+    case SKIV_ResampleFilter_Triangle: return 1.0f;
+    case SKIV_ResampleFilter_Mitchell: return 2.0f;
+    case SKIV_ResampleFilter_Lanczos3: return 3.0f;
+    default:                           return 0.5f;
+  }
+}
+
+static float
+SKIV_Kernel_EvaluateFilter (SKIV_ResampleFilter filter, float x)
+{
+  x = std::abs (x);
+
+  switch (filter)
+  {
+    case SKIV_ResampleFilter_Triangle:
+      return std::max (0.0f, 1.0f - x);
+
+    // Mitchell-Netravali, B = C = 1/3
+    case SKIV_ResampleFilter_Mitchell:
+    {
+      constexpr float B = 1.0f / 3.0f,
+                      C = 1.0f / 3.0f;
+
+      if (x < 1.0f)
+        return ( ( 12.0f -  9.0f * B -  6.0f * C) * x * x * x +
+                 (-18.0f + 12.0f * B +  6.0f * C) * x * x     +
+                 (  6.0f -  2.0f * B)                           ) / 6.0f;
+      if (x < 2.0f)
+        return ( (        -        B -  6.0f * C) * x * x * x +
+                 (          6.0f * B + 30.0f * C) * x * x     +
+                 (        -12.0f * B - 48.0f * C) * x         +
+                 (          8.0f * B + 24.0f * C)               ) / 6.0f;
+
+      return 0.0f;
+    }
+
+    case SKIV_ResampleFilter_Lanczos3:
+    {
+      if (x < 1.0e-6f)
+        return 1.0f;
+      if (x >= 3.0f)
+        return 0.0f;
+
+      const float px = DirectX::XM_PI * x;
+
+      return
+        3.0f * std::sin (px) * std::sin (px / 3.0f) / (px * px);
+    }
+
+    default:
+      return 0.0f;
+  }
+}
+
+static skiv_filter_bank_s
+SKIV_Kernel_BuildFilterBank (size_t src_size, size_t dst_size, SKIV_ResampleFilter filter)
+{
+  const double scale   = static_cast <double> (src_size) / static_cast <double> (dst_size);
+
+  // Downscaling stretches the filter over every source pixel it covers, which
+  //   is what anti-aliases; upscaling interpolates at the filter's own width.
+  const double stretch = std::max (1.0, scale);
+  const double radius  = SKIV_Kernel_GetFilterRadius (filter) * stretch;
+
+  std::vector <size_t> lo     (dst_size);
+  std::vector <size_t> offset (dst_size + 1, 0);
+  std::vector <float>  packed;
+  std::vector <double> window;
+
+  size_t taps = 1;
+
+  for (size_t i = 0; i < dst_size; ++i)
+  {
+    const double center = (static_cast <double> (i) + 0.5) * scale;
+
+    // Area weights are the exact overlap of the destination pixel's footprint
+    const double a = (filter == SKIV_ResampleFilter_Area) ? center - 0.5 * scale : center - radius;
+    const double b = (filter == SKIV_ResampleFilter_Area) ? center + 0.5 * scale : center + radius;
+
+    const size_t j0 = static_cast <size_t> (std::clamp (std::floor (a), 0.0, static_cast <double> (src_size - 1)));
+    const size_t j1 = static_cast <size_t> (std::clamp (std::ceil  (b), static_cast <double> (j0 + 1), static_cast <double> (src_size)));
+
+    window.clear ();
+
+    double sum = 0.0;
+
+    for (size_t j = j0; j < j1; ++j)
+    {
+      const double w = (filter == SKIV_ResampleFilter_Area)
+        ? std::max (0.0, std::min (b, static_cast <double> (j + 1)) - std::max (a, static_cast <double> (j)))
+        : SKIV_Kernel_EvaluateFilter (filter, static_cast <float> ((static_cast <double> (j) + 0.5 - center) / stretch));
+
+      window.push_back (w);
+      sum += w;
+    }
+
+    // Taps clipped by the edges of the image are dropped and the rest renormalized;
+    //   should nothing be left, the nearest source pixel is used as-is.
+    if (std::abs (sum) < 1.0e-8)
+    {
+      std::fill (window.begin (), window.end (), 0.0);
+      window [std::min (window.size () - 1, static_cast <size_t> (std::max (0.0, std::floor (center) - static_cast <double> (j0))))] = 1.0;
+      sum = 1.0;
+    }
+
+    // Zero weights at both ends are trimmed
+    size_t k0 = 0;
+    size_t k1 = window.size ();
+
+    while (k1 - k0 > 1 && window [k0]     == 0.0) ++k0;
+    while (k1 - k0 > 1 && window [k1 - 1] == 0.0) --k1;
+
+    for (size_t k = k0; k < k1; ++k)
+      packed.push_back (static_cast <float> (window [k] / sum));
+
+    lo     [i]     = j0 + k0;
+    offset [i + 1] = packed.size ();
+    taps           = std::max (taps, k1 - k0);
+  }
+
+  skiv_filter_bank_s bank;
+
+  bank.taps = taps;
+  bank.first   .resize (dst_size);
+  bank.weights .resize (dst_size * taps,     0.0f);
+  bank.expanded.resize (dst_size * taps * 4, 0.0f);
+
+  // Windows near the right edge are shifted left so that all taps stay in bounds
+  for (size_t i = 0; i < dst_size; ++i)
+  {
+    bank.first [i] = std::min (lo [i], src_size - taps);
+
+    const size_t shift = lo [i] - bank.first [i];
+
+    for (size_t k = offset [i]; k < offset [i + 1]; ++k)
+    {
+      const size_t tap = i * taps + shift + (k - offset [i]);
+
+      bank.weights [tap] = packed [k];
+
+      for (size_t c = 0; c < 4; ++c)
+        bank.expanded [tap * 4 + c] = packed [k];
+    }
+  }
+
+  return bank;
+}
+
+// Filtering happens on premultiplied alpha, so that transparent pixels do not
+//   bleed their (often meaningless) color into their neighbours.
+static void
+SKIV_Kernel_Premultiply (float* pixels, size_t count)
+{
+  size_t i = 0;
+
+  for (; i + 2 <= count; i += 2)
+  {
+    const __m256 v = _mm256_loadu_ps (pixels + 4 * i);
+    const __m256 a = _mm256_permute_ps (v, _MM_SHUFFLE (3, 3, 3, 3));
+
+    _mm256_storeu_ps (pixels + 4 * i, _mm256_blend_ps (_mm256_mul_ps (v, a), v, 0x88));
+  }
+
+  for (; i < count; ++i)
+  {
+    pixels [4 * i + 0] *= pixels [4 * i + 3];
+    pixels [4 * i + 1] *= pixels [4 * i + 3];
+    pixels [4 * i + 2] *= pixels [4 * i + 3];
+  }
+}
+
+// Also clamps alpha, which ringing filters can push out of [0, 1]
+static void
+SKIV_Kernel_Unpremultiply (float* pixels, size_t count)
+{
+  const __m256 zero    = _mm256_setzero_ps ();
+  const __m256 one     = _mm256_set1_ps    (1.0f);
+  const __m256 epsilon = _mm256_set1_ps    (1.0e-6f);
+
+  size_t i = 0;
+
+  for (; i + 2 <= count; i += 2)
+  {
+    const __m256 v   = _mm256_loadu_ps   (pixels + 4 * i);
+    const __m256 a   = _mm256_min_ps     (_mm256_max_ps (_mm256_permute_ps (v, _MM_SHUFFLE (3, 3, 3, 3)), zero), one);
+    const __m256 rcp = _mm256_and_ps     (_mm256_div_ps (one, a), _mm256_cmp_ps (a, epsilon, _CMP_GT_OQ));
+
+    _mm256_storeu_ps (pixels + 4 * i, _mm256_blend_ps (_mm256_mul_ps (v, rcp), a, 0x88));
+  }
+
+  for (; i < count; ++i)
+  {
+    const float a   = std::clamp (pixels [4 * i + 3], 0.0f, 1.0f);
+    const float rcp = (a > 1.0e-6f) ? 1.0f / a : 0.0f;
+
+    pixels [4 * i + 0] *= rcp;
+    pixels [4 * i + 1] *= rcp;
+    pixels [4 * i + 2] *= rcp;
+    pixels [4 * i + 3]  = a;
+  }
+}
+
+// One RGBA row through the horizontal bank, two source pixels per FMA
+static void
+SKIV_Kernel_ResampleRow (const float* src, float* dst, const skiv_filter_bank_s& bank)
+{
+  const size_t taps = bank.taps;
+
+  for (size_t x = 0; x < bank.first.size (); ++x)
+  {
+    const float* s = src                   + bank.first [x] * 4;
+    const float* w = bank.expanded.data () + x * taps       * 4;
+
+    __m256 acc = _mm256_setzero_ps ();
+    size_t k   = 0;
+
+    for (; k + 2 <= taps; k += 2)
+      acc = _mm256_fmadd_ps (_mm256_loadu_ps (s + 4 * k), _mm256_loadu_ps (w + 4 * k), acc);
+
+    __m128 sum =
+      _mm_add_ps (_mm256_castps256_ps128 (acc), _mm256_extractf128_ps (acc, 1));
+
+    if (k < taps)
+      sum = _mm_fmadd_ps (_mm_loadu_ps (s + 4 * k), _mm_loadu_ps (w + 4 * k), sum);
+
+    _mm_storeu_ps (dst + 4 * x, sum);
+  }
+}
+
+// Weighted sum of taps rows into one, 8 floats at a time
+static void
+SKIV_Kernel_ResampleColumns (const float* const* rows, const float* weights, size_t taps, float* dst, size_t count)
+{
+  size_t i = 0;
+
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256 acc = _mm256_setzero_ps ();
+
+    for (size_t k = 0; k < taps; ++k)
+      acc = _mm256_fmadd_ps (_mm256_loadu_ps (rows [k] + i), _mm256_set1_ps (weights [k]), acc);
+
+    _mm256_storeu_ps (dst + i, acc);
+  }
+
+  for (; i < count; ++i)
+  {
+    float acc = 0.0f;
+
+    for (size_t k = 0; k < taps; ++k)
+      acc += rows [k][i] * weights [k];
+
+    dst [i] = acc;
+  }
+}
+
+HRESULT
+SKIV_Image_Resample (const DirectX::Image& image, size_t width, size_t height, SKIV_ResampleFilter filter, DirectX::ScratchImage& result)
+{
+  SKIV_TRACE_SCOPE ("Resample");
+
+  if (image.pixels == nullptr || image.width == 0 || image.height == 0 || width == 0 || height == 0)
+    return E_INVALIDARG;
+
+  if (width == image.width && height == image.height)
+    return result.InitializeFromImage (image);
+
+  const skiv_row_layout_e layout =
+    SKIV_Kernel_GetRowLayout (image.format);
+
+  // Packed and planar formats are left to DirectXTex, which filters them as stored
+  if (layout == SKIV_Row_Unsupported)
+  {
+    const DirectX::TEX_FILTER_FLAGS fallback =
+      (filter == SKIV_ResampleFilter_Mitchell || filter == SKIV_ResampleFilter_Lanczos3) ? DirectX::TEX_FILTER_CUBIC
+                                                                                          : DirectX::TEX_FILTER_TRIANGLE;
+    return
+      DirectX::Resize (image, width, height, fallback | DirectX::TEX_FILTER_FORCE_NON_WIC, result);
+  }
+
+  HRESULT hr =
+    result.Initialize2D (image.format, width, height, 1, 1);
+
+  if (FAILED (hr))
+    return hr;
+
+  const skiv_filter_bank_s h_bank = SKIV_Kernel_BuildFilterBank (image.width,  width,  filter);
+  const skiv_filter_bank_s v_bank = SKIV_Kernel_BuildFilterBank (image.height, height, filter);
+
+  const DirectX::Image* pDest =
+    result.GetImage (0, 0, 0);
+
+  const size_t band  = SKIV_Kernel_GetBandHeight (height);
+  const size_t bands = (height + band - 1) / band;
+
+  // Each band resamples the source rows it needs horizontally into a private
+  //   buffer, so bands overlap by a few rows but never wait on each other.
+  concurrency::parallel_for (size_t (0), bands, [&](size_t band_idx)
+  {
+    const size_t y_begin =                       band_idx * band;
+    const size_t y_end   = std::min (height, y_begin + band);
+
+    const size_t src_begin = v_bank.first [y_begin];
+    const size_t src_end   = v_bank.first [y_end - 1] + v_bank.taps;
+
+    std::vector <float>         src_row (image.width * 4);
+    std::vector <float>         out_row (width       * 4);
+    std::vector <float>         rows    ((src_end - src_begin) * width * 4);
+    std::vector <const float *> taps    (v_bank.taps);
+
+    for (size_t y = src_begin; y < src_end; ++y)
+    {
+      SKIV_Kernel_LoadRow     (layout, image.pixels + y * image.rowPitch, src_row.data (), image.width);
+      SKIV_Kernel_Premultiply (src_row.data (), image.width);
+      SKIV_Kernel_ResampleRow (src_row.data (), rows.data () + (y - src_begin) * width * 4, h_bank);
+    }
+
+    for (size_t y = y_begin; y < y_end; ++y)
+    {
+      for (size_t k = 0; k < v_bank.taps; ++k)
+        taps [k] = rows.data () + (v_bank.first [y] + k - src_begin) * width * 4;
+
+      SKIV_Kernel_ResampleColumns (taps.data (), v_bank.weights.data () + y * v_bank.taps, v_bank.taps, out_row.data (), width * 4);
+      SKIV_Kernel_Unpremultiply   (out_row.data (), width);
+      SKIV_Kernel_StoreRow        (layout, out_row.data (), pDest->pixels + y * pDest->rowPitch, width);
+    }
+  });
+
+  return S_OK;
+}
+
+void
+SKIV_Image_GetExportSize (size_t width, size_t height, float percent, size_t max_width, size_t max_height,
+                          size_t& export_width, size_t& export_height)
+{
+  double scale =
+    std::clamp (static_cast <double> (percent) / 100.0, 0.0, 1.0);
+
+  if (max_width  != 0) scale = std::min (scale, static_cast <double> (max_width)  / static_cast <double> (width));
+  if (max_height != 0) scale = std::min (scale, static_cast <double> (max_height) / static_cast <double> (height));
+
+  export_width  = std::max (size_t { 1 }, static_cast <size_t> (std::round (static_cast <double> (width)  * scale)));
+  export_height = std::max (size_t { 1 }, static_cast <size_t> (std::round (static_cast <double> (height) * scale)));
+}
+
+HRESULT
+SKIV_Image_ResizeForExport (const DirectX::Image& image, float percent, size_t max_width, size_t max_height, DirectX::ScratchImage& result)
+{
+  size_t width  = 0,
+         height = 0;
+
+  SKIV_Image_GetExportSize (image.width, image.height, percent, max_width, max_height, width, height);
+
+  if (width >= image.width && height >= image.height)
+    return S_FALSE;
+
+  // Lanczos is the sharpest, but rings visibly around HDR highlights that
+  //   are orders of magnitude brighter than their surroundings.
+  const SKIV_ResampleFilter filter =
+    (DirectX::FormatDataType (image.format) == DirectX::FORMAT_TYPE_FLOAT) ? SKIV_ResampleFilter_Mitchell
+                                                                           : SKIV_ResampleFilter_Lanczos3;
+
+  PLOG_INFO << "Resizing " << image.width << "x" << image.height << " image to " << width << "x" << height << " for export";
+
+  return
+    SKIV_Image_Resample (image, width, height, filter, result);
+}
+
+#pragma endregion
+
+#pragma region HDR Visualization
+
+// CPU reference of the HDR visualizations and tonemapping in imgui_pix_shader.hlsl
+//
+//   Every step mirrors the shader, including its quirks (the heatmap gradient
+//     is doubled between stops, and the image always round-trips through
+//       ICtCp even when no tonemap is active), so that an exported or batch
+//         visualization matches what the viewer displays pixel for pixel.
+
+// Transposed, same as SKIV_Image_Rec709toICtCp / SKIV_Image_ICtCptoRec709
+static const DirectX::XMMATRIX c_fromLMStoICtCp =
+{
+  { 0.5000f,  1.6137f,  4.3780f, 0.0f },
+  { 0.5000f, -3.3234f, -4.2455f, 0.0f },
+  { 0.0000f,  1.7097f, -0.1325f, 0.0f },
+  { 0.0f,     0.0f,     0.0f,    1.0f }
+};
+
+static const DirectX::XMMATRIX c_fromICtCptoLMS =
+{
+  { 1.0f,                   1.0f,                   1.0f,                  0.0f },
+  { 0.00860514569398152f,  -0.00860514569398152f,   0.56004885956263900f,  0.0f },
+  { 0.11103560447547328f,  -0.11103560447547328f,  -0.32063747023212210f,  0.0f },
+  { 0.0f,                   0.0f,                   0.0f,                  1.0f }
+};
+
+constexpr float SKIV_PQ_N     = 2610.0f / 4096.0f / 4.0f;
+constexpr float SKIV_PQ_M     = 2523.0f / 4096.0f * 128.0f;
+constexpr float SKIV_PQ_C1    = 3424.0f / 4096.0f;
+constexpr float SKIV_PQ_C2    = 2413.0f / 4096.0f * 32.0f;
+constexpr float SKIV_PQ_C3    = 2392.0f / 4096.0f * 32.0f;
+constexpr float SKIV_PQ_MAX   = 125.0f; // 10,000 nits in scRGB
+
+// Shader's LinearToPQY (x): Clamp_scRGB nudges the result away from 0 by FP16_MIN
+static float
+SKIV_Kernel_LinearToPQY (float x)
+{
+  x = std::max (x, 0.0f);
+
+  if (x == 0.0f)
+    return 0.0f;
+
+  const float p  = std::pow (x / SKIV_PQ_MAX, SKIV_PQ_N);
+  const float nd = (SKIV_PQ_C1 + SKIV_PQ_C2 * p) /
+                   (1.0f       + SKIV_PQ_C3 * p);
+
+  return
+    std::min (std::pow (nd, SKIV_PQ_M) + FP16_MIN, FLT_MAX);
+}
+
+// Input is >= 0; sign (0) keeps 0 at 0 like the shader
+static __forceinline __m256
+SKIV_Kernel_LinearToPQ (__m256 x)
+{
+  const __m256 p  =
+    _mm256_pow_ps (_mm256_div_ps (x, _mm256_set1_ps (SKIV_PQ_MAX)), _mm256_set1_ps (SKIV_PQ_N));
+  const __m256 nd =
+    _mm256_div_ps (_mm256_fmadd_ps (p, _mm256_set1_ps (SKIV_PQ_C2), _mm256_set1_ps (SKIV_PQ_C1)),
+                   _mm256_fmadd_ps (p, _mm256_set1_ps (SKIV_PQ_C3), _mm256_set1_ps (1.0f)));
+
+  return
+    _mm256_and_ps (_mm256_cmp_ps (x, _mm256_setzero_ps (), _CMP_GT_OQ),
+                   _mm256_pow_ps (nd, _mm256_set1_ps (SKIV_PQ_M)));
+}
+
+static __forceinline __m256
+SKIV_Kernel_PQToLinear (__m256 x)
+{
+  const __m256 sign_bit = _mm256_set1_ps (-0.0f);
+
+  const __m256 p  =
+    _mm256_pow_ps (_mm256_andnot_ps (sign_bit, x), _mm256_set1_ps (1.0f / SKIV_PQ_M));
+  const __m256 nd =
+    _mm256_div_ps (_mm256_max_ps  (_mm256_sub_ps (p, _mm256_set1_ps (SKIV_PQ_C1)), _mm256_setzero_ps ()),
+                   _mm256_fnmadd_ps (p, _mm256_set1_ps (SKIV_PQ_C3), _mm256_set1_ps (SKIV_PQ_C2)));
+
+  return
+    _mm256_or_ps (_mm256_and_ps (x, sign_bit),
+      _mm256_mul_ps (_mm256_pow_ps (nd, _mm256_set1_ps (1.0f / SKIV_PQ_N)), _mm256_set1_ps (SKIV_PQ_MAX)));
+}
+
+// Shader's SanitizeFP: NaN -> 0, +/-Inf -> +/-FLT_MAX
+static __forceinline __m256
+SKIV_Kernel_SanitizeFP (__m256 v)
+{
+  return
+    _mm256_and_ps (_mm256_cmp_ps (v, v, _CMP_ORD_Q),
+      _mm256_min_ps (_mm256_max_ps (v, _mm256_set1_ps (-FLT_MAX)), _mm256_set1_ps (FLT_MAX)));
+}
+
+// Shader's ! isnormal (x), i.e. Inf or NaN
+static __forceinline __m256
+SKIV_Kernel_IsNotFinite (__m256 v)
+{
+  return
+    _mm256_cmp_ps (_mm256_andnot_ps (_mm256_set1_ps (-0.0f), v), _mm256_set1_ps (INFINITY), _CMP_NLT_UQ);
+}
+
+struct skiv_viz_state_s {
+  uint32_t type         = SKIV_HDR_VISUALIZTION_NONE;
+  uint32_t sdr_flags    = 0;
+  uint32_t tonemap_type = SKIV_TONEMAP_TYPE_NONE;
+  bool     hdr_display  = true;
+  float    brightness   = 1.0f;
+  float    dML          = 0.0f; // Display max luminance, PQ
+  float    cML          = 0.0f; // Content max luminance, PQ
+
+  __m256   hue [6][3];
+
+  skiv_gamut_planes_s xyz   { c_from709toXYZ   };
+  skiv_gamut_planes_s lms   { c_fromXYZtoLMS   };
+  skiv_gamut_planes_s ictcp { c_fromLMStoICtCp };
+  skiv_gamut_planes_s i_lms { c_fromICtCptoLMS };
+  skiv_gamut_planes_s i_xyz { c_fromLMStoXYZ   };
+  skiv_gamut_planes_s i_709 { c_fromXYZto709   };
+  skiv_gamut_planes_s p3    { c_from709toDCIP3 };
+  skiv_gamut_planes_s r2020 { c_from709to2020  };
+  skiv_gamut_planes_s ap1   { c_from709toAP1   };
+  skiv_gamut_planes_s ap0   { c_from709toAP0   };
+
+  // Heatmap gradient: stops n and n+1 of each segment, and their colors
+  __m256 stop_lo     = _mm256_setr_ps (0.00f, 3.16f, 10.0f, 31.6f, 100.f, 316.f, 1000.f, 3160.f);
+  __m256 stop_hi     = _mm256_setr_ps (3.16f, 10.0f, 31.6f, 100.f, 316.f, 1000.f, 3160.f, 10000.f);
+
+  __m256 col_lo [3] = {
+    _mm256_setr_ps (0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f),
+    _mm256_setr_ps (0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 0.2f, 0.0f, 0.0f),
+    _mm256_setr_ps (0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f)
+  };
+  __m256 col_hi [3] = {
+    _mm256_setr_ps (0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f),
+    _mm256_setr_ps (0.0f, 1.0f, 1.0f, 1.0f, 0.2f, 0.0f, 0.0f, 1.0f),
+    _mm256_setr_ps (1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f)
+  };
+};
+
+// Processes 8 pixels of planar scRGB in-place, see imgui_pix_shader.hlsl's main ()
+static __forceinline void
+SKIV_Kernel_Visualize8 (const skiv_viz_state_s& viz, __m256& R, __m256& G, __m256& B)
+{
+  const __m256 zero     = _mm256_setzero_ps ();
+  const __m256 one      = _mm256_set1_ps    (1.0f);
+  const __m256 all_bits = _mm256_castsi256_ps (_mm256_set1_epi32 (-1));
+  const __m256 scale    = _mm256_set1_ps    (viz.brightness);
+
+  //
+  // ApplyHDRVisualization (..., false)
+  //
+  switch (viz.type)
+  {
+    case SKIV_HDR_VISUALIZTION_HEATMAP:
+    {
+      static constexpr float
+        stops [8] = { 0.00f, 3.16f, 10.0f, 31.6f, 100.f, 316.f, 1000.f, 3160.f };
+
+      R = _mm256_mul_ps (R, scale);
+      G = _mm256_mul_ps (G, scale);
+      B = _mm256_mul_ps (B, scale);
+
+      const __m256 nits =
+        _mm256_mul_ps (_mm256_max_ps (viz.xyz.dot (1, R, G, B), zero), _mm256_set1_ps (80.0f));
+
+      // Number of interior stops below nits = active segment
+      __m256i segment = _mm256_setzero_si256 ();
+
+      for (int stop = 1; stop < 8; ++stop)
+      {
+        segment =
+          _mm256_sub_epi32 (segment, _mm256_castps_si256 (
+            _mm256_cmp_ps (nits, _mm256_set1_ps (stops [stop]), _CMP_GT_OQ)));
+      }
+
+      const __m256 s0 = _mm256_permutevar8x32_ps (viz.stop_lo, segment);
+      const __m256 s1 = _mm256_permutevar8x32_ps (viz.stop_hi, segment);
+      const __m256 t  = _mm256_div_ps (_mm256_sub_ps (nits, s0), _mm256_sub_ps (s1, s0));
+
+      // sign (nits - STOPn) - sign (nits - STOPn+1) is 2 inside a segment, and
+      //   exactly at a stop both adjacent segments contribute 1, except at the
+      //     last stop where the gradient ends at 1x white.
+      const __m256 weight =
+        _mm256_blendv_ps (_mm256_set1_ps (2.0f), one, _mm256_cmp_ps (nits, _mm256_set1_ps (10000.0f), _CMP_EQ_OQ));
+      const __m256 over   =
+        _mm256_cmp_ps (nits, _mm256_set1_ps (10000.0f), _CMP_GT_OQ);
+
+      __m256* channels [3] = { &R, &G, &B };
+
+      for (int c = 0; c < 3; ++c)
+      {
+        const __m256 c0 = _mm256_permutevar8x32_ps (viz.col_lo [c], segment);
+        const __m256 c1 = _mm256_permutevar8x32_ps (viz.col_hi [c], segment);
+
+        *channels [c] =
+          _mm256_blendv_ps (_mm256_mul_ps (_mm256_fmadd_ps (t, _mm256_sub_ps (c1, c0), c0), weight),
+                            _mm256_set1_ps (125.0f), over);
+      }
+    } break;
+
+    case SKIV_HDR_VISUALIZTION_GAMUT:
+    {
+      // min () picks the non-NaN operand, like HLSL
+      const __m256 lum =
+        _mm256_min_ps (viz.xyz.dot (1, R, G, B), _mm256_set1_ps (125.0f));
+
+      const __m256 invalid =
+        _mm256_or_ps (_mm256_or_ps (SKIV_Kernel_IsNotFinite (R), SKIV_Kernel_IsNotFinite (G)),
+                      _mm256_or_ps (SKIV_Kernel_IsNotFinite (B), _mm256_xor_ps (viz.ap0.contains (R, G, B), all_bits)));
+
+      // Widest gamut wins, so blend from the narrowest outwards
+      const __m256 outside [5] = {
+        _mm256_or_ps (_mm256_or_ps (_mm256_cmp_ps (R, zero, _CMP_LT_OQ), _mm256_cmp_ps (G, zero, _CMP_LT_OQ)),
+                                    _mm256_cmp_ps (B, zero, _CMP_LT_OQ)),
+        _mm256_xor_ps (viz.p3.contains    (R, G, B), all_bits),
+        _mm256_xor_ps (viz.r2020.contains (R, G, B), all_bits),
+        _mm256_xor_ps (viz.ap1.contains   (R, G, B), all_bits),
+        invalid
+      };
+
+      __m256 out [3] = {
+        _mm256_mul_ps (lum, viz.hue [0][0]),
+        _mm256_mul_ps (lum, viz.hue [0][1]),
+        _mm256_mul_ps (lum, viz.hue [0][2])
+      };
+
+      for (int gamut = 0; gamut < 5; ++gamut)
+      {
+        // MIN_WIDE_GAMUT_Y * 1, 2, 3, 4 and 8
+        const __m256 min_lum =
+          _mm256_max_ps (lum, _mm256_set1_ps (0.15f * (gamut == 4 ? 8.0f : static_cast <float> (gamut + 1))));
+
+        for (int c = 0; c < 3; ++c)
+          out [c] = _mm256_blendv_ps (out [c], _mm256_mul_ps (min_lum, viz.hue [gamut + 1][c]), outside [gamut]);
+      }
+
+      const __m256 black =
+        _mm256_cmp_ps (lum, _mm256_set1_ps (FP16_MIN), _CMP_LT_OQ);
+
+      R = _mm256_andnot_ps (black, out [0]);
+      G = _mm256_andnot_ps (black, out [1]);
+      B = _mm256_andnot_ps (black, out [2]);
+    } break;
+
+    case SKIV_HDR_VISUALIZTION_SDR:
+    {
+      const __m256 lum =
+        _mm256_max_ps (viz.xyz.dot (1, R, G, B), zero);
+
+      __m256 hdr = zero;
+
+      if (viz.sdr_flags & SKIV_VIZ_FLAG_SDR_CONSIDER_LUMINANCE)
+        hdr = _mm256_or_ps (hdr, _mm256_cmp_ps (lum, one, _CMP_GT_OQ));
+
+      if (viz.sdr_flags & SKIV_VIZ_FLAG_SDR_CONSIDER_GAMUT)
+        hdr = _mm256_or_ps (hdr, _mm256_or_ps (_mm256_or_ps (_mm256_cmp_ps (R, zero, _CMP_LT_OQ), _mm256_cmp_ps (G, zero, _CMP_LT_OQ)),
+                                                                _mm256_cmp_ps (B, zero, _CMP_LT_OQ)));
+
+      if (viz.sdr_flags & SKIV_VIZ_FLAG_SDR_CONSIDER_OVERBRIGHT)
+        hdr = _mm256_or_ps (hdr, _mm256_or_ps (_mm256_or_ps (_mm256_cmp_ps (R, one, _CMP_GT_OQ), _mm256_cmp_ps (G, one, _CMP_GT_OQ)),
+                                                                _mm256_cmp_ps (B, one, _CMP_GT_OQ)));
+
+      R = _mm256_mul_ps (_mm256_blendv_ps (lum, R, hdr), scale);
+      G = _mm256_mul_ps (_mm256_blendv_ps (lum, G, hdr), scale);
+      B = _mm256_mul_ps (_mm256_blendv_ps (lum, B, hdr), scale);
+    } break;
+
+    default:
+      break;
+  }
+
+  R = SKIV_Kernel_SanitizeFP (R);
+  G = SKIV_Kernel_SanitizeFP (G);
+  B = SKIV_Kernel_SanitizeFP (B);
+
+  // dot (orig_col * user_brightness_scale, 1.0), alpha is always 1 here
+  const __m256 orig_sum =
+    _mm256_mul_ps (_mm256_add_ps (_mm256_add_ps (R, G), _mm256_add_ps (B, one)), scale);
+
+  if (viz.type == SKIV_HDR_VISUALIZTION_NONE)
+  {
+    const __m256 brightness =
+      _mm256_set1_ps (viz.hdr_display ? viz.brightness
+                                      : std::max (viz.brightness, 0.001f));
+
+    R = _mm256_mul_ps (R, brightness);
+    G = _mm256_mul_ps (G, brightness);
+    B = _mm256_mul_ps (B, brightness);
+  }
+
+  //
+  // Tonemap in ICtCp
+  //
+  const __m256 X = viz.xyz.dot (0, R, G, B);
+  const __m256 Y = viz.xyz.dot (1, R, G, B);
+  const __m256 Z = viz.xyz.dot (2, R, G, B);
+
+  const __m256 L = SKIV_Kernel_LinearToPQ (_mm256_max_ps (viz.lms.dot (0, X, Y, Z), zero));
+  const __m256 M = SKIV_Kernel_LinearToPQ (_mm256_max_ps (viz.lms.dot (1, X, Y, Z), zero));
+  const __m256 S = SKIV_Kernel_LinearToPQ (_mm256_max_ps (viz.lms.dot (2, X, Y, Z), zero));
+
+  __m256 I  = viz.ictcp.dot (0, L, M, S);
+  __m256 Ct = viz.ictcp.dot (1, L, M, S);
+  __m256 Cp = viz.ictcp.dot (2, L, M, S);
+
+  const __m256 Y_in  = _mm256_max_ps (I, zero);
+        __m256 Y_out = Y_in;
+
+  const __m256 dML = _mm256_set1_ps (viz.dML);
+  const __m256 cML = _mm256_set1_ps (viz.cML);
+
+  switch (viz.tonemap_type)
+  {
+    case SKIV_TONEMAP_TYPE_CLIP:
+      Y_out = _mm256_min_ps (Y_in, dML);
+      break;
+
+    case SKIV_TONEMAP_TYPE_NORMALIZE_TO_CLL:
+      Y_out =
+        _mm256_div_ps (_mm256_fmadd_ps (_mm256_div_ps (one, _mm256_mul_ps (cML, cML)), _mm256_mul_ps (Y_in, Y_in), Y_in),
+                       _mm256_add_ps   (one, Y_in));
+      break;
+
+    case SKIV_TONEMAP_TYPE_MAP_CLL_TO_DISPLAY:
+    {
+      const __m256 a = _mm256_div_ps (dML, _mm256_mul_ps (cML, cML));
+      const __m256 b = _mm256_div_ps (one, dML);
+
+      Y_out =
+        _mm256_div_ps (_mm256_mul_ps (Y_in, _mm256_fmadd_ps (a, Y_in, one)),
+                                            _mm256_fmadd_ps (b, Y_in, one));
+    } break;
+
+    default:
+      break;
+  }
+
+  const __m256 active =
+    _mm256_cmp_ps (_mm256_add_ps (Y_out, Y_in), zero, _CMP_GT_OQ);
+
+  if (viz.tonemap_type == SKIV_TONEMAP_TYPE_MAP_CLL_TO_DISPLAY && (! viz.hdr_display))
+    I = _mm256_pow_ps (I, _mm256_set1_ps (1.18f));
+
+  const __m256 I0 = I;
+
+  I =
+    _mm256_mul_ps (I, _mm256_max_ps (_mm256_div_ps (Y_out, Y_in), zero));
+
+  const __m256 I_scale =
+    _mm256_and_ps (_mm256_and_ps (_mm256_cmp_ps (I,  zero, _CMP_NEQ_OQ),
+                                  _mm256_cmp_ps (I0, zero, _CMP_NEQ_OQ)),
+                   _mm256_min_ps (_mm256_div_ps (I0, I), _mm256_div_ps (I, I0)));
+
+  I  = _mm256_and_ps    (active, I);
+  Ct = _mm256_blendv_ps (Ct, _mm256_mul_ps (Ct, I_scale), active);
+  Cp = _mm256_blendv_ps (Cp, _mm256_mul_ps (Cp, I_scale), active);
+
+  const __m256 L1 = SKIV_Kernel_PQToLinear (viz.i_lms.dot (0, I, Ct, Cp));
+  const __m256 M1 = SKIV_Kernel_PQToLinear (viz.i_lms.dot (1, I, Ct, Cp));
+  const __m256 S1 = SKIV_Kernel_PQToLinear (viz.i_lms.dot (2, I, Ct, Cp));
+
+  const __m256 X1 = viz.i_xyz.dot (0, L1, M1, S1);
+  const __m256 Y1 = viz.i_xyz.dot (1, L1, M1, S1);
+  const __m256 Z1 = viz.i_xyz.dot (2, L1, M1, S1);
+
+  R = viz.i_709.dot (0, X1, Y1, Z1);
+  G = viz.i_709.dot (1, X1, Y1, Z1);
+  B = viz.i_709.dot (2, X1, Y1, Z1);
+
+  // ApplyHDRVisualization (..., true) is a no-op, but the heatmap's scale and
+  //   inverse scale around it do not cancel out exactly.
+  if (viz.type == SKIV_HDR_VISUALIZTION_HEATMAP)
+  {
+    const __m256 inv_scale =
+      _mm256_set1_ps (1.0f / viz.brightness);
+
+    R = _mm256_mul_ps (_mm256_mul_ps (R, scale), inv_scale);
+    G = _mm256_mul_ps (_mm256_mul_ps (G, scale), inv_scale);
+    B = _mm256_mul_ps (_mm256_mul_ps (B, scale), inv_scale);
+  }
+
+  const __m256 keep =
+    _mm256_cmp_ps (orig_sum, _mm256_set1_ps (FP16_MIN), _CMP_GT_OQ);
+
+  R = SKIV_Kernel_SanitizeFP (_mm256_and_ps (keep, R));
+  G = SKIV_Kernel_SanitizeFP (_mm256_and_ps (keep, G));
+  B = SKIV_Kernel_SanitizeFP (_mm256_and_ps (keep, B));
+}
+
+HRESULT
+SKIV_Image_ApplyVisualization (const DirectX::Image& image, const skiv_hdr_visualization_s& params, DirectX::ScratchImage& result)
+{
+  SKIV_TRACE_SCOPE ("ApplyVisualization");
+
+  const skiv_row_layout_e layout =
+    SKIV_Kernel_GetRowLayout (image.format);
+
+  if (layout == SKIV_Row_Unsupported || image.pixels == nullptr || params.brightness <= 0.0f)
+    return E_INVALIDARG;
+
+  // Same tonemap selection as ImGui_ImplDX11_RenderDrawData () and the shader
+  skiv_viz_state_s viz;
+
+  viz.type         = params.type;
+  viz.sdr_flags    = params.sdr_flags;
+  viz.hdr_display  = params.hdr_display;
+  viz.brightness   = params.brightness;
+  viz.tonemap_type =
+    (params.brightness * params.content_max_nits > params.display_max_nits) ? params.tonemap_type
+                                                                            : SKIV_TONEMAP_TYPE_NONE;
+
+  if (! viz.hdr_display)
+    viz.tonemap_type = SKIV_TONEMAP_TYPE_MAP_CLL_TO_DISPLAY;
+
+  if (viz.type == SKIV_HDR_VISUALIZTION_GAMUT)
+    viz.tonemap_type = SKIV_TONEMAP_TYPE_NONE;
+
+  viz.dML = SKIV_Kernel_LinearToPQY (            params.display_max_nits / 80.0f);
+  viz.cML = SKIV_Kernel_LinearToPQY (std::min (params.content_max_nits / 80.0f, 10000.0f));
+
+  if (viz.tonemap_type != SKIV_TONEMAP_TYPE_NONE && (! viz.hdr_display))
+    viz.dML = SKIV_Kernel_LinearToPQY (1.5f);
+
+  // Segments the shader does not handle (INFINITE_ROLLOFF) fall through to none
+  if (viz.tonemap_type != SKIV_TONEMAP_TYPE_CLIP             &&
+      viz.tonemap_type != SKIV_TONEMAP_TYPE_NORMALIZE_TO_CLL &&
+      viz.tonemap_type != SKIV_TONEMAP_TYPE_MAP_CLL_TO_DISPLAY)
+      viz.tonemap_type  = SKIV_TONEMAP_TYPE_NONE;
+
+  for (int gamut = 0; gamut < 6; ++gamut)
+    for (int c = 0; c < 3; ++c)
+      viz.hue [gamut][c] = _mm256_set1_ps (params.gamut_hue [gamut][c]);
+
+  // The output is scRGB, which 8-bit formats cannot hold, and FP16 is what the
+  //   viewer renders it to; FP32 input gains nothing from the extra precision.
+  const skiv_row_layout_e out_layout = SKIV_Row_FP16;
+
+  HRESULT hr =
+    result.Initialize2D (DXGI_FORMAT_R16G16B16A16_FLOAT, image.width, image.height, 1, 1);
+
+  if (FAILED (hr))
+    return hr;
+
+  const DirectX::Image* pDest =
+    result.GetImage (0, 0, 0);
+
+  const bool bgra =
+    SKIV_Kernel_IsBGRA8 (image.format);
+
+  const size_t width  = image.width;
+  const size_t padded = (width + 7) & ~size_t (7);
+  const size_t height = image.height;
+  const size_t band   = SKIV_Kernel_GetBandHeight (height);
+  const size_t bands  = (height + band - 1) / band;
+
+  concurrency::parallel_for (size_t (0), bands, [&](size_t band_idx)
+  {
+    // The row is transposed to planar form (padded to 8 pixels, so there is no scalar tail)
+    std::vector <float> buffer (width * 4 + padded * 3, 0.0f);
+
+    float* row   = buffer.data ();
+    float* red   = row   + width * 4;
+    float* green = red   + padded;
+    float* blue  = green + padded;
+
+    const size_t y_begin =                       band_idx * band;
+    const size_t y_end   = std::min (height, y_begin + band);
+
+    for (size_t y = y_begin; y < y_end; ++y)
+    {
+      SKIV_Kernel_LoadRow (layout, image.pixels + y * image.rowPitch, row, width);
+
+      for (size_t x = 0; x < width; ++x)
+      {
+        red   [x] = row [4 * x + (bgra ? 2 : 0)];
+        green [x] = row [4 * x + 1];
+        blue  [x] = row [4 * x + (bgra ? 0 : 2)];
+      }
+
+      for (size_t x = 0; x < padded; x += 8)
+      {
+        __m256 R = _mm256_loadu_ps (red   + x);
+        __m256 G = _mm256_loadu_ps (green + x);
+        __m256 B = _mm256_loadu_ps (blue  + x);
+
+        SKIV_Kernel_Visualize8 (viz, R, G, B);
+
+        _mm256_storeu_ps (red   + x, R);
+        _mm256_storeu_ps (green + x, G);
+        _mm256_storeu_ps (blue  + x, B);
+      }
+
+      // The shader's output is opaque
+      for (size_t x = 0; x < width; ++x)
+      {
+        row [4 * x + 0] = red   [x];
+        row [4 * x + 1] = green [x];
+        row [4 * x + 2] = blue  [x];
+        row [4 * x + 3] = 1.0f;
+      }
+
+      SKIV_Kernel_StoreRow (out_layout, row, pDest->pixels + y * pDest->rowPitch, width);
+    }
+  });
+
+  return S_OK;
+}
+
+#pragma endregion
+
+#pragma region CIE 1931 Coverage
+
+// Chromaticity plot shown next to the gamut statistics (1024x1024, x right, y up).
+//
+//   Every pixel of the full-resolution image is binned once, into one bitmap
+//     of hit bins per worker thread that are OR-ed together at the end; the plot is
+//       then the same regardless of zoom or which parts of the image are on
+//         screen, and the GPU only ever samples the finished texture.
+constexpr size_t SKIV_CIE1931_SIZE  = 1024;
+constexpr size_t SKIV_CIE1931_WORDS = SKIV_CIE1931_SIZE * SKIV_CIE1931_SIZE / 64;
+
+// Bins a chromaticity into the 1024x1024 plot (row 0 is y = 1), out of range bins are dropped
+static __forceinline void
+SKIV_Kernel_MarkCIE1931 (uint64_t* bins, float x, float y)
+{
+  const float fx = static_cast <float> (SKIV_CIE1931_SIZE) * x;
+  const float fy = static_cast <float> (SKIV_CIE1931_SIZE) - static_cast <float> (SKIV_CIE1931_SIZE) * y;
+
+  if (! (fx >= 0.0f && fx < static_cast <float> (SKIV_CIE1931_SIZE) &&
+         fy >= 0.0f && fy < static_cast <float> (SKIV_CIE1931_SIZE)))
+    return;
+
+  const size_t bin =
+    static_cast <size_t> (fy) * SKIV_CIE1931_SIZE + static_cast <size_t> (fx);
+
+  bins [bin / 64] |= 1ULL << (bin % 64);
+}
+
+HRESULT
+SKIV_Image_AccumulateCIE1931 (const DirectX::Image& image, DirectX::ScratchImage& coverage)
+{
+  SKIV_TRACE_SCOPE ("AccumulateCIE1931");
+
+  const bool fp16 = (image.format == DXGI_FORMAT_R16G16B16A16_FLOAT);
+  const bool fp32 = (image.format == DXGI_FORMAT_R32G32B32A32_FLOAT);
+
+  if ((! fp16 && ! fp32) || image.pixels == nullptr)
+    return E_INVALIDARG;
+
+  static const skiv_gamut_planes_s planes_xyz (c_from709toXYZ);
+  static const skiv_gamut_planes_s planes_ap1 (c_from709toAP1);
+
+  const size_t width  = image.width;
+  const size_t height = image.height;
+  const size_t band   = SKIV_Kernel_GetBandHeight (height);
+  const size_t bands  = (height + band - 1) / band;
+
+  concurrency::combinable <std::vector <uint64_t>> thread_bins;
+
+  concurrency::parallel_for (size_t (0), bands, [&](size_t band_idx)
+  {
+    std::vector <uint64_t>& bins =
+      thread_bins.local ();
+
+    if (bins.empty ())
+        bins.resize (SKIV_CIE1931_WORDS, 0);
+
+    const __m256 ap1_min = _mm256_set1_ps (FP16_MIN);
+
+    const size_t y_begin =                       band_idx * band;
+    const size_t y_end   = std::min (height, y_begin + band);
+
+    for (size_t y = y_begin; y < y_end; ++y)
+    {
+      const uint8_t* row =
+        image.pixels + y * image.rowPitch;
+
+      size_t x = 0;
+
+      for (; x + 8 <= width; x += 8)
+      {
+        __m256 r, g, b;
+
+        if (fp16) SKIV_Kernel_LoadRGB8_FP16 (reinterpret_cast <const uint16_t *> (row) + x * 4, r, g, b);
+        else      SKIV_Kernel_LoadRGB8_FP32 (reinterpret_cast <const float    *> (row) + x * 4, r, g, b);
+
+        // Only colors inside AP1 are plotted
+        __m256 inside =
+          _mm256_cmp_ps (planes_ap1.dot (0, r, g, b), ap1_min, _CMP_GE_OQ);
+        inside = _mm256_and_ps (inside,
+          _mm256_cmp_ps (planes_ap1.dot (1, r, g, b), ap1_min, _CMP_GE_OQ));
+        inside = _mm256_and_ps (inside,
+          _mm256_cmp_ps (planes_ap1.dot (2, r, g, b), ap1_min, _CMP_GE_OQ));
+
+        int mask =
+          _mm256_movemask_ps (inside);
+
+        if (mask == 0)
+          continue;
+
+        const __m256 X = planes_xyz.dot (0, r, g, b);
+        const __m256 Y = planes_xyz.dot (1, r, g, b);
+        const __m256 Z = planes_xyz.dot (2, r, g, b);
+
+        const __m256 rcp_sum =
+          _mm256_div_ps (_mm256_set1_ps (1.0f), _mm256_add_ps (_mm256_add_ps (X, Y), Z));
+
+        alignas (32) float cx [8];
+        alignas (32) float cy [8];
+
+        _mm256_store_ps (cx, _mm256_mul_ps (X, rcp_sum));
+        _mm256_store_ps (cy, _mm256_mul_ps (Y, rcp_sum));
+
+        for (; mask != 0; mask &= mask - 1)
+        {
+          const unsigned long lane =
+            _tzcnt_u32 (static_cast <unsigned int> (mask));
+
+          SKIV_Kernel_MarkCIE1931 (bins.data (), cx [lane], cy [lane]);
+        }
+      }
+
+      for (; x < width; ++x)
+      {
+        float rgb [4];
+
+        if (fp16)
+        {
+          const uint16_t* p =
+            reinterpret_cast <const uint16_t *> (row) + x * 4;
+
+          rgb [0] = DirectX::PackedVector::XMConvertHalfToFloat (p [0]);
+          rgb [1] = DirectX::PackedVector::XMConvertHalfToFloat (p [1]);
+          rgb [2] = DirectX::PackedVector::XMConvertHalfToFloat (p [2]);
+        }
+
+        else
+          memcpy (rgb, reinterpret_cast <const float *> (row) + x * 4, sizeof (float) * 3);
+
+        const DirectX::XMVECTOR v =
+          DirectX::XMVectorSet (rgb [0], rgb [1], rgb [2], 1.0f);
+
+        uint32_t                         xm_test_all = 0x0;
+        DirectX::XMVectorGreaterOrEqualR (&xm_test_all, DirectX::XMVector3Transform (v, c_from709toAP1), DirectX::XMVectorReplicate (FP16_MIN));
+
+        if (! DirectX::XMComparisonAllTrue (xm_test_all))
+          continue;
+
+        DirectX::XMFLOAT4 xyz;
+        DirectX::XMStoreFloat4 (&xyz, DirectX::XMVector3Transform (v, c_from709toXYZ));
+
+        const float sum = xyz.x + xyz.y + xyz.z;
+
+        SKIV_Kernel_MarkCIE1931 (bins.data (), xyz.x / sum, xyz.y / sum);
+      }
+    }
+  });
+
+  std::vector <uint64_t> bins (SKIV_CIE1931_WORDS, 0);
+
+  thread_bins.combine_each ([&](const std::vector <uint64_t>& local)
+  {
+    for (size_t i = 0; i < local.size (); ++i)
+      bins [i] |= local [i];
+  });
+
+  HRESULT hr =
+    coverage.Initialize2D (DXGI_FORMAT_R16G16B16A16_FLOAT, SKIV_CIE1931_SIZE, SKIV_CIE1931_SIZE, 1, 1);
+
+  if (FAILED (hr))
+    return hr;
+
+  const DirectX::Image* pCoverage =
+    coverage.GetImage (0, 0, 0);
+
+  // Each hit bin shows the Rec. 709 color of its chromaticity (at X+Y+Z = 1,
+  //   doubled for visibility), the rest of the plot is transparent black.
+  concurrency::parallel_for (size_t (0), SKIV_CIE1931_SIZE, [&](size_t row)
+  {
+    std::vector <float> texels (SKIV_CIE1931_SIZE * 4, 0.0f);
+
+    const float cy =
+      (static_cast <float> (SKIV_CIE1931_SIZE - row) - 0.5f) / static_cast <float> (SKIV_CIE1931_SIZE);
+
+    for (size_t col = 0; col < SKIV_CIE1931_SIZE; ++col)
+    {
+      const size_t bin = row * SKIV_CIE1931_SIZE + col;
+
+      if ((bins [bin / 64] & (1ULL << (bin % 64))) == 0)
+        continue;
+
+      const float cx =
+        (static_cast <float> (col) + 0.5f) / static_cast <float> (SKIV_CIE1931_SIZE);
+
+      DirectX::XMFLOAT4 color;
+      DirectX::XMStoreFloat4 (&color,
+        DirectX::XMVectorScale (
+          DirectX::XMVector3Transform (DirectX::XMVectorSet (cx, cy, 1.0f - cx - cy, 1.0f), c_fromXYZto709), 2.0f)
+      );
+
+      texels [col * 4 + 0] = color.x;
+      texels [col * 4 + 1] = color.y;
+      texels [col * 4 + 2] = color.z;
+      texels [col * 4 + 3] = 1.0f;
+    }
+
+    SKIV_Kernel_GetFP16Kernels ().pack (texels.data (),
+      reinterpret_cast <uint16_t *> (pCoverage->pixels + row * pCoverage->rowPitch), SKIV_CIE1931_SIZE * 4);
+  });
+
+  return S_OK;
+}
+
+#pragma endregion
+
+#pragma region Crop and Rotate
+
+// A clockwise rotation of a crop is an affine map from destination pixels to
+//   source bytes, so every destination row is a single strided walk over the
+//     source and nothing but the selected rectangle is ever read.
+struct skiv_crop_walk_s {
+  ptrdiff_t origin = 0; // Source byte offset of destination (0, 0)
+  ptrdiff_t step_x = 0; // Source bytes per destination column
+  ptrdiff_t step_y = 0; // Source bytes per destination row
+};
+
+enum skiv_crop_convert_e {
+  SKIV_Crop_Copy,        // Same layout
+  SKIV_Crop_CopyOpaque,  // Same layout, alpha forced to 1 (BGRX destinations)
+  SKIV_Crop_ToFP16,      // scRGB
+  SKIV_Crop_ToSDR,       // 8-bit sRGB, clipped
+  SKIV_Crop_ToHDR10      // Rec. 2020 PQ, R10G10B10A2
+};
+
+static bool
+SKIV_Kernel_IsOpaque (DXGI_FORMAT format)
+{
+  return format == DXGI_FORMAT_B8G8R8X8_UNORM || format == DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+}
+
+static bool
+SKIV_Kernel_GetCropConversion (DXGI_FORMAT src, DXGI_FORMAT dst, skiv_crop_convert_e& convert)
+{
+  const bool src_8bit = SKIV_Kernel_IsBGRA8 (src) || SKIV_Kernel_GetRowLayout (src) == SKIV_Row_RGBA8;
+  const bool dst_8bit = SKIV_Kernel_IsBGRA8 (dst) || SKIV_Kernel_GetRowLayout (dst) == SKIV_Row_RGBA8;
+
+  if (src == dst)
+    convert = SKIV_Crop_Copy;
+
+  else if (SKIV_Kernel_IsBGRA8 (src) && SKIV_Kernel_IsBGRA8 (dst))
+    convert = SKIV_Kernel_IsOpaque (dst) ? SKIV_Crop_CopyOpaque : SKIV_Crop_Copy;
+
+  else if (dst == DXGI_FORMAT_R16G16B16A16_FLOAT && src_8bit)
+    convert = SKIV_Crop_ToFP16;
+
+  else if (src == DXGI_FORMAT_R16G16B16A16_FLOAT && dst_8bit)
+    convert = SKIV_Crop_ToSDR;
+
+  else if (src == DXGI_FORMAT_R16G16B16A16_FLOAT && dst == DXGI_FORMAT_R10G10B10A2_UNORM)
+    convert = SKIV_Crop_ToHDR10;
+
+  else
+    return false;
+
+  return true;
+}
+
+// scRGB -> Rec. 2020 PQ, 8 pixels at a time (the tail goes through a padded copy)
+static void
+SKIV_Kernel_StoreRowHDR10 (const float* src, uint32_t* dst, size_t pixels)
+{
+  static const skiv_gamut_planes_s to2020 (c_from709to2020);
+
+  // Lane order of SKIV_Kernel_LoadRGB8_FP32
+  static constexpr size_t lane_pixel [8] = { 0, 2, 4, 6, 1, 3, 5, 7 };
+
+  const __m256 zero  = _mm256_setzero_ps ();
+  const __m256 one   = _mm256_set1_ps    (1.0f);
+  const __m256 scale = _mm256_set1_ps    (1023.0f);
+
+  for (size_t x = 0; x < pixels; x += 8)
+  {
+    const size_t count = std::min <size_t> (8, pixels - x);
+
+    alignas (32) float padded [32] = { };
+
+    const float* in = src + 4 * x;
+
+    if (count < 8)
+      in = static_cast <const float *> (memcpy (padded, in, count * 4 * sizeof (float)));
+
+    __m256 r, g, b;
+    SKIV_Kernel_LoadRGB8_FP32 (in, r, g, b);
+
+    auto _Encode = [&](int k) -> __m256i
+    {
+      const __m256 pq =
+        SKIV_Kernel_LinearToPQ (_mm256_max_ps (to2020.dot (k, r, g, b), zero));
+
+      return
+        _mm256_cvtps_epi32 (_mm256_mul_ps (_mm256_min_ps (_mm256_max_ps (pq, zero), one), scale));
+    };
+
+    alignas (32) uint32_t R [8], G [8], B [8];
+
+    _mm256_store_si256 (reinterpret_cast <__m256i *> (R), _Encode (0));
+    _mm256_store_si256 (reinterpret_cast <__m256i *> (G), _Encode (1));
+    _mm256_store_si256 (reinterpret_cast <__m256i *> (B), _Encode (2));
+
+    for (size_t lane = 0; lane < 8; ++lane)
+    {
+      if (lane_pixel [lane] < count)
+        dst [x + lane_pixel [lane]] = R [lane] | (G [lane] << 10) | (B [lane] << 20) | (3U << 30);
+    }
+  }
+}
+
+HRESULT
+SKIV_Image_CropRotate (const DirectX::Image& image, const DirectX::Rect& rect, DXGI_MODE_ROTATION rotation, DXGI_FORMAT format, DirectX::ScratchImage& result)
+{
+  SKIV_TRACE_SCOPE ("CropRotate");
+
+  if (image.pixels == nullptr || rect.x >= image.width || rect.y >= image.height)
+    return E_INVALIDARG;
+
+  skiv_crop_convert_e convert;
+
+  if (! SKIV_Kernel_GetCropConversion (image.format, format, convert))
+  {
+    PLOG_ERROR << "Unsupported crop conversion from DXGI format " << image.format << " to " << format;
+    return HRESULT_FROM_WIN32 (ERROR_NOT_SUPPORTED);
+  }
+
+  const size_t bytes_per_pixel =
+    DirectX::BitsPerPixel (image.format) / 8;
+
+  if (bytes_per_pixel != 4 && bytes_per_pixel != 8)
+    return HRESULT_FROM_WIN32 (ERROR_NOT_SUPPORTED);
+
+  // Clipped to the image
+  const size_t src_x  = rect.x;
+  const size_t src_y  = rect.y;
+  const size_t src_w  = std::min (rect.w, image.width  - rect.x);
+  const size_t src_h  = std::min (rect.h, image.height - rect.y);
+
+  if (src_w == 0 || src_h == 0)
+    return E_INVALIDARG;
+
+  const bool   swap_axes = (rotation == DXGI_MODE_ROTATION_ROTATE90 ||
+                            rotation == DXGI_MODE_ROTATION_ROTATE270);
+  const size_t width     = swap_axes ? src_h : src_w;
+  const size_t height    = swap_axes ? src_w : src_h;
+
+  const ptrdiff_t bpp   = static_cast <ptrdiff_t> (bytes_per_pixel);
+  const ptrdiff_t pitch = static_cast <ptrdiff_t> (image.rowPitch);
+  const ptrdiff_t x0    = static_cast <ptrdiff_t> (src_x), x1 = static_cast <ptrdiff_t> (src_x + src_w - 1);
+  const ptrdiff_t y0    = static_cast <ptrdiff_t> (src_y), y1 = static_cast <ptrdiff_t> (src_y + src_h - 1);
+
+  skiv_crop_walk_s walk;
+
+  switch (rotation)
+  {
+    case DXGI_MODE_ROTATION_ROTATE90:
+      walk = { y1 * pitch + x0 * bpp, -pitch,  bpp   };
+      break;
+    case DXGI_MODE_ROTATION_ROTATE180:
+      walk = { y1 * pitch + x1 * bpp, -bpp,   -pitch };
+      break;
+    case DXGI_MODE_ROTATION_ROTATE270:
+      walk = { y0 * pitch + x1 * bpp,  pitch, -bpp   };
+      break;
+    default:
+      walk = { y0 * pitch + x0 * bpp,  bpp,    pitch };
+      break;
+  }
+
+  HRESULT hr =
+    result.Initialize2D (format, width, height, 1, 1);
+
+  if (FAILED (hr))
+    return hr;
+
+  const DirectX::Image* pDest =
+    result.GetImage (0, 0, 0);
+
+  const bool swizzle = (convert == SKIV_Crop_ToFP16 || convert == SKIV_Crop_ToSDR) &&
+    (SKIV_Kernel_IsBGRA8 (image.format) != SKIV_Kernel_IsBGRA8 (format));
+  const bool opaque  = SKIV_Kernel_IsOpaque (image.format) || SKIV_Kernel_IsOpaque (format);
+
+  const size_t band  = SKIV_Kernel_GetBandHeight (height);
+  const size_t bands = (height + band - 1) / band;
+
+  concurrency::parallel_for (size_t (0), bands, [&](size_t band_idx)
+  {
+    std::vector <uint8_t> gathered (width * bytes_per_pixel);
+    std::vector <float>   row      (convert >= SKIV_Crop_ToFP16 ? width * 4 : 0);
+
+    const size_t y_begin =                       band_idx * band;
+    const size_t y_end   = std::min (height, y_begin + band);
+
+    for (size_t y = y_begin; y < y_end; ++y)
+    {
+      const uint8_t* src = image.pixels  + walk.origin + static_cast <ptrdiff_t> (y) * walk.step_y;
+            uint8_t* dst = pDest->pixels + y * pDest->rowPitch;
+
+      // Unrotated rows are contiguous in the source
+      uint8_t* out =
+        (convert <= SKIV_Crop_CopyOpaque) ? dst : gathered.data ();
+
+      if (walk.step_x == bpp)
+        memcpy (out, src, width * bytes_per_pixel);
+
+      else if (bytes_per_pixel == 4)
+      {
+        for (size_t x = 0; x < width; ++x)
+          reinterpret_cast <uint32_t *> (out) [x] = *reinterpret_cast <const uint32_t *> (src + static_cast <ptrdiff_t> (x) * walk.step_x);
+      }
+
+      else
+      {
+        for (size_t x = 0; x < width; ++x)
+          reinterpret_cast <uint64_t *> (out) [x] = *reinterpret_cast <const uint64_t *> (src + static_cast <ptrdiff_t> (x) * walk.step_x);
+      }
+
+      if (convert == SKIV_Crop_Copy)
+        continue;
+
+      if (convert == SKIV_Crop_CopyOpaque)
+      {
+        for (size_t x = 0; x < width; ++x)
+          reinterpret_cast <uint32_t *> (dst) [x] |= 0xFF000000U;
+
+        continue;
+      }
+
+      SKIV_Kernel_LoadRow ( (convert == SKIV_Crop_ToFP16) ? SKIV_Row_RGBA8
+                                                          : SKIV_Row_FP16, gathered.data (), row.data (), width );
+
+      for (size_t x = 0; x < width && (swizzle || opaque); ++x)
+      {
+        if (swizzle) std::swap (row [4 * x], row [4 * x + 2]);
+        if (opaque)  row [4 * x + 3] = 1.0f;
+      }
+
+      switch (convert)
+      {
+        case SKIV_Crop_ToFP16:
+          SKIV_Kernel_StoreRow (SKIV_Row_FP16,  row.data (), dst, width);
+          break;
+        case SKIV_Crop_ToSDR:
+          SKIV_Kernel_StoreRow (SKIV_Row_RGBA8, row.data (), dst, width);
+          break;
+        case SKIV_Crop_ToHDR10:
+          SKIV_Kernel_StoreRowHDR10 (row.data (), reinterpret_cast <uint32_t *> (dst), width);
+          break;
+        default:
+          break;
+      }
+    }
+  });
+
+  return S_OK;
+}
+
+#pragma endregion
+
+#pragma region CICP Decoding
+
+// Rows are decoded in place in a float buffer, 8 pixels at a time, by a kernel
+//   compiled for each transfer function; the primaries are a matrix (and the
+//     luma weights HLG's OOTF needs) looked up by code point.
+
+struct skiv_cicp_primaries_s {
+  uint8_t code;
+  float   to_scrgb [3][3]; // Row-major, Bradford-adapted to D65
+  float   luma     [3];
+};
+
+static constexpr skiv_cicp_primaries_s skiv_cicp_primaries [] = {
+  {  1, { {  1.0000000f,  0.0000000f,  0.0000000f }, {  0.0000000f,  1.0000000f,  0.0000000f }, {  0.0000000f,  0.0000000f,  1.0000000f } }, { 0.2126390f, 0.7151687f, 0.0721923f } }, // BT.709
+  {  5, { {  1.0440432f, -0.0440432f,  0.0000000f }, {  0.0000000f,  1.0000000f,  0.0000000f }, {  0.0000000f,  0.0117934f,  0.9882066f } }, { 0.2220043f, 0.7066548f, 0.0713409f } }, // BT.470 BG
+  {  6, { {  0.9395421f,  0.0501814f,  0.0102766f }, {  0.0177722f,  0.9657929f,  0.0164349f }, { -0.0016216f, -0.0043697f,  1.0059913f } }, { 0.2123764f, 0.7010599f, 0.0865638f } }, // SMPTE 170M
+  {  9, { {  1.6604910f, -0.5876411f, -0.0728499f }, { -0.1245505f,  1.1328999f, -0.0083494f }, { -0.0181508f, -0.1005789f,  1.1187297f } }, { 0.2627002f, 0.6779981f, 0.0593017f } }, // BT.2020
+  { 11, { {  1.1575164f, -0.1549624f, -0.0025540f }, { -0.0415001f,  1.0455679f, -0.0040679f }, { -0.0180500f, -0.0785783f,  1.0966283f } }, { 0.2094917f, 0.7215953f, 0.0689131f } }, // DCI-P3
+  { 12, { {  1.2249402f, -0.2249402f,  0.0000000f }, { -0.0420570f,  1.0420570f,  0.0000000f }, { -0.0196376f, -0.0786360f,  1.0982736f } }, { 0.2289746f, 0.6917385f, 0.0792869f } }  // Display P3
+};
+
+enum skiv_cicp_transfer_e {
+  SKIV_Transfer_BT709,
+  SKIV_Transfer_Gamma,
+  SKIV_Transfer_Linear,
+  SKIV_Transfer_sRGB,
+  SKIV_Transfer_PQ,
+  SKIV_Transfer_HLG
+};
+
+struct skiv_cicp_params_s {
+  const skiv_cicp_primaries_s* primaries;
+  float                        gamma;
+  float                        linear_scale;
+  float                        hlg_peak;      // scRGB
+  float                        hlg_exponent;  // System gamma - 1
+};
+
+// Curves of SDR signals are mirrored around 0, as float decoders may overshoot
+template <typename curve_fn>
+static __forceinline __m256
+SKIV_Kernel_MirrorCurve (__m256 x, curve_fn curve)
+{
+  const __m256 sign_bit = _mm256_set1_ps (-0.0f);
+
+  return
+    _mm256_or_ps (_mm256_and_ps (x, sign_bit), curve (_mm256_andnot_ps (sign_bit, x)));
+}
+
+template <skiv_cicp_transfer_e transfer>
+static __forceinline __m256
+SKIV_Kernel_DecodeTransfer (__m256 x, const skiv_cicp_params_s& params)
+{
+  if constexpr (transfer == SKIV_Transfer_BT709)
+  {
+    return SKIV_Kernel_MirrorCurve (x, [](__m256 v)
+    {
+      const __m256 power =
+        _mm256_pow_ps (_mm256_div_ps (_mm256_add_ps (v, _mm256_set1_ps (0.099f)), _mm256_set1_ps (1.099f)), _mm256_set1_ps (1.0f / 0.45f));
+
+      return
+        _mm256_blendv_ps (power, _mm256_div_ps (v, _mm256_set1_ps (4.5f)), _mm256_cmp_ps (v, _mm256_set1_ps (0.081f), _CMP_LT_OQ));
+    });
+  }
+
+  else if constexpr (transfer == SKIV_Transfer_Gamma)
+  {
+    const __m256 gamma = _mm256_set1_ps (params.gamma);
+
+    return SKIV_Kernel_MirrorCurve (x, [&](__m256 v)
+    {
+      return _mm256_pow_ps (v, gamma);
+    });
+  }
+
+  else if constexpr (transfer == SKIV_Transfer_Linear)
+  {
+    return
+      _mm256_mul_ps (x, _mm256_set1_ps (params.linear_scale));
+  }
+
+  else if constexpr (transfer == SKIV_Transfer_sRGB)
+  {
+    return SKIV_Kernel_MirrorCurve (x, [](__m256 v)
+    {
+      const __m256 power =
+        _mm256_pow_ps (_mm256_div_ps (_mm256_add_ps (v, _mm256_set1_ps (0.055f)), _mm256_set1_ps (1.055f)), _mm256_set1_ps (2.4f));
+
+      return
+        _mm256_blendv_ps (power, _mm256_div_ps (v, _mm256_set1_ps (12.92f)), _mm256_cmp_ps (v, _mm256_set1_ps (0.04045f), _CMP_LE_OQ));
+    });
+  }
+
+  else if constexpr (transfer == SKIV_Transfer_PQ)
+  {
+    return
+      SKIV_Kernel_PQToLinear (x);
+  }
+
+  // Scene-linear; the OOTF follows once all three channels are known
+  else if constexpr (transfer == SKIV_Transfer_HLG)
+  {
+    constexpr float a = 0.17883277f,
+                    b = 0.28466892f,
+                    c = 0.55991073f;
+
+    const __m256 v   = _mm256_max_ps (x, _mm256_setzero_ps ());
+    const __m256 low = _mm256_div_ps (_mm256_mul_ps (v, v), _mm256_set1_ps (3.0f));
+    const __m256 high =
+      _mm256_div_ps (_mm256_add_ps (_mm256_exp_ps (_mm256_div_ps (_mm256_sub_ps (v, _mm256_set1_ps (c)), _mm256_set1_ps (a))), _mm256_set1_ps (b)), _mm256_set1_ps (12.0f));
+
+    return
+      _mm256_blendv_ps (high, low, _mm256_cmp_ps (v, _mm256_set1_ps (0.5f), _CMP_LE_OQ));
+  }
+}
+
+template <skiv_cicp_transfer_e transfer>
+static void
+SKIV_Kernel_DecodeCICPRow (float* row, size_t pixels, const skiv_cicp_params_s& params, __m256& vMin, __m256& vMax)
+{
+  const auto& primaries = *params.primaries;
+
+  const __m256 m [3][3] = {
+    { _mm256_set1_ps (primaries.to_scrgb [0][0]), _mm256_set1_ps (primaries.to_scrgb [0][1]), _mm256_set1_ps (primaries.to_scrgb [0][2]) },
+    { _mm256_set1_ps (primaries.to_scrgb [1][0]), _mm256_set1_ps (primaries.to_scrgb [1][1]), _mm256_set1_ps (primaries.to_scrgb [1][2]) },
+    { _mm256_set1_ps (primaries.to_scrgb [2][0]), _mm256_set1_ps (primaries.to_scrgb [2][1]), _mm256_set1_ps (primaries.to_scrgb [2][2]) }
+  };
+
+  // The row is padded to a multiple of 8 pixels
+  for (size_t x = 0; x < pixels; x += 8)
+  {
+    float* p = row + x * 4;
+
+    const __m256 t0 = _mm256_unpacklo_ps (_mm256_loadu_ps (p +  0), _mm256_loadu_ps (p +  8)); // r0 r2 g0 g2 | r1 r3 g1 g3
+    const __m256 t1 = _mm256_unpackhi_ps (_mm256_loadu_ps (p +  0), _mm256_loadu_ps (p +  8)); // b0 b2 a0 a2 | b1 b3 a1 a3
+    const __m256 t2 = _mm256_unpacklo_ps (_mm256_loadu_ps (p + 16), _mm256_loadu_ps (p + 24)); // r4 r6 g4 g6 | r5 r7 g5 g7
+    const __m256 t3 = _mm256_unpackhi_ps (_mm256_loadu_ps (p + 16), _mm256_loadu_ps (p + 24)); // b4 b6 a4 a6 | b5 b7 a5 a7
+
+    __m256 r = SKIV_Kernel_DecodeTransfer <transfer> (_mm256_shuffle_ps (t0, t2, _MM_SHUFFLE (1, 0, 1, 0)), params);
+    __m256 g = SKIV_Kernel_DecodeTransfer <transfer> (_mm256_shuffle_ps (t0, t2, _MM_SHUFFLE (3, 2, 3, 2)), params);
+    __m256 b = SKIV_Kernel_DecodeTransfer <transfer> (_mm256_shuffle_ps (t1, t3, _MM_SHUFFLE (1, 0, 1, 0)), params);
+    __m256 a =                                        _mm256_shuffle_ps (t1, t3, _MM_SHUFFLE (3, 2, 3, 2));
+
+    // BT.2100 OOTF: Fd = Lw * Ys^(gamma - 1) * E
+    if constexpr (transfer == SKIV_Transfer_HLG)
+    {
+      const __m256 ys =
+        _mm256_fmadd_ps (_mm256_set1_ps (primaries.luma [0]), r,
+        _mm256_fmadd_ps (_mm256_set1_ps (primaries.luma [1]), g,
+        _mm256_mul_ps   (_mm256_set1_ps (primaries.luma [2]), b)));
+
+      const __m256 scale =
+        _mm256_mul_ps (_mm256_set1_ps (params.hlg_peak),
+                       _mm256_pow_ps (_mm256_max_ps (ys, _mm256_set1_ps (FLT_MIN)), _mm256_set1_ps (params.hlg_exponent)));
+
+      r = _mm256_mul_ps (r, scale);
+      g = _mm256_mul_ps (g, scale);
+      b = _mm256_mul_ps (b, scale);
+    }
+
+    __m256 out [3];
+
+    for (int c = 0; c < 3; ++c)
+    {
+      out [c] = _mm256_fmadd_ps (m [c][0], r,
+                _mm256_fmadd_ps (m [c][1], g,
+                _mm256_mul_ps   (m [c][2], b)));
+
+      vMin = _mm256_min_ps (vMin, out [c]);
+      vMax = _mm256_max_ps (vMax, out [c]);
+    }
+
+    // Same permutation in reverse
+    const __m256 u0 = _mm256_unpacklo_ps (out [0], out [1]); // r0 g0 r2 g2 | r1 g1 r3 g3
+    const __m256 u1 = _mm256_unpacklo_ps (out [2], a);       // b0 a0 b2 a2 | b1 a1 b3 a3
+    const __m256 u2 = _mm256_unpackhi_ps (out [0], out [1]); // r4 g4 r6 g6 | r5 g5 r7 g7
+    const __m256 u3 = _mm256_unpackhi_ps (out [2], a);       // b4 a4 b6 a6 | b5 a5 b7 a7
+
+    _mm256_storeu_ps (p +  0, _mm256_shuffle_ps (u0, u1, _MM_SHUFFLE (1, 0, 1, 0)));
+    _mm256_storeu_ps (p +  8, _mm256_shuffle_ps (u0, u1, _MM_SHUFFLE (3, 2, 3, 2)));
+    _mm256_storeu_ps (p + 16, _mm256_shuffle_ps (u2, u3, _MM_SHUFFLE (1, 0, 1, 0)));
+    _mm256_storeu_ps (p + 24, _mm256_shuffle_ps (u2, u3, _MM_SHUFFLE (3, 2, 3, 2)));
+  }
+}
+
+using SKIV_Kernel_DecodeCICPRow_pfn = void (*)(float* row, size_t pixels, const skiv_cicp_params_s& params, __m256& vMin, __m256& vMax);
+
+static constexpr struct {
+  uint8_t                       code;
+  SKIV_Kernel_DecodeCICPRow_pfn kernel;
+  float                         gamma;
+} skiv_cicp_transfers [] = {
+  {  1, SKIV_Kernel_DecodeCICPRow <SKIV_Transfer_BT709>,  0.0f }, // BT.709
+  {  4, SKIV_Kernel_DecodeCICPRow <SKIV_Transfer_Gamma>,  2.2f }, // BT.470 M
+  {  5, SKIV_Kernel_DecodeCICPRow <SKIV_Transfer_Gamma>,  2.8f }, // BT.470 BG
+  {  6, SKIV_Kernel_DecodeCICPRow <SKIV_Transfer_BT709>,  0.0f }, // BT.601
+  {  8, SKIV_Kernel_DecodeCICPRow <SKIV_Transfer_Linear>, 0.0f },
+  { 13, SKIV_Kernel_DecodeCICPRow <SKIV_Transfer_sRGB>,   0.0f },
+  { 14, SKIV_Kernel_DecodeCICPRow <SKIV_Transfer_BT709>,  0.0f }, // BT.2020 (10-bit)
+  { 15, SKIV_Kernel_DecodeCICPRow <SKIV_Transfer_BT709>,  0.0f }, // BT.2020 (12-bit)
+  { 16, SKIV_Kernel_DecodeCICPRow <SKIV_Transfer_PQ>,     0.0f },
+  { 18, SKIV_Kernel_DecodeCICPRow <SKIV_Transfer_HLG>,    0.0f }
+};
+
+HRESULT
+SKIV_Image_DecodeCICP (const DirectX::Image& image, const skiv_cicp_s& cicp, DirectX::ScratchImage& result, bool& wcg, bool& hdr)
+{
+  SKIV_TRACE_SCOPE ("DecodeCICP");
+
+  // The rows are read as RGBA, whatever their encoding
+  const skiv_row_layout_e layout =
+    SKIV_Kernel_IsBGRA8 (image.format) ? SKIV_Row_Unsupported
+                                       : SKIV_Kernel_GetRowLayout (image.format);
+
+  if (layout == SKIV_Row_Unsupported || image.pixels == nullptr)
+    return E_INVALIDARG;
+
+  skiv_cicp_params_s params = {
+    .primaries    = &skiv_cicp_primaries [0],
+    .gamma        = 1.0f,
+    .linear_scale = cicp.linear_scale,
+    .hlg_peak     = cicp.hlg_peak_nits / 80.0f,
+    .hlg_exponent = 0.2f + 0.42f * std::log10 (cicp.hlg_peak_nits / 1000.0f)
+  };
+
+  SKIV_Kernel_DecodeCICPRow_pfn kernel =
+    SKIV_Kernel_DecodeCICPRow <SKIV_Transfer_sRGB>;
+
+  bool supported_primaries = false,
+       supported_transfer  = false;
+
+  for (const auto& primaries : skiv_cicp_primaries)
+  {
+    if (primaries.code == cicp.primaries)
+    {
+      params.primaries    = &primaries;
+      supported_primaries = true;
+    }
+  }
+
+  for (const auto& transfer : skiv_cicp_transfers)
+  {
+    if (transfer.code == cicp.transfer_func)
+    {
+      kernel             = transfer.kernel;
+      params.gamma       = transfer.gamma;
+      supported_transfer = true;
+    }
+  }
+
+  // 2 = Unspecified
+  PLOG_WARNING_IF (! supported_primaries && cicp.primaries     != 2) << "Unsupported CICP primaries "         << (int)cicp.primaries     << ", assuming BT.709";
+  PLOG_WARNING_IF (! supported_transfer  && cicp.transfer_func != 2) << "Unsupported CICP transfer function " << (int)cicp.transfer_func << ", assuming sRGB";
+
+  HRESULT hr =
+    result.Initialize2D (DXGI_FORMAT_R16G16B16A16_FLOAT, image.width, image.height, 1, 1);
+
+  if (FAILED (hr))
+    return hr;
+
+  const DirectX::Image& dst =
+    *result.GetImage (0, 0, 0);
+
+  const size_t band   = SKIV_Kernel_GetBandHeight (image.height);
+  const size_t bands  = (image.height + band - 1) / band;
+  const size_t padded = (image.width + 7) & ~size_t (7);
+
+  // Outside of Rec. 709 / above SDR white by more than rounding noise
+  constexpr float epsilon = 1.0f / 1024.0f;
+
+  std::atomic <bool> any_wcg = false,
+                     any_hdr = false;
+
+  concurrency::parallel_for (size_t (0), bands, [&](size_t band_idx)
+  {
+    // Padding stays 0, which decodes to 0 whatever the transfer function
+    std::vector <float> row (padded * 4, 0.0f);
+
+    __m256 vMin = _mm256_set1_ps ( FLT_MAX),
+           vMax = _mm256_set1_ps (-FLT_MAX);
+
+    const size_t y_end =
+      std::min (image.height, (band_idx + 1) * band);
+
+    for (size_t y = band_idx * band; y < y_end; ++y)
+    {
+      const uint8_t* src =
+        image.pixels + y * image.rowPitch;
+
+      const size_t count = image.width * 4;
+
+      switch (layout)
+      {
+        case SKIV_Row_FP32:
+          memcpy (row.data (), src, count * sizeof (float));
+          break;
+
+        case SKIV_Row_FP16:
+          SKIV_Kernel_GetFP16Kernels ().unpack (reinterpret_cast <const uint16_t *> (src), row.data (), count);
+          break;
+
+        case SKIV_Row_RGBA16:
+          for (size_t i = 0; i < count; ++i)
+            row [i] = static_cast <float> (reinterpret_cast <const uint16_t *> (src) [i]) * (1.0f / 65535.0f);
+          break;
+
+        default:
+          for (size_t i = 0; i < count; ++i)
+            row [i] = static_cast <float> (src [i]) * (1.0f / 255.0f);
+          break;
+      }
+
+      kernel (row.data (), image.width, params, vMin, vMax);
+
+      SKIV_Kernel_GetFP16Kernels ().pack (row.data (), reinterpret_cast <uint16_t *> (dst.pixels + y * dst.rowPitch), count);
+    }
+
+    alignas (32) float lanes [2][8];
+
+    _mm256_store_ps (lanes [0], vMin);
+    _mm256_store_ps (lanes [1], vMax);
+
+    if (*std::min_element (lanes [0], lanes [0] + 8) < -epsilon)
+      any_wcg = true;
+
+    if (*std::max_element (lanes [1], lanes [1] + 8) > 1.0f + epsilon)
+      any_hdr = true;
+  });
+
+  wcg = any_wcg.load ();
+  hdr = any_hdr.load ();
+
+  return S_OK;
+}
+
+#pragma endregion
@@ -0,0 +1,604 @@
+#include "utility/image.h"
+#include "utility/trace.h"
+#include <plog/Log.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <immintrin.h>
+#include <ppl.h>
+
+// Radiance RGBE (.hdr) decoding and encoding
+//
+//   DirectX::LoadFromHDRMemory / SaveToHDRFile decode and encode one scanline
+//     after another, converting every pixel between RGBE and float on its own.
+//
+//   Here a quick serial pass locates every scanline (new-style RLE only needs
+//     its run headers to be walked), after which the scanlines are decoded and
+//       converted to FP16 scRGB eight pixels at a time, one band of rows per
+//         task. The encoder converts and run-length encodes each band into its
+//           own buffer, and the buffers are joined in order at the end.
+
+#pragma region Helpers
+
+// Runs shorter than this are cheaper to store as literals
+constexpr size_t SKIV_RADIANCE_MIN_RUN = 4;
+
+// Values above this (and anything not finite) would overflow the exponent
+constexpr float  SKIV_RADIANCE_MAX     = 1e37f;
+
+static size_t
+SKIV_Radiance_GetBandHeight (size_t height)
+{
+  static const size_t
+    num_cpus = std::max (1U, std::thread::hardware_concurrency ());
+
+  return
+    std::max <size_t> (1, height / (num_cpus * 4));
+}
+
+// Decodes a single scanline starting at data into rgbe (width * 4 bytes), or
+//   only measures it if rgbe is nullptr; returns the bytes consumed, 0 on error
+static size_t
+SKIV_Radiance_ReadScanline (const uint8_t* data, const uint8_t* end, size_t width, uint8_t* rgbe)
+{
+  const uint8_t* pos = data;
+
+  if (end - pos < 4)
+    return 0;
+
+  // New-style RLE: each component run-length encoded on its own
+  if (width >= 8 && width <= 0x7FFF && pos [0] == 2 && pos [1] == 2 && (pos [2] & 0x80) == 0)
+  {
+    if (((size_t (pos [2]) << 8) | pos [3]) != width)
+      return 0;
+
+    pos += 4;
+
+    for (size_t c = 0; c < 4; ++c)
+    {
+      for (size_t x = 0; x < width; )
+      {
+        if (pos >= end)
+          return 0;
+
+        size_t count = *pos++;
+
+        if (count > 128)
+        {
+          count -= 128;
+
+          if (x + count > width || pos >= end)
+            return 0;
+
+          if (rgbe != nullptr)
+          {
+            for (size_t i = 0; i < count; ++i)
+              rgbe [(x + i) * 4 + c] = *pos;
+          }
+
+          pos++;
+        }
+
+        else
+        {
+          if (count == 0 || x + count > width || static_cast <size_t> (end - pos) < count)
+            return 0;
+
+          if (rgbe != nullptr)
+          {
+            for (size_t i = 0; i < count; ++i)
+              rgbe [(x + i) * 4 + c] = pos [i];
+          }
+
+          pos += count;
+        }
+
+        x += count;
+      }
+    }
+
+    return pos - data;
+  }
+
+  // Flat pixels, with old-style RLE: (1, 1, 1, n) repeats the previous pixel n
+  //   times, shifted left by 8 bits for every repeat that immediately follows
+  uint32_t previous = 0;
+  int      shift    = 0;
+
+  for (size_t x = 0; x < width; )
+  {
+    if (end - pos < 4)
+      return 0;
+
+    uint32_t pixel;
+    memcpy (&pixel, pos, 4);
+    pos += 4;
+
+    if (pos [-4] == 1 && pos [-3] == 1 && pos [-2] == 1)
+    {
+      const size_t count =
+        (shift < 24) ? static_cast <size_t> (pos [-1]) << shift : SIZE_MAX;
+
+      if (x == 0 || count > width - x)
+        return 0;
+
+      if (rgbe != nullptr)
+      {
+        for (size_t i = 0; i < count; ++i)
+          memcpy (&rgbe [(x + i) * 4], &previous, 4);
+      }
+
+      x     += count;
+      shift += 8;
+    }
+
+    else
+    {
+      if (rgbe != nullptr)
+        memcpy (&rgbe [x * 4], &pixel, 4);
+
+      previous = pixel;
+      shift    = 0;
+      x++;
+    }
+  }
+
+  return pos - data;
+}
+
+// RGBE to RGBA32F, alpha 1; multiplied by scale (the inverse of the file's
+//   exposure) before clamping to the FP16 range
+static void
+SKIV_Radiance_DecodeRGBE (const uint8_t* rgbe, float* rgba, size_t width, float scale)
+{
+  const __m256i byte_mask = _mm256_set1_epi32 (0xFF);
+  const __m256  fp16_max  = _mm256_set1_ps    (65504.0f);
+  const __m256  one       = _mm256_set1_ps    (1.0f);
+  const __m256  exposure  = _mm256_set1_ps    (scale);
+
+  size_t x = 0;
+
+  for (; x + 8 <= width; x += 8)
+  {
+    const __m256i px =
+      _mm256_loadu_si256 (reinterpret_cast <const __m256i *> (rgbe + x * 4));
+
+    const __m256i e = _mm256_srli_epi32 (px, 24);
+
+    // 2^(e - 136) built from its bits; exponents this small are 0 anyway
+    const __m256 f =
+      _mm256_mul_ps (
+        _mm256_and_ps (_mm256_castsi256_ps (_mm256_slli_epi32 (_mm256_sub_epi32 (e, _mm256_set1_epi32 (9)), 23)),
+                       _mm256_castsi256_ps (_mm256_cmpgt_epi32 (e, _mm256_set1_epi32 (9)))), exposure);
+
+    // FP16 tops out at 65504, where the sun in an environment map does not
+    const __m256 r = _mm256_min_ps (_mm256_mul_ps (_mm256_cvtepi32_ps (_mm256_and_si256 (                   px,      byte_mask)), f), fp16_max);
+    const __m256 g = _mm256_min_ps (_mm256_mul_ps (_mm256_cvtepi32_ps (_mm256_and_si256 (_mm256_srli_epi32 (px,  8), byte_mask)), f), fp16_max);
+    const __m256 b = _mm256_min_ps (_mm256_mul_ps (_mm256_cvtepi32_ps (_mm256_and_si256 (_mm256_srli_epi32 (px, 16), byte_mask)), f), fp16_max);
+
+    const __m256 t0 = _mm256_unpacklo_ps (r, g);   // r0 g0 r1 g1 | r4 g4 r5 g5
+    const __m256 t1 = _mm256_unpacklo_ps (b, one); // b0 1  b1 1  | b4 1  b5 1
+    const __m256 t2 = _mm256_unpackhi_ps (r, g);   // r2 g2 r3 g3 | r6 g6 r7 g7
+    const __m256 t3 = _mm256_unpackhi_ps (b, one); // b2 1  b3 1  | b6 1  b7 1
+
+    const __m256 p01 = _mm256_shuffle_ps (t0, t1, _MM_SHUFFLE (1, 0, 1, 0)); // p0 | p4
+    const __m256 p23 = _mm256_shuffle_ps (t0, t1, _MM_SHUFFLE (3, 2, 3, 2)); // p1 | p5
+    const __m256 p45 = _mm256_shuffle_ps (t2, t3, _MM_SHUFFLE (1, 0, 1, 0)); // p2 | p6
+    const __m256 p67 = _mm256_shuffle_ps (t2, t3, _MM_SHUFFLE (3, 2, 3, 2)); // p3 | p7
+
+    float* dst = rgba + x * 4;
+
+    _mm256_storeu_ps (dst +  0, _mm256_permute2f128_ps (p01, p23, 0x20)); // p0 p1
+    _mm256_storeu_ps (dst +  8, _mm256_permute2f128_ps (p45, p67, 0x20)); // p2 p3
+    _mm256_storeu_ps (dst + 16, _mm256_permute2f128_ps (p01, p23, 0x31)); // p4 p5
+    _mm256_storeu_ps (dst + 24, _mm256_permute2f128_ps (p45, p67, 0x31)); // p6 p7
+  }
+
+  for (; x < width; ++x)
+  {
+    const uint8_t* px = rgbe + x * 4;
+    const float    f  = (px [3] > 9) ? std::ldexp (1.0f, px [3] - 136) * scale : 0.0f;
+
+    rgba [x * 4 + 0] = std::min (px [0] * f, 65504.0f);
+    rgba [x * 4 + 1] = std::min (px [1] * f, 65504.0f);
+    rgba [x * 4 + 2] = std::min (px [2] * f, 65504.0f);
+    rgba [x * 4 + 3] = 1.0f;
+  }
+}
+
+// RGBA32F to RGBE; negative components become 0, as in Radiance's setcolr ( )
+static void
+SKIV_Radiance_EncodeRGBE (const float* rgba, uint8_t* rgbe, size_t width)
+{
+  const __m256 zero    = _mm256_setzero_ps ();
+  const __m256 max     = _mm256_set1_ps    (SKIV_RADIANCE_MAX);
+  const __m256 min     = _mm256_set1_ps    (1e-32f);
+
+  size_t x = 0;
+
+  for (; x + 8 <= width; x += 8)
+  {
+    const float* src = rgba + x * 4;
+
+    const __m256 p0 = _mm256_loadu_ps (src +  0);
+    const __m256 p1 = _mm256_loadu_ps (src +  8);
+    const __m256 p2 = _mm256_loadu_ps (src + 16);
+    const __m256 p3 = _mm256_loadu_ps (src + 24);
+
+    const __m256 t0 = _mm256_unpacklo_ps (p0, p1); // r0 r2 g0 g2 | r1 r3 g1 g3
+    const __m256 t1 = _mm256_unpackhi_ps (p0, p1); // b0 b2 a0 a2 | b1 b3 a1 a3
+    const __m256 t2 = _mm256_unpacklo_ps (p2, p3); // r4 r6 g4 g6 | r5 r7 g5 g7
+    const __m256 t3 = _mm256_unpackhi_ps (p2, p3); // b4 b6 a4 a6 | b5 b7 a5 a7
+
+    // max_ps returns its second operand for NaN, so NaN becomes 0
+    const __m256 r = _mm256_min_ps (_mm256_max_ps (_mm256_shuffle_ps (t0, t2, _MM_SHUFFLE (1, 0, 1, 0)), zero), max);
+    const __m256 g = _mm256_min_ps (_mm256_max_ps (_mm256_shuffle_ps (t0, t2, _MM_SHUFFLE (3, 2, 3, 2)), zero), max);
+    const __m256 b = _mm256_min_ps (_mm256_max_ps (_mm256_shuffle_ps (t1, t3, _MM_SHUFFLE (1, 0, 1, 0)), zero), max);
+
+    const __m256  v     = _mm256_max_ps (r, _mm256_max_ps (g, b));
+    const __m256i bits  = _mm256_srli_epi32 (_mm256_castps_si256 (v), 23);
+
+    // frexp (v) = m * 2^(bits - 126), m in [0.5, 1); the mantissas are
+    //   component * 2^(8 - (bits - 126)), truncated like Radiance does
+    const __m256 scale =
+      _mm256_castsi256_ps (_mm256_slli_epi32 (_mm256_sub_epi32 (_mm256_set1_epi32 (261), bits), 23));
+
+    const __m256i mask = _mm256_castps_si256 (_mm256_cmp_ps (v, min, _CMP_GE_OQ));
+
+    const __m256i mr = _mm256_cvttps_epi32 (_mm256_mul_ps (r, scale));
+    const __m256i mg = _mm256_cvttps_epi32 (_mm256_mul_ps (g, scale));
+    const __m256i mb = _mm256_cvttps_epi32 (_mm256_mul_ps (b, scale));
+    const __m256i e  = _mm256_add_epi32    (bits, _mm256_set1_epi32 (2));
+
+    const __m256i packed =
+      _mm256_and_si256 (mask,
+        _mm256_or_si256 (_mm256_or_si256 (mr, _mm256_slli_epi32 (mg,  8)),
+                         _mm256_or_si256 (_mm256_slli_epi32 (mb, 16), _mm256_slli_epi32 (e, 24))));
+
+    // Undo the lane permutation (0, 2, 4, 6, 1, 3, 5, 7)
+    _mm256_storeu_si256 (reinterpret_cast <__m256i *> (rgbe + x * 4),
+      _mm256_permutevar8x32_epi32 (packed, _mm256_setr_epi32 (0, 4, 1, 5, 2, 6, 3, 7)));
+  }
+
+  for (; x < width; ++x)
+  {
+    float c [3];
+
+    for (int i = 0; i < 3; ++i)
+    {
+      const float value = rgba [x * 4 + i];
+      c [i] = (value > 0.0f) ? std::min (value, SKIV_RADIANCE_MAX) : 0.0f;
+    }
+
+    const float v = std::max (c [0], std::max (c [1], c [2]));
+
+    uint8_t* px = rgbe + x * 4;
+
+    if (v < 1e-32f)
+    {
+      memset (px, 0, 4);
+      continue;
+    }
+
+    int         exponent;
+    const float scale = std::frexp (v, &exponent) * 256.0f / v;
+
+    px [0] = static_cast <uint8_t> (c [0] * scale);
+    px [1] = static_cast <uint8_t> (c [1] * scale);
+    px [2] = static_cast <uint8_t> (c [2] * scale);
+    px [3] = static_cast <uint8_t> (exponent + 128);
+  }
+}
+
+// New-style RLE, one component after another
+static void
+SKIV_Radiance_WriteScanline (const uint8_t* rgbe, size_t width, std::vector <uint8_t>& out)
+{
+  out.push_back (2);
+  out.push_back (2);
+  out.push_back (static_cast <uint8_t> (width >> 8));
+  out.push_back (static_cast <uint8_t> (width & 0xFF));
+
+  for (size_t c = 0; c < 4; ++c)
+  {
+    auto value = [&](size_t x) { return rgbe [x * 4 + c]; };
+
+    for (size_t x = 0; x < width; )
+    {
+      // Find the next run worth encoding
+      size_t run_start = x,
+             run_count = 0;
+
+      while (run_start < width)
+      {
+        run_count = 1;
+
+        while (run_start + run_count < width && run_count < 127 && value (run_start + run_count) == value (run_start))
+          run_count++;
+
+        if (run_count >= SKIV_RADIANCE_MIN_RUN)
+          break;
+
+        run_start += run_count;
+      }
+
+      // Literals up to the run
+      while (x < run_start && x < width)
+      {
+        const size_t count =
+          std::min <size_t> (128, std::min (run_start, width) - x);
+
+        out.push_back (static_cast <uint8_t> (count));
+
+        for (size_t i = 0; i < count; ++i)
+          out.push_back (value (x + i));
+
+        x += count;
+      }
+
+      if (run_start < width)
+      {
+        out.push_back (static_cast <uint8_t> (128 + run_count));
+        out.push_back (value (run_start));
+
+        x = run_start + run_count;
+      }
+    }
+  }
+}
+
+#pragma endregion
+
+HRESULT
+SKIV_Image_LoadRadiance (const void* data, size_t size, DirectX::ScratchImage& result)
+{
+  SKIV_TRACE_SCOPE ("LoadRadiance");
+
+  const uint8_t* begin = static_cast <const uint8_t *> (data);
+  const uint8_t* end   = begin + size;
+  const uint8_t* pos   = begin;
+
+  auto _ReadLine = [&](std::string& line)
+  {
+    const uint8_t* eol =
+      static_cast <const uint8_t *> (memchr (pos, '\n', end - pos));
+
+    if (eol == nullptr)
+      return false;
+
+    line.assign (reinterpret_cast <const char *> (pos), eol - pos);
+    pos = eol + 1;
+
+    return true;
+  };
+
+  std::string line;
+
+  if (! _ReadLine (line) || (line != "#?RADIANCE" && line != "#?RGBE"))
+    return E_FAIL;
+
+  float exposure = 1.0f;
+
+  // Variables, up to an empty line
+  while (true)
+  {
+    if (! _ReadLine (line))
+      return E_FAIL;
+
+    if (line.empty ())
+      break;
+
+    if (line.starts_with ("FORMAT=") && line != "FORMAT=32-bit_rle_rgbe")
+    {
+      PLOG_WARNING << "Unsupported Radiance " << line.c_str ();
+      return E_NOTIMPL;
+    }
+
+    // Radiance multiplies, and reading the file divides, every exposure applied
+    if (line.starts_with ("EXPOSURE="))
+    {
+      const float value =
+        static_cast <float> (std::atof (line.c_str () + 9));
+
+      if (value > 0.0f && std::isfinite (value))
+        exposure *= value;
+    }
+  }
+
+  // Resolution: only row-major orientations (Y first)
+  char   y_sign = 0,
+         x_sign = 0;
+  size_t height = 0,
+         width  = 0;
+
+  if (! _ReadLine (line) || sscanf_s (line.c_str (), "%cY %zu %cX %zu", &y_sign, 1, &height, &x_sign, 1, &width) != 4)
+  {
+    PLOG_WARNING << "Unsupported Radiance resolution string";
+    return E_NOTIMPL;
+  }
+
+  if (width == 0 || height == 0 || width > 65536 || height > 65536 ||
+      (y_sign != '-' && y_sign != '+') || (x_sign != '-' && x_sign != '+'))
+    return E_FAIL;
+
+  // Locate every scanline first
+  std::vector <size_t> offsets (height + 1);
+
+  for (size_t y = 0; y < height; ++y)
+  {
+    offsets [y] = pos - begin;
+
+    const size_t bytes =
+      SKIV_Radiance_ReadScanline (pos, end, width, nullptr);
+
+    if (bytes == 0)
+    {
+      PLOG_ERROR << "Corrupt Radiance scanline " << y;
+      return E_FAIL;
+    }
+
+    pos += bytes;
+  }
+
+  HRESULT hr =
+    result.Initialize2D (DXGI_FORMAT_R16G16B16A16_FLOAT, width, height, 1, 1);
+
+  if (FAILED (hr))
+    return hr;
+
+  const DirectX::Image& dst =
+    *result.GetImage (0, 0, 0);
+
+  const size_t band  = SKIV_Radiance_GetBandHeight (height);
+  const size_t bands = (height + band - 1) / band;
+
+  const float inv_exposure = 1.0f / exposure;
+
+  concurrency::parallel_for (size_t (0), bands, [&](size_t band_idx)
+  {
+    std::vector <uint8_t> rgbe (width * 4);
+    std::vector <float>   rgba (width * 4);
+
+    const size_t y_end =
+      std::min (height, (band_idx + 1) * band);
+
+    for (size_t y = band_idx * band; y < y_end; ++y)
+    {
+      SKIV_Radiance_ReadScanline (begin + offsets [y], end, width, rgbe.data ());
+      SKIV_Radiance_DecodeRGBE   (rgbe.data (), rgba.data (), width, inv_exposure);
+
+      // +X runs left to right, -Y top to bottom
+      if (x_sign == '-')
+      {
+        for (size_t x = 0; x < width / 2; ++x)
+          std::swap_ranges (&rgba [x * 4], &rgba [x * 4 + 4], &rgba [(width - 1 - x) * 4]);
+      }
+
+      const size_t row =
+        (y_sign == '-') ? y : height - 1 - y;
+
+      SKIV_Image_PackFP32toFP16 (rgba.data (), reinterpret_cast <uint16_t *> (dst.pixels + row * dst.rowPitch), width * 4);
+    }
+  });
+
+  return S_OK;
+}
+
+HRESULT
+SKIV_Image_SaveRadiance (const DirectX::Image& image, DirectX::Blob& blob)
+{
+  SKIV_TRACE_SCOPE ("SaveRadiance");
+
+  if (image.pixels == nullptr || image.width == 0 || image.height == 0)
+    return E_INVALIDARG;
+
+  if (image.format != DXGI_FORMAT_R16G16B16A16_FLOAT &&
+      image.format != DXGI_FORMAT_R32G32B32A32_FLOAT)
+    return HRESULT_FROM_WIN32 (ERROR_NOT_SUPPORTED);
+
+  const size_t width  = image.width,
+               height = image.height;
+
+  const std::string header =
+    "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y " + std::to_string (height) + " +X " + std::to_string (width) + "\n";
+
+  const size_t band  = SKIV_Radiance_GetBandHeight (height);
+  const size_t bands = (height + band - 1) / band;
+
+  std::vector <std::vector <uint8_t>> encoded (bands);
+
+  concurrency::parallel_for (size_t (0), bands, [&](size_t band_idx)
+  {
+    std::vector <float>   rgba (width * 4);
+    std::vector <uint8_t> rgbe (width * 4);
+
+    std::vector <uint8_t>& out = encoded [band_idx];
+
+    const size_t y_end =
+      std::min (height, (band_idx + 1) * band);
+
+    out.reserve ((y_end - band_idx * band) * width * 4);
+
+    for (size_t y = band_idx * band; y < y_end; ++y)
+    {
+      const uint8_t* src =
+        image.pixels + y * image.rowPitch;
+
+      if (image.format == DXGI_FORMAT_R16G16B16A16_FLOAT)
+        SKIV_Image_UnpackFP16toFP32 (reinterpret_cast <const uint16_t *> (src), rgba.data (), width * 4);
+      else
+        memcpy (rgba.data (), src, width * 4 * sizeof (float));
+
+      SKIV_Radiance_EncodeRGBE (rgba.data (), rgbe.data (), width);
+
+      // Scanlines outside of what new-style RLE can describe are stored flat
+      if (width >= 8 && width <= 0x7FFF)
+        SKIV_Radiance_WriteScanline (rgbe.data (), width, out);
+      else
+        out.insert (out.end (), rgbe.begin (), rgbe.end ());
+    }
+  });
+
+  size_t total = header.size ();
+
+  for (const auto& part : encoded)
+    total += part.size ();
+
+  HRESULT hr =
+    blob.Initialize (total);
+
+  if (FAILED (hr))
+    return hr;
+
+  uint8_t* dst =
+    static_cast <uint8_t *> (blob.GetBufferPointer ());
+
+  memcpy (dst, header.data (), header.size ());
+  dst += header.size ();
+
+  for (const auto& part : encoded)
+  {
+    memcpy (dst, part.data (), part.size ());
+    dst += part.size ();
+  }
+
+  return S_OK;
+}
+
+HRESULT
+SKIV_Image_SaveRadianceToFile (const DirectX::Image& image, const wchar_t* wszFileName)
+{
+  DirectX::Blob blob;
+
+  HRESULT hr =
+    SKIV_Image_SaveRadiance (image, blob);
+
+  if (FAILED (hr))
+    return hr;
+
+  HANDLE hFile =
+    CreateFileW (wszFileName, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+  if (hFile == INVALID_HANDLE_VALUE)
+    return HRESULT_FROM_WIN32 (GetLastError ());
+
+  DWORD dwWritten = 0;
+
+  const bool written =
+    WriteFile (hFile, blob.GetBufferPointer (), static_cast <DWORD> (blob.GetBufferSize ()), &dwWritten, nullptr) &&
+    dwWritten == blob.GetBufferSize ();
+
+  hr = written ? S_OK : HRESULT_FROM_WIN32 (GetLastError ());
+
+  CloseHandle (hFile);
+
+  if (! written)
+    DeleteFileW (wszFileName);
+
+  return hr;
+}
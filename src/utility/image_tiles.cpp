@@ -0,0 +1,192 @@
+#include <utility/image_tiles.h>
+#include <utility/image.h>
+#include <utility/trace.h>
+#include <plog/Log.h>
+#include <concurrent_queue.h>
+#include <algorithm>
+#include <cmath>
+
+extern concurrency::concurrent_queue <IUnknown *> SKIF_ResourcesToFree;
+
+static void
+SKIV_Tiles_Evict (skiv_image_tile_s& tile, size_t& resident_bytes)
+{
+  PLOG_VERBOSE << "SKIF_ResourcesToFree: Pushing " << tile.pSRV.p << " to be released";
+  SKIF_ResourcesToFree.push (tile.pSRV.Detach ());
+
+  resident_bytes -= std::min (resident_bytes, tile.pixels.slicePitch);
+}
+
+HRESULT
+skiv_tiled_image_s::Create (DirectX::ScratchImage&& source, size_t size)
+{
+  SKIV_TRACE_SCOPE ("CreateTiles");
+
+  const DirectX::Image* pImage =
+    source.GetImage (0, 0, 0);
+
+  if (pImage == nullptr || size == 0)
+    return E_INVALIDARG;
+
+  const size_t bits_per_pixel =
+    DirectX::BitsPerPixel (pImage->format);
+
+  if (bits_per_pixel == 0 || (bits_per_pixel % 8) != 0 ||
+      DirectX::IsCompressed (pImage->format) ||
+      DirectX::IsPlanar     (pImage->format))
+    return E_INVALIDARG;
+
+  const size_t bytes_per_pixel = bits_per_pixel / 8;
+
+  ReleaseTextures ( );
+
+  image     = std::move (source);
+  pImage    = image.GetImage (0, 0, 0);
+
+  width     = pImage->width;
+  height    = pImage->height;
+  format    = pImage->format;
+  tile_size = size;
+  columns   = (width  + size - 1) / size;
+  rows      = (height + size - 1) / size;
+
+  tiles.clear  ( );
+  tiles.resize (columns * rows);
+
+  for (size_t idx = 0; idx < tiles.size (); ++idx)
+  {
+    auto& tile = tiles [idx];
+
+    tile.x      = (idx % columns) * size;
+    tile.y      = (idx / columns) * size;
+    tile.width  = std::min (size, width  - tile.x);
+    tile.height = std::min (size, height - tile.y);
+
+    // Rows keep the pitch of the full image, which D3D11 takes as the pitch of the initial data
+    tile.pixels.width      = tile.width;
+    tile.pixels.height     = tile.height;
+    tile.pixels.format     = format;
+    tile.pixels.rowPitch   = pImage->rowPitch;
+    tile.pixels.slicePitch = tile.width * tile.height * bytes_per_pixel;
+    tile.pixels.pixels     = pImage->pixels + tile.y * pImage->rowPitch
+                                            + tile.x * bytes_per_pixel;
+  }
+
+  PLOG_INFO << "Split " << width << "x" << height << " image into " << columns << "x" << rows
+            << " tiles of " << size << "x" << size;
+
+  return S_OK;
+}
+
+HRESULT
+skiv_tiled_image_s::CreatePreview (DirectX::ScratchImage& preview, size_t max_dimension)
+{
+  SKIV_TRACE_SCOPE ("CreateTilePreview");
+
+  if (tiles.empty () || max_dimension == 0)
+    return E_INVALIDARG;
+
+  const double scale =
+    std::min (1.0, static_cast <double> (max_dimension) /
+                   static_cast <double> (std::max (width, height)));
+
+  preview_width  = std::max (size_t { 1 }, static_cast <size_t> (std::round (static_cast <double> (width)  * scale)));
+  preview_height = std::max (size_t { 1 }, static_cast <size_t> (std::round (static_cast <double> (height) * scale)));
+
+  // The resampler works through bands of rows in parallel and only buffers
+  //   the source rows of its current band
+  return
+    SKIV_Image_Resample (*image.GetImage (0, 0, 0), preview_width, preview_height, SKIV_ResampleFilter_Area, preview);
+}
+
+void
+skiv_tiled_image_s::UpdateResidency (ID3D11Device* pDevice, float x0, float y0, float x1, float y1)
+{
+  frame++;
+
+  if (tiles.empty () || x1 <= x0 || y1 <= y0)
+    return;
+
+  auto _ToTile = [&](float pos, size_t count) -> size_t
+  {
+    return static_cast <size_t> (
+      std::clamp (std::floor (pos / static_cast <float> (tile_size)), 0.0f, static_cast <float> (count - 1))
+    );
+  };
+
+  const size_t col0 = _ToTile (x0, columns), col1 = _ToTile (std::max (x0, x1 - 1.0f), columns);
+  const size_t row0 = _ToTile (y0, rows),    row1 = _ToTile (std::max (y0, y1 - 1.0f), rows);
+
+  size_t uploads = 0;
+
+  for (size_t row = row0; row <= row1; ++row)
+  {
+    for (size_t col = col0; col <= col1; ++col)
+    {
+      auto& tile = tiles [row * columns + col];
+
+      tile.last_used = frame;
+
+      // Not-yet-resident tiles keep showing the overview underneath, so spreading
+      //   the uploads over a few frames avoids a hitch when panning quickly.
+      if (tile.pSRV.p != nullptr || pDevice == nullptr || uploads >= SKIV_TILE_UPLOADS_PER_FRAME)
+        continue;
+
+      uploads++;
+
+      SKIV_TRACE_SCOPE ("UploadTile");
+
+      DirectX::TexMetadata meta = { };
+
+      meta.width     = tile.width;
+      meta.height    = tile.height;
+      meta.depth     = 1;
+      meta.arraySize = 1;
+      meta.mipLevels = 1;
+      meta.format    = format;
+      meta.dimension = DirectX::TEX_DIMENSION_TEXTURE2D;
+
+      CComPtr <ID3D11Resource> pTex;
+
+      if (SUCCEEDED (DirectX::CreateTexture (pDevice, &tile.pixels, 1, meta, &pTex.p)) &&
+          SUCCEEDED (pDevice->CreateShaderResourceView (pTex.p, nullptr, &tile.pSRV.p)))
+        resident_bytes += tile.pixels.slicePitch;
+
+      else
+        PLOG_ERROR << "Failed to upload the image tile at " << tile.x << "," << tile.y;
+    }
+  }
+
+  if (resident_bytes > budget)
+  {
+    std::vector <skiv_image_tile_s*> candidates;
+
+    for (auto& tile : tiles)
+      if (tile.pSRV.p != nullptr && tile.last_used != frame)
+        candidates.push_back (&tile);
+
+    std::sort (candidates.begin (), candidates.end (),
+      [](const skiv_image_tile_s* a, const skiv_image_tile_s* b) { return a->last_used < b->last_used; });
+
+    // Visible tiles are never evicted, even if they alone exceed the budget
+    for (auto* tile : candidates)
+    {
+      if (resident_bytes <= budget)
+        break;
+
+      SKIV_Tiles_Evict (*tile, resident_bytes);
+    }
+  }
+
+  SKIV_Trace_Counter ("Resident Tiles (MiB)", static_cast <double> (resident_bytes) / (1024.0 * 1024.0));
+}
+
+void
+skiv_tiled_image_s::ReleaseTextures (void)
+{
+  for (auto& tile : tiles)
+    if (tile.pSRV.p != nullptr)
+      SKIV_Tiles_Evict (tile, resident_bytes);
+
+  resident_bytes = 0;
+}
@@ -0,0 +1,201 @@
+#include <utility/plog_async.h>
+#include <utility/plog_formatter.h>
+#include <utility/sk_utility.h>
+#include <utility/utility.h>
+#include <cassert>
+
+// How long the flusher sleeps when nobody wakes it up
+constexpr DWORD SKIV_ASYNCLOG_INTERVAL_MS = 50;
+
+SKIV_AsyncLogAppender::SKIV_AsyncLogAppender (const wchar_t* path, size_t max_file_size, size_t capacity) :
+  slots     (std::make_unique <slot_s []> (capacity)),
+  mask      (capacity - 1),
+  file_path (path),
+  max_size  (max_file_size)
+{
+  assert ((capacity & mask) == 0);
+
+  for (size_t i = 0; i < capacity; ++i)
+    slots [i].sequence.store (i, std::memory_order_relaxed);
+
+  wake   = CreateEvent (nullptr, FALSE, FALSE, nullptr);
+  thread = std::thread ([this] { flusher (); });
+}
+
+SKIV_AsyncLogAppender::~SKIV_AsyncLogAppender (void)
+{
+  stopping = true;
+  SetEvent (wake);
+
+  if (thread.joinable ())
+    thread.join ();
+
+  flush ();
+
+  if (file != INVALID_HANDLE_VALUE)
+    CloseHandle (file);
+
+  CloseHandle (wake);
+}
+
+void
+SKIV_AsyncLogAppender::write (const plog::Record& record)
+{
+  size_t  pos = enqueue_pos.load (std::memory_order_relaxed);
+  slot_s* slot;
+
+  while (true)
+  {
+    slot = &slots [pos & mask];
+
+    const intptr_t diff =
+      static_cast <intptr_t> (slot->sequence.load (std::memory_order_acquire)) - static_cast <intptr_t> (pos);
+
+    if (diff == 0)
+    {
+      if (enqueue_pos.compare_exchange_weak (pos, pos + 1, std::memory_order_relaxed))
+        break;
+    }
+
+    // The flusher has not caught up with this slot yet
+    else if (diff < 0)
+    {
+      records_dropped.fetch_add (1, std::memory_order_relaxed);
+      SetEvent (wake);
+      return;
+    }
+
+    else
+      pos = enqueue_pos.load (std::memory_order_relaxed);
+  }
+
+  // The strings keep their capacity from the last lap, so this rarely allocates
+  entry_s& entry = slot->entry;
+
+  entry.time     = record.getTime     ();
+  entry.severity = record.getSeverity ();
+  entry.tid      = record.getTid      ();
+  entry.line     = record.getLine     ();
+  entry.func     = record.getFunc     ();
+  entry.message  = record.getMessage  ();
+
+  // The slot belongs to the flusher from here on
+  const plog::Severity severity =
+    entry.severity;
+
+  slot->sequence.store (pos + 1, std::memory_order_release);
+
+  if (severity == plog::fatal)
+    flush ();
+
+  // Errors are written out promptly, and the flusher is nudged well before the ring fills up
+  else if (severity <= plog::error || (pos & (mask >> 2)) == 0)
+    SetEvent (wake);
+}
+
+bool
+SKIV_AsyncLogAppender::flush (void)
+{
+  // The flusher may have been interrupted mid-batch by a crash on another thread
+  std::unique_lock <std::timed_mutex> _(flush_lock, std::chrono::milliseconds (250));
+
+  if (! _.owns_lock ())
+    return false;
+
+  drain ();
+
+  return true;
+}
+
+void
+SKIV_AsyncLogAppender::drain (void)
+{
+  batch.clear ();
+
+  uint64_t records = 0;
+
+  while (true)
+  {
+    slot_s& slot = slots [dequeue_pos & mask];
+
+    if (slot.sequence.load (std::memory_order_acquire) != dequeue_pos + 1)
+      break;
+
+    const entry_s& entry = slot.entry;
+
+    batch += SK_WideCharToUTF8 (
+      plog::LogFormatterUtcTime::format (entry.time, entry.severity, entry.tid, entry.line, entry.func.c_str (), entry.message.c_str ())
+    );
+
+    // Hand the slot back to the producers for the next lap
+    slot.sequence.store (dequeue_pos + mask + 1, std::memory_order_release);
+    dequeue_pos++;
+    records++;
+  }
+
+  const uint64_t dropped =
+    records_dropped.load (std::memory_order_relaxed);
+
+  if (dropped != dropped_logged)
+  {
+    plog::util::Time now;
+    plog::util::ftime (&now);
+
+    const std::wstring message =
+      std::to_wstring (dropped - dropped_logged) + L" log records were dropped as the log could not keep up!";
+
+    batch += SK_WideCharToUTF8 (
+      plog::LogFormatterUtcTime::format (now, plog::warning, plog::util::gettid (), __LINE__, __FUNCTION__, message.c_str ())
+    );
+
+    dropped_logged = dropped;
+  }
+
+  if (batch.empty ())
+    return;
+
+  if (file != INVALID_HANDLE_VALUE && file_size + batch.size () > max_size)
+  {
+    CloseHandle (file);
+    file = INVALID_HANDLE_VALUE;
+  }
+
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    file =
+      CreateFileW (file_path.c_str (), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                   CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    file_size = 0;
+
+    if (file == INVALID_HANDLE_VALUE)
+      return;
+
+    // Same as plog's UTF-8 converter
+    batch.insert (0, "\xEF\xBB\xBF");
+  }
+
+  DWORD dwWritten = 0;
+
+  if (WriteFile (file, batch.data (), static_cast <DWORD> (batch.size ()), &dwWritten, nullptr))
+    file_size += dwWritten;
+
+  records_written.fetch_add (records, std::memory_order_relaxed);
+}
+
+void
+SKIV_AsyncLogAppender::flusher (void)
+{
+  SKIF_Util_SetThreadDescription (GetCurrentThread (), L"SKIV_LogFlusher");
+
+  SetThreadPriority (GetCurrentThread (), THREAD_PRIORITY_LOWEST);
+
+  while (! stopping.load ())
+  {
+    WaitForSingleObject (wake, SKIV_ASYNCLOG_INTERVAL_MS);
+
+    std::scoped_lock <std::timed_mutex> _(flush_lock);
+
+    drain ();
+  }
+}
@@ -308,6 +308,15 @@ SKIF_RegistrySettings::SKIF_RegistrySettings (void)
   if (regKVDiagnostics.hasData(&hKey))
     iDiagnostics           =   regKVDiagnostics            .getData (&hKey);
 
+  if (regKVBufferPoolCap.hasData(&hKey))
+    iBufferPoolCap         =   regKVBufferPoolCap          .getData (&hKey);
+
+  if (regKVImageCacheCap.hasData(&hKey))
+    iImageCacheCap         =   regKVImageCacheCap          .getData (&hKey);
+
+  if (regKVExportSize.hasData(&hKey))
+    iExportSize            =   regKVExportSize             .getData (&hKey);
+
 
   lsKey =
     RegCreateKeyW ( HKEY_CURRENT_USER,
@@ -325,6 +334,10 @@ SKIF_RegistrySettings::SKIF_RegistrySettings (void)
     RegCreateKeyW ( HKEY_CURRENT_USER,
                       LR"(SOFTWARE\Kaldaien\Special K\Viewer\PNG\)",
                         &png.key.m_hKey );
+  lsKey =
+    RegCreateKeyW ( HKEY_CURRENT_USER,
+                      LR"(SOFTWARE\Kaldaien\Special K\Viewer\DDS\)",
+                        &dds.key.m_hKey );
 
   if (regKVAVIFHDRBitDepth.hasData (&avif.key.m_hKey))
     avif.hdr_bitdepth      =   regKVAVIFHDRBitDepth        .getData (&avif.key.m_hKey);
@@ -346,6 +359,11 @@ SKIF_RegistrySettings::SKIF_RegistrySettings (void)
   if (regKVPNGHDRBitDepth.hasData  (&png.key.m_hKey))
     png.hdr_bitdepth       =   regKVPNGHDRBitDepth         .getData (&png.key.m_hKey);
 
+  if (regKVDDSQuality.hasData      (&dds.key.m_hKey))
+    dds.quality            =   regKVDDSQuality             .getData (&dds.key.m_hKey);
+  if (regKVDDSMipmaps.hasData      (&dds.key.m_hKey))
+    dds.mipmaps            =   regKVDDSMipmaps             .getData (&dds.key.m_hKey);
+
 #if 0
   if (! SKIF_Util_GetDragFromMaximized ( ))
     bMaximizeOnDoubleClick = false; // Force disabled IF the OS prerequisites are not enabled
@@ -407,6 +425,7 @@ SKIF_RegistrySettings::SKIF_RegistrySettings (void)
   bGhost                   =   regKVGhost                  .getData (&hKey);
   bLoggingDeveloper        =   regKVLoggingDeveloper       .getData (&hKey);
   bImageDetails            =   regKVImageDetails           .getData (&hKey);
+  bBufferPoolLargePages    =   regKVBufferPoolLargePages   .getData (&hKey);
 
   // Keybindings
   // All keybindings must first read the data from the registry,
@@ -0,0 +1,341 @@
+#include <utility/sha256.h>
+#include <plog/Log.h>
+#include <immintrin.h>
+#include <intrin.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+#pragma region Block Compression
+
+alignas (16) static const uint32_t skiv_sha256_k [64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static __forceinline uint32_t
+SKIV_SHA256_Rotr (uint32_t x, int n)
+{
+  return (x >> n) | (x << (32 - n));
+}
+
+static void
+SKIV_SHA256_Compress_Scalar (uint32_t state [8], const uint8_t* data, size_t blocks)
+{
+  for (; blocks > 0; --blocks, data += 64)
+  {
+    uint32_t w [64];
+
+    for (int i = 0; i < 16; ++i)
+    {
+      w [i] = (static_cast <uint32_t> (data [i * 4    ]) << 24) |
+              (static_cast <uint32_t> (data [i * 4 + 1]) << 16) |
+              (static_cast <uint32_t> (data [i * 4 + 2]) <<  8) |
+               static_cast <uint32_t> (data [i * 4 + 3]);
+    }
+
+    for (int i = 16; i < 64; ++i)
+    {
+      const uint32_t s0 = SKIV_SHA256_Rotr (w [i - 15],  7) ^ SKIV_SHA256_Rotr (w [i - 15], 18) ^ (w [i - 15] >>  3);
+      const uint32_t s1 = SKIV_SHA256_Rotr (w [i -  2], 17) ^ SKIV_SHA256_Rotr (w [i -  2], 19) ^ (w [i -  2] >> 10);
+
+      w [i] = w [i - 16] + s0 + w [i - 7] + s1;
+    }
+
+    uint32_t a = state [0], b = state [1], c = state [2], d = state [3],
+             e = state [4], f = state [5], g = state [6], h = state [7];
+
+    for (int i = 0; i < 64; ++i)
+    {
+      const uint32_t S1  = SKIV_SHA256_Rotr (e, 6) ^ SKIV_SHA256_Rotr (e, 11) ^ SKIV_SHA256_Rotr (e, 25);
+      const uint32_t ch  = (e & f) ^ (~e & g);
+      const uint32_t t1  = h + S1 + ch + skiv_sha256_k [i] + w [i];
+      const uint32_t S0  = SKIV_SHA256_Rotr (a, 2) ^ SKIV_SHA256_Rotr (a, 13) ^ SKIV_SHA256_Rotr (a, 22);
+      const uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+      const uint32_t t2  = S0 + maj;
+
+      h = g; g = f; f = e; e = d + t1;
+      d = c; c = b; b = a; a = t1 + t2;
+    }
+
+    state [0] += a; state [1] += b; state [2] += c; state [3] += d;
+    state [4] += e; state [5] += f; state [6] += g; state [7] += h;
+  }
+}
+
+// Four rounds per group; the message schedule of group g + 2 is started (msg1)
+//   and group g + 1 completed (msg2) alongside, rotating through four registers.
+static void
+SKIV_SHA256_Compress_SHANI (uint32_t state [8], const uint8_t* data, size_t blocks)
+{
+  const __m128i mask =
+    _mm_set_epi64x (0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+  // The SHA instructions want the state as ABEF / CDGH
+  __m128i tmp    = _mm_shuffle_epi32 (_mm_loadu_si128 (reinterpret_cast <const __m128i *> (&state [0])), 0xB1); // CDAB
+  __m128i state1 = _mm_shuffle_epi32 (_mm_loadu_si128 (reinterpret_cast <const __m128i *> (&state [4])), 0x1B); // EFGH
+  __m128i state0 = _mm_alignr_epi8   (tmp, state1, 8);    // ABEF
+          state1 = _mm_blend_epi16   (state1, tmp, 0xF0); // CDGH
+
+  for (; blocks > 0; --blocks, data += 64)
+  {
+    const __m128i abef = state0;
+    const __m128i cdgh = state1;
+
+    __m128i msgs [4];
+
+    for (int g = 0; g < 16; ++g)
+    {
+      __m128i& cur = msgs [ g      & 3];
+      __m128i& nxt = msgs [(g + 1) & 3];
+      __m128i& prv = msgs [(g + 3) & 3];
+
+      if (g < 4)
+        cur = _mm_shuffle_epi8 (_mm_loadu_si128 (reinterpret_cast <const __m128i *> (data + g * 16)), mask);
+
+      __m128i msg =
+        _mm_add_epi32 (cur, _mm_load_si128 (reinterpret_cast <const __m128i *> (&skiv_sha256_k [g * 4])));
+
+      state1 = _mm_sha256rnds2_epu32 (state1, state0, msg);
+
+      if (g >= 3 && g <= 14)
+      {
+        nxt = _mm_add_epi32      (nxt, _mm_alignr_epi8 (cur, prv, 4));
+        nxt = _mm_sha256msg2_epu32 (nxt, cur);
+      }
+
+      msg    = _mm_shuffle_epi32     (msg, 0x0E);
+      state0 = _mm_sha256rnds2_epu32 (state0, state1, msg);
+
+      if (g >= 1 && g <= 12)
+        prv = _mm_sha256msg1_epu32 (prv, cur);
+    }
+
+    state0 = _mm_add_epi32 (state0, abef);
+    state1 = _mm_add_epi32 (state1, cdgh);
+  }
+
+  tmp    = _mm_shuffle_epi32 (state0, 0x1B);       // FEBA
+  state1 = _mm_shuffle_epi32 (state1, 0xB1);       // DCHG
+  state0 = _mm_blend_epi16   (tmp, state1, 0xF0);  // DCBA
+  state1 = _mm_alignr_epi8   (state1, tmp, 8);     // HGFE
+
+  _mm_storeu_si128 (reinterpret_cast <__m128i *> (&state [0]), state0);
+  _mm_storeu_si128 (reinterpret_cast <__m128i *> (&state [4]), state1);
+}
+
+using SKIV_SHA256_Compress_pfn = void (*)(uint32_t state [8], const uint8_t* data, size_t blocks);
+
+struct skiv_sha256_impl_s {
+  SKIV_SHA256_Compress_pfn compress  = SKIV_SHA256_Compress_Scalar;
+  const char*              name      = "Scalar";
+  bool                     has_shani = false;
+
+  skiv_sha256_impl_s (void)
+  {
+    int cpu_info [4] = { };
+
+    __cpuid   (cpu_info, 0);
+    const int max_leaf = cpu_info [0];
+
+    __cpuid   (cpu_info, 1);
+    const bool has_ssse3  = (cpu_info [2] & (1 <<  9)) != 0;
+    const bool has_sse41  = (cpu_info [2] & (1 << 19)) != 0;
+
+    bool has_sha = false;
+
+    if (max_leaf >= 7)
+    {
+      __cpuidex (cpu_info, 7, 0);
+      has_sha = (cpu_info [1] & (1 << 29)) != 0;
+    }
+
+    has_shani = has_sha && has_ssse3 && has_sse41;
+
+    if (has_shani)
+    {
+      compress = SKIV_SHA256_Compress_SHANI;
+      name     = "SHA-NI";
+    }
+
+    PLOG_INFO << "SHA-256 implementation: " << name;
+  }
+};
+
+static skiv_sha256_impl_s&
+SKIV_SHA256_GetImpl (void)
+{
+  static skiv_sha256_impl_s impl;
+  return                    impl;
+}
+
+#pragma endregion
+
+skiv_sha256_s::skiv_sha256_s (void)
+{
+  reset ();
+}
+
+void
+skiv_sha256_s::reset (void)
+{
+  static constexpr uint32_t initial [8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+  };
+
+  memcpy (state, initial, sizeof (state));
+
+  buffered = 0;
+  length   = 0;
+}
+
+void
+skiv_sha256_s::update (const void* data, size_t size)
+{
+  const auto compress =
+    SKIV_SHA256_GetImpl ().compress;
+
+  auto bytes =
+    static_cast <const uint8_t *> (data);
+
+  length += size;
+
+  // Top up a partial block first
+  if (buffered > 0)
+  {
+    const size_t take =
+      std::min (size, sizeof (buffer) - buffered);
+
+    memcpy (buffer + buffered, bytes, take);
+
+    buffered += take;
+    bytes    += take;
+    size     -= take;
+
+    if (buffered < sizeof (buffer))
+      return;
+
+    compress (state, buffer, 1);
+    buffered = 0;
+  }
+
+  // Whole blocks straight from the input
+  if (size >= 64)
+  {
+    compress (state, bytes, size / 64);
+
+    bytes += size & ~static_cast <size_t> (63);
+    size  &= 63;
+  }
+
+  memcpy (buffer, bytes, size);
+  buffered = size;
+}
+
+std::array <uint8_t, 32>
+skiv_sha256_s::finish (void)
+{
+  const uint64_t bits = length * 8;
+
+  // 0x80, zeros up to 56 mod 64, then the big-endian length in bits
+  uint8_t padding [72] = { 0x80 };
+
+  const size_t pad =
+    (buffered < 56) ? (56 - buffered) : (120 - buffered);
+
+  for (int i = 0; i < 8; ++i)
+    padding [pad + i] = static_cast <uint8_t> (bits >> (56 - i * 8));
+
+  const uint64_t message_length = length;
+  update (padding, pad + 8);
+  length = message_length;
+
+  std::array <uint8_t, 32> digest;
+
+  for (int i = 0; i < 8; ++i)
+  {
+    digest [i * 4    ] = static_cast <uint8_t> (state [i] >> 24);
+    digest [i * 4 + 1] = static_cast <uint8_t> (state [i] >> 16);
+    digest [i * 4 + 2] = static_cast <uint8_t> (state [i] >>  8);
+    digest [i * 4 + 3] = static_cast <uint8_t> (state [i]      );
+  }
+
+  return digest;
+}
+
+std::string
+skiv_sha256_s::finish_hex (void)
+{
+  static constexpr char hex [] = "0123456789abcdef";
+
+  const auto digest =
+    finish ();
+
+  std::string str;
+  str.reserve (64);
+
+  for (uint8_t byte : digest)
+  {
+    str += hex [byte >> 4];
+    str += hex [byte & 15];
+  }
+
+  return str;
+}
+
+std::string
+SKIV_SHA256_HashFile (const std::wstring& path)
+{
+  FILE* pFile =
+    _wfopen (path.c_str (), L"rb");
+
+  if (pFile == nullptr)
+    return "";
+
+  skiv_sha256_s sha256;
+
+  auto chunk =
+    std::make_unique <uint8_t []> (1024 * 1024);
+
+  size_t read;
+  while ((read = fread (chunk.get (), 1, 1024 * 1024, pFile)) > 0)
+    sha256.update (chunk.get (), read);
+
+  const bool failed =
+    ferror (pFile) != 0;
+
+  fclose (pFile);
+
+  return
+    failed ? "" : sha256.finish_hex ();
+}
+
+const char*
+SKIV_SHA256_GetImplementation (void)
+{
+  return
+    SKIV_SHA256_GetImpl ().name;
+}
+
+bool
+SKIV_SHA256_SetImplementation (bool shani)
+{
+  auto& impl =
+    SKIV_SHA256_GetImpl ();
+
+  if (shani && ! impl.has_shani)
+    return false;
+
+  impl.compress = shani ? SKIV_SHA256_Compress_SHANI : SKIV_SHA256_Compress_Scalar;
+  impl.name     = shani ? "SHA-NI"                   : "Scalar";
+
+  return true;
+}
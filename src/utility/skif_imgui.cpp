@@ -1,5 +1,6 @@
 #include <utility/skif_imgui.h>
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <unordered_set>
@@ -9,6 +10,7 @@
 
 #include <utility/fsutil.h>
 #include <utility/registry.h>
+#include <utility/trace.h>
 
 #include <fonts/fa_621.h>
 #include <fonts/fa_621b.h>
@@ -1036,12 +1038,10 @@ SKIF_ImGui_MissingGlyphCallback (wchar_t c)
   }
 }
 
-ImFont*
-SKIF_ImGui_LoadFont ( const std::wstring& filename, float point_size, const ImWchar* glyph_range, ImFontConfig* cfg )
+// Returns an empty string if the font is neither a path nor found in the Windows fonts folder
+static std::wstring
+SKIF_ImGui_ResolveFontPath (const std::wstring& filename)
 {
-  auto& io =
-    ImGui::GetIO ();
-
   wchar_t wszFullPath [MAX_PATH + 2] = { };
 
   if (GetFileAttributesW (              filename.c_str ()) != INVALID_FILE_ATTRIBUTES)
@@ -1061,10 +1061,22 @@ SKIF_ImGui_LoadFont ( const std::wstring& filename, float point_size, const ImWc
       *wszFullPath = L'\0';
   }
 
-  if (*wszFullPath != L'\0')
+  return wszFullPath;
+}
+
+ImFont*
+SKIF_ImGui_LoadFont ( const std::wstring& filename, float point_size, const ImWchar* glyph_range, ImFontConfig* cfg )
+{
+  auto& io =
+    ImGui::GetIO ();
+
+  const std::wstring path =
+    SKIF_ImGui_ResolveFontPath (filename);
+
+  if (! path.empty ())
   {
     return
-      io.Fonts->AddFontFromFileTTF ( SK_WideCharToUTF8 (wszFullPath).c_str (),
+      io.Fonts->AddFontFromFileTTF ( SK_WideCharToUTF8 (path).c_str (),
                                        point_size,
                                          cfg,
                                            glyph_range );
@@ -1073,11 +1085,305 @@ SKIF_ImGui_LoadFont ( const std::wstring& filename, float point_size, const ImWc
   return (ImFont *)nullptr;
 }
 
+
+// Font Atlas Cache
+
+// Rasterizing the system fonts (and especially the CJK collections) dominates
+//   startup, so the built atlas is kept on disk and restored as-is on the next
+//     launch. The key covers everything that affects the output: the ImGui
+//       version, every font file (path, size and last write time) and the size
+//         and glyph ranges it was loaded with, so a DPI or font size change
+//           simply selects a different cache file.
+constexpr uint32_t SKIF_FONT_CACHE_MAGIC   = 0x41464B53; // "SKFA"
+constexpr uint32_t SKIF_FONT_CACHE_VERSION = 1;
+constexpr size_t   SKIF_FONT_CACHE_FILES   = 4;      // One per recently used DPI / font size
+
+// A font file queued by SKIF_ImGui_InitFonts
+struct skif_font_source_s {
+  std::wstring   path;
+  float          size   = 0.0f;
+  const ImWchar* ranges = nullptr;
+  bool           merge  = false;
+};
+
+struct skif_font_cache_header_s {
+  uint32_t magic          = SKIF_FONT_CACHE_MAGIC;
+  uint32_t version        = SKIF_FONT_CACHE_VERSION;
+  uint64_t key            = 0;
+  int32_t  tex_width      = 0;
+  int32_t  tex_height     = 0;
+  ImVec2   tex_uv_scale;
+  ImVec2   tex_uv_white_pixel;
+  ImVec4   tex_uv_lines [IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1];
+  uint32_t font_count     = 0;
+  int32_t  consolas_index = -1;
+};
+
+// Followed by glyph_count ImFontGlyph
+struct skif_font_cache_font_s {
+  float    size           = 0.0f;
+  float    ascent         = 0.0f;
+  float    descent        = 0.0f;
+  int32_t  surface        = 0;
+  ImWchar  fallback_char  = 0;
+  ImWchar  ellipsis_char  = 0;
+  uint32_t glyph_count    = 0;
+};
+
+static uint64_t
+SKIF_ImGui_GetFontCacheKey (const std::vector <skif_font_source_s>& sources)
+{
+  uint64_t key = 0xcbf29ce484222325ULL; // FNV-1a
+
+  auto _Hash = [&](const void* data, size_t size)
+  {
+    for (size_t i = 0; i < size; ++i)
+      key = (key ^ static_cast <const uint8_t *> (data) [i]) * 0x100000001b3ULL;
+  };
+
+  _Hash (IMGUI_VERSION, sizeof (IMGUI_VERSION));
+
+  const size_t glyph_size = sizeof (ImFontGlyph);
+  _Hash (&glyph_size, sizeof (glyph_size));
+
+  for (const auto& source : sources)
+  {
+    WIN32_FILE_ATTRIBUTE_DATA                                         attributes = { };
+    GetFileAttributesExW (source.path.c_str (), GetFileExInfoStandard, &attributes);
+
+    _Hash (source.path.data (), source.path.size () * sizeof (wchar_t));
+    _Hash (&attributes.ftLastWriteTime, sizeof (attributes.ftLastWriteTime));
+    _Hash (&attributes.nFileSizeLow,    sizeof (attributes.nFileSizeLow));
+    _Hash (&source.size,                sizeof (source.size));
+    _Hash (&source.merge,               sizeof (source.merge));
+
+    for (const ImWchar* range = source.ranges; range != nullptr && *range != 0; ++range)
+      _Hash (range, sizeof (ImWchar));
+  }
+
+  return key;
+}
+
+// Restores the fonts and the alpha bitmap into an empty atlas; returns false,
+//   leaving the atlas empty, if the file is missing, stale or truncated.
+static bool
+SKIF_ImGui_LoadFontAtlasCache (const std::filesystem::path& path, uint64_t key, ImFontAtlas* atlas, int& consolas_index)
+{
+  HANDLE hFile =
+    CreateFileW (path.c_str (), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+  if (hFile == INVALID_HANDLE_VALUE)
+    return false;
+
+  LARGE_INTEGER        file_size = { };
+  GetFileSizeEx (hFile, &file_size);
+
+  HANDLE hMapping =
+    CreateFileMappingW (hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+  const uint8_t* view = (hMapping != nullptr)
+    ? static_cast <const uint8_t *> (MapViewOfFile (hMapping, FILE_MAP_READ, 0, 0, 0))
+    : nullptr;
+
+  const size_t size   = static_cast <size_t> (file_size.QuadPart);
+  size_t       offset = 0;
+
+  auto _Read = [&](size_t bytes) -> const uint8_t*
+  {
+    if (view == nullptr || bytes > size - offset)
+      return nullptr;
+
+    offset += bytes;
+    return view + offset - bytes;
+  };
+
+  skif_font_cache_header_s header;
+  bool                     valid = false;
+
+  if (auto data = _Read (sizeof (header)))
+  {
+    memcpy (&header, data, sizeof (header));
+
+    valid = header.magic   == SKIF_FONT_CACHE_MAGIC   &&
+            header.version == SKIF_FONT_CACHE_VERSION &&
+            header.key     == key && header.font_count != 0 &&
+            header.tex_width > 0 && header.tex_height > 0;
+  }
+
+  if (valid)
+  {
+    atlas->TexWidth        = header.tex_width;
+    atlas->TexHeight       = header.tex_height;
+    atlas->TexUvScale      = header.tex_uv_scale;
+    atlas->TexUvWhitePixel = header.tex_uv_white_pixel;
+
+    memcpy (atlas->TexUvLines, header.tex_uv_lines, sizeof (atlas->TexUvLines));
+
+    for (uint32_t i = 0; i < header.font_count && valid; ++i)
+    {
+      skif_font_cache_font_s desc;
+      const uint8_t*         data = _Read (sizeof (desc));
+
+      if (data != nullptr)
+        memcpy (&desc, data, sizeof (desc));
+
+      const uint8_t* glyphs = (data != nullptr && desc.glyph_count != 0 && desc.glyph_count < 0xFFFF)
+        ? _Read (desc.glyph_count * sizeof (ImFontGlyph))
+        : nullptr;
+
+      if (glyphs == nullptr)
+      {
+        valid = false;
+        break;
+      }
+
+      ImFont* font = IM_NEW (ImFont);
+
+      font->ContainerAtlas      = atlas;
+      font->FontSize            = desc.size;
+      font->Ascent              = desc.ascent;
+      font->Descent             = desc.descent;
+      font->MetricsTotalSurface = desc.surface;
+      font->FallbackChar        = desc.fallback_char;
+      font->EllipsisChar        = desc.ellipsis_char;
+
+      font->Glyphs.resize (static_cast <int> (desc.glyph_count));
+      memcpy (font->Glyphs.Data, glyphs, desc.glyph_count * sizeof (ImFontGlyph));
+
+      // The TAB glyph saved last is reused rather than appended again
+      font->BuildLookupTable ( );
+
+      atlas->Fonts.push_back (font);
+    }
+
+    const size_t pixels_size =
+      static_cast <size_t> (header.tex_width) * static_cast <size_t> (header.tex_height);
+
+    const uint8_t* pixels =
+      valid ? _Read (pixels_size) : nullptr;
+
+    if (pixels != nullptr)
+    {
+      atlas->TexPixelsAlpha8 = static_cast <unsigned char *> (IM_ALLOC (pixels_size));
+      memcpy (atlas->TexPixelsAlpha8, pixels, pixels_size);
+
+      atlas->TexReady = true;
+      consolas_index  = header.consolas_index;
+    }
+
+    else
+      valid = false;
+  }
+
+  if (view != nullptr)
+    UnmapViewOfFile (view);
+
+  if (hMapping != nullptr)
+    CloseHandle (hMapping);
+
+  CloseHandle (hFile);
+
+  if (! valid)
+    atlas->Clear ( );
+
+  return valid;
+}
+
+static void
+SKIF_ImGui_SaveFontAtlasCache (const std::filesystem::path& path, uint64_t key, ImFontAtlas* atlas, int consolas_index)
+{
+  if (atlas->TexPixelsAlpha8 == nullptr || atlas->Fonts.Size == 0)
+    return;
+
+  skif_font_cache_header_s header;
+
+  header.key                = key;
+  header.tex_width          = atlas->TexWidth;
+  header.tex_height         = atlas->TexHeight;
+  header.tex_uv_scale       = atlas->TexUvScale;
+  header.tex_uv_white_pixel = atlas->TexUvWhitePixel;
+  header.font_count         = static_cast <uint32_t> (atlas->Fonts.Size);
+  header.consolas_index     = consolas_index;
+
+  memcpy (header.tex_uv_lines, atlas->TexUvLines, sizeof (header.tex_uv_lines));
+
+  std::error_code ec;
+  std::filesystem::create_directories (path.parent_path (), ec);
+
+  // Written aside and renamed, so an interrupted write never leaves a truncated cache behind
+  std::filesystem::path temp_path = path;
+  temp_path += L".tmp";
+
+  {
+    std::ofstream file (temp_path, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+
+    file.write (reinterpret_cast <const char *> (&header), sizeof (header));
+
+    for (const ImFont* font : atlas->Fonts)
+    {
+      skif_font_cache_font_s desc;
+
+      desc.size          = font->FontSize;
+      desc.ascent        = font->Ascent;
+      desc.descent       = font->Descent;
+      desc.surface       = font->MetricsTotalSurface;
+      desc.fallback_char = font->FallbackChar;
+      desc.ellipsis_char = (font->EllipsisCharCount == 1) ? font->EllipsisChar
+                                                          : (ImWchar)-1; // Three dots are picked again on load
+      desc.glyph_count   = static_cast <uint32_t> (font->Glyphs.Size);
+
+      file.write (reinterpret_cast <const char *> (&desc),             sizeof (desc));
+      file.write (reinterpret_cast <const char *> (font->Glyphs.Data), font->Glyphs.Size * sizeof (ImFontGlyph));
+    }
+
+    file.write (reinterpret_cast <const char *> (atlas->TexPixelsAlpha8),
+                static_cast <std::streamsize> (atlas->TexWidth) * atlas->TexHeight);
+
+    if (! file.good ())
+    {
+      PLOG_WARNING << "Failed to write the font atlas cache to " << temp_path.wstring ();
+
+      file.close ( );
+      std::filesystem::remove (temp_path, ec);
+      return;
+    }
+  }
+
+  std::filesystem::rename (temp_path, path, ec);
+
+  if (ec)
+  {
+    PLOG_WARNING << "Failed to write the font atlas cache to " << path.wstring () << ": " << ec.message ().c_str ();
+    std::filesystem::remove (temp_path, ec);
+    return;
+  }
+
+  // Keep only the most recently used cache files
+  std::vector <std::filesystem::directory_entry> entries;
+
+  for (const auto& entry : std::filesystem::directory_iterator (path.parent_path (), ec))
+    if (entry.is_regular_file (ec) && entry.path ().extension () == L".bin")
+      entries.push_back (entry);
+
+  if (entries.size () > SKIF_FONT_CACHE_FILES)
+  {
+    std::sort (entries.begin (), entries.end (), [&](const auto& a, const auto& b)
+      { return a.last_write_time (ec) > b.last_write_time (ec); });
+
+    for (size_t i = SKIF_FONT_CACHE_FILES; i < entries.size (); ++i)
+      std::filesystem::remove (entries [i].path (), ec);
+  }
+}
+
 void
 SKIF_ImGui_InitFonts (float fontSize, bool extendedCharsets)
 {
   static SKIF_CommonPathsCache& _path_cache = SKIF_CommonPathsCache::GetInstance ( );
 
+  SKIV_TRACE_SCOPE ("InitFonts");
+
+  DWORD start_time = SKIF_Util_timeGetTime1 ( );
+
   // Font size should always be rounded down to the nearest integer
   fontSize = floor(fontSize);
 
@@ -1126,13 +1432,26 @@ SKIF_ImGui_InitFonts (float fontSize, bool extendedCharsets)
 
   std::wstring standardFont = (fontSize >= 18.0F) ? L"Tahoma.ttf" : L"Verdana.ttf"; // L"Tahoma.ttf" : L"Verdana.ttf";
 
+  // Fonts are only queued here; they are loaded further down if the atlas
+  //   cannot be restored from the cache
+  std::vector <skif_font_source_s> sources;
+
+  auto _QueueFont = [&](const std::wstring& filename, float size, const ImWchar* ranges)
+  {
+    std::wstring path =
+      SKIF_ImGui_ResolveFontPath (filename);
+
+    if (! path.empty ())
+      sources.push_back ({ path, size, ranges, font_cfg.MergeMode });
+  };
+
   std::error_code ec;
   // Create any missing directories
   if (! std::filesystem::exists (            fontDir, ec))
         std::filesystem::create_directories (fontDir, ec);
 
   // Core character set
-  SKIF_ImGui_LoadFont     (standardFont, fontSize, SK_ImGui_GetGlyphRangesDefaultEx(), &font_cfg);
+  _QueueFont     (standardFont, fontSize, SK_ImGui_GetGlyphRangesDefaultEx());
   //SKIF_ImGui_LoadFont     ((fontDir / L"NotoSans-Regular.ttf"), fontSize, SK_ImGui_GetGlyphRangesDefaultEx());
 
   if (! useDefaultFont)
@@ -1145,7 +1464,7 @@ SKIF_ImGui_InitFonts (float fontSize, bool extendedCharsets)
   {
     // Cyrillic character set
     if (! vFontCyrillic.empty())
-      SKIF_ImGui_LoadFont   (standardFont,   fontSize, vFontCyrillic.data(), &font_cfg);
+      _QueueFont   (standardFont,   fontSize, vFontCyrillic.data());
       //SKIF_ImGui_LoadFont   ((fontDir / L"NotoSans-Regular.ttf"), fontSize, io.Fonts->GetGlyphRangesCyrillic        (), &font_cfg);
   
     // Japanese character set
@@ -1155,16 +1474,16 @@ SKIF_ImGui_InitFonts (float fontSize, bool extendedCharsets)
       //SKIF_ImGui_LoadFont ((fontDir / L"NotoSansJP-Regular.ttf"), fontSize, io.Fonts->GetGlyphRangesJapanese        (), &font_cfg);
       ///*
       if (SKIF_Util_IsWindows10OrGreater ( ))
-        SKIF_ImGui_LoadFont (L"YuGothR.ttc",  fontSize, vFontJapanese.data(), &font_cfg);
+        _QueueFont (L"YuGothR.ttc",  fontSize, vFontJapanese.data());
       else
-        SKIF_ImGui_LoadFont (L"yugothic.ttf", fontSize, vFontJapanese.data(), &font_cfg);
+        _QueueFont (L"yugothic.ttf", fontSize, vFontJapanese.data());
       //*/
     }
 
     // Simplified Chinese character set
     // Also includes almost all of the Japanese characters except for some Kanjis
     if (! vFontChineseSimplified.empty())
-      SKIF_ImGui_LoadFont   (L"msyh.ttc",     fontSize, vFontChineseSimplified.data(), &font_cfg);
+      _QueueFont   (L"msyh.ttc",     fontSize, vFontChineseSimplified.data());
       //SKIF_ImGui_LoadFont ((fontDir / L"NotoSansSC-Regular.ttf"), fontSize, io.Fonts->GetGlyphRangesChineseSimplifiedCommon        (), &font_cfg);
 
     // Japanese character set
@@ -1174,31 +1493,31 @@ SKIF_ImGui_InitFonts (float fontSize, bool extendedCharsets)
       //SKIF_ImGui_LoadFont ((fontDir / L"NotoSansJP-Regular.ttf"), fontSize, io.Fonts->GetGlyphRangesJapanese        (), &font_cfg);
       ///*
       if (SKIF_Util_IsWindows10OrGreater ( ))
-        SKIF_ImGui_LoadFont (L"YuGothR.ttc",  fontSize, vFontJapanese.data(), &font_cfg);
+        _QueueFont (L"YuGothR.ttc",  fontSize, vFontJapanese.data());
       else
-        SKIF_ImGui_LoadFont (L"yugothic.ttf", fontSize, vFontJapanese.data(), &font_cfg);
+        _QueueFont (L"yugothic.ttf", fontSize, vFontJapanese.data());
       //*/
     }
     
     // All Chinese character sets
     if (! vFontChineseAll.empty())
-      SKIF_ImGui_LoadFont   (L"msjh.ttc",     fontSize, vFontChineseAll.data(), &font_cfg);
+      _QueueFont   (L"msjh.ttc",     fontSize, vFontChineseAll.data());
       //SKIF_ImGui_LoadFont ((fontDir / L"NotoSansTC-Regular.ttf"), fontSize, io.Fonts->GetGlyphRangesChineseFull        (), &font_cfg);
 
     // Korean character set
     // On 32-bit builds this does not include Hangul syllables due to system limitaitons
     if (! vFontKorean.empty())
-      SKIF_ImGui_LoadFont   (L"malgun.ttf",   fontSize, vFontKorean.data(), &font_cfg);
+      _QueueFont   (L"malgun.ttf",   fontSize, vFontKorean.data());
       //SKIF_ImGui_LoadFont ((fontDir / L"NotoSansKR-Regular.ttf"), fontSize, io.Fonts->SK_ImGui_GetGlyphRangesKorean        (), &font_cfg);
 
     // Thai character set
     if (! vFontThai.empty())
-      SKIF_ImGui_LoadFont   (standardFont,   fontSize, vFontThai.data(), &font_cfg);
+      _QueueFont   (standardFont,   fontSize, vFontThai.data());
       //SKIF_ImGui_LoadFont   ((fontDir / L"NotoSansThai-Regular.ttf"),   fontSize, io.Fonts->GetGlyphRangesThai      (), &font_cfg);
 
     // Vietnamese character set
     if (! vFontVietnamese.empty())
-      SKIF_ImGui_LoadFont   (standardFont,   fontSize, vFontVietnamese.data(), &font_cfg);
+      _QueueFont   (standardFont,   fontSize, vFontVietnamese.data());
       //SKIF_ImGui_LoadFont   ((fontDir / L"NotoSans-Regular.ttf"),   fontSize, io.Fonts->GetGlyphRangesVietnamese    (), &font_cfg);
   }
 
@@ -1239,14 +1558,93 @@ SKIF_ImGui_InitFonts (float fontSize, bool extendedCharsets)
 
     // FA Regular is basically useless as it only has 163 icons, so we don't bother using it
     // FA Solid has 1390 icons in comparison
-        SKIF_ImGui_LoadFont (fontDir/FONT_ICON_FILE_NAME_FAS, fontSizeFA, SK_ImGui_GetGlyphRangesFontAwesome(), &font_cfg);
+        _QueueFont (fontDir/FONT_ICON_FILE_NAME_FAS, fontSizeFA, SK_ImGui_GetGlyphRangesFontAwesome());
     // FA Brands
-    SKIF_ImGui_LoadFont (fontDir/FONT_ICON_FILE_NAME_FAB, fontSizeFA, SK_ImGui_GetGlyphRangesFontAwesomeBrands(), &font_cfg);
+    _QueueFont (fontDir/FONT_ICON_FILE_NAME_FAB, fontSizeFA, SK_ImGui_GetGlyphRangesFontAwesomeBrands());
 
     //io.Fonts->AddFontDefault ();
 
-    fontConsolas = SKIF_ImGui_LoadFont (L"Consola.ttf", fontSizeConsolas, SK_ImGui_GetGlyphRangesDefaultEx ( ));
-    //fontConsolas = SKIF_ImGui_LoadFont ((fontDir / L"NotoSansMono-Regular.ttf"), fontSize/* - 4.0f*/, SK_ImGui_GetGlyphRangesDefaultEx());
+    // Consolas is a separate font rather than merged into the main one
+    font_cfg.MergeMode = false;
+
+    const size_t consolas_source = sources.size ();
+
+    _QueueFont (L"Consola.ttf", fontSizeConsolas, SK_ImGui_GetGlyphRangesDefaultEx ( ));
+    //_QueueFont ((fontDir / L"NotoSansMono-Regular.ttf"), fontSize/* - 4.0f*/, SK_ImGui_GetGlyphRangesDefaultEx());
+
+  // Glyphs of the extended character sets are added on demand by SKIF_ImGui_MissingGlyphCallback,
+  //   so those atlases are specific to the session and not worth caching
+  bool cacheable = (! useDefaultFont);
+
+  if (extendedCharsets)
+    for (const auto* on_demand : { &vFontCyrillic, &vFontJapanese, &vFontChineseSimplified, &vFontChineseAll,
+                                   &vFontKorean,   &vFontThai,     &vFontVietnamese })
+      if (! on_demand->empty ())
+        cacheable = false;
+
+  const uint64_t cache_key =
+    SKIF_ImGui_GetFontCacheKey (sources);
+
+  wchar_t      wszCacheFile [32] = { };
+  swprintf_s ( wszCacheFile, L"atlas-%016llx.bin", cache_key );
+
+  const std::filesystem::path cache_path =
+    fontDir / L"Cache" / wszCacheFile;
+
+  int  consolas_index = -1;
+  bool cached         = cacheable &&
+    SKIF_ImGui_LoadFontAtlasCache (cache_path, cache_key, io.Fonts, consolas_index);
+
+  if (cached)
+  {
+    // Bump the file so it is not the first one to be pruned
+    std::filesystem::last_write_time (cache_path, std::filesystem::file_time_type::clock::now (), ec);
+  }
+
+  else
+  {
+    for (size_t i = 0; i < sources.size (); ++i)
+    {
+      font_cfg.MergeMode = sources [i].merge;
+
+      ImFont* font =
+        io.Fonts->AddFontFromFileTTF ( SK_WideCharToUTF8 (sources [i].path).c_str (),
+                                         sources [i].size, &font_cfg, sources [i].ranges );
+
+      if (i == consolas_source && font != nullptr)
+        consolas_index = io.Fonts->Fonts.Size - 1;
+    }
+
+    DWORD build_time = SKIF_Util_timeGetTime1 ( );
+    io.Fonts->Build ( );
+    PLOG_DEBUG << "Operation [Fonts->Build] took " << (SKIF_Util_timeGetTime1 ( ) - build_time) << " ms.";
+
+    if (cacheable)
+      SKIF_ImGui_SaveFontAtlasCache (cache_path, cache_key, io.Fonts, consolas_index);
+
+    // The font files (tens of MiB for the CJK collections) are not needed once
+    //   the atlas is built; the backend keeps the much smaller bitmap instead
+    io.Fonts->ClearInputData ( );
+  }
+
+  fontConsolas = (consolas_index >= 0 && consolas_index < io.Fonts->Fonts.Size)
+               ? io.Fonts->Fonts [consolas_index]
+               : nullptr;
+
+  int glyphs = 0;
+
+  for (const ImFont* font : io.Fonts->Fonts)
+    glyphs += font->Glyphs.Size;
+
+  const size_t atlas_bytes =
+    static_cast <size_t> (io.Fonts->TexWidth) * static_cast <size_t> (io.Fonts->TexHeight);
+
+  PLOG_INFO << "Font atlas " << (cached ? "restored from cache" : "built from " + std::to_string (sources.size ()) + " font files")
+            << " in " << (SKIF_Util_timeGetTime1 ( ) - start_time) << " ms: "
+            << io.Fonts->TexWidth << "x" << io.Fonts->TexHeight << ", " << glyphs << " glyphs, "
+            << (atlas_bytes / 1024) << " KiB";
+
+  SKIV_Trace_Counter ("Font Atlas (MiB)", static_cast <double> (atlas_bytes) / (1024.0 * 1024.0));
 }
 
 void
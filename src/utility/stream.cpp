@@ -0,0 +1,286 @@
+#include <utility/stream.h>
+#include <Windows.h>
+#include <wininet.h>
+#include <plog/Log.h>
+#include <algorithm>
+#include <cwctype>
+#include <map>
+#include <share.h>
+
+#pragma comment(lib, "wininet.lib")
+
+void
+skiv_stream_s::write (const void* bytes, size_t size)
+{
+  {
+    std::scoped_lock <std::mutex> _(lock);
+
+    data.insert (data.end (), static_cast <const uint8_t*> (bytes),
+                              static_cast <const uint8_t*> (bytes) + size);
+  }
+
+  grown.notify_all ();
+}
+
+void
+skiv_stream_s::finish (bool succeeded)
+{
+  {
+    std::scoped_lock <std::mutex> _(lock);
+
+    done    = true;
+    success = succeeded;
+  }
+
+  grown.notify_all ();
+}
+
+size_t
+skiv_stream_s::read (size_t offset, std::vector <uint8_t>& out, size_t max_size)
+{
+  std::unique_lock <std::mutex> _(lock);
+
+  grown.wait (_, [&] { return data.size () > offset || done; });
+
+  if (data.size () <= offset)
+    return 0;
+
+  const size_t size =
+    std::min (data.size () - offset, max_size);
+
+  out.insert (out.end (), data.begin () + offset,
+                          data.begin () + offset + size);
+
+  return size;
+}
+
+size_t
+skiv_stream_s::wait (size_t size)
+{
+  std::unique_lock <std::mutex> _(lock);
+
+  grown.wait (_, [&] { return data.size () >= size || done; });
+
+  return data.size ();
+}
+
+bool
+skiv_stream_s::ended (void)
+{
+  std::scoped_lock <std::mutex> _(lock);
+
+  return done;
+}
+
+bool
+skiv_stream_s::succeeded (void)
+{
+  std::scoped_lock <std::mutex> _(lock);
+
+  return done && success;
+}
+
+static struct {
+  std::mutex                                               lock;
+  std::map <std::wstring, std::shared_ptr <skiv_stream_s>> streams;
+} skiv_streams;
+
+// The viewer normalizes the paths it opens, the download may not have
+static std::wstring
+SKIV_Stream_GetKey (const std::wstring& path)
+{
+  std::wstring full (MAX_PATH, L'\0');
+
+  DWORD len =
+    GetFullPathNameW (path.c_str (), static_cast <DWORD> (full.size ()), full.data (), nullptr);
+
+  if (len > full.size ())
+  {
+    full.resize (len);
+    len = GetFullPathNameW (path.c_str (), len, full.data (), nullptr);
+  }
+
+  if (len == 0)
+    full = path;
+  else
+    full.resize (len);
+
+  std::transform (full.begin (), full.end (), full.begin (), [](wchar_t c) { return static_cast <wchar_t> (std::towlower (c)); });
+
+  return full;
+}
+
+std::shared_ptr <skiv_stream_s>
+SKIV_Stream_Register (const std::wstring& path)
+{
+  auto stream =
+    std::make_shared <skiv_stream_s> ();
+
+  std::scoped_lock <std::mutex> _(skiv_streams.lock);
+
+  skiv_streams.streams [SKIV_Stream_GetKey (path)] = stream;
+
+  return stream;
+}
+
+std::shared_ptr <skiv_stream_s>
+SKIV_Stream_Find (const std::wstring& path)
+{
+  const std::wstring key =
+    SKIV_Stream_GetKey (path);
+
+  std::scoped_lock <std::mutex> _(skiv_streams.lock);
+
+  auto it =
+    skiv_streams.streams.find (key);
+
+  return
+    (it != skiv_streams.streams.end ()) ? it->second : nullptr;
+}
+
+void
+SKIV_Stream_Unregister (const std::wstring& path)
+{
+  const std::wstring key =
+    SKIV_Stream_GetKey (path);
+
+  std::scoped_lock <std::mutex> _(skiv_streams.lock);
+
+  skiv_streams.streams.erase (key);
+}
+
+bool
+SKIV_Stream_Download (const std::wstring& url, const std::wstring& destination, skiv_stream_s* stream, const std::function <void (const void* data, size_t size)>& on_data)
+{
+  wchar_t wszHostName  [INTERNET_MAX_HOST_NAME_LENGTH] = { };
+  wchar_t wszUrlPath   [INTERNET_MAX_PATH_LENGTH]      = { };
+  wchar_t wszExtraInfo [INTERNET_MAX_PATH_LENGTH]      = { };
+
+  URL_COMPONENTSW urlcomps   = { };
+
+  urlcomps.dwStructSize      = sizeof (URL_COMPONENTSW);
+  urlcomps.lpszHostName      = wszHostName;
+  urlcomps.dwHostNameLength  = INTERNET_MAX_HOST_NAME_LENGTH;
+  urlcomps.lpszUrlPath       = wszUrlPath;
+  urlcomps.dwUrlPathLength   = INTERNET_MAX_PATH_LENGTH;
+  urlcomps.lpszExtraInfo     = wszExtraInfo;
+  urlcomps.dwExtraInfoLength = INTERNET_MAX_PATH_LENGTH;
+
+  HINTERNET hInetRoot = nullptr,
+            hInetHost = nullptr,
+            hInetReq  = nullptr;
+  FILE*     fOut      = nullptr;
+  bool      success   = false;
+
+  if (! InternetCrackUrlW (url.c_str (), static_cast <DWORD> (url.length ()), 0x0, &urlcomps) ||
+      (urlcomps.nScheme != INTERNET_SCHEME_HTTP && urlcomps.nScheme != INTERNET_SCHEME_HTTPS))
+  {
+    PLOG_ERROR << "Not a http or https URL: " << url;
+  }
+
+  else if ((hInetRoot = InternetOpenW (L"Special K - Asset Crawler", INTERNET_OPEN_TYPE_DIRECT, nullptr, nullptr, 0x0)) == nullptr ||
+           (hInetHost = InternetConnectW (hInetRoot, wszHostName, urlcomps.nPort, nullptr, nullptr, INTERNET_SERVICE_HTTP, 0x0, 0)) == nullptr)
+  {
+    PLOG_ERROR << "WinInet failed to connect to " << wszHostName << ", error " << GetLastError ();
+  }
+
+  else
+  {
+    const std::wstring full_path =
+      std::wstring (wszUrlPath) + wszExtraInfo;
+
+    PCWSTR rgpszAcceptTypes [] = { L"*/*", nullptr };
+
+    const DWORD flags =
+      ((urlcomps.nScheme == INTERNET_SCHEME_HTTPS) ? INTERNET_FLAG_SECURE : 0x0) |
+      INTERNET_FLAG_IGNORE_REDIRECT_TO_HTTP  | INTERNET_FLAG_IGNORE_REDIRECT_TO_HTTPS |
+      INTERNET_FLAG_IGNORE_CERT_DATE_INVALID | INTERNET_FLAG_IGNORE_CERT_CN_INVALID   |
+      INTERNET_FLAG_RELOAD                   | INTERNET_FLAG_NO_CACHE_WRITE           | INTERNET_FLAG_PRAGMA_NOCACHE;
+
+    hInetReq =
+      HttpOpenRequestW (hInetHost, L"GET", full_path.c_str (), L"HTTP/1.1", nullptr, rgpszAcceptTypes, flags, 0);
+
+    // Wait 5000 msecs for a dead connection, then give up
+    ULONG ulTimeout = 5000UL;
+
+    if (hInetReq != nullptr)
+      InternetSetOptionW (hInetReq, INTERNET_OPTION_RECEIVE_TIMEOUT, &ulTimeout, sizeof (ULONG));
+
+    DWORD dwStatusCode     = 0;
+    DWORD dwStatusCode_Len = sizeof (DWORD);
+
+    if (hInetReq == nullptr || ! HttpSendRequestW (hInetReq, nullptr, 0, nullptr, 0))
+      PLOG_ERROR << "WinInet failed to request " << url << ", error " << GetLastError ();
+
+    else if (! HttpQueryInfoW (hInetReq, HTTP_QUERY_STATUS_CODE | HTTP_QUERY_FLAG_NUMBER, &dwStatusCode, &dwStatusCode_Len, nullptr) || dwStatusCode != 200)
+      PLOG_WARNING << "Failed to download " << url << " -> HTTP Status Code: " << dwStatusCode;
+
+    // Shared for reading, the viewer opens the file while it is being written
+    else if ((fOut = _wfsopen (destination.c_str (), L"wb", _SH_DENYWR)) == nullptr)
+      PLOG_ERROR << "Failed to open " << destination << " for writing!";
+
+    else
+    {
+      std::vector <char> chunk (64 * 1024);
+
+      // Each read returns as soon as any data arrived, so chunks reach the
+      //   stream as the server sends them
+      DWORD dwSizeAvailable = 0,
+            dwSizeRead      = 0;
+
+      success = true;
+
+      while (InternetQueryDataAvailable (hInetReq, &dwSizeAvailable, 0x0, 0))
+      {
+        if (dwSizeAvailable == 0)
+          break;
+
+        if (chunk.size () < dwSizeAvailable)
+            chunk.resize   (dwSizeAvailable);
+
+        if (! InternetReadFile (hInetReq, chunk.data (), dwSizeAvailable, &dwSizeRead))
+        {
+          success = false;
+          break;
+        }
+
+        if (dwSizeRead == 0)
+          break;
+
+        if (fwrite (chunk.data (), dwSizeRead, 1, fOut) != 1)
+        {
+          success = false;
+          break;
+        }
+
+        // Flushed first, so that the file is never behind the stream
+        fflush (fOut);
+
+        if (stream != nullptr)
+          stream->write (chunk.data (), dwSizeRead);
+
+        if (on_data)
+          on_data (chunk.data (), dwSizeRead);
+      }
+
+      // Ended early, e.g. the connection dropped
+      if (success && GetLastError () == ERROR_INTERNET_CONNECTION_RESET)
+        success = false;
+
+      fclose (fOut);
+    }
+  }
+
+  if (hInetReq  != nullptr) InternetCloseHandle (hInetReq);
+  if (hInetHost != nullptr) InternetCloseHandle (hInetHost);
+  if (hInetRoot != nullptr) InternetCloseHandle (hInetRoot);
+
+  // Never leave a truncated image behind for the viewer to find
+  if (! success)
+    DeleteFileW (destination.c_str ());
+
+  if (stream != nullptr)
+    stream->finish (success);
+
+  return success;
+}
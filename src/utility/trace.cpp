@@ -0,0 +1,171 @@
+#include <utility/trace.h>
+#include <plog/Log.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <thread>
+#endif
+
+std::atomic <bool> SKIV_Trace_Recording = false;
+
+// Upper bound on recorded events, so a forgotten trace cannot grow without limit
+constexpr size_t SKIV_TRACE_MAX_EVENTS = 1 << 20;
+
+struct skiv_trace_event_s {
+  const char* name;
+  char        phase; // 'X' = complete span, 'C' = counter
+  uint32_t    tid;
+  uint64_t    ts;    // Steady clock, made relative to trace_epoch when written
+  uint64_t    dur;
+  double      value;
+};
+
+static std::mutex                          trace_lock;
+static std::vector <skiv_trace_event_s>    trace_events;
+static size_t                              trace_dropped = 0;
+static std::atomic <int64_t>               trace_epoch   = 0; // steady_clock, in microseconds
+
+static int64_t
+SKIV_Trace_GetSteadyMicroseconds (void)
+{
+  return
+    std::chrono::duration_cast <std::chrono::microseconds> (
+      std::chrono::steady_clock::now ( ).time_since_epoch ( )
+    ).count ( );
+}
+
+static uint32_t
+SKIV_Trace_GetThreadId (void)
+{
+#ifdef _WIN32
+  return GetCurrentThreadId ( );
+#else
+  return static_cast <uint32_t> (std::hash <std::thread::id> { } (std::this_thread::get_id ( )));
+#endif
+}
+
+static void
+SKIV_Trace_Record (const skiv_trace_event_s& event)
+{
+  std::scoped_lock <std::mutex> _(trace_lock);
+
+  if (trace_events.size () < SKIV_TRACE_MAX_EVENTS)
+    trace_events.push_back (event);
+  else
+    trace_dropped++;
+}
+
+void
+SKIV_Trace_Start (void)
+{
+  std::scoped_lock <std::mutex> _(trace_lock);
+
+  trace_events.clear ( );
+  trace_events.reserve (4096);
+  trace_dropped = 0;
+  trace_epoch   = SKIV_Trace_GetSteadyMicroseconds ( );
+
+  SKIV_Trace_Recording.store (true);
+
+  PLOG_INFO << "Trace recording started";
+}
+
+void
+SKIV_Trace_Stop (void)
+{
+  SKIV_Trace_Recording.store (false);
+
+  PLOG_INFO << "Trace recording stopped";
+}
+
+uint64_t
+SKIV_Trace_Now (void)
+{
+  return static_cast <uint64_t> (
+    SKIV_Trace_GetSteadyMicroseconds ( )
+  );
+}
+
+void
+SKIV_Trace_Span (const char* name, uint64_t begin, uint64_t end)
+{
+  SKIV_Trace_Record ({ name, 'X', SKIV_Trace_GetThreadId ( ), begin, end > begin ? end - begin : 0, 0.0 });
+}
+
+void
+SKIV_Trace_Counter (const char* name, double value)
+{
+  if (! SKIV_Trace_IsRecording ( ))
+    return;
+
+  SKIV_Trace_Record ({ name, 'C', SKIV_Trace_GetThreadId ( ), SKIV_Trace_Now ( ), 0, value });
+}
+
+bool
+SKIV_Trace_WriteJSON (const std::filesystem::path& path)
+{
+  std::vector <skiv_trace_event_s> events;
+  size_t                           dropped = 0;
+
+  {
+    std::scoped_lock <std::mutex> _(trace_lock);
+
+    events.swap (trace_events);
+    std::swap   (dropped, trace_dropped);
+  }
+
+  std::ofstream file (path, std::ios::out | std::ios::trunc);
+
+  if (! file.is_open ())
+  {
+    PLOG_ERROR << "Failed to open " << path.wstring () << " for writing!";
+    return false;
+  }
+
+  // Names are string literals from our own code; only quotes and
+  //   backslashes would need escaping, and there are none.
+  file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+  bool first = true;
+
+  const uint64_t epoch =
+    static_cast <uint64_t> (trace_epoch.load ( ));
+
+  for (const auto& event : events)
+  {
+    file << (first ? "\n" : ",\n");
+    first = false;
+
+    // Spans that were already open when the trace started are cut off at its beginning
+    const uint64_t ts  = std::max (event.ts, epoch);
+    const uint64_t end = std::max (event.ts + event.dur, ts);
+
+    file << "{\"name\":\"" << event.name << "\",\"ph\":\"" << event.phase
+         << "\",\"pid\":1,\"tid\":"  << event.tid
+         <<   ",\"ts\":"             << ts - epoch;
+
+    if (event.phase == 'X')
+      file << ",\"dur\":"            << end - ts << "}";
+
+    // NaN and infinity have no JSON representation
+    else if (! std::isfinite (event.value))
+      file << ",\"args\":{\"value\":null}}";
+
+    else
+      file << ",\"args\":{\"value\":" << event.value << "}}";
+  }
+
+  file << "\n]}\n";
+
+  PLOG_INFO          << "Wrote " << events.size () << " trace events to " << path.wstring ();
+  PLOG_WARNING_IF (dropped > 0) << "Dropped " << dropped << " trace events beyond the limit of " << SKIV_TRACE_MAX_EVENTS;
+
+  return file.good ();
+}
@@ -9,7 +9,8 @@
 #include <utility/utility.h>
 #include <utility/sk_utility.h>
 #include <nlohmann/json.hpp>
-#include <picosha2.h>
+#include <utility/sha256.h>
+#include <utility/stream.h>
 #include <TextFlow.hpp>
 
 #include <utility/fsutil.h>
@@ -610,6 +611,9 @@ SKIF_Updater::PerformUpdateCheck (results_s& _res)
               if (PathFileExists ((root + filename).c_str()))
                 _res.state |= UpdateFlags_Downloaded;
 
+              // Set when the installer is hashed as it downloads
+              std::string hex_str_downloaded;
+
               if ((_res.state & UpdateFlags_Downloaded) != UpdateFlags_Downloaded)
               {
                 PLOG_VERBOSE << "File " << (root + filename) << " has not been downloaded...";
@@ -618,8 +622,15 @@ SKIF_Updater::PerformUpdateCheck (results_s& _res)
                      (_res.state & UpdateFlags_Older  ) != UpdateFlags_Older))
                 {
                   PLOG_INFO << "Downloading installer: " << branchInstaller;
-                  if (SKIF_Util_GetWebResource (branchInstaller, root + filename))
+
+                  skiv_sha256_s sha256;
+
+                  if (SKIV_Stream_Download (branchInstaller, root + filename, nullptr,
+                        [&](const void* data, size_t size) { sha256.update (data, size); }))
+                  {
                     _res.state |= UpdateFlags_Downloaded;
+                    hex_str_downloaded = sha256.finish_hex ();
+                  }
                 }
               }
 
@@ -635,12 +646,9 @@ SKIF_Updater::PerformUpdateCheck (results_s& _res)
                   // If the repository.json file includes a hash, check it
                   hex_str_expected = version["SHA256"].get<std::string>();
 
-                  std::ifstream fileStream (root + filename, std::ios::binary);
-                  std::vector<unsigned char> hash (picosha2::k_digest_size);
-                  picosha2::hash256 (fileStream, hash.begin(), hash.end());
-                  fileStream.close  ();
-
-                  hex_str = picosha2::bytes_to_hex_string(hash.begin(), hash.end());
+                  // Installers downloaded by an earlier check are read back from disk
+                  hex_str = (! hex_str_downloaded.empty()) ? hex_str_downloaded
+                                                           : SKIV_SHA256_HashFile (root + filename);
                 }
                 catch (const std::exception&)
                 {
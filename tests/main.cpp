@@ -0,0 +1,70 @@
+#include "test.h"
+#include <d3d11.h>
+#include <concurrent_queue.h>
+
+// Owned by SKIV.cpp in the application; the tiler hands evicted textures to it
+concurrency::concurrent_queue <IUnknown *> SKIF_ResourcesToFree;
+
+// Compiled into viewer.cpp in the application; the ICC parser inflates iCCP chunks with it
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_JPEG
+#define STBI_ONLY_PNG
+#include <stb_image.h>
+
+// Owned by viewer.cpp in the application as well; the patched stb_image reports through them
+thread_local stbi__context::cicp_s SKIV_STBI_CICP;
+thread_local stbi__context::sbit_s SKIV_STBI_SBIT;
+thread_local stbi__result_info     SKIV_STBI_ResultInfo;
+
+// Owned by utility.cpp in the application; image_bc.cpp times DDS exports with it
+DWORD
+SKIF_Util_timeGetTime1 (void)
+{
+  return static_cast <DWORD> (GetTickCount64 ());
+}
+
+static int failures = 0;
+
+std::vector <skiv_test_s>&
+SKIV_Test_GetRegistry (void)
+{
+  static std::vector <skiv_test_s> registry;
+  return registry;
+}
+
+void
+SKIV_Test_Fail (const char* file, int line, const char* expr)
+{
+  printf ("%s(%d): error: check failed: %s\n", file, line, expr);
+  failures++;
+}
+
+int
+main (void)
+{
+  int failed_tests = 0;
+
+  for (const auto& test : SKIV_Test_GetRegistry ())
+  {
+    const int before = failures;
+
+    test.fn ();
+
+    const bool passed = (failures == before);
+
+    printf ("%s %s\n", passed ? "[  OK  ]" : "[FAILED]", test.name);
+
+    if (! passed)
+      failed_tests++;
+
+    IUnknown* pResource = nullptr;
+
+    while (SKIF_ResourcesToFree.try_pop (pResource))
+      pResource->Release ();
+  }
+
+  printf ("%zu tests, %d failed\n", SKIV_Test_GetRegistry ().size (), failed_tests);
+
+  return
+    (failed_tests == 0) ? 0 : 1;
+}
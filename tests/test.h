@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// Self-registering checks run by SKIV.Tests after every build; any failed
+//   check fails the build. Failures print as "file(line): error: ..." so that
+//     Visual Studio lists them like compiler errors.
+struct skiv_test_s {
+  const char* name;
+  void      (*fn) (void);
+};
+
+std::vector <skiv_test_s>& SKIV_Test_GetRegistry (void);
+void                       SKIV_Test_Fail        (const char* file, int line, const char* expr);
+
+struct skiv_test_registrar_s {
+  skiv_test_registrar_s (const char* name, void (*fn) (void))
+  {
+    SKIV_Test_GetRegistry ().push_back ({ name, fn });
+  }
+};
+
+#define SKIV_TEST(name)                                                      \
+  static void                  SKIV_Test_##name (void);                      \
+  static skiv_test_registrar_s SKIV_TestRegistrar_##name (#name, SKIV_Test_##name); \
+  static void                  SKIV_Test_##name (void)
+
+#define SKIV_CHECK(expr) \
+  ((expr) ? (void)0 : SKIV_Test_Fail (__FILE__, __LINE__, #expr))
+
+// |a - b| <= tolerance, NaN never passes
+#define SKIV_CHECK_NEAR(a, b, tolerance) \
+  ((std::fabs (static_cast <double> (a) - static_cast <double> (b)) <= (tolerance)) ? (void)0 : \
+    SKIV_Test_Fail (__FILE__, __LINE__, #a " ~= " #b))
@@ -0,0 +1,307 @@
+#include "test.h"
+#include <utility/image.h>
+#include <DirectXPackedVector.h>
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+using DirectX::PackedVector::XMConvertFloatToHalf;
+using DirectX::PackedVector::XMConvertHalfToFloat;
+
+// SKIV_Image_DecompressBC () against DirectX::Decompress, on random blocks of
+//   every format. BC1 - BC5 and BC7 must produce the same bytes; BC6H is
+//     compared in float with a small tolerance.
+
+// Not a multiple of 4 either way, so the last column and row of blocks are cut
+constexpr size_t SKIV_TEST_BC_WIDTH  = 37;
+constexpr size_t SKIV_TEST_BC_HEIGHT = 21;
+
+static void
+SKIV_Test_MakeBlocks (DXGI_FORMAT format, DirectX::ScratchImage& image)
+{
+  image.Initialize2D (format, SKIV_TEST_BC_WIDTH, SKIV_TEST_BC_HEIGHT, 1, 1);
+
+  std::mt19937 rng (0x39);
+
+  const DirectX::Image* pImage =
+    image.GetImage (0, 0, 0);
+
+  const bool is_bc1 = (format == DXGI_FORMAT_BC1_UNORM || format == DXGI_FORMAT_BC1_UNORM_SRGB);
+  const bool is_bc4 = (format == DXGI_FORMAT_BC4_SNORM || format == DXGI_FORMAT_BC4_UNORM ||
+                       format == DXGI_FORMAT_BC5_SNORM || format == DXGI_FORMAT_BC5_UNORM);
+  const bool is_bc7 = (format == DXGI_FORMAT_BC7_UNORM || format == DXGI_FORMAT_BC7_UNORM_SRGB);
+
+  const size_t block_bytes =
+    DirectX::BitsPerPixel (format) * 2;
+
+  for (size_t by = 0; by < (pImage->height + 3) / 4; ++by)
+  {
+    for (size_t bx = 0; bx < (pImage->width + 3) / 4; ++bx)
+    {
+      uint8_t*     block = pImage->pixels + by * pImage->rowPitch + bx * block_bytes;
+      const size_t n     = by * 16 + bx;
+
+      for (size_t i = 0; i < block_bytes; ++i)
+        block [i] = static_cast <uint8_t> (rng ());
+
+      // Equal endpoints, which BC1 decodes in its three-colour mode
+      if (is_bc1 && n % 5 == 0)
+        memcpy (block + 2, block, 2);
+
+      // -128 and -127 (the same value) as either endpoint, in both orders
+      if (is_bc4 && n % 3 == 0)
+      {
+        for (size_t half = 0; half < block_bytes; half += 8)
+        {
+          block [half + 0] = (n % 2 == 0) ? 0x80 : 0x81;
+          block [half + 1] = (n % 2 == 0) ? 0x81 : 0x80;
+        }
+      }
+
+      // Every mode about equally often, and the reserved one (no mode bit set)
+      if (is_bc7)
+      {
+        const uint32_t mode = n % 9;
+
+        block [0] = (mode == 8) ? 0 :
+          static_cast <uint8_t> ((block [0] << (mode + 1)) | (1 << mode));
+      }
+    }
+  }
+}
+
+SKIV_TEST (BC_DecompressMatchesDirectXTex)
+{
+  // DirectXTex decodes BC4 / BC5 into R8 / R8G8, so only those are compared
+  static const struct {
+    DXGI_FORMAT format;
+    DXGI_FORMAT output;     // SKIV_Image_DecompressBC
+    DXGI_FORMAT reference;  // DirectX::Decompress
+    size_t      channels;
+  } formats [] = {
+    { DXGI_FORMAT_BC1_UNORM,      DXGI_FORMAT_R8G8B8A8_UNORM,      DXGI_FORMAT_R8G8B8A8_UNORM,      4 },
+    { DXGI_FORMAT_BC1_UNORM_SRGB, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, 4 },
+    { DXGI_FORMAT_BC2_UNORM,      DXGI_FORMAT_R8G8B8A8_UNORM,      DXGI_FORMAT_R8G8B8A8_UNORM,      4 },
+    { DXGI_FORMAT_BC2_UNORM_SRGB, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, 4 },
+    { DXGI_FORMAT_BC3_UNORM,      DXGI_FORMAT_R8G8B8A8_UNORM,      DXGI_FORMAT_R8G8B8A8_UNORM,      4 },
+    { DXGI_FORMAT_BC3_UNORM_SRGB, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, 4 },
+    { DXGI_FORMAT_BC4_UNORM,      DXGI_FORMAT_R8G8B8A8_UNORM,      DXGI_FORMAT_R8_UNORM,            1 },
+    { DXGI_FORMAT_BC4_SNORM,      DXGI_FORMAT_R8G8B8A8_SNORM,      DXGI_FORMAT_R8_SNORM,            1 },
+    { DXGI_FORMAT_BC5_UNORM,      DXGI_FORMAT_R8G8B8A8_UNORM,      DXGI_FORMAT_R8G8_UNORM,          2 },
+    { DXGI_FORMAT_BC5_SNORM,      DXGI_FORMAT_R8G8B8A8_SNORM,      DXGI_FORMAT_R8G8_SNORM,          2 },
+    { DXGI_FORMAT_BC6H_UF16,      DXGI_FORMAT_R16G16B16A16_FLOAT,  DXGI_FORMAT_R16G16B16A16_FLOAT,  4 },
+    { DXGI_FORMAT_BC6H_SF16,      DXGI_FORMAT_R16G16B16A16_FLOAT,  DXGI_FORMAT_R16G16B16A16_FLOAT,  4 },
+    { DXGI_FORMAT_BC7_UNORM,      DXGI_FORMAT_R8G8B8A8_UNORM,      DXGI_FORMAT_R8G8B8A8_UNORM,      4 },
+    { DXGI_FORMAT_BC7_UNORM_SRGB, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, 4 }
+  };
+
+  for (const auto& [format, output, reference_format, channels] : formats)
+  {
+    DirectX::ScratchImage blocks;
+    SKIV_Test_MakeBlocks (format, blocks);
+
+    DirectX::ScratchImage ours,
+                          reference;
+
+    SKIV_CHECK (SUCCEEDED (SKIV_Image_DecompressBC (*blocks.GetImage (0, 0, 0),                   ours)));
+    SKIV_CHECK (SUCCEEDED (DirectX::Decompress     (*blocks.GetImage (0, 0, 0), reference_format, reference)));
+
+    const DirectX::Image* a = ours     .GetImage (0, 0, 0);
+    const DirectX::Image* b = reference.GetImage (0, 0, 0);
+
+    SKIV_CHECK (a != nullptr && b != nullptr);
+
+    if (a == nullptr || b == nullptr)
+      continue;
+
+    SKIV_CHECK (a->format == output);
+    SKIV_CHECK (a->width  == b->width && a->height == b->height);
+
+    const bool   is_bc6h      = (output == DXGI_FORMAT_R16G16B16A16_FLOAT);
+    const size_t pixel_bytes  = DirectX::BitsPerPixel (b->format) / 8;
+    size_t       mismatches   = 0;
+    double       max_relative = 0.0;
+
+    for (size_t y = 0; y < a->height; ++y)
+    {
+      for (size_t x = 0; x < a->width; ++x)
+      {
+        for (size_t c = 0; c < channels; ++c)
+        {
+          if (is_bc6h)
+          {
+            const float va = XMConvertHalfToFloat (reinterpret_cast <const uint16_t *> (a->pixels + y * a->rowPitch) [x * 4 + c]);
+            const float vb = XMConvertHalfToFloat (reinterpret_cast <const uint16_t *> (b->pixels + y * b->rowPitch) [x * 4 + c]);
+
+            max_relative = std::max (max_relative, static_cast <double> (std::fabs (va - vb) / std::max (1.0f, std::fabs (vb))));
+          }
+
+          else
+            mismatches += (a->pixels [y * a->rowPitch + x * 4 + c] != b->pixels [y * b->rowPitch + x * pixel_bytes + c]);
+        }
+      }
+    }
+
+    if (mismatches != 0 || max_relative > 0.001)
+      printf ("DXGI_FORMAT %d: %zu bytes differ, largest relative difference %g\n", format, mismatches, max_relative);
+
+    SKIV_CHECK (mismatches   == 0);
+    SKIV_CHECK (max_relative <= 0.001);
+  }
+}
+
+// SKIV_Image_CompressBC () at every preset, decoded by DirectX::Decompress and
+//   held to a PSNR floor, so that a change to the encoders that costs quality
+//     shows up here.
+
+// Gradients, hard edges, a smooth blob and some noise in every channel; FP16
+//   goes up to 16x SDR white
+static void
+SKIV_Test_MakeEncoderSource (DXGI_FORMAT format, DirectX::ScratchImage& image)
+{
+  constexpr size_t size = 64;
+
+  const bool is_hdr    = (format == DXGI_FORMAT_BC6H_UF16 || format == DXGI_FORMAT_BC6H_SF16);
+  const bool is_signed = (format == DXGI_FORMAT_BC6H_SF16);
+
+  image.Initialize2D (is_hdr ? DXGI_FORMAT_R16G16B16A16_FLOAT : DXGI_FORMAT_R8G8B8A8_UNORM, size, size, 1, 1);
+
+  std::mt19937 rng (0x40);
+
+  const DirectX::Image* pImage =
+    image.GetImage (0, 0, 0);
+
+  for (size_t y = 0; y < size; ++y)
+  {
+    for (size_t x = 0; x < size; ++x)
+    {
+      const float u = static_cast <float> (x) / (size - 1);
+      const float v = static_cast <float> (y) / (size - 1);
+      const float d = (u - 0.5f) * (u - 0.5f) + (v - 0.5f) * (v - 0.5f);
+
+      float rgba [4] = {
+        u,
+        ((x / 8 + y / 8) % 2 == 0) ? 0.2f + 0.6f * v : 0.9f - 0.5f * u,
+        std::exp (-d * 12.0f),
+        (x < size / 2) ? 1.0f : v
+      };
+
+      for (float& value : rgba)
+        value = std::clamp (value + static_cast <float> (rng () % 9) / 255.0f - 4.0f / 255.0f, 0.0f, 1.0f);
+
+      if (is_hdr)
+      {
+        uint16_t* pixel =
+          reinterpret_cast <uint16_t *> (pImage->pixels + y * pImage->rowPitch) + x * 4;
+
+        // Saturated colours dip below zero in the other channels, as wide
+        //   gamut colours do in scRGB
+        for (size_t c = 0; c < 3; ++c)
+          pixel [c] = XMConvertFloatToHalf (rgba [c] * rgba [c] * 16.0f - (is_signed ? 0.25f * rgba [(c + 1) % 3] : 0.0f));
+
+        pixel [3] = XMConvertFloatToHalf (1.0f);
+      }
+
+      else
+      {
+        for (size_t c = 0; c < 4; ++c)
+          pImage->pixels [y * pImage->rowPitch + x * 4 + c] = static_cast <uint8_t> (rgba [c] * 255.0f + 0.5f);
+      }
+    }
+  }
+}
+
+// Over RGBA for 8-bit images; FP16 is compared over RGB after x / (1 + |x|),
+//   so that the shadows count for about as much as the highlights, like they
+//     do for BC6H, which interpolates half-float bit patterns
+static double
+SKIV_Test_GetPSNR (const DirectX::Image& source, const DirectX::Image& decoded)
+{
+  const bool   is_hdr   = (source.format == DXGI_FORMAT_R16G16B16A16_FLOAT);
+  const size_t channels = is_hdr ? 3 : 4;
+  const double peak     = is_hdr ? 1.0 : 255.0;
+
+  double error = 0.0;
+
+  for (size_t y = 0; y < source.height; ++y)
+  {
+    for (size_t x = 0; x < source.width; ++x)
+    {
+      for (size_t c = 0; c < channels; ++c)
+      {
+        double a, b;
+
+        if (is_hdr)
+        {
+          a = XMConvertHalfToFloat (reinterpret_cast <const uint16_t *> (source .pixels + y * source .rowPitch) [x * 4 + c]);
+          b = XMConvertHalfToFloat (reinterpret_cast <const uint16_t *> (decoded.pixels + y * decoded.rowPitch) [x * 4 + c]);
+
+          a /= 1.0 + std::fabs (a);
+          b /= 1.0 + std::fabs (b);
+        }
+
+        else
+        {
+          a = source .pixels [y * source .rowPitch + x * 4 + c];
+          b = decoded.pixels [y * decoded.rowPitch + x * 4 + c];
+        }
+
+        error += (a - b) * (a - b);
+      }
+    }
+  }
+
+  const double mse =
+    error / static_cast <double> (source.width * source.height * channels);
+
+  return (mse == 0.0) ? 99.0
+                      : 10.0 * std::log10 (peak * peak / mse);
+}
+
+SKIV_TEST (BC_CompressMeetsPSNRFloors)
+{
+  // Floors in dB for Fast, Normal and Best, about 1.5 dB below what the
+  //   encoder reaches; Normal and Best also have to do at least as well as Fast
+  static const struct {
+    DXGI_FORMAT format;
+    DXGI_FORMAT reference;
+    double      floors [3];
+  } formats [] = {
+    { DXGI_FORMAT_BC7_UNORM,      DXGI_FORMAT_R8G8B8A8_UNORM,      { 37.5, 39.0, 39.0 } },
+    { DXGI_FORMAT_BC7_UNORM_SRGB, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, { 37.5, 39.0, 39.0 } },
+    { DXGI_FORMAT_BC6H_UF16,      DXGI_FORMAT_R16G16B16A16_FLOAT,  { 36.5, 39.0, 39.0 } },
+    { DXGI_FORMAT_BC6H_SF16,      DXGI_FORMAT_R16G16B16A16_FLOAT,  { 32.0, 35.5, 35.5 } }
+  };
+
+  for (const auto& [format, reference_format, floors] : formats)
+  {
+    DirectX::ScratchImage source;
+    SKIV_Test_MakeEncoderSource (format, source);
+
+    double fast = 0.0;
+
+    for (SKIV_BCQuality quality : { SKIV_BCQuality_Fast, SKIV_BCQuality_Normal, SKIV_BCQuality_Best })
+    {
+      DirectX::ScratchImage compressed,
+                            decoded;
+
+      SKIV_CHECK (SUCCEEDED (SKIV_Image_CompressBC (*source.GetImage (0, 0, 0), format, quality, compressed)));
+      SKIV_CHECK (compressed.GetMetadata ().format == format);
+      SKIV_CHECK (SUCCEEDED (DirectX::Decompress (*compressed.GetImage (0, 0, 0), reference_format, decoded)));
+
+      if (decoded.GetImage (0, 0, 0) == nullptr)
+        continue;
+
+      const double psnr =
+        SKIV_Test_GetPSNR (*source.GetImage (0, 0, 0), *decoded.GetImage (0, 0, 0));
+
+      printf ("DXGI_FORMAT %d, quality %d: %.2f dB\n", format, quality, psnr);
+
+      if (quality == SKIV_BCQuality_Fast)
+        fast = psnr;
+
+      SKIV_CHECK (psnr >= floors [quality]);
+      SKIV_CHECK (psnr >= fast - 0.05);
+    }
+  }
+}
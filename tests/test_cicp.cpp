@@ -0,0 +1,188 @@
+#include "test.h"
+#include <utility/image.h>
+#include <array>
+#include <cstring>
+
+// Known signal levels through SKIV_Image_DecodeCICP (); the output is FP16,
+//   so the tolerances are relative to the value.
+
+// One FP32 pixel per entry of signals
+static std::vector <float>
+SKIV_Test_DecodeCICP (const std::vector <std::array <float, 3>>& signals, const skiv_cicp_s& cicp, bool& wcg, bool& hdr)
+{
+  std::vector <float> row;
+
+  for (const auto& signal : signals)
+    row.insert (row.end (), { signal [0], signal [1], signal [2], 0.5f });
+
+  const DirectX::Image image = {
+    .width      = signals.size (),
+    .height     = 1,
+    .format     = DXGI_FORMAT_R32G32B32A32_FLOAT,
+    .rowPitch   = row.size () * sizeof (float),
+    .slicePitch = row.size () * sizeof (float),
+    .pixels     = reinterpret_cast <uint8_t *> (row.data ())
+  };
+
+  DirectX::ScratchImage decoded;
+
+  SKIV_CHECK (SUCCEEDED (SKIV_Image_DecodeCICP (image, cicp, decoded, wcg, hdr)));
+  SKIV_CHECK (decoded.GetMetadata ().format == DXGI_FORMAT_R16G16B16A16_FLOAT);
+
+  std::vector <float> pixels (row.size ());
+
+  if (decoded.GetPixels () != nullptr)
+    SKIV_Image_UnpackFP16toFP32 (reinterpret_cast <const uint16_t *> (decoded.GetPixels ()), pixels.data (), pixels.size ());
+
+  return pixels;
+}
+
+#define SKIV_CHECK_SCRGB(pixels, x, r, g, b)                                     \
+  do {                                                                           \
+    SKIV_CHECK_NEAR ((pixels) [(x) * 4 + 0], (r), 0.002 * std::fabs (r) + 1e-4); \
+    SKIV_CHECK_NEAR ((pixels) [(x) * 4 + 1], (g), 0.002 * std::fabs (g) + 1e-4); \
+    SKIV_CHECK_NEAR ((pixels) [(x) * 4 + 2], (b), 0.002 * std::fabs (b) + 1e-4); \
+    SKIV_CHECK      ((pixels) [(x) * 4 + 3] == 0.5f);                            \
+  } while (0)
+
+SKIV_TEST (CICP_GrayLevels)
+{
+  static const struct {
+    skiv_cicp_s cicp;
+    float       signal;
+    double      scrgb;
+  } references [] = {
+    { { .primaries =  1, .transfer_func = 13 },                          0.5f,       0.2140482 }, // sRGB
+    { { .primaries =  1, .transfer_func =  1 },                          0.5f,       0.2595894 }, // BT.709
+    { { .primaries =  1, .transfer_func =  4 },                          0.5f,       0.2176376 }, // Gamma 2.2
+    { { .primaries =  1, .transfer_func =  5 },                          0.5f,       0.1435873 }, // Gamma 2.8
+    { { .primaries =  1, .transfer_func =  8, .linear_scale = 3.0f },    0.5f,       1.5       }, // Linear
+    { { .primaries =  9, .transfer_func = 16 },                          0.5080784f, 1.25      }, // PQ, 100 nits
+    { { .primaries =  9, .transfer_func = 16 },                          0.75f,      12.292223 }, // PQ, 983 nits
+    { { .primaries =  9, .transfer_func = 18 },                          0.75f,      2.5394    }, // HLG, 1000 nits peak
+    { { .primaries = 12, .transfer_func = 13 },                          1.0f,       1.0       }  // Display P3
+  };
+
+  for (const auto& reference : references)
+  {
+    bool wcg = true,
+         hdr = false;
+
+    const auto pixels =
+      SKIV_Test_DecodeCICP ({ { reference.signal, reference.signal, reference.signal } }, reference.cicp, wcg, hdr);
+
+    // Gray stays gray, whatever the primaries
+    SKIV_CHECK_SCRGB (pixels, 0, reference.scrgb, reference.scrgb, reference.scrgb);
+
+    SKIV_CHECK (! wcg);
+    SKIV_CHECK (hdr == (reference.scrgb > 1.0));
+  }
+}
+
+SKIV_TEST (CICP_Primaries)
+{
+  bool wcg = false,
+       hdr = true;
+
+  // Linear, so that the columns of the matrices to Rec. 709 come out as they are
+  const auto bt2020 =
+    SKIV_Test_DecodeCICP ({ { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } }, { .primaries = 9, .transfer_func = 8 }, wcg, hdr);
+
+  SKIV_CHECK_SCRGB (bt2020, 0,  1.6604910, -0.1245505, -0.0181508);
+  SKIV_CHECK_SCRGB (bt2020, 1, -0.5876411,  1.1328999, -0.1005789);
+  SKIV_CHECK_SCRGB (bt2020, 2, -0.0728499, -0.0083494,  1.1187297);
+
+  SKIV_CHECK (wcg);
+  SKIV_CHECK (hdr);
+
+  const auto p3 =
+    SKIV_Test_DecodeCICP ({ { 1.0f, 0.0f, 0.0f } }, { .primaries = 12, .transfer_func = 8 }, wcg, hdr);
+
+  SKIV_CHECK_SCRGB (p3, 0, 1.2249402, -0.0420570, -0.0196376);
+  SKIV_CHECK (wcg);
+
+  // Rec. 709 red is the only primary that stays in range
+  const auto bt709 =
+    SKIV_Test_DecodeCICP ({ { 1.0f, 0.0f, 0.0f } }, { .primaries = 1, .transfer_func = 8 }, wcg, hdr);
+
+  SKIV_CHECK_SCRGB (bt709, 0, 1.0, 0.0, 0.0);
+  SKIV_CHECK (! wcg);
+  SKIV_CHECK (! hdr);
+}
+
+SKIV_TEST (CICP_UnsupportedCodesDecodeAsSRGB)
+{
+  bool wcg = false,
+       hdr = false;
+
+  // 2 = Unspecified, 22 / 17 are reserved / SMPTE ST 428
+  for (const skiv_cicp_s cicp : { skiv_cicp_s { .primaries = 2,  .transfer_func = 2  },
+                                  skiv_cicp_s { .primaries = 22, .transfer_func = 17 } })
+  {
+    const auto pixels =
+      SKIV_Test_DecodeCICP ({ { 0.5f, 1.0f, 0.0f } }, cicp, wcg, hdr);
+
+    SKIV_CHECK_SCRGB (pixels, 0, 0.2140482, 1.0, 0.0);
+  }
+}
+
+SKIV_TEST (CICP_SDRCurvesAreMirrored)
+{
+  bool wcg = false,
+       hdr = false;
+
+  // Float decoders overshoot below 0
+  const auto pixels =
+    SKIV_Test_DecodeCICP ({ { -0.5f, 0.5f, 0.5f } }, { .primaries = 1, .transfer_func = 13 }, wcg, hdr);
+
+  SKIV_CHECK_SCRGB (pixels, 0, -0.2140482, 0.2140482, 0.2140482);
+  SKIV_CHECK (wcg);
+}
+
+SKIV_TEST (CICP_IntegerInputs)
+{
+  // Widths that do not fill the last 8 pixels, over several rows
+  constexpr size_t width  = 13,
+                   height = 3;
+
+  bool wcg = true,
+       hdr = true;
+
+  DirectX::ScratchImage rgba8;
+  rgba8.Initialize2D (DXGI_FORMAT_R8G8B8A8_UNORM, width, height, 1, 1);
+
+  std::memset (rgba8.GetPixels (), 188, rgba8.GetPixelsSize ());
+
+  DirectX::ScratchImage decoded;
+
+  SKIV_CHECK (SUCCEEDED (SKIV_Image_DecodeCICP (*rgba8.GetImage (0, 0, 0), { }, decoded, wcg, hdr)));
+  SKIV_CHECK (! wcg && ! hdr);
+
+  std::vector <float> pixels (width * height * 4);
+  SKIV_Image_UnpackFP16toFP32 (reinterpret_cast <const uint16_t *> (decoded.GetPixels ()), pixels.data (), pixels.size ());
+
+  for (size_t i = 0; i < pixels.size (); ++i)
+    SKIV_CHECK_NEAR (pixels [i], (i % 4 == 3) ? 188.0 / 255.0 : 0.5028865, 2e-3);
+
+  DirectX::ScratchImage rgba16;
+  rgba16.Initialize2D (DXGI_FORMAT_R16G16B16A16_UNORM, width, height, 1, 1);
+
+  auto words =
+    reinterpret_cast <uint16_t *> (rgba16.GetPixels ());
+
+  for (size_t i = 0; i < width * height * 4; ++i)
+    words [i] = 32768;
+
+  SKIV_CHECK (SUCCEEDED (SKIV_Image_DecodeCICP (*rgba16.GetImage (0, 0, 0), { }, decoded, wcg, hdr)));
+
+  SKIV_Image_UnpackFP16toFP32 (reinterpret_cast <const uint16_t *> (decoded.GetPixels ()), pixels.data (), pixels.size ());
+
+  for (size_t i = 0; i < pixels.size (); ++i)
+    SKIV_CHECK_NEAR (pixels [i], (i % 4 == 3) ? 32768.0 / 65535.0 : 0.2140482, 1e-3);
+
+  // BGRA would decode with red and blue swapped
+  DirectX::ScratchImage bgra8;
+  bgra8.Initialize2D (DXGI_FORMAT_B8G8R8A8_UNORM, width, height, 1, 1);
+
+  SKIV_CHECK (SKIV_Image_DecodeCICP (*bgra8.GetImage (0, 0, 0), { }, decoded, wcg, hdr) == E_INVALIDARG);
+}
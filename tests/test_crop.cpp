@@ -0,0 +1,313 @@
+#include "test.h"
+#include <utility/image.h>
+#include <DirectXPackedVector.h>
+#include <algorithm>
+#include <cstring>
+
+using DirectX::PackedVector::XMConvertFloatToHalf;
+using DirectX::PackedVector::XMConvertHalfToFloat;
+
+// Odd sizes, so that neither axis is a multiple of the 8-pixel kernels
+constexpr size_t SKIV_TEST_CROP_WIDTH  = 37;
+constexpr size_t SKIV_TEST_CROP_HEIGHT = 23;
+
+// Every rectangle is clipped to the image; these overhang the right, the
+//   bottom and both edges, and rotation carries each overhang to a
+//     different edge of the result.
+static const DirectX::Rect SKIV_Test_CropRects [] = {
+  {  0,  0, SKIV_TEST_CROP_WIDTH, SKIV_TEST_CROP_HEIGHT },
+  {  5,  3, 11,  7 },
+  { 30,  4, 20,  9 }, // Right
+  {  6, 17, 10, 40 }, // Bottom
+  { 29, 15, 99, 99 }, // Right and bottom
+  {  0,  0,  1, 50 }, // Single column
+  { 36, 22,  5,  5 }  // Single pixel in the corner
+};
+
+static const DXGI_MODE_ROTATION SKIV_Test_Rotations [] = {
+  DXGI_MODE_ROTATION_IDENTITY,
+  DXGI_MODE_ROTATION_ROTATE90,
+  DXGI_MODE_ROTATION_ROTATE180,
+  DXGI_MODE_ROTATION_ROTATE270
+};
+
+// Source pixel shown at (u, v) of the clipped rect rotated clockwise
+static void
+SKIV_Test_MapCropped (const DirectX::Rect& rect, DXGI_MODE_ROTATION rotation, size_t u, size_t v, size_t& x, size_t& y)
+{
+  const size_t x0 = rect.x, x1 = std::min (rect.x + rect.w, SKIV_TEST_CROP_WIDTH)  - 1;
+  const size_t y0 = rect.y, y1 = std::min (rect.y + rect.h, SKIV_TEST_CROP_HEIGHT) - 1;
+
+  switch (rotation)
+  {
+    case DXGI_MODE_ROTATION_ROTATE90:  x = x0 + v; y = y1 - u; break;
+    case DXGI_MODE_ROTATION_ROTATE180: x = x1 - u; y = y1 - v; break;
+    case DXGI_MODE_ROTATION_ROTATE270: x = x1 - v; y = y0 + u; break;
+    default:                           x = x0 + u; y = y0 + v; break;
+  }
+}
+
+static float
+SKIV_Test_SRGBToLinear (uint8_t v)
+{
+  const double c = v / 255.0;
+
+  return static_cast <float> ((c <= 0.04045) ? c / 12.92 : std::pow ((c + 0.055) / 1.055, 2.4));
+}
+
+// BT.2100 PQ of a scRGB value (1.0 = 80 nits)
+static uint32_t
+SKIV_Test_EncodePQ10 (double scrgb)
+{
+  const double m1 = 2610.0 / 16384.0,        m2 = 2523.0 / 4096.0 * 128.0;
+  const double c1 = 3424.0 / 4096.0,         c2 = 2413.0 / 4096.0 * 32.0,
+               c3 = 2392.0 / 4096.0 * 32.0;
+
+  const double y  = std::pow (std::max (scrgb, 0.0) * 80.0 / 10000.0, m1);
+  const double pq = std::pow ((c1 + c2 * y) / (1.0 + c3 * y), m2);
+
+  return static_cast <uint32_t> (std::lround (std::min (pq, 1.0) * 1023.0));
+}
+
+// 8-bit pixels whose channels encode their position
+static void
+SKIV_Test_MakeCropSource8 (DXGI_FORMAT format, DirectX::ScratchImage& image)
+{
+  image.Initialize2D (format, SKIV_TEST_CROP_WIDTH, SKIV_TEST_CROP_HEIGHT, 1, 1);
+
+  const DirectX::Image* pImage = image.GetImage (0, 0, 0);
+
+  for (size_t y = 0; y < SKIV_TEST_CROP_HEIGHT; ++y)
+  {
+    uint8_t* row = pImage->pixels + y * pImage->rowPitch;
+
+    for (size_t x = 0; x < SKIV_TEST_CROP_WIDTH; ++x)
+    {
+      row [x * 4 + 0] = static_cast <uint8_t> (x * 5);
+      row [x * 4 + 1] = static_cast <uint8_t> (y * 11);
+      row [x * 4 + 2] = static_cast <uint8_t> (255 - x * 3);
+      row [x * 4 + 3] = static_cast <uint8_t> (x + y);
+    }
+  }
+}
+
+// scRGB pixels whose channels encode their position, and stray outside [0, 1]
+static float
+SKIV_Test_CropValue (size_t x, size_t y, int channel)
+{
+  switch (channel)
+  {
+    case 0:  return static_cast <float> (x) / 16.0f;          // Up to 2.25
+    case 1:  return static_cast <float> (y) / 16.0f - 0.25f;  // Negative at the top
+    case 2:  return static_cast <float> (x + y) / 64.0f;
+    default: return 0.5f;
+  }
+}
+
+static void
+SKIV_Test_MakeCropSourceFP16 (DirectX::ScratchImage& image)
+{
+  image.Initialize2D (DXGI_FORMAT_R16G16B16A16_FLOAT, SKIV_TEST_CROP_WIDTH, SKIV_TEST_CROP_HEIGHT, 1, 1);
+
+  const DirectX::Image* pImage = image.GetImage (0, 0, 0);
+
+  for (size_t y = 0; y < SKIV_TEST_CROP_HEIGHT; ++y)
+  {
+    uint16_t* row =
+      reinterpret_cast <uint16_t *> (pImage->pixels + y * pImage->rowPitch);
+
+    for (size_t x = 0; x < SKIV_TEST_CROP_WIDTH; ++x)
+      for (int c = 0; c < 4; ++c)
+        row [x * 4 + c] = XMConvertFloatToHalf (SKIV_Test_CropValue (x, y, c));
+  }
+}
+
+// Runs every rect at every rotation, and hands each destination pixel to check
+//   along with the source pixel it has to come from
+template <typename _Check>
+static void
+SKIV_Test_ForEachCrop (const DirectX::Image& source, DXGI_FORMAT format, _Check check)
+{
+  for (const auto& rect : SKIV_Test_CropRects)
+  {
+    for (const auto rotation : SKIV_Test_Rotations)
+    {
+      DirectX::ScratchImage result;
+
+      SKIV_CHECK (SUCCEEDED (SKIV_Image_CropRotate (source, rect, rotation, format, result)));
+
+      const DirectX::Image* pDest = result.GetImage (0, 0, 0);
+
+      SKIV_CHECK (pDest != nullptr && pDest->format == format);
+
+      if (pDest == nullptr)
+        continue;
+
+      const size_t clipped_w = std::min (rect.w, SKIV_TEST_CROP_WIDTH  - rect.x);
+      const size_t clipped_h = std::min (rect.h, SKIV_TEST_CROP_HEIGHT - rect.y);
+      const bool   swap_axes = (rotation == DXGI_MODE_ROTATION_ROTATE90 ||
+                                rotation == DXGI_MODE_ROTATION_ROTATE270);
+
+      SKIV_CHECK (pDest->width  == (swap_axes ? clipped_h : clipped_w));
+      SKIV_CHECK (pDest->height == (swap_axes ? clipped_w : clipped_h));
+
+      for (size_t v = 0; v < pDest->height; ++v)
+      {
+        for (size_t u = 0; u < pDest->width; ++u)
+        {
+          size_t x, y;
+          SKIV_Test_MapCropped (rect, rotation, u, v, x, y);
+
+          check (pDest->pixels + v * pDest->rowPitch, u, x, y);
+        }
+      }
+    }
+  }
+}
+
+SKIV_TEST (CropRotate_Copy8)
+{
+  DirectX::ScratchImage source;
+  SKIV_Test_MakeCropSource8 (DXGI_FORMAT_R8G8B8A8_UNORM, source);
+
+  const DirectX::Image& src = *source.GetImage (0, 0, 0);
+
+  SKIV_Test_ForEachCrop (src, DXGI_FORMAT_R8G8B8A8_UNORM, [&](const uint8_t* row, size_t u, size_t x, size_t y)
+  {
+    SKIV_CHECK (memcmp (row + u * 4, src.pixels + y * src.rowPitch + x * 4, 4) == 0);
+  });
+}
+
+SKIV_TEST (CropRotate_CopyFP16)
+{
+  DirectX::ScratchImage source;
+  SKIV_Test_MakeCropSourceFP16 (source);
+
+  const DirectX::Image& src = *source.GetImage (0, 0, 0);
+
+  SKIV_Test_ForEachCrop (src, DXGI_FORMAT_R16G16B16A16_FLOAT, [&](const uint8_t* row, size_t u, size_t x, size_t y)
+  {
+    SKIV_CHECK (memcmp (row + u * 8, src.pixels + y * src.rowPitch + x * 8, 8) == 0);
+  });
+}
+
+SKIV_TEST (CropRotate_CopyOpaque)
+{
+  DirectX::ScratchImage source;
+  SKIV_Test_MakeCropSource8 (DXGI_FORMAT_B8G8R8A8_UNORM, source);
+
+  const DirectX::Image& src = *source.GetImage (0, 0, 0);
+
+  SKIV_Test_ForEachCrop (src, DXGI_FORMAT_B8G8R8X8_UNORM, [&](const uint8_t* row, size_t u, size_t x, size_t y)
+  {
+    const uint8_t* in = src.pixels + y * src.rowPitch + x * 4;
+
+    SKIV_CHECK (memcmp (row + u * 4, in, 3) == 0 && row [u * 4 + 3] == 255);
+  });
+}
+
+SKIV_TEST (CropRotate_ToFP16)
+{
+  DirectX::ScratchImage source;
+  SKIV_Test_MakeCropSource8 (DXGI_FORMAT_B8G8R8A8_UNORM_SRGB, source);
+
+  const DirectX::Image& src = *source.GetImage (0, 0, 0);
+
+  // BGRA in, RGBA out; color is linearized, alpha is not
+  SKIV_Test_ForEachCrop (src, DXGI_FORMAT_R16G16B16A16_FLOAT, [&](const uint8_t* row, size_t u, size_t x, size_t y)
+  {
+    const uint8_t*  in  = src.pixels + y * src.rowPitch + x * 4;
+    const uint16_t* out = reinterpret_cast <const uint16_t *> (row) + u * 4;
+
+    SKIV_CHECK_NEAR (XMConvertHalfToFloat (out [0]), SKIV_Test_SRGBToLinear (in [2]), 1e-3);
+    SKIV_CHECK_NEAR (XMConvertHalfToFloat (out [1]), SKIV_Test_SRGBToLinear (in [1]), 1e-3);
+    SKIV_CHECK_NEAR (XMConvertHalfToFloat (out [2]), SKIV_Test_SRGBToLinear (in [0]), 1e-3);
+    SKIV_CHECK_NEAR (XMConvertHalfToFloat (out [3]), in [3] / 255.0,                  1e-3);
+  });
+}
+
+SKIV_TEST (CropRotate_ToSDR)
+{
+  DirectX::ScratchImage source;
+  SKIV_Test_MakeCropSourceFP16 (source);
+
+  const DirectX::Image& src = *source.GetImage (0, 0, 0);
+
+  // Clipped to [0, 1] and sRGB encoded, swizzled for BGRA
+  for (const DXGI_FORMAT format : { DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, DXGI_FORMAT_B8G8R8A8_UNORM })
+  {
+    const bool bgra = (format == DXGI_FORMAT_B8G8R8A8_UNORM);
+
+    SKIV_Test_ForEachCrop (src, format, [&](const uint8_t* row, size_t u, size_t x, size_t y)
+    {
+      const uint8_t* out = row + u * 4;
+
+      for (int c = 0; c < 3; ++c)
+      {
+        const double linear =
+          std::clamp (static_cast <double> (XMConvertHalfToFloat (XMConvertFloatToHalf (SKIV_Test_CropValue (x, y, c)))), 0.0, 1.0);
+
+        const double encoded =
+          255.0 * ((linear <= 0.0031308) ? linear * 12.92 : 1.055 * std::pow (linear, 1.0 / 2.4) - 0.055);
+
+        SKIV_CHECK_NEAR (out [bgra ? 2 - c : c], encoded, 1.0);
+      }
+
+      SKIV_CHECK (out [3] == 128);
+    });
+  }
+}
+
+SKIV_TEST (CropRotate_ToHDR10)
+{
+  DirectX::ScratchImage source;
+  SKIV_Test_MakeCropSourceFP16 (source);
+
+  const DirectX::Image& src = *source.GetImage (0, 0, 0);
+
+  // Rec. 709 -> Rec. 2020 (c_from709to2020), then PQ; alpha is always opaque
+  static constexpr double to2020 [3][3] = {
+    { 0.627403914928436279296875,      0.3292830288410186767578125,  0.0433130674064159393310546875 },
+    { 0.069097287952899932861328125,   0.9195404052734375,           0.011362315155565738677978515625 },
+    { 0.01639143936336040496826171875, 0.08801330626010894775390625, 0.895595252513885498046875 }
+  };
+
+  SKIV_Test_ForEachCrop (src, DXGI_FORMAT_R10G10B10A2_UNORM, [&](const uint8_t* row, size_t u, size_t x, size_t y)
+  {
+    const uint32_t packed =
+      reinterpret_cast <const uint32_t *> (row) [u];
+
+    double rgb [3];
+
+    for (int c = 0; c < 3; ++c)
+      rgb [c] = XMConvertHalfToFloat (XMConvertFloatToHalf (SKIV_Test_CropValue (x, y, c)));
+
+    for (int c = 0; c < 3; ++c)
+    {
+      const uint32_t expected =
+        SKIV_Test_EncodePQ10 (to2020 [c][0] * rgb [0] + to2020 [c][1] * rgb [1] + to2020 [c][2] * rgb [2]);
+
+      SKIV_CHECK_NEAR ((packed >> (10 * c)) & 0x3FF, expected, 1.0);
+    }
+
+    SKIV_CHECK ((packed >> 30) == 3);
+  });
+}
+
+SKIV_TEST (CropRotate_RejectsInvalidRequests)
+{
+  DirectX::ScratchImage source;
+  SKIV_Test_MakeCropSource8 (DXGI_FORMAT_R8G8B8A8_UNORM, source);
+
+  const DirectX::Image& src = *source.GetImage (0, 0, 0);
+
+  DirectX::ScratchImage result;
+
+  // Entirely outside of the image, or empty
+  SKIV_CHECK (SKIV_Image_CropRotate (src, { SKIV_TEST_CROP_WIDTH, 0, 4, 4 }, DXGI_MODE_ROTATION_IDENTITY, src.format, result) == E_INVALIDARG);
+  SKIV_CHECK (SKIV_Image_CropRotate (src, { 0, SKIV_TEST_CROP_HEIGHT, 4, 4 }, DXGI_MODE_ROTATION_IDENTITY, src.format, result) == E_INVALIDARG);
+  SKIV_CHECK (SKIV_Image_CropRotate (src, { 3, 3, 0, 4 },                     DXGI_MODE_ROTATION_IDENTITY, src.format, result) == E_INVALIDARG);
+
+  // 8-bit images cannot become HDR10
+  SKIV_CHECK (FAILED (SKIV_Image_CropRotate (src, { 0, 0, 4, 4 }, DXGI_MODE_ROTATION_IDENTITY, DXGI_FORMAT_R10G10B10A2_UNORM, result)));
+}
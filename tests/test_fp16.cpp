@@ -0,0 +1,198 @@
+#include "test.h"
+#include <utility/image.h>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <random>
+
+// Every half-float conversion path the CPU supports against the scalar one,
+//   bit for bit, on the same rows. The rows are long enough for AVX-512's
+//     32-wide blocks, F16C's 16 and 8-wide ones and a scalar tail.
+
+static float
+SKIV_Test_FloatFromBits (uint32_t bits)
+{
+  float  value;
+  memcpy (&value, &bits, sizeof (float));
+  return value;
+}
+
+static uint32_t
+SKIV_Test_BitsFromFloat (float value)
+{
+  uint32_t bits;
+  memcpy (&bits, &value, sizeof (float));
+  return bits;
+}
+
+// Every half as a float, the ties halfway between neighbouring halves and
+//   the floats either side of those, float denormals, Inf, NaN and random bits
+static std::vector <float>
+SKIV_Test_MakePackInputs (void)
+{
+  std::vector <float> inputs;
+
+  for (uint16_t half = 0; half < 0x7C00; ++half)
+  {
+    for (uint32_t sign : { 0x00000000u, 0x80000000u })
+    {
+      float value;
+      SKIV_Image_UnpackFP16toFP32 (&half, &value, 1);
+
+      const uint32_t bits = SKIV_Test_BitsFromFloat (value) | sign;
+      inputs.push_back (SKIV_Test_FloatFromBits (bits));
+
+      // Denormal halves are 2^-24 apart; normal ones have 13 fewer mantissa
+      //   bits than a float, so the tie is 2^12 float ulps up
+      const uint32_t tie = (half < 0x400) ?
+        SKIV_Test_BitsFromFloat ((static_cast <float> (half) + 0.5f) * SKIV_Test_FloatFromBits (0x33800000u)) | sign :
+        bits + 0x1000u;
+
+      inputs.push_back (SKIV_Test_FloatFromBits (tie - 1));
+      inputs.push_back (SKIV_Test_FloatFromBits (tie));
+      inputs.push_back (SKIV_Test_FloatFromBits (tie + 1));
+    }
+  }
+
+  const uint32_t specials [] = {
+    0x00000000u, 0x80000000u, // +-0
+    0x00000001u, 0x807FFFFFu, // Float denormals
+    0x00400000u, 0x80000010u,
+    0x33000000u, 0x33000001u, // Half the smallest half denormal, and just above
+    0x387FFFFFu, 0x38800000u, // Either side of the smallest normal half
+    0x477FE000u, 0x477FEFFFu, // 65504 and just below the overflow tie
+    0x477FF000u, 0xC77FF000u, // 65520 rounds to Inf
+    0x7F7FFFFFu, 0xFF7FFFFFu, // FLT_MAX
+    0x7F800000u, 0xFF800000u, // +-Inf
+    0x7FC00000u, 0xFFC00000u, // Quiet NaN
+    0x7F800001u, 0xFF800001u, // Signaling NaN, payload below the half's mantissa
+    0x7FBFE000u, 0x7FFFFFFFu  // Payloads that survive the truncation
+  };
+
+  for (uint32_t bits : specials)
+    inputs.push_back (SKIV_Test_FloatFromBits (bits));
+
+  std::mt19937 rng (0x27);
+
+  for (int i = 0; i < 65536; ++i)
+    inputs.push_back (SKIV_Test_FloatFromBits (rng ()));
+
+  // Leave a tail shorter than any vector
+  while (inputs.size () % 32 != 29)
+    inputs.push_back (0.0f);
+
+  return inputs;
+}
+
+SKIV_TEST (FP16_EveryKernelMatchesScalar)
+{
+  const SKIV_FP16Kernel best =
+    SKIV_Image_GetFP16Kernel ();
+
+  SKIV_CHECK (SKIV_Image_SetFP16Kernel (SKIV_FP16Kernel_Scalar));
+
+  const std::vector <float> floats =
+    SKIV_Test_MakePackInputs ();
+
+  std::vector <uint16_t> halves (65536 + 29);
+
+  for (size_t i = 0; i < halves.size (); ++i)
+    halves [i] = static_cast <uint16_t> (i); // Every half, including denormals, Inf and NaN
+
+  std::vector <uint16_t> packed_scalar   (floats.size ()), packed   (floats.size ());
+  std::vector <float>    unpacked_scalar (halves.size ()), unpacked (halves.size ());
+
+  SKIV_Image_PackFP32toFP16   (floats.data (), packed_scalar.data   (), floats.size ());
+  SKIV_Image_UnpackFP16toFP32 (halves.data (), unpacked_scalar.data (), halves.size ());
+
+  for (SKIV_FP16Kernel kernel : { SKIV_FP16Kernel_F16C, SKIV_FP16Kernel_AVX512 })
+  {
+    if (! SKIV_Image_SetFP16Kernel (kernel))
+    {
+      printf ("FP16 kernel %d is not supported by this CPU, skipped\n", kernel);
+      continue;
+    }
+
+    SKIV_CHECK (SKIV_Image_GetFP16Kernel () == kernel);
+
+    // Starting one element in as well, so that the blocks straddle other values
+    for (size_t offset : { 0, 1 })
+    {
+      std::fill (packed  .begin (), packed  .end (), uint16_t (0xDEAD));
+      std::fill (unpacked.begin (), unpacked.end (), 0.0f);
+
+      SKIV_Image_PackFP32toFP16   (floats.data () + offset, packed  .data () + offset, floats.size () - offset);
+      SKIV_Image_UnpackFP16toFP32 (halves.data () + offset, unpacked.data () + offset, halves.size () - offset);
+
+      size_t pack_mismatches   = 0,
+             unpack_mismatches = 0;
+
+      for (size_t i = offset; i < floats.size (); ++i)
+        pack_mismatches += (packed [i] != packed_scalar [i]);
+
+      for (size_t i = offset; i < halves.size (); ++i)
+        unpack_mismatches += (SKIV_Test_BitsFromFloat (unpacked [i]) != SKIV_Test_BitsFromFloat (unpacked_scalar [i]));
+
+      SKIV_CHECK (pack_mismatches   == 0);
+      SKIV_CHECK (unpack_mismatches == 0);
+    }
+  }
+
+  SKIV_CHECK (SKIV_Image_SetFP16Kernel (best));
+}
+
+SKIV_TEST (FP16_ScalarKnownValues)
+{
+  const SKIV_FP16Kernel best =
+    SKIV_Image_GetFP16Kernel ();
+
+  SKIV_CHECK (SKIV_Image_SetFP16Kernel (SKIV_FP16Kernel_Scalar));
+
+  static const struct {
+    uint32_t input;
+    uint16_t half;
+  } cases [] = {
+    { 0x3F800000u, 0x3C00 }, // 1
+    { 0xC0000000u, 0xC000 }, // -2
+    { 0x477FE000u, 0x7BFF }, // 65504
+    { 0x477FF000u, 0x7C00 }, // 65520, ties to even, which is Inf
+    { 0x33800000u, 0x0001 }, // 2^-24, the smallest denormal
+    { 0x33000000u, 0x0000 }, // 2^-25, ties to even (0)
+    { 0x33C00000u, 0x0002 }, // 1.5 * 2^-24, ties to even (2)
+    { 0x38800000u, 0x0400 }, // 2^-14, the smallest normal
+    { 0x387FC000u, 0x03FF }, // The largest denormal
+    { 0x00000001u, 0x0000 }, // Float denormals flush to 0
+    { 0x80000001u, 0x8000 },
+    { 0x7F800000u, 0x7C00 }, // Inf
+    { 0xFF800000u, 0xFC00 },
+    { 0x7F800001u, 0x7E00 }, // NaN stays NaN, quieted
+    { 0xFFC02000u, 0xFE01 }
+  };
+
+  for (const auto& [input, expected] : cases)
+  {
+    const float value = SKIV_Test_FloatFromBits (input);
+    uint16_t    half  = 0;
+
+    SKIV_Image_PackFP32toFP16 (&value, &half, 1);
+
+    if (half != expected)
+      printf ("0x%08X packed to 0x%04X, expected 0x%04X\n", input, half, expected);
+
+    SKIV_CHECK (half == expected);
+  }
+
+  // Half denormals come back exact, Inf and NaN keep their sign and payload
+  const uint16_t halves   [] = { 0x0001,      0x83FF,      0x7C00,      0xFC00,      0x7C01,      0xFE00      };
+  const uint32_t expected [] = { 0x33800000u, 0xB87FC000u, 0x7F800000u, 0xFF800000u, 0x7FC02000u, 0xFFC00000u };
+
+  for (size_t i = 0; i < std::size (halves); ++i)
+  {
+    float value = 0.0f;
+    SKIV_Image_UnpackFP16toFP32 (&halves [i], &value, 1);
+
+    SKIV_CHECK (SKIV_Test_BitsFromFloat (value) == expected [i]);
+  }
+
+  SKIV_CHECK (SKIV_Image_SetFP16Kernel (best));
+}
@@ -0,0 +1,217 @@
+#include "test.h"
+#include <utility/icc.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+// Minimal ICC profiles (v2 header, big-endian tags)
+struct skiv_test_icc_s {
+  std::vector <uint8_t> data;
+
+  void u16 (uint32_t v) { data.push_back (static_cast <uint8_t> (v >> 8)); data.push_back (static_cast <uint8_t> (v)); }
+  void u32 (uint32_t v) { u16 (v >> 16); u16 (v & 0xFFFF); }
+  void sig (const char* s) { data.insert (data.end (), s, s + 4); }
+  void s15 (double v) { u32 (static_cast <uint32_t> (static_cast <int32_t> (std::lround (v * 65536.0)))); }
+
+  static std::vector <uint8_t>
+  build (const char* color_space, const std::vector <std::pair <const char*, skiv_test_icc_s>>& tags)
+  {
+    skiv_test_icc_s header,
+                    body;
+
+    header.data.resize (128);
+
+    memcpy (&header.data [16], color_space, 4);
+    memcpy (&header.data [20], "XYZ ",      4);
+    memcpy (&header.data [36], "acsp",      4);
+
+    header.u32 (static_cast <uint32_t> (tags.size ()));
+
+    for (const auto& [tag_sig, tag] : tags)
+    {
+      header.sig (tag_sig);
+      header.u32 (static_cast <uint32_t> (132 + tags.size () * 12 + body.data.size ()));
+      header.u32 (static_cast <uint32_t> (tag.data.size ()));
+
+      body.data.insert (body.data.end (), tag.data.begin (), tag.data.end ());
+      body.data.resize ((body.data.size () + 3) & ~size_t (3));
+    }
+
+    header.data.insert (header.data.end (), body.data.begin (), body.data.end ());
+
+    const uint32_t size =
+      static_cast <uint32_t> (header.data.size ());
+
+    for (int i = 0; i < 4; ++i)
+      header.data [i] = static_cast <uint8_t> (size >> (24 - i * 8));
+
+    return header.data;
+  }
+};
+
+// Colorants (D50) of Display P3 and sRGB, as columns
+static constexpr double skiv_test_p3   [3][3] = { { 0.5151, 0.2920, 0.1571 }, { 0.2412, 0.6922, 0.0666 }, { -0.0011, 0.0419, 0.7841 } };
+static constexpr double skiv_test_srgb [3][3] = { { 0.4361, 0.3851, 0.1431 }, { 0.2225, 0.7169, 0.0606 }, {  0.0139, 0.0971, 0.7141 } };
+
+// Linear P3 to linear sRGB
+static constexpr float skiv_test_p3_to_srgb [3][3] = { { 1.2249f, -0.2247f, 0.0f }, { -0.0420f, 1.0419f, 0.0f }, { -0.0197f, -0.0786f, 1.0979f } };
+
+static skiv_test_icc_s
+SKIV_Test_sRGBCurve (void)
+{
+  skiv_test_icc_s curve;
+
+  curve.sig ("para"); curve.u32 (0);
+  curve.u16 (3);      curve.u16 (0);
+  curve.s15 (2.4);    curve.s15 (1.0 / 1.055); curve.s15 (0.055 / 1.055); curve.s15 (1.0 / 12.92); curve.s15 (0.04045);
+
+  return curve;
+}
+
+static std::vector <uint8_t>
+SKIV_Test_MatrixProfile (const double (&colorants) [3][3])
+{
+  auto _XYZ = [&](int c)
+  {
+    skiv_test_icc_s xyz;
+
+    xyz.sig ("XYZ "); xyz.u32 (0);
+    xyz.s15 (colorants [0][c]); xyz.s15 (colorants [1][c]); xyz.s15 (colorants [2][c]);
+
+    return xyz;
+  };
+
+  return skiv_test_icc_s::build ("RGB ", {
+    { "rXYZ", _XYZ (0) },                { "gXYZ", _XYZ (1) },                { "bXYZ", _XYZ (2) },
+    { "rTRC", SKIV_Test_sRGBCurve () },  { "gTRC", SKIV_Test_sRGBCurve () },  { "bTRC", SKIV_Test_sRGBCurve () }
+  });
+}
+
+// Display P3, tabulated in a 17^3 CLUT of 16-bit PCS XYZ
+static std::vector <uint8_t>
+SKIV_Test_LUTProfile (void)
+{
+  skiv_test_icc_s lut16;
+
+  lut16.sig ("mft2"); lut16.u32 (0);
+  lut16.data.insert (lut16.data.end (), { 3, 3, 17, 0 });
+
+  for (int i = 0; i < 9; ++i)
+    lut16.s15 ((i % 4 == 0) ? 1.0 : 0.0);
+
+  lut16.u16 (2); lut16.u16 (2);
+
+  for (int c = 0; c < 3; ++c) { lut16.u16 (0); lut16.u16 (65535); }
+
+  for (int r = 0; r < 17; ++r)
+  for (int g = 0; g < 17; ++g)
+  for (int b = 0; b < 17; ++b)
+  {
+    const int    node [3] = { r, g, b };
+          double linear [3];
+
+    for (int c = 0; c < 3; ++c)
+    {
+      const double x = node [c] / 16.0;
+
+      linear [c] = (x <= 0.04045) ? x / 12.92 : std::pow ((x + 0.055) / 1.055, 2.4);
+    }
+
+    for (int o = 0; o < 3; ++o)
+      lut16.u16 (static_cast <uint32_t> (std::clamp (std::lround ((skiv_test_p3 [o][0] * linear [0] + skiv_test_p3 [o][1] * linear [1] + skiv_test_p3 [o][2] * linear [2]) * 32768.0), 0L, 65535L)));
+  }
+
+  for (int c = 0; c < 3; ++c) { lut16.u16 (0); lut16.u16 (65535); }
+
+  return skiv_test_icc_s::build ("RGB ", { { "A2B0", lut16 } });
+}
+
+// Primaries against the reference P3 to sRGB matrix, and mid gray, which is
+//   0.2140 linear whatever the primaries
+static void
+SKIV_Test_CheckP3Transform (const std::vector <uint8_t>& profile, float tolerance)
+{
+  auto transform =
+    SKIV_ICC_GetTransform (profile.data (), profile.size ());
+
+  SKIV_CHECK (transform != nullptr);
+
+  if (transform == nullptr)
+    return;
+
+  for (int c = 0; c < 3; ++c)
+  {
+    float primary [4] = { 0.0f, 0.0f, 0.0f, 1.0f },
+          result  [4];
+
+    primary [c] = 1.0f;
+
+    SKIV_ICC_Transform (*transform, primary, result, 1);
+
+    for (int o = 0; o < 3; ++o)
+      SKIV_CHECK_NEAR (result [o], skiv_test_p3_to_srgb [o][c], tolerance);
+
+    SKIV_CHECK (result [3] == 1.0f);
+  }
+
+  const float gray [4] = { 0.5f, 0.5f, 0.5f, 0.25f };
+        float result [4];
+
+  SKIV_ICC_Transform (*transform, gray, result, 1);
+
+  for (int o = 0; o < 3; ++o)
+    SKIV_CHECK_NEAR (result [o], 0.2140f, tolerance);
+
+  SKIV_CHECK (result [3] == 0.25f);
+
+  // 8-bit noise as the viewer transforms it; saturated P3 cannot fit in Rec. 709
+  constexpr size_t width  = 61,
+                   height = 37;
+
+  std::vector <uint8_t> pixels (width * height * 4);
+  std::mt19937          rng    (0x1CC);
+
+  for (auto& channel : pixels)
+    channel = static_cast <uint8_t> (rng ());
+
+  DirectX::ScratchImage image;
+  bool                  wcg = false,
+                        hdr = false;
+
+  SKIV_CHECK (SUCCEEDED (SKIV_ICC_TransformImage (*transform, pixels.data (), width, height, false, image, wcg, hdr)));
+  SKIV_CHECK (image.GetMetadata ().format == DXGI_FORMAT_R16G16B16A16_FLOAT);
+  SKIV_CHECK (image.GetMetadata ().width  == width && image.GetMetadata ().height == height);
+  SKIV_CHECK (wcg);
+}
+
+SKIV_TEST (ICC_MatrixProfile)
+{
+  SKIV_Test_CheckP3Transform (SKIV_Test_MatrixProfile (skiv_test_p3), 0.005f);
+}
+
+SKIV_TEST (ICC_LUTProfile)
+{
+  SKIV_Test_CheckP3Transform (SKIV_Test_LUTProfile (), 0.01f);
+}
+
+SKIV_TEST (ICC_sRGBCompilesToNothing)
+{
+  const auto profile =
+    SKIV_Test_MatrixProfile (skiv_test_srgb);
+
+  SKIV_CHECK (SKIV_ICC_GetTransform (profile.data (), profile.size ()) == nullptr);
+}
+
+SKIV_TEST (ICC_RejectsMalformedProfiles)
+{
+  auto profile =
+    SKIV_Test_MatrixProfile (skiv_test_p3);
+
+  // Truncated in the middle of the tag data
+  SKIV_CHECK (SKIV_ICC_GetTransform (profile.data (), profile.size () / 2) == nullptr);
+
+  // Not a profile
+  profile [36] = 'x';
+  SKIV_CHECK (SKIV_ICC_GetTransform (profile.data (), profile.size ()) == nullptr);
+}
@@ -0,0 +1,234 @@
+#include "test.h"
+#include <utility/image_cache.h>
+#include <DirectXPackedVector.h>
+#include <cstring>
+#include <random>
+#include <string>
+
+using DirectX::PackedVector::XMConvertFloatToHalf;
+
+// Image cache entries, written and read back directly rather than through the
+//   registry's cache folder
+
+static std::wstring
+SKIV_Test_GetTempFile (const wchar_t* name)
+{
+  wchar_t wszTemp [MAX_PATH + 1] = { };
+  GetTempPathW (MAX_PATH, wszTemp);
+
+  return
+    std::wstring (wszTemp) + name;
+}
+
+static bool
+SKIV_Test_WriteFile (const std::wstring& path, const std::string& contents)
+{
+  HANDLE hFile =
+    CreateFileW (path.c_str (), GENERIC_WRITE, 0x0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+  if (hFile == INVALID_HANDLE_VALUE)
+    return false;
+
+  DWORD dwWritten = 0;
+  bool  written   =
+    WriteFile (hFile, contents.data (), static_cast <DWORD> (contents.size ()), &dwWritten, nullptr);
+
+  CloseHandle (hFile);
+
+  return written;
+}
+
+static uint64_t
+SKIV_Test_GetWriteTime (const std::wstring& path)
+{
+  WIN32_FILE_ATTRIBUTE_DATA
+                        attrs = { };
+  GetFileAttributesExW (path.c_str (), GetFileExInfoStandard, &attrs);
+
+  return
+    (static_cast <uint64_t> (attrs.ftLastWriteTime.dwHighDateTime) << 32) | attrs.ftLastWriteTime.dwLowDateTime;
+}
+
+static void
+SKIV_Test_SetWriteTime (const std::wstring& path, uint64_t time)
+{
+  HANDLE hFile =
+    CreateFileW (path.c_str (), FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                 OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+  if (hFile == INVALID_HANDLE_VALUE)
+    return;
+
+  FILETIME ft = { static_cast <DWORD> (time), static_cast <DWORD> (time >> 32) };
+  SetFileTime (hFile, nullptr, nullptr, &ft);
+  CloseHandle (hFile);
+}
+
+// Just over 4 MiB of FP16, so the entry has a second chunk; the first rows are
+//   a smooth ramp that compresses, the rest noise that is stored as-is
+static void
+SKIV_Test_MakeCacheImage (DirectX::ScratchImage& image)
+{
+  image.Initialize2D (DXGI_FORMAT_R16G16B16A16_FLOAT, 1030, 520, 1, 1);
+
+  std::mt19937 rng (0x46);
+
+  const DirectX::Image* pImage =
+    image.GetImage (0, 0, 0);
+
+  for (size_t y = 0; y < pImage->height; ++y)
+  {
+    uint16_t* row =
+      reinterpret_cast <uint16_t *> (pImage->pixels + y * pImage->rowPitch);
+
+    for (size_t i = 0; i < pImage->width * 4; ++i)
+    {
+      row [i] = (y < pImage->height / 2) ?
+        XMConvertFloatToHalf (static_cast <float> (i / 4) / 64.0f) : static_cast <uint16_t> (rng ());
+    }
+  }
+}
+
+static skiv_image_cache_info_s
+SKIV_Test_MakeCacheInfo (void)
+{
+  skiv_image_cache_info_s info;
+
+  info.bpc          = 16;
+  info.channels     = 4;
+  info.is_hdr       = true;
+  info.is_dds       = true;
+  info.light_is_hdr = true;
+  info.max_cll      = 1234.5f;
+  info.max_cll_name = 'G';
+  info.max_nits     = 4000.25f;
+  info.min_nits     = 0.0625f;
+  info.avg_nits     = 180.5f;
+  info.p99_nits     = 950.75f;
+  info.pixel_counts = { .rec_709 = 1, .rec_2020 = 2, .dci_p3 = 3, .ap1 = 4, .ap0 = 5, .undefined = 6, .total = 21 };
+
+  return info;
+}
+
+static bool
+SKIV_Test_SameImage (const DirectX::ScratchImage& a, const DirectX::ScratchImage& b)
+{
+  const DirectX::Image* pA = a.GetImage (0, 0, 0);
+  const DirectX::Image* pB = b.GetImage (0, 0, 0);
+
+  return
+    pA != nullptr && pB != nullptr &&
+    pA->format     == pB->format     &&
+    pA->width      == pB->width      &&
+    pA->height     == pB->height     &&
+    pA->slicePitch == pB->slicePitch &&
+    memcmp (pA->pixels, pB->pixels, pA->slicePitch) == 0;
+}
+
+SKIV_TEST (ImageCache_RoundTripsEveryField)
+{
+  const std::wstring source = SKIV_Test_GetTempFile (L"SKIV.Tests.cache_source.bin"),
+                     entry  = SKIV_Test_GetTempFile (L"SKIV.Tests.cache_entry.skivcache");
+
+  SKIV_CHECK (SKIV_Test_WriteFile (source, std::string (1000, 's')));
+
+  DirectX::ScratchImage image;
+  SKIV_Test_MakeCacheImage (image);
+
+  const skiv_image_cache_info_s stored =
+    SKIV_Test_MakeCacheInfo ();
+
+  SKIV_CHECK (SKIV_ImageCache_WriteEntry (entry, source, *image.GetImage (0, 0, 0), stored));
+
+  DirectX::ScratchImage   loaded;
+  skiv_image_cache_info_s info;
+
+  SKIV_CHECK (SKIV_ImageCache_ReadEntry (entry, source, loaded, info));
+  SKIV_CHECK (SKIV_Test_SameImage (image, loaded));
+
+  SKIV_CHECK (info.bpc                    == stored.bpc);
+  SKIV_CHECK (info.channels               == stored.channels);
+  SKIV_CHECK (info.is_hdr                 == stored.is_hdr);
+  SKIV_CHECK (info.is_dds                 == stored.is_dds);
+  SKIV_CHECK (info.light_is_hdr           == stored.light_is_hdr);
+  SKIV_CHECK (info.max_cll                == stored.max_cll);
+  SKIV_CHECK (info.max_cll_name           == stored.max_cll_name);
+  SKIV_CHECK (info.max_nits               == stored.max_nits);
+  SKIV_CHECK (info.min_nits               == stored.min_nits);
+  SKIV_CHECK (info.avg_nits               == stored.avg_nits);
+  SKIV_CHECK (info.p99_nits               == stored.p99_nits);
+  SKIV_CHECK (info.pixel_counts.rec_709   == stored.pixel_counts.rec_709);
+  SKIV_CHECK (info.pixel_counts.rec_2020  == stored.pixel_counts.rec_2020);
+  SKIV_CHECK (info.pixel_counts.dci_p3    == stored.pixel_counts.dci_p3);
+  SKIV_CHECK (info.pixel_counts.ap1       == stored.pixel_counts.ap1);
+  SKIV_CHECK (info.pixel_counts.ap0       == stored.pixel_counts.ap0);
+  SKIV_CHECK (info.pixel_counts.undefined == stored.pixel_counts.undefined);
+  SKIV_CHECK (info.pixel_counts.total     == stored.pixel_counts.total);
+
+  // An entry with no file behind it
+  DeleteFileW (source.c_str ());
+  SKIV_CHECK (! SKIV_ImageCache_ReadEntry (entry, source, loaded, info));
+
+  DeleteFileW (entry.c_str ());
+}
+
+SKIV_TEST (ImageCache_ChecksTheSourceFile)
+{
+  const std::wstring source = SKIV_Test_GetTempFile (L"SKIV.Tests.cache_source.bin"),
+                     entry  = SKIV_Test_GetTempFile (L"SKIV.Tests.cache_entry.skivcache");
+
+  SKIV_CHECK (SKIV_Test_WriteFile (source, std::string (1000, 's')));
+
+  DirectX::ScratchImage image;
+  SKIV_Test_MakeCacheImage (image);
+
+  SKIV_CHECK (SKIV_ImageCache_WriteEntry (entry, source, *image.GetImage (0, 0, 0), SKIV_Test_MakeCacheInfo ()));
+
+  const uint64_t written =
+    SKIV_Test_GetWriteTime (source);
+
+  DirectX::ScratchImage   loaded;
+  skiv_image_cache_info_s info;
+
+  // Touched, but the same bytes: served after hashing
+  SKIV_Test_SetWriteTime (source, written - 10000000ULL);
+  SKIV_CHECK (SKIV_ImageCache_ReadEntry (entry, source, loaded, info) && SKIV_Test_SameImage (image, loaded));
+
+  // Same size, other bytes
+  SKIV_CHECK (SKIV_Test_WriteFile (source, std::string (1000, 't')));
+  SKIV_Test_SetWriteTime (source, written - 20000000ULL);
+  SKIV_CHECK (! SKIV_ImageCache_ReadEntry (entry, source, loaded, info));
+
+  // Size and last write time alone decide while they match, the file is not hashed
+  SKIV_Test_SetWriteTime (source, written);
+  SKIV_CHECK (SKIV_ImageCache_ReadEntry (entry, source, loaded, info));
+
+  // Another size
+  SKIV_CHECK (SKIV_Test_WriteFile (source, std::string (1001, 's')));
+  SKIV_Test_SetWriteTime (source, written);
+  SKIV_CHECK (! SKIV_ImageCache_ReadEntry (entry, source, loaded, info));
+
+  // An entry of an older version, or none at all
+  SKIV_CHECK (SKIV_Test_WriteFile (source, std::string (1000, 's')));
+  SKIV_Test_SetWriteTime (source, written);
+
+  HANDLE hEntry =
+    CreateFileW (entry.c_str (), GENERIC_READ | GENERIC_WRITE, 0x0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+  if (hEntry != INVALID_HANDLE_VALUE)
+  {
+    const uint32_t version = 1;
+    DWORD          dwWritten = 0;
+
+    SetFilePointer (hEntry, sizeof (uint32_t), nullptr, FILE_BEGIN);
+    WriteFile      (hEntry, &version, sizeof (version), &dwWritten, nullptr);
+    CloseHandle    (hEntry);
+  }
+
+  SKIV_CHECK (! SKIV_ImageCache_ReadEntry (entry, source, loaded, info));
+
+  DeleteFileW (entry.c_str ());
+  SKIV_CHECK (! SKIV_ImageCache_ReadEntry (entry, source, loaded, info));
+
+  DeleteFileW (source.c_str ());
+}
@@ -0,0 +1,255 @@
+#include "test.h"
+#include <utility/image.h>
+#include <objbase.h>
+#include <stb_image.h>
+#include <algorithm>
+#include <cstring>
+
+// SKIV_Image_LoadJPEG () against stbi, the decoder it replaces, on files
+//   encoded by WIC (4:2:0, no restart markers).
+
+// Gradients with a checkerboard, so that both smooth areas and edges show up
+static void
+SKIV_Test_MakeSDR (size_t width, size_t height, DirectX::ScratchImage& image)
+{
+  image.Initialize2D (DXGI_FORMAT_R8G8B8A8_UNORM, width, height, 1, 1);
+
+  for (size_t y = 0; y < height; ++y)
+  {
+    uint8_t* row =
+      image.GetPixels () + y * image.GetImage (0, 0, 0)->rowPitch;
+
+    for (size_t x = 0; x < width; ++x)
+    {
+      const int check = (((x / 7) + (y / 5)) % 2) ? 24 : -24;
+
+      row [x * 4 + 0] = static_cast <uint8_t> (std::clamp (static_cast <int> (x * 255 / width)  + check, 0, 255));
+      row [x * 4 + 1] = static_cast <uint8_t> (std::clamp (static_cast <int> (y * 255 / height) - check, 0, 255));
+      row [x * 4 + 2] = static_cast <uint8_t> (128 + (x * y) % 64);
+      row [x * 4 + 3] = 255;
+    }
+  }
+}
+
+static bool
+SKIV_Test_EncodeJPEG (const DirectX::ScratchImage& image, std::vector <uint8_t>& file)
+{
+  // WIC needs COM on this thread
+  CoInitializeEx (nullptr, COINIT_MULTITHREADED);
+
+  DirectX::Blob blob;
+
+  if (FAILED (DirectX::SaveToWICMemory (*image.GetImage (0, 0, 0), DirectX::WIC_FLAGS_NONE, DirectX::GetWICCodec (DirectX::WIC_CODEC_JPEG), blob)))
+    return false;
+
+  const uint8_t* data =
+    static_cast <const uint8_t *> (blob.GetBufferPointer ());
+
+  file.assign (data, data + blob.GetBufferSize ());
+
+  return true;
+}
+
+// PSNR of b against a, both RGBA8 of the same size; alpha is ignored
+static double
+SKIV_Test_GetPSNR (const uint8_t* a, const uint8_t* b, size_t pixels)
+{
+  double squared_error = 0.0;
+
+  for (size_t i = 0; i < pixels * 4; ++i)
+  {
+    if (i % 4 == 3)
+      continue;
+
+    const double difference = static_cast <double> (a [i]) - b [i];
+    squared_error += difference * difference;
+  }
+
+  const double mse =
+    squared_error / static_cast <double> (pixels * 3);
+
+  return
+    (mse == 0.0) ? 99.0 : 10.0 * std::log10 (255.0 * 255.0 / mse);
+}
+
+SKIV_TEST (JPEG_MatchesSTBI)
+{
+  // Partial MCUs on both axes, and a single block
+  for (const auto& [width, height] : { std::pair { 96, 64 }, std::pair { 77, 53 }, std::pair { 8, 8 }, std::pair { 3, 2 } })
+  {
+    DirectX::ScratchImage original;
+    SKIV_Test_MakeSDR (width, height, original);
+
+    std::vector <uint8_t> file;
+    SKIV_CHECK (SKIV_Test_EncodeJPEG (original, file));
+
+    size_t info_width    = 0,
+           info_height   = 0;
+    int    info_channels = 0;
+
+    SKIV_CHECK (SKIV_Image_GetJPEGInfo (file.data (), file.size (), info_width, info_height, info_channels));
+    SKIV_CHECK (info_width == size_t (width) && info_height == size_t (height) && info_channels == 3);
+
+    int stbi_width = 0, stbi_height = 0, stbi_channels = 0;
+
+    stbi_uc* stbi_pixels =
+      stbi_load_from_memory (file.data (), static_cast <int> (file.size ()), &stbi_width, &stbi_height, &stbi_channels, 4);
+
+    SKIV_CHECK (stbi_pixels != nullptr);
+
+    DirectX::ScratchImage rgba,
+                          bgra;
+
+    SKIV_CHECK (SUCCEEDED (SKIV_Image_LoadJPEG (file.data (), file.size (), 1, DXGI_FORMAT_R8G8B8A8_UNORM, rgba)));
+    SKIV_CHECK (SUCCEEDED (SKIV_Image_LoadJPEG (file.data (), file.size (), 1, DXGI_FORMAT_B8G8R8A8_UNORM, bgra)));
+
+    const bool decoded =
+      stbi_pixels       != nullptr && rgba.GetPixels () != nullptr && bgra.GetPixels () != nullptr &&
+      rgba.GetMetadata ().width  == size_t (width) && rgba.GetMetadata ().height == size_t (height) &&
+      rgba.GetImage (0, 0, 0)->rowPitch == size_t (width) * 4;
+
+    SKIV_CHECK (decoded);
+
+    if (decoded)
+    {
+      const uint8_t* ours = rgba.GetPixels ();
+
+      // Both decode the same file, so ours has to be as faithful as stbi's
+      const double psnr_ours = SKIV_Test_GetPSNR (original.GetPixels (), ours,        size_t (width) * height);
+      const double psnr_stbi = SKIV_Test_GetPSNR (original.GetPixels (), stbi_pixels, size_t (width) * height);
+
+      SKIV_CHECK (psnr_ours >= psnr_stbi - 0.5);
+      SKIV_CHECK (SKIV_Test_GetPSNR (stbi_pixels, ours, size_t (width) * height) > 40.0);
+
+      // Same pixels with red and blue swapped, and opaque
+      const uint8_t* swapped = bgra.GetPixels ();
+
+      bool same = true;
+
+      for (size_t i = 0; i < size_t (width) * height * 4; i += 4)
+      {
+        same &= swapped [i + 0] == ours [i + 2] && swapped [i + 1] == ours [i + 1] &&
+                swapped [i + 2] == ours [i + 0] && swapped [i + 3] == 255 && ours [i + 3] == 255;
+      }
+
+      SKIV_CHECK (same);
+    }
+
+    stbi_image_free (stbi_pixels);
+  }
+}
+
+SKIV_TEST (JPEG_ScaledDecode)
+{
+  constexpr size_t width  = 203,
+                   height = 117;
+
+  DirectX::ScratchImage original;
+  SKIV_Test_MakeSDR (width, height, original);
+
+  std::vector <uint8_t> file;
+  SKIV_CHECK (SKIV_Test_EncodeJPEG (original, file));
+
+  DirectX::ScratchImage full;
+  SKIV_CHECK (SUCCEEDED (SKIV_Image_LoadJPEG (file.data (), file.size (), 1, DXGI_FORMAT_R8G8B8A8_UNORM, full)));
+
+  if (full.GetPixels () == nullptr)
+    return;
+
+  for (int scale : { 2, 4, 8 })
+  {
+    DirectX::ScratchImage scaled;
+    SKIV_CHECK (SUCCEEDED (SKIV_Image_LoadJPEG (file.data (), file.size (), scale, DXGI_FORMAT_R8G8B8A8_UNORM, scaled)));
+
+    // Rounded up, like libjpeg
+    const size_t scaled_width  = (width  + scale - 1) / scale,
+                 scaled_height = (height + scale - 1) / scale;
+
+    SKIV_CHECK (scaled.GetMetadata ().width == scaled_width && scaled.GetMetadata ().height == scaled_height);
+
+    if (scaled.GetMetadata ().width != scaled_width || scaled.GetMetadata ().height != scaled_height)
+      continue;
+
+    // Close to a box filter of the full decode, away from the partial edge blocks
+    std::vector <uint8_t> box    ((scaled_width - 1) * (scaled_height - 1) * 4),
+                          output ((scaled_width - 1) * (scaled_height - 1) * 4);
+
+    for (size_t y = 0; y < scaled_height - 1; ++y)
+    {
+      for (size_t x = 0; x < scaled_width - 1; ++x)
+      {
+        for (size_t c = 0; c < 4; ++c)
+        {
+          int sum = 0;
+
+          for (int yy = 0; yy < scale; ++yy)
+          for (int xx = 0; xx < scale; ++xx)
+            sum += full.GetPixels () [((y * scale + yy) * width + x * scale + xx) * 4 + c];
+
+          box    [(y * (scaled_width - 1) + x) * 4 + c] = static_cast <uint8_t> ((sum + scale * scale / 2) / (scale * scale));
+          output [(y * (scaled_width - 1) + x) * 4 + c] = scaled.GetPixels () [(y * scaled_width + x) * 4 + c];
+        }
+      }
+    }
+
+    SKIV_CHECK (SKIV_Test_GetPSNR (box.data (), output.data (), box.size () / 4) > 28.0);
+  }
+
+  SKIV_CHECK (SKIV_Image_LoadJPEG (file.data (), file.size (), 3, DXGI_FORMAT_R8G8B8A8_UNORM, full) == E_INVALIDARG);
+}
+
+SKIV_TEST (JPEG_Scale)
+{
+  // The largest DCT scale that still covers the requested size
+  SKIV_CHECK (SKIV_Image_GetJPEGScale (4000, 3000, 4000, 3000) == 1);
+  SKIV_CHECK (SKIV_Image_GetJPEGScale (4000, 3000, 2000, 1500) == 2);
+  SKIV_CHECK (SKIV_Image_GetJPEGScale (4000, 3000, 2001, 1500) == 1);
+  SKIV_CHECK (SKIV_Image_GetJPEGScale (4000, 3000, 1000,  750) == 4);
+  SKIV_CHECK (SKIV_Image_GetJPEGScale (4000, 3000,  100,  100) == 8);
+
+  // Rounded up, so 1001 / 8 still covers 126
+  SKIV_CHECK (SKIV_Image_GetJPEGScale (1001, 1001,  126,  126) == 8);
+  SKIV_CHECK (SKIV_Image_GetJPEGScale (1001, 1001,  127,  126) == 4);
+}
+
+SKIV_TEST (JPEG_RejectsBrokenFiles)
+{
+  DirectX::ScratchImage original;
+  SKIV_Test_MakeSDR (64, 48, original);
+
+  std::vector <uint8_t> file;
+  SKIV_CHECK (SKIV_Test_EncodeJPEG (original, file));
+
+  DirectX::ScratchImage decoded;
+
+  // Cut off in the markers
+  for (size_t size : { size_t (2), size_t (40) })
+    SKIV_CHECK (FAILED (SKIV_Image_LoadJPEG (file.data (), size, 1, DXGI_FORMAT_R8G8B8A8_UNORM, decoded)));
+
+  // Cut off in the middle of the scan, which decodes padded (as stbi does)
+  SKIV_CHECK (SUCCEEDED (SKIV_Image_LoadJPEG (file.data (), file.size () / 2, 1, DXGI_FORMAT_R8G8B8A8_UNORM, decoded)));
+  SKIV_CHECK (decoded.GetMetadata ().width == 64 && decoded.GetMetadata ().height == 48);
+
+  // Progressive is left to stbi
+  for (size_t i = 2; i + 1 < file.size (); ++i)
+  {
+    if (file [i] == 0xFF && file [i + 1] == 0xC0)
+    {
+      file [i + 1] = 0xC2;
+      break;
+    }
+  }
+
+  SKIV_CHECK (SKIV_Image_LoadJPEG (file.data (), file.size (), 1, DXGI_FORMAT_R8G8B8A8_UNORM, decoded) == E_NOTIMPL);
+
+  const char not_a_jpeg [] = "\x89PNG\r\n\x1a\n";
+
+  size_t width = 0, height = 0;
+  int    channels = 0;
+
+  SKIV_CHECK (! SKIV_Image_GetJPEGInfo (not_a_jpeg, sizeof (not_a_jpeg), width, height, channels));
+  SKIV_CHECK (FAILED (SKIV_Image_LoadJPEG (not_a_jpeg, sizeof (not_a_jpeg), 1, DXGI_FORMAT_R8G8B8A8_UNORM, decoded)));
+
+  // Only 8-bit RGBA / BGRA / BGRX output
+  SKIV_CHECK (SKIV_Image_LoadJPEG (file.data (), file.size (), 1, DXGI_FORMAT_R16G16B16A16_FLOAT, decoded) == E_INVALIDARG);
+}
@@ -0,0 +1,167 @@
+#include "test.h"
+#include <utility/image.h>
+#include <DirectXPackedVector.h>
+#include <random>
+
+using DirectX::PackedVector::XMConvertFloatToHalf;
+using DirectX::PackedVector::XMConvertHalfToFloat;
+
+// SKIV_Image_GenerateMipMaps () against DirectXTex's box filter. 8-bit images
+//   are always filtered in linear light, which DirectXTex only does for the
+//     _SRGB formats, so those are what the 8-bit chains are compared with.
+
+// Noise with varying alpha; power of 2 sizes, where DirectXTex uses a plain
+//   2x2 box, and wider than tall so the last levels are a single row
+constexpr size_t SKIV_TEST_MIP_WIDTH  = 64;
+constexpr size_t SKIV_TEST_MIP_HEIGHT = 16;
+
+static void
+SKIV_Test_MakeMipSource (DXGI_FORMAT format, DirectX::ScratchImage& image)
+{
+  image.Initialize2D (format, SKIV_TEST_MIP_WIDTH, SKIV_TEST_MIP_HEIGHT, 1, 1);
+
+  std::mt19937 rng (0x313);
+
+  const DirectX::Image* pImage =
+    image.GetImage (0, 0, 0);
+
+  for (size_t y = 0; y < pImage->height; ++y)
+  {
+    uint8_t* row =
+      pImage->pixels + y * pImage->rowPitch;
+
+    for (size_t i = 0; i < pImage->width * 4; ++i)
+    {
+      if (format == DXGI_FORMAT_R16G16B16A16_FLOAT)
+      {
+        // scRGB, up to 4x SDR white; alpha stays within 0 .. 1
+        const float value =
+          static_cast <float> (rng () % 4096) / ((i % 4 == 3) ? 4095.0f : 1024.0f);
+
+        reinterpret_cast <uint16_t *> (row) [i] = XMConvertFloatToHalf (value);
+      }
+
+      else
+        row [i] = static_cast <uint8_t> (rng ());
+    }
+  }
+}
+
+// Largest difference over every level, in 8-bit levels or relative to 1.0 for
+//   FP16; alpha is skipped for BGRX, whose X is undefined
+static double
+SKIV_Test_CompareMipChains (const DirectX::ScratchImage& ours, const DirectX::ScratchImage& reference, bool compare_alpha)
+{
+  double max_difference = 0.0;
+
+  const DXGI_FORMAT format =
+    ours.GetMetadata ().format;
+
+  for (size_t level = 0; level < reference.GetMetadata ().mipLevels; ++level)
+  {
+    const DirectX::Image* a = ours     .GetImage (level, 0, 0);
+    const DirectX::Image* b = reference.GetImage (level, 0, 0);
+
+    if (a == nullptr || b == nullptr || a->width != b->width || a->height != b->height)
+      return 1.0e9;
+
+    for (size_t y = 0; y < a->height; ++y)
+    {
+      for (size_t i = 0; i < a->width * 4; ++i)
+      {
+        if (i % 4 == 3 && ! compare_alpha)
+          continue;
+
+        double difference;
+
+        if (format == DXGI_FORMAT_R16G16B16A16_FLOAT)
+        {
+          const float va = XMConvertHalfToFloat (reinterpret_cast <const uint16_t *> (a->pixels + y * a->rowPitch) [i]);
+          const float vb = XMConvertHalfToFloat (reinterpret_cast <const uint16_t *> (b->pixels + y * b->rowPitch) [i]);
+
+          difference = std::fabs (va - vb) / std::max (1.0f, std::fabs (vb));
+        }
+
+        else
+          difference = std::abs (static_cast <int> (a->pixels [y * a->rowPitch + i]) -
+                                 static_cast <int> (b->pixels [y * b->rowPitch + i]));
+
+        max_difference = std::max (max_difference, difference);
+      }
+    }
+  }
+
+  return max_difference;
+}
+
+SKIV_TEST (MipMaps_MatchDirectXTex)
+{
+  static const struct {
+    DXGI_FORMAT format;
+    double      tolerance;
+  } formats [] = {
+    { DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, 1.0   },
+    { DXGI_FORMAT_B8G8R8A8_UNORM_SRGB, 1.0   },
+    { DXGI_FORMAT_B8G8R8X8_UNORM_SRGB, 1.0   },
+    { DXGI_FORMAT_R16G16B16A16_FLOAT,  0.002 }
+  };
+
+  for (const auto& [format, tolerance] : formats)
+  {
+    DirectX::ScratchImage source;
+    SKIV_Test_MakeMipSource (format, source);
+
+    DirectX::ScratchImage ours,
+                          reference;
+
+    SKIV_CHECK (SUCCEEDED (SKIV_Image_GenerateMipMaps (*source.GetImage (0, 0, 0), ours)));
+    SKIV_CHECK (SUCCEEDED (DirectX::GenerateMipMaps  (*source.GetImage (0, 0, 0), DirectX::TEX_FILTER_BOX | DirectX::TEX_FILTER_FORCE_NON_WIC, 0, reference)));
+
+    // Down to 1x1
+    SKIV_CHECK (ours.GetMetadata ().mipLevels == 7);
+    SKIV_CHECK (ours.GetMetadata ().mipLevels == reference.GetMetadata ().mipLevels);
+    SKIV_CHECK (ours.GetMetadata ().format    == format);
+
+    const bool opaque =
+      (format == DXGI_FORMAT_B8G8R8X8_UNORM_SRGB);
+
+    SKIV_CHECK (SKIV_Test_CompareMipChains (ours, reference, ! opaque) <= tolerance);
+
+    // BGRX comes out opaque, whatever its X bytes held
+    if (opaque)
+    {
+      bool all_opaque = true;
+
+      for (size_t level = 1; level < ours.GetMetadata ().mipLevels; ++level)
+      {
+        const DirectX::Image* pLevel = ours.GetImage (level, 0, 0);
+
+        for (size_t y = 0; y < pLevel->height; ++y)
+          for (size_t x = 0; x < pLevel->width; ++x)
+            all_opaque &= pLevel->pixels [y * pLevel->rowPitch + x * 4 + 3] == 255;
+      }
+
+      SKIV_CHECK (all_opaque);
+    }
+  }
+}
+
+SKIV_TEST (MipMaps_BGRXIsNotLeftToDirectXTex)
+{
+  // The layout 3-channel stbi images and JPEGs are decoded to; the UNORM
+  //   variant is filtered like _SRGB, so it matches the reference all the same
+  DirectX::ScratchImage source;
+  SKIV_Test_MakeMipSource (DXGI_FORMAT_B8G8R8X8_UNORM_SRGB, source);
+
+  DirectX::ScratchImage reference;
+  SKIV_CHECK (SUCCEEDED (DirectX::GenerateMipMaps (*source.GetImage (0, 0, 0), DirectX::TEX_FILTER_BOX | DirectX::TEX_FILTER_FORCE_NON_WIC, 0, reference)));
+
+  source.OverrideFormat (DXGI_FORMAT_B8G8R8X8_UNORM);
+
+  DirectX::ScratchImage ours;
+  SKIV_CHECK (SUCCEEDED (SKIV_Image_GenerateMipMaps (*source.GetImage (0, 0, 0), ours)));
+
+  ours.OverrideFormat (DXGI_FORMAT_B8G8R8X8_UNORM_SRGB);
+
+  SKIV_CHECK (SKIV_Test_CompareMipChains (ours, reference, false) <= 1.0);
+}
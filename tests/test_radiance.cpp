@@ -0,0 +1,348 @@
+#include "test.h"
+#include <utility/image.h>
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <string>
+
+// SKIV_Image_LoadRadiance () / SKIV_Image_SaveRadiance () against each other,
+//   against hand-written files and against DirectXTex's own codec.
+
+// HDR content with runs (for RLE), black, negative components and highlights
+//   far above FP16's range of precision
+static void
+SKIV_Test_MakeHDR (size_t width, size_t height, DirectX::ScratchImage& image)
+{
+  image.Initialize2D (DXGI_FORMAT_R32G32B32A32_FLOAT, width, height, 1, 1);
+
+  std::mt19937                           rng   (0x4D52);
+  std::uniform_real_distribution <float> level (0.0f, 1.0f);
+
+  for (size_t y = 0; y < height; ++y)
+  {
+    float* row =
+      reinterpret_cast <float *> (image.GetImage (0, 0, 0)->pixels + y * image.GetImage (0, 0, 0)->rowPitch);
+
+    for (size_t x = 0; x < width; ++x)
+    {
+      float* px = row + x * 4;
+
+      switch ((x / 5 + y) % 4)
+      {
+        // A run of a single color
+        case 0:
+          px [0] = 0.75f; px [1] = 1.5f; px [2] = 3.0f;
+          break;
+
+        case 1:
+          px [0] = px [1] = px [2] = 0.0f;
+          break;
+
+        // Noise from 1/256 to 4096
+        case 2:
+          for (int c = 0; c < 3; ++c)
+            px [c] = std::exp2 (level (rng) * 20.0f - 8.0f);
+          break;
+
+        // Outside of the gamut RGBE can store
+        case 3:
+          px [0] = -0.5f; px [1] = 2.0f * level (rng); px [2] = 0.25f;
+          break;
+      }
+
+      px [3] = 1.0f;
+    }
+  }
+}
+
+// RGBE keeps 8 bits of the largest component, truncated, and negatives become
+//   0; the decoders' FP16 output adds a little more
+static bool
+SKIV_Test_MatchesRGBE (const DirectX::ScratchImage& original_image, const DirectX::ScratchImage& decoded_image)
+{
+  if (original_image.GetImages () == nullptr || decoded_image.GetImages () == nullptr)
+    return false;
+
+  const DirectX::Image& original = *original_image.GetImages ();
+  const DirectX::Image& decoded  = *decoded_image.GetImages  ();
+
+  if (original.width != decoded.width || original.height != decoded.height)
+    return false;
+
+  DirectX::ScratchImage a, b;
+
+  auto _ToFP32 = [](const DirectX::Image& image, DirectX::ScratchImage& result)
+  {
+    result.Initialize2D (DXGI_FORMAT_R32G32B32A32_FLOAT, image.width, image.height, 1, 1);
+
+    for (size_t y = 0; y < image.height; ++y)
+    {
+      const uint8_t* src = image.pixels                     + y * image.rowPitch;
+            float*   dst = reinterpret_cast <float *> (result.GetPixels () + y * result.GetImage (0, 0, 0)->rowPitch);
+
+      if (image.format == DXGI_FORMAT_R16G16B16A16_FLOAT)
+        SKIV_Image_UnpackFP16toFP32 (reinterpret_cast <const uint16_t *> (src), dst, image.width * 4);
+      else
+        memcpy (dst, src, image.width * 4 * sizeof (float));
+    }
+  };
+
+  _ToFP32 (original, a);
+  _ToFP32 (decoded,  b);
+
+  const float* expected = reinterpret_cast <const float *> (a.GetPixels ());
+  const float* actual   = reinterpret_cast <const float *> (b.GetPixels ());
+
+  for (size_t i = 0; i < original.width * original.height * 4; i += 4)
+  {
+    const float max =
+      std::max ({ expected [i], expected [i + 1], expected [i + 2], 0.0f });
+
+    for (int c = 0; c < 3; ++c)
+    {
+      const float value = std::max (expected [i + c], 0.0f);
+
+      if (std::fabs (actual [i + c] - value) > max / 128.0f + value / 1024.0f)
+        return false;
+    }
+
+    if (actual [i + 3] != 1.0f)
+      return false;
+  }
+
+  return true;
+}
+
+static HRESULT
+SKIV_Test_LoadRadiance (const std::string& file, DirectX::ScratchImage& result)
+{
+  return
+    SKIV_Image_LoadRadiance (file.data (), file.size (), result);
+}
+
+static void
+SKIV_Test_CheckPixel (const DirectX::ScratchImage& image, size_t x, size_t y, float r, float g, float b)
+{
+  const DirectX::Image* pImage = image.GetImage (0, 0, 0);
+
+  SKIV_CHECK (pImage != nullptr && x < pImage->width && y < pImage->height);
+
+  if (pImage == nullptr || x >= pImage->width || y >= pImage->height)
+    return;
+
+  float rgba [4];
+
+  SKIV_Image_UnpackFP16toFP32 (reinterpret_cast <const uint16_t *> (pImage->pixels + y * pImage->rowPitch) + x * 4, rgba, 4);
+
+  SKIV_CHECK_NEAR (rgba [0], r, 1e-3);
+  SKIV_CHECK_NEAR (rgba [1], g, 1e-3);
+  SKIV_CHECK_NEAR (rgba [2], b, 1e-3);
+  SKIV_CHECK      (rgba [3] == 1.0f);
+}
+
+SKIV_TEST (Radiance_RoundTrip)
+{
+  // New-style RLE, then widths it cannot describe, which are stored flat
+  for (const auto& [width, height] : { std::pair { 45, 7 }, std::pair { 8, 3 }, std::pair { 0x7FFF, 2 },
+                                       std::pair {  5, 4 }, std::pair { 1, 1 }, std::pair { 0x8020, 2 } })
+  {
+    DirectX::ScratchImage image;
+    SKIV_Test_MakeHDR (width, height, image);
+
+    DirectX::Blob blob;
+    SKIV_CHECK (SUCCEEDED (SKIV_Image_SaveRadiance (*image.GetImage (0, 0, 0), blob)));
+
+    const std::string file (static_cast <const char *> (blob.GetBufferPointer ()), blob.GetBufferSize ());
+
+    const std::string header =
+      "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y " + std::to_string (height) + " +X " + std::to_string (width) + "\n";
+
+    SKIV_CHECK (file.starts_with (header));
+
+    const bool rle = (width >= 8 && width <= 0x7FFF);
+
+    if (rle)
+    {
+      SKIV_CHECK (file.size () > header.size () + 4 && file [header.size ()] == 2 && file [header.size () + 1] == 2);
+      SKIV_CHECK (file.size () < header.size () + size_t (width) * height * 4);
+    }
+    else
+      SKIV_CHECK (file.size () == header.size () + size_t (width) * height * 4);
+
+    DirectX::ScratchImage decoded;
+    SKIV_CHECK (SUCCEEDED (SKIV_Test_LoadRadiance (file, decoded)));
+    SKIV_CHECK (decoded.GetMetadata ().format == DXGI_FORMAT_R16G16B16A16_FLOAT);
+    SKIV_CHECK (SKIV_Test_MatchesRGBE (image, decoded));
+
+    // FP16 input encodes the same way
+    DirectX::ScratchImage fp16;
+    fp16.Initialize2D (DXGI_FORMAT_R16G16B16A16_FLOAT, width, height, 1, 1);
+
+    SKIV_Image_PackFP32toFP16 (reinterpret_cast <const float *> (image.GetPixels ()), reinterpret_cast <uint16_t *> (fp16.GetPixels ()), size_t (width) * height * 4);
+
+    DirectX::Blob blob16;
+    SKIV_CHECK (SUCCEEDED (SKIV_Image_SaveRadiance (*fp16.GetImage (0, 0, 0), blob16)));
+
+    DirectX::ScratchImage decoded16;
+    SKIV_CHECK (SUCCEEDED (SKIV_Image_LoadRadiance (blob16.GetBufferPointer (), blob16.GetBufferSize (), decoded16)));
+    SKIV_CHECK (SKIV_Test_MatchesRGBE (fp16, decoded16));
+  }
+}
+
+// RGBE pixels of 1.0, 0.5, 0.25 and 2.0, 1.0, 0.5 (mantissa * 2^(e - 136))
+static const std::string skiv_test_rgbe_a ("\x80\x40\x20\x81", 4);
+static const std::string skiv_test_rgbe_b ("\x80\x40\x20\x82", 4);
+
+SKIV_TEST (Radiance_OldStyleRLE)
+{
+  // (1, 1, 1, n) repeats the previous pixel n times, shifted by 8 bits for
+  //   each repeat that follows directly: 1 + 43 + (1 << 8) = 300 pixels, and
+  //     1 + 42 + 1 + 0 + (1 << 8) = 300 on the second row
+  const std::string file =
+    "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y 2 +X 300\n" +
+    skiv_test_rgbe_a + std::string ("\x01\x01\x01\x2B", 4) + std::string ("\x01\x01\x01\x01", 4) +
+    skiv_test_rgbe_b + std::string ("\x01\x01\x01\x2A", 4) +
+    skiv_test_rgbe_a + std::string ("\x01\x01\x01\x00", 4) + std::string ("\x01\x01\x01\x01", 4);
+
+  DirectX::ScratchImage decoded;
+  SKIV_CHECK (SUCCEEDED (SKIV_Test_LoadRadiance (file, decoded)));
+
+  for (size_t x : { 0, 1, 43, 44, 299 })
+    SKIV_Test_CheckPixel (decoded, x, 0, 1.0f, 0.5f, 0.25f);
+
+  SKIV_Test_CheckPixel (decoded,   0, 1, 2.0f, 1.0f, 0.5f);
+  SKIV_Test_CheckPixel (decoded,  42, 1, 2.0f, 1.0f, 0.5f);
+  SKIV_Test_CheckPixel (decoded,  43, 1, 1.0f, 0.5f, 0.25f);
+  SKIV_Test_CheckPixel (decoded, 299, 1, 1.0f, 0.5f, 0.25f);
+
+  // A repeat before any pixel, and one past the end of the scanline
+  SKIV_CHECK (FAILED (SKIV_Test_LoadRadiance ("#?RADIANCE\n\n-Y 1 +X 2\n" + std::string ("\x01\x01\x01\x02", 4), decoded)));
+  SKIV_CHECK (FAILED (SKIV_Test_LoadRadiance ("#?RADIANCE\n\n-Y 1 +X 2\n" + skiv_test_rgbe_a + std::string ("\x01\x01\x01\x02", 4), decoded)));
+}
+
+SKIV_TEST (Radiance_Exposure)
+{
+  // Every EXPOSURE applies, and reading the file divides by their product
+  const std::string file =
+    "#?RADIANCE\nEXPOSURE=2\nFORMAT=32-bit_rle_rgbe\nEXPOSURE=0.5e1\n\n-Y 1 +X 2\n" + skiv_test_rgbe_a + skiv_test_rgbe_b;
+
+  DirectX::ScratchImage decoded;
+  SKIV_CHECK (SUCCEEDED (SKIV_Test_LoadRadiance (file, decoded)));
+
+  SKIV_Test_CheckPixel (decoded, 0, 0, 0.1f, 0.05f, 0.025f);
+  SKIV_Test_CheckPixel (decoded, 1, 0, 0.2f, 0.1f,  0.05f);
+
+  // Nonsense values are ignored
+  SKIV_CHECK (SUCCEEDED (SKIV_Test_LoadRadiance ("#?RGBE\nEXPOSURE=0\nEXPOSURE=-4\n\n-Y 1 +X 1\n" + skiv_test_rgbe_a, decoded)));
+  SKIV_Test_CheckPixel (decoded, 0, 0, 1.0f, 0.5f, 0.25f);
+
+  // 2^17, 2^16 and 2^15 are beyond FP16, but not once the exposure of 4 is
+  //   divided out; 9 pixels for both the AVX2 loop and the scalar tail
+  std::string bright;
+
+  for (int x = 0; x < 9; ++x)
+    bright += std::string ("\x80\x40\x20" "\x92", 4);
+
+  SKIV_CHECK (SUCCEEDED (SKIV_Test_LoadRadiance ("#?RADIANCE\nEXPOSURE=4\n\n-Y 1 +X 9\n" + bright, decoded)));
+  SKIV_Test_CheckPixel (decoded, 0, 0, 32768.0f, 16384.0f, 8192.0f);
+  SKIV_Test_CheckPixel (decoded, 8, 0, 32768.0f, 16384.0f, 8192.0f);
+
+  // Still clamped to FP16 once it is
+  SKIV_CHECK (SUCCEEDED (SKIV_Test_LoadRadiance ("#?RADIANCE\nEXPOSURE=0.5\n\n-Y 1 +X 9\n" + bright, decoded)));
+  SKIV_Test_CheckPixel (decoded, 0, 0, 65504.0f, 65504.0f, 65504.0f);
+  SKIV_Test_CheckPixel (decoded, 8, 0, 65504.0f, 65504.0f, 65504.0f);
+}
+
+SKIV_TEST (Radiance_FlippedAxes)
+{
+  // a b    in file order, for every combination of signs
+  // b a
+  const std::string pixels =
+    skiv_test_rgbe_a + skiv_test_rgbe_b + skiv_test_rgbe_b + skiv_test_rgbe_a + skiv_test_rgbe_a + skiv_test_rgbe_a;
+
+  for (const char* resolution : { "-Y 3 +X 2", "+Y 3 +X 2", "-Y 3 -X 2", "+Y 3 -X 2" })
+  {
+    DirectX::ScratchImage decoded;
+    SKIV_CHECK (SUCCEEDED (SKIV_Test_LoadRadiance (std::string ("#?RADIANCE\n\n") + resolution + "\n" + pixels, decoded)));
+
+    const bool flip_y = (resolution [0] == '+'),
+               flip_x = (resolution [5] == '-');
+
+    // File row 0 is "a b", row 1 is "b a", row 2 is "a a"
+    for (size_t row = 0; row < 3; ++row)
+    {
+      const size_t y = flip_y ? 2 - row : row;
+
+      for (size_t column = 0; column < 2; ++column)
+      {
+        const size_t x = flip_x ? 1 - column : column;
+
+        const bool is_b =
+          (row == 0 && column == 1) || (row == 1 && column == 0);
+
+        SKIV_Test_CheckPixel (decoded, x, y, is_b ? 2.0f : 1.0f, is_b ? 1.0f : 0.5f, is_b ? 0.5f : 0.25f);
+      }
+    }
+  }
+}
+
+SKIV_TEST (Radiance_RejectsUnsupportedFiles)
+{
+  DirectX::ScratchImage decoded;
+
+  const std::string pixel = skiv_test_rgbe_a;
+
+  // Left to DirectXTex
+  SKIV_CHECK (SKIV_Test_LoadRadiance ("#?RADIANCE\nFORMAT=32-bit_rle_xyze\n\n-Y 1 +X 1\n" + pixel, decoded) == E_NOTIMPL);
+  SKIV_CHECK (SKIV_Test_LoadRadiance ("#?RADIANCE\n\n+X 1 -Y 1\n"                          + pixel, decoded) == E_NOTIMPL);
+
+  // Malformed
+  SKIV_CHECK (FAILED (SKIV_Test_LoadRadiance ("P6\n1 1\n255\n",                          decoded)));
+  SKIV_CHECK (FAILED (SKIV_Test_LoadRadiance ("#?RADIANCE\n\n-Y 2 +X 1\n" + pixel,       decoded))); // Truncated
+  SKIV_CHECK (FAILED (SKIV_Test_LoadRadiance ("#?RADIANCE\n\n-Y 0 +X 1\n",               decoded)));
+
+  // New-style RLE with a run past the end of the scanline
+  SKIV_CHECK (FAILED (SKIV_Test_LoadRadiance ("#?RADIANCE\n\n-Y 1 +X 8\n" + std::string ("\x02\x02\x00\x08\x89\x80", 6), decoded)));
+
+  // Only floating-point images are encoded here
+  DirectX::ScratchImage sdr;
+  sdr.Initialize2D (DXGI_FORMAT_R8G8B8A8_UNORM, 8, 8, 1, 1);
+
+  DirectX::Blob blob;
+  SKIV_CHECK (FAILED (SKIV_Image_SaveRadiance (*sdr.GetImage (0, 0, 0), blob)));
+}
+
+SKIV_TEST (Radiance_MatchesDirectXTex)
+{
+  for (const auto& [width, height] : { std::pair { 61, 9 }, std::pair { 5, 3 }, std::pair { 0x8020, 1 } })
+  {
+    DirectX::ScratchImage original;
+    SKIV_Test_MakeHDR (width, height, original);
+
+    // DirectXTex's files decode the same with either codec
+    DirectX::Blob theirs;
+    SKIV_CHECK (SUCCEEDED (DirectX::SaveToHDRMemory (*original.GetImages (), theirs)));
+
+    DirectX::ScratchImage theirs_by_directxtex,
+                          theirs_by_us;
+
+    SKIV_CHECK (SUCCEEDED (DirectX::LoadFromHDRMemory  (theirs.GetBufferPointer (), theirs.GetBufferSize (), nullptr, theirs_by_directxtex)));
+    SKIV_CHECK (SUCCEEDED (SKIV_Image_LoadRadiance     (theirs.GetBufferPointer (), theirs.GetBufferSize (),          theirs_by_us)));
+
+    SKIV_CHECK (SKIV_Test_MatchesRGBE (original, theirs_by_directxtex));
+    SKIV_CHECK (SKIV_Test_MatchesRGBE (theirs_by_directxtex, theirs_by_us));
+
+    // Ours decode the same with DirectXTex as they do with us
+    DirectX::Blob ours;
+    SKIV_CHECK (SUCCEEDED (SKIV_Image_SaveRadiance (*original.GetImages (), ours)));
+
+    DirectX::ScratchImage ours_by_directxtex,
+                          ours_by_us;
+
+    SKIV_CHECK (SUCCEEDED (DirectX::LoadFromHDRMemory  (ours.GetBufferPointer (), ours.GetBufferSize (), nullptr, ours_by_directxtex)));
+    SKIV_CHECK (SUCCEEDED (SKIV_Image_LoadRadiance     (ours.GetBufferPointer (), ours.GetBufferSize (),          ours_by_us)));
+
+    SKIV_CHECK (SKIV_Test_MatchesRGBE (original, ours_by_directxtex));
+    SKIV_CHECK (SKIV_Test_MatchesRGBE (ours_by_directxtex, ours_by_us));
+  }
+}
@@ -0,0 +1,375 @@
+#include "test.h"
+#include <utility/image.h>
+#include <DirectXPackedVector.h>
+#include <cstring>
+
+using DirectX::PackedVector::XMConvertFloatToHalf;
+using DirectX::PackedVector::XMConvertHalfToFloat;
+
+// SKIV_Image_Resample () on images whose result is known exactly: flat colors,
+//   linear ramps and block averages, in 8-bit (filtered in linear light) and
+//     float formats.
+
+static const SKIV_ResampleFilter SKIV_Test_Filters [] = {
+  SKIV_ResampleFilter_Area,
+  SKIV_ResampleFilter_Triangle,
+  SKIV_ResampleFilter_Mitchell,
+  SKIV_ResampleFilter_Lanczos3
+};
+
+static double
+SKIV_Test_sRGBToLinear (double c)
+{
+  return (c <= 0.04045) ? c / 12.92 : std::pow ((c + 0.055) / 1.055, 2.4);
+}
+
+static double
+SKIV_Test_LinearTosRGB (double c)
+{
+  return (c <= 0.0031308) ? c * 12.92 : 1.055 * std::pow (c, 1.0 / 2.4) - 0.055;
+}
+
+// Channel c of pixel (x, y) as a float, 8-bit channels as stored (0 .. 255)
+static float
+SKIV_Test_GetChannel (const DirectX::Image& image, size_t x, size_t y, size_t c)
+{
+  const uint8_t* row =
+    image.pixels + y * image.rowPitch;
+
+  switch (image.format)
+  {
+    case DXGI_FORMAT_R32G32B32A32_FLOAT:
+      return reinterpret_cast <const float *> (row) [x * 4 + c];
+    case DXGI_FORMAT_R16G16B16A16_FLOAT:
+      return XMConvertHalfToFloat (reinterpret_cast <const uint16_t *> (row) [x * 4 + c]);
+    default:
+      return row [x * 4 + c];
+  }
+}
+
+static void
+SKIV_Test_SetChannel (const DirectX::Image& image, size_t x, size_t y, size_t c, float value)
+{
+  uint8_t* row =
+    image.pixels + y * image.rowPitch;
+
+  switch (image.format)
+  {
+    case DXGI_FORMAT_R32G32B32A32_FLOAT:
+      reinterpret_cast <float *> (row) [x * 4 + c] = value;
+      break;
+    case DXGI_FORMAT_R16G16B16A16_FLOAT:
+      reinterpret_cast <uint16_t *> (row) [x * 4 + c] = XMConvertFloatToHalf (value);
+      break;
+    default:
+      row [x * 4 + c] = static_cast <uint8_t> (value);
+      break;
+  }
+}
+
+SKIV_TEST (Resample_Dimensions)
+{
+  static const struct {
+    size_t src_width, src_height;
+    size_t dst_width, dst_height;
+  } sizes [] = {
+    { 37, 23, 13,  7 }, // Downscale
+    { 37, 23, 80, 51 }, // Upscale
+    { 37, 23, 74,  5 }, // Both at once
+    { 37, 23,  1,  1 },
+    {  1,  1,  9,  3 }
+  };
+
+  for (DXGI_FORMAT format : { DXGI_FORMAT_B8G8R8X8_UNORM, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, DXGI_FORMAT_R16G16B16A16_FLOAT, DXGI_FORMAT_R32G32B32A32_FLOAT })
+  {
+    for (const auto& size : sizes)
+    {
+      DirectX::ScratchImage source;
+      source.Initialize2D (format, size.src_width, size.src_height, 1, 1);
+
+      std::memset (source.GetPixels (), 0, source.GetPixelsSize ());
+
+      for (SKIV_ResampleFilter filter : SKIV_Test_Filters)
+      {
+        DirectX::ScratchImage result;
+
+        SKIV_CHECK (SUCCEEDED (SKIV_Image_Resample (*source.GetImage (0, 0, 0), size.dst_width, size.dst_height, filter, result)));
+        SKIV_CHECK (result.GetMetadata ().width  == size.dst_width);
+        SKIV_CHECK (result.GetMetadata ().height == size.dst_height);
+        SKIV_CHECK (result.GetMetadata ().format == format);
+      }
+    }
+
+    DirectX::ScratchImage source,
+                          result;
+
+    source.Initialize2D (format, 4, 4, 1, 1);
+
+    SKIV_CHECK (SKIV_Image_Resample (*source.GetImage (0, 0, 0), 0, 4, SKIV_ResampleFilter_Area, result) == E_INVALIDARG);
+  }
+}
+
+SKIV_TEST (Resample_FlatColorsStayFlat)
+{
+  // The weights of every filter add up to 1, ringing included
+  static const struct {
+    DXGI_FORMAT format;
+    float       color [4];
+    double      tolerance;
+  } cases [] = {
+    { DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, { 200.0f, 31.0f, 128.0f, 255.0f }, 1.0    },
+    { DXGI_FORMAT_B8G8R8A8_UNORM,      {  17.0f, 99.0f, 250.0f, 128.0f }, 1.0    },
+    { DXGI_FORMAT_R16G16B16A16_FLOAT,  {  4.5f,  0.25f, 0.0f,   1.0f   }, 0.005  },
+    { DXGI_FORMAT_R32G32B32A32_FLOAT,  { 12.5f,  0.5f,  0.125f, 0.75f  }, 0.0005 }
+  };
+
+  for (const auto& test : cases)
+  {
+    DirectX::ScratchImage source;
+    source.Initialize2D (test.format, 29, 17, 1, 1);
+
+    for (size_t y = 0; y < 17; ++y)
+      for (size_t x = 0; x < 29; ++x)
+        for (size_t c = 0; c < 4; ++c)
+          SKIV_Test_SetChannel (*source.GetImage (0, 0, 0), x, y, c, test.color [c]);
+
+    for (SKIV_ResampleFilter filter : SKIV_Test_Filters)
+    {
+      for (const auto& [width, height] : { std::pair { size_t (11), size_t (6) }, std::pair { size_t (64), size_t (40) } })
+      {
+        DirectX::ScratchImage result;
+        SKIV_CHECK (SUCCEEDED (SKIV_Image_Resample (*source.GetImage (0, 0, 0), width, height, filter, result)));
+
+        if (result.GetMetadata ().width != width || result.GetMetadata ().height != height)
+          continue;
+
+        double max_difference = 0.0;
+
+        for (size_t y = 0; y < height; ++y)
+          for (size_t x = 0; x < width; ++x)
+            for (size_t c = 0; c < 4; ++c)
+              max_difference = std::max (max_difference, static_cast <double> (std::fabs (SKIV_Test_GetChannel (*result.GetImage (0, 0, 0), x, y, c) - test.color [c]) / std::max (1.0f, test.color [c])));
+
+        SKIV_CHECK (max_difference <= test.tolerance);
+      }
+    }
+  }
+}
+
+SKIV_TEST (Resample_AreaDownscaleAveragesBlocks)
+{
+  constexpr size_t width  = 24,
+                   height = 12,
+                   factor = 4;
+
+  // FP32 is averaged as it is, 8-bit in linear light; BGRX is what the viewer
+  //   decodes JPEGs to, and DirectXTex would average it as stored
+  for (DXGI_FORMAT format : { DXGI_FORMAT_R32G32B32A32_FLOAT, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, DXGI_FORMAT_B8G8R8X8_UNORM })
+  {
+    const bool is_float =
+      (format == DXGI_FORMAT_R32G32B32A32_FLOAT);
+
+    DirectX::ScratchImage source;
+    source.Initialize2D (format, width, height, 1, 1);
+
+    for (size_t y = 0; y < height; ++y)
+    {
+      for (size_t x = 0; x < width; ++x)
+      {
+        for (size_t c = 0; c < 3; ++c)
+        {
+          SKIV_Test_SetChannel (*source.GetImage (0, 0, 0), x, y, c,
+            is_float ? static_cast <float> ((x *  7 + y * 13 + c *  5) % 31) * 0.25f
+                     : static_cast <float> ((x * 37 + y * 91 + c * 53) % 256));
+        }
+
+        SKIV_Test_SetChannel (*source.GetImage (0, 0, 0), x, y, 3, is_float ? 1.0f : 255.0f);
+      }
+    }
+
+    DirectX::ScratchImage result;
+    SKIV_CHECK (SUCCEEDED (SKIV_Image_Resample (*source.GetImage (0, 0, 0), width / factor, height / factor, SKIV_ResampleFilter_Area, result)));
+
+    if (result.GetMetadata ().width != width / factor || result.GetMetadata ().height != height / factor)
+      continue;
+
+    for (size_t y = 0; y < height / factor; ++y)
+    {
+      for (size_t x = 0; x < width / factor; ++x)
+      {
+        for (size_t c = 0; c < 3; ++c)
+        {
+          double sum = 0.0;
+
+          for (size_t j = 0; j < factor; ++j)
+          {
+            for (size_t i = 0; i < factor; ++i)
+            {
+              const float value =
+                SKIV_Test_GetChannel (*source.GetImage (0, 0, 0), x * factor + i, y * factor + j, c);
+
+              sum += is_float ? value : SKIV_Test_sRGBToLinear (value / 255.0);
+            }
+          }
+
+          const double average =
+            sum / (factor * factor);
+
+          if (is_float)
+            SKIV_CHECK_NEAR (SKIV_Test_GetChannel (*result.GetImage (0, 0, 0), x, y, c), average, 1.0e-4);
+          else
+            SKIV_CHECK_NEAR (SKIV_Test_GetChannel (*result.GetImage (0, 0, 0), x, y, c), SKIV_Test_LinearTosRGB (average) * 255.0, 1.0);
+        }
+      }
+    }
+  }
+}
+
+SKIV_TEST (Resample_TriangleUpscaleInterpolatesRamps)
+{
+  // A linear ramp is reproduced exactly away from the edges, where the
+  //   clipped taps are renormalized
+  constexpr size_t width  = 16,
+                   height = 8;
+
+  for (DXGI_FORMAT format : { DXGI_FORMAT_R32G32B32A32_FLOAT, DXGI_FORMAT_R16G16B16A16_FLOAT })
+  {
+    DirectX::ScratchImage source;
+    source.Initialize2D (format, width, height, 1, 1);
+
+    for (size_t y = 0; y < height; ++y)
+    {
+      for (size_t x = 0; x < width; ++x)
+      {
+        SKIV_Test_SetChannel (*source.GetImage (0, 0, 0), x, y, 0, static_cast <float> (x));
+        SKIV_Test_SetChannel (*source.GetImage (0, 0, 0), x, y, 1, static_cast <float> (y));
+        SKIV_Test_SetChannel (*source.GetImage (0, 0, 0), x, y, 2, 0.5f);
+        SKIV_Test_SetChannel (*source.GetImage (0, 0, 0), x, y, 3, 1.0f);
+      }
+    }
+
+    DirectX::ScratchImage result;
+    SKIV_CHECK (SUCCEEDED (SKIV_Image_Resample (*source.GetImage (0, 0, 0), width * 2, height * 2, SKIV_ResampleFilter_Triangle, result)));
+
+    if (result.GetMetadata ().width != width * 2 || result.GetMetadata ().height != height * 2)
+      continue;
+
+    for (size_t y = 1; y < height * 2 - 1; ++y)
+    {
+      for (size_t x = 1; x < width * 2 - 1; ++x)
+      {
+        // Centers of the destination pixels in source pixel coordinates
+        const double u = (x + 0.5) / 2.0 - 0.5,
+                     v = (y + 0.5) / 2.0 - 0.5;
+
+        SKIV_CHECK_NEAR (SKIV_Test_GetChannel (*result.GetImage (0, 0, 0), x, y, 0), u,   0.01);
+        SKIV_CHECK_NEAR (SKIV_Test_GetChannel (*result.GetImage (0, 0, 0), x, y, 1), v,   0.01);
+        SKIV_CHECK_NEAR (SKIV_Test_GetChannel (*result.GetImage (0, 0, 0), x, y, 2), 0.5, 0.001);
+      }
+    }
+  }
+}
+
+SKIV_TEST (Resample_Alpha)
+{
+  constexpr size_t width  = 8,
+                   height = 8;
+
+  // Transparent pixels are red, which must not bleed into the opaque green ones
+  DirectX::ScratchImage rgba;
+  rgba.Initialize2D (DXGI_FORMAT_R8G8B8A8_UNORM, width, height, 1, 1);
+
+  // BGRX with zeroed X bytes, which are no alpha at all
+  DirectX::ScratchImage bgrx;
+  bgrx.Initialize2D (DXGI_FORMAT_B8G8R8X8_UNORM, width, height, 1, 1);
+
+  for (size_t y = 0; y < height; ++y)
+  {
+    for (size_t x = 0; x < width; ++x)
+    {
+      uint8_t* pixel = rgba.GetPixels () + y * rgba.GetImage (0, 0, 0)->rowPitch + x * 4;
+
+      const bool opaque = (x % 2) == 0;
+
+      pixel [0] = opaque ? 0   : 255;
+      pixel [1] = opaque ? 255 : 0;
+      pixel [2] = 0;
+      pixel [3] = opaque ? 255 : 0;
+
+      pixel = bgrx.GetPixels () + y * bgrx.GetImage (0, 0, 0)->rowPitch + x * 4;
+
+      pixel [0] = 40;
+      pixel [1] = 80;
+      pixel [2] = 160;
+      pixel [3] = 0;
+    }
+  }
+
+  for (bool upscale : { false, true })
+  {
+    const size_t dst_width  = upscale ? width  * 3 : width  / 2,
+                 dst_height = upscale ? height * 3 : height / 2;
+
+    DirectX::ScratchImage rgba_result,
+                          bgrx_result;
+
+    // Exact coverage when halved, so alpha is exactly half
+    const SKIV_ResampleFilter filter =
+      upscale ? SKIV_ResampleFilter_Triangle : SKIV_ResampleFilter_Area;
+
+    SKIV_CHECK (SUCCEEDED (SKIV_Image_Resample (*rgba.GetImage (0, 0, 0), dst_width, dst_height, filter, rgba_result)));
+    SKIV_CHECK (SUCCEEDED (SKIV_Image_Resample (*bgrx.GetImage (0, 0, 0), dst_width, dst_height, SKIV_ResampleFilter_Lanczos3, bgrx_result)));
+
+    if (rgba_result.GetPixels () == nullptr || bgrx_result.GetPixels () == nullptr)
+      return;
+
+    for (size_t y = 0; y < dst_height; ++y)
+    {
+      for (size_t x = 0; x < dst_width; ++x)
+      {
+        const uint8_t* pixel = rgba_result.GetPixels () + y * rgba_result.GetImage (0, 0, 0)->rowPitch + x * 4;
+
+        // Anything with coverage is pure green
+        if (pixel [3] > 0)
+        {
+          SKIV_CHECK (pixel [0] == 0);
+          SKIV_CHECK (pixel [1] == 255);
+        }
+
+        if (! upscale)
+          SKIV_CHECK_NEAR (pixel [3], 128, 1);
+
+        pixel = bgrx_result.GetPixels () + y * bgrx_result.GetImage (0, 0, 0)->rowPitch + x * 4;
+
+        SKIV_CHECK (pixel [0] == 40 && pixel [1] == 80 && pixel [2] == 160 && pixel [3] == 255);
+      }
+    }
+  }
+}
+
+SKIV_TEST (Resample_ExportSize)
+{
+  size_t width  = 0,
+         height = 0;
+
+  SKIV_Image_GetExportSize (4000, 3000, 50.0f, 0, 0, width, height);
+  SKIV_CHECK (width == 2000 && height == 1500);
+
+  // The tighter limit wins, and the aspect ratio is kept
+  SKIV_Image_GetExportSize (4000, 3000, 100.0f, 1000, 1000, width, height);
+  SKIV_CHECK (width == 1000 && height == 750);
+
+  // Never upscales
+  SKIV_Image_GetExportSize (400, 300, 200.0f, 0, 0, width, height);
+  SKIV_CHECK (width == 400 && height == 300);
+
+  DirectX::ScratchImage source,
+                        result;
+
+  source.Initialize2D (DXGI_FORMAT_B8G8R8X8_UNORM, 40, 30, 1, 1);
+  std::memset (source.GetPixels (), 0x80, source.GetPixelsSize ());
+
+  SKIV_CHECK (SKIV_Image_ResizeForExport (*source.GetImage (0, 0, 0), 100.0f, 0, 0, result) == S_FALSE);
+  SKIV_CHECK (SUCCEEDED (SKIV_Image_ResizeForExport (*source.GetImage (0, 0, 0), 25.0f, 0, 0, result)));
+  SKIV_CHECK (result.GetMetadata ().width == 10 && result.GetMetadata ().height == 8);
+}
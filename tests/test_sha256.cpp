@@ -0,0 +1,129 @@
+#include "test.h"
+#include <utility/sha256.h>
+#include <picosha2.h>
+#include <random>
+#include <string>
+
+// Known answers for runs of 'a' (checked with another SHA-256 implementation),
+//   sized around the padding boundaries: 55 bytes still fit the length in the
+//     last block, 56 .. 63 need an extra one.
+static const struct {
+  size_t      length;
+  const char* digest;
+} skiv_test_sha256_vectors [] = {
+  {       0, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+  {      55, "9f4390f8d30c2dd92ec9f095b65e2b9ae9b0a925a5258e241c9f1e910f734318" },
+  {      56, "b35439a4ac6f0948b6d6f9e3c6af0f5f590ce20f1bde7090ef7970686ec6738a" },
+  {      63, "7d3e74a05d7db15bce4ad9ec0658ea98e3f06eeecf16b4c6fff2da457ddc2f34" },
+  {      64, "ffe054fe7ae0cb6dc65c3af9b61d5209f439851db43d0ba5997337df154668eb" },
+  {      65, "635361c48bb9eab14198e76ea8ab7f1a41685d6ad62aa9146d301d4f17eb0ae0" },
+  { 1000003, "cf5f310cac13bb0f1de288d09940e8ee441e8d5d88b0fd4ec6021c405fda8c8c" }
+};
+
+// Runs checks once per implementation the CPU has, then goes back to SHA-NI
+//   where available
+template <class _Fn>
+static void
+SKIV_Test_ForEachSHA256 (_Fn&& checks)
+{
+  for (bool shani : { false, true })
+  {
+    if (! SKIV_SHA256_SetImplementation (shani))
+    {
+      printf ("  SHA-NI is not supported by this CPU, only the scalar path was tested\n");
+      continue;
+    }
+
+    checks ();
+  }
+
+  SKIV_SHA256_SetImplementation (true);
+}
+
+SKIV_TEST (SHA256_KnownAnswers)
+{
+  SKIV_Test_ForEachSHA256 ([](void)
+  {
+    for (const auto& vector : skiv_test_sha256_vectors)
+    {
+      const std::string message (vector.length, 'a');
+
+      skiv_sha256_s sha256;
+      sha256.update (message.data (), message.size ());
+
+      SKIV_CHECK (sha256.finish_hex () == vector.digest);
+
+      // Fed one byte at a time
+      sha256.reset ();
+
+      for (char c : message)
+        sha256.update (&c, 1);
+
+      SKIV_CHECK (sha256.finish_hex () == vector.digest);
+    }
+
+    skiv_sha256_s sha256;
+    sha256.update ("abc", 3);
+
+    SKIV_CHECK (sha256.finish_hex () == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+  });
+}
+
+SKIV_TEST (SHA256_RandomChunksMatchPicoSHA2)
+{
+  std::mt19937 rng (0x5C1F);
+
+  std::vector <uint8_t> data (1000003);
+
+  for (auto& byte : data)
+    byte = static_cast <uint8_t> (rng ());
+
+  SKIV_Test_ForEachSHA256 ([&](void)
+  {
+    // Every length around the block boundaries, then the whole buffer
+    for (size_t length : { 0, 1, 55, 56, 57, 63, 64, 65, 119, 120, 127, 128, 129, 1000003 })
+    {
+      const std::string reference =
+        picosha2::hash256_hex_string (data.begin (), data.begin () + length);
+
+      // Chunks from empty to a few blocks, as a download delivers them
+      std::uniform_int_distribution <size_t> chunk_size (0, 300);
+
+      skiv_sha256_s sha256;
+
+      for (size_t offset = 0; offset < length; )
+      {
+        const size_t size =
+          std::min (chunk_size (rng), length - offset);
+
+        sha256.update (data.data () + offset, size);
+        offset +=                         size;
+      }
+
+      SKIV_CHECK (sha256.finish_hex () == reference);
+    }
+  });
+}
+
+SKIV_TEST (SHA256_ImplementationsAgree)
+{
+  if (! SKIV_SHA256_SetImplementation (true))
+    return;
+
+  std::vector <uint8_t> data (64 * 1024 + 17);
+
+  for (size_t i = 0; i < data.size (); ++i)
+    data [i] = static_cast <uint8_t> (i * 151 + (i >> 8));
+
+  skiv_sha256_s shani;
+  shani.update (data.data (), data.size ());
+
+  SKIV_SHA256_SetImplementation (false);
+
+  skiv_sha256_s scalar;
+  scalar.update (data.data (), data.size ());
+
+  SKIV_SHA256_SetImplementation (true);
+
+  SKIV_CHECK (shani.finish () == scalar.finish ());
+}
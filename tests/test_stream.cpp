@@ -0,0 +1,295 @@
+#include "test.h"
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <Windows.h>
+#include <utility/stream.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <cwctype>
+#include <mutex>
+#include <share.h>
+#include <string>
+#include <thread>
+
+// SKIV_Stream_Download () against a one-shot HTTP server on the loopback
+//   interface, which holds the last part of the body back until the test has
+//     seen the first part come out of the stream.
+struct skiv_test_http_server_s {
+  SOCKET      listener = INVALID_SOCKET;
+  USHORT      port     = 0;
+  std::thread thread;
+
+  std::mutex              lock;
+  std::condition_variable released;
+  bool                    release = false;
+
+  // Status line without the protocol, e.g. "200 OK"
+  bool start (std::string status, std::string head, std::string tail)
+  {
+    WSADATA wsaData = { };
+
+    if (WSAStartup (MAKEWORD (2, 2), &wsaData) != 0)
+      return false;
+
+    listener =
+      socket (AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+    sockaddr_in addr     = { };
+    int         addr_len = sizeof (addr);
+
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+    addr.sin_port        = 0; // Any free port
+
+    if (listener == INVALID_SOCKET                                              ||
+        bind        (listener, reinterpret_cast <sockaddr *> (&addr), sizeof (addr)) != 0 ||
+        listen      (listener, 1)                                                        != 0 ||
+        getsockname (listener, reinterpret_cast <sockaddr *> (&addr), &addr_len)       != 0)
+      return false;
+
+    port = ntohs (addr.sin_port);
+
+    thread = std::thread ([this, status, head, tail](void)
+    {
+      SOCKET client =
+        accept (listener, nullptr, nullptr);
+
+      if (client == INVALID_SOCKET)
+        return;
+
+      // Reads the request up to the end of its headers
+      std::string request;
+      char        buffer [1024];
+      int         received;
+
+      while (request.find ("\r\n\r\n") == std::string::npos &&
+             (received = recv (client, buffer, sizeof (buffer), 0)) > 0)
+        request.append (buffer, received);
+
+      const std::string response =
+        "HTTP/1.1 " + status + "\r\n"
+        "Content-Length: " + std::to_string (head.size () + tail.size ()) + "\r\n"
+        "Connection: close\r\n"
+        "\r\n" + head;
+
+      send (client, response.data (), static_cast <int> (response.size ()), 0);
+
+      // Gives up after a while, so that a download that does not stream
+      //   fails the test instead of hanging it
+      std::unique_lock <std::mutex> guard (lock);
+      released.wait_for (guard, std::chrono::seconds (5), [this](void) { return release; });
+      guard.unlock ();
+
+      send (client, tail.data (), static_cast <int> (tail.size ()), 0);
+
+      shutdown    (client, SD_SEND);
+      closesocket (client);
+    });
+
+    return true;
+  }
+
+  void send_rest (void)
+  {
+    std::lock_guard <std::mutex> guard (lock);
+    release = true;
+    released.notify_all ();
+  }
+
+  ~skiv_test_http_server_s (void)
+  {
+    send_rest ();
+
+    if (listener != INVALID_SOCKET)
+      closesocket (listener);
+
+    if (thread.joinable ())
+      thread.join ();
+
+    WSACleanup ();
+  }
+};
+
+static std::wstring
+SKIV_Test_GetTempFile (const wchar_t* name)
+{
+  wchar_t wszTemp [MAX_PATH + 1] = { };
+  GetTempPathW (MAX_PATH, wszTemp);
+
+  return
+    std::wstring (wszTemp) + name;
+}
+
+static std::string
+SKIV_Test_ReadFile (const std::wstring& path)
+{
+  std::string contents;
+
+  // Shared like the viewer's _wfopen (), so that this works mid-download
+  FILE* fIn =
+    _wfsopen (path.c_str (), L"rb", _SH_DENYNO);
+
+  if (fIn == nullptr)
+    return contents;
+
+  char   buffer [4096];
+  size_t read;
+
+  while ((read = fread (buffer, 1, sizeof (buffer), fIn)) > 0)
+    contents.append (buffer, read);
+
+  fclose (fIn);
+
+  return contents;
+}
+
+SKIV_TEST (Stream_DownloadIsReadableWhileRunning)
+{
+  // Distinct bytes, so that any reordering or loss shows up
+  std::string head (70000, '\0'),
+              tail (30000, '\0');
+
+  for (size_t i = 0; i < head.size (); ++i) head [i] = static_cast <char> (i * 7 + 1);
+  for (size_t i = 0; i < tail.size (); ++i) tail [i] = static_cast <char> (i * 13 + 5);
+
+  skiv_test_http_server_s server;
+  SKIV_CHECK (server.start ("200 OK", head, tail));
+
+  const std::wstring path =
+    SKIV_Test_GetTempFile (L"SKIV.Tests.stream.bin");
+
+  DeleteFileW (path.c_str ());
+
+  const std::wstring url =
+    L"http://127.0.0.1:" + std::to_wstring (server.port) + L"/image.jxl";
+
+  skiv_stream_s stream;
+  bool          success  = false;
+  size_t        calls    = 0;
+
+  std::thread download ([&](void)
+  {
+    success =
+      SKIV_Stream_Download (url, path, &stream, [&](const void*, size_t) { calls++; });
+  });
+
+  // The first part has to come out of the stream while the server is
+  //   still holding the rest back
+  const size_t available =
+    stream.wait (head.size ());
+
+  SKIV_CHECK (available == head.size ());
+  SKIV_CHECK (! stream.ended ());
+
+  std::vector <uint8_t> seen;
+  stream.read (0, seen, head.size ());
+
+  SKIV_CHECK (seen.size () == head.size ());
+  SKIV_CHECK (seen.size () == head.size () && std::memcmp (seen.data (), head.data (), head.size ()) == 0);
+
+  server.send_rest ();
+  download.join    ();
+
+  SKIV_CHECK (success);
+  SKIV_CHECK (calls > 0);
+  SKIV_CHECK (stream.ended ());
+  SKIV_CHECK (stream.succeeded ());
+
+  // Both the stream and the file hold the complete body
+  std::vector <uint8_t> all;
+  size_t                offset = 0,
+                        read;
+
+  while ((read = stream.read (offset, all)) > 0)
+    offset += read;
+
+  SKIV_CHECK (all.size () == head.size () + tail.size ());
+  SKIV_CHECK (all.size () == head.size () + tail.size () && std::memcmp (all.data () + head.size (), tail.data (), tail.size ()) == 0);
+
+  SKIV_CHECK (SKIV_Test_ReadFile (path) == head + tail);
+
+  DeleteFileW (path.c_str ());
+}
+
+SKIV_TEST (Stream_FileIsReadableWhileDownloading)
+{
+  const std::string head (50000, 'h'),
+                    tail (20000, 't');
+
+  skiv_test_http_server_s server;
+  SKIV_CHECK (server.start ("200 OK", head, tail));
+
+  const std::wstring path =
+    SKIV_Test_GetTempFile (L"SKIV.Tests.partial.bin");
+
+  DeleteFileW (path.c_str ());
+
+  const std::wstring url =
+    L"http://127.0.0.1:" + std::to_wstring (server.port) + L"/image.png";
+
+  skiv_stream_s stream;
+  bool          success = false;
+
+  std::thread download ([&](void)
+  {
+    success =
+      SKIV_Stream_Download (url, path, &stream);
+  });
+
+  // The file is flushed before the stream sees a chunk, so whatever the stream
+  //   holds can be read from disk while the server holds the rest back
+  SKIV_CHECK (stream.wait (head.size ()) == head.size ());
+  SKIV_CHECK (! stream.ended ());
+
+  SKIV_CHECK (SKIV_Test_ReadFile (path) == head);
+
+  server.send_rest ();
+  download.join    ();
+
+  SKIV_CHECK (success);
+  SKIV_CHECK (SKIV_Test_ReadFile (path) == head + tail);
+
+  DeleteFileW (path.c_str ());
+}
+
+SKIV_TEST (Stream_FailedDownloadLeavesNoFile)
+{
+  skiv_test_http_server_s server;
+  SKIV_CHECK (server.start ("404 Not Found", "Not here", ""));
+
+  const std::wstring path =
+    SKIV_Test_GetTempFile (L"SKIV.Tests.missing.bin");
+
+  DeleteFileW (path.c_str ());
+
+  const std::wstring url =
+    L"http://127.0.0.1:" + std::to_wstring (server.port) + L"/missing.png";
+
+  skiv_stream_s stream;
+
+  SKIV_CHECK (! SKIV_Stream_Download (url, path, &stream));
+  SKIV_CHECK (stream.ended ());
+  SKIV_CHECK (! stream.succeeded ());
+  SKIV_CHECK (GetFileAttributesW (path.c_str ()) == INVALID_FILE_ATTRIBUTES);
+}
+
+SKIV_TEST (Stream_RegistryNormalizesPaths)
+{
+  const std::wstring path =
+    SKIV_Test_GetTempFile (L"SKIV.Tests.Registry.bin");
+
+  auto stream =
+    SKIV_Stream_Register (path);
+
+  // The viewer looks paths up lowercased and fully qualified
+  std::wstring lower = path;
+  for (auto& c : lower)
+    c = static_cast <wchar_t> (towlower (c));
+
+  SKIV_CHECK (SKIV_Stream_Find (lower) == stream);
+
+  SKIV_Stream_Unregister (path);
+
+  SKIV_CHECK (SKIV_Stream_Find (path) == nullptr);
+}
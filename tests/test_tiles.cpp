@@ -0,0 +1,375 @@
+#include "test.h"
+#include <utility/image_tiles.h>
+#include <utility/image.h>
+#include <DirectXPackedVector.h>
+#include <concurrent_queue.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <random>
+
+extern concurrency::concurrent_queue <IUnknown *> SKIF_ResourcesToFree;
+
+// RGBA8 image whose pixels encode their own position
+static void
+SKIV_Test_MakePositionImage (size_t width, size_t height, DirectX::ScratchImage& image)
+{
+  image.Initialize2D (DXGI_FORMAT_R8G8B8A8_UNORM, width, height, 1, 1);
+
+  const DirectX::Image* pImage = image.GetImage (0, 0, 0);
+
+  for (size_t y = 0; y < height; ++y)
+  {
+    uint8_t* row = pImage->pixels + y * pImage->rowPitch;
+
+    for (size_t x = 0; x < width; ++x)
+    {
+      row [x * 4 + 0] = static_cast <uint8_t> (x);
+      row [x * 4 + 1] = static_cast <uint8_t> (x >> 8);
+      row [x * 4 + 2] = static_cast <uint8_t> (y);
+      row [x * 4 + 3] = static_cast <uint8_t> (y >> 8);
+    }
+  }
+}
+
+SKIV_TEST (Tiles_CoverImageWithoutCopying)
+{
+  DirectX::ScratchImage source;
+  SKIV_Test_MakePositionImage (300, 200, source);
+
+  const uint8_t* decoded = source.GetPixels ();
+
+  skiv_tiled_image_s tiled;
+  SKIV_CHECK (SUCCEEDED (tiled.Create (std::move (source), 64)));
+
+  SKIV_CHECK (tiled.image.GetPixels () == decoded);
+  SKIV_CHECK (tiled.columns == 5 && tiled.rows == 4);
+  SKIV_CHECK (tiled.tiles.size () == 20);
+
+  std::vector <int> covered (300 * 200, 0);
+
+  for (const auto& tile : tiled.tiles)
+  {
+    SKIV_CHECK (tile.pixels.width  == tile.width);
+    SKIV_CHECK (tile.pixels.height == tile.height);
+    SKIV_CHECK (tile.pixels.slicePitch == tile.width * tile.height * 4);
+
+    for (size_t y = 0; y < tile.height; ++y)
+    {
+      for (size_t x = 0; x < tile.width; ++x)
+      {
+        const uint8_t* p =
+          tile.pixels.pixels + y * tile.pixels.rowPitch + x * 4;
+
+        const size_t image_x = p [0] | (p [1] << 8);
+        const size_t image_y = p [2] | (p [3] << 8);
+
+        SKIV_CHECK (image_x == tile.x + x && image_y == tile.y + y);
+
+        covered [image_y * 300 + image_x]++;
+      }
+    }
+  }
+
+  SKIV_CHECK (std::all_of (covered.begin (), covered.end (), [](int count) { return count == 1; }));
+
+  // The last column and row are partial
+  SKIV_CHECK (tiled.tiles.back ().width  == 300 - 4 * 64);
+  SKIV_CHECK (tiled.tiles.back ().height == 200 - 3 * 64);
+}
+
+SKIV_TEST (Tiles_RejectCompressedFormats)
+{
+  DirectX::ScratchImage source;
+  source.Initialize2D (DXGI_FORMAT_BC1_UNORM, 64, 64, 1, 1);
+
+  skiv_tiled_image_s tiled;
+  SKIV_CHECK (tiled.Create (std::move (source), 32) == E_INVALIDARG);
+}
+
+SKIV_TEST (Tiles_IsRequired)
+{
+  constexpr size_t MiB = 1024 * 1024;
+
+  SKIV_CHECK (  skiv_tiled_image_s::IsRequired (SKIV_TILED_IMAGE_MAX_DIMENSION + 1, 16));
+  SKIV_CHECK (  skiv_tiled_image_s::IsRequired (16, SKIV_TILED_IMAGE_MAX_DIMENSION + 1));
+  SKIV_CHECK (! skiv_tiled_image_s::IsRequired (SKIV_TILED_IMAGE_MAX_DIMENSION, SKIV_TILED_IMAGE_MAX_DIMENSION));
+
+  // Unknown video memory never forces tiling
+  SKIV_CHECK (! skiv_tiled_image_s::IsRequired (8192, 8192, 512 * MiB, 0));
+
+  // A texture may take at most half of the video memory that is left
+  SKIV_CHECK (! skiv_tiled_image_s::IsRequired (8192, 8192, 512 * MiB, 1024 * MiB));
+  SKIV_CHECK (  skiv_tiled_image_s::IsRequired (8192, 8192, 512 * MiB, 1023 * MiB));
+}
+
+SKIV_TEST (Tiles_PreviewKeepsRegistration)
+{
+  // Black left half, white right half; a 3:1 reduction puts the edge exactly
+  //   between two preview columns
+  DirectX::ScratchImage source;
+  source.Initialize2D (DXGI_FORMAT_R8G8B8A8_UNORM, 300, 200, 1, 1);
+
+  const DirectX::Image* pSource = source.GetImage (0, 0, 0);
+
+  for (size_t y = 0; y < 200; ++y)
+    for (size_t x = 0; x < 300; ++x)
+      memset (pSource->pixels + y * pSource->rowPitch + x * 4, (x < 150) ? 0x00 : 0xFF, 4);
+
+  skiv_tiled_image_s tiled;
+  SKIV_CHECK (SUCCEEDED (tiled.Create (std::move (source), 64)));
+
+  DirectX::ScratchImage preview;
+  SKIV_CHECK (SUCCEEDED (tiled.CreatePreview (preview, 100)));
+
+  const DirectX::Image* pPreview = preview.GetImage (0, 0, 0);
+
+  SKIV_CHECK (pPreview != nullptr);
+  SKIV_CHECK (tiled.preview_width == 100 && tiled.preview_height == 67);
+
+  if (pPreview == nullptr || pPreview->width != 100)
+    return;
+
+  for (size_t y = 0; y < pPreview->height; ++y)
+  {
+    const uint8_t* row = pPreview->pixels + y * pPreview->rowPitch;
+
+    SKIV_CHECK (row [49 * 4] == 0x00 && row [50 * 4] == 0xFF);
+  }
+}
+
+// 4 x 2 tiles of 64 x 64 RGBA8 pixels
+struct skiv_test_tile_grid_s {
+  skiv_tiled_image_s         tiled;
+  CComPtr <ID3D11Device>     pDevice;
+  size_t                     tile_bytes = 64 * 64 * 4;
+
+  skiv_test_tile_grid_s (size_t budget_tiles)
+  {
+    DirectX::ScratchImage source;
+    SKIV_Test_MakePositionImage (256, 128, source);
+
+    tiled.Create (std::move (source), 64);
+    tiled.budget = budget_tiles * tile_bytes;
+
+    D3D11CreateDevice (nullptr, D3D_DRIVER_TYPE_WARP, nullptr, 0, nullptr, 0, D3D11_SDK_VERSION, &pDevice.p, nullptr, nullptr);
+  }
+
+  void view (size_t col0, size_t row0, size_t col1, size_t row1)
+  {
+    tiled.UpdateResidency (pDevice, col0 * 64.0f,       row0 * 64.0f,
+                                   (col1 + 1) * 64.0f, (row1 + 1) * 64.0f);
+  }
+
+  bool resident (size_t col, size_t row) const
+  {
+    return tiled.tiles [row * tiled.columns + col].pSRV.p != nullptr;
+  }
+
+  size_t resident_count (void) const
+  {
+    return std::count_if (tiled.tiles.begin (), tiled.tiles.end (),
+      [](const skiv_image_tile_s& tile) { return tile.pSRV.p != nullptr; });
+  }
+};
+
+SKIV_TEST (Tiles_UploadsAreSpreadOverFrames)
+{
+  skiv_test_tile_grid_s grid (8);
+  SKIV_CHECK (grid.pDevice != nullptr);
+
+  grid.view (0, 0, 3, 1);
+  SKIV_CHECK (grid.resident_count () == SKIV_TILE_UPLOADS_PER_FRAME);
+
+  grid.view (0, 0, 3, 1);
+  SKIV_CHECK (grid.resident_count () == SKIV_TILE_UPLOADS_PER_FRAME * 2);
+
+  grid.view (0, 0, 3, 1);
+  grid.view (0, 0, 3, 1);
+  SKIV_CHECK (grid.resident_count () == 8);
+  SKIV_CHECK (grid.tiled.resident_bytes == 8 * grid.tile_bytes);
+
+  // Resident and visible in the current frame
+  for (const auto& tile : grid.tiled.tiles)
+    SKIV_CHECK (grid.tiled.IsVisible (tile));
+}
+
+SKIV_TEST (Tiles_EvictLeastRecentlyVisible)
+{
+  skiv_test_tile_grid_s grid (2);
+
+  grid.view (0, 0, 0, 0);
+  grid.view (1, 0, 1, 0);
+  SKIV_CHECK (grid.resident (0, 0) && grid.resident (1, 0));
+
+  // Over budget, the tile seen longest ago goes
+  grid.view (2, 0, 2, 0);
+  SKIV_CHECK (! grid.resident (0, 0) && grid.resident (1, 0) && grid.resident (2, 0));
+
+  size_t evicted = 0;
+  for (IUnknown* pResource = nullptr; SKIF_ResourcesToFree.try_pop (pResource); ++evicted)
+    pResource->Release ();
+
+  SKIV_CHECK (evicted == 1);
+
+  // Seeing tile 1 again makes tile 2 the older one
+  grid.view (1, 0, 1, 0);
+  grid.view (3, 0, 3, 0);
+  SKIV_CHECK (grid.resident (1, 0) && ! grid.resident (2, 0) && grid.resident (3, 0));
+  SKIV_CHECK (grid.tiled.resident_bytes == 2 * grid.tile_bytes);
+}
+
+SKIV_TEST (Tiles_VisibleTilesAreNeverEvicted)
+{
+  skiv_test_tile_grid_s grid (1);
+
+  for (int frame = 0; frame < 4; ++frame)
+    grid.view (0, 0, 3, 1);
+
+  SKIV_CHECK (grid.resident_count () == 8);
+  SKIV_CHECK (grid.tiled.resident_bytes > grid.tiled.budget);
+
+  // Once out of view, everything but the visible tile is evicted
+  grid.view (3, 1, 3, 1);
+  SKIV_CHECK (grid.resident_count () == 1 && grid.resident (3, 1));
+  SKIV_CHECK (grid.tiled.resident_bytes == grid.tile_bytes);
+
+  grid.tiled.ReleaseTextures ();
+  SKIV_CHECK (grid.resident_count () == 0 && grid.tiled.resident_bytes == 0);
+}
+
+// Straightforward single-threaded version of SKIV_Image_MeasureLight
+static skiv_image_light_s
+SKIV_Test_MeasureLightReference (const std::vector <float>& rgba, size_t width, size_t height)
+{
+  DirectX::XMFLOAT4X4      to_xyz;
+  DirectX::XMStoreFloat4x4 (&to_xyz, c_from709toXYZ);
+
+  auto _Luminance = [&](const float* p)
+  {
+    return p [0] * to_xyz.m [0][1] + p [1] * to_xyz.m [1][1] + p [2] * to_xyz.m [2][1];
+  };
+
+  float  max_rgb [3] = { 0.0f, 0.0f, 0.0f };
+  float  max_lum     = 0.0f;
+  float  min_lum     = 5240320.0f;
+  double lum_accum   = 0.0;
+
+  for (size_t y = 0; y < height; ++y)
+  {
+    double scanline_lum = 0.0;
+
+    for (size_t x = 0; x < width; ++x)
+    {
+      const float* p   = &rgba [(y * width + x) * 4];
+      const float  lum = _Luminance (p);
+
+      for (int k = 0; k < 3; ++k)
+        if (p [k] > max_rgb [k]) max_rgb [k] = p [k];
+
+      if (lum > max_lum) max_lum = lum;
+      if (lum < min_lum) min_lum = lum;
+      if (lum > 0.0f)    scanline_lum += lum;
+    }
+
+    lum_accum += scanline_lum / width;
+  }
+
+  const float lo    = std::clamp (min_lum, 0.0f, 125.0f);
+  const float hi    = std::clamp (max_lum, lo,   125.0f);
+  const float range = hi - lo;
+
+  std::vector <uint64_t> freq (65536, 0);
+
+  for (size_t i = 0; i < width * height; ++i)
+  {
+    const float lum = _Luminance (&rgba [i * 4]);
+
+    freq [(lum > 0.0f && range > 0.0f) ?
+      static_cast <size_t> (std::clamp (std::roundf ((lum - lo) / (range / 65536.0f)), 0.0f, 65535.0f)) : 0]++;
+  }
+
+  float  p99     = 0.0f;
+  double percent = 100.0;
+
+  for (int i = 65535; i >= 0; --i)
+  {
+    percent -= 100.0 * static_cast <double> (freq [i]) / static_cast <double> (width * height);
+
+    if (percent <= 99.94)
+    {
+      p99 = lo + range * (static_cast <float> (i) / 65536.0f);
+      break;
+    }
+  }
+
+  if (p99 <= 0.01f)
+    p99 = hi;
+
+  skiv_image_light_s light;
+
+  light.max_cll      = std::max ({ max_rgb [0], max_rgb [1], max_rgb [2] });
+  light.max_cll_name = light.max_cll == max_rgb [0] ? 'R' :
+                       light.max_cll == max_rgb [1] ? 'G' : 'B';
+  light.max_nits     = std::max (0.0f, max_lum * 80.0f);
+  light.min_nits     = std::max (0.0f, min_lum * 80.0f);
+  light.p99_nits     = std::max (0.0f, p99     * 80.0f);
+  light.avg_nits     = static_cast <float> (80.0 * lum_accum / height);
+
+  return light;
+}
+
+SKIV_TEST (Tiles_LightLevelsMatchReference)
+{
+  // Wider and taller than one band on any CPU, with negative, NaN and
+  //   beyond-10k-nits pixels
+  const size_t width = 523, height = 389;
+
+  std::mt19937                           rng (31);
+  std::uniform_real_distribution <float> unit (0.0f, 1.0f);
+
+  std::vector <float> rgba (width * height * 4);
+
+  for (size_t i = 0; i < width * height; ++i)
+  {
+    for (int k = 0; k < 3; ++k)
+      rgba [i * 4 + k] = std::pow (10.0f, unit (rng) * 4.0f - 3.0f);
+
+    rgba [i * 4 + 3] = 1.0f;
+  }
+
+  rgba [7 * 4 + 0]    = -0.25f;
+  rgba [11 * 4 + 1]   = std::numeric_limits <float>::quiet_NaN ();
+  rgba [4242 * 4 + 2] = 200.0f;
+
+  // The reference sees what the FP16 image holds
+  for (auto& value : rgba)
+    value = DirectX::PackedVector::XMConvertHalfToFloat (DirectX::PackedVector::XMConvertFloatToHalf (value));
+
+  DirectX::ScratchImage fp16, fp32;
+  fp16.Initialize2D (DXGI_FORMAT_R16G16B16A16_FLOAT, width, height, 1, 1);
+  fp32.Initialize2D (DXGI_FORMAT_R32G32B32A32_FLOAT, width, height, 1, 1);
+
+  memcpy                    (fp32.GetPixels (), rgba.data (), rgba.size () * sizeof (float));
+  SKIV_Image_PackFP32toFP16 (rgba.data (), reinterpret_cast <uint16_t *> (fp16.GetPixels ()), rgba.size ());
+
+  const skiv_image_light_s expected =
+    SKIV_Test_MeasureLightReference (rgba, width, height);
+
+  SKIV_CHECK (expected.max_cll == 200.0f && expected.max_cll_name == 'B');
+
+  for (const auto* pImage : { &fp16, &fp32 })
+  {
+    const skiv_image_light_s light =
+      SKIV_Image_MeasureLight (*pImage->GetImage (0, 0, 0));
+
+    SKIV_CHECK      (light.max_cll      == expected.max_cll);
+    SKIV_CHECK      (light.max_cll_name == expected.max_cll_name);
+    SKIV_CHECK_NEAR (light.max_nits,       expected.max_nits, expected.max_nits * 1e-5);
+    SKIV_CHECK_NEAR (light.min_nits,       expected.min_nits, 1e-3);
+    SKIV_CHECK_NEAR (light.avg_nits,       expected.avg_nits, expected.avg_nits * 1e-5);
+
+    // Within one histogram bin
+    SKIV_CHECK_NEAR (light.p99_nits,       expected.p99_nits, 80.0 * 125.0 / 65536.0);
+  }
+}
@@ -0,0 +1,205 @@
+#include "test.h"
+#include <utility/image.h>
+#include <tabs/viewer.h>
+#include <DirectXPackedVector.h>
+#include <array>
+#include <cstring>
+#include <limits>
+
+// Golden values of SKIV_Image_ApplyVisualization (), worked out by hand from
+//   imgui_pix_shader.hlsl; the ICtCp round trip every pixel goes through costs
+//     a little precision, hence the tolerances.
+
+// Rec. 709 luminance (Y row of c_from709toXYZ)
+static double
+SKIV_Test_Luminance (double r, double g, double b)
+{
+  return 0.2126390039920806884765625 * r + 0.715168654918670654296875 * g + 0.072192318737506866455078125 * b;
+}
+
+// One pixel per entry of colors, as FP32 scRGB
+static void
+SKIV_Test_MakeRow (const std::vector <std::array <float, 3>>& colors, DirectX::ScratchImage& image)
+{
+  image.Initialize2D (DXGI_FORMAT_R32G32B32A32_FLOAT, colors.size (), 1, 1, 1);
+
+  float* row =
+    reinterpret_cast <float *> (image.GetImage (0, 0, 0)->pixels);
+
+  for (size_t x = 0; x < colors.size (); ++x)
+  {
+    row [x * 4 + 0] = colors [x][0];
+    row [x * 4 + 1] = colors [x][1];
+    row [x * 4 + 2] = colors [x][2];
+    row [x * 4 + 3] = 1.0f;
+  }
+}
+
+static std::vector <float>
+SKIV_Test_Visualize (const DirectX::Image& image, const skiv_hdr_visualization_s& viz)
+{
+  DirectX::ScratchImage result;
+
+  SKIV_CHECK (SUCCEEDED (SKIV_Image_ApplyVisualization (image, viz, result)));
+  SKIV_CHECK (result.GetMetadata ().format == DXGI_FORMAT_R16G16B16A16_FLOAT);
+
+  const DirectX::Image* pImage = result.GetImage (0, 0, 0);
+
+  std::vector <float> pixels (pImage->width * 4);
+
+  SKIV_Image_UnpackFP16toFP32 (reinterpret_cast <const uint16_t *> (pImage->pixels), pixels.data (), pixels.size ());
+
+  return pixels;
+}
+
+#define SKIV_CHECK_PIXEL(pixels, x, r, g, b, tolerance)      \
+  do {                                                       \
+    SKIV_CHECK_NEAR ((pixels) [(x) * 4 + 0], (r), (tolerance)); \
+    SKIV_CHECK_NEAR ((pixels) [(x) * 4 + 1], (g), (tolerance)); \
+    SKIV_CHECK_NEAR ((pixels) [(x) * 4 + 2], (b), (tolerance)); \
+    SKIV_CHECK      ((pixels) [(x) * 4 + 3] == 1.0f);           \
+  } while (0)
+
+SKIV_TEST (Visualization_Heatmap)
+{
+  // Grays, so that nits = 80 * value
+  const std::vector <std::array <float, 3>> grays = {
+    {   0.0f   / 80.0f,   0.0f   / 80.0f,   0.0f   / 80.0f },
+    {   1.58f  / 80.0f,   1.58f  / 80.0f,   1.58f  / 80.0f }, // Halfway black .. blue
+    {  65.8f   / 80.0f,  65.8f   / 80.0f,  65.8f   / 80.0f }, // Halfway green .. yellow
+    { 208.0f   / 80.0f, 208.0f   / 80.0f, 208.0f   / 80.0f }, // Halfway yellow .. orange
+    { 2000.0f  / 80.0f, 2000.0f  / 80.0f, 2000.0f  / 80.0f }, // Red .. magenta
+    { 20000.0f / 80.0f, 20000.0f / 80.0f, 20000.0f / 80.0f }  // Beyond the scale
+  };
+
+  DirectX::ScratchImage image;
+  SKIV_Test_MakeRow (grays, image);
+
+  skiv_hdr_visualization_s viz;
+  viz.type             = SKIV_HDR_VISUALIZTION_HEATMAP;
+  viz.display_max_nits = 10000.0f; // No tonemapping
+
+  const auto pixels =
+    SKIV_Test_Visualize (*image.GetImage (0, 0, 0), viz);
+
+  // Each segment blends its two stops at twice their color
+  SKIV_CHECK_PIXEL (pixels, 0, 0.0f, 0.0f, 0.0f,   1e-3);
+  SKIV_CHECK_PIXEL (pixels, 1, 0.0f, 0.0f, 1.0f,   1e-2);
+  SKIV_CHECK_PIXEL (pixels, 2, 1.0f, 2.0f, 0.0f,   2e-2);
+  SKIV_CHECK_PIXEL (pixels, 3, 2.0f, 1.2f, 0.0f,   2e-2);
+  SKIV_CHECK_PIXEL (pixels, 4, 2.0f, 0.0f, 2.0 * (2000.0 - 1000.0) / (3160.0 - 1000.0), 2e-2);
+  SKIV_CHECK_PIXEL (pixels, 5, 125.0f, 125.0f, 125.0f, 1.0);
+
+  // The scale is in displayed nits
+  viz.brightness = 2.0f;
+
+  const auto brighter =
+    SKIV_Test_Visualize (*image.GetImage (0, 0, 0), viz);
+
+  SKIV_CHECK_PIXEL (brighter, 1, 0.0f, 0.0f, 2.0f, 2e-2); // 3.16 nits, the blue stop
+}
+
+SKIV_TEST (Visualization_Gamut)
+{
+  const float nan = std::numeric_limits <float>::quiet_NaN ();
+
+  const std::vector <std::array <float, 3>> colors = {
+    { 0.5f,     0.5f,     0.5f     }, // Rec. 709
+    { 1.0799f,  0.0663f, -0.0255f  }, // 90 % DCI-P3 red, 10 % DCI-P3 green
+    { 0.01f,    0.01f,   -0.0001f  }, // Barely outside Rec. 709, dark
+    { 0.0f,     0.0f,     0.0f     }, // Black
+    { nan,      0.5f,     0.5f     }, // Invalid
+    { -10.0f,   5.0f,     0.0f     }  // Outside of AP0
+  };
+
+  DirectX::ScratchImage image;
+  SKIV_Test_MakeRow (colors, image);
+
+  skiv_hdr_visualization_s viz;
+  viz.type = SKIV_HDR_VISUALIZTION_GAMUT;
+
+  const auto pixels =
+    SKIV_Test_Visualize (*image.GetImage (0, 0, 0), viz);
+
+  // Luminance times the gamut's hue, never dimmer than MIN_WIDE_GAMUT_Y (0.15) times the gamut's rank
+  const double p3_lum   = SKIV_Test_Luminance (1.0799, 0.0663, -0.0255);
+  const double dark_lum = std::max (0.15, SKIV_Test_Luminance (0.01, 0.01, -0.0001));
+  const double ap0_lum  = std::max (1.2,  SKIV_Test_Luminance (-10.0, 5.0, 0.0));
+
+  SKIV_CHECK_PIXEL (pixels, 0, 0.5f,  0.5f,     0.5f,     2e-3);
+  SKIV_CHECK_PIXEL (pixels, 1, 0.0f,  p3_lum,   p3_lum,   2e-3);
+  SKIV_CHECK_PIXEL (pixels, 2, 0.0f,  dark_lum, dark_lum, 2e-3);
+  SKIV_CHECK_PIXEL (pixels, 3, 0.0f,  0.0f,     0.0f,     1e-6);
+  SKIV_CHECK_PIXEL (pixels, 5, ap0_lum, 0.0f,   0.0f,     1e-2);
+
+  // Non-finite pixels show as the undefined hue at full brightness (HLSL's min () drops the NaN)
+  SKIV_CHECK_PIXEL (pixels, 4, 125.0f, 0.0f, 0.0f, 0.5);
+}
+
+SKIV_TEST (Visualization_Tonemap)
+{
+  const std::vector <std::array <float, 3>> grays = {
+    {  2.0f,  2.0f,  2.0f }, // 160 nits
+    { 10.0f, 10.0f, 10.0f }, // 800 nits
+    { 12.5f, 12.5f, 12.5f }  // 1000 nits, the content's maximum
+  };
+
+  DirectX::ScratchImage image;
+  SKIV_Test_MakeRow (grays, image);
+
+  skiv_hdr_visualization_s viz;
+  viz.content_max_nits = 1000.0f;
+  viz.display_max_nits =  400.0f;
+
+  // Everything above the display's maximum is clipped to it
+  viz.tonemap_type = SKIV_TONEMAP_TYPE_CLIP;
+
+  const auto clipped =
+    SKIV_Test_Visualize (*image.GetImage (0, 0, 0), viz);
+
+  SKIV_CHECK_PIXEL (clipped, 0, 2.0f, 2.0f, 2.0f, 1e-2);
+  SKIV_CHECK_PIXEL (clipped, 1, 5.0f, 5.0f, 5.0f, 3e-2);
+  SKIV_CHECK_PIXEL (clipped, 2, 5.0f, 5.0f, 5.0f, 3e-2);
+
+  // The content's maximum lands exactly on the display's maximum
+  viz.tonemap_type = SKIV_TONEMAP_TYPE_MAP_CLL_TO_DISPLAY;
+
+  const auto mapped =
+    SKIV_Test_Visualize (*image.GetImage (0, 0, 0), viz);
+
+  SKIV_CHECK_PIXEL (mapped, 2, 5.0f, 5.0f, 5.0f, 3e-2);
+  SKIV_CHECK (mapped [0] < 2.0f && mapped [4] < mapped [8]);
+
+  // The content's maximum is normalized to PQ 1.0 (10,000 nits)
+  viz.tonemap_type = SKIV_TONEMAP_TYPE_NORMALIZE_TO_CLL;
+
+  const auto normalized =
+    SKIV_Test_Visualize (*image.GetImage (0, 0, 0), viz);
+
+  SKIV_CHECK_PIXEL (normalized, 2, 125.0f, 125.0f, 125.0f, 1.0);
+
+  // Content within the display's range is left alone
+  viz.display_max_nits = 1000.0f;
+
+  const auto untouched =
+    SKIV_Test_Visualize (*image.GetImage (0, 0, 0), viz);
+
+  SKIV_CHECK_PIXEL (untouched, 1, 10.0f, 10.0f, 10.0f, 2e-2);
+}
+
+SKIV_TEST (Visualization_KeepsSDRInputInFP16)
+{
+  DirectX::ScratchImage image;
+  image.Initialize2D (DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, 9, 1, 1, 1);
+
+  // sRGB 188 is very close to linear 0.5
+  std::memset (image.GetPixels (), 188, image.GetPixelsSize ());
+
+  skiv_hdr_visualization_s viz;
+
+  const auto pixels =
+    SKIV_Test_Visualize (*image.GetImage (0, 0, 0), viz);
+
+  for (size_t x = 0; x < 9; ++x)
+    SKIV_CHECK_PIXEL (pixels, x, 0.5029f, 0.5029f, 0.5029f, 5e-3);
+}